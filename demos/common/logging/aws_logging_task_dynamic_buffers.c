@@ -56,6 +56,10 @@
 /* A block time of 0 just means don't block. */
 #define loggingDONT_BLOCK    0
 
+/* The maximum number of messages the logging task takes from the queue at
+ * once when xQueueReceiveMultiple() is available. */
+#define loggingRECEIVE_BATCH_SIZE    8
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -114,17 +118,35 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
 
 static void prvLoggingTask( void * pvParameters )
 {
-    char * pcReceivedString = NULL;
+    #if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+        char * pcReceivedStrings[ loggingRECEIVE_BATCH_SIZE ];
+        BaseType_t xReceived, xIndex;
 
-    for( ; ; )
-    {
-        /* Block to wait for the next string to print. */
-        if( xQueueReceive( xQueue, &pcReceivedString, portMAX_DELAY ) == pdPASS )
+        for( ; ; )
         {
-            configPRINT_STRING( pcReceivedString );
-            vPortFree( ( void * ) pcReceivedString );
+            /* Block to wait for the next string to print, and take any other
+             * strings that were queued behind it in the same operation. */
+            xReceived = xQueueReceiveMultiple( xQueue, pcReceivedStrings, loggingRECEIVE_BATCH_SIZE, portMAX_DELAY );
+
+            for( xIndex = 0; xIndex < xReceived; xIndex++ )
+            {
+                configPRINT_STRING( pcReceivedStrings[ xIndex ] );
+                vPortFree( ( void * ) pcReceivedStrings[ xIndex ] );
+            }
         }
-    }
+    #else /* if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 ) */
+        char * pcReceivedString = NULL;
+
+        for( ; ; )
+        {
+            /* Block to wait for the next string to print. */
+            if( xQueueReceive( xQueue, &pcReceivedString, portMAX_DELAY ) == pdPASS )
+            {
+                configPRINT_STRING( pcReceivedString );
+                vPortFree( ( void * ) pcReceivedString );
+            }
+        }
+    #endif /* if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 ) */
 }
 /*-----------------------------------------------------------*/
 
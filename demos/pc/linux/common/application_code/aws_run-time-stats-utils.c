@@ -0,0 +1,100 @@
+/*
+ * Amazon FreeRTOS V1.4.7
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * Utility functions required to gather run time statistics.  See:
+ * http://www.freertos.org/rtos-run-time-stats.html
+ *
+ * The host monotonic clock is used as the time base, so the counter keeps
+ * running at the same rate however the host schedules the process.  Counts are
+ * in 1/100ths of a millisecond.
+ *
+ * Also note that it is assumed this demo is going to be used for short periods
+ * of time only, and therefore timer overflows are not handled.
+ */
+
+/* Standard includes. */
+#include <time.h>
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+
+/* Variables used in the creation of the run time stats time base.  Run time
+ * stats record how much time each task spends in the Running state. */
+static long long llInitialRunTimeCounterValue = 0LL;
+static BaseType_t xRunTimeCounterConfigured = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+static long long prvGetHundredthsOfMillisecond( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( long long ) xNow.tv_sec * 100000LL ) + ( ( long long ) xNow.tv_nsec / 10000LL );
+}
+/*-----------------------------------------------------------*/
+
+void vConfigureTimerForRunTimeStats( void )
+{
+    /* What is the counter value now, this will be subtracted from readings
+     * taken at run time. */
+    llInitialRunTimeCounterValue = prvGetHundredthsOfMillisecond();
+    xRunTimeCounterConfigured = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long long ullGetRunTimeNanoseconds( void )
+{
+    struct timespec xNow;
+
+    /* A finer time base than the run time counter, for timing short
+     * sections of kernel code from the trace macros. */
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( unsigned long long ) xNow.tv_sec * 1000000000ULL ) + ( unsigned long long ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulGetRunTimeCounterValue( void )
+{
+    unsigned long ulReturn;
+
+    if( xRunTimeCounterConfigured == pdFALSE )
+    {
+        /* The trace macros can call this function before the kernel has been
+         * started, in which case the time base will not have been
+         * initialised. */
+        ulReturn = 0;
+    }
+    else
+    {
+        ulReturn = ( unsigned long ) ( prvGetHundredthsOfMillisecond() - llInitialRunTimeCounterValue );
+    }
+
+    return ulReturn;
+}
+/*-----------------------------------------------------------*/
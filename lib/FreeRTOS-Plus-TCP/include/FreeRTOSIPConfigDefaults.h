@@ -301,6 +301,18 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigEVENT_QUEUE_LENGTH		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
 #endif
 
+/* The number of events the IP-task takes from its event queue at once.  A
+value above 1 uses xQueueReceiveMultiple(), so configUSE_QUEUE_SEND_RECEIVE_MULTIPLE
+must be set to 1, and lets a burst of events be drained with a single queue
+operation. */
+#ifndef ipconfigEVENT_QUEUE_BATCH_SIZE
+	#define ipconfigEVENT_QUEUE_BATCH_SIZE	1
+#endif
+
+#if( ( ipconfigEVENT_QUEUE_BATCH_SIZE > 1 ) && ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE != 1 ) )
+	#error ipconfigEVENT_QUEUE_BATCH_SIZE above 1 requires configUSE_QUEUE_SEND_RECEIVE_MULTIPLE to be set to 1
+#endif
+
 #ifndef ipconfigALLOW_SOCKET_SEND_WITHOUT_BIND
 	#define ipconfigALLOW_SOCKET_SEND_WITHOUT_BIND 1
 #endif
@@ -495,6 +507,26 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM 0
 #endif
 
+/* The function that calculates the Internet checksum, see usGenerateChecksum().
+The default, usGenerateChecksumWord32() in FreeRTOS_IP.c, is optimised for 32-bit
+MCU's.  Faster versions can be found in source/portable/Checksum:
+usGenerateChecksumWord64() in portable C, usGenerateChecksumSSE2() and
+usGenerateChecksumAVX2() for x86, and usGenerateChecksumNEON() for ARM
+Cortex-A.  A custom function with the same prototype may be used as well. */
+#ifndef ipconfigCHECKSUM_FUNCTION
+	#define ipconfigCHECKSUM_FUNCTION	usGenerateChecksumWord32
+#endif
+
+/* When 1, a network buffer has a member 'ucChecksumFlags' in which the driver
+reports, per received packet, which checksums have been verified by the
+hardware: ipCHECKSUM_RX_IP_VERIFIED and/or ipCHECKSUM_RX_PROTOCOL_VERIFIED.
+The IP-task will not check those again.  Unlike
+ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM, this can be decided for each packet,
+e.g. when the hardware only recognises some protocols. */
+#ifndef ipconfigDRIVER_REPORTS_RX_CHECKSUM
+	#define ipconfigDRIVER_REPORTS_RX_CHECKSUM	0
+#endif
+
 #ifndef ipconfigDHCP_REGISTER_HOSTNAME
 	#define ipconfigDHCP_REGISTER_HOSTNAME 0
 #endif
@@ -546,6 +578,90 @@ connections, hang protection can help reduce the impact of SYN floods. */
 	#define ipconfigARP_STORES_REMOTE_ADDRESSES 0
 #endif
 
+/* When set to 1, incoming TCP packets find their socket through a hash table
+indexed by the 4-tuple, plus a small index of listening sockets by local port,
+in stead of walking 'xBoundTCPSocketsList'.  It costs two list items per TCP
+socket and one List_t per bucket. */
+#ifndef ipconfigUSE_TCP_SOCKET_HASH
+	#define ipconfigUSE_TCP_SOCKET_HASH 0
+#endif
+
+#if( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+	/* Number of buckets for connected sockets, must be a power of 2. */
+	#ifndef ipconfigTCP_SOCKET_HASH_SIZE
+		#define ipconfigTCP_SOCKET_HASH_SIZE 64
+	#endif
+
+	/* Number of buckets for listening sockets, must be a power of 2. */
+	#ifndef ipconfigTCP_LISTEN_HASH_SIZE
+		#define ipconfigTCP_LISTEN_HASH_SIZE 16
+	#endif
+
+	#if( ( ipconfigTCP_SOCKET_HASH_SIZE < 1 ) || ( ( ipconfigTCP_SOCKET_HASH_SIZE & ( ipconfigTCP_SOCKET_HASH_SIZE - 1 ) ) != 0 ) )
+		#error ipconfigTCP_SOCKET_HASH_SIZE must be a power of 2
+	#endif
+
+	#if( ( ipconfigTCP_LISTEN_HASH_SIZE < 1 ) || ( ( ipconfigTCP_LISTEN_HASH_SIZE & ( ipconfigTCP_LISTEN_HASH_SIZE - 1 ) ) != 0 ) )
+		#error ipconfigTCP_LISTEN_HASH_SIZE must be a power of 2
+	#endif
+#endif /* ipconfigUSE_TCP_SOCKET_HASH */
+
+/* Congestion control for TCP connections, only available when
+ipconfigUSE_TCP_WIN == 1:
+	0 : none, the amount of outstanding data is only limited by the peer's
+		window and by the socket's own transmission window.
+	1 : NewReno: slow start, congestion avoidance and fast recovery with
+		partial ACK's (RFC 5681 / RFC 6582).
+	2 : CUBIC: the loss recovery of NewReno, with a cubic growth of the
+		congestion window in congestion avoidance (RFC 8312). */
+#define ipTCP_CONGESTION_NONE		0
+#define ipTCP_CONGESTION_NEWRENO	1
+#define ipTCP_CONGESTION_CUBIC		2
+
+#ifndef ipconfigTCP_CONGESTION_CONTROL
+	#define ipconfigTCP_CONGESTION_CONTROL ipTCP_CONGESTION_NONE
+#endif
+
+#if( ( ipconfigTCP_CONGESTION_CONTROL < ipTCP_CONGESTION_NONE ) || ( ipconfigTCP_CONGESTION_CONTROL > ipTCP_CONGESTION_CUBIC ) )
+	#error ipconfigTCP_CONGESTION_CONTROL must be 0 (none), 1 (NewReno) or 2 (CUBIC)
+#endif
+
+#if( ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE ) && ( ipconfigUSE_TCP_WIN == 0 ) )
+	#error ipconfigTCP_CONGESTION_CONTROL requires ipconfigUSE_TCP_WIN
+#endif
+
+/* When set to 1, the TCP sender keeps a SACK scoreboard (RFC 6675): a segment
+is considered lost as soon as more than 2 * MSS bytes, or 3 segments, above it
+have been SACK'd.  All holes in the window are then retransmitted within one
+round-trip.  With congestion control, the data sent during loss recovery is
+limited by an estimate of the data that is still in flight ('pipe') in stead of
+by an inflated cwnd, and so are the retransmissions.  Without congestion control
+nothing paces the retransmissions, so use it together with
+ipconfigTCP_CONGESTION_CONTROL.  When 0, a segment is retransmitted after the
+third SACK that starts above it. */
+#ifndef ipconfigUSE_TCP_SACK_SCOREBOARD
+	#define ipconfigUSE_TCP_SACK_SCOREBOARD 0
+#endif
+
+#if( ( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 ) && ( ipconfigUSE_TCP_WIN == 0 ) )
+	#error ipconfigUSE_TCP_SACK_SCOREBOARD requires ipconfigUSE_TCP_WIN
+#endif
+
+/* When set to 1, FreeRTOS_send() accepts the flag FREERTOS_ZERO_COPY.  The
+data is then passed in a buffer obtained from FreeRTOS_GetTCPPayloadBuffer(),
+which the application fills in place.  The socket keeps the network buffer
+until its data has been acknowledged, and sends it as a packet of its own:
+the data is neither copied into the txStream nor copied out of it.  The buffer
+still occupies its length of space in the txStream, which keeps limiting the
+amount of outstanding data. */
+#ifndef ipconfigUSE_TCP_ZERO_COPY_TX
+	#define ipconfigUSE_TCP_ZERO_COPY_TX 0
+#endif
+
+#if( ( ipconfigUSE_TCP_ZERO_COPY_TX != 0 ) && ( ipconfigUSE_TCP_WIN == 0 ) )
+	#error ipconfigUSE_TCP_ZERO_COPY_TX requires ipconfigUSE_TCP_WIN
+#endif
+
 #ifndef ipconfigBUFFER_PADDING
 	/* Expert option: define a value for 'ipBUFFER_PADDING'.
 	When 'ipconfigBUFFER_PADDING' equals 0,
@@ -83,6 +83,11 @@ buffer will have the following contents:
     #define ipBUFFER_PADDING    ( 8u + ipconfigPACKET_FILLER_SIZE )
 #endif
 
+/* Bits of 'ucChecksumFlags' in a network buffer, set by a driver for a received
+packet when ipconfigDRIVER_REPORTS_RX_CHECKSUM is 1. */
+#define ipCHECKSUM_RX_IP_VERIFIED			( 0x01u )	/* The IP header checksum is correct. */
+#define ipCHECKSUM_RX_PROTOCOL_VERIFIED		( 0x02u )	/* The TCP, UDP or ICMP checksum is correct. */
+
 /* The structure used to store buffers and pass them around the network stack.
 Buffers can be in use by the stack, in use by the network interface hardware
 driver, or free (not in use). */
@@ -94,6 +99,9 @@ typedef struct xNETWORK_BUFFER
 	size_t xDataLength; 			/* Starts by holding the total Ethernet frame length, then the UDP/TCP payload length. */
 	uint16_t usPort;				/* Source or destination port, depending on usage scenario. */
 	uint16_t usBoundPort;			/* The port to which a transmitting socket is bound. */
+	#if( ipconfigDRIVER_REPORTS_RX_CHECKSUM != 0 )
+		uint8_t ucChecksumFlags;	/* Received packets: the checksums that the driver has verified, see ipCHECKSUM_RX_IP_VERIFIED. */
+	#endif
 	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
 		struct xNETWORK_BUFFER *pxNextBuffer; /* Possible optimisation for expert users - requires network driver support. */
 	#endif
@@ -233,6 +241,12 @@ void FreeRTOS_GetAddressConfiguration( uint32_t *pulIPAddress, uint32_t *pulNetM
 void FreeRTOS_SetAddressConfiguration( const uint32_t *pulIPAddress, const uint32_t *pulNetMask, const uint32_t *pulGatewayAddress, const uint32_t *pulDNSServerAddress );
 BaseType_t FreeRTOS_SendPingRequest( uint32_t ulIPAddress, size_t xNumberOfBytesToSend, TickType_t xBlockTimeTicks );
 void FreeRTOS_ReleaseUDPPayloadBuffer( void *pvBuffer );
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+	/* A buffer for FreeRTOS_send() with the FREERTOS_ZERO_COPY flag, and its
+	release in case it was not sent. */
+	void * FreeRTOS_GetTCPPayloadBuffer( size_t xRequestedSizeBytes, TickType_t xBlockTimeTicks );
+	void FreeRTOS_ReleaseTCPPayloadBuffer( void *pvBuffer );
+#endif
 const uint8_t * FreeRTOS_GetMACAddress( void );
 void FreeRTOS_UpdateMACAddress( const uint8_t ucMACAddress[ipMAC_ADDRESS_LENGTH_BYTES] );
 void vApplicationIPNetworkEventHook( eIPCallbackEvent_t eNetworkEvent );
@@ -280,6 +280,10 @@ setting. */
 /* The offset into an IP packet into which the IP data (payload) starts. */
 #define ipIP_PAYLOAD_OFFSET		( sizeof( IPPacket_t ) )
 
+/* The offset into a TCP packet at which the data starts.  Data is only sent in
+packets without TCP options. */
+#define ipTCP_PAYLOAD_OFFSET	( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER )
+
 #include "pack_struct_start.h"
 struct xUDP_IP_FRAGMENT_PARAMETERS
 {
@@ -431,9 +435,25 @@ eFrameProcessingResult_t eARPProcessPacket( ARPPacket_t * const pxARPFrame );
 eFrameProcessingResult_t eConsiderFrameForProcessing( const uint8_t * const pucEthernetBuffer );
 
 /*
- * Return the checksum generated over xDataLengthBytes from pucNextData.
+ * Return the checksum generated over xDataLengthBytes from pucNextData.  It is
+ * calculated by the function selected with ipconfigCHECKSUM_FUNCTION.  All
+ * implementations take and return the sum in host order.
  */
-uint16_t usGenerateChecksum( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
+#define usGenerateChecksum( ulSum, pucNextData, uxDataLengthBytes ) \
+	ipconfigCHECKSUM_FUNCTION( ( ulSum ), ( pucNextData ), ( uxDataLengthBytes ) )
+
+/* The default, in FreeRTOS_IP.c, optimised for 32-bit MCU's. */
+uint16_t usGenerateChecksumWord32( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
+
+/* Portable C with a 64-bit accumulator, portable/Checksum/Checksum_Word64.c */
+uint16_t usGenerateChecksumWord64( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
+
+/* x86 hosts, portable/Checksum/Checksum_x86.c */
+uint16_t usGenerateChecksumSSE2( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
+uint16_t usGenerateChecksumAVX2( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
+
+/* ARM Cortex-A, portable/Checksum/Checksum_NEON.c */
+uint16_t usGenerateChecksumNEON( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes );
 
 /* Socket related private functions. */
 
@@ -469,7 +489,9 @@ BaseType_t xIPIsNetworkTaskReady( void );
 	void vTCPNetStat( void );
 
 	/*
-	 * At least one socket needs to check for timeouts
+	 * At least one socket needs to check for timeouts.  Only the sockets whose
+	 * timer has expired are checked.  Returns the number of ticks until the
+	 * next timer expires.
 	 */
 	TickType_t xTCPTimerCheck( BaseType_t xWillSleep );
 
@@ -535,7 +557,7 @@ BaseType_t xIPIsNetworkTaskReady( void );
 		} bits;
 		uint32_t ulHighestRxAllowed;
 								/* The highest sequence number that we can receive at any moment */
-		uint16_t usTimeout;		/* Time (in ticks) after which this socket needs attention */
+		uint16_t usTimeout;		/* Time (in ticks) after which this socket needs attention, 0 when its timer is not running */
 		uint16_t usCurMSS;		/* Current Maximum Segment Size */
 		uint16_t usInitMSS;		/* Initial maximum segment Size */
 		uint16_t usChildCount;	/* In case of a listening socket: number of connections on this port number */
@@ -545,6 +567,14 @@ BaseType_t xIPIsNetworkTaskReady( void );
 								 * TCP win segments */
 		uint8_t ucTCPState;		/* TCP state: see eTCP_STATE */
 		struct XSOCKET *pxPeerSocket;	/* for server socket: child, for child socket: parent */
+		TickType_t xTimerDeadline;		/* Tick count at which the timer started with 'usTimeout' expires */
+		UBaseType_t uxTimerIndex;		/* Position + 1 of the socket in the TCP timer heap, 0 when not in the heap */
+		ListItem_t xCheckListItem;		/* Used when an API function asks the IP-task to check this socket */
+		ListItem_t xWakeUpListItem;		/* Used while 'xEventBits' has events that were not yet passed to the user */
+		#if( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+			ListItem_t xHashListItem;	/* Used to reference the socket from a 4-tuple hash bucket */
+			ListItem_t xListenListItem;	/* Used to reference the socket from a listen-port bucket */
+		#endif /* ipconfigUSE_TCP_SOCKET_HASH */
 		#if( ipconfigTCP_KEEP_ALIVE == 1 )
 			uint8_t ucKeepRepCount;
 			TickType_t xLastAliveTime;
@@ -561,6 +591,10 @@ BaseType_t xIPIsNetworkTaskReady( void );
 		#if( ipconfigUSE_TCP_WIN == 1 )
 			NetworkBufferDescriptor_t *pxAckMessage;
 		#endif /* ipconfigUSE_TCP_WIN */
+		#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+			List_t xTxFragments;		/* Network buffers passed to FreeRTOS_send() with FREERTOS_ZERO_COPY, in the order of txStream.
+										 * The value of each 'xBufferListItem' is the position of the data in txStream */
+		#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
 		/* Buffer space to store the last TCP header received. */
 		LastTCPPacket_t xPacket;
 		uint8_t tcpflags;		/* TCP flags */
@@ -623,6 +657,7 @@ typedef struct XSOCKET
 	uint16_t usLocalPort;		/* Local port on this machine */
 	uint8_t ucSocketOptions;
 	uint8_t ucProtocol; /* choice of FREERTOS_IPPROTO_UDP/TCP */
+	void *pvSocketID;	/* Set and read by the user with FreeRTOS_SetSocketID() and FreeRTOS_GetSocketID(). */
 	#if( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
 		SemaphoreHandle_t pxUserSemaphore;
 	#endif /* ipconfigSOCKET_HAS_USER_SEMAPHORE */
@@ -661,6 +696,32 @@ typedef struct XSOCKET
 	 */
 	FreeRTOS_Socket_t *pxTCPSocketLookup( uint32_t ulLocalIP, UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort );
 
+	/*
+	 * Start (xTicks > 0) or stop (xTicks == 0) the timer of a TCP socket.
+	 * Must be called from the IP-task.
+	 */
+	void vSocketSetTCPTimer( FreeRTOS_Socket_t *pxSocket, TickType_t xTicks );
+
+	/*
+	 * Ask the IP-task to check a TCP socket as soon as possible, as if its
+	 * timer had expired.  May be called from any task.
+	 */
+	void vSocketKickTCPTimer( FreeRTOS_Socket_t *pxSocket );
+
+	/*
+	 * Called by the IP-task after setting bits in 'xEventBits' of a TCP socket:
+	 * vSocketWakeUpUser() will be called just before the IP-task goes to sleep.
+	 */
+	void vSocketWakeUpUserLater( FreeRTOS_Socket_t *pxSocket );
+
+	#if( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+		/*
+		 * Called by the IP-task after the remote address or port of a bound
+		 * TCP socket has changed: move the socket to its new hash bucket.
+		 */
+		void vSocketUpdateTCPHash( FreeRTOS_Socket_t *pxSocket );
+	#endif /* ipconfigUSE_TCP_SOCKET_HASH */
+
 #endif /* ipconfigUSE_TCP */
 
 /*
@@ -777,6 +838,20 @@ NetworkBufferDescriptor_t *pxUDPPayloadBuffer_to_NetworkBuffer( void *pvBuffer )
 	void vTCPStateChange( FreeRTOS_Socket_t *pxSocket, enum eTCP_STATE eTCPState );
 #endif /* ipconfigUSE_TCP */
 
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+	/*
+	 * Returns a pointer to the original NetworkBuffer from a pointer to a TCP
+	 * payload buffer, as returned by FreeRTOS_GetTCPPayloadBuffer().
+	 */
+	NetworkBufferDescriptor_t *pxTCPPayloadBuffer_to_NetworkBuffer( void *pvBuffer );
+
+	/*
+	 * Release the network buffers that were passed to FreeRTOS_send() with
+	 * FREERTOS_ZERO_COPY, called when the TX stream is cleared or freed.
+	 */
+	void vTCPReleaseTxFragments( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 /*_RB_ Should this be part of the public API? */
 void FreeRTOS_netstat( void );
 
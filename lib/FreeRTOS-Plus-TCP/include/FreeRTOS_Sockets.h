@@ -180,6 +180,13 @@ struct freertos_sockaddr
 	uint32_t sin_addr;
 };
 
+/* A part of the data in a stream, see FreeRTOS_recv_peek(). */
+struct freertos_iovec
+{
+	void *iov_base;
+	size_t iov_len;
+};
+
 #if ipconfigBYTE_ORDER == pdFREERTOS_LITTLE_ENDIAN
 
 	#define FreeRTOS_inet_addr_quick( ucOctet0, ucOctet1, ucOctet2, ucOctet3 )				\
@@ -232,6 +239,11 @@ BaseType_t FreeRTOS_bind( Socket_t xSocket, struct freertos_sockaddr *pxAddress,
 /* function to get the local address and IP port */
 size_t FreeRTOS_GetLocalAddress( Socket_t xSocket, struct freertos_sockaddr *pxAddress );
 
+/* Functions to attach a user value to a socket, for instance to find the
+owner of the socket passed to the FREERTOS_SO_WAKEUP_CALLBACK callback. */
+BaseType_t FreeRTOS_SetSocketID( Socket_t xSocket, void *pvSocketID );
+void *FreeRTOS_GetSocketID( Socket_t xSocket );
+
 /* Made available when ipconfigETHERNET_DRIVER_FILTERS_PACKETS is set to 1. */
 BaseType_t xPortHasUDPSocket( uint16_t usPortNr );
 
@@ -294,6 +306,18 @@ FreeRTOS_rx_size(). */
  */
 uint8_t *FreeRTOS_get_tx_head( Socket_t xSocket, BaseType_t *pxLength );
 
+/*
+ * For advanced applications only:
+ * Get direct pointers to the received data, without copying it.  The data in
+ * the circular receive buffer is returned in at most two parts, the second
+ * one is used when the data wraps around the end of the buffer.  The data
+ * stays valid until it is removed with FreeRTOS_recv_consume(), which may
+ * remove less than was peeked at.  FreeRTOS_recv_peek() waits for data and
+ * returns like FreeRTOS_recv().
+ */
+BaseType_t FreeRTOS_recv_peek( Socket_t xSocket, struct freertos_iovec pxSegments[ 2 ], BaseType_t xFlags );
+BaseType_t FreeRTOS_recv_consume( Socket_t xSocket, size_t uxCount );
+
 #endif /* ipconfigUSE_TCP */
 
 /*
@@ -58,7 +58,8 @@ typedef struct xTCP_SEGMENT
 				ucDupAckCount : 8,	/* Counts the number of times that a higher segment was ACK'd. After 3 times a Fast Retransmission takes place */
 				bOutstanding : 1,	/* It the peer's turn, we're just waiting for an ACK */
 				bAcked : 1,			/* This segment has been acknowledged */
-				bIsForRx : 1;		/* pdTRUE if segment is used for reception */
+				bIsForRx : 1,		/* pdTRUE if segment is used for reception */
+				bLost : 1;			/* SACK scoreboard: enough data above this segment was SACK'd to consider it lost */
 		} bits;
 		uint32_t ulFlags;
 	} u;
@@ -98,8 +99,11 @@ typedef struct xTCP_WINDOW
 			uint32_t
 				bHasInit : 1,		/* The window structure has been initialised */
 				bSendFullSize : 1,	/* May only send packets with a size equal to MSS (for optimisation) */
-				bTimeStamps : 1;	/* Socket is supposed to use TCP time-stamps. This depends on the */
-		} bits;						/* party which opens the connection */
+				bTimeStamps : 1,	/* Socket is supposed to use TCP time-stamps. This depends on the */
+									/* party which opens the connection */
+				bFastRecovery : 1,	/* Congestion control: a fast retransmission took place, waiting for 'ulRecoverySequenceNumber' to be ACK'd */
+				bCubicEpoch : 1;	/* CUBIC: 'xCubicEpochStart' and 'ulCubicK' are valid */
+		} bits;
 		uint32_t ulFlags;
 	} u;
 	TCPWinSize_t xSize;
@@ -126,6 +130,18 @@ typedef struct xTCP_WINDOW
 	uint32_t ulOptionsData[ipSIZE_TCP_OPTIONS/sizeof(uint32_t)];	/* Contains the options we send out */
 	List_t xTxSegments;					/* A linked list of all transmission segments, sorted on sequence number */
 	List_t xRxSegments;					/* A linked list of reception segments, order depends on sequence of arrival */
+	#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+		uint32_t ulCongestionWindow;		/* cwnd: number of bytes that may be outstanding according to the congestion state */
+		uint32_t ulSlowStartThreshold;		/* ssthresh: as long as cwnd is below this value, it grows exponentially (slow start) */
+		uint32_t ulBytesAcked;				/* Bytes ACK'd since cwnd was last incremented during congestion avoidance */
+		uint32_t ulRecoverySequenceNumber;	/* NewReno 'recover': the highest sequence number sent when fast recovery started */
+	#endif
+	#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+		uint32_t ulCubicMaxWindow;			/* W_max: the size of cwnd just before the last reduction */
+		uint32_t ulCubicK;					/* The number of ms after the start of the epoch at which cwnd reaches W_max again */
+		uint32_t ulCubicRenoWindow;			/* W_est: the window that NewReno would have reached in the current epoch */
+		TickType_t xCubicEpochStart;		/* The time at which the current congestion avoidance epoch started */
+	#endif
 #else
 	/* For tiny TCP, there is only 1 outstanding TX segment */
 	TCPSegment_t xTxSegment;			/* Priority queue */
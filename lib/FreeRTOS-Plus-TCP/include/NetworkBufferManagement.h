@@ -54,6 +54,22 @@ In case BufferAllocation_2.c is used, the new space must be allocated. */
 NetworkBufferDescriptor_t *pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer,
 	size_t xNewSizeBytes );
 
+/* Statistics of one size class of BufferAllocation_3.c. */
+typedef struct xNETWORK_BUFFER_CLASS_STATS
+{
+	size_t uxBufferSize;			/* Bytes available for an Ethernet frame. */
+	UBaseType_t uxBufferCount;		/* Number of buffers in the class. */
+	UBaseType_t uxInUse;			/* Number of buffers currently taken. */
+	UBaseType_t uxHighWaterMark;	/* Highest number of buffers taken since booting. */
+	uint32_t ulAllocations;			/* Number of buffers taken since booting. */
+	uint32_t ulFailures;			/* Number of times the class was found empty. */
+} NetworkBufferClassStats_t;
+
+/* Get the statistics of size class 'uxClass', counting from the smallest.
+Only implemented by BufferAllocation_3.c, returns pdFALSE for an invalid
+class. */
+BaseType_t xGetNetworkBufferClassStats( UBaseType_t uxClass, NetworkBufferClassStats_t *pxStats );
+
 #if ipconfigTCP_IP_SANITY
 	/*
 	 * Check if an address is a valid pointer to a network descriptor
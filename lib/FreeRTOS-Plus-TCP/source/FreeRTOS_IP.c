@@ -317,6 +317,11 @@ IPStackEvent_t xReceivedEvent;
 TickType_t xNextIPSleep;
 FreeRTOS_Socket_t *pxSocket;
 struct freertos_sockaddr xAddress;
+#if( ipconfigEVENT_QUEUE_BATCH_SIZE > 1 )
+	/* Events taken from the queue in one go, and the next one to process. */
+	static IPStackEvent_t xReceivedEvents[ ipconfigEVENT_QUEUE_BATCH_SIZE ];
+	BaseType_t xEventCount = 0, xEventIndex = 0;
+#endif
 
 	/* Just to prevent compiler warnings about unused parameters. */
 	( void ) pvParameters;
@@ -354,13 +359,38 @@ struct freertos_sockaddr xAddress;
 		/* Calculate the acceptable maximum sleep time. */
 		xNextIPSleep = prvCalculateSleepTime();
 
-		/* Wait until there is something to do. If the following call exits
-		 * due to a time out rather than a message being received, set a
-		 * 'NoEvent' value. */
-		if ( xQueueReceive( xNetworkEventQueue, ( void * ) &xReceivedEvent, xNextIPSleep ) == pdFALSE ) 
+		#if( ipconfigEVENT_QUEUE_BATCH_SIZE > 1 )
+		{
+			/* Only go back to the queue once every event of the previous burst
+			has been processed, and then take as many events as are waiting.
+			The timers are still checked between the events of a burst. */
+			if( xEventIndex >= xEventCount )
+			{
+				xEventIndex = 0;
+				xEventCount = xQueueReceiveMultiple( xNetworkEventQueue, ( void * ) xReceivedEvents, ipconfigEVENT_QUEUE_BATCH_SIZE, xNextIPSleep );
+			}
+
+			if( xEventIndex < xEventCount )
+			{
+				xReceivedEvent = xReceivedEvents[ xEventIndex ];
+				xEventIndex++;
+			}
+			else
+			{
+				xReceivedEvent.eEventType = eNoEvent;
+			}
+		}
+		#else
 		{
-			xReceivedEvent.eEventType = eNoEvent;
+			/* Wait until there is something to do. If the following call exits
+			 * due to a time out rather than a message being received, set a
+			 * 'NoEvent' value. */
+			if ( xQueueReceive( xNetworkEventQueue, ( void * ) &xReceivedEvent, xNextIPSleep ) == pdFALSE )
+			{
+				xReceivedEvent.eEventType = eNoEvent;
+			}
 		}
+		#endif /* ipconfigEVENT_QUEUE_BATCH_SIZE */
 
 		#if( ipconfigCHECK_IP_QUEUE_SPACE != 0 )
 		{
@@ -928,6 +958,74 @@ void FreeRTOS_ReleaseUDPPayloadBuffer( void *pvBuffer )
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+
+	void *FreeRTOS_GetTCPPayloadBuffer( size_t xRequestedSizeBytes, TickType_t xBlockTimeTicks )
+	{
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+	void *pvReturn;
+
+		/* Obtain a network buffer with space for the Ethernet, IP and TCP
+		headers in front of the data, so that it can be sent as it is. */
+		pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( ipTCP_PAYLOAD_OFFSET + xRequestedSizeBytes, xBlockTimeTicks );
+
+		if( pxNetworkBuffer != NULL )
+		{
+			/* Set the actual packet size in case a bigger buffer was returned. */
+			pxNetworkBuffer->xDataLength = ipTCP_PAYLOAD_OFFSET + xRequestedSizeBytes;
+
+			/* Leave space for the TCP header. */
+			pvReturn = ( void * ) &( pxNetworkBuffer->pucEthernetBuffer[ ipTCP_PAYLOAD_OFFSET ] );
+		}
+		else
+		{
+			pvReturn = NULL;
+		}
+
+		return pvReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	NetworkBufferDescriptor_t *pxTCPPayloadBuffer_to_NetworkBuffer( void *pvBuffer )
+	{
+	uint8_t *pucBuffer;
+	NetworkBufferDescriptor_t *pxResult;
+
+		if( pvBuffer == NULL )
+		{
+			pxResult = NULL;
+		}
+		else
+		{
+			/* The input here is a pointer to a payload buffer.  Subtract the
+			size of the TCP/IP headers plus the size of the header in the
+			network buffer. */
+			pucBuffer = ( ( uint8_t * ) pvBuffer ) - ( ipTCP_PAYLOAD_OFFSET + ipBUFFER_PADDING );
+
+			/* Here a pointer was placed to the network descriptor.  As a
+			pointer is dereferenced, make sure it is well aligned. */
+			if( ( ( ( uintptr_t ) pucBuffer ) & ( sizeof( pucBuffer ) - 1u ) ) == 0u )
+			{
+				pxResult = * ( ( NetworkBufferDescriptor_t ** ) pucBuffer );
+			}
+			else
+			{
+				pxResult = NULL;
+			}
+		}
+
+		return pxResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	void FreeRTOS_ReleaseTCPPayloadBuffer( void *pvBuffer )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxTCPPayloadBuffer_to_NetworkBuffer( pvBuffer ) );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 /*_RB_ Should we add an error or assert if the task priorities are set such that the servers won't function as expected? */
 /*_HT_ There was a bug in FreeRTOS_TCP_IP.c that only occurred when the applications' priority was too high.
  As that bug has been repaired, there is not an urgent reason to warn.
@@ -1480,19 +1578,28 @@ eFrameProcessingResult_t eReturn = eProcessBuffer;
 
 	#if( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 0 )
 	{
+	#if( ipconfigDRIVER_REPORTS_RX_CHECKSUM != 0 )
+		/* The driver may have verified some checksums of this packet. */
+		const uint8_t ucVerified = pxNetworkBuffer->ucChecksumFlags;
+	#else
+		const uint8_t ucVerified = 0u;
+	#endif
+
 		/* Some drivers of NIC's with checksum-offloading will enable the above
 		define, so that the checksum won't be checked again here */
 		if (eReturn == eProcessBuffer )
 		{
 			/* Is the IP header checksum correct? */
 			if( ( pxIPHeader->ucProtocol != ( uint8_t ) ipPROTOCOL_ICMP ) &&
+				( ( ucVerified & ipCHECKSUM_RX_IP_VERIFIED ) == 0u ) &&
 				( usGenerateChecksum( 0UL, ( uint8_t * ) &( pxIPHeader->ucVersionHeaderLength ), ( size_t ) uxHeaderLength ) != ipCORRECT_CRC ) )
 			{
 				/* Check sum in IP-header not correct. */
 				eReturn = eReleaseBuffer;
 			}
 			/* Is the upper-layer checksum (TCP/UDP/ICMP) correct? */
-			else if( usGenerateProtocolChecksum( ( uint8_t * )( pxNetworkBuffer->pucEthernetBuffer ), pxNetworkBuffer->xDataLength, pdFALSE ) != ipCORRECT_CRC )
+			else if( ( ( ucVerified & ipCHECKSUM_RX_PROTOCOL_VERIFIED ) == 0u ) &&
+				( usGenerateProtocolChecksum( ( uint8_t * )( pxNetworkBuffer->pucEthernetBuffer ), pxNetworkBuffer->xDataLength, pdFALSE ) != ipCORRECT_CRC ) )
 			{
 				/* Protocol checksum not accepted. */
 				eReturn = eReleaseBuffer;
@@ -2029,8 +2136,11 @@ uint8_t ucProtocol;
  *	 method should process. The method's memory iterator is initialized to this value.
  *   uxDataLengthBytes: This argument contains the number of bytes that this method
  *	 should process.
+ *
+ * This is the default implementation of usGenerateChecksum(), see
+ * ipconfigCHECKSUM_FUNCTION for the alternatives in portable/Checksum.
  */
-uint16_t usGenerateChecksum( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+uint16_t usGenerateChecksumWord32( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
 {
 xUnion32 xSum2, xSum, xTerm;
 xUnionPtr xSource;		/* Points to first byte */
@@ -75,6 +75,11 @@ range 1024-65535" excluding those already in use (inbound or outbound). */
 	#define ipTCP_TIMER_PERIOD_MS	( 1000 )
 #endif
 
+/* Evaluates to pdTRUE when tick count xA comes before tick count xB.  The
+difference is used so that the TCP timer heap stays ordered when the tick count
+wraps around. */
+#define socketTICK_IS_BEFORE( xA, xB )	( ( ( TickType_t ) ( ( xA ) - ( xB ) ) ) > ( ( ( TickType_t ) portMAX_DELAY ) >> 1 ) )
+
 /* The next private port number to use when binding a client socket is stored in
 the usNextPortToUse[] array - which has either 1 or two indexes depending on
 whether TCP is being supported. */
@@ -129,6 +134,21 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	static StreamBuffer_t *prvTCPCreateStream (FreeRTOS_Socket_t *pxSocket, BaseType_t xIsInputStream );
 #endif /* ipconfigUSE_TCP == 1 */
 
+#if( ipconfigUSE_TCP == 1 )
+	/*
+	 * Called from FreeRTOS_recv() and FreeRTOS_recv_peek(): wait until the
+	 * rxStream has data, the connection is closed or the time-out is reached.
+	 * Returns the number of bytes in rxStream, or a negative error code.
+	 */
+	static BaseType_t prvTCPRecvWait( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags );
+
+	/*
+	 * Called after data has been taken from rxStream: when the low-water mark
+	 * had been reached, see if the peer may be told that there is space again.
+	 */
+	static void prvTCPCheckLowWater( FreeRTOS_Socket_t *pxSocket );
+#endif /* ipconfigUSE_TCP */
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * Called from FreeRTOS_send(): some checks which will be done before
@@ -137,6 +157,16 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	static int32_t prvTCPSendCheck( FreeRTOS_Socket_t *pxSocket, size_t xDataLength );
 #endif /* ipconfigUSE_TCP */
 
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+	/*
+	 * Called by FreeRTOS_send() with the flag FREERTOS_ZERO_COPY: pass the
+	 * network buffer of the payload buffer 'pvBuffer' to the socket, after
+	 * prvTCPSendCheck() has passed.  Unless it returns a positive number, the
+	 * buffer still belongs to the caller.
+	 */
+	static BaseType_t prvTCPSendZeroCopy( FreeRTOS_Socket_t *pxSocket, void *pvBuffer, size_t uxDataLength, BaseType_t xFlags );
+#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * When a child socket gets closed, make sure to update the child-count of the parent
@@ -158,6 +188,31 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	static FreeRTOS_Socket_t *prvFindSelectedSocket( SocketSelect_t *pxSocketSet );
 
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
+
+#if( ipconfigUSE_TCP == 1 )
+
+	/* Make sure the TCP timer heap has room for at least uxCount sockets. */
+	static BaseType_t prvTCPTimerHeapReserve( UBaseType_t uxCount );
+
+	/* Take a socket out of the TCP timer heap. */
+	static void prvTCPTimerHeapRemove( FreeRTOS_Socket_t *pxSocket );
+
+	/* Restore the heap order after the deadline of the socket at uxIndex has
+	changed. */
+	static void prvTCPTimerHeapUpdate( UBaseType_t uxIndex );
+
+	/* Put a socket in the TCP timer heap with a new deadline. */
+	static void prvTCPTimerStart( FreeRTOS_Socket_t *pxSocket, TickType_t xDeadline );
+
+#endif /* ipconfigUSE_TCP */
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH != 0 ) )
+
+	/* Return the index of the 'xTCPSocketHash' bucket for a 4-tuple.  All
+	parameters are in host-endian notation. */
+	static UBaseType_t prvTCPHashIndex( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort );
+
+#endif /* ipconfigUSE_TCP_SOCKET_HASH */
 /*-----------------------------------------------------------*/
 
 /* The list that contains mappings between sockets and port numbers.  Accesses
@@ -166,8 +221,34 @@ List_t xBoundUDPSocketsList;
 
 #if ipconfigUSE_TCP == 1
 	List_t xBoundTCPSocketsList;
+
+	/* The running timers of the TCP sockets, kept as a binary min-heap ordered
+	by 'xTimerDeadline', so the first timer to expire is always found at index
+	0.  The array is resized in vSocketBind(), so that every bound TCP socket
+	fits and starting a timer can not fail.  Only accessed by the IP-task. */
+	static FreeRTOS_Socket_t **ppxTCPTimerHeap = NULL;
+	static UBaseType_t uxTCPTimerHeapLength = 0u;
+	static UBaseType_t uxTCPTimerHeapCount = 0u;
+
+	/* Sockets that an API function wants to be checked by the IP-task.  The
+	list is accessed by all tasks, with the scheduler suspended. */
+	static List_t xTCPCheckList;
+
+	/* Sockets with events that must be passed to the user before the IP-task
+	goes to sleep.  Only accessed by the IP-task. */
+	static List_t xTCPWakeUpList;
 #endif /* ipconfigUSE_TCP == 1 */
 
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH != 0 ) )
+	/* Every bound TCP socket is also stored in one of the buckets of
+	'xTCPSocketHash', selected by its local port, remote port and remote IP
+	address.  Sockets bound by the user (not the child sockets of a listening
+	socket) are also stored in 'xTCPListenHash', selected by their local port.
+	Both tables are only accessed by the IP-task. */
+	static List_t xTCPSocketHash[ ipconfigTCP_SOCKET_HASH_SIZE ];
+	static List_t xTCPListenHash[ ipconfigTCP_LISTEN_HASH_SIZE ];
+#endif /* ipconfigUSE_TCP_SOCKET_HASH */
+
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvValidSocket( FreeRTOS_Socket_t *pxSocket, BaseType_t xProtocol, BaseType_t xIsBound )
@@ -200,6 +281,23 @@ BaseType_t vNetworkSocketsInit( void )
 	#if( ipconfigUSE_TCP == 1 )
 	{
 		vListInitialise( &xBoundTCPSocketsList );
+		vListInitialise( &xTCPCheckList );
+		vListInitialise( &xTCPWakeUpList );
+
+		#if( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+		{
+		BaseType_t xIndex;
+
+			for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigTCP_SOCKET_HASH_SIZE; xIndex++ )
+			{
+				vListInitialise( &( xTCPSocketHash[ xIndex ] ) );
+			}
+			for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigTCP_LISTEN_HASH_SIZE; xIndex++ )
+			{
+				vListInitialise( &( xTCPListenHash[ xIndex ] ) );
+			}
+		}
+		#endif /* ipconfigUSE_TCP_SOCKET_HASH */
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
 
@@ -350,6 +448,26 @@ Socket_t xReturn;
 					/* The above values are just defaults, and can be overridden by
 					calling FreeRTOS_setsockopt().  No buffers will be allocated until a
 					socket is connected and data is exchanged. */
+
+					vListInitialiseItem( &( pxSocket->u.xTCP.xCheckListItem ) );
+					listSET_LIST_ITEM_OWNER( &( pxSocket->u.xTCP.xCheckListItem ), ( void * ) pxSocket );
+					vListInitialiseItem( &( pxSocket->u.xTCP.xWakeUpListItem ) );
+					listSET_LIST_ITEM_OWNER( &( pxSocket->u.xTCP.xWakeUpListItem ), ( void * ) pxSocket );
+
+					#if( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+					{
+						vListInitialiseItem( &( pxSocket->u.xTCP.xHashListItem ) );
+						listSET_LIST_ITEM_OWNER( &( pxSocket->u.xTCP.xHashListItem ), ( void * ) pxSocket );
+						vListInitialiseItem( &( pxSocket->u.xTCP.xListenListItem ) );
+						listSET_LIST_ITEM_OWNER( &( pxSocket->u.xTCP.xListenListItem ), ( void * ) pxSocket );
+					}
+					#endif /* ipconfigUSE_TCP_SOCKET_HASH */
+
+					#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+					{
+						vListInitialise( &( pxSocket->u.xTCP.xTxFragments ) );
+					}
+					#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
 				}
 			}
 			#endif  /* ipconfigUSE_TCP == 1 */
@@ -1035,6 +1153,16 @@ List_t *pxSocketList;
 				FreeRTOS_ntohs( pxAddress->sin_port ) ) );
 			xReturn = -pdFREERTOS_ERRNO_EADDRINUSE;
 		}
+	#if( ipconfigUSE_TCP == 1 )
+		else if( ( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP ) &&
+				 ( prvTCPTimerHeapReserve( listCURRENT_LIST_LENGTH( &xBoundTCPSocketsList ) + 1u ) == pdFALSE ) )
+		{
+			/* There is no space to store the timer of one more TCP socket. */
+			FreeRTOS_debug_printf( ( "vSocketBind: no space for the timer of TCP port %d\n",
+				FreeRTOS_ntohs( pxAddress->sin_port ) ) );
+			xReturn = -pdFREERTOS_ERRNO_ENOMEM;
+		}
+	#endif /* ipconfigUSE_TCP == 1 */
 		else
 		{
 			/* Allocate the port number to the socket.
@@ -1059,6 +1187,28 @@ List_t *pxSocketList;
 				/* Add the socket to 'xBoundUDPSocketsList' or 'xBoundTCPSocketsList' */
 				vListInsertEnd( pxSocketList, &( pxSocket->xBoundSocketListItem ) );
 
+				#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH != 0 ) )
+				{
+					if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+					{
+						/* File the socket under its current 4-tuple.  A child
+						socket still has a remote address of 0:0 here, it will
+						be moved by vSocketUpdateTCPHash(). */
+						vListInsertEnd( &( xTCPSocketHash[ prvTCPHashIndex( pxSocket->usLocalPort,
+							pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort ) ] ),
+							&( pxSocket->u.xTCP.xHashListItem ) );
+
+						if( xInternal == pdFALSE )
+						{
+							/* Only a socket bound by the user may become a
+							listening socket.  There is at most one per port. */
+							vListInsertEnd( &( xTCPListenHash[ pxSocket->usLocalPort & ( ipconfigTCP_LISTEN_HASH_SIZE - 1u ) ] ),
+								&( pxSocket->u.xTCP.xListenListItem ) );
+						}
+					}
+				}
+				#endif /* ipconfigUSE_TCP_SOCKET_HASH */
+
 				#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 				{
 					xTaskResumeAll();
@@ -1165,6 +1315,14 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 				vPortFreeLarge( pxSocket->u.xTCP.rxStream );
 			}
 
+			#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+			{
+				/* Release the buffers that were passed with FREERTOS_ZERO_COPY
+				and which are not yet acknowledged. */
+				vTCPReleaseTxFragments( pxSocket );
+			}
+			#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 			if( pxSocket->u.xTCP.txStream != NULL )
 			{
 				vPortFreeLarge( pxSocket->u.xTCP.txStream );
@@ -1173,6 +1331,26 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 			/* In case this is a child socket, make sure the child-count of the
 			parent socket is decreased. */
 			prvTCPSetSocketCount( pxSocket );
+
+			/* Stop the timer and forget about pending checks and events. */
+			if( pxSocket->u.xTCP.uxTimerIndex != 0u )
+			{
+				prvTCPTimerHeapRemove( pxSocket );
+			}
+
+			if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xWakeUpListItem ) ) != NULL )
+			{
+				uxListRemove( &( pxSocket->u.xTCP.xWakeUpListItem ) );
+			}
+
+			vTaskSuspendAll();
+			{
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xCheckListItem ) ) != NULL )
+				{
+					uxListRemove( &( pxSocket->u.xTCP.xCheckListItem ) );
+				}
+			}
+			xTaskResumeAll();
 		}
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
@@ -1197,6 +1375,22 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 			xTaskResumeAll();
 		}
 		#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
+
+		#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH != 0 ) )
+		{
+			if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+			{
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xHashListItem ) ) != NULL )
+				{
+					uxListRemove( &( pxSocket->u.xTCP.xHashListItem ) );
+				}
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xListenListItem ) ) != NULL )
+				{
+					uxListRemove( &( pxSocket->u.xTCP.xListenListItem ) );
+				}
+			}
+		}
+		#endif /* ipconfigUSE_TCP_SOCKET_HASH */
 	}
 
 	/* Now the socket is not bound the list of waiting packets can be
@@ -1603,7 +1797,7 @@ FreeRTOS_Socket_t *pxSocket;
 						( pxSocket->u.xTCP.ucTCPState >= eESTABLISHED ) &&
 						( FreeRTOS_outstanding( pxSocket ) != 0 ) )
 					{
-						pxSocket->u.xTCP.usTimeout = 1u; /* to set/clear bSendFullSize */
+						vSocketKickTCPTimer( pxSocket ); /* to set/clear bSendFullSize */
 						xSendEventToIPTask( eTCPTimerEvent );
 					}
 				}
@@ -1627,7 +1821,7 @@ FreeRTOS_Socket_t *pxSocket;
 					}
 
 					pxSocket->u.xTCP.bits.bWinChange = pdTRUE_UNSIGNED;
-					pxSocket->u.xTCP.usTimeout = 1u; /* to set/clear bRxStopped */
+					vSocketKickTCPTimer( pxSocket ); /* to set/clear bRxStopped */
 					xSendEventToIPTask( eTCPTimerEvent );
 				}
 				xReturn = 0;
@@ -1874,6 +2068,35 @@ FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
 
 /*-----------------------------------------------------------*/
 
+BaseType_t FreeRTOS_SetSocketID( Socket_t xSocket, void *pvSocketID )
+{
+FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+BaseType_t xReturn = -pdFREERTOS_ERRNO_EINVAL;
+
+	if( ( pxSocket != NULL ) && ( pxSocket != FREERTOS_INVALID_SOCKET ) )
+	{
+		pxSocket->pvSocketID = pvSocketID;
+		xReturn = 0;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void *FreeRTOS_GetSocketID( Socket_t xSocket )
+{
+FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+void *pvReturn = NULL;
+
+	if( ( pxSocket != NULL ) && ( pxSocket != FREERTOS_INVALID_SOCKET ) )
+	{
+		pvReturn = pxSocket->pvSocketID;
+	}
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
 void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 {
 /* _HT_ must work this out, now vSocketWakeUpUser will be called for any important
@@ -2015,7 +2238,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				vTCPStateChange( pxSocket, eCONNECT_SYN );
 
 				/* To start an active connect. */
-				pxSocket->u.xTCP.usTimeout = 1u;
+				vSocketKickTCPTimer( pxSocket );
 
 				if( xSendEventToIPTask( eTCPTimerEvent ) != pdPASS )
 				{
@@ -2234,154 +2457,170 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 #if( ipconfigUSE_TCP == 1 )
 
-	/*
-	 * Read incoming data from a TCP socket
-	 * Only after the last byte has been read, a close error might be returned
-	 */
-	BaseType_t FreeRTOS_recv( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags )
+	static BaseType_t prvTCPRecvWait( FreeRTOS_Socket_t *pxSocket, BaseType_t xFlags )
 	{
 	BaseType_t xByteCount;
-	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
 	TickType_t xRemainingTime;
 	BaseType_t xTimed = pdFALSE;
 	TimeOut_t xTimeOut;
 	EventBits_t xEventBits = ( EventBits_t ) 0;
 
-		/* Check if the socket is valid, has type TCP and if it is bound to a
-		port. */
-		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) == pdFALSE )
+		if( pxSocket->u.xTCP.rxStream != NULL )
 		{
-			xByteCount = -pdFREERTOS_ERRNO_EINVAL;
+			xByteCount = ( BaseType_t )uxStreamBufferGetSize ( pxSocket->u.xTCP.rxStream );
 		}
 		else
 		{
-			if( pxSocket->u.xTCP.rxStream != NULL )
-			{
-				xByteCount = ( BaseType_t )uxStreamBufferGetSize ( pxSocket->u.xTCP.rxStream );
-			}
-			else
+			xByteCount = 0;
+		}
+
+		while( xByteCount == 0 )
+		{
+			switch( pxSocket->u.xTCP.ucTCPState )
 			{
-				xByteCount = 0;
+			case eCLOSED:
+			case eCLOSE_WAIT:	/* (server + client) waiting for a connection termination request from the local user. */
+			case eCLOSING:		/* (server + client) waiting for a connection termination request acknowledgement from the remote TCP. */
+				if( pxSocket->u.xTCP.bits.bMallocError != pdFALSE_UNSIGNED )
+				{
+					/* The no-memory error has priority above the non-connected error.
+					Both are fatal and will elad to closing the socket. */
+					xByteCount = -pdFREERTOS_ERRNO_ENOMEM;
+				}
+				else
+				{
+					xByteCount = -pdFREERTOS_ERRNO_ENOTCONN;
+				}
+				/* Call continue to break out of the switch and also the while
+				loop. */
+				continue;
+			default:
+				break;
 			}
 
-			while( xByteCount == 0 )
+			if( xTimed == pdFALSE )
 			{
-				switch( pxSocket->u.xTCP.ucTCPState )
+				/* Only in the first round, check for non-blocking. */
+				xRemainingTime = pxSocket->xReceiveBlockTime;
+
+				if( xRemainingTime == ( TickType_t ) 0 )
 				{
-				case eCLOSED:
-				case eCLOSE_WAIT:	/* (server + client) waiting for a connection termination request from the local user. */
-				case eCLOSING:		/* (server + client) waiting for a connection termination request acknowledgement from the remote TCP. */
-					if( pxSocket->u.xTCP.bits.bMallocError != pdFALSE_UNSIGNED )
-					{
-						/* The no-memory error has priority above the non-connected error.
-						Both are fatal and will elad to closing the socket. */
-						xByteCount = -pdFREERTOS_ERRNO_ENOMEM;
-					}
-					else
+					#if( ipconfigSUPPORT_SIGNALS != 0 )
 					{
-						xByteCount = -pdFREERTOS_ERRNO_ENOTCONN;
+						/* Just check for the interrupt flag. */
+						xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup, eSOCKET_INTR,
+							pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, socketDONT_BLOCK );
 					}
-					/* Call continue to break out of the switch and also the while
-					loop. */
-					continue;
-				default:
+					#endif /* ipconfigSUPPORT_SIGNALS */
 					break;
 				}
 
-				if( xTimed == pdFALSE )
+				if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
 				{
-					/* Only in the first round, check for non-blocking. */
-					xRemainingTime = pxSocket->xReceiveBlockTime;
-
-					if( xRemainingTime == ( TickType_t ) 0 )
-					{
-						#if( ipconfigSUPPORT_SIGNALS != 0 )
-						{
-							/* Just check for the interrupt flag. */
-							xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup, eSOCKET_INTR,
-								pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, socketDONT_BLOCK );
-						}
-						#endif /* ipconfigSUPPORT_SIGNALS */
-						break;
-					}
+					break;
+				}
 
-					if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
-					{
-						break;
-					}
+				/* Don't get here a second time. */
+				xTimed = pdTRUE;
 
-					/* Don't get here a second time. */
-					xTimed = pdTRUE;
+				/* Fetch the current time. */
+				vTaskSetTimeOutState( &xTimeOut );
+			}
 
-					/* Fetch the current time. */
-					vTaskSetTimeOutState( &xTimeOut );
-				}
+			/* Has the timeout been reached? */
+			if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+			{
+				break;
+			}
 
-				/* Has the timeout been reached? */
-				if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+			/* Block until there is a down-stream event. */
+			xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup,
+				eSOCKET_RECEIVE | eSOCKET_CLOSED | eSOCKET_INTR,
+				pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+			#if( ipconfigSUPPORT_SIGNALS != 0 )
+			{
+				if( ( xEventBits & eSOCKET_INTR ) != 0u )
 				{
 					break;
 				}
+			}
+			#else
+			{
+				( void ) xEventBits;
+			}
+			#endif /* ipconfigSUPPORT_SIGNALS */
 
-				/* Block until there is a down-stream event. */
-				xEventBits = xEventGroupWaitBits( pxSocket->xEventGroup,
-					eSOCKET_RECEIVE | eSOCKET_CLOSED | eSOCKET_INTR,
-					pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
-				#if( ipconfigSUPPORT_SIGNALS != 0 )
-				{
-					if( ( xEventBits & eSOCKET_INTR ) != 0u )
-					{
-						break;
-					}
-				}
-				#else
-				{
-					( void ) xEventBits;
-				}
-				#endif /* ipconfigSUPPORT_SIGNALS */
+			if( pxSocket->u.xTCP.rxStream != NULL )
+			{
+				xByteCount = ( BaseType_t ) uxStreamBufferGetSize ( pxSocket->u.xTCP.rxStream );
+			}
+			else
+			{
+				xByteCount = 0;
+			}
+		}
 
-				if( pxSocket->u.xTCP.rxStream != NULL )
-				{
-					xByteCount = ( BaseType_t ) uxStreamBufferGetSize ( pxSocket->u.xTCP.rxStream );
-				}
-				else
-				{
-					xByteCount = 0;
-				}
+	#if( ipconfigSUPPORT_SIGNALS != 0 )
+		if( ( xEventBits & eSOCKET_INTR ) != 0 )
+		{
+			if( ( xEventBits & ( eSOCKET_RECEIVE | eSOCKET_CLOSED ) ) != 0 )
+			{
+				/* Shouldn't have cleared other flags. */
+				xEventBits &= ~eSOCKET_INTR;
+				xEventGroupSetBits( pxSocket->xEventGroup, xEventBits );
 			}
+			xByteCount = -pdFREERTOS_ERRNO_EINTR;
+		}
+	#endif /* ipconfigSUPPORT_SIGNALS */
 
-		#if( ipconfigSUPPORT_SIGNALS != 0 )
-			if( ( xEventBits & eSOCKET_INTR ) != 0 )
+		return xByteCount;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPCheckLowWater( FreeRTOS_Socket_t *pxSocket )
+	{
+		if( pxSocket->u.xTCP.bits.bLowWater != pdFALSE_UNSIGNED )
+		{
+			/* We had reached the low-water mark, now see if the flag
+			can be cleared */
+			size_t uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
+
+			if( uxFrontSpace >= pxSocket->u.xTCP.uxEnoughSpace )
 			{
-				if( ( xEventBits & ( eSOCKET_RECEIVE | eSOCKET_CLOSED ) ) != 0 )
-				{
-					/* Shouldn't have cleared other flags. */
-					xEventBits &= ~eSOCKET_INTR;
-					xEventGroupSetBits( pxSocket->xEventGroup, xEventBits );
-				}
-				xByteCount = -pdFREERTOS_ERRNO_EINTR;
+				pxSocket->u.xTCP.bits.bLowWater = pdFALSE_UNSIGNED;
+				pxSocket->u.xTCP.bits.bWinChange = pdTRUE_UNSIGNED;
+				vSocketKickTCPTimer( pxSocket ); /* because bLowWater is cleared. */
+				xSendEventToIPTask( eTCPTimerEvent );
 			}
-			else
-		#endif /* ipconfigSUPPORT_SIGNALS */
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * Read incoming data from a TCP socket
+	 * Only after the last byte has been read, a close error might be returned
+	 */
+	BaseType_t FreeRTOS_recv( Socket_t xSocket, void *pvBuffer, size_t xBufferLength, BaseType_t xFlags )
+	{
+	BaseType_t xByteCount;
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+
+		/* Check if the socket is valid, has type TCP and if it is bound to a
+		port. */
+		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) == pdFALSE )
+		{
+			xByteCount = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			xByteCount = prvTCPRecvWait( pxSocket, xFlags );
+
 			if( xByteCount > 0 )
 			{
 				if( ( xFlags & FREERTOS_ZERO_COPY ) == 0 )
 				{
 					xByteCount = ( BaseType_t ) uxStreamBufferGet( pxSocket->u.xTCP.rxStream, 0ul, ( uint8_t * ) pvBuffer, ( size_t ) xBufferLength, ( xFlags & FREERTOS_MSG_PEEK ) != 0 );
-					if( pxSocket->u.xTCP.bits.bLowWater != pdFALSE_UNSIGNED )
-					{
-						/* We had reached the low-water mark, now see if the flag
-						can be cleared */
-						size_t uxFrontSpace = uxStreamBufferFrontSpace( pxSocket->u.xTCP.rxStream );
-
-						if( uxFrontSpace >= pxSocket->u.xTCP.uxEnoughSpace )
-						{
-							pxSocket->u.xTCP.bits.bLowWater = pdFALSE_UNSIGNED;
-							pxSocket->u.xTCP.bits.bWinChange = pdTRUE_UNSIGNED;
-							pxSocket->u.xTCP.usTimeout = 1u; /* because bLowWater is cleared. */
-							xSendEventToIPTask( eTCPTimerEvent );
-						}
-					}
+					prvTCPCheckLowWater( pxSocket );
 				}
 				else
 				{
@@ -2393,31 +2632,107 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 		return xByteCount;
 	}
+	/*-----------------------------------------------------------*/
 
-#endif /* ipconfigUSE_TCP */
-/*-----------------------------------------------------------*/
-
-#if( ipconfigUSE_TCP == 1 )
-
-	static int32_t prvTCPSendCheck( FreeRTOS_Socket_t *pxSocket, size_t xDataLength )
+	/*
+	 * Get direct pointers to the data in rxStream.  As the data may wrap
+	 * around the end of the circular buffer, it is returned in two parts.
+	 */
+	BaseType_t FreeRTOS_recv_peek( Socket_t xSocket, struct freertos_iovec pxSegments[ 2 ], BaseType_t xFlags )
 	{
-	int32_t xResult = 1;
+	BaseType_t xByteCount;
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+	StreamBuffer_t *pxStream;
+	size_t uxTail, uxFirst;
+
+		pxSegments[ 0 ].iov_base = NULL;
+		pxSegments[ 0 ].iov_len = 0u;
+		pxSegments[ 1 ].iov_base = NULL;
+		pxSegments[ 1 ].iov_len = 0u;
 
-		/* Is this a socket of type TCP and is it already bound to a port number ? */
 		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) == pdFALSE )
 		{
-			xResult = -pdFREERTOS_ERRNO_EINVAL;
-		}
-		else if( pxSocket->u.xTCP.bits.bMallocError != pdFALSE_UNSIGNED )
-		{
-			xResult = -pdFREERTOS_ERRNO_ENOMEM;
+			xByteCount = -pdFREERTOS_ERRNO_EINVAL;
 		}
-		else if( pxSocket->u.xTCP.ucTCPState == eCLOSED ||
-                 pxSocket->u.xTCP.ucTCPState == eCLOSE_WAIT ||
-                 pxSocket->u.xTCP.ucTCPState == eCLOSING )
+		else
 		{
-			xResult = -pdFREERTOS_ERRNO_ENOTCONN;
-		}
+			xByteCount = prvTCPRecvWait( pxSocket, xFlags );
+
+			if( xByteCount > 0 )
+			{
+				/* The IP-task only moves the head, so the data between the
+				tail and the head that was seen above stays where it is until
+				it is consumed. */
+				pxStream = pxSocket->u.xTCP.rxStream;
+				uxTail = pxStream->uxTail;
+				uxFirst = FreeRTOS_min_uint32( ( uint32_t ) xByteCount, ( uint32_t ) ( pxStream->LENGTH - uxTail ) );
+
+				pxSegments[ 0 ].iov_base = ( void * ) ( pxStream->ucArray + uxTail );
+				pxSegments[ 0 ].iov_len = uxFirst;
+
+				if( uxFirst < ( size_t ) xByteCount )
+				{
+					pxSegments[ 1 ].iov_base = ( void * ) pxStream->ucArray;
+					pxSegments[ 1 ].iov_len = ( size_t ) xByteCount - uxFirst;
+				}
+			}
+		}
+
+		return xByteCount;
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * Remove data from rxStream after it was inspected with
+	 * FreeRTOS_recv_peek().
+	 */
+	BaseType_t FreeRTOS_recv_consume( Socket_t xSocket, size_t uxCount )
+	{
+	BaseType_t xByteCount;
+	FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+
+		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) == pdFALSE )
+		{
+			xByteCount = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else if( pxSocket->u.xTCP.rxStream == NULL )
+		{
+			xByteCount = 0;
+		}
+		else
+		{
+			/* Only advance the tail, at most up to the head. */
+			xByteCount = ( BaseType_t ) uxStreamBufferGet( pxSocket->u.xTCP.rxStream, 0ul, NULL, uxCount, pdFALSE );
+			prvTCPCheckLowWater( pxSocket );
+		}
+
+		return xByteCount;
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	static int32_t prvTCPSendCheck( FreeRTOS_Socket_t *pxSocket, size_t xDataLength )
+	{
+	int32_t xResult = 1;
+
+		/* Is this a socket of type TCP and is it already bound to a port number ? */
+		if( prvValidSocket( pxSocket, FREERTOS_IPPROTO_TCP, pdTRUE ) == pdFALSE )
+		{
+			xResult = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else if( pxSocket->u.xTCP.bits.bMallocError != pdFALSE_UNSIGNED )
+		{
+			xResult = -pdFREERTOS_ERRNO_ENOMEM;
+		}
+		else if( pxSocket->u.xTCP.ucTCPState == eCLOSED ||
+                 pxSocket->u.xTCP.ucTCPState == eCLOSE_WAIT ||
+                 pxSocket->u.xTCP.ucTCPState == eCLOSING )
+		{
+			xResult = -pdFREERTOS_ERRNO_ENOTCONN;
+		}
 		else if( pxSocket->u.xTCP.bits.bFinSent != pdFALSE_UNSIGNED )
 		{
 			/* This TCP connection is closing already, the FIN flag has been sent.
@@ -2447,6 +2762,110 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+
+	static BaseType_t prvTCPSendZeroCopy( FreeRTOS_Socket_t *pxSocket, void *pvBuffer, size_t uxDataLength, BaseType_t xFlags )
+	{
+	NetworkBufferDescriptor_t *pxNetworkBuffer = pxTCPPayloadBuffer_to_NetworkBuffer( pvBuffer );
+	BaseType_t xResult;
+	TickType_t xRemainingTime;
+	TimeOut_t xTimeOut;
+
+		/* prvTCPSendCheck() has already been called. */
+		if( ( pxNetworkBuffer == NULL ) ||
+			( pxNetworkBuffer->xDataLength < ( ipTCP_PAYLOAD_OFFSET + uxDataLength ) ) ||
+			( uxDataLength >= pxSocket->u.xTCP.txStream->LENGTH ) )
+		{
+			/* Not a buffer from FreeRTOS_GetTCPPayloadBuffer(), or the data
+			does not fit in it, or it will never fit in the txStream. */
+			xResult = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			xResult = ( BaseType_t ) uxDataLength;
+			xRemainingTime = pxSocket->xSendBlockTime;
+
+			#if( ipconfigUSE_CALLBACKS != 0 )
+			{
+				if( xIsCallingFromIPTask() != pdFALSE )
+				{
+					/* Don't let the IP-task wait for itself. */
+					xRemainingTime = ( TickType_t ) 0;
+				}
+			}
+			#endif /* ipconfigUSE_CALLBACKS */
+
+			if( ( xFlags & FREERTOS_MSG_DONTWAIT ) != 0 )
+			{
+				xRemainingTime = ( TickType_t ) 0;
+			}
+
+			vTaskSetTimeOutState( &xTimeOut );
+
+			/* The buffer is passed as a whole: wait until the txStream has
+			space for all of its data. */
+			while( uxStreamBufferGetSpace( pxSocket->u.xTCP.txStream ) < uxDataLength )
+			{
+				if( ( pxSocket->u.xTCP.ucTCPState > eESTABLISHED ) || ( pxSocket->u.xTCP.bits.bFinSent != pdFALSE_UNSIGNED ) )
+				{
+					xResult = -pdFREERTOS_ERRNO_ENOTCONN;
+					break;
+				}
+
+				if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+				{
+					xResult = -pdFREERTOS_ERRNO_ENOSPC;
+					break;
+				}
+
+				/* Go sleeping until down-stream events are received. */
+				xEventGroupWaitBits( pxSocket->xEventGroup, eSOCKET_SEND | eSOCKET_CLOSED,
+					pdTRUE /*xClearOnExit*/, pdFALSE /*xWaitAllBits*/, xRemainingTime );
+			}
+
+			if( xResult > 0 )
+			{
+				/* The value of the list item is the position of the data in
+				txStream.  The header space in front of the data will be
+				filled in by the IP-task. */
+				pxNetworkBuffer->xDataLength = ipTCP_PAYLOAD_OFFSET + uxDataLength;
+				listSET_LIST_ITEM_VALUE( &( pxNetworkBuffer->xBufferListItem ), ( TickType_t ) pxSocket->u.xTCP.txStream->uxHead );
+
+				vTaskSuspendAll();
+				{
+					/* Setting bCloseRequested and adding the last data must be
+					done together, see FreeRTOS_send(). */
+					if( pxSocket->u.xTCP.bits.bCloseAfterSend != pdFALSE_UNSIGNED )
+					{
+						pxSocket->u.xTCP.bits.bCloseRequested = pdTRUE_UNSIGNED;
+					}
+
+					vListInsertEnd( &( pxSocket->u.xTCP.xTxFragments ), &( pxNetworkBuffer->xBufferListItem ) );
+
+					/* Only advance the head of txStream: the IP-task will see
+					the data once the buffer is in the list. */
+					( void ) uxStreamBufferAdd( pxSocket->u.xTCP.txStream, 0u, NULL, uxDataLength );
+				}
+				( void ) xTaskResumeAll();
+
+				/* Let the IP-task work on this socket. */
+				vSocketKickTCPTimer( pxSocket );
+
+				if( xIsCallingFromIPTask() == pdFALSE )
+				{
+					xSendEventToIPTask( eTCPTimerEvent );
+				}
+
+				xResult = ( BaseType_t ) uxDataLength;
+			}
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP == 1 )
 
 	/* Get a direct pointer to the circular transmit buffer.
@@ -2495,12 +2914,17 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	TimeOut_t xTimeOut;
 	BaseType_t xCloseAfterSend;
 
-		/* Prevent compiler warnings about unused parameters.  The parameter
-		may be used in future versions. */
-		( void ) xFlags;
-
 		xByteCount = ( BaseType_t ) prvTCPSendCheck( pxSocket, uxDataLength );
 
+		#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+		if( ( xByteCount > 0 ) && ( ( xFlags & FREERTOS_ZERO_COPY ) != 0 ) )
+		{
+			/* The data is passed in a network buffer, which is handed over
+			as a whole. */
+			xByteCount = prvTCPSendZeroCopy( pxSocket, ( void * ) pvBuffer, uxDataLength, xFlags );
+		}
+		else
+		#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
 		if( xByteCount > 0 )
 		{
 			/* xBytesLeft is number of bytes to send, will count to zero. */
@@ -2560,7 +2984,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 					/* Send a message to the IP-task so it can work on this
 					socket.  Data is sent, let the IP-task work on it. */
-					pxSocket->u.xTCP.usTimeout = 1u;
+					vSocketKickTCPTimer( pxSocket );
 
 					if( xIsCallingFromIPTask() == pdFALSE )
 					{
@@ -2706,6 +3130,12 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 					vStreamBufferClear( pxSocket->u.xTCP.txStream );
 				}
 
+				#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+				{
+					vTCPReleaseTxFragments( pxSocket );
+				}
+				#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 				memset( pxSocket->u.xTCP.xPacket.u.ucLastPacket, '\0', sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket ) );
 				memset( &pxSocket->u.xTCP.xTCPWindow, '\0', sizeof( pxSocket->u.xTCP.xTCPWindow ) );
 				memset( &pxSocket->u.xTCP.bits, '\0', sizeof( pxSocket->u.xTCP.bits ) );
@@ -2749,7 +3179,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 			pxSocket->u.xTCP.bits.bUserShutdown = pdTRUE_UNSIGNED;
 
 			/* Let the IP-task perform the shutdown of the connection. */
-			pxSocket->u.xTCP.usTimeout = 1u;
+			vSocketKickTCPTimer( pxSocket );
 			xSendEventToIPTask( eTCPTimerEvent );
 			xResult = 0;
 		}
@@ -2771,75 +3201,255 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 	 * - Send a keep-alive packet
 	 * - Check for timeout (in non-connected states only)
 	 */
-	TickType_t xTCPTimerCheck( BaseType_t xWillSleep )
+	static BaseType_t prvTCPTimerHeapReserve( UBaseType_t uxCount )
 	{
-	FreeRTOS_Socket_t *pxSocket;
-	TickType_t xShortest = pdMS_TO_TICKS( ( TickType_t ) ipTCP_TIMER_PERIOD_MS );
-	TickType_t xNow = xTaskGetTickCount();
-	static TickType_t xLastTime = 0u;
-	TickType_t xDelta = xNow - xLastTime;
-	ListItem_t* pxEnd = ( ListItem_t * ) listGET_END_MARKER( &xBoundTCPSocketsList );
-	ListItem_t *pxIterator = ( ListItem_t * ) listGET_HEAD_ENTRY( &xBoundTCPSocketsList );
+	FreeRTOS_Socket_t **ppxNewHeap;
+	UBaseType_t uxNewLength;
+	BaseType_t xReturn = pdTRUE;
 
-		xLastTime = xNow;
-
-		if( xDelta == 0u )
+		if( uxCount > uxTCPTimerHeapLength )
 		{
-			xDelta = 1u;
+			/* Grow in steps of a factor 2, so that binding many sockets does
+			not cause many re-allocations. */
+			uxNewLength = ( uxTCPTimerHeapLength != 0u ) ? ( 2u * uxTCPTimerHeapLength ) : 8u;
+			while( uxNewLength < uxCount )
+			{
+				uxNewLength *= 2u;
+			}
+
+			ppxNewHeap = ( FreeRTOS_Socket_t ** ) pvPortMalloc( uxNewLength * sizeof( *ppxNewHeap ) );
+
+			if( ppxNewHeap == NULL )
+			{
+				xReturn = pdFALSE;
+			}
+			else
+			{
+				if( ppxTCPTimerHeap != NULL )
+				{
+					memcpy( ppxNewHeap, ppxTCPTimerHeap, uxTCPTimerHeapCount * sizeof( *ppxNewHeap ) );
+					vPortFree( ppxTCPTimerHeap );
+				}
+
+				ppxTCPTimerHeap = ppxNewHeap;
+				uxTCPTimerHeapLength = uxNewLength;
+			}
 		}
 
-		while( pxIterator != pxEnd )
-		{
-			pxSocket = ( FreeRTOS_Socket_t * )listGET_LIST_ITEM_OWNER( pxIterator );
-			pxIterator = ( ListItem_t * ) listGET_NEXT( pxIterator );
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPTimerHeapUpdate( UBaseType_t uxIndex )
+	{
+	FreeRTOS_Socket_t *pxSocket = ppxTCPTimerHeap[ uxIndex ];
+	UBaseType_t uxParent, uxChild;
 
-			/* Sockets with 'tmout == 0' do not need any regular attention. */
-			if( pxSocket->u.xTCP.usTimeout == 0u )
+		/* Move the socket up while its deadline is earlier than the one of its
+		parent. */
+		while( uxIndex > 0u )
+		{
+			uxParent = ( uxIndex - 1u ) / 2u;
+			if( socketTICK_IS_BEFORE( pxSocket->u.xTCP.xTimerDeadline, ppxTCPTimerHeap[ uxParent ]->u.xTCP.xTimerDeadline ) == pdFALSE )
 			{
-				continue;
+				break;
 			}
+			ppxTCPTimerHeap[ uxIndex ] = ppxTCPTimerHeap[ uxParent ];
+			ppxTCPTimerHeap[ uxIndex ]->u.xTCP.uxTimerIndex = uxIndex + 1u;
+			uxIndex = uxParent;
+		}
 
-			if( xDelta < ( TickType_t ) pxSocket->u.xTCP.usTimeout )
+		/* Move the socket down while a child has an earlier deadline. */
+		for( ;; )
+		{
+			uxChild = ( 2u * uxIndex ) + 1u;
+			if( uxChild >= uxTCPTimerHeapCount )
 			{
-				pxSocket->u.xTCP.usTimeout = ( uint16_t ) ( ( ( TickType_t ) pxSocket->u.xTCP.usTimeout ) - xDelta );
+				break;
 			}
-			else
+			if( ( ( uxChild + 1u ) < uxTCPTimerHeapCount ) &&
+				( socketTICK_IS_BEFORE( ppxTCPTimerHeap[ uxChild + 1u ]->u.xTCP.xTimerDeadline, ppxTCPTimerHeap[ uxChild ]->u.xTCP.xTimerDeadline ) != pdFALSE ) )
+			{
+				uxChild++;
+			}
+			if( socketTICK_IS_BEFORE( ppxTCPTimerHeap[ uxChild ]->u.xTCP.xTimerDeadline, pxSocket->u.xTCP.xTimerDeadline ) == pdFALSE )
 			{
-			int rc ;
-				pxSocket->u.xTCP.usTimeout = 0u;
-				rc = xTCPSocketCheck( pxSocket );
+				break;
+			}
+			ppxTCPTimerHeap[ uxIndex ] = ppxTCPTimerHeap[ uxChild ];
+			ppxTCPTimerHeap[ uxIndex ]->u.xTCP.uxTimerIndex = uxIndex + 1u;
+			uxIndex = uxChild;
+		}
+
+		ppxTCPTimerHeap[ uxIndex ] = pxSocket;
+		pxSocket->u.xTCP.uxTimerIndex = uxIndex + 1u;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPTimerHeapRemove( FreeRTOS_Socket_t *pxSocket )
+	{
+	UBaseType_t uxIndex = pxSocket->u.xTCP.uxTimerIndex - 1u;
+
+		pxSocket->u.xTCP.uxTimerIndex = 0u;
+		uxTCPTimerHeapCount--;
+
+		if( uxIndex != uxTCPTimerHeapCount )
+		{
+			/* Fill the hole with the last entry and restore the heap order. */
+			ppxTCPTimerHeap[ uxIndex ] = ppxTCPTimerHeap[ uxTCPTimerHeapCount ];
+			prvTCPTimerHeapUpdate( uxIndex );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPTimerStart( FreeRTOS_Socket_t *pxSocket, TickType_t xDeadline )
+	{
+		pxSocket->u.xTCP.xTimerDeadline = xDeadline;
 
-				/* Within this function, the socket might want to send a delayed
-				ack or send out data or whatever it needs to do. */
-				if( rc < 0 )
+		if( pxSocket->u.xTCP.uxTimerIndex != 0u )
+		{
+			prvTCPTimerHeapUpdate( pxSocket->u.xTCP.uxTimerIndex - 1u );
+		}
+		else if( socketSOCKET_IS_BOUND( pxSocket ) != pdFALSE )
+		{
+			/* vSocketBind() has reserved a place for every bound socket. */
+			configASSERT( uxTCPTimerHeapCount < uxTCPTimerHeapLength );
+			ppxTCPTimerHeap[ uxTCPTimerHeapCount ] = pxSocket;
+			uxTCPTimerHeapCount++;
+			prvTCPTimerHeapUpdate( uxTCPTimerHeapCount - 1u );
+		}
+		else
+		{
+			/* A socket that is not bound has nothing to do. */
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vSocketSetTCPTimer( FreeRTOS_Socket_t *pxSocket, TickType_t xTicks )
+	{
+		pxSocket->u.xTCP.usTimeout = ( uint16_t ) xTicks;
+
+		if( xTicks != 0u )
+		{
+			prvTCPTimerStart( pxSocket, xTaskGetTickCount() + xTicks );
+		}
+		else if( pxSocket->u.xTCP.uxTimerIndex != 0u )
+		{
+			prvTCPTimerHeapRemove( pxSocket );
+		}
+		else
+		{
+			/* The timer was not running. */
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vSocketKickTCPTimer( FreeRTOS_Socket_t *pxSocket )
+	{
+		if( xIsCallingFromIPTask() != pdFALSE )
+		{
+			/* Let the timer expire at the next check. */
+			vSocketSetTCPTimer( pxSocket, 1u );
+		}
+		else
+		{
+			vTaskSuspendAll();
+			{
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xCheckListItem ) ) == NULL )
 				{
-					/* Continue because the socket was deleted. */
-					continue;
+					vListInsertEnd( &xTCPCheckList, &( pxSocket->u.xTCP.xCheckListItem ) );
 				}
 			}
+			xTaskResumeAll();
+		}
+	}
+	/*-----------------------------------------------------------*/
 
-			/* In xEventBits the driver may indicate that the socket has
-			important events for the user.  These are only done just before the
-			IP-task goes to sleep. */
-			if( pxSocket->xEventBits != 0u )
+	void vSocketWakeUpUserLater( FreeRTOS_Socket_t *pxSocket )
+	{
+		if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xWakeUpListItem ) ) == NULL )
+		{
+			vListInsertEnd( &xTCPWakeUpList, &( pxSocket->u.xTCP.xWakeUpListItem ) );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	TickType_t xTCPTimerCheck( BaseType_t xWillSleep )
+	{
+	FreeRTOS_Socket_t *pxSocket;
+	TickType_t xShortest = pdMS_TO_TICKS( ( TickType_t ) ipTCP_TIMER_PERIOD_MS );
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xRemaining;
+
+		/* Sockets for which an API function asked for a check are handled as
+		if their timer has expired. */
+		vTaskSuspendAll();
+		{
+			while( listCURRENT_LIST_LENGTH( &xTCPCheckList ) != 0u )
 			{
-				if( xWillSleep != pdFALSE )
-				{
-					/* The IP-task is about to go to sleep, so messages can be
-					sent to the socket owners. */
-					vSocketWakeUpUser( pxSocket );
-				}
-				else
+				pxSocket = ( FreeRTOS_Socket_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xTCPCheckList );
+				uxListRemove( &( pxSocket->u.xTCP.xCheckListItem ) );
+				pxSocket->u.xTCP.usTimeout = 1u;
+				prvTCPTimerStart( pxSocket, xNow );
+			}
+		}
+		xTaskResumeAll();
+
+		/* Only the sockets of which the timer has expired are visited.  The
+		socket being checked may start its timer again, or get closed. */
+		while( uxTCPTimerHeapCount != 0u )
+		{
+			pxSocket = ppxTCPTimerHeap[ 0 ];
+
+			if( socketTICK_IS_BEFORE( xNow, pxSocket->u.xTCP.xTimerDeadline ) != pdFALSE )
+			{
+				break;
+			}
+
+			vSocketSetTCPTimer( pxSocket, 0u );
+
+			/* Within this function, the socket might want to send a delayed
+			ack or send out data or whatever it needs to do.  A negative
+			result means that the socket was deleted. */
+			( void ) xTCPSocketCheck( pxSocket );
+		}
+
+		/* In xEventBits the driver may indicate that the socket has
+		important events for the user.  These are only done just before the
+		IP-task goes to sleep. */
+		if( listCURRENT_LIST_LENGTH( &xTCPWakeUpList ) != 0u )
+		{
+			if( xWillSleep != pdFALSE )
+			{
+				/* The IP-task is about to go to sleep, so messages can be
+				sent to the socket owners. */
+				while( listCURRENT_LIST_LENGTH( &xTCPWakeUpList ) != 0u )
 				{
-					/* Or else make sure this will be called again to wake-up
-					the sockets' owner. */
-					xShortest = ( TickType_t ) 0;
+					pxSocket = ( FreeRTOS_Socket_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xTCPWakeUpList );
+					uxListRemove( &( pxSocket->u.xTCP.xWakeUpListItem ) );
+
+					if( pxSocket->xEventBits != 0u )
+					{
+						vSocketWakeUpUser( pxSocket );
+					}
 				}
 			}
+			else
+			{
+				/* Or else make sure this will be called again to wake-up
+				the sockets' owner. */
+				xShortest = ( TickType_t ) 0;
+			}
+		}
 
-			if( ( pxSocket->u.xTCP.usTimeout != 0u ) && ( xShortest > ( TickType_t ) pxSocket->u.xTCP.usTimeout ) )
+		/* The socket at the top of the heap has the earliest deadline. */
+		if( uxTCPTimerHeapCount != 0u )
+		{
+			xRemaining = ppxTCPTimerHeap[ 0 ]->u.xTCP.xTimerDeadline - xNow;
+
+			if( xShortest > xRemaining )
 			{
-				xShortest = ( TickType_t ) pxSocket->u.xTCP.usTimeout;
+				xShortest = xRemaining;
 			}
 		}
 
@@ -2849,7 +3459,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigUSE_TCP == 1 )
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH == 0 ) )
 
 	/*
 	 * TCP: as multiple sockets may be bound to the same local port number
@@ -2899,7 +3509,102 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 		return pxResult;
 	}
 
-#endif /* ipconfigUSE_TCP */
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH == 0 ) */
+/*-----------------------------------------------------------*/
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH != 0 ) )
+
+	static UBaseType_t prvTCPHashIndex( UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
+	{
+	uint32_t ulHash;
+
+		/* Mix the tuple with a multiplicative (Fibonacci) hash, then fold the
+		high bits down so that the mask below uses all of them. */
+		ulHash = ulRemoteIP ^ ( ( ( uint32_t ) uxRemotePort ) << 16 ) ^ ( uint32_t ) uxLocalPort;
+		ulHash *= 0x9E3779B1ul;
+		ulHash ^= ulHash >> 16;
+
+		return ( UBaseType_t ) ( ulHash & ( ipconfigTCP_SOCKET_HASH_SIZE - 1u ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vSocketUpdateTCPHash( FreeRTOS_Socket_t *pxSocket )
+	{
+		if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xHashListItem ) ) != NULL )
+		{
+			uxListRemove( &( pxSocket->u.xTCP.xHashListItem ) );
+			vListInsertEnd( &( xTCPSocketHash[ prvTCPHashIndex( pxSocket->usLocalPort,
+				pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort ) ] ),
+				&( pxSocket->u.xTCP.xHashListItem ) );
+		}
+
+		/* A socket that is actively connecting will never become a listening
+		socket: take it out of the listen index so that client sockets do not
+		lengthen those buckets. */
+		if( ( pxSocket->u.xTCP.ucTCPState != ( uint8_t ) eTCP_LISTEN ) &&
+			( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xListenListItem ) ) != NULL ) &&
+			( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED ) )
+		{
+			uxListRemove( &( pxSocket->u.xTCP.xListenListItem ) );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	/*
+	 * The same lookup as above, but only the sockets that share a hash
+	 * bucket with the 4-tuple, or with the local port in case of a listening
+	 * socket, are inspected.  The fields of each candidate are compared
+	 * again, so a socket filed under a stale tuple can not give a false match.
+	 */
+	FreeRTOS_Socket_t *pxTCPSocketLookup( uint32_t ulLocalIP, UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
+	{
+	ListItem_t *pxIterator;
+	FreeRTOS_Socket_t *pxResult = NULL;
+	MiniListItem_t *pxEnd;
+
+		/* Parameter not yet supported. */
+		( void ) ulLocalIP;
+
+		pxEnd = ( MiniListItem_t* )listGET_END_MARKER( &( xTCPSocketHash[ prvTCPHashIndex( uxLocalPort, ulRemoteIP, uxRemotePort ) ] ) );
+		for( pxIterator  = ( ListItem_t * ) listGET_NEXT( pxEnd );
+			 pxIterator != ( ListItem_t * ) pxEnd;
+			 pxIterator  = ( ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			if( ( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort ) &&
+				( pxSocket->u.xTCP.ucTCPState != ( uint8_t ) eTCP_LISTEN ) &&
+				( pxSocket->u.xTCP.usRemotePort == ( uint16_t ) uxRemotePort ) &&
+				( pxSocket->u.xTCP.ulRemoteIP == ulRemoteIP ) )
+			{
+				pxResult = pxSocket;
+				break;
+			}
+		}
+
+		if( pxResult == NULL )
+		{
+			/* An exact match was not found, look for a listening socket. */
+			pxEnd = ( MiniListItem_t* )listGET_END_MARKER( &( xTCPListenHash[ uxLocalPort & ( ipconfigTCP_LISTEN_HASH_SIZE - 1u ) ] ) );
+			for( pxIterator  = ( ListItem_t * ) listGET_NEXT( pxEnd );
+				 pxIterator != ( ListItem_t * ) pxEnd;
+				 pxIterator  = ( ListItem_t * ) listGET_NEXT( pxIterator ) )
+			{
+				FreeRTOS_Socket_t *pxSocket = ( FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+				if( ( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort ) &&
+					( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eTCP_LISTEN ) )
+				{
+					pxResult = pxSocket;
+					break;
+				}
+			}
+		}
+
+		return pxResult;
+	}
+
+#endif /* ( ipconfigUSE_TCP == 1 ) && ( ipconfigUSE_TCP_SOCKET_HASH != 0 ) */
 /*-----------------------------------------------------------*/
 
 #if( ipconfigUSE_TCP == 1 )
@@ -3097,7 +3802,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 						pxSocket->u.xTCP.bits.bWinChange = pdTRUE_UNSIGNED;
 
 						/* bLowWater was reached, send the changed window size. */
-						pxSocket->u.xTCP.usTimeout = 1u;
+						vSocketKickTCPTimer( pxSocket );
 						xSendEventToIPTask( eTCPTimerEvent );
 					}
 				}
@@ -3105,6 +3810,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				/* New incoming data is available, wake up the user.   User's
 				semaphores will be set just before the IP-task goes asleep. */
 				pxSocket->xEventBits |= eSOCKET_RECEIVE;
+				vSocketWakeUpUserLater( pxSocket );
 
 				#if ipconfigSUPPORT_SELECT_FUNCTION == 1
 				{
@@ -257,6 +257,43 @@ static TickType_t prvTCPNextTimeout( FreeRTOS_Socket_t *pxSocket );
  */
 static void prvTCPAddTxData( FreeRTOS_Socket_t *pxSocket );
 
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+	/*
+	 * Return the offset from the tail of txStream of the data of a buffer that
+	 * was passed with FREERTOS_ZERO_COPY.  It is negative when the first part
+	 * of the data has been acknowledged already.
+	 */
+	static int32_t prvTCPTxFragmentOffset( FreeRTOS_Socket_t *pxSocket, const ListItem_t *pxItem );
+
+	/*
+	 * Find the first buffer passed with FREERTOS_ZERO_COPY of which the data
+	 * ends beyond 'lOffset', an offset from the tail of txStream.  The offset
+	 * and the length of its data are returned in '*plStart' and '*plLength'.
+	 */
+	static NetworkBufferDescriptor_t *prvTCPFindTxFragment( FreeRTOS_Socket_t *pxSocket, int32_t lOffset,
+		int32_t *plStart, int32_t *plLength );
+
+	/*
+	 * Copy TX data that is not sent as a buffer of its own, either from
+	 * txStream or from the buffers passed with FREERTOS_ZERO_COPY.
+	 */
+	static size_t prvTCPCopyTxData( FreeRTOS_Socket_t *pxSocket, size_t uxOffset, uint8_t *pucTarget, size_t uxCount );
+
+	/*
+	 * Send a buffer passed with FREERTOS_ZERO_COPY of which the data forms
+	 * exactly one TX segment.  The buffer stays with the socket until the data
+	 * has been acknowledged.
+	 */
+	static void prvTCPSendTxFragment( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxFragment,
+		const uint8_t *pucHeaders, int32_t lStreamPos, int32_t lDataLen );
+
+	/*
+	 * Release the buffers passed with FREERTOS_ZERO_COPY of which all data is
+	 * among the 'ulCount' bytes that have just been acknowledged.
+	 */
+	static void prvTCPAckTxFragments( FreeRTOS_Socket_t *pxSocket, uint32_t ulCount );
+#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 /*
  *  Called to handle the closure of a TCP connection.
  */
@@ -469,7 +506,7 @@ static BaseType_t prvTCPSocketIsActive( UBaseType_t uxStatus )
  * It can send a delayed ACK or new data
  * Sequence of calling (normally) :
  * IP-Task:
- *		xTCPTimerCheck()				// Check all sockets ( declared in FreeRTOS_Sockets.c )
+ *		xTCPTimerCheck()				// Check the sockets whose timer expired ( declared in FreeRTOS_Sockets.c )
  *		xTCPSocketCheck()				// Either send a delayed ACK or call prvTCPSendPacket()
  *		prvTCPSendPacket()				// Either send a SYN or call prvTCPSendRepeated ( regular messages )
  *		prvTCPSendRepeated()			// Send at most 8 messages on a row
@@ -1004,6 +1041,14 @@ uint32_t ulInitialSequenceNumber = 0;
 	}
 	#endif /* ipconfigHAS_PRINTF != 0 */
 
+	#if( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+	{
+		/* The remote address and port were set by FreeRTOS_connect(), file
+		the socket under its new 4-tuple before the SYN goes out. */
+		vSocketUpdateTCPHash( pxSocket );
+	}
+	#endif /* ipconfigUSE_TCP_SOCKET_HASH */
+
 	ulRemoteIP = FreeRTOS_htonl( pxSocket->u.xTCP.ulRemoteIP );
 
 	/* Determine the ARP cache status for the requested IP address. */
@@ -1288,8 +1333,14 @@ UBaseType_t uxNewMSS;
 						if( ( pxSocket->u.xTCP.txStream  != NULL ) && ( ulCount > 0 ) )
 						{
 							/* Just advancing the tail index, 'ulCount' bytes have been confirmed. */
+							#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+							{
+								prvTCPAckTxFragments( pxSocket, ulCount );
+							}
+							#endif
 							uxStreamBufferGet( pxSocket->u.xTCP.txStream, 0, NULL, ( size_t ) ulCount, pdFALSE );
 							pxSocket->xEventBits |= eSOCKET_SEND;
+							vSocketWakeUpUserLater( pxSocket );
 
 							#if ipconfigSUPPORT_SELECT_FUNCTION == 1
 							{
@@ -1477,6 +1528,7 @@ BaseType_t bAfter  = ( BaseType_t ) NOW_CONNECTED( eTCPState );						/* Is it co
 					}
 
 					xParent->xEventBits |= eSOCKET_ACCEPT;
+					vSocketWakeUpUserLater( xParent );
 
 					#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 					{
@@ -1514,6 +1566,7 @@ BaseType_t bAfter  = ( BaseType_t ) NOW_CONNECTED( eTCPState );						/* Is it co
 			else
 			{
 				pxSocket->xEventBits |= eSOCKET_CONNECT;
+				vSocketWakeUpUserLater( pxSocket );
 
 				#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 				{
@@ -1529,6 +1582,7 @@ BaseType_t bAfter  = ( BaseType_t ) NOW_CONNECTED( eTCPState );						/* Is it co
 		{
 			/* Notify/wake-up the socket-owner by setting a semaphore. */
 			pxSocket->xEventBits |= eSOCKET_CLOSED;
+			vSocketWakeUpUserLater( pxSocket );
 
 			#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 			{
@@ -1555,7 +1609,7 @@ BaseType_t bAfter  = ( BaseType_t ) NOW_CONNECTED( eTCPState );						/* Is it co
 			won't need further attention of the IP-task.
 			Setting time-out to zero means that the socket won't get checked during
 			timer events. */
-			pxSocket->u.xTCP.usTimeout = 0u;
+			vSocketSetTCPTimer( pxSocket, 0u );
 		}
 	}
 	else
@@ -1692,6 +1746,11 @@ uint32_t ulDataGot, ulDistance;
 TCPWindow_t *pxTCPWindow;
 NetworkBufferDescriptor_t *pxNewBuffer;
 int32_t lStreamPos;
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+	NetworkBufferDescriptor_t *pxFragment;
+	int32_t lStart, lLength;
+	UBaseType_t uxIndex;
+#endif
 
 	if( ( *ppxNetworkBuffer ) != NULL )
 	{
@@ -1721,6 +1780,27 @@ int32_t lStreamPos;
 			lDataLen = ( int32_t ) ulTCPWindowTxGet( pxTCPWindow, pxSocket->u.xTCP.ulWindowSize, &lStreamPos );
 		}
 
+		#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+		{
+			/* As long as the next segment is exactly the data of a buffer that
+			was passed with FREERTOS_ZERO_COPY, send that buffer itself.  Data
+			is only sent in packets without options. */
+			for( uxIndex = 0u; ( uxIndex < ( UBaseType_t ) SEND_REPEATED_COUNT ) && ( lDataLen > 0 ) && ( uxOptionsLength == 0u ); uxIndex++ )
+			{
+				uxOffset = uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail, ( size_t ) lStreamPos );
+				pxFragment = prvTCPFindTxFragment( pxSocket, ( int32_t ) uxOffset, &lStart, &lLength );
+
+				if( ( pxFragment == NULL ) || ( lStart != ( int32_t ) uxOffset ) || ( lLength != lDataLen ) )
+				{
+					break;
+				}
+
+				prvTCPSendTxFragment( pxSocket, pxFragment, pucEthernetBuffer, lStreamPos, lDataLen );
+				lDataLen = ( int32_t ) ulTCPWindowTxGet( pxTCPWindow, pxSocket->u.xTCP.ulWindowSize, &lStreamPos );
+			}
+		}
+		#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 		if( lDataLen > 0 )
 		{
 			/* Check if the current network buffer is big enough, if not,
@@ -1741,7 +1821,18 @@ int32_t lStreamPos;
 
 				/* Here data is copied from the txStream in 'peek' mode.  Only
 				when the packets are acked, the tail marker will be updated. */
-				ulDataGot = ( uint32_t ) uxStreamBufferGet( pxSocket->u.xTCP.txStream, uxOffset, pucSendData, ( size_t ) lDataLen, pdTRUE );
+				#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+				{
+					/* The data may come from buffers passed with
+					FREERTOS_ZERO_COPY, e.g. when a buffer holds more than one
+					MSS. */
+					ulDataGot = ( uint32_t ) prvTCPCopyTxData( pxSocket, uxOffset, pucSendData, ( size_t ) lDataLen );
+				}
+				#else
+				{
+					ulDataGot = ( uint32_t ) uxStreamBufferGet( pxSocket->u.xTCP.txStream, uxOffset, pucSendData, ( size_t ) lDataLen, pdTRUE );
+				}
+				#endif
 
 				#if( ipconfigHAS_DEBUG_PRINTF != 0 )
 				{
@@ -1833,7 +1924,7 @@ int32_t lStreamPos;
 							pxSocket->u.xTCP.usRemotePort,
 							pxSocket->u.xTCP.ucKeepRepCount ) );
 					pxSocket->u.xTCP.bits.bSendKeepAlive = pdTRUE_UNSIGNED;
-					pxSocket->u.xTCP.usTimeout = ( ( uint16_t ) pdMS_TO_TICKS( 2500 ) );
+					vSocketSetTCPTimer( pxSocket, pdMS_TO_TICKS( 2500 ) );
 					pxSocket->u.xTCP.ucKeepRepCount++;
 				}
 			}
@@ -1896,7 +1987,7 @@ TickType_t ulDelayMs = ( TickType_t ) tcpMAXIMUM_TCP_WAKEUP_TIME_MS;
 		FreeRTOS_debug_printf( ( "Connect[%lxip:%u]: next timeout %u: %lu ms\n",
 			pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort,
 			pxSocket->u.xTCP.ucRepCount, ulDelayMs ) );
-		pxSocket->u.xTCP.usTimeout = ( uint16_t )pdMS_TO_MIN_TICKS( ulDelayMs );
+		vSocketSetTCPTimer( pxSocket, ( uint16_t )pdMS_TO_MIN_TICKS( ulDelayMs ) );
 	}
 	else if( pxSocket->u.xTCP.usTimeout == 0u )
 	{
@@ -1917,7 +2008,7 @@ TickType_t ulDelayMs = ( TickType_t ) tcpMAXIMUM_TCP_WAKEUP_TIME_MS;
 		{
 			/* ulDelayMs contains the time to wait before a re-transmission. */
 		}
-		pxSocket->u.xTCP.usTimeout = ( uint16_t )pdMS_TO_MIN_TICKS( ulDelayMs );
+		vSocketSetTCPTimer( pxSocket, ( uint16_t )pdMS_TO_MIN_TICKS( ulDelayMs ) );
 	}
 	else
 	{
@@ -1933,6 +2024,9 @@ TickType_t ulDelayMs = ( TickType_t ) tcpMAXIMUM_TCP_WAKEUP_TIME_MS;
 static void prvTCPAddTxData( FreeRTOS_Socket_t *pxSocket )
 {
 int32_t lCount, lLength;
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+	int32_t lOffset, lStart, lFragmentLength, lAdded;
+#endif
 
 	/* A txStream has been created already, see if the socket has new data for
 	the sliding window.
@@ -1942,6 +2036,65 @@ int32_t lCount, lLength;
 	data not-yet-confirmed can be found at rxTail. */
 	lLength = ( int32_t ) uxStreamBufferMidSpace( pxSocket->u.xTCP.txStream );
 
+	#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+	{
+		/* The data of a buffer passed with FREERTOS_ZERO_COPY must get segments
+		of its own, so that the buffer can be sent as it is.  Hand it over
+		separately, and make sure that the sliding window doesn't add other
+		data to its segment. */
+		while( lLength > 0 )
+		{
+			lOffset = ( int32_t ) uxStreamBufferDistance( pxSocket->u.xTCP.txStream, pxSocket->u.xTCP.txStream->uxTail, pxSocket->u.xTCP.txStream->uxMid );
+
+			if( prvTCPFindTxFragment( pxSocket, lOffset, &lStart, &lFragmentLength ) == NULL )
+			{
+				/* Only ordinary data is left. */
+				break;
+			}
+
+			if( lStart > lOffset )
+			{
+				/* Ordinary data up to the start of the buffer. */
+				lCount = FreeRTOS_min_int32( lLength, lStart - lOffset );
+			}
+			else
+			{
+				if( lStart == lOffset )
+				{
+					pxSocket->u.xTCP.xTCPWindow.pxHeadSegment = NULL;
+				}
+
+				lCount = FreeRTOS_min_int32( lLength, ( lStart + lFragmentLength ) - lOffset );
+			}
+
+			lAdded = lTCPWindowTxAdd( &pxSocket->u.xTCP.xTCPWindow,
+									  ( uint32_t ) lCount,
+									  ( int32_t ) pxSocket->u.xTCP.txStream->uxMid,
+									  ( int32_t ) pxSocket->u.xTCP.txStream->LENGTH );
+
+			if( lAdded > 0 )
+			{
+				vStreamBufferMoveMid( pxSocket->u.xTCP.txStream, ( size_t ) lAdded );
+			}
+
+			if( lAdded < lCount )
+			{
+				/* Out of segments, try again later. */
+				lLength = 0;
+				break;
+			}
+
+			if( ( lStart <= lOffset ) && ( ( lOffset + lAdded ) == ( lStart + lFragmentLength ) ) )
+			{
+				/* The end of the buffer has been reached. */
+				pxSocket->u.xTCP.xTCPWindow.pxHeadSegment = NULL;
+			}
+
+			lLength -= lAdded;
+		}
+	}
+	#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 	if( lLength > 0 )
 	{
 		/* All data between txMid and rxHead will now be passed to the sliding
@@ -1964,6 +2117,202 @@ int32_t lCount, lLength;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+
+	static int32_t prvTCPTxFragmentOffset( FreeRTOS_Socket_t *pxSocket, const ListItem_t *pxItem )
+	{
+	const StreamBuffer_t *pxStream = pxSocket->u.xTCP.txStream;
+	int32_t lOffset;
+
+		lOffset = ( int32_t ) uxStreamBufferDistance( pxStream, pxStream->uxTail, ( size_t ) listGET_LIST_ITEM_VALUE( pxItem ) );
+
+		if( lOffset > ( int32_t ) uxStreamBufferGetSize( pxStream ) )
+		{
+			/* The buffer starts before the tail: the first part of its data has
+			been acknowledged and removed from the stream already. */
+			lOffset -= ( int32_t ) pxStream->LENGTH;
+		}
+
+		return lOffset;
+	}
+	/*-----------------------------------------------------------*/
+
+	static NetworkBufferDescriptor_t *prvTCPFindTxFragment( FreeRTOS_Socket_t *pxSocket, int32_t lOffset,
+		int32_t *plStart, int32_t *plLength )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t *pxEnd = ( const MiniListItem_t * ) listGET_END_MARKER( &( pxSocket->u.xTCP.xTxFragments ) );
+	NetworkBufferDescriptor_t *pxReturn = NULL, *pxBuffer;
+
+		/* FreeRTOS_send() adds buffers to the list from the user's task. */
+		vTaskSuspendAll();
+		{
+			for( pxIterator = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+				 pxIterator != ( const ListItem_t * ) pxEnd;
+				 pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+			{
+				pxBuffer = ( NetworkBufferDescriptor_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+				*plStart = prvTCPTxFragmentOffset( pxSocket, pxIterator );
+				*plLength = ( int32_t ) ( pxBuffer->xDataLength - ipTCP_PAYLOAD_OFFSET );
+
+				if( ( *plStart + *plLength ) > lOffset )
+				{
+					pxReturn = pxBuffer;
+					break;
+				}
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return pxReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static size_t prvTCPCopyTxData( FreeRTOS_Socket_t *pxSocket, size_t uxOffset, uint8_t *pucTarget, size_t uxCount )
+	{
+	NetworkBufferDescriptor_t *pxFragment;
+	int32_t lStart, lLength, lOffset;
+	size_t uxDone = 0u, uxChunk;
+
+		while( uxDone < uxCount )
+		{
+			lOffset = ( int32_t ) ( uxOffset + uxDone );
+			pxFragment = prvTCPFindTxFragment( pxSocket, lOffset, &lStart, &lLength );
+
+			if( ( pxFragment != NULL ) && ( lStart <= lOffset ) )
+			{
+				/* The data is in a buffer passed with FREERTOS_ZERO_COPY. */
+				uxChunk = FreeRTOS_min_uint32( uxCount - uxDone, ( uint32_t ) ( ( lStart + lLength ) - lOffset ) );
+				memcpy( pucTarget + uxDone, pxFragment->pucEthernetBuffer + ipTCP_PAYLOAD_OFFSET + ( lOffset - lStart ), uxChunk );
+			}
+			else
+			{
+				/* The data is in txStream, up to the next buffer, if any. */
+				uxChunk = uxCount - uxDone;
+
+				if( pxFragment != NULL )
+				{
+					uxChunk = FreeRTOS_min_uint32( uxChunk, ( uint32_t ) ( lStart - lOffset ) );
+				}
+
+				uxChunk = uxStreamBufferGet( pxSocket->u.xTCP.txStream, ( size_t ) lOffset, pucTarget + uxDone, uxChunk, pdTRUE );
+
+				if( uxChunk == 0u )
+				{
+					break;
+				}
+			}
+
+			uxDone += uxChunk;
+		}
+
+		return uxDone;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPSendTxFragment( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxFragment,
+		const uint8_t *pucHeaders, int32_t lStreamPos, int32_t lDataLen )
+	{
+	TCPPacket_t *pxTCPPacket = ( TCPPacket_t * ) ( pxFragment->pucEthernetBuffer );
+	TCPWindow_t *pxTCPWindow = &( pxSocket->u.xTCP.xTCPWindow );
+	size_t uxFrameLength = ipTCP_PAYLOAD_OFFSET + ( size_t ) lDataLen;
+	uint32_t ulDistance;
+
+		/* Put the headers in front of the data, which stays where the
+		application has written it. */
+		memcpy( pxFragment->pucEthernetBuffer, pucHeaders, ipTCP_PAYLOAD_OFFSET );
+		pxTCPPacket->xTCPHeader.ucTCPFlags |= ( uint8_t ) ( ipTCP_FLAG_ACK | ipTCP_FLAG_PSH );
+		pxTCPPacket->xTCPHeader.ucTCPOffset = ( uint8_t ) ( ipSIZE_OF_TCP_HEADER << 2 );
+
+		/* If the owner of the socket requests a closure, add the FIN flag to
+		the last packet, like prvTCPPrepareSend() does. */
+		if( ( pxSocket->u.xTCP.bits.bCloseRequested != pdFALSE_UNSIGNED ) && ( pxSocket->u.xTCP.bits.bFinSent == pdFALSE_UNSIGNED ) )
+		{
+			ulDistance = ( uint32_t ) uxStreamBufferDistance( pxSocket->u.xTCP.txStream, ( size_t ) lStreamPos, pxSocket->u.xTCP.txStream->uxHead );
+
+			if( ulDistance == ( uint32_t ) lDataLen )
+			{
+				pxTCPPacket->xTCPHeader.ucTCPFlags |= ipTCP_FLAG_FIN;
+				pxTCPWindow->tx.ulFINSequenceNumber = pxTCPWindow->ulOurSequenceNumber + ( uint32_t ) lDataLen;
+				pxSocket->u.xTCP.bits.bFinSent = pdTRUE_UNSIGNED;
+			}
+		}
+
+		/* The socket keeps the buffer for a retransmission, a zero-copy driver
+		will get a duplicate. */
+		pxFragment->xDataLength = uxFrameLength;
+		prvTCPReturnPacket( pxSocket, pxFragment, ( uint32_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ) + ( uint32_t ) lDataLen, pdFALSE );
+
+		/* The length may have been padded to the minimum packet size, but it
+		is used to find the length of the data. */
+		pxFragment->xDataLength = uxFrameLength;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPAckTxFragments( FreeRTOS_Socket_t *pxSocket, uint32_t ulCount )
+	{
+	NetworkBufferDescriptor_t *pxFragment;
+	List_t *pxList = &( pxSocket->u.xTCP.xTxFragments );
+
+		do
+		{
+			pxFragment = NULL;
+
+			vTaskSuspendAll();
+			{
+				if( listLIST_IS_EMPTY( pxList ) == pdFALSE )
+				{
+					pxFragment = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList );
+
+					if( ( prvTCPTxFragmentOffset( pxSocket, listGET_HEAD_ENTRY( pxList ) ) + ( int32_t ) ( pxFragment->xDataLength - ipTCP_PAYLOAD_OFFSET ) ) <= ( int32_t ) ulCount )
+					{
+						( void ) uxListRemove( &( pxFragment->xBufferListItem ) );
+					}
+					else
+					{
+						pxFragment = NULL;
+					}
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			if( pxFragment != NULL )
+			{
+				vReleaseNetworkBufferAndDescriptor( pxFragment );
+			}
+		} while( pxFragment != NULL );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTCPReleaseTxFragments( FreeRTOS_Socket_t *pxSocket )
+	{
+	NetworkBufferDescriptor_t *pxFragment;
+	List_t *pxList = &( pxSocket->u.xTCP.xTxFragments );
+
+		do
+		{
+			pxFragment = NULL;
+
+			vTaskSuspendAll();
+			{
+				if( listLIST_IS_EMPTY( pxList ) == pdFALSE )
+				{
+					pxFragment = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList );
+					( void ) uxListRemove( &( pxFragment->xBufferListItem ) );
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			if( pxFragment != NULL )
+			{
+				vReleaseNetworkBufferAndDescriptor( pxFragment );
+			}
+		} while( pxFragment != NULL );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigUSE_TCP_ZERO_COPY_TX */
+
 /*
  * prvTCPHandleFin() will be called to handle socket closure
  * The Closure starts when either a FIN has been received and accepted,
@@ -2398,9 +2747,15 @@ int32_t lDistance, lSendResult;
 			confirmed, and because there is new space in the txStream, the
 			user/owner should be woken up. */
 			/* _HT_ : only in case the socket's waiting? */
+			#if( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+			{
+				prvTCPAckTxFragments( pxSocket, ulCount );
+			}
+			#endif
 			if( uxStreamBufferGet( pxSocket->u.xTCP.txStream, 0u, NULL, ( size_t ) ulCount, pdFALSE ) != 0u )
 			{
 				pxSocket->xEventBits |= eSOCKET_SEND;
+				vSocketWakeUpUserLater( pxSocket );
 
 				#if ipconfigSUPPORT_SELECT_FUNCTION == 1
 				{
@@ -2575,14 +2930,14 @@ int32_t lRxSpace;
 			if( ( ulReceiveLength < ( uint32_t ) pxSocket->u.xTCP.usCurMSS ) ||	/* Received a small message. */
 				( lRxSpace < ( int32_t ) ( 2U * pxSocket->u.xTCP.usCurMSS ) ) )	/* There are less than 2 x MSS space in the Rx buffer. */
 			{
-				pxSocket->u.xTCP.usTimeout = ( uint16_t ) pdMS_TO_MIN_TICKS( DELAYED_ACK_SHORT_DELAY_MS );
+				vSocketSetTCPTimer( pxSocket, pdMS_TO_MIN_TICKS( DELAYED_ACK_SHORT_DELAY_MS ) );
 			}
 			else
 			{
 				/* Normally a delayed ACK should wait 200 ms for a next incoming
 				packet.  Only wait 20 ms here to gain performance.  A slow ACK
 				for full-size message. */
-				pxSocket->u.xTCP.usTimeout = ( uint16_t ) pdMS_TO_MIN_TICKS( DELAYED_ACK_LONGER_DELAY_MS );
+				vSocketSetTCPTimer( pxSocket, pdMS_TO_MIN_TICKS( DELAYED_ACK_LONGER_DELAY_MS ) );
 			}
 
 			if( ( xTCPWindowLoggingLevel > 1 ) && ( ipconfigTCP_MAY_LOG_PORT( pxSocket->usLocalPort ) != pdFALSE ) )
@@ -3182,6 +3537,13 @@ uint32_t ulInitialSequenceNumber;
 		pxReturn->u.xTCP.ulRemoteIP = FreeRTOS_htonl( pxTCPPacket->xIPHeader.ulSourceIPAddress );
 		pxReturn->u.xTCP.xTCPWindow.ulOurSequenceNumber = ulInitialSequenceNumber;
 
+		#if( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+		{
+			/* The socket is now known by its peer's address and port. */
+			vSocketUpdateTCPHash( pxReturn );
+		}
+		#endif /* ipconfigUSE_TCP_SOCKET_HASH */
+
 		/* Here is the SYN action. */
 		pxReturn->u.xTCP.xTCPWindow.rx.ulCurrentSequenceNumber = FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulSequenceNumber );
 		prvSocketSetMSS( pxReturn );
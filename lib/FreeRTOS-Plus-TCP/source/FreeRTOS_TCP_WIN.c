@@ -88,6 +88,33 @@
 	#define MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW		( 4u )
 
 #endif /* configUSE_TCP_WIN */
+
+#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+
+	/* The initial congestion window, RFC 3390:
+	 * min( 4 * MSS, max( 2 * MSS, 4380 bytes ) ). */
+	#define winCC_INITIAL_WINDOW_BYTES		( 4380UL )
+
+	/* The slow start threshold starts 'arbitrarily high'. */
+	#define winCC_INITIAL_SSTHRESH			( 0x7FFFFFFFUL )
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL */
+
+#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+
+	/* CUBIC: after a loss, cwnd is multiplied by beta = 0.7.  The constant C,
+	 * which determines the aggressiveness of the window growth, equals 0.4.
+	 * W_cubic( t ) = C * ( t - K )^3 + W_max, with t and K in seconds and the
+	 * windows in segments. */
+	#define winCUBIC_BETA_NUM				( 7UL )
+	#define winCUBIC_BETA_DEN				( 10UL )
+	#define winCUBIC_C_NUM					( 4ULL )
+	#define winCUBIC_C_DEN					( 10ULL )
+
+	/* Keep ( t - K )^3 well within 64 bits: limit | t - K | to 100 seconds. */
+	#define winCUBIC_MAX_OFFSET_MS			( 100000LL )
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC */
 /*-----------------------------------------------------------*/
 
 extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewListItem, MiniListItem_t * const pxWhere );
@@ -193,10 +220,77 @@ extern void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
  * A higher Tx block has been acknowledged.  Now iterate through the xWaitQueue
  * to find a possible condition for a FAST retransmission.
  */
-#if( ipconfigUSE_TCP_WIN == 1 )
+#if( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_TCP_SACK_SCOREBOARD == 0 )
 	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow, uint32_t ulFirst );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
+/*
+ * SACK scoreboard: new SACK information was received.  Every outstanding
+ * segment with enough SACK'd data above it is considered lost and moved to the
+ * priority queue.  Returns the number of segments that were found lost.
+ */
+#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+	static uint32_t prvTCPWindowTxScoreboard( TCPWindow_t *pxWindow );
+#endif
+
+/*
+ * SACK scoreboard: estimate the number of bytes in flight, i.e. the data that
+ * has been sent and that has neither been SACK'd nor been considered lost,
+ * plus the retransmissions.
+ */
+#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 ) && ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+	static uint32_t prvTCPWindowPipe( TCPWindow_t *pxWindow );
+#endif
+
+/*
+ * SACK scoreboard: returns pdTRUE if the pipe leaves room in cwnd for one more
+ * retransmission from the priority queue.  Outside loss recovery it always
+ * returns pdTRUE.
+ */
+#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 ) && ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+	static BaseType_t prvTCPWindowPipeHasSpace( TCPWindow_t *pxWindow );
+#endif
+
+/*
+ * Congestion control: set the initial values of cwnd and ssthresh.
+ */
+#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+	static void prvTCPWindowCongestionInit( TCPWindow_t *pxWindow );
+#endif
+
+/*
+ * Congestion control: a loss has been detected, either by a fast retransmission
+ * ( xTimeout == pdFALSE ) or by an expired retransmission timer.  Lower ssthresh
+ * and cwnd.
+ */
+#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+	static void prvTCPWindowCongestionEvent( TCPWindow_t *pxWindow, BaseType_t xTimeout );
+#endif
+
+/*
+ * Congestion control: the left side of the transmission window has advanced by
+ * 'ulBytesConfirmed' bytes.  Open cwnd, or handle a (partial) ACK during fast
+ * recovery.
+ */
+#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+	static void prvTCPWindowCongestionAck( TCPWindow_t *pxWindow, uint32_t ulBytesConfirmed );
+#endif
+
+/*
+ * CUBIC: the window that should be reached at this moment according to the
+ * cubic function.
+ */
+#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+	static uint32_t prvTCPWindowCubicTarget( TCPWindow_t *pxWindow );
+#endif
+
+/*
+ * CUBIC: integer cube root, rounded down.
+ */
+#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+	static uint32_t prvCubeRoot( uint64_t ullValue );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* TCP segment pool. */
@@ -670,6 +764,12 @@ const int32_t l500ms = 500;
 	/* The right-hand side of the transmit window. */
 	pxWindow->tx.ulHighestSequenceNumber = ulSequenceNumber;
 	pxWindow->ulOurSequenceNumber = ulSequenceNumber;
+
+	#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+	{
+		prvTCPWindowCongestionInit( pxWindow );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -1187,6 +1287,31 @@ const int32_t l500ms = 500;
 			{
 				xHasSpace = pdFALSE;
 			}
+
+			#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+			{
+			uint32_t ulInFlight = ulTxOutstanding;
+
+				#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+				{
+					/* During loss recovery, SACK'd and lost segments have left
+					the network. */
+					if( pxWindow->u.bits.bFastRecovery != pdFALSE_UNSIGNED )
+					{
+						ulInFlight = prvTCPWindowPipe( pxWindow );
+					}
+				}
+				#endif
+
+				/* The congestion window limits the outstanding data in the
+				same way.  One segment may always be sent when nothing is
+				outstanding. */
+				if( ( ulTxOutstanding != 0UL ) && ( pxWindow->ulCongestionWindow < ulInFlight + ( ( uint32_t ) pxSegment->lDataLength ) ) )
+				{
+					xHasSpace = pdFALSE;
+				}
+			}
+			#endif
 		}
 
 		return xHasSpace;
@@ -1200,12 +1325,18 @@ const int32_t l500ms = 500;
 	BaseType_t xTCPWindowTxHasData( TCPWindow_t *pxWindow, uint32_t ulWindowSize, TickType_t *pulDelay )
 	{
 	TCPSegment_t *pxSegment;
-	BaseType_t xReturn;
+	BaseType_t xReturn, xPriority;
 	TickType_t ulAge, ulMaxAge;
 
 		*pulDelay = 0u;
 
-		if( listLIST_IS_EMPTY( &pxWindow->xPriorityQueue ) == pdFALSE )
+		#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 ) && ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+			xPriority = ( listLIST_IS_EMPTY( &pxWindow->xPriorityQueue ) == pdFALSE ) && ( prvTCPWindowPipeHasSpace( pxWindow ) != pdFALSE );
+		#else
+			xPriority = ( listLIST_IS_EMPTY( &pxWindow->xPriorityQueue ) == pdFALSE );
+		#endif
+
+		if( xPriority != pdFALSE )
 		{
 			/* No need to look at retransmissions or new transmission as long as
 			there are priority segments.  *pulDelay equals zero, meaning it must
@@ -1283,8 +1414,25 @@ const int32_t l500ms = 500;
 		/* Fetches data to be sent-out now.
 
 		Priority messages: segments with a resend need no check current sliding
-		window size. */
-		pxSegment = xTCPWindowGetHead( &( pxWindow->xPriorityQueue ) );
+		window size.  During SACK based loss recovery, they are limited by the
+		pipe, so that a burst of holes does not overflow the bottleneck once
+		more. */
+		#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 ) && ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+		{
+			if( prvTCPWindowPipeHasSpace( pxWindow ) != pdFALSE )
+			{
+				pxSegment = xTCPWindowGetHead( &( pxWindow->xPriorityQueue ) );
+			}
+			else
+			{
+				pxSegment = NULL;
+			}
+		}
+		#else
+		{
+			pxSegment = xTCPWindowGetHead( &( pxWindow->xPriorityQueue ) );
+		}
+		#endif
 		pxWindow->ulOurSequenceNumber = pxWindow->tx.ulHighestSequenceNumber;
 
 		if( pxSegment == NULL )
@@ -1306,6 +1454,27 @@ const int32_t l500ms = 500;
 					pxSegment = xTCPWindowGetHead( &( pxWindow->xWaitQueue ) );
 					pxSegment->u.bits.ucDupAckCount = pdFALSE_UNSIGNED;
 
+					#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+					{
+						/* The segment is being repaired, SACK's that arrive
+						later must not retransmit it once more. */
+						pxSegment->u.bits.bLost = pdTRUE_UNSIGNED;
+					}
+					#endif
+
+					#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+					{
+						/* A retransmission time-out for the oldest outstanding
+						segment.  Only the first time-out of a segment lowers
+						ssthresh, repeated time-outs leave it unchanged. */
+						if( ( pxSegment->ulSequenceNumber == pxWindow->tx.ulCurrentSequenceNumber ) &&
+							( pxSegment->u.bits.ucTransmitCount == 1u ) )
+						{
+							prvTCPWindowCongestionEvent( pxWindow, pdTRUE );
+						}
+					}
+					#endif
+
 					/* Some detailed logging. */
 					if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != 0 ) )
 					{
@@ -1409,17 +1578,23 @@ const int32_t l500ms = 500;
 			( pxSegment->u.bits.ucTransmitCount )++;
 
 			/* If there have been several retransmissions (4), decrease the
-			size of the transmission window to at most 2 times MSS. */
-			if( pxSegment->u.bits.ucTransmitCount == MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW )
+			size of the transmission window to at most 2 times MSS.  Not with
+			congestion control: cwnd shrinks after a loss and grows back,
+			whereas this reduction lasts for the rest of the connection. */
+			#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_NONE )
 			{
-				if( pxWindow->xSize.ulTxWindowLength > ( 2U * pxWindow->usMSS ) )
+				if( pxSegment->u.bits.ucTransmitCount == MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW )
 				{
-					FreeRTOS_debug_printf( ( "ulTCPWindowTxGet[%u - %d]: Change Tx window: %lu -> %u\n",
-						pxWindow->usPeerPortNumber, pxWindow->usOurPortNumber,
-						pxWindow->xSize.ulTxWindowLength, 2 * pxWindow->usMSS ) );
-					pxWindow->xSize.ulTxWindowLength = ( 2UL * pxWindow->usMSS );
+					if( pxWindow->xSize.ulTxWindowLength > ( 2U * pxWindow->usMSS ) )
+					{
+						FreeRTOS_debug_printf( ( "ulTCPWindowTxGet[%u - %d]: Change Tx window: %lu -> %u\n",
+							pxWindow->usPeerPortNumber, pxWindow->usOurPortNumber,
+							pxWindow->xSize.ulTxWindowLength, 2 * pxWindow->usMSS ) );
+						pxWindow->xSize.ulTxWindowLength = ( 2UL * pxWindow->usMSS );
+					}
 				}
 			}
+			#endif
 
 			/* Clear the transmit timer. */
 			vTCPTimerSet( &( pxSegment->xTransmitTimer ) );
@@ -1590,7 +1765,7 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigUSE_TCP_WIN == 1 )
+#if( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigUSE_TCP_SACK_SCOREBOARD == 0 )
 
 	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow, uint32_t ulFirst )
 	{
@@ -1648,6 +1823,143 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+
+	static uint32_t prvTCPWindowTxScoreboard( TCPWindow_t *pxWindow )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t *pxEnd = ( const MiniListItem_t * ) listGET_END_MARKER( &( pxWindow->xTxSegments ) );
+	TCPSegment_t *pxSegment;
+	uint32_t ulSackedBytes = 0UL, ulSackedCount = 0UL, ulLostCount = 0UL;
+	const uint32_t ulLostBytes = ( DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT - 1u ) * ( uint32_t ) pxWindow->usMSS;
+
+		/* RFC 6675 IsLost(): a segment is lost when at least 'DupThresh'
+		segments, or more than ( DupThresh - 1 ) * MSS bytes, above it have
+		been SACK'd.  xTxSegments is sorted on sequence number and a segment
+		that has been SACK'd has 'bAcked' set, so it is the scoreboard.  First
+		count all SACK'd data, then walk from the left side of the window and
+		subtract what has been passed: the remainder lies above the current
+		segment. */
+		for( pxIterator = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+			 pxIterator != ( const ListItem_t * ) pxEnd;
+			 pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			pxSegment = ( TCPSegment_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			if( pxSegment->u.bits.bAcked != pdFALSE_UNSIGNED )
+			{
+				ulSackedBytes += ( uint32_t ) pxSegment->lDataLength;
+				ulSackedCount++;
+			}
+		}
+
+		for( pxIterator = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+			 ( pxIterator != ( const ListItem_t * ) pxEnd ) && ( ulSackedCount != 0UL );
+			 pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			pxSegment = ( TCPSegment_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			if( pxSegment->u.bits.bAcked != pdFALSE_UNSIGNED )
+			{
+				ulSackedBytes -= ( uint32_t ) pxSegment->lDataLength;
+				ulSackedCount--;
+			}
+			else if( ( pxSegment->u.bits.bLost == pdFALSE_UNSIGNED ) &&
+					 ( listLIST_ITEM_CONTAINER( &( pxSegment->xQueueItem ) ) == &( pxWindow->xWaitQueue ) ) &&
+					 ( ( ulSackedCount >= DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT ) || ( ulSackedBytes > ulLostBytes ) ) )
+			{
+				/* An outstanding segment that is lost.  A segment is only
+				declared lost once: if its retransmission gets lost as well, it
+				will be repaired by the retransmission timer. */
+				pxSegment->u.bits.bLost = pdTRUE_UNSIGNED;
+				pxSegment->u.bits.ucTransmitCount = pdFALSE_UNSIGNED;
+
+				if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
+				{
+					FreeRTOS_debug_printf( ( "prvTCPWindowTxScoreboard: Lost sequence number %lu (%lu bytes SACK'd above)\n",
+						pxSegment->ulSequenceNumber - pxWindow->tx.ulFirstSequenceNumber,
+						ulSackedBytes ) );
+				}
+
+				/* Move it from xWaitQueue to the priority queue.  The list
+				is walked in order, so the holes will be retransmitted from
+				left to right. */
+				uxListRemove( &pxSegment->xQueueItem );
+				vListInsertFifo( &( pxWindow->xPriorityQueue ), &( pxSegment->xQueueItem ) );
+				ulLostCount++;
+			}
+			else
+			{
+				/* Not lost, or already being repaired. */
+			}
+		}
+
+		return ulLostCount;
+	}
+
+#endif /* ipconfigUSE_TCP_SACK_SCOREBOARD != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 ) && ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+
+	static uint32_t prvTCPWindowPipe( TCPWindow_t *pxWindow )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t *pxEnd = ( const MiniListItem_t * ) listGET_END_MARKER( &( pxWindow->xTxSegments ) );
+	TCPSegment_t *pxSegment;
+	uint32_t ulPipe = 0UL;
+
+		/* RFC 6675 SetPipe(), per segment in stead of per byte. */
+		for( pxIterator = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+			 pxIterator != ( const ListItem_t * ) pxEnd;
+			 pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+			pxSegment = ( TCPSegment_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			if( ( pxSegment->u.bits.bOutstanding != pdFALSE_UNSIGNED ) && ( pxSegment->u.bits.bAcked == pdFALSE_UNSIGNED ) )
+			{
+				/* Sent and not SACK'd.  A lost segment only counts when its
+				retransmission is on its way, i.e. when it has left the
+				priority queue. */
+				if( ( pxSegment->u.bits.bLost == pdFALSE_UNSIGNED ) ||
+					( listLIST_ITEM_CONTAINER( &( pxSegment->xQueueItem ) ) == &( pxWindow->xWaitQueue ) ) )
+				{
+					ulPipe += ( uint32_t ) pxSegment->lDataLength;
+				}
+			}
+		}
+
+		return ulPipe;
+	}
+
+#endif /* ipconfigUSE_TCP_SACK_SCOREBOARD && ipconfigTCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 ) && ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+
+	static BaseType_t prvTCPWindowPipeHasSpace( TCPWindow_t *pxWindow )
+	{
+	uint32_t ulPipe;
+	BaseType_t xReturn = pdTRUE;
+
+		if( pxWindow->u.bits.bFastRecovery != pdFALSE_UNSIGNED )
+		{
+			/* RFC 6675: while ( cwnd - pipe ) >= 1 SMSS, a segment may be
+			sent.  When the pipe is empty, one segment may always be sent. */
+			ulPipe = prvTCPWindowPipe( pxWindow );
+
+			if( ( ulPipe != 0UL ) && ( pxWindow->ulCongestionWindow < ulPipe + ( uint32_t ) pxWindow->usMSS ) )
+			{
+				xReturn = pdFALSE;
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigUSE_TCP_SACK_SCOREBOARD && ipconfigTCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP_WIN == 1 )
 
 	uint32_t ulTCPWindowTxAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber )
@@ -1661,10 +1973,34 @@ const int32_t l500ms = 500;
 		if( xSequenceLessThanOrEqual( ulSequenceNumber, ulFirstSequence ) != pdFALSE )
 		{
 			ulReturn = 0UL;
+
+			#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE ) && ( ipconfigUSE_TCP_SACK_SCOREBOARD == 0 )
+			{
+				/* During fast recovery, every duplicate ACK means that a
+				segment has left the network: inflate cwnd by one MSS.  The
+				SACK scoreboard keeps track of this in the 'pipe'. */
+				if( ( pxWindow->u.bits.bFastRecovery != pdFALSE_UNSIGNED ) &&
+					( ulSequenceNumber == ulFirstSequence ) &&
+					( pxWindow->tx.ulHighestSequenceNumber != ulFirstSequence ) &&
+					( pxWindow->ulCongestionWindow < pxWindow->xSize.ulTxWindowLength ) )
+				{
+					pxWindow->ulCongestionWindow += pxWindow->usMSS;
+				}
+			}
+			#endif
 		}
 		else
 		{
 			ulReturn = prvTCPWindowTxCheckAck( pxWindow, ulFirstSequence, ulSequenceNumber );
+
+			#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+			{
+				if( ulReturn != 0UL )
+				{
+					prvTCPWindowCongestionAck( pxWindow, ulReturn );
+				}
+			}
+			#endif
 		}
 
 		return ulReturn;
@@ -1677,12 +2013,44 @@ const int32_t l500ms = 500;
 
 	uint32_t ulTCPWindowTxSack( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast )
 	{
-	uint32_t ulAckCount = 0UL;
+	uint32_t ulAckCount = 0UL, ulLost;
 	uint32_t ulCurrentSequenceNumber = pxWindow->tx.ulCurrentSequenceNumber;
 
 		/* Receive a SACK option. */
 		ulAckCount = prvTCPWindowTxCheckAck( pxWindow, ulFirst, ulLast );
-		prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+
+		#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+		{
+			/* The SACK'd segments are now marked in xTxSegments, see which
+			holes must be repaired. */
+			ulLost = prvTCPWindowTxScoreboard( pxWindow );
+		}
+		#else
+		{
+			ulLost = prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+		}
+		#endif
+
+		#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+		{
+			if( ulAckCount != 0UL )
+			{
+				prvTCPWindowCongestionAck( pxWindow, ulAckCount );
+			}
+
+			/* The first fast retransmission starts fast recovery.  Losses
+			that are detected during the recovery belong to the same
+			congestion event. */
+			if( ( ulLost != 0UL ) && ( pxWindow->u.bits.bFastRecovery == pdFALSE_UNSIGNED ) )
+			{
+				prvTCPWindowCongestionEvent( pxWindow, pdFALSE );
+			}
+		}
+		#else
+		{
+			( void ) ulLost;
+		}
+		#endif
 
 		if( ( xTCPWindowLoggingLevel >= 1 ) && ( xSequenceGreaterThan( ulFirst, ulCurrentSequenceNumber ) != pdFALSE ) )
 		{
@@ -1701,6 +2069,336 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+
+	static void prvTCPWindowCongestionInit( TCPWindow_t *pxWindow )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+
+		/* Initial window, RFC 3390. */
+		pxWindow->ulCongestionWindow = FreeRTOS_min_uint32( 4UL * ulMSS, FreeRTOS_max_uint32( 2UL * ulMSS, winCC_INITIAL_WINDOW_BYTES ) );
+		pxWindow->ulSlowStartThreshold = winCC_INITIAL_SSTHRESH;
+		pxWindow->ulBytesAcked = 0UL;
+		pxWindow->ulRecoverySequenceNumber = pxWindow->tx.ulHighestSequenceNumber;
+
+		#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+		{
+			pxWindow->ulCubicMaxWindow = 0UL;
+			pxWindow->ulCubicK = 0UL;
+			pxWindow->ulCubicRenoWindow = 0UL;
+			pxWindow->xCubicEpochStart = 0u;
+		}
+		#endif
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+
+	static void prvTCPWindowCongestionEvent( TCPWindow_t *pxWindow, BaseType_t xTimeout )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+	uint32_t ulFlightSize, ulThreshold;
+
+		/* FlightSize: the amount of data that has been sent but not yet
+		cumulatively acknowledged. */
+		if( xSequenceGreaterThan( pxWindow->tx.ulHighestSequenceNumber, pxWindow->tx.ulCurrentSequenceNumber ) != pdFALSE )
+		{
+			ulFlightSize = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+		}
+		else
+		{
+			ulFlightSize = 0UL;
+		}
+
+		#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+		{
+			/* Fast convergence: if cwnd did not grow back to the previous
+			W_max, another flow probably claimed bandwidth.  Release some more
+			by lowering W_max to ( 1 + beta ) / 2 times cwnd. */
+			if( pxWindow->ulCongestionWindow < pxWindow->ulCubicMaxWindow )
+			{
+				pxWindow->ulCubicMaxWindow = ( pxWindow->ulCongestionWindow * ( winCUBIC_BETA_DEN + winCUBIC_BETA_NUM ) ) / ( 2UL * winCUBIC_BETA_DEN );
+			}
+			else
+			{
+				pxWindow->ulCubicMaxWindow = pxWindow->ulCongestionWindow;
+			}
+
+			/* A new epoch starts with the first ACK in congestion avoidance. */
+			pxWindow->u.bits.bCubicEpoch = pdFALSE_UNSIGNED;
+			ulThreshold = ( ulFlightSize / winCUBIC_BETA_DEN ) * winCUBIC_BETA_NUM;
+		}
+		#else
+		{
+			ulThreshold = ulFlightSize / 2UL;
+		}
+		#endif
+
+		pxWindow->ulSlowStartThreshold = FreeRTOS_max_uint32( ulThreshold, 2UL * ulMSS );
+		pxWindow->ulBytesAcked = 0UL;
+
+		if( xTimeout != pdFALSE )
+		{
+			/* After a time-out, start all over again with slow start. */
+			pxWindow->ulCongestionWindow = ulMSS;
+			pxWindow->u.bits.bFastRecovery = pdFALSE_UNSIGNED;
+		}
+		else
+		{
+			/* Fast recovery: the 3 segments that caused the duplicate ACK's
+			have left the network, so cwnd is inflated by 3 * MSS.  With the
+			SACK scoreboard, the pipe accounts for them.  Recovery ends when
+			everything sent up till now has been ACK'd. */
+			#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+			{
+				pxWindow->ulCongestionWindow = pxWindow->ulSlowStartThreshold;
+			}
+			#else
+			{
+				pxWindow->ulCongestionWindow = pxWindow->ulSlowStartThreshold + ( 3UL * ulMSS );
+			}
+			#endif
+			pxWindow->ulRecoverySequenceNumber = pxWindow->tx.ulHighestSequenceNumber;
+			pxWindow->u.bits.bFastRecovery = pdTRUE_UNSIGNED;
+		}
+
+		if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) != pdFALSE ) )
+		{
+			FreeRTOS_debug_printf( ( "prvTCPWindowCongestionEvent[%u,%u]: %s flight %lu ssthresh %lu cwnd %lu\n",
+				pxWindow->usPeerPortNumber,
+				pxWindow->usOurPortNumber,
+				( xTimeout != pdFALSE ) ? "RTO" : "fast rexmit",
+				ulFlightSize,
+				pxWindow->ulSlowStartThreshold,
+				pxWindow->ulCongestionWindow ) );
+		}
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+
+	static void prvTCPWindowCongestionAck( TCPWindow_t *pxWindow, uint32_t ulBytesConfirmed )
+	{
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+	uint32_t ulFlightSize;
+
+		if( pxWindow->u.bits.bFastRecovery != pdFALSE_UNSIGNED )
+		{
+			if( xSequenceGreaterThanOrEqual( pxWindow->tx.ulCurrentSequenceNumber, pxWindow->ulRecoverySequenceNumber ) != pdFALSE )
+			{
+				/* A full ACK: all data that was outstanding when the loss was
+				detected has been confirmed.  Deflate cwnd and leave fast
+				recovery, RFC 6582 option 1. */
+				ulFlightSize = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+				pxWindow->ulCongestionWindow = FreeRTOS_min_uint32( pxWindow->ulSlowStartThreshold, FreeRTOS_max_uint32( ulFlightSize, ulMSS ) + ulMSS );
+				pxWindow->u.bits.bFastRecovery = pdFALSE_UNSIGNED;
+			}
+			else
+			{
+			TCPSegment_t *pxSegment;
+
+				/* A partial ACK.  The segment that follows the data just
+				confirmed was lost as well.  Retransmit it right away in stead
+				of waiting for more SACK's or for its time-out.  With the
+				scoreboard, this repairs holes near the end of the window,
+				which have too little data SACK'd above them. */
+				pxSegment = xTCPWindowPeekHead( &( pxWindow->xTxSegments ) );
+
+				if( ( pxSegment != NULL ) &&
+					( pxSegment->ulSequenceNumber == pxWindow->tx.ulCurrentSequenceNumber ) &&
+					( pxSegment->u.bits.bAcked == pdFALSE_UNSIGNED ) &&
+					( pxSegment->u.bits.bLost == pdFALSE_UNSIGNED ) &&
+					( listLIST_ITEM_CONTAINER( &( pxSegment->xQueueItem ) ) == &( pxWindow->xWaitQueue ) ) )
+				{
+					#if( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+					{
+						pxSegment->u.bits.bLost = pdTRUE_UNSIGNED;
+					}
+					#endif
+					pxSegment->u.bits.ucTransmitCount = pdFALSE_UNSIGNED;
+					uxListRemove( &pxSegment->xQueueItem );
+					vListInsertFifo( &( pxWindow->xPriorityQueue ), &( pxSegment->xQueueItem ) );
+				}
+
+				/* Deflate cwnd by the amount of new data that was ACK'd, and
+				add back one MSS if that was at least one segment.  The
+				scoreboard does not inflate cwnd, it limits the pipe. */
+				#if( ipconfigUSE_TCP_SACK_SCOREBOARD == 0 )
+				{
+					pxWindow->ulCongestionWindow -= FreeRTOS_min_uint32( pxWindow->ulCongestionWindow - ulMSS, ulBytesConfirmed );
+
+					if( ulBytesConfirmed >= ulMSS )
+					{
+						pxWindow->ulCongestionWindow += ulMSS;
+					}
+				}
+				#endif
+			}
+		}
+		else if( pxWindow->ulCongestionWindow < pxWindow->ulSlowStartThreshold )
+		{
+			/* Slow start: open cwnd with at most one MSS per ACK, which
+			doubles it every round-trip. */
+			pxWindow->ulCongestionWindow += FreeRTOS_min_uint32( ulBytesConfirmed, ulMSS );
+		}
+		else
+		{
+			#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+			{
+			uint32_t ulTarget;
+			uint64_t ullIncrement;
+
+				if( pxWindow->u.bits.bCubicEpoch == pdFALSE_UNSIGNED )
+				{
+					/* Start a new epoch.  K is the time it takes to grow from
+					cwnd back to W_max: K = cbrt( ( W_max - cwnd ) / C ), with
+					the windows in segments and K in seconds. */
+					pxWindow->u.bits.bCubicEpoch = pdTRUE_UNSIGNED;
+					pxWindow->xCubicEpochStart = xTaskGetTickCount();
+					pxWindow->ulCubicRenoWindow = pxWindow->ulCongestionWindow;
+
+					if( pxWindow->ulCongestionWindow < pxWindow->ulCubicMaxWindow )
+					{
+						pxWindow->ulCubicK = prvCubeRoot( ( ( uint64_t ) ( pxWindow->ulCubicMaxWindow - pxWindow->ulCongestionWindow ) * winCUBIC_C_DEN * 1000000000ULL ) /
+							( winCUBIC_C_NUM * ulMSS ) );
+					}
+					else
+					{
+						pxWindow->ulCubicK = 0UL;
+						pxWindow->ulCubicMaxWindow = pxWindow->ulCongestionWindow;
+					}
+				}
+
+				/* W_est: in the TCP-friendly region, CUBIC grows at least as
+				fast as NewReno would, using alpha = 3 * ( 1 - beta ) / ( 1 + beta )
+				segments per round-trip. */
+				pxWindow->ulCubicRenoWindow += ( uint32_t ) ( ( ( uint64_t ) ( 3UL * ( winCUBIC_BETA_DEN - winCUBIC_BETA_NUM ) ) * ulMSS * ulBytesConfirmed ) /
+					( ( uint64_t ) ( winCUBIC_BETA_DEN + winCUBIC_BETA_NUM ) * pxWindow->ulCongestionWindow ) );
+
+				ulTarget = FreeRTOS_max_uint32( prvTCPWindowCubicTarget( pxWindow ), pxWindow->ulCubicRenoWindow );
+
+				/* Never grow faster than 1.5 times cwnd per round-trip. */
+				ulTarget = FreeRTOS_min_uint32( ulTarget, pxWindow->ulCongestionWindow + ( pxWindow->ulCongestionWindow / 2UL ) );
+
+				if( ulTarget > pxWindow->ulCongestionWindow )
+				{
+					/* Spread the growth to 'ulTarget' over one round-trip. */
+					ullIncrement = ( ( uint64_t ) ( ulTarget - pxWindow->ulCongestionWindow ) * ulBytesConfirmed ) / pxWindow->ulCongestionWindow;
+					pxWindow->ulCongestionWindow += ( uint32_t ) ullIncrement;
+				}
+			}
+			#else
+			{
+				/* Congestion avoidance: one MSS per round-trip, i.e. each time
+				a full cwnd of data has been ACK'd. */
+				pxWindow->ulBytesAcked += ulBytesConfirmed;
+
+				if( pxWindow->ulBytesAcked >= pxWindow->ulCongestionWindow )
+				{
+					pxWindow->ulBytesAcked -= pxWindow->ulCongestionWindow;
+					pxWindow->ulCongestionWindow += ulMSS;
+				}
+			}
+			#endif
+		}
+
+		/* A cwnd beyond the socket's own transmission window would have no
+		effect, other than making the next reduction less effective. */
+		if( pxWindow->ulCongestionWindow > pxWindow->xSize.ulTxWindowLength )
+		{
+			pxWindow->ulCongestionWindow = FreeRTOS_max_uint32( pxWindow->xSize.ulTxWindowLength, ulMSS );
+		}
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+
+	static uint32_t prvTCPWindowCubicTarget( TCPWindow_t *pxWindow )
+	{
+	int64_t llOffset;
+	uint64_t ullCube, ullDelta;
+	uint32_t ulReturn;
+
+		/* W_cubic( t + RTT ): the window that should be reached one round-trip
+		from now.  'llOffset' is ( t + RTT - K ) in ms. */
+		llOffset = ( int64_t ) ( ( xTaskGetTickCount() - pxWindow->xCubicEpochStart ) * portTICK_PERIOD_MS );
+		llOffset += ( int64_t ) pxWindow->lSRTT - ( int64_t ) pxWindow->ulCubicK;
+
+		if( llOffset > winCUBIC_MAX_OFFSET_MS )
+		{
+			llOffset = winCUBIC_MAX_OFFSET_MS;
+		}
+		else if( llOffset < -winCUBIC_MAX_OFFSET_MS )
+		{
+			llOffset = -winCUBIC_MAX_OFFSET_MS;
+		}
+
+		ullCube = ( uint64_t ) ( ( llOffset < 0 ) ? -llOffset : llOffset );
+		ullCube = ullCube * ullCube * ullCube;
+
+		/* C * ( t - K )^3 segments, with ( t - K ) in ms: divide by 10^9. */
+		ullDelta = ( ( ullCube / 1000ULL ) * winCUBIC_C_NUM * pxWindow->usMSS ) / ( winCUBIC_C_DEN * 1000000ULL );
+
+		if( llOffset >= 0 )
+		{
+			if( ullDelta < ( uint64_t ) ( winCC_INITIAL_SSTHRESH - pxWindow->ulCubicMaxWindow ) )
+			{
+				ulReturn = pxWindow->ulCubicMaxWindow + ( uint32_t ) ullDelta;
+			}
+			else
+			{
+				/* Saturate, the caller limits the growth anyway. */
+				ulReturn = winCC_INITIAL_SSTHRESH;
+			}
+		}
+		else if( ullDelta < ( uint64_t ) pxWindow->ulCubicMaxWindow )
+		{
+			ulReturn = pxWindow->ulCubicMaxWindow - ( uint32_t ) ullDelta;
+		}
+		else
+		{
+			ulReturn = 0UL;
+		}
+
+		return ulReturn;
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC )
+
+	static uint32_t prvCubeRoot( uint64_t ullValue )
+	{
+	uint64_t ullResult = 0ULL, ullBits;
+	int32_t lShift;
+
+		/* Bit-wise cube root: determine one bit of the result per 3 bits of
+		the value, starting at the most significant end. */
+		for( lShift = 63; lShift >= 0; lShift -= 3 )
+		{
+			ullResult <<= 1;
+			ullBits = ( 3ULL * ullResult * ( ullResult + 1ULL ) ) + 1ULL;
+
+			if( ( ullValue >> lShift ) >= ullBits )
+			{
+				ullValue -= ullBits << lShift;
+				ullResult++;
+			}
+		}
+
+		return ( uint32_t ) ullResult;
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL == ipTCP_CONGESTION_CUBIC */
+/*-----------------------------------------------------------*/
+
 /*
 #####   #                      #####   ####  ######
 # # #   #                      # # #  #    #  #    #
@@ -281,6 +281,13 @@ UBaseType_t uxCount;
 				}
 				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
 
+				#if( ipconfigDRIVER_REPORTS_RX_CHECKSUM != 0 )
+				{
+					/* Nothing has been verified yet. */
+					pxReturn->ucChecksumFlags = 0u;
+				}
+				#endif /* ipconfigDRIVER_REPORTS_RX_CHECKSUM */
+
 				if( xTCPWindowLoggingLevel > 3 )
 				{
 					FreeRTOS_debug_printf( ( "BUF_GET[%ld]: %p (%p)\n",
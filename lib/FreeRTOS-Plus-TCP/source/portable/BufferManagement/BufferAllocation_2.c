@@ -279,6 +279,13 @@ size_t uxCount;
 					pxReturn->pxNextBuffer = NULL;
 				}
 				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+				#if( ipconfigDRIVER_REPORTS_RX_CHECKSUM != 0 )
+				{
+					/* Nothing has been verified yet. */
+					pxReturn->ucChecksumFlags = 0u;
+				}
+				#endif /* ipconfigDRIVER_REPORTS_RX_CHECKSUM */
 			}
 		}
 		else
@@ -0,0 +1,743 @@
+/*
+ * FreeRTOS+TCP V2.0.10
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/******************************************************************************
+ *
+ * BufferAllocation_3.c: network buffers taken from pre-allocated slabs.
+ *
+ * The Ethernet buffers are divided in three size classes, of which the sizes
+ * and the number of buffers are set in FreeRTOSIPConfig.h:
+ *
+ *     ipconfigBUFFER_ALLOC_3_SMALL_SIZE / _COUNT      default 128 bytes
+ *     ipconfigBUFFER_ALLOC_3_MEDIUM_SIZE / _COUNT     default 512 bytes
+ *     ipconfigBUFFER_ALLOC_3_LARGE_SIZE / _COUNT      default ipTOTAL_ETHERNET_FRAME_SIZE
+ *
+ * A request is served by the smallest class that is large enough.  When that
+ * class is empty, a larger class is used.  Unlike BufferAllocation_2.c, the
+ * heap is never used, so it can not be fragmented by network traffic.
+ *
+ * The free descriptors and the free buffers of each class are kept on
+ * lock-free stacks.  No semaphore or critical section is used, so a driver can
+ * obtain and release buffers from an interrupt without delaying tasks, and
+ * vice versa.  A task that asks for a buffer with a block time polls once per
+ * tick until one is released.
+ *
+ * The stacks need a 32-bit compare-and-swap.  With GCC or Clang it is used
+ * when the target has one, which excludes e.g. the Cortex-M0.  Otherwise the
+ * swap is done with interrupts masked, which is very short but not lock-free.
+ *
+ * xGetNetworkBufferClassStats() reports, for each class, the number of
+ * buffers in use, the high-water mark and the number of times the class was
+ * found empty.
+ *
+ ******************************************************************************/
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_UDP_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+
+#ifndef ipconfigBUFFER_ALLOC_3_SMALL_SIZE
+	#define ipconfigBUFFER_ALLOC_3_SMALL_SIZE		128u
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_3_SMALL_COUNT
+	#define ipconfigBUFFER_ALLOC_3_SMALL_COUNT		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_3_MEDIUM_SIZE
+	#define ipconfigBUFFER_ALLOC_3_MEDIUM_SIZE		512u
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_3_MEDIUM_COUNT
+	#define ipconfigBUFFER_ALLOC_3_MEDIUM_COUNT		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 4 )
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_3_LARGE_SIZE
+	#define ipconfigBUFFER_ALLOC_3_LARGE_SIZE		ipTOTAL_ETHERNET_FRAME_SIZE
+#endif
+
+#ifndef ipconfigBUFFER_ALLOC_3_LARGE_COUNT
+	#define ipconfigBUFFER_ALLOC_3_LARGE_COUNT		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#endif
+
+/* The obtained network buffer must be large enough to hold a packet that might
+replace the packet that was requested to be sent. */
+#if ipconfigUSE_TCP == 1
+	#define baMINIMAL_BUFFER_SIZE		sizeof( TCPPacket_t )
+#else
+	#define baMINIMAL_BUFFER_SIZE		sizeof( ARPPacket_t )
+#endif /* ipconfigUSE_TCP == 1 */
+
+/* For an Ethernet interrupt to be able to obtain a network buffer there must
+be at least this number of descriptors available. */
+#define baINTERRUPT_BUFFER_GET_THRESHOLD	( 3 )
+
+#define baCLASS_COUNT			( 3 )
+
+/* Round up to a multiple of 8 bytes, the alignment of every slot. */
+#define baROUND_UP_8( x )		( ( ( x ) + 7u ) & ~( ( size_t ) 7u ) )
+
+/* A slot holds the pointer back to the descriptor, the padding, and the
+Ethernet frame. */
+#define baSLOT_SIZE( xSize )	baROUND_UP_8( ( size_t ) ( xSize ) + ipBUFFER_PADDING )
+
+#define baSTORAGE_SIZE			( ( baSLOT_SIZE( ipconfigBUFFER_ALLOC_3_SMALL_SIZE ) * ipconfigBUFFER_ALLOC_3_SMALL_COUNT ) + \
+								  ( baSLOT_SIZE( ipconfigBUFFER_ALLOC_3_MEDIUM_SIZE ) * ipconfigBUFFER_ALLOC_3_MEDIUM_COUNT ) + \
+								  ( baSLOT_SIZE( ipconfigBUFFER_ALLOC_3_LARGE_SIZE ) * ipconfigBUFFER_ALLOC_3_LARGE_COUNT ) )
+
+/* The head of a stack holds a tag in the upper 16 bits and the index plus one
+of the top entry in the lower 16 bits, 0 meaning empty.  The tag changes with
+every push and pop, so that a pop which was interrupted by a pop and a push of
+the same entry (the ABA problem) fails and retries. */
+#define baSTACK_EMPTY			( 0u )
+#define baSTACK_INDEX_MASK		( 0xffffUL )
+#define baSTACK_TAG_INCREMENT	( 0x10000UL )
+
+#define ASSERT_CONCAT_(a, b) a##b
+#define ASSERT_CONCAT(a, b) ASSERT_CONCAT_(a, b)
+#define STATIC_ASSERT(e) \
+	;enum { ASSERT_CONCAT(assert_line_, __LINE__) = 1/(!!(e)) }
+
+#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+	STATIC_ASSERT( ipconfigETHERNET_MINIMUM_PACKET_BYTES <= baMINIMAL_BUFFER_SIZE );
+#endif
+
+/* The classes are ordered by size, the largest can hold a complete frame. */
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_3_SMALL_SIZE < ipconfigBUFFER_ALLOC_3_MEDIUM_SIZE );
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_3_MEDIUM_SIZE < ipconfigBUFFER_ALLOC_3_LARGE_SIZE );
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_3_LARGE_SIZE >= ipTOTAL_ETHERNET_FRAME_SIZE );
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_3_LARGE_COUNT > 0 );
+
+/* Indexes must fit in the lower 16 bits of a stack head. */
+STATIC_ASSERT( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS < baSTACK_INDEX_MASK );
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_3_SMALL_COUNT < baSTACK_INDEX_MASK );
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_3_MEDIUM_COUNT < baSTACK_INDEX_MASK );
+STATIC_ASSERT( ipconfigBUFFER_ALLOC_3_LARGE_COUNT < baSTACK_INDEX_MASK );
+
+/* A lock-free stack of the indexes 0 .. n-1. */
+typedef struct xFREE_STACK
+{
+	volatile uint32_t ulHead;		/* Tag and index + 1 of the top entry. */
+	volatile uint16_t *pusNext;		/* For each entry: index + 1 of the entry below it. */
+} FreeStack_t;
+
+typedef struct xBUFFER_CLASS
+{
+	FreeStack_t xFree;				/* The free slots. */
+	uint8_t *pucStorage;			/* The first slot. */
+	size_t uxSlotSize;				/* Bytes from one slot to the next. */
+	size_t uxBufferSize;			/* Bytes available for the Ethernet frame. */
+	UBaseType_t uxCount;			/* Number of slots. */
+	volatile uint32_t ulInUse;
+	volatile uint32_t ulHighWaterMark;
+	volatile uint32_t ulAllocations;
+	volatile uint32_t ulFailures;
+} BufferClass_t;
+
+/*
+ * Atomically replace '*pulTarget' with 'ulDesired' if it still equals
+ * 'ulExpected'.  Returns pdTRUE when it was replaced.
+ */
+static portINLINE BaseType_t prvCompareAndSwap( volatile uint32_t *pulTarget, uint32_t ulExpected, uint32_t ulDesired );
+
+/*
+ * Atomically add 'ulValue' to '*pulTarget', returns the new value.
+ */
+static uint32_t prvAtomicAdd( volatile uint32_t *pulTarget, uint32_t ulValue );
+
+/*
+ * Push an index on a stack, or pop one.  prvStackPop() returns pdFALSE when
+ * the stack is empty.
+ */
+static void prvStackPush( FreeStack_t *pxStack, UBaseType_t uxIndex );
+static BaseType_t prvStackPop( FreeStack_t *pxStack, UBaseType_t *puxIndex );
+
+/*
+ * Take a slot for a frame of 'xSize' bytes from the smallest class that has
+ * one.  Returns NULL if all suitable classes are empty.
+ */
+static uint8_t *prvTakeSlot( size_t xSize );
+
+/*
+ * Find the class and the index of a slot.  Returns NULL if the pointer does
+ * not belong to any class.
+ */
+static BufferClass_t *prvFindClass( const uint8_t *pucSlot, UBaseType_t *puxIndex );
+
+/*
+ * Take a descriptor and a buffer without blocking.  When 'xFromISR' is
+ * pdTRUE, the last baINTERRUPT_BUFFER_GET_THRESHOLD descriptors are left for
+ * the tasks.
+ */
+static NetworkBufferDescriptor_t *prvGetNetworkBuffer( size_t xRequestedSizeBytes, BaseType_t xFromISR );
+
+/*-----------------------------------------------------------*/
+
+/* The descriptors, and the stack of free descriptors. */
+static NetworkBufferDescriptor_t xNetworkBufferDescriptors[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+static volatile uint16_t usDescriptorNext[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+static FreeStack_t xFreeDescriptors;
+
+/* pdTRUE for a descriptor that is in use, to detect a double release. */
+static volatile uint32_t ulDescriptorInUse[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The number of free descriptors, and the lowest number seen. */
+static volatile uint32_t ulFreeDescriptors;
+static volatile uint32_t ulMinimumFreeDescriptors;
+
+/* The slabs: the slots of all classes, aligned on 8 bytes. */
+static uint64_t ullStorage[ baSTORAGE_SIZE / sizeof( uint64_t ) ];
+
+/* The links of the free slots of each class.  One entry is added so that the
+arrays are not empty when a class has no buffers. */
+static volatile uint16_t usSmallNext[ ipconfigBUFFER_ALLOC_3_SMALL_COUNT + 1 ];
+static volatile uint16_t usMediumNext[ ipconfigBUFFER_ALLOC_3_MEDIUM_COUNT + 1 ];
+static volatile uint16_t usLargeNext[ ipconfigBUFFER_ALLOC_3_LARGE_COUNT + 1 ];
+
+static BufferClass_t xClasses[ baCLASS_COUNT ];
+
+static BaseType_t xHasInit = pdFALSE;
+
+/* This constant is defined as false to let FreeRTOS_TCP_IP.c know that the
+network buffers have a variable size: resizing may be necessary */
+const BaseType_t xBufferAllocFixedSize = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+#if defined( __GNUC__ ) && defined( __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4 )
+
+	static portINLINE BaseType_t prvCompareAndSwap( volatile uint32_t *pulTarget, uint32_t ulExpected, uint32_t ulDesired )
+	{
+		return __atomic_compare_exchange_n( pulTarget, &ulExpected, ulDesired, pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) ? pdTRUE : pdFALSE;
+	}
+
+#else
+
+	static portINLINE BaseType_t prvCompareAndSwap( volatile uint32_t *pulTarget, uint32_t ulExpected, uint32_t ulDesired )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+	BaseType_t xReturn = pdFALSE;
+
+		/* No compare-and-swap instruction: mask the interrupts for the few
+		instructions needed.  This may be called from tasks and from
+		interrupts. */
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( *pulTarget == ulExpected )
+			{
+				*pulTarget = ulDesired;
+				xReturn = pdTRUE;
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return xReturn;
+	}
+
+#endif /* __GCC_HAVE_SYNC_COMPARE_AND_SWAP_4 */
+/*-----------------------------------------------------------*/
+
+static uint32_t prvAtomicAdd( volatile uint32_t *pulTarget, uint32_t ulValue )
+{
+uint32_t ulOld;
+
+	do
+	{
+		ulOld = *pulTarget;
+	} while( prvCompareAndSwap( pulTarget, ulOld, ulOld + ulValue ) == pdFALSE );
+
+	return ulOld + ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStackPush( FreeStack_t *pxStack, UBaseType_t uxIndex )
+{
+uint32_t ulHead;
+
+	do
+	{
+		ulHead = pxStack->ulHead;
+		pxStack->pusNext[ uxIndex ] = ( uint16_t ) ( ulHead & baSTACK_INDEX_MASK );
+	} while( prvCompareAndSwap( &( pxStack->ulHead ), ulHead,
+		( ( ulHead & ~baSTACK_INDEX_MASK ) + baSTACK_TAG_INCREMENT ) | ( ( uint32_t ) uxIndex + 1UL ) ) == pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStackPop( FreeStack_t *pxStack, UBaseType_t *puxIndex )
+{
+uint32_t ulHead, ulTop;
+BaseType_t xReturn = pdFALSE;
+
+	for( ;; )
+	{
+		ulHead = pxStack->ulHead;
+		ulTop = ulHead & baSTACK_INDEX_MASK;
+
+		if( ulTop == baSTACK_EMPTY )
+		{
+			break;
+		}
+
+		/* 'pusNext[]' may have been changed by another pop and push since the
+		head was read, but then the tag has changed as well and the swap
+		fails. */
+		if( prvCompareAndSwap( &( pxStack->ulHead ), ulHead,
+			( ( ulHead & ~baSTACK_INDEX_MASK ) + baSTACK_TAG_INCREMENT ) | pxStack->pusNext[ ulTop - 1UL ] ) != pdFALSE )
+		{
+			*puxIndex = ( UBaseType_t ) ( ulTop - 1UL );
+			xReturn = pdTRUE;
+			break;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkBuffersInitialise( void )
+{
+static volatile uint16_t * const pusNext[ baCLASS_COUNT ] = { usSmallNext, usMediumNext, usLargeNext };
+static const size_t uxSizes[ baCLASS_COUNT ] = { ipconfigBUFFER_ALLOC_3_SMALL_SIZE, ipconfigBUFFER_ALLOC_3_MEDIUM_SIZE, ipconfigBUFFER_ALLOC_3_LARGE_SIZE };
+static const UBaseType_t uxCounts[ baCLASS_COUNT ] = { ipconfigBUFFER_ALLOC_3_SMALL_COUNT, ipconfigBUFFER_ALLOC_3_MEDIUM_COUNT, ipconfigBUFFER_ALLOC_3_LARGE_COUNT };
+uint8_t *pucStorage = ( uint8_t * ) ullStorage;
+BufferClass_t *pxClass;
+UBaseType_t uxClass, x;
+
+	/* Only initialise the buffers if they have not been initialised before. */
+	if( xHasInit == pdFALSE )
+	{
+		xFreeDescriptors.ulHead = baSTACK_EMPTY;
+		xFreeDescriptors.pusNext = usDescriptorNext;
+
+		for( x = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; x > 0u; x-- )
+		{
+			/* Initialise and set the owner of the buffer list items, the
+			sockets use them to queue received packets. */
+			xNetworkBufferDescriptors[ x - 1u ].pucEthernetBuffer = NULL;
+			vListInitialiseItem( &( xNetworkBufferDescriptors[ x - 1u ].xBufferListItem ) );
+			listSET_LIST_ITEM_OWNER( &( xNetworkBufferDescriptors[ x - 1u ].xBufferListItem ), &xNetworkBufferDescriptors[ x - 1u ] );
+			ulDescriptorInUse[ x - 1u ] = pdFALSE;
+			prvStackPush( &xFreeDescriptors, x - 1u );
+		}
+
+		ulFreeDescriptors = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+		ulMinimumFreeDescriptors = ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+
+		for( uxClass = 0; uxClass < baCLASS_COUNT; uxClass++ )
+		{
+			pxClass = &( xClasses[ uxClass ] );
+			memset( pxClass, 0, sizeof( *pxClass ) );
+			pxClass->xFree.ulHead = baSTACK_EMPTY;
+			pxClass->xFree.pusNext = pusNext[ uxClass ];
+			pxClass->pucStorage = pucStorage;
+			pxClass->uxBufferSize = uxSizes[ uxClass ];
+			pxClass->uxSlotSize = baSLOT_SIZE( uxSizes[ uxClass ] );
+			pxClass->uxCount = uxCounts[ uxClass ];
+
+			/* Push in reverse, so the first slots are used first. */
+			for( x = pxClass->uxCount; x > 0u; x-- )
+			{
+				prvStackPush( &( pxClass->xFree ), x - 1u );
+			}
+
+			pucStorage += pxClass->uxSlotSize * pxClass->uxCount;
+		}
+
+		xHasInit = pdTRUE;
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t *prvTakeSlot( size_t xSize )
+{
+BufferClass_t *pxClass;
+UBaseType_t uxClass, uxIndex;
+uint32_t ulInUse, ulHighWaterMark;
+uint8_t *pucReturn = NULL;
+
+	for( uxClass = 0; uxClass < baCLASS_COUNT; uxClass++ )
+	{
+		pxClass = &( xClasses[ uxClass ] );
+
+		if( pxClass->uxBufferSize < xSize )
+		{
+			continue;
+		}
+
+		if( prvStackPop( &( pxClass->xFree ), &uxIndex ) == pdFALSE )
+		{
+			/* The class is empty, try the next larger one. */
+			( void ) prvAtomicAdd( &( pxClass->ulFailures ), 1UL );
+			continue;
+		}
+
+		( void ) prvAtomicAdd( &( pxClass->ulAllocations ), 1UL );
+		ulInUse = prvAtomicAdd( &( pxClass->ulInUse ), 1UL );
+
+		do
+		{
+			ulHighWaterMark = pxClass->ulHighWaterMark;
+		} while( ( ulInUse > ulHighWaterMark ) &&
+				 ( prvCompareAndSwap( &( pxClass->ulHighWaterMark ), ulHighWaterMark, ulInUse ) == pdFALSE ) );
+
+		pucReturn = pxClass->pucStorage + ( uxIndex * pxClass->uxSlotSize );
+		break;
+	}
+
+	return pucReturn;
+}
+/*-----------------------------------------------------------*/
+
+static BufferClass_t *prvFindClass( const uint8_t *pucSlot, UBaseType_t *puxIndex )
+{
+BufferClass_t *pxReturn = NULL;
+UBaseType_t uxClass;
+size_t uxOffset;
+
+	for( uxClass = 0; uxClass < baCLASS_COUNT; uxClass++ )
+	{
+		if( ( pucSlot >= xClasses[ uxClass ].pucStorage ) &&
+			( pucSlot < xClasses[ uxClass ].pucStorage + ( xClasses[ uxClass ].uxSlotSize * xClasses[ uxClass ].uxCount ) ) )
+		{
+			uxOffset = ( size_t ) ( pucSlot - xClasses[ uxClass ].pucStorage );
+			configASSERT( ( uxOffset % xClasses[ uxClass ].uxSlotSize ) == 0u );
+			*puxIndex = ( UBaseType_t ) ( uxOffset / xClasses[ uxClass ].uxSlotSize );
+			pxReturn = &( xClasses[ uxClass ] );
+			break;
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t *pucGetNetworkBuffer( size_t *pxRequestedSizeBytes )
+{
+uint8_t *pucEthernetBuffer;
+size_t xSize = *pxRequestedSizeBytes;
+
+	if( xSize < baMINIMAL_BUFFER_SIZE )
+	{
+		/* Buffers must be at least large enough to hold a TCP-packet with
+		headers, or an ARP packet, in case TCP is not included. */
+		xSize = baMINIMAL_BUFFER_SIZE;
+	}
+
+	/* The slots are aligned already, unlike BufferAllocation_2.c the size is
+	not rounded up: a complete frame must fit in the largest class. */
+	*pxRequestedSizeBytes = xSize;
+
+	pucEthernetBuffer = prvTakeSlot( xSize );
+
+	if( pucEthernetBuffer != NULL )
+	{
+		/* Enough space is left at the start of the buffer to place a pointer to
+		the network buffer structure that references this Ethernet buffer.
+		Return a pointer to the start of the Ethernet buffer itself. */
+		pucEthernetBuffer += ipBUFFER_PADDING;
+	}
+
+	return pucEthernetBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBuffer( uint8_t *pucEthernetBuffer )
+{
+BufferClass_t *pxClass;
+UBaseType_t uxIndex;
+
+	if( pucEthernetBuffer != NULL )
+	{
+		pxClass = prvFindClass( pucEthernetBuffer - ipBUFFER_PADDING, &uxIndex );
+		configASSERT( pxClass != NULL );
+
+		if( pxClass != NULL )
+		{
+			( void ) prvAtomicAdd( &( pxClass->ulInUse ), ( uint32_t ) -1 );
+			prvStackPush( &( pxClass->xFree ), uxIndex );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static NetworkBufferDescriptor_t *prvGetNetworkBuffer( size_t xRequestedSizeBytes, BaseType_t xFromISR )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+UBaseType_t uxIndex;
+uint32_t ulFree, ulMinimum;
+uint8_t *pucSlot;
+
+	if( ( xFromISR != pdFALSE ) && ( ulFreeDescriptors <= ( uint32_t ) baINTERRUPT_BUFFER_GET_THRESHOLD ) )
+	{
+		/* Leave the last descriptors to the tasks, so that a rapidly
+		executing interrupt can not exhaust them. */
+	}
+	else if( prvStackPop( &xFreeDescriptors, &uxIndex ) != pdFALSE )
+	{
+		pxReturn = &( xNetworkBufferDescriptors[ uxIndex ] );
+		ulDescriptorInUse[ uxIndex ] = pdTRUE;
+		ulFree = prvAtomicAdd( &ulFreeDescriptors, ( uint32_t ) -1 );
+
+		/* For stats, latch the lowest number of network buffers since
+		booting. */
+		do
+		{
+			ulMinimum = ulMinimumFreeDescriptors;
+		} while( ( ulFree < ulMinimum ) &&
+				 ( prvCompareAndSwap( &ulMinimumFreeDescriptors, ulMinimum, ulFree ) == pdFALSE ) );
+
+		configASSERT( pxReturn->pucEthernetBuffer == NULL );
+
+		if( xRequestedSizeBytes > 0u )
+		{
+			pucSlot = prvTakeSlot( xRequestedSizeBytes );
+
+			if( pucSlot == NULL )
+			{
+				/* No class can hold the frame, the descriptor can not be
+				used either. */
+				vReleaseNetworkBufferAndDescriptor( pxReturn );
+				pxReturn = NULL;
+			}
+			else
+			{
+				/* Store a pointer to the network buffer structure in the
+				buffer storage area, then move the buffer pointer on past the
+				stored pointer so the pointer value is not overwritten by the
+				application when the buffer is used. */
+				*( ( NetworkBufferDescriptor_t ** ) pucSlot ) = pxReturn;
+				pxReturn->pucEthernetBuffer = pucSlot + ipBUFFER_PADDING;
+
+				/* Store the requested size, like BufferAllocation_2.c does. */
+				pxReturn->xDataLength = xRequestedSizeBytes;
+
+				#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+				{
+					/* make sure the buffer is not linked */
+					pxReturn->pxNextBuffer = NULL;
+				}
+				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+				#if( ipconfigDRIVER_REPORTS_RX_CHECKSUM != 0 )
+				{
+					/* Nothing has been verified yet. */
+					pxReturn->ucChecksumFlags = 0u;
+				}
+				#endif /* ipconfigDRIVER_REPORTS_RX_CHECKSUM */
+			}
+		}
+		else
+		{
+			/* A descriptor is being returned without an associated buffer being
+			allocated. */
+		}
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes, TickType_t xBlockTimeTicks )
+{
+NetworkBufferDescriptor_t *pxReturn;
+TimeOut_t xTimeOut;
+
+	if( ( xRequestedSizeBytes != 0u ) && ( xRequestedSizeBytes < ( size_t ) baMINIMAL_BUFFER_SIZE ) )
+	{
+		/* ARP packets can replace application packets, so the storage must be
+		at least large enough to hold an ARP. */
+		xRequestedSizeBytes = baMINIMAL_BUFFER_SIZE;
+	}
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		pxReturn = prvGetNetworkBuffer( xRequestedSizeBytes, pdFALSE );
+
+		if( ( pxReturn != NULL ) || ( xTaskCheckForTimeOut( &xTimeOut, &xBlockTimeTicks ) != pdFALSE ) )
+		{
+			break;
+		}
+
+		/* There is no semaphore to wait on, poll until a buffer has been
+		released or the block time has passed. */
+		vTaskDelay( 1u );
+	}
+
+	if( pxReturn == NULL )
+	{
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
+	}
+	else
+	{
+		iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
+{
+NetworkBufferDescriptor_t *pxReturn;
+
+	if( ( xRequestedSizeBytes != 0u ) && ( xRequestedSizeBytes < ( size_t ) baMINIMAL_BUFFER_SIZE ) )
+	{
+		xRequestedSizeBytes = baMINIMAL_BUFFER_SIZE;
+	}
+
+	pxReturn = prvGetNetworkBuffer( xRequestedSizeBytes, pdTRUE );
+
+	if( pxReturn == NULL )
+	{
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
+	}
+	else
+	{
+		iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+UBaseType_t uxIndex = ( UBaseType_t ) ( pxNetworkBuffer - xNetworkBufferDescriptors );
+
+	configASSERT( uxIndex < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS );
+
+	/* Only release a descriptor that is in use, a second release of the same
+	descriptor is ignored, like in BufferAllocation_2.c. */
+	if( prvCompareAndSwap( &( ulDescriptorInUse[ uxIndex ] ), pdTRUE, pdFALSE ) != pdFALSE )
+	{
+		vReleaseNetworkBuffer( pxNetworkBuffer->pucEthernetBuffer );
+		pxNetworkBuffer->pucEthernetBuffer = NULL;
+
+		( void ) prvAtomicAdd( &ulFreeDescriptors, 1UL );
+		prvStackPush( &xFreeDescriptors, uxIndex );
+	}
+
+	iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+	/* Nothing is locked and no task is woken, a task that waits for a buffer
+	polls. */
+	vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
+{
+	return ( UBaseType_t ) ulFreeDescriptors;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
+{
+	return ( UBaseType_t ) ulMinimumFreeDescriptors;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer, size_t xNewSizeBytes )
+{
+BufferClass_t *pxClass;
+UBaseType_t uxIndex;
+size_t xOriginalLength;
+uint8_t *pucBuffer;
+
+	pxClass = prvFindClass( pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING, &uxIndex );
+	configASSERT( pxClass != NULL );
+
+	if( ( pxClass != NULL ) && ( xNewSizeBytes <= pxClass->uxBufferSize ) )
+	{
+		/* The slot is large enough already. */
+		pxNetworkBuffer->xDataLength = xNewSizeBytes;
+	}
+	else
+	{
+		pucBuffer = pucGetNetworkBuffer( &( xNewSizeBytes ) );
+
+		if( pucBuffer == NULL )
+		{
+			/* In case the allocation fails, return NULL. */
+			pxNetworkBuffer = NULL;
+		}
+		else
+		{
+			xOriginalLength = pxNetworkBuffer->xDataLength + ipBUFFER_PADDING;
+			pxNetworkBuffer->xDataLength = xNewSizeBytes;
+
+			/* Copy the data and the pointer back to the descriptor. */
+			memcpy( pucBuffer - ipBUFFER_PADDING, pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING, xOriginalLength );
+			vReleaseNetworkBuffer( pxNetworkBuffer->pucEthernetBuffer );
+			pxNetworkBuffer->pucEthernetBuffer = pucBuffer;
+		}
+	}
+
+	return pxNetworkBuffer;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetNetworkBufferClassStats( UBaseType_t uxClass, NetworkBufferClassStats_t *pxStats )
+{
+BaseType_t xReturn = pdFALSE;
+
+	if( uxClass < baCLASS_COUNT )
+	{
+		pxStats->uxBufferSize = xClasses[ uxClass ].uxBufferSize;
+		pxStats->uxBufferCount = xClasses[ uxClass ].uxCount;
+		pxStats->uxInUse = ( UBaseType_t ) xClasses[ uxClass ].ulInUse;
+		pxStats->uxHighWaterMark = ( UBaseType_t ) xClasses[ uxClass ].ulHighWaterMark;
+		pxStats->ulAllocations = xClasses[ uxClass ].ulAllocations;
+		pxStats->ulFailures = xClasses[ uxClass ].ulFailures;
+		xReturn = pdTRUE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
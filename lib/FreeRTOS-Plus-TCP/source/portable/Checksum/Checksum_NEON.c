@@ -0,0 +1,102 @@
+/*
+FreeRTOS+TCP V2.0.10
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+/******************************************************************************
+ *
+ * Internet checksum (RFC 1071) with NEON, for ARMv7-A and AArch64 CPU's, such
+ * as the Cortex-A cores used in gateways.
+ *
+ * Select it with:
+ *     #define ipconfigCHECKSUM_FUNCTION	usGenerateChecksumNEON
+ *
+ * VPADAL adds pairs of 32-bit lanes to 64-bit accumulators, so no carry is
+ * lost.  The bytes that do not fill a vector are summed by
+ * usGenerateChecksumWord64(), so Checksum_Word64.c must be compiled as well.
+ *
+ * On targets without NEON usGenerateChecksumNEON() is the same as
+ * usGenerateChecksumWord64(), so a configuration shared by several CPU's may
+ * select it and the file may be built on any host.
+ *
+ ******************************************************************************/
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+	#include <arm_neon.h>
+#endif
+
+/*-----------------------------------------------------------*/
+
+#if defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+
+uint16_t usGenerateChecksumNEON( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+uint64x2_t xSum0 = vdupq_n_u64( 0ull ), xSum1 = vdupq_n_u64( 0ull );
+const uint8_t *pucSource = pucNextData;
+size_t uxLength = uxDataLengthBytes;
+uint64_t ullSum;
+uint32_t ulResult;
+
+	/* vld1q_u8() has no alignment requirement.  Loading bytes and
+	reinterpreting them keeps the words in memory order. */
+	while( uxLength >= 32u )
+	{
+		xSum0 = vpadalq_u32( xSum0, vreinterpretq_u32_u8( vld1q_u8( pucSource ) ) );
+		xSum1 = vpadalq_u32( xSum1, vreinterpretq_u32_u8( vld1q_u8( pucSource + 16 ) ) );
+		pucSource += 32;
+		uxLength -= 32u;
+	}
+
+	xSum0 = vaddq_u64( xSum0, xSum1 );
+	ullSum = vgetq_lane_u64( xSum0, 0 ) + vgetq_lane_u64( xSum0, 1 ) + FreeRTOS_ntohs( ulSum );
+
+	/* Fold 64 bits to 16 bits. */
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	ulResult = ( uint32_t ) ullSum;
+	ulResult = ( ulResult & 0xffffu ) + ( ulResult >> 16 );
+	ulResult = ( ulResult & 0xffffu ) + ( ulResult >> 16 );
+
+	return usGenerateChecksumWord64( ( uint32_t ) FreeRTOS_ntohs( ( uint16_t ) ulResult ), pucSource, uxLength );
+}
+
+#else /* __ARM_NEON */
+
+uint16_t usGenerateChecksumNEON( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+	return usGenerateChecksumWord64( ulSum, pucNextData, uxDataLengthBytes );
+}
+
+#endif /* __ARM_NEON */
+/*-----------------------------------------------------------*/
@@ -0,0 +1,160 @@
+/*
+FreeRTOS+TCP V2.0.10
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+/******************************************************************************
+ *
+ * Internet checksum (RFC 1071) with a 64-bit accumulator, in portable C.
+ *
+ * Select it with:
+ *     #define ipconfigCHECKSUM_FUNCTION	usGenerateChecksumWord64
+ *
+ * Adding 32-bit words to a 64-bit accumulator can not overflow before 4 GB
+ * has been summed, so the carries do not have to be counted one by one, as
+ * the default usGenerateChecksumWord32() in FreeRTOS_IP.c does.  They are
+ * folded back once, at the end.  A 32-bit CPU does the 64-bit addition with
+ * an add and an add-with-carry, without any branches.
+ *
+ * This file is also needed by the SIMD implementations in this directory,
+ * which use usGenerateChecksumWord64() for the bytes that do not fill a
+ * vector.
+ *
+ ******************************************************************************/
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+
+/* Number of bytes summed by one pass through the unrolled loop. */
+#define ckBYTES_PER_LOOP	( 8u * sizeof( uint32_t ) )
+
+typedef union xUNION16
+{
+	uint16_t u16;
+	uint8_t u8[ 2 ];
+} ckUnion16_t;
+
+/*-----------------------------------------------------------*/
+
+uint16_t usGenerateChecksumWord64( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+uint64_t ullSum = 0ull;
+const uint8_t *pucSource = pucNextData;
+const uint32_t *pulSource;
+size_t uxLength = uxDataLengthBytes;
+ckUnion16_t xTerm;
+uint32_t ulResult;
+BaseType_t xOddAddress = pdFALSE;
+
+	/* The sum is made of 16-bit words as they are found in memory, i.e. in
+	network order.  The result is swapped to host order at the end. */
+
+	if( ( ( ( uintptr_t ) pucSource ) & 1u ) != 0u )
+	{
+		/* A 16-bit word of the data would straddle two 16-bit words of memory.
+		Sum as if the data started one byte earlier, with a zero: the result is
+		the byte-swapped checksum, which is corrected at the end. */
+		xOddAddress = pdTRUE;
+
+		if( uxLength > 0u )
+		{
+			xTerm.u8[ 0 ] = 0u;
+			xTerm.u8[ 1 ] = *pucSource;
+			ullSum += xTerm.u16;
+			pucSource++;
+			uxLength--;
+		}
+	}
+
+	if( ( ( ( ( uintptr_t ) pucSource ) & 2u ) != 0u ) && ( uxLength >= 2u ) )
+	{
+		/* Align to 32 bits, some CPU's can not access unaligned words. */
+		ullSum += *( ( const uint16_t * ) pucSource );
+		pucSource += 2;
+		uxLength -= 2u;
+	}
+
+	pulSource = ( const uint32_t * ) pucSource;
+
+	while( uxLength >= ckBYTES_PER_LOOP )
+	{
+		/* Eight independent loads, which are added without any test. */
+		ullSum += ( uint64_t ) pulSource[ 0 ] + pulSource[ 1 ];
+		ullSum += ( uint64_t ) pulSource[ 2 ] + pulSource[ 3 ];
+		ullSum += ( uint64_t ) pulSource[ 4 ] + pulSource[ 5 ];
+		ullSum += ( uint64_t ) pulSource[ 6 ] + pulSource[ 7 ];
+		pulSource += 8;
+		uxLength -= ckBYTES_PER_LOOP;
+	}
+
+	while( uxLength >= sizeof( uint32_t ) )
+	{
+		ullSum += pulSource[ 0 ];
+		pulSource++;
+		uxLength -= sizeof( uint32_t );
+	}
+
+	pucSource = ( const uint8_t * ) pulSource;
+
+	if( uxLength >= 2u )
+	{
+		ullSum += *( ( const uint16_t * ) pucSource );
+		pucSource += 2;
+		uxLength -= 2u;
+	}
+
+	if( uxLength != 0u )
+	{
+		/* One byte left, it is the first byte of a 16-bit word. */
+		xTerm.u8[ 0 ] = *pucSource;
+		xTerm.u8[ 1 ] = 0u;
+		ullSum += xTerm.u16;
+	}
+
+	/* Fold 64 bits to 16 bits, adding the carries back in. */
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	ulResult = ( uint32_t ) ullSum;
+	ulResult = ( ulResult & 0xffffu ) + ( ulResult >> 16 );
+	ulResult = ( ulResult & 0xffffu ) + ( ulResult >> 16 );
+
+	if( xOddAddress != pdFALSE )
+	{
+		ulResult = ( ( ulResult & 0xffu ) << 8 ) | ( ( ulResult & 0xff00u ) >> 8 );
+	}
+
+	/* Add the initial value, which is given in host order. */
+	ulResult += FreeRTOS_ntohs( ulSum );
+	ulResult = ( ulResult & 0xffffu ) + ( ulResult >> 16 );
+
+	return FreeRTOS_htons( ( uint16_t ) ulResult );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,152 @@
+/*
+FreeRTOS+TCP V2.0.10
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+/******************************************************************************
+ *
+ * Internet checksum (RFC 1071) with SSE2 and AVX2, for x86 hosts such as the
+ * Linux and Windows simulators.  GCC and Clang only.
+ *
+ * Select one of them with:
+ *     #define ipconfigCHECKSUM_FUNCTION	usGenerateChecksumSSE2
+ *     #define ipconfigCHECKSUM_FUNCTION	usGenerateChecksumAVX2
+ *
+ * SSE2 is always present on x86_64.  usGenerateChecksumAVX2() may only be
+ * selected when all CPU's that will run the application support AVX2.  The
+ * functions are compiled with a 'target' attribute, so the project does not
+ * need -msse2 or -mavx2.
+ *
+ * Each vector is split into 32-bit lanes, which are widened and added to 64-bit
+ * lanes: no carry is lost.  The bytes that do not fill a vector are summed by
+ * usGenerateChecksumWord64(), so Checksum_Word64.c must be compiled as well.
+ *
+ ******************************************************************************/
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+
+#if !defined( __GNUC__ ) || !( defined( __x86_64__ ) || defined( __i386__ ) )
+	#error Checksum_x86.c requires GCC or Clang and an x86 target
+#endif
+
+#include <immintrin.h>
+
+/*
+ * Fold a 64-bit sum of 16-bit words (in memory order) to a 16-bit sum in host
+ * order, to be passed as 'ulSum' to usGenerateChecksumWord64().
+ */
+static uint32_t prvFold64( uint64_t ullSum );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvFold64( uint64_t ullSum )
+{
+uint32_t ulResult;
+
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	ullSum = ( ullSum & 0xffffffffull ) + ( ullSum >> 32 );
+	ulResult = ( uint32_t ) ullSum;
+	ulResult = ( ulResult & 0xffffu ) + ( ulResult >> 16 );
+	ulResult = ( ulResult & 0xffffu ) + ( ulResult >> 16 );
+
+	return ( uint32_t ) FreeRTOS_ntohs( ( uint16_t ) ulResult );
+}
+/*-----------------------------------------------------------*/
+
+__attribute__( ( target( "sse2" ) ) )
+uint16_t usGenerateChecksumSSE2( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+const __m128i xZero = _mm_setzero_si128();
+__m128i xSum0 = _mm_setzero_si128(), xSum1 = _mm_setzero_si128();
+__m128i xData0, xData1;
+const uint8_t *pucSource = pucNextData;
+size_t uxLength = uxDataLengthBytes;
+uint64_t ullLanes[ 2 ];
+uint32_t ulPartial;
+
+	/* x86 loads unaligned vectors without a penalty worth avoiding, so the
+	pairing of bytes into 16-bit words simply follows the data. */
+	while( uxLength >= 32u )
+	{
+		xData0 = _mm_loadu_si128( ( const __m128i * ) pucSource );
+		xData1 = _mm_loadu_si128( ( const __m128i * ) ( pucSource + 16 ) );
+		xSum0 = _mm_add_epi64( xSum0, _mm_unpacklo_epi32( xData0, xZero ) );
+		xSum1 = _mm_add_epi64( xSum1, _mm_unpackhi_epi32( xData0, xZero ) );
+		xSum0 = _mm_add_epi64( xSum0, _mm_unpacklo_epi32( xData1, xZero ) );
+		xSum1 = _mm_add_epi64( xSum1, _mm_unpackhi_epi32( xData1, xZero ) );
+		pucSource += 32;
+		uxLength -= 32u;
+	}
+
+	_mm_storeu_si128( ( __m128i * ) ullLanes, _mm_add_epi64( xSum0, xSum1 ) );
+
+	/* Each lane gains less than 2^33 per 32 bytes, the lanes can not
+	overflow before many gigabytes have been summed. */
+	ulPartial = prvFold64( ullLanes[ 0 ] + ullLanes[ 1 ] + FreeRTOS_ntohs( ulSum ) );
+
+	return usGenerateChecksumWord64( ulPartial, pucSource, uxLength );
+}
+/*-----------------------------------------------------------*/
+
+__attribute__( ( target( "avx2" ) ) )
+uint16_t usGenerateChecksumAVX2( uint32_t ulSum, const uint8_t * pucNextData, size_t uxDataLengthBytes )
+{
+const __m256i xZero = _mm256_setzero_si256();
+__m256i xSum0 = _mm256_setzero_si256(), xSum1 = _mm256_setzero_si256();
+__m256i xData0, xData1;
+const uint8_t *pucSource = pucNextData;
+size_t uxLength = uxDataLengthBytes;
+uint64_t ullLanes[ 4 ];
+uint32_t ulPartial;
+
+	while( uxLength >= 64u )
+	{
+		xData0 = _mm256_loadu_si256( ( const __m256i * ) pucSource );
+		xData1 = _mm256_loadu_si256( ( const __m256i * ) ( pucSource + 32 ) );
+
+		/* The unpack instructions work within each 128-bit half, which does
+		not matter for a sum. */
+		xSum0 = _mm256_add_epi64( xSum0, _mm256_unpacklo_epi32( xData0, xZero ) );
+		xSum1 = _mm256_add_epi64( xSum1, _mm256_unpackhi_epi32( xData0, xZero ) );
+		xSum0 = _mm256_add_epi64( xSum0, _mm256_unpacklo_epi32( xData1, xZero ) );
+		xSum1 = _mm256_add_epi64( xSum1, _mm256_unpackhi_epi32( xData1, xZero ) );
+		pucSource += 64;
+		uxLength -= 64u;
+	}
+
+	_mm256_storeu_si256( ( __m256i * ) ullLanes, _mm256_add_epi64( xSum0, xSum1 ) );
+	ulPartial = prvFold64( ullLanes[ 0 ] + ullLanes[ 1 ] + ullLanes[ 2 ] + ullLanes[ 3 ] + FreeRTOS_ntohs( ulSum ) );
+
+	/* Less than 64 bytes are left. */
+	return usGenerateChecksumWord64( ulPartial, pucSource, uxLength );
+}
+/*-----------------------------------------------------------*/
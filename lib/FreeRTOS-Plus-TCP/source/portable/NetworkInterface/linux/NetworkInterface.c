@@ -0,0 +1,789 @@
+/*
+FreeRTOS+TCP V2.0.10
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+/*
+ * A FreeRTOS+TCP network interface for the Linux (Posix port) simulator.
+ *
+ * Two host back ends are supported, selected by
+ * configNETWORK_INTERFACE_USE_PACKET_MMAP:
+ *
+ * 0 - A TAP device.  The device named by configNETWORK_INTERFACE_TO_USE is
+ *     opened, or created if it does not already exist.  Give the host side an
+ *     address in the same subnet as the FreeRTOS node to talk to it, for
+ *     example "ip addr add 192.168.7.1/24 dev tap0".
+ *
+ * 1 - An AF_PACKET socket bound to an existing interface, for example "eth0",
+ *     with PACKET_MMAP receive and transmit rings shared with the kernel.
+ *
+ * A host thread, which is outside the control of the scheduler, waits for the
+ * interface to become readable then raises a simulated interrupt.  The
+ * interrupt handler defers to a task that drains up to niMAX_RX_BATCH frames
+ * at a time into network buffers.  When ipconfigUSE_LINKED_RX_MESSAGES is set
+ * the frames of a batch are chained through pxNextBuffer and passed to the IP
+ * task in a single event.  The receive "interrupt" is only enabled again once
+ * the interface has been drained, so the host thread never spins.
+ *
+ * Frames are read directly into network buffers and written directly from
+ * them, so the driver never holds on to a buffer after xNetworkInterfaceOutput()
+ * returns.  It can therefore be used with ipconfigZERO_COPY_RX_DRIVER and
+ * ipconfigZERO_COPY_TX_DRIVER set to either 0 or 1.
+ *
+ * With ipconfigDRIVER_REPORTS_RX_CHECKSUM, the packet socket back end passes on
+ * the kernel's TP_STATUS_CSUM_VALID, so that the IP task does not check the TCP
+ * or UDP checksum again.
+ *
+ * Opening either back end requires CAP_NET_ADMIN (or CAP_NET_RAW for the
+ * packet socket), unless the TAP device was created in advance for the user,
+ * for example with "ip tuntap add dev tap0 mode tap user $USER".
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <linux/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/if_tun.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+#include "NetworkInterface.h"
+
+/* The host interface to use.  This is the name of a TAP device, or of an
+existing interface when configNETWORK_INTERFACE_USE_PACKET_MMAP is 1. */
+#ifndef configNETWORK_INTERFACE_TO_USE
+	#define configNETWORK_INTERFACE_TO_USE		"tap0"
+#endif
+
+/* Set to 1 to use an AF_PACKET socket with PACKET_MMAP rings in place of a TAP
+device. */
+#ifndef configNETWORK_INTERFACE_USE_PACKET_MMAP
+	#define configNETWORK_INTERFACE_USE_PACKET_MMAP	0
+#endif
+
+/* The priority of the task that the receive interrupt defers to. */
+#ifndef configMAC_ISR_SIMULATOR_PRIORITY
+	#define configMAC_ISR_SIMULATOR_PRIORITY	( configMAX_PRIORITIES - 1 )
+#endif
+
+/* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
+driver will filter incoming packets and only pass the stack those packets it
+considers need processing. */
+#if( ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES == 0 )
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eProcessBuffer
+#else
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eConsiderFrameForProcessing( ( pucEthernetBuffer ) )
+#endif
+
+/* The simulated interrupt raised by the receive thread.  Numbers up to and
+including portINTERRUPT_TICK are reserved by the port. */
+#define niRX_INTERRUPT				( portINTERRUPT_TICK + 1UL )
+
+/* The maximum number of frames passed to the IP task in one event. */
+#define niMAX_RX_BATCH				( 32 )
+
+/* The time to wait before trying again when no network buffer is available to
+receive into.  Frames are queued by the host in the meantime. */
+#define niNO_BUFFER_DELAY			pdMS_TO_TICKS( 2UL )
+
+/* The values returned by prvReceiveFrames(). */
+#define niRX_EMPTY					( 0 )
+#define niRX_MORE					( 1 )
+#define niRX_NO_BUFFER				( 2 )
+
+/* The size of a network buffer, used to receive a complete frame. */
+#define niBUFFER_SIZE				( ( size_t ) ipTOTAL_ETHERNET_FRAME_SIZE )
+
+/* The space taken by each buffer when BufferAllocation_1.c is used.  Each
+buffer starts with ipBUFFER_PADDING bytes, the first of which hold a pointer
+back to the descriptor. */
+#define niBUFFER_1_PACKET_SIZE		( ( ( niBUFFER_SIZE + ipBUFFER_PADDING ) + 7UL ) & ~7UL )
+
+/* Geometry of each of the PACKET_MMAP rings.  A block must be a multiple of the
+page size and hold a whole number of frames. */
+#define niRING_FRAME_SIZE			( 2048U )
+#define niRING_BLOCK_SIZE			( 4096U * 4U )
+#define niRING_BLOCK_COUNT			( 32U )
+#define niRING_FRAME_COUNT			( ( niRING_BLOCK_SIZE / niRING_FRAME_SIZE ) * niRING_BLOCK_COUNT )
+#define niRING_SIZE					( niRING_BLOCK_SIZE * niRING_BLOCK_COUNT )
+
+/* The offset of the frame data within a transmit ring slot. */
+#define niTX_DATA_OFFSET			( TPACKET2_HDRLEN - sizeof( struct sockaddr_ll ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Open the host interface selected by configNETWORK_INTERFACE_TO_USE.
+ */
+static BaseType_t prvOpenInterface( void );
+
+/*
+ * Read one frame from the host interface into pucBuffer, which has room for
+ * niBUFFER_SIZE bytes.  Returns the length of the frame, or 0 if there are no
+ * more frames to read.
+ */
+static size_t prvReadFrame( uint8_t *pucBuffer, uint8_t *pucChecksumFlags );
+
+/*
+ * Write one frame to the host interface.
+ */
+static BaseType_t prvWriteFrame( const uint8_t *pucBuffer, size_t xLength );
+
+/*
+ * Host thread that waits for frames to arrive and raises the receive
+ * interrupt.
+ */
+static void *prvReceiveThread( void *pvParameters );
+
+/*
+ * Handler for the simulated receive interrupt.
+ */
+static uint32_t prvReceiveInterruptHandler( void );
+
+/*
+ * The task the receive interrupt defers to.  Drains the host interface then
+ * enables the receive interrupt again.
+ */
+static void prvEMACHandlerTask( void *pvParameters );
+
+/*
+ * Read up to niMAX_RX_BATCH frames and pass them to the IP task.
+ */
+static BaseType_t prvReceiveFrames( void );
+
+/*
+ * Pass a frame, or a chain of frames, to the IP task.
+ */
+static void prvPassToIPTask( NetworkBufferDescriptor_t *pxBufferChain );
+
+/*-----------------------------------------------------------*/
+
+/* The file descriptor of the TAP device or packet socket. */
+static int iInterfaceFd = -1;
+
+#if( configNETWORK_INTERFACE_USE_PACKET_MMAP != 0 )
+
+	/* The receive and transmit rings shared with the kernel, and the index of
+	the next slot to use in each. */
+	static uint8_t *pucRxRing = NULL;
+	static uint8_t *pucTxRing = NULL;
+	static uint32_t ulRxRingIndex = 0UL;
+	static uint32_t ulTxRingIndex = 0UL;
+
+#endif /* configNETWORK_INTERFACE_USE_PACKET_MMAP */
+
+/* The receive thread waits on this before polling the interface, which
+simulates masking the receive interrupt in the MAC. */
+static sem_t xRxInterruptEnable;
+
+/* The task that receive interrupts defer to. */
+static TaskHandle_t xEMACTaskHandle = NULL;
+
+/* A network buffer that has been obtained but not yet used, so the buffer
+obtained for the last read of a drain is not freed just to be obtained again. */
+static NetworkBufferDescriptor_t *pxSpareBuffer = NULL;
+
+/* Counters for viewing in the debugger, or for calculating the per frame cost
+of the stack when measuring throughput. */
+static volatile uint32_t ulRxInterruptCount = 0UL;
+static volatile uint32_t ulRxEventCount = 0UL;
+static volatile uint32_t ulRxFrameCount = 0UL;
+static volatile uint32_t ulRxDropCount = 0UL;
+static volatile uint32_t ulTxFrameCount = 0UL;
+static volatile uint32_t ulTxFailureCount = 0UL;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+BaseType_t xReturn = pdPASS;
+pthread_t xReceiveThread;
+int iReturned;
+
+	/* This function is called again each time the network goes down, but the
+	host interface only has to be set up once. */
+	if( iInterfaceFd < 0 )
+	{
+		xReturn = prvOpenInterface();
+
+		if( xReturn == pdPASS )
+		{
+			iReturned = sem_init( &xRxInterruptEnable, 0, 1U );
+			configASSERT( iReturned == 0 );
+
+			vPortSetInterruptHandler( niRX_INTERRUPT, prvReceiveInterruptHandler );
+			xTaskCreate( prvEMACHandlerTask, "EMAC", configMINIMAL_STACK_SIZE, NULL, configMAC_ISR_SIMULATOR_PRIORITY, &xEMACTaskHandle );
+			configASSERT( xEMACTaskHandle != NULL );
+
+			/* The host thread inherits the signal mask of the thread that
+			creates it, so create it inside a critical section to ensure it
+			never takes a simulated interrupt. */
+			taskENTER_CRITICAL();
+			{
+				iReturned = pthread_create( &xReceiveThread, NULL, prvReceiveThread, NULL );
+			}
+			taskEXIT_CRITICAL();
+
+			configASSERT( iReturned == 0 );
+			( void ) pthread_detach( xReceiveThread );
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t bReleaseAfterSend )
+{
+BaseType_t xReturn = pdFAIL;
+
+	iptraceNETWORK_INTERFACE_TRANSMIT();
+
+	if( pxNetworkBuffer->xDataLength <= niBUFFER_SIZE )
+	{
+		xReturn = prvWriteFrame( pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
+	}
+
+	if( xReturn == pdPASS )
+	{
+		ulTxFrameCount++;
+	}
+	else
+	{
+		ulTxFailureCount++;
+	}
+
+	/* The frame has been copied to the host, so the buffer can be released
+	whether or not it was sent. */
+	if( bReleaseAfterSend != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] )
+{
+static uint8_t ucNetworkPackets[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS * niBUFFER_1_PACKET_SIZE ] __attribute__ ( ( aligned( 8 ) ) );
+uint8_t *pucRAMBuffer = ucNetworkPackets;
+UBaseType_t uxIndex;
+
+	for( uxIndex = 0; uxIndex < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; uxIndex++ )
+	{
+		pxNetworkBuffers[ uxIndex ].pucEthernetBuffer = pucRAMBuffer + ipBUFFER_PADDING;
+		*( ( NetworkBufferDescriptor_t ** ) pucRAMBuffer ) = &( pxNetworkBuffers[ uxIndex ] );
+		pucRAMBuffer += niBUFFER_1_PACKET_SIZE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetPhyLinkStatus( void )
+{
+	/* There is no PHY, so the link is up for as long as the host interface is
+	open. */
+	return ( iInterfaceFd >= 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvReceiveThread( void *pvParameters )
+{
+struct pollfd xPollDescriptor;
+
+	( void ) pvParameters;
+
+	xPollDescriptor.fd = iInterfaceFd;
+	xPollDescriptor.events = POLLIN;
+
+	for( ;; )
+	{
+		/* Wait until the handler task has drained the interface. */
+		while( sem_wait( &xRxInterruptEnable ) != 0 )
+		{
+			/* Interrupted, try again. */
+		}
+
+		/* Wait until there is at least one frame to read.  The descriptor is
+		level triggered, so a frame that arrived after the handler task last
+		found the interface empty is still seen here. */
+		do
+		{
+			xPollDescriptor.revents = 0;
+		} while( poll( &xPollDescriptor, 1, -1 ) <= 0 );
+
+		vPortGenerateSimulatedInterrupt( niRX_INTERRUPT );
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvReceiveInterruptHandler( void )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	ulRxInterruptCount++;
+	vTaskNotifyGiveFromISR( xEMACTaskHandle, &xHigherPriorityTaskWoken );
+
+	return ( uint32_t ) xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEMACHandlerTask( void *pvParameters )
+{
+BaseType_t xResult;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		/* Wait for the receive interrupt. */
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+		do
+		{
+			xResult = prvReceiveFrames();
+
+			if( xResult == niRX_NO_BUFFER )
+			{
+				/* Wait for the IP task to release some buffers.  The host
+				keeps the frames until then, or drops them if its own queue
+				overflows, much as a MAC would. */
+				vTaskDelay( niNO_BUFFER_DELAY );
+			}
+		} while( xResult != niRX_EMPTY );
+
+		/* The interface is empty, enable the receive interrupt again. */
+		( void ) sem_post( &xRxInterruptEnable );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReceiveFrames( void )
+{
+NetworkBufferDescriptor_t *pxBuffer;
+BaseType_t xReturn = niRX_MORE;
+BaseType_t xCount;
+size_t xLength;
+uint8_t ucChecksumFlags;
+
+#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	NetworkBufferDescriptor_t *pxFirstBuffer = NULL;
+	NetworkBufferDescriptor_t *pxLastBuffer = NULL;
+#endif
+
+	for( xCount = 0; xCount < niMAX_RX_BATCH; xCount++ )
+	{
+		if( pxSpareBuffer == NULL )
+		{
+			pxSpareBuffer = pxGetNetworkBufferWithDescriptor( niBUFFER_SIZE, ( TickType_t ) 0 );
+
+			if( pxSpareBuffer == NULL )
+			{
+				xReturn = niRX_NO_BUFFER;
+				break;
+			}
+		}
+
+		xLength = prvReadFrame( pxSpareBuffer->pucEthernetBuffer, &ucChecksumFlags );
+
+		if( xLength == 0 )
+		{
+			xReturn = niRX_EMPTY;
+			break;
+		}
+
+		ulRxFrameCount++;
+		iptraceNETWORK_INTERFACE_RECEIVE();
+
+		if( ipCONSIDER_FRAME_FOR_PROCESSING( pxSpareBuffer->pucEthernetBuffer ) != eProcessBuffer )
+		{
+			/* Not of interest, so the spare buffer can be reused for the next
+			frame. */
+			continue;
+		}
+
+		pxBuffer = pxSpareBuffer;
+		pxSpareBuffer = NULL;
+		pxBuffer->xDataLength = xLength;
+
+		#if( ipconfigDRIVER_REPORTS_RX_CHECKSUM != 0 )
+		{
+			pxBuffer->ucChecksumFlags = ucChecksumFlags;
+		}
+		#endif
+
+		#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		{
+			/* Chain the frame, the whole batch is passed to the IP task in one
+			event. */
+			pxBuffer->pxNextBuffer = NULL;
+
+			if( pxFirstBuffer == NULL )
+			{
+				pxFirstBuffer = pxBuffer;
+			}
+			else
+			{
+				pxLastBuffer->pxNextBuffer = pxBuffer;
+			}
+
+			pxLastBuffer = pxBuffer;
+		}
+		#else
+		{
+			prvPassToIPTask( pxBuffer );
+		}
+		#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+	}
+
+	#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	{
+		if( pxFirstBuffer != NULL )
+		{
+			prvPassToIPTask( pxFirstBuffer );
+		}
+	}
+	#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPassToIPTask( NetworkBufferDescriptor_t *pxBufferChain )
+{
+IPStackEvent_t xRxEvent;
+NetworkBufferDescriptor_t *pxNextBuffer;
+
+	xRxEvent.eEventType = eNetworkRxEvent;
+	xRxEvent.pvData = ( void * ) pxBufferChain;
+
+	if( xSendEventStructToIPTask( &xRxEvent, ( TickType_t ) 0 ) == pdPASS )
+	{
+		ulRxEventCount++;
+	}
+	else
+	{
+		/* The event could not be sent to the IP task, so the buffers must be
+		released again. */
+		while( pxBufferChain != NULL )
+		{
+			#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+			{
+				pxNextBuffer = pxBufferChain->pxNextBuffer;
+			}
+			#else
+			{
+				pxNextBuffer = NULL;
+			}
+			#endif
+
+			vReleaseNetworkBufferAndDescriptor( pxBufferChain );
+			pxBufferChain = pxNextBuffer;
+			ulRxDropCount++;
+		}
+
+		iptraceETHERNET_RX_EVENT_LOST();
+		FreeRTOS_debug_printf( ( "prvPassToIPTask: Can not queue the received frames\n" ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if( configNETWORK_INTERFACE_USE_PACKET_MMAP == 0 )
+
+	static BaseType_t prvOpenInterface( void )
+	{
+	struct ifreq xRequest;
+	int iControlSocket;
+	BaseType_t xReturn = pdFAIL;
+
+		iInterfaceFd = open( "/dev/net/tun", O_RDWR | O_NONBLOCK );
+
+		if( iInterfaceFd < 0 )
+		{
+			FreeRTOS_printf( ( "prvOpenInterface: can not open /dev/net/tun (errno %d)\n", errno ) );
+		}
+		else
+		{
+			/* Attach to the TAP device, creating it if necessary.  Frames are
+			read and written without a packet information header. */
+			memset( &xRequest, 0x00, sizeof( xRequest ) );
+			xRequest.ifr_flags = IFF_TAP | IFF_NO_PI;
+			strncpy( xRequest.ifr_name, configNETWORK_INTERFACE_TO_USE, IFNAMSIZ - 1 );
+
+			if( ioctl( iInterfaceFd, TUNSETIFF, &xRequest ) < 0 )
+			{
+				FreeRTOS_printf( ( "prvOpenInterface: can not attach to %s (errno %d)\n", configNETWORK_INTERFACE_TO_USE, errno ) );
+				( void ) close( iInterfaceFd );
+				iInterfaceFd = -1;
+			}
+			else
+			{
+				xReturn = pdPASS;
+
+				/* Match the MTU of the host side to that of the stack and bring
+				the device up.  A device created in advance may not permit
+				this, in which case it has to be configured on the host. */
+				iControlSocket = socket( AF_INET, SOCK_DGRAM, 0 );
+
+				if( iControlSocket >= 0 )
+				{
+					xRequest.ifr_mtu = ipconfigNETWORK_MTU;
+					( void ) ioctl( iControlSocket, SIOCSIFMTU, &xRequest );
+
+					if( ioctl( iControlSocket, SIOCGIFFLAGS, &xRequest ) == 0 )
+					{
+						xRequest.ifr_flags |= IFF_UP;
+						( void ) ioctl( iControlSocket, SIOCSIFFLAGS, &xRequest );
+					}
+
+					( void ) close( iControlSocket );
+				}
+
+				FreeRTOS_printf( ( "prvOpenInterface: using TAP device %s\n", configNETWORK_INTERFACE_TO_USE ) );
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static size_t prvReadFrame( uint8_t *pucBuffer, uint8_t *pucChecksumFlags )
+	{
+	ssize_t xBytesRead;
+	size_t xReturn = 0;
+
+		/* A TAP device does not say whether the checksums are valid. */
+		*pucChecksumFlags = 0u;
+
+		/* A frame longer than the buffer is truncated by the host, which is
+		avoided by setting the MTU of the device in prvOpenInterface(). */
+		xBytesRead = read( iInterfaceFd, pucBuffer, niBUFFER_SIZE );
+
+		if( xBytesRead > 0 )
+		{
+			xReturn = ( size_t ) xBytesRead;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvWriteFrame( const uint8_t *pucBuffer, size_t xLength )
+	{
+	BaseType_t xReturn = pdFAIL;
+
+		if( write( iInterfaceFd, pucBuffer, xLength ) == ( ssize_t ) xLength )
+		{
+			xReturn = pdPASS;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+#else /* configNETWORK_INTERFACE_USE_PACKET_MMAP */
+
+	static BaseType_t prvOpenInterface( void )
+	{
+	struct ifreq xRequest;
+	struct tpacket_req xRingRequest;
+	struct sockaddr_ll xAddress;
+	struct packet_mreq xMembership;
+	int iVersion = TPACKET_V2;
+	uint8_t *pucRings;
+	BaseType_t xReturn = pdFAIL;
+
+		iInterfaceFd = socket( AF_PACKET, SOCK_RAW, htons( ETH_P_ALL ) );
+
+		memset( &xRequest, 0x00, sizeof( xRequest ) );
+		strncpy( xRequest.ifr_name, configNETWORK_INTERFACE_TO_USE, IFNAMSIZ - 1 );
+
+		memset( &xRingRequest, 0x00, sizeof( xRingRequest ) );
+		xRingRequest.tp_block_size = niRING_BLOCK_SIZE;
+		xRingRequest.tp_block_nr = niRING_BLOCK_COUNT;
+		xRingRequest.tp_frame_size = niRING_FRAME_SIZE;
+		xRingRequest.tp_frame_nr = niRING_FRAME_COUNT;
+
+		if( iInterfaceFd < 0 )
+		{
+			FreeRTOS_printf( ( "prvOpenInterface: can not open a packet socket (errno %d)\n", errno ) );
+		}
+		else if( ioctl( iInterfaceFd, SIOCGIFINDEX, &xRequest ) < 0 )
+		{
+			FreeRTOS_printf( ( "prvOpenInterface: no interface called %s\n", configNETWORK_INTERFACE_TO_USE ) );
+		}
+		else if( ( setsockopt( iInterfaceFd, SOL_PACKET, PACKET_VERSION, &iVersion, sizeof( iVersion ) ) < 0 ) ||
+				 ( setsockopt( iInterfaceFd, SOL_PACKET, PACKET_RX_RING, &xRingRequest, sizeof( xRingRequest ) ) < 0 ) ||
+				 ( setsockopt( iInterfaceFd, SOL_PACKET, PACKET_TX_RING, &xRingRequest, sizeof( xRingRequest ) ) < 0 ) )
+		{
+			FreeRTOS_printf( ( "prvOpenInterface: can not create the packet rings (errno %d)\n", errno ) );
+		}
+		else
+		{
+			/* The receive ring is mapped first, followed by the transmit
+			ring. */
+			pucRings = ( uint8_t * ) mmap( NULL, 2U * niRING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, iInterfaceFd, 0 );
+
+			memset( &xAddress, 0x00, sizeof( xAddress ) );
+			xAddress.sll_family = AF_PACKET;
+			xAddress.sll_protocol = htons( ETH_P_ALL );
+			xAddress.sll_ifindex = xRequest.ifr_ifindex;
+
+			/* The MAC address of the stack is not that of the host interface,
+			so the interface must pass up all frames. */
+			memset( &xMembership, 0x00, sizeof( xMembership ) );
+			xMembership.mr_ifindex = xRequest.ifr_ifindex;
+			xMembership.mr_type = PACKET_MR_PROMISC;
+
+			if( pucRings == MAP_FAILED )
+			{
+				FreeRTOS_printf( ( "prvOpenInterface: can not map the packet rings (errno %d)\n", errno ) );
+			}
+			else if( bind( iInterfaceFd, ( struct sockaddr * ) &xAddress, sizeof( xAddress ) ) < 0 )
+			{
+				FreeRTOS_printf( ( "prvOpenInterface: can not bind to %s (errno %d)\n", configNETWORK_INTERFACE_TO_USE, errno ) );
+				( void ) munmap( pucRings, 2U * niRING_SIZE );
+			}
+			else
+			{
+				( void ) setsockopt( iInterfaceFd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &xMembership, sizeof( xMembership ) );
+
+				pucRxRing = pucRings;
+				pucTxRing = pucRings + niRING_SIZE;
+				xReturn = pdPASS;
+
+				FreeRTOS_printf( ( "prvOpenInterface: using %s with %u frame rings\n", configNETWORK_INTERFACE_TO_USE, niRING_FRAME_COUNT ) );
+			}
+		}
+
+		if( ( xReturn != pdPASS ) && ( iInterfaceFd >= 0 ) )
+		{
+			( void ) close( iInterfaceFd );
+			iInterfaceFd = -1;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static size_t prvReadFrame( uint8_t *pucBuffer, uint8_t *pucChecksumFlags )
+	{
+	volatile struct tpacket2_hdr *pxHeader;
+	const struct sockaddr_ll *pxAddress;
+	size_t xReturn = 0;
+
+		*pucChecksumFlags = 0u;
+
+		for( ;; )
+		{
+			pxHeader = ( volatile struct tpacket2_hdr * ) ( pucRxRing + ( ulRxRingIndex * niRING_FRAME_SIZE ) );
+
+			if( ( pxHeader->tp_status & TP_STATUS_USER ) == 0 )
+			{
+				/* The slot is still owned by the kernel, so the ring is
+				empty. */
+				break;
+			}
+
+			/* Read the status before the frame. */
+			__atomic_thread_fence( __ATOMIC_ACQUIRE );
+
+			/* Frames sent by the host itself are also captured, skip them. */
+			pxAddress = ( const struct sockaddr_ll * ) ( ( ( const uint8_t * ) pxHeader ) + TPACKET_ALIGN( sizeof( struct tpacket2_hdr ) ) );
+
+			if( ( pxAddress->sll_pkttype != PACKET_OUTGOING ) && ( pxHeader->tp_snaplen <= niBUFFER_SIZE ) )
+			{
+				memcpy( pucBuffer, ( ( const uint8_t * ) pxHeader ) + pxHeader->tp_mac, pxHeader->tp_snaplen );
+				xReturn = ( size_t ) pxHeader->tp_snaplen;
+
+				/* The host has verified the TCP or UDP checksum, e.g. because
+				the NIC did. */
+				*pucChecksumFlags = ( ( pxHeader->tp_status & TP_STATUS_CSUM_VALID ) != 0u ) ? ipCHECKSUM_RX_PROTOCOL_VERIFIED : 0u;
+			}
+
+			/* Return the slot to the kernel. */
+			__atomic_thread_fence( __ATOMIC_RELEASE );
+			pxHeader->tp_status = TP_STATUS_KERNEL;
+			ulRxRingIndex = ( ulRxRingIndex + 1UL ) % niRING_FRAME_COUNT;
+
+			if( xReturn != 0 )
+			{
+				break;
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvWriteFrame( const uint8_t *pucBuffer, size_t xLength )
+	{
+	volatile struct tpacket2_hdr *pxHeader;
+	BaseType_t xReturn = pdFAIL;
+
+		pxHeader = ( volatile struct tpacket2_hdr * ) ( pucTxRing + ( ulTxRingIndex * niRING_FRAME_SIZE ) );
+
+		/* Only the IP task transmits, so the slot can be claimed without a
+		lock.  The frame is dropped if the ring is full. */
+		if( pxHeader->tp_status == TP_STATUS_AVAILABLE )
+		{
+			memcpy( ( ( uint8_t * ) pxHeader ) + niTX_DATA_OFFSET, pucBuffer, xLength );
+			pxHeader->tp_len = ( uint32_t ) xLength;
+
+			__atomic_thread_fence( __ATOMIC_RELEASE );
+			pxHeader->tp_status = TP_STATUS_SEND_REQUEST;
+			ulTxRingIndex = ( ulTxRingIndex + 1UL ) % niRING_FRAME_COUNT;
+			xReturn = pdPASS;
+		}
+
+		/* Ask the kernel to send every slot that is ready, without waiting.
+		Frames queued while an earlier request is still being processed are
+		sent as one batch. */
+		( void ) send( iInterfaceFd, NULL, 0, MSG_DONTWAIT );
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configNETWORK_INTERFACE_USE_PACKET_MMAP */
@@ -53,17 +53,24 @@ taskEVENT_LIST_ITEM_VALUE_IN_USE definition. */
 	#define eventUNBLOCKED_DUE_TO_BIT_SET	0x0200U
 	#define eventWAIT_FOR_ALL_BITS			0x0400U
 	#define eventEVENT_BITS_CONTROL_BYTES	0xff00U
+	#define eventNUMBER_OF_BITS				8U
 #else
 	#define eventCLEAR_EVENTS_ON_EXIT_BIT	0x01000000UL
 	#define eventUNBLOCKED_DUE_TO_BIT_SET	0x02000000UL
 	#define eventWAIT_FOR_ALL_BITS			0x04000000UL
 	#define eventEVENT_BITS_CONTROL_BYTES	0xff000000UL
+	#define eventNUMBER_OF_BITS				24U
 #endif
 
 typedef struct EventGroupDef_t
 {
 	EventBits_t uxEventBits;
-	List_t xTasksWaitingForBits;		/*< List of tasks waiting for a bit to be set. */
+	List_t xTasksWaitingForBits;		/*< List of tasks waiting for a bit to be set.  When configUSE_EVENT_GROUP_BIT_INDEX is 1 only tasks waiting for any one of several bits are held here. */
+
+	#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+		List_t xTasksWaitingForBit[ eventNUMBER_OF_BITS ];	/*< Tasks waiting for all their bits, or for a single bit, listed under one of their bits that is not yet set. */
+		EventBits_t uxBitsWaitedForAny;		/*< Bits the tasks in xTasksWaitingForBits wait for.  Can be a superset once tasks have timed out. */
+	#endif
 
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxEventGroupNumber;
@@ -86,6 +93,31 @@ typedef struct EventGroupDef_t
  */
 static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, const EventBits_t uxBitsToWaitFor, const BaseType_t xWaitForAllBits ) PRIVILEGED_FUNCTION;
 
+/*
+ * Unblock the tasks in pxList whose wait condition is met by the current event
+ * bits.  Returns the bits to clear because an unblocked task requested they are
+ * cleared on exit.
+ */
+static EventBits_t prvUnblockWaitingTasks( EventGroup_t *pxEventBits, List_t * const pxList ) PRIVILEGED_FUNCTION;
+
+/*
+ * Initialise the lists a newly created event group holds its blocked tasks in.
+ */
+static void prvInitialiseWaitingLists( EventGroup_t *pxEventBits ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+
+	/*
+	 * Return the list a task that is about to wait for uxBitsWaitedFor should
+	 * be placed in.  A task waiting for all of its bits, or for a single bit,
+	 * is listed under one of its bits that is not set, as nothing else can
+	 * unblock it.  A task waiting for any of several bits is placed in
+	 * xTasksWaitingForBits and its bits are noted in uxBitsWaitedForAny.
+	 */
+	static List_t *prvGetWaitingList( EventGroup_t *pxEventBits, const EventBits_t uxBitsWaitedFor, const EventBits_t uxControlBits ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 #if( configSUPPORT_STATIC_ALLOCATION == 1 )
@@ -113,7 +145,7 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, co
 		if( pxEventBits != NULL )
 		{
 			pxEventBits->uxEventBits = 0;
-			vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
+			prvInitialiseWaitingLists( pxEventBits );
 
 			#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 			{
@@ -164,7 +196,7 @@ static BaseType_t prvTestWaitCondition( const EventBits_t uxCurrentEventBits, co
 		if( pxEventBits != NULL )
 		{
 			pxEventBits->uxEventBits = 0;
-			vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
+			prvInitialiseWaitingLists( pxEventBits );
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
@@ -229,7 +261,15 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 				/* Store the bits that the calling task is waiting for in the
 				task's event list item so the kernel knows when a match is
 				found.  Then enter the blocked state. */
-				vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | eventCLEAR_EVENTS_ON_EXIT_BIT | eventWAIT_FOR_ALL_BITS ), xTicksToWait );
+				#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+				{
+					vTaskPlaceOnUnorderedEventList( prvGetWaitingList( pxEventBits, uxBitsToWaitFor, eventWAIT_FOR_ALL_BITS ), ( uxBitsToWaitFor | eventCLEAR_EVENTS_ON_EXIT_BIT | eventWAIT_FOR_ALL_BITS ), xTicksToWait );
+				}
+				#else
+				{
+					vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | eventCLEAR_EVENTS_ON_EXIT_BIT | eventWAIT_FOR_ALL_BITS ), xTicksToWait );
+				}
+				#endif
 
 				/* This assignment is obsolete as uxReturn will get set after
 				the task unblocks, but some compilers mistakenly generate a
@@ -384,7 +424,15 @@ BaseType_t xTimeoutOccurred = pdFALSE;
 			/* Store the bits that the calling task is waiting for in the
 			task's event list item so the kernel knows when a match is
 			found.  Then enter the blocked state. */
-			vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | uxControlBits ), xTicksToWait );
+			#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+			{
+				vTaskPlaceOnUnorderedEventList( prvGetWaitingList( pxEventBits, uxBitsToWaitFor, uxControlBits ), ( uxBitsToWaitFor | uxControlBits ), xTicksToWait );
+			}
+			#else
+			{
+				vTaskPlaceOnUnorderedEventList( &( pxEventBits->xTasksWaitingForBits ), ( uxBitsToWaitFor | uxControlBits ), xTicksToWait );
+			}
+			#endif
 
 			/* This is obsolete as it will get set after the task unblocks, but
 			some compilers mistakenly generate a warning about the variable
@@ -506,11 +554,11 @@ UBaseType_t uxSavedInterruptStatus;
 EventGroup_t const * const pxEventBits = xEventGroup;
 EventBits_t uxReturn;
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 	{
 		uxReturn = pxEventBits->uxEventBits;
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 	return uxReturn;
 } /*lint !e818 EventGroupHandle_t is a typedef used in other functions to so can't be pointer to const. */
@@ -518,96 +566,245 @@ EventBits_t uxReturn;
 
 EventBits_t xEventGroupSetBits( EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet )
 {
-ListItem_t *pxListItem, *pxNext;
-ListItem_t const *pxListEnd;
-List_t const * pxList;
-EventBits_t uxBitsToClear = 0, uxBitsWaitedFor, uxControlBits;
+EventBits_t uxBitsToClear = 0;
 EventGroup_t *pxEventBits = xEventGroup;
-BaseType_t xMatchFound = pdFALSE;
 
 	/* Check the user is not attempting to set the bits used by the kernel
 	itself. */
 	configASSERT( xEventGroup );
 	configASSERT( ( uxBitsToSet & eventEVENT_BITS_CONTROL_BYTES ) == 0 );
 
-	pxList = &( pxEventBits->xTasksWaitingForBits );
-	pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
 	vTaskSuspendAll();
 	{
 		traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet );
 
-		pxListItem = listGET_HEAD_ENTRY( pxList );
-
 		/* Set the bits. */
 		pxEventBits->uxEventBits |= uxBitsToSet;
 
 		/* See if the new bit value should unblock any tasks. */
-		while( pxListItem != pxListEnd )
+		#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
 		{
-			pxNext = listGET_NEXT( pxListItem );
-			uxBitsWaitedFor = listGET_LIST_ITEM_VALUE( pxListItem );
-			xMatchFound = pdFALSE;
+		EventBits_t uxBitsToTest = uxBitsToSet, uxBit = ( EventBits_t ) 1;
+		UBaseType_t uxIndex = 0;
 
-			/* Split the bits waited for from the control bits. */
-			uxControlBits = uxBitsWaitedFor & eventEVENT_BITS_CONTROL_BYTES;
-			uxBitsWaitedFor &= ~eventEVENT_BITS_CONTROL_BYTES;
-
-			if( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) == ( EventBits_t ) 0 )
+			/* Only the tasks listed under the bits being set can have had
+			their wait condition met.  The lists of bits that were already set
+			are empty, as setting a bit empties its list. */
+			while( uxBitsToTest != ( EventBits_t ) 0 )
 			{
-				/* Just looking for single bit being set. */
-				if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) != ( EventBits_t ) 0 )
+				if( ( uxBitsToTest & uxBit ) != ( EventBits_t ) 0 )
 				{
-					xMatchFound = pdTRUE;
+					uxBitsToTest &= ~uxBit;
+
+					if( listLIST_IS_EMPTY( &( pxEventBits->xTasksWaitingForBit[ uxIndex ] ) ) == pdFALSE )
+					{
+						uxBitsToClear |= prvUnblockWaitingTasks( pxEventBits, &( pxEventBits->xTasksWaitingForBit[ uxIndex ] ) );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
 				}
 				else
 				{
 					mtCOVERAGE_TEST_MARKER();
 				}
+
+				uxBit <<= 1;
+				uxIndex++;
+			}
+
+			if( ( uxBitsToSet & pxEventBits->uxBitsWaitedForAny ) != ( EventBits_t ) 0 )
+			{
+				uxBitsToClear |= prvUnblockWaitingTasks( pxEventBits, &( pxEventBits->xTasksWaitingForBits ) );
 			}
-			else if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) == uxBitsWaitedFor )
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
+		{
+			uxBitsToClear = prvUnblockWaitingTasks( pxEventBits, &( pxEventBits->xTasksWaitingForBits ) );
+		}
+		#endif /* configUSE_EVENT_GROUP_BIT_INDEX */
+
+		/* Clear any bits that matched when the eventCLEAR_EVENTS_ON_EXIT_BIT
+		bit was set in the control word. */
+		pxEventBits->uxEventBits &= ~uxBitsToClear;
+
+		traceEVENT_GROUP_SET_BITS_END( xEventGroup, uxBitsToSet );
+	}
+	( void ) xTaskResumeAll();
+
+	return pxEventBits->uxEventBits;
+}
+/*-----------------------------------------------------------*/
+
+static EventBits_t prvUnblockWaitingTasks( EventGroup_t *pxEventBits, List_t * const pxList )
+{
+ListItem_t *pxListItem, *pxNext;
+ListItem_t const *pxListEnd;
+EventBits_t uxBitsToClear = 0, uxBitsWaitedFor, uxControlBits;
+BaseType_t xMatchFound;
+
+	#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+		EventBits_t uxBitsStillWaitedFor = 0;
+	#endif
+
+	pxListEnd = listGET_END_MARKER( pxList ); /*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+	pxListItem = listGET_HEAD_ENTRY( pxList );
+
+	while( pxListItem != pxListEnd )
+	{
+		pxNext = listGET_NEXT( pxListItem );
+		uxBitsWaitedFor = listGET_LIST_ITEM_VALUE( pxListItem );
+		xMatchFound = pdFALSE;
+
+		/* Split the bits waited for from the control bits. */
+		uxControlBits = uxBitsWaitedFor & eventEVENT_BITS_CONTROL_BYTES;
+		uxBitsWaitedFor &= ~eventEVENT_BITS_CONTROL_BYTES;
+
+		if( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) == ( EventBits_t ) 0 )
+		{
+			/* Just looking for single bit being set. */
+			if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) != ( EventBits_t ) 0 )
 			{
-				/* All bits are set. */
 				xMatchFound = pdTRUE;
 			}
 			else
 			{
-				/* Need all bits to be set, but not all the bits were set. */
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else if( ( uxBitsWaitedFor & pxEventBits->uxEventBits ) == uxBitsWaitedFor )
+		{
+			/* All bits are set. */
+			xMatchFound = pdTRUE;
+		}
+		else
+		{
+			/* Need all bits to be set, but not all the bits were set. */
+		}
+
+		if( xMatchFound != pdFALSE )
+		{
+			/* The bits match.  Should the bits be cleared on exit? */
+			if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
+			{
+				uxBitsToClear |= uxBitsWaitedFor;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
 			}
 
-			if( xMatchFound != pdFALSE )
+			/* Store the actual event flag value in the task's event list
+			item before removing the task from the event list.  The
+			eventUNBLOCKED_DUE_TO_BIT_SET bit is set so the task knows
+			that is was unblocked due to its required bits matching, rather
+			than because it timed out. */
+			vTaskRemoveFromUnorderedEventList( pxListItem, pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET );
+		}
+		else
+		{
+			#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
 			{
-				/* The bits match.  Should the bits be cleared on exit? */
-				if( ( uxControlBits & eventCLEAR_EVENTS_ON_EXIT_BIT ) != ( EventBits_t ) 0 )
+				if( pxList == &( pxEventBits->xTasksWaitingForBits ) )
 				{
-					uxBitsToClear |= uxBitsWaitedFor;
+					uxBitsStillWaitedFor |= uxBitsWaitedFor;
 				}
 				else
 				{
-					mtCOVERAGE_TEST_MARKER();
+					/* The bit the task was listed under is now set, but it
+					still needs others.  List it under one of those instead.
+					That bit is not set so is not one of the bits being tested
+					by the caller, and the task is not seen again. */
+					( void ) uxListRemove( pxListItem );
+					vListInsertEnd( prvGetWaitingList( pxEventBits, uxBitsWaitedFor, uxControlBits ), pxListItem );
 				}
+			}
+			#endif /* configUSE_EVENT_GROUP_BIT_INDEX */
+		}
 
-				/* Store the actual event flag value in the task's event list
-				item before removing the task from the event list.  The
-				eventUNBLOCKED_DUE_TO_BIT_SET bit is set so the task knows
-				that is was unblocked due to its required bits matching, rather
-				than because it timed out. */
-				vTaskRemoveFromUnorderedEventList( pxListItem, pxEventBits->uxEventBits | eventUNBLOCKED_DUE_TO_BIT_SET );
+		/* Move onto the next list item.  Note pxListItem->pxNext is not
+		used here as the list item may have been removed from the event list
+		and inserted into the ready/pending reading list. */
+		pxListItem = pxNext;
+	}
+
+	#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+	{
+		if( pxList == &( pxEventBits->xTasksWaitingForBits ) )
+		{
+			/* Drop the bits of tasks that have since been unblocked or timed
+			out. */
+			pxEventBits->uxBitsWaitedForAny = uxBitsStillWaitedFor;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif /* configUSE_EVENT_GROUP_BIT_INDEX */
+
+	return uxBitsToClear;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseWaitingLists( EventGroup_t *pxEventBits )
+{
+	vListInitialise( &( pxEventBits->xTasksWaitingForBits ) );
+
+	#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+	{
+	UBaseType_t uxIndex;
+
+		for( uxIndex = ( UBaseType_t ) 0U; uxIndex < ( UBaseType_t ) eventNUMBER_OF_BITS; uxIndex++ )
+		{
+			vListInitialise( &( pxEventBits->xTasksWaitingForBit[ uxIndex ] ) );
+		}
+
+		pxEventBits->uxBitsWaitedForAny = 0;
+	}
+	#endif /* configUSE_EVENT_GROUP_BIT_INDEX */
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+
+	static List_t *prvGetWaitingList( EventGroup_t *pxEventBits, const EventBits_t uxBitsWaitedFor, const EventBits_t uxControlBits )
+	{
+	List_t *pxList;
+	EventBits_t uxBitsNotSet;
+	UBaseType_t uxIndex = 0;
+
+		if( ( ( uxControlBits & eventWAIT_FOR_ALL_BITS ) != ( EventBits_t ) 0 ) || ( ( uxBitsWaitedFor & ( uxBitsWaitedFor - ( EventBits_t ) 1 ) ) == ( EventBits_t ) 0 ) )
+		{
+			/* The task cannot be unblocked until the lowest of its bits that
+			is not set is set.  The caller only blocks the task if its wait
+			condition is not met, so there is such a bit. */
+			uxBitsNotSet = uxBitsWaitedFor & ~( pxEventBits->uxEventBits );
+			configASSERT( uxBitsNotSet != ( EventBits_t ) 0 );
+
+			while( ( uxBitsNotSet & ( EventBits_t ) 1 ) == ( EventBits_t ) 0 )
+			{
+				uxBitsNotSet >>= 1;
+				uxIndex++;
 			}
 
-			/* Move onto the next list item.  Note pxListItem->pxNext is not
-			used here as the list item may have been removed from the event list
-			and inserted into the ready/pending reading list. */
-			pxListItem = pxNext;
+			pxList = &( pxEventBits->xTasksWaitingForBit[ uxIndex ] );
+		}
+		else
+		{
+			pxEventBits->uxBitsWaitedForAny |= uxBitsWaitedFor;
+			pxList = &( pxEventBits->xTasksWaitingForBits );
 		}
 
-		/* Clear any bits that matched when the eventCLEAR_EVENTS_ON_EXIT_BIT
-		bit was set in the control word. */
-		pxEventBits->uxEventBits &= ~uxBitsToClear;
+		return pxList;
 	}
-	( void ) xTaskResumeAll();
 
-	return pxEventBits->uxEventBits;
-}
+#endif /* configUSE_EVENT_GROUP_BIT_INDEX */
 /*-----------------------------------------------------------*/
 
 void vEventGroupDelete( EventGroupHandle_t xEventGroup )
@@ -627,6 +824,23 @@ const List_t *pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBits );
 			vTaskRemoveFromUnorderedEventList( pxTasksWaitingForBits->xListEnd.pxNext, eventUNBLOCKED_DUE_TO_BIT_SET );
 		}
 
+		#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+		{
+		UBaseType_t uxIndex;
+
+			for( uxIndex = ( UBaseType_t ) 0U; uxIndex < ( UBaseType_t ) eventNUMBER_OF_BITS; uxIndex++ )
+			{
+				pxTasksWaitingForBits = &( pxEventBits->xTasksWaitingForBit[ uxIndex ] );
+
+				while( listCURRENT_LIST_LENGTH( pxTasksWaitingForBits ) > ( UBaseType_t ) 0 )
+				{
+					configASSERT( pxTasksWaitingForBits->xListEnd.pxNext != ( const ListItem_t * ) &( pxTasksWaitingForBits->xListEnd ) );
+					vTaskRemoveFromUnorderedEventList( pxTasksWaitingForBits->xListEnd.pxNext, eventUNBLOCKED_DUE_TO_BIT_SET );
+				}
+			}
+		}
+		#endif /* configUSE_EVENT_GROUP_BIT_INDEX */
+
 		#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
 		{
 			/* The event group can only have been allocated dynamically - free
@@ -30,6 +30,41 @@
 #include "FreeRTOS.h"
 #include "list.h"
 
+#if( configUSE_INDEXED_LISTS == 1 )
+
+	/* Indexed lists keep a treap alongside the linked list.  The tree is
+	ordered exactly as the linked list (an in-order walk of the tree visits the
+	items in list order), so the tree only ever has to be searched, never
+	compared against the list.  The heap priority of an item is derived from
+	its address, so it is fixed for the lifetime of the item and needs no
+	storage. */
+	#define listTREE_PRIORITY( pxItem )	( ( uint32_t ) ( ( portPOINTER_SIZE_TYPE ) ( pxItem ) ) * 0x9E3779B1UL )
+
+	/*
+	 * Returns the item after which an item of value xValue has to be inserted
+	 * to keep pxList sorted - the last item with a value less than or equal to
+	 * xValue, or the list end marker if there is no such item.
+	 */
+	static ListItem_t *prvTreeSearch( List_t * const pxList, const TickType_t xValue ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Adds pxItem, which has already been linked into pxList, to the tree at
+	 * the position matching its place in the list.
+	 */
+	static void prvTreeLink( List_t * const pxList, ListItem_t * const pxItem ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Removes pxItem from the tree of pxList.
+	 */
+	static void prvTreeUnlink( List_t * const pxList, ListItem_t * const pxItem ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Rotates pxItem above its parent, preserving the in-order sequence.
+	 */
+	static void prvTreeRotateUp( List_t * const pxList, ListItem_t * const pxItem ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_INDEXED_LISTS */
+
 /*-----------------------------------------------------------
  * PUBLIC LIST API documented in list.h
  *----------------------------------------------------------*/
@@ -56,9 +91,27 @@ void vListInitialise( List_t * const pxList )
 	configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
 	listSET_LIST_INTEGRITY_CHECK_1_VALUE( pxList );
 	listSET_LIST_INTEGRITY_CHECK_2_VALUE( pxList );
+
+	#if( configUSE_INDEXED_LISTS == 1 )
+	{
+		pxList->pxTreeRoot = NULL;
+		pxList->xIndexed = pdFALSE;
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_INDEXED_LISTS == 1 )
+
+	void vListInitialiseIndexed( List_t * const pxList )
+	{
+		vListInitialise( pxList );
+		pxList->xIndexed = pdTRUE;
+	}
+
+#endif /* configUSE_INDEXED_LISTS */
+/*-----------------------------------------------------------*/
+
 void vListInitialiseItem( ListItem_t * const pxItem )
 {
 	/* Make sure the list item is not recorded as being on a list. */
@@ -96,6 +149,19 @@ ListItem_t * const pxIndex = pxList->pxIndex;
 	/* Remember which list the item is in. */
 	pxNewListItem->pxContainer = pxList;
 
+	#if( configUSE_INDEXED_LISTS == 1 )
+	{
+		if( pxList->xIndexed != pdFALSE )
+		{
+			prvTreeLink( pxList, pxNewListItem );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
 	( pxList->uxNumberOfItems )++;
 }
 /*-----------------------------------------------------------*/
@@ -123,6 +189,13 @@ const TickType_t xValueOfInsertion = pxNewListItem->xItemValue;
 	{
 		pxIterator = pxList->xListEnd.pxPrevious;
 	}
+	#if( configUSE_INDEXED_LISTS == 1 )
+		else if( pxList->xIndexed != pdFALSE )
+		{
+			/* Find the same position as the loop below, but in O(log n). */
+			pxIterator = prvTreeSearch( pxList, xValueOfInsertion );
+		}
+	#endif
 	else
 	{
 		/* *** NOTE ***********************************************************
@@ -163,6 +236,19 @@ const TickType_t xValueOfInsertion = pxNewListItem->xItemValue;
 	item later. */
 	pxNewListItem->pxContainer = pxList;
 
+	#if( configUSE_INDEXED_LISTS == 1 )
+	{
+		if( pxList->xIndexed != pdFALSE )
+		{
+			prvTreeLink( pxList, pxNewListItem );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
 	( pxList->uxNumberOfItems )++;
 }
 /*-----------------------------------------------------------*/
@@ -173,6 +259,19 @@ UBaseType_t uxListRemove( ListItem_t * const pxItemToRemove )
 item. */
 List_t * const pxList = pxItemToRemove->pxContainer;
 
+	#if( configUSE_INDEXED_LISTS == 1 )
+	{
+		if( pxList->xIndexed != pdFALSE )
+		{
+			prvTreeUnlink( pxList, pxItemToRemove );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
 	pxItemToRemove->pxNext->pxPrevious = pxItemToRemove->pxPrevious;
 	pxItemToRemove->pxPrevious->pxNext = pxItemToRemove->pxNext;
 
@@ -196,3 +295,164 @@ List_t * const pxList = pxItemToRemove->pxContainer;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_INDEXED_LISTS == 1 )
+
+	static ListItem_t *prvTreeSearch( List_t * const pxList, const TickType_t xValue )
+	{
+	ListItem_t *pxNode = pxList->pxTreeRoot;
+	ListItem_t *pxInsertAfter = ( ListItem_t * ) &( pxList->xListEnd );	/*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+
+		/* Items with the same value are kept in insertion order, so the new
+		item goes after every item whose value is less than or equal to its
+		own. */
+		while( pxNode != NULL )
+		{
+			if( pxNode->xItemValue <= xValue )
+			{
+				pxInsertAfter = pxNode;
+				pxNode = pxNode->pxTreeRight;
+			}
+			else
+			{
+				pxNode = pxNode->pxTreeLeft;
+			}
+		}
+
+		return pxInsertAfter;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTreeLink( List_t * const pxList, ListItem_t * const pxItem )
+	{
+	const ListItem_t * const pxListEnd = ( ListItem_t * ) &( pxList->xListEnd );	/*lint !e826 !e740 !e9087 The mini list structure is used as the list end to save RAM.  This is checked and valid. */
+	ListItem_t * const pxPrevious = pxItem->pxPrevious;
+	ListItem_t * const pxNext = pxItem->pxNext;
+
+		pxItem->pxTreeLeft = NULL;
+		pxItem->pxTreeRight = NULL;
+
+		/* The item sits between its list neighbours, so in the tree it must
+		become either the right child of the previous item or the left child
+		of the next item - whichever of the two slots is free.  The end marker
+		is never part of the tree. */
+		if( ( pxPrevious != pxListEnd ) && ( pxPrevious->pxTreeRight == NULL ) )
+		{
+			pxPrevious->pxTreeRight = pxItem;
+			pxItem->pxTreeParent = pxPrevious;
+		}
+		else if( pxNext != pxListEnd )
+		{
+			configASSERT( pxNext->pxTreeLeft == NULL );
+			pxNext->pxTreeLeft = pxItem;
+			pxItem->pxTreeParent = pxNext;
+		}
+		else
+		{
+			/* The item is the only one in the list. */
+			pxList->pxTreeRoot = pxItem;
+			pxItem->pxTreeParent = NULL;
+		}
+
+		/* Restore the heap order of the priorities. */
+		while( ( pxItem->pxTreeParent != NULL ) && ( listTREE_PRIORITY( pxItem ) > listTREE_PRIORITY( pxItem->pxTreeParent ) ) )
+		{
+			prvTreeRotateUp( pxList, pxItem );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTreeUnlink( List_t * const pxList, ListItem_t * const pxItem )
+	{
+	ListItem_t *pxChild;
+	ListItem_t *pxParent;
+
+		/* Rotate the item down until it has at most one child, always lifting
+		the child with the higher priority so the heap order holds. */
+		while( ( pxItem->pxTreeLeft != NULL ) && ( pxItem->pxTreeRight != NULL ) )
+		{
+			if( listTREE_PRIORITY( pxItem->pxTreeLeft ) > listTREE_PRIORITY( pxItem->pxTreeRight ) )
+			{
+				prvTreeRotateUp( pxList, pxItem->pxTreeLeft );
+			}
+			else
+			{
+				prvTreeRotateUp( pxList, pxItem->pxTreeRight );
+			}
+		}
+
+		/* Replace the item with its only child, if any. */
+		pxChild = ( pxItem->pxTreeLeft != NULL ) ? pxItem->pxTreeLeft : pxItem->pxTreeRight;
+		pxParent = pxItem->pxTreeParent;
+
+		if( pxChild != NULL )
+		{
+			pxChild->pxTreeParent = pxParent;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( pxParent == NULL )
+		{
+			pxList->pxTreeRoot = pxChild;
+		}
+		else if( pxParent->pxTreeLeft == pxItem )
+		{
+			pxParent->pxTreeLeft = pxChild;
+		}
+		else
+		{
+			pxParent->pxTreeRight = pxChild;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTreeRotateUp( List_t * const pxList, ListItem_t * const pxItem )
+	{
+	ListItem_t * const pxParent = pxItem->pxTreeParent;
+	ListItem_t * const pxGrandParent = pxParent->pxTreeParent;
+	ListItem_t *pxMoved;
+
+		if( pxParent->pxTreeLeft == pxItem )
+		{
+			pxMoved = pxItem->pxTreeRight;
+			pxParent->pxTreeLeft = pxMoved;
+			pxItem->pxTreeRight = pxParent;
+		}
+		else
+		{
+			pxMoved = pxItem->pxTreeLeft;
+			pxParent->pxTreeRight = pxMoved;
+			pxItem->pxTreeLeft = pxParent;
+		}
+
+		if( pxMoved != NULL )
+		{
+			pxMoved->pxTreeParent = pxParent;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxParent->pxTreeParent = pxItem;
+		pxItem->pxTreeParent = pxGrandParent;
+
+		if( pxGrandParent == NULL )
+		{
+			pxList->pxTreeRoot = pxItem;
+		}
+		else if( pxGrandParent->pxTreeLeft == pxParent )
+		{
+			pxGrandParent->pxTreeLeft = pxItem;
+		}
+		else
+		{
+			pxGrandParent->pxTreeRight = pxItem;
+		}
+	}
+
+#endif /* configUSE_INDEXED_LISTS */
+/*-----------------------------------------------------------*/
+
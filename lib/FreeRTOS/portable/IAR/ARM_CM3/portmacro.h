@@ -164,6 +164,9 @@ not necessary for to use this port.  They are defined so the common demo files
 /* portNOP() is not required by this port. */
 #define portNOP()
 
+/* Only one core runs code, so a compiler barrier is enough. */
+#define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
+
 /*-----------------------------------------------------------*/
 
 /* Suppress warnings that are generated by the IAR tools, but cannot be fixed in
@@ -0,0 +1,1287 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * A sample implementation of pvPortMalloc() that, like heap_5.c, allows the
+ * heap to be defined across multiple non-contiguous blocks and combines
+ * (coalescences) adjacent memory blocks as they are freed, but that finds and
+ * frees blocks in a time that does not depend on the number of free blocks.
+ *
+ * Free blocks are held in a two level segregated fit (TLSF) structure.  The
+ * first level splits block sizes into powers of two, and the second level
+ * splits each power of two into heapSL_INDEX_COUNT equal ranges.  Each range
+ * has its own list of free blocks, and a bitmap per level records which lists
+ * are not empty, so the smallest range that can hold a request is found with a
+ * few bit operations rather than by walking a list.  Each block also records
+ * the block in front of it in memory, so a freed block is merged with its
+ * neighbours without searching for them.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c, heap_4.c and heap_5.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ *
+ * Usage notes:
+ *
+ * vPortDefineHeapRegions() ***must*** be called before pvPortMalloc().
+ * pvPortMalloc() will be called if any task objects (tasks, queues, event
+ * groups, etc.) are created, therefore vPortDefineHeapRegions() ***must*** be
+ * called before any other objects are defined.
+ *
+ * vPortDefineHeapRegions() takes a single parameter.  The parameter is an array
+ * of HeapRegion_t structures, terminated using a NULL zero sized region
+ * definition, exactly as described in heap_5.c.  The regions do not have to
+ * be in address order when heap_6.c is used.
+ *
+ * A single block can be no larger than heapMAXIMUM_BLOCK_SIZE bytes, and any
+ * part of a region beyond that size is not used.
+ *
+ * If configUSE_HEAP_TASK_CACHES is 1 then each task that allocates small
+ * blocks keeps a cache of up to configHEAP_TASK_CACHE_DEPTH freed blocks of
+ * each of heapCACHE_CLASSES sizes, pointed to by its thread local storage
+ * pointer configHEAP_TASK_CACHE_TLS_INDEX.  A task allocates from and frees to
+ * its own cache without suspending the scheduler, so tasks that allocate and
+ * free small blocks often do not wait for each other.  A freed block is cached
+ * in the largest class it can hold, as a block is not split when the part left
+ * over would be too small to be a block of its own.  Blocks that were not
+ * taken from a cache during configHEAP_TASK_CACHE_TRIM_TICKS are returned to
+ * the heap, either by the task itself or by vPortTrimTaskCaches(), which the
+ * idle task calls, as are all the blocks of a task that is deleted.
+ * xPortGetFreeHeapSize() does not include the bytes held in caches, which are
+ * returned by xPortGetCachedHeapSize(), or by xPortGetTaskCachedHeapSize() for
+ * the cache of the calling task alone.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* Assumes 8bit bytes! */
+#define heapBITS_PER_BYTE		( ( size_t ) 8 )
+
+/* Each power of two is split into 2 ^ heapSL_INDEX_COUNT_LOG2 second level
+ranges.  Blocks smaller than heapSMALL_BLOCK_SIZE are all held under the first
+first level index, in ranges of heapSMALL_BLOCK_STEP bytes. */
+#define heapSL_INDEX_COUNT_LOG2	( 4U )
+#define heapSL_INDEX_COUNT		( 1U << heapSL_INDEX_COUNT_LOG2 )
+#define heapFL_INDEX_SHIFT		( heapSL_INDEX_COUNT_LOG2 + 3U )
+#define heapSMALL_BLOCK_SIZE	( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+#define heapSMALL_BLOCK_STEP	( heapSMALL_BLOCK_SIZE / heapSL_INDEX_COUNT )
+
+/* The first level bitmap is 32 bits, which limits the largest block size. */
+#define heapFL_INDEX_MAX		( 30U )
+#define heapFL_INDEX_COUNT		( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 2U )
+#define heapMAXIMUM_BLOCK_SIZE	( ( ( size_t ) 1 << ( heapFL_INDEX_MAX + 1U ) ) - portBYTE_ALIGNMENT )
+
+/* Define the block header.  Only pxPreviousPhysicalBlock and xBlockSize are
+kept while a block is allocated.  pxNextFreeBlock and pxPreviousFreeBlock are
+only valid while the block is free, and occupy the start of the memory that is
+returned to the application when it is allocated. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxPreviousPhysicalBlock;	/*<< The block that ends where this block starts, or NULL for the first block in a region. */
+	size_t xBlockSize;								/*<< The size of the block, including this header. */
+	struct A_BLOCK_LINK *pxNextFreeBlock;			/*<< The next block in the same free list. */
+	struct A_BLOCK_LINK *pxPreviousFreeBlock;		/*<< The previous block in the same free list. */
+} BlockLink_t;
+
+#if( configUSE_HEAP_TASK_CACHES == 1 )
+
+	#if( portBYTE_ALIGNMENT > 32 )
+		#error configUSE_HEAP_TASK_CACHES cannot be used when portBYTE_ALIGNMENT is above 32
+	#endif
+
+	#ifndef portMEMORY_BARRIER
+		#error configUSE_HEAP_TASK_CACHES requires portMEMORY_BARRIER() to be defined in portmacro.h
+	#endif
+
+	/* Task caches hold blocks for allocations of up to heapCACHE_SIZE( n )
+	bytes, for each of the classes n, and each size is double the size of the
+	class below. */
+	#define heapCACHE_CLASSES				( 4U )
+	#define heapCACHE_SIZE( uxClass )		( ( ( size_t ) 32 ) << ( uxClass ) )
+	#define heapCACHE_LARGEST_SIZE			heapCACHE_SIZE( heapCACHE_CLASSES - 1U )
+	#define heapCACHE_BLOCK_SIZE( uxClass )	( heapCACHE_SIZE( uxClass ) + xHeapStructSize )
+
+	/* The blocks cached by one task, linked through pxNextFreeBlock.  Cached
+	blocks are still marked as allocated. */
+	typedef struct HEAP_TASK_CACHE
+	{
+		BlockLink_t *pxBlocks[ heapCACHE_CLASSES ];
+		UBaseType_t uxCount[ heapCACHE_CLASSES ];
+		UBaseType_t uxLowCount[ heapCACHE_CLASSES ];	/*<< The fewest blocks in the class since the cache was last trimmed. */
+		size_t xCachedBytes;							/*<< The total size of the cached blocks, including their headers. */
+		TickType_t xLastTrimTime;
+		volatile BaseType_t xInUse;						/*<< Set while the task changes its cache, which vPortTrimTaskCaches() then leaves alone. */
+		struct HEAP_TASK_CACHE *pxNextCache;			/*<< The caches of all tasks are linked so the bytes they hold can be totalled. */
+		struct HEAP_TASK_CACHE *pxPreviousCache;
+	} TaskCache_t;
+
+#endif /* configUSE_HEAP_TASK_CACHES */
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Return the first and second level indexes of the free list that holds
+ * blocks of xBlockSize bytes.
+ */
+static void prvMappingInsert( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel );
+
+/*
+ * Return the first and second level indexes of the smallest free list whose
+ * blocks are all at least xBlockSize bytes.
+ */
+static void prvMappingSearch( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel );
+
+/*
+ * Add a free block to, or remove a free block from, the free list for its
+ * size.
+ */
+static void prvInsertBlockIntoFreeList( BlockLink_t *pxBlockToInsert );
+static void prvRemoveBlockFromFreeList( BlockLink_t *pxBlockToRemove );
+
+/*
+ * Remove and return a free block of at least xWantedSize bytes, or return
+ * NULL if there is none.
+ */
+static BlockLink_t *prvTakeFreeBlock( size_t xWantedSize );
+
+/*
+ * Return the position of the lowest or highest set bit in a non zero value.
+ */
+static UBaseType_t prvLowestSetBit( uint32_t ulValue );
+static UBaseType_t prvHighestSetBit( size_t xValue );
+
+/*
+ * Allocate a block of xWantedSize bytes, including the header, from the free
+ * lists, or free an allocated block back to them.  Called with the scheduler
+ * suspended.
+ */
+static BlockLink_t *prvAllocateBlock( size_t xWantedSize );
+static void prvFreeBlock( BlockLink_t *pxLink );
+
+#if( configUSE_HEAP_TASK_CACHES == 1 )
+
+	/*
+	 * Return the smallest cache class that holds allocations of xSize bytes.
+	 */
+	static UBaseType_t prvCacheClass( size_t xSize );
+
+	/*
+	 * Return the cache of the calling task, creating it if xCreate is pdTRUE.
+	 * Returns NULL if the scheduler is not running.
+	 */
+	static TaskCache_t *prvGetTaskCache( BaseType_t xCreate );
+
+	/*
+	 * Mark the cache of the calling task as in use and return it, or return
+	 * NULL if the task cannot use its cache now.  prvReleaseTaskCache() ends
+	 * the use.
+	 */
+	static TaskCache_t *prvAcquireTaskCache( BaseType_t xCreate );
+	static void prvReleaseTaskCache( TaskCache_t *pxCache );
+
+	/*
+	 * Take a block of the given class from, or add a block to, the cache of
+	 * the calling task.  prvAddToTaskCache() returns pdFALSE if the block is
+	 * not kept in the cache.
+	 */
+	static BlockLink_t *prvTakeFromTaskCache( UBaseType_t uxClass );
+	static BaseType_t prvAddToTaskCache( BlockLink_t *pxBlock );
+
+	/*
+	 * Return the blocks that were not used since the cache was last trimmed to
+	 * the heap, if configHEAP_TASK_CACHE_TRIM_TICKS have passed since then.
+	 */
+	static void prvTrimTaskCache( TaskCache_t *pxCache );
+
+#endif /* configUSE_HEAP_TASK_CACHES */
+
+/*-----------------------------------------------------------*/
+
+/* The size of the part of the structure placed at the beginning of each
+allocated memory block must by correctly byte aligned. */
+static const size_t xHeapStructSize	= ( ( sizeof( BlockLink_t * ) + sizeof( size_t ) ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* Block sizes must not get too small, as a free block must hold the whole
+structure. */
+static const size_t xMinimumBlockSize = ( sizeof( BlockLink_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* The free lists, and the bitmaps of the lists that are not empty. */
+static BlockLink_t *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+static uint32_t ulFirstLevelBitmap = 0U;
+static uint32_t ulSecondLevelBitmaps[ heapFL_INDEX_COUNT ];
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* Gets set to the top bit of an size_t type.  When this bit in the xBlockSize
+member of an BlockLink_t structure is set then the block belongs to the
+application.  When the bit is free the block is still part of the free heap
+space. */
+static size_t xBlockAllocatedBit = 0;
+
+#if( configUSE_HEAP_TASK_CACHES == 1 )
+	static TaskCache_t *pxTaskCaches = NULL;
+#endif
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+BlockLink_t *pxBlock = NULL;
+void *pvReturn = NULL;
+
+	#if( configUSE_HEAP_TASK_CACHES == 1 )
+		UBaseType_t uxClass;
+	#endif
+
+	/* The heap must be initialised before the first call to
+	prvPortMalloc(). */
+	configASSERT( xBlockAllocatedBit );
+
+	/* Check the requested block size is not so large that it could not be
+	held in any block. */
+	if( ( xWantedSize > 0 ) && ( xWantedSize <= ( heapMAXIMUM_BLOCK_SIZE - xHeapStructSize ) ) )
+	{
+		#if( configUSE_HEAP_TASK_CACHES == 1 )
+		{
+			if( xWantedSize <= heapCACHE_LARGEST_SIZE )
+			{
+				/* Small blocks are allocated in the sizes the task caches
+				hold, and taken from the calling task's cache if it has one
+				of the right size. */
+				uxClass = prvCacheClass( xWantedSize );
+				xWantedSize = heapCACHE_SIZE( uxClass );
+				pxBlock = prvTakeFromTaskCache( uxClass );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_HEAP_TASK_CACHES */
+
+		/* The wanted size is increased so it can contain the block header
+		in addition to the requested amount of bytes. */
+		xWantedSize += xHeapStructSize;
+
+		/* Ensure that blocks are always aligned to the required number of
+		bytes. */
+		if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+		{
+			/* Byte alignment required. */
+			xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( xWantedSize < xMinimumBlockSize )
+		{
+			xWantedSize = xMinimumBlockSize;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( pxBlock == NULL )
+		{
+			vTaskSuspendAll();
+			{
+				pxBlock = prvAllocateBlock( xWantedSize );
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( pxBlock != NULL )
+		{
+			/* Return the memory space pointed to - jumping over the block
+			header at its start. */
+			pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	traceMALLOC( pvReturn, xWantedSize );
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+uint8_t *puc = ( uint8_t * ) pv;
+BlockLink_t *pxLink;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a block header immediately before
+		it. */
+		puc -= xHeapStructSize;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxLink = ( void * ) puc;
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxLink->xBlockSize & xBlockAllocatedBit ) != 0 );
+
+		if( ( pxLink->xBlockSize & xBlockAllocatedBit ) != 0 )
+		{
+			traceFREE( pv, pxLink->xBlockSize & ~xBlockAllocatedBit );
+
+			#if( configUSE_HEAP_TASK_CACHES == 1 )
+			{
+				/* The block is kept by the calling task if it is one of the
+				sizes the task caches hold. */
+				if( prvAddToTaskCache( pxLink ) != pdFALSE )
+				{
+					pxLink = NULL;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_HEAP_TASK_CACHES */
+
+			if( pxLink != NULL )
+			{
+				vTaskSuspendAll();
+				{
+					prvFreeBlock( pxLink );
+				}
+				( void ) xTaskResumeAll();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvAllocateBlock( size_t xWantedSize )
+{
+BlockLink_t *pxBlock = NULL, *pxNewBlockLink, *pxNextBlock;
+
+	if( xWantedSize <= xFreeBytesRemaining )
+	{
+		pxBlock = prvTakeFreeBlock( xWantedSize );
+
+		if( pxBlock != NULL )
+		{
+			/* If the block is larger than required it can be split into
+			two. */
+			if( ( pxBlock->xBlockSize - xWantedSize ) >= xMinimumBlockSize )
+			{
+				/* This block is to be split into two.  Create a new block
+				following the number of bytes requested. The void cast is used
+				to prevent byte alignment warnings from the compiler. */
+				pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+				pxNewBlockLink->xBlockSize = pxBlock->xBlockSize - xWantedSize;
+				pxNewBlockLink->pxPreviousPhysicalBlock = pxBlock;
+				pxBlock->xBlockSize = xWantedSize;
+
+				/* The block after the new block is now behind the new
+				block. */
+				pxNextBlock = ( void * ) ( ( ( uint8_t * ) pxNewBlockLink ) + pxNewBlockLink->xBlockSize );
+				pxNextBlock->pxPreviousPhysicalBlock = pxNewBlockLink;
+
+				/* Insert the new block into the list of free blocks. */
+				prvInsertBlockIntoFreeList( pxNewBlockLink );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			xFreeBytesRemaining -= pxBlock->xBlockSize;
+
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* The block is being returned - it is allocated and owned by the
+			application. */
+			pxBlock->xBlockSize |= xBlockAllocatedBit;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeBlock( BlockLink_t *pxLink )
+{
+BlockLink_t *pxNeighbour;
+
+	/* The block is being returned to the heap - it is no longer
+	allocated. */
+	pxLink->xBlockSize &= ~xBlockAllocatedBit;
+	xFreeBytesRemaining += pxLink->xBlockSize;
+
+	/* Merge the block with the block in front of it if that block is free. */
+	pxNeighbour = pxLink->pxPreviousPhysicalBlock;
+
+	if( ( pxNeighbour != NULL ) && ( ( pxNeighbour->xBlockSize & xBlockAllocatedBit ) == 0 ) )
+	{
+		prvRemoveBlockFromFreeList( pxNeighbour );
+		pxNeighbour->xBlockSize += pxLink->xBlockSize;
+		pxLink = pxNeighbour;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	/* Merge the block with the block behind it if that block is free.  The
+	last block in each region is a marker that is always allocated. */
+	pxNeighbour = ( void * ) ( ( ( uint8_t * ) pxLink ) + pxLink->xBlockSize );
+
+	if( ( pxNeighbour->xBlockSize & xBlockAllocatedBit ) == 0 )
+	{
+		prvRemoveBlockFromFreeList( pxNeighbour );
+		pxLink->xBlockSize += pxNeighbour->xBlockSize;
+		pxNeighbour = ( void * ) ( ( ( uint8_t * ) pxLink ) + pxLink->xBlockSize );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxNeighbour->pxPreviousPhysicalBlock = pxLink;
+
+	/* Add this block to the list of free blocks. */
+	prvInsertBlockIntoFreeList( pxLink );
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_HEAP_TASK_CACHES == 1 )
+
+	static UBaseType_t prvCacheClass( size_t xSize )
+	{
+	UBaseType_t uxClass = 0;
+
+		while( xSize > heapCACHE_SIZE( uxClass ) )
+		{
+			uxClass++;
+		}
+
+		return uxClass;
+	}
+	/*-----------------------------------------------------------*/
+
+	static TaskCache_t *prvGetTaskCache( BaseType_t xCreate )
+	{
+	TaskCache_t *pxCache = NULL;
+	BlockLink_t *pxBlock;
+
+		/* Only tasks have caches, and a task only uses its own cache, so the
+		cache is used without suspending the scheduler. */
+		if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
+		{
+			pxCache = ( TaskCache_t * ) pvTaskGetThreadLocalStoragePointer( NULL, configHEAP_TASK_CACHE_TLS_INDEX );
+
+			if( ( pxCache == NULL ) && ( xCreate != pdFALSE ) )
+			{
+				/* The cache is allocated from the free lists directly, as
+				pvPortMalloc() would look for a cache to allocate it from. */
+				vTaskSuspendAll();
+				{
+					pxBlock = prvAllocateBlock( ( xHeapStructSize + sizeof( TaskCache_t ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) );
+
+					if( pxBlock != NULL )
+					{
+						pxCache = ( TaskCache_t * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+						memset( ( void * ) pxCache, 0x00, sizeof( TaskCache_t ) );
+						pxCache->xLastTrimTime = xTaskGetTickCount();
+
+						/* Link the cache into the list used to total the
+						cached bytes. */
+						pxCache->pxNextCache = pxTaskCaches;
+
+						if( pxTaskCaches != NULL )
+						{
+							pxTaskCaches->pxPreviousCache = pxCache;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+
+						pxTaskCaches = pxCache;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				( void ) xTaskResumeAll();
+
+				if( pxCache != NULL )
+				{
+					vTaskSetThreadLocalStoragePointer( NULL, configHEAP_TASK_CACHE_TLS_INDEX, ( void * ) pxCache );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxCache;
+	}
+	/*-----------------------------------------------------------*/
+
+	static TaskCache_t *prvAcquireTaskCache( BaseType_t xCreate )
+	{
+	TaskCache_t *pxCache = prvGetTaskCache( xCreate );
+
+		if( pxCache != NULL )
+		{
+			/* The cache is marked as in use before the scheduler state is
+			checked again, so either vPortTrimTaskCaches() sees the mark, or
+			this task sees the scheduler suspended by vPortTrimTaskCaches() and
+			does not use the cache. */
+			pxCache->xInUse = pdTRUE;
+			portMEMORY_BARRIER();
+
+			if( xTaskGetSchedulerState() != taskSCHEDULER_RUNNING )
+			{
+				pxCache->xInUse = pdFALSE;
+				pxCache = NULL;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxCache;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvReleaseTaskCache( TaskCache_t *pxCache )
+	{
+		portMEMORY_BARRIER();
+		pxCache->xInUse = pdFALSE;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BlockLink_t *prvTakeFromTaskCache( UBaseType_t uxClass )
+	{
+	TaskCache_t *pxCache = prvAcquireTaskCache( pdTRUE );
+	BlockLink_t *pxBlock = NULL;
+
+		if( pxCache != NULL )
+		{
+			prvTrimTaskCache( pxCache );
+			pxBlock = pxCache->pxBlocks[ uxClass ];
+
+			if( pxBlock != NULL )
+			{
+				pxCache->pxBlocks[ uxClass ] = pxBlock->pxNextFreeBlock;
+				pxCache->uxCount[ uxClass ]--;
+				pxCache->xCachedBytes -= pxBlock->xBlockSize & ~xBlockAllocatedBit;
+
+				if( pxCache->uxCount[ uxClass ] < pxCache->uxLowCount[ uxClass ] )
+				{
+					pxCache->uxLowCount[ uxClass ] = pxCache->uxCount[ uxClass ];
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			prvReleaseTaskCache( pxCache );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxBlock;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvAddToTaskCache( BlockLink_t *pxBlock )
+	{
+	TaskCache_t *pxCache;
+	BlockLink_t *pxReturned;
+	size_t xBlockSize = pxBlock->xBlockSize & ~xBlockAllocatedBit;
+	UBaseType_t uxClass, uxIndex;
+	BaseType_t xReturn = pdFALSE;
+
+		/* pvPortMalloc() allocates small blocks in the sizes of the classes,
+		but does not split off a part that is too small to be a block, so a
+		block can be up to xMinimumBlockSize bytes larger than its class. */
+		if( ( xBlockSize >= heapCACHE_BLOCK_SIZE( 0U ) ) && ( xBlockSize < ( heapCACHE_BLOCK_SIZE( heapCACHE_CLASSES - 1U ) + xMinimumBlockSize ) ) )
+		{
+			/* The block is cached in the largest class it holds, and counted
+			at its real size. */
+			uxClass = heapCACHE_CLASSES - 1U;
+
+			while( xBlockSize < heapCACHE_BLOCK_SIZE( uxClass ) )
+			{
+				uxClass--;
+			}
+
+			pxCache = prvAcquireTaskCache( pdFALSE );
+
+			if( pxCache != NULL )
+			{
+				prvTrimTaskCache( pxCache );
+
+				if( pxCache->uxCount[ uxClass ] >= ( UBaseType_t ) configHEAP_TASK_CACHE_DEPTH )
+				{
+					/* The cache is full.  Return half of it to the heap at
+					once, rather than one block per call. */
+					vTaskSuspendAll();
+					{
+						for( uxIndex = 0; uxIndex < ( ( UBaseType_t ) configHEAP_TASK_CACHE_DEPTH / 2U ); uxIndex++ )
+						{
+							pxReturned = pxCache->pxBlocks[ uxClass ];
+							pxCache->pxBlocks[ uxClass ] = pxReturned->pxNextFreeBlock;
+							pxCache->xCachedBytes -= pxReturned->xBlockSize & ~xBlockAllocatedBit;
+							prvFreeBlock( pxReturned );
+						}
+					}
+					( void ) xTaskResumeAll();
+
+					pxCache->uxCount[ uxClass ] -= ( UBaseType_t ) configHEAP_TASK_CACHE_DEPTH / 2U;
+
+					if( pxCache->uxCount[ uxClass ] < pxCache->uxLowCount[ uxClass ] )
+					{
+						pxCache->uxLowCount[ uxClass ] = pxCache->uxCount[ uxClass ];
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				pxBlock->pxNextFreeBlock = pxCache->pxBlocks[ uxClass ];
+				pxCache->pxBlocks[ uxClass ] = pxBlock;
+				pxCache->uxCount[ uxClass ]++;
+				pxCache->xCachedBytes += xBlockSize;
+				xReturn = pdTRUE;
+
+				prvReleaseTaskCache( pxCache );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTrimTaskCache( TaskCache_t *pxCache )
+	{
+	const TickType_t xTimeNow = xTaskGetTickCount();
+	BlockLink_t *pxReturned;
+	UBaseType_t uxClass;
+
+		if( ( xTimeNow - pxCache->xLastTrimTime ) >= ( TickType_t ) configHEAP_TASK_CACHE_TRIM_TICKS )
+		{
+			/* Blocks that stayed in the cache for the whole period were not
+			needed, so return them to the heap. */
+			vTaskSuspendAll();
+			{
+				for( uxClass = 0; uxClass < heapCACHE_CLASSES; uxClass++ )
+				{
+					while( pxCache->uxLowCount[ uxClass ] > ( UBaseType_t ) 0 )
+					{
+						pxReturned = pxCache->pxBlocks[ uxClass ];
+						pxCache->pxBlocks[ uxClass ] = pxReturned->pxNextFreeBlock;
+						pxCache->xCachedBytes -= pxReturned->xBlockSize & ~xBlockAllocatedBit;
+						prvFreeBlock( pxReturned );
+
+						pxCache->uxLowCount[ uxClass ]--;
+						pxCache->uxCount[ uxClass ]--;
+					}
+
+					pxCache->uxLowCount[ uxClass ] = pxCache->uxCount[ uxClass ];
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			pxCache->xLastTrimTime = xTimeNow;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortTrimTaskCaches( void )
+	{
+	static TickType_t xLastTrimTime = 0;
+	TaskCache_t *pxCache;
+
+		if( ( xTaskGetTickCount() - xLastTrimTime ) >= ( TickType_t ) configHEAP_TASK_CACHE_TRIM_TICKS )
+		{
+			vTaskSuspendAll();
+			{
+				/* Checked again, as there is an idle task on each core. */
+				if( ( xTaskGetTickCount() - xLastTrimTime ) >= ( TickType_t ) configHEAP_TASK_CACHE_TRIM_TICKS )
+				{
+					xLastTrimTime = xTaskGetTickCount();
+
+					/* A task that stopped allocating no longer trims its own
+					cache.  A task does not start to change its cache while
+					the scheduler is suspended, so only the caches that were
+					already being changed are left alone. */
+					for( pxCache = pxTaskCaches; pxCache != NULL; pxCache = pxCache->pxNextCache )
+					{
+						if( pxCache->xInUse == pdFALSE )
+						{
+							prvTrimTaskCache( pxCache );
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortFreeTaskCache( void *pvCache )
+	{
+	TaskCache_t *pxCache = ( TaskCache_t * ) pvCache;
+	BlockLink_t *pxReturned;
+	UBaseType_t uxClass;
+
+		if( pxCache != NULL )
+		{
+			vTaskSuspendAll();
+			{
+				/* The blocks are freed by following the lists, not the counts,
+				in case the task was deleted while it was adding a block. */
+				for( uxClass = 0; uxClass < heapCACHE_CLASSES; uxClass++ )
+				{
+					while( pxCache->pxBlocks[ uxClass ] != NULL )
+					{
+						pxReturned = pxCache->pxBlocks[ uxClass ];
+						pxCache->pxBlocks[ uxClass ] = pxReturned->pxNextFreeBlock;
+						prvFreeBlock( pxReturned );
+					}
+				}
+
+				if( pxCache->pxPreviousCache != NULL )
+				{
+					pxCache->pxPreviousCache->pxNextCache = pxCache->pxNextCache;
+				}
+				else
+				{
+					pxTaskCaches = pxCache->pxNextCache;
+				}
+
+				if( pxCache->pxNextCache != NULL )
+				{
+					pxCache->pxNextCache->pxPreviousCache = pxCache->pxPreviousCache;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				prvFreeBlock( ( BlockLink_t * ) ( ( ( uint8_t * ) pxCache ) - xHeapStructSize ) );
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	size_t xPortGetCachedHeapSize( void )
+	{
+	const TaskCache_t *pxCache;
+	size_t xCachedBytes = 0;
+
+		vTaskSuspendAll();
+		{
+			for( pxCache = pxTaskCaches; pxCache != NULL; pxCache = pxCache->pxNextCache )
+			{
+				xCachedBytes += pxCache->xCachedBytes;
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return xCachedBytes;
+	}
+	/*-----------------------------------------------------------*/
+
+	size_t xPortGetTaskCachedHeapSize( void )
+	{
+	const TaskCache_t *pxCache = prvGetTaskCache( pdFALSE );
+	size_t xCachedBytes = 0;
+
+		/* Only the calling task changes its own cache, so the count can be
+		read without suspending the scheduler. */
+		if( pxCache != NULL )
+		{
+			xCachedBytes = pxCache->xCachedBytes;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xCachedBytes;
+	}
+
+#endif /* configUSE_HEAP_TASK_CACHES */
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvLowestSetBit( uint32_t ulValue )
+{
+UBaseType_t uxBit = 0;
+
+	/* Isolate the lowest set bit, then find its position with a fixed number
+	of steps. */
+	ulValue &= ~ulValue + 1U;
+
+	if( ( ulValue & 0xffff0000UL ) != 0U )
+	{
+		uxBit += 16U;
+	}
+
+	if( ( ulValue & 0xff00ff00UL ) != 0U )
+	{
+		uxBit += 8U;
+	}
+
+	if( ( ulValue & 0xf0f0f0f0UL ) != 0U )
+	{
+		uxBit += 4U;
+	}
+
+	if( ( ulValue & 0xccccccccUL ) != 0U )
+	{
+		uxBit += 2U;
+	}
+
+	if( ( ulValue & 0xaaaaaaaaUL ) != 0U )
+	{
+		uxBit += 1U;
+	}
+
+	return uxBit;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvHighestSetBit( size_t xValue )
+{
+UBaseType_t uxBit = 0;
+
+	/* Block sizes are below 2 ^ ( heapFL_INDEX_MAX + 1 ), so only the low 32
+	bits need to be searched. */
+	if( ( xValue & ( size_t ) 0xffff0000UL ) != 0U )
+	{
+		xValue >>= 16;
+		uxBit += 16U;
+	}
+
+	if( ( xValue & ( size_t ) 0x0000ff00UL ) != 0U )
+	{
+		xValue >>= 8;
+		uxBit += 8U;
+	}
+
+	if( ( xValue & ( size_t ) 0x000000f0UL ) != 0U )
+	{
+		xValue >>= 4;
+		uxBit += 4U;
+	}
+
+	if( ( xValue & ( size_t ) 0x0000000cUL ) != 0U )
+	{
+		xValue >>= 2;
+		uxBit += 2U;
+	}
+
+	if( ( xValue & ( size_t ) 0x00000002UL ) != 0U )
+	{
+		uxBit += 1U;
+	}
+
+	return uxBit;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel )
+{
+UBaseType_t uxHighestBit;
+
+	if( xBlockSize < heapSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are all under the first first level index. */
+		*puxFirstLevel = 0;
+		*puxSecondLevel = ( UBaseType_t ) ( xBlockSize / heapSMALL_BLOCK_STEP );
+	}
+	else
+	{
+		uxHighestBit = prvHighestSetBit( xBlockSize );
+		*puxSecondLevel = ( UBaseType_t ) ( xBlockSize >> ( uxHighestBit - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT;
+		*puxFirstLevel = uxHighestBit - ( heapFL_INDEX_SHIFT - 1U );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel )
+{
+	/* Round the size up to the start of the next range, unless it is at the
+	start of a range already, so that every block in the range found is large
+	enough. */
+	if( xBlockSize < heapSMALL_BLOCK_SIZE )
+	{
+		xBlockSize += heapSMALL_BLOCK_STEP - 1U;
+	}
+	else
+	{
+		xBlockSize += ( ( size_t ) 1 << ( prvHighestSetBit( xBlockSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1U;
+	}
+
+	prvMappingInsert( xBlockSize, puxFirstLevel, puxSecondLevel );
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvTakeFreeBlock( size_t xWantedSize )
+{
+BlockLink_t *pxBlock = NULL;
+UBaseType_t uxFirstLevel, uxSecondLevel;
+uint32_t ulBitmap;
+
+	prvMappingSearch( xWantedSize, &uxFirstLevel, &uxSecondLevel );
+
+	if( uxFirstLevel < heapFL_INDEX_COUNT )
+	{
+		/* Look for a non empty list in the same power of two first, starting
+		at the range found. */
+		ulBitmap = ulSecondLevelBitmaps[ uxFirstLevel ] & ( ~0UL << uxSecondLevel );
+
+		if( ulBitmap == 0U )
+		{
+			/* Then in the next larger power of two that has free blocks. */
+			ulBitmap = ulFirstLevelBitmap & ( ~0UL << ( uxFirstLevel + 1U ) );
+
+			if( ulBitmap != 0U )
+			{
+				uxFirstLevel = prvLowestSetBit( ulBitmap );
+				ulBitmap = ulSecondLevelBitmaps[ uxFirstLevel ];
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ulBitmap != 0U )
+		{
+			uxSecondLevel = prvLowestSetBit( ulBitmap );
+			pxBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+			configASSERT( pxBlock != NULL );
+			configASSERT( pxBlock->xBlockSize >= xWantedSize );
+			prvRemoveBlockFromFreeList( pxBlock );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoFreeList( BlockLink_t *pxBlockToInsert )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+BlockLink_t *pxHead;
+
+	prvMappingInsert( pxBlockToInsert->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+	pxHead = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+
+	/* Blocks are added to the front of their list, so the most recently freed
+	memory is reused first. */
+	pxBlockToInsert->pxPreviousFreeBlock = NULL;
+	pxBlockToInsert->pxNextFreeBlock = pxHead;
+
+	if( pxHead != NULL )
+	{
+		pxHead->pxPreviousFreeBlock = pxBlockToInsert;
+	}
+	else
+	{
+		ulFirstLevelBitmap |= ( 1UL << uxFirstLevel );
+		ulSecondLevelBitmaps[ uxFirstLevel ] |= ( 1UL << uxSecondLevel );
+	}
+
+	pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlockToInsert;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveBlockFromFreeList( BlockLink_t *pxBlockToRemove )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	if( pxBlockToRemove->pxNextFreeBlock != NULL )
+	{
+		pxBlockToRemove->pxNextFreeBlock->pxPreviousFreeBlock = pxBlockToRemove->pxPreviousFreeBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( pxBlockToRemove->pxPreviousFreeBlock != NULL )
+	{
+		pxBlockToRemove->pxPreviousFreeBlock->pxNextFreeBlock = pxBlockToRemove->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block is at the head of its list. */
+		prvMappingInsert( pxBlockToRemove->xBlockSize, &uxFirstLevel, &uxSecondLevel );
+		configASSERT( pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] == pxBlockToRemove );
+		pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlockToRemove->pxNextFreeBlock;
+
+		if( pxBlockToRemove->pxNextFreeBlock == NULL )
+		{
+			/* The list is now empty. */
+			ulSecondLevelBitmaps[ uxFirstLevel ] &= ~( 1UL << uxSecondLevel );
+
+			if( ulSecondLevelBitmaps[ uxFirstLevel ] == 0U )
+			{
+				ulFirstLevelBitmap &= ~( 1UL << uxFirstLevel );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions )
+{
+BlockLink_t *pxFirstFreeBlockInRegion, *pxEnd;
+size_t xAlignedHeap;
+size_t xTotalRegionSize, xTotalHeapSize = 0;
+BaseType_t xDefinedRegions = 0;
+size_t xAddress;
+const HeapRegion_t *pxHeapRegion;
+
+	/* Can only call once! */
+	configASSERT( xBlockAllocatedBit == 0 );
+
+	/* Work out the position of the top bit in a size_t variable. */
+	xBlockAllocatedBit = ( ( size_t ) 1 ) << ( ( sizeof( size_t ) * heapBITS_PER_BYTE ) - 1 );
+
+	pxHeapRegion = &( pxHeapRegions[ xDefinedRegions ] );
+
+	while( pxHeapRegion->xSizeInBytes > 0 )
+	{
+		xTotalRegionSize = pxHeapRegion->xSizeInBytes;
+
+		/* Ensure the heap region starts on a correctly aligned boundary. */
+		xAddress = ( size_t ) pxHeapRegion->pucStartAddress;
+		if( ( xAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+		{
+			xAddress += ( portBYTE_ALIGNMENT - 1 );
+			xAddress &= ~portBYTE_ALIGNMENT_MASK;
+
+			/* Adjust the size for the bytes lost to alignment. */
+			xTotalRegionSize -= xAddress - ( size_t ) pxHeapRegion->pucStartAddress;
+		}
+
+		xAlignedHeap = xAddress;
+
+		/* The region holds one free block, followed by a marker that looks
+		like an allocated block so the free block is never merged past the end
+		of the region. */
+		configASSERT( xTotalRegionSize <= ( heapMAXIMUM_BLOCK_SIZE + xHeapStructSize ) );
+		if( xTotalRegionSize > ( heapMAXIMUM_BLOCK_SIZE + xHeapStructSize ) )
+		{
+			xTotalRegionSize = heapMAXIMUM_BLOCK_SIZE + xHeapStructSize;
+		}
+
+		xAddress = xAlignedHeap + xTotalRegionSize;
+		xAddress -= xHeapStructSize;
+		xAddress &= ~portBYTE_ALIGNMENT_MASK;
+
+		configASSERT( xAddress >= ( xAlignedHeap + xMinimumBlockSize ) );
+
+		pxFirstFreeBlockInRegion = ( BlockLink_t * ) xAlignedHeap;
+		pxFirstFreeBlockInRegion->pxPreviousPhysicalBlock = NULL;
+		pxFirstFreeBlockInRegion->xBlockSize = xAddress - xAlignedHeap;
+
+		pxEnd = ( BlockLink_t * ) xAddress;
+		pxEnd->pxPreviousPhysicalBlock = pxFirstFreeBlockInRegion;
+		pxEnd->xBlockSize = xBlockAllocatedBit;
+
+		prvInsertBlockIntoFreeList( pxFirstFreeBlockInRegion );
+		xTotalHeapSize += pxFirstFreeBlockInRegion->xBlockSize;
+
+		/* Move onto the next HeapRegion_t structure. */
+		xDefinedRegions++;
+		pxHeapRegion = &( pxHeapRegions[ xDefinedRegions ] );
+	}
+
+	xMinimumEverFreeBytesRemaining = xTotalHeapSize;
+	xFreeBytesRemaining = xTotalHeapSize;
+
+	/* Check something was actually defined before it is accessed. */
+	configASSERT( xTotalHeapSize );
+}
@@ -156,6 +156,9 @@ not necessary for to use this port.  They are defined so the common demo files
 /* portNOP() is not required by this port. */
 #define portNOP()
 
+/* Only one core runs code, so a compiler barrier is enough. */
+#define portMEMORY_BARRIER() __memory_changed()
+
 #define portINLINE __inline
 
 #ifndef portFORCE_INLINE
@@ -0,0 +1,783 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the Posix port.
+ *
+ * Each task has a pthread which eases use of standard debuggers
+ * (allowing backtraces of tasks etc).  Threads for tasks that are not
+ * running are blocked on a per-thread condition variable, so exactly one
+ * thread executes FreeRTOS code at any time and scheduling is as
+ * deterministic as it is on a single core target.
+ *
+ * Interrupts are simulated with signals.  The tick is generated by SIGALRM
+ * from an interval timer, and other simulated interrupts are raised by sending
+ * portSIGNAL_INTERRUPT to the process.  Both are only ever unblocked in the
+ * thread of the task that is in the Running state, so masking them in that
+ * thread is equivalent to disabling interrupts.
+ *
+ * When configNUMBER_OF_CORES is greater than 1 each simulated core has a
+ * running thread of its own, so that many task threads execute at once.  The
+ * core a thread runs on is recorded in a thread local variable when the thread
+ * is resumed, a core is made to yield by sending portSIGNAL_YIELD to the
+ * thread running on it, and the kernel locks are spinlocks.
+ *
+ * Note that the FreeRTOS+POSIX library cannot be used with this port, as its
+ * pthread_* functions would replace those of the host C library that the port
+ * itself is built on.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define portMAX_INTERRUPTS				( ( uint32_t ) sizeof( uint32_t ) * 8UL ) /* The number of bits in an uint32_t. */
+#define portNO_CRITICAL_NESTING			( ( UBaseType_t ) 0 )
+
+/* The host signals used to simulate interrupts, and the signal used to return
+control to the thread that started the scheduler. */
+#define portSIGNAL_TICK					SIGALRM
+#define portSIGNAL_INTERRUPT			SIGUSR2
+#define portSIGNAL_END_SCHEDULER		SIGUSR1
+#define portSIGNAL_YIELD				SIGURG
+
+/*-----------------------------------------------------------*/
+
+/* The Posix port runs each task in a thread.  The context switching is managed
+by the threads, so the task stack does not have to be managed directly,
+although the task stack is still used to hold a ThreadState_t structure - this
+is the only thing it will ever hold.  The structure indirectly maps the task
+handle to a thread handle. */
+typedef struct THREAD_STATE
+{
+	pthread_t xThread;				/* The thread that executes the task. */
+	pthread_mutex_t xMutex;			/* Protects xResumePending. */
+	pthread_cond_t xCond;			/* Signalled when the thread may run. */
+	BaseType_t xResumePending;		/* Set when the thread has been selected to run. */
+	TaskFunction_t pxCode;			/* The function that implements the task. */
+	void *pvParams;					/* The parameter passed into the task function. */
+	volatile BaseType_t xDying;		/* Set when the task has been deleted. */
+	BaseType_t xCoreID;				/* The core the thread was last resumed on. */
+} ThreadState_t;
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/* The kernel locks.  A lock is held by a core, and can be taken more than
+	once by the core holding it. */
+	typedef struct RECURSIVE_LOCK
+	{
+		volatile BaseType_t xOwner;		/* The core holding the lock, or -1 if it is free. */
+		UBaseType_t uxRecursion;		/* The number of times the owner has taken the lock. */
+	} RecursiveLock_t;
+
+#endif
+
+/*
+ * The thread entry point.  Waits to be scheduled for the first time before
+ * calling the function that implements the task.
+ */
+static void *prvWaitForStart( void *pvParams );
+
+/*
+ * Handlers for the simulated tick and other simulated interrupts.  These
+ * execute in the thread of the task that was running when the signal was
+ * taken.
+ */
+static void prvTickSignalHandler( int iSignal );
+static void prvInterruptSignalHandler( int iSignal );
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/*
+	 * Handler for the signal sent by vPortYieldCore().
+	 */
+	static void prvYieldSignalHandler( int iSignal );
+
+#endif
+
+/*
+ * Select the next task to run, then hand the processor to its thread.
+ */
+static void prvSwitchContext( void );
+static void prvSwitchThread( ThreadState_t *pxThreadToResume, ThreadState_t *pxThreadToSuspend );
+
+/*
+ * Block the calling thread until it is next selected to run, and allow a
+ * blocked thread to run.
+ */
+static void prvSuspendSelf( ThreadState_t *pxThreadState );
+static void prvResumeThread( ThreadState_t *pxThreadState, BaseType_t xCoreID );
+
+/*
+ * Called if a task function returns.
+ */
+static void prvTaskExitError( void );
+
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES == 1 )
+
+	/* Pointer to the TCB of the currently executing task. */
+	extern void * volatile pxCurrentTCB;
+
+	/* The critical nesting count for the currently executing task.  Each thread
+	saves and restores its own value as it is switched out and back in. */
+	static volatile UBaseType_t uxCriticalNesting = portNO_CRITICAL_NESTING;
+
+#else
+
+	/* Pointers to the TCBs of the tasks running on each core. */
+	extern void * volatile pxCurrentTCBs[ configNUMBER_OF_CORES ];
+
+	/* The core the calling thread is running on, read by portGET_CORE_ID().
+	The scheduler thread, which creates the first tasks, counts as core 0. */
+	__thread BaseType_t xPortThreadCoreID = 0;
+
+	#define pxCurrentTCB	pxCurrentTCBs[ xPortThreadCoreID ]
+
+	/* The task lock and the ISR lock, indexed by portTASK_LOCK and
+	portISR_LOCK. */
+	static RecursiveLock_t xKernelLocks[ 2 ] = { { -1, 0 }, { -1, 0 } };
+
+#endif
+
+/* Simulated interrupts waiting to be processed.  This is a bit mask where each
+bit represents one interrupt, so a maximum of 32 interrupts can be simulated. */
+static volatile uint32_t ulPendingInterrupts = 0UL;
+
+/* Handlers for all the simulated interrupts.  The first two positions are
+reserved for the Yield and Tick interrupts, which are handled directly. */
+static uint32_t (*ulIsrHandler[ portMAX_INTERRUPTS ])( void ) = { 0 };
+
+/* The set of signals that are masked while (simulated) interrupts are
+disabled. */
+static sigset_t xInterruptSignals;
+
+/* The thread that called xPortStartScheduler(), which waits for
+vPortEndScheduler() to be called. */
+static pthread_t xSchedulerThread;
+static volatile BaseType_t xSchedulerEnd = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+static portINLINE ThreadState_t *prvGetThreadFromTask( void *pvTask )
+{
+	/* The first member of the TCB is the top of stack pointer, which
+	pxPortInitialiseStack() set to point to the thread state. */
+	return *( ( ThreadState_t ** ) pvTask );
+}
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+ThreadState_t *pxThreadState;
+pthread_attr_t xThreadAttributes;
+sigset_t xOldMask;
+int iReturned;
+
+	/* In this simulated case a stack is not initialised, but instead a thread
+	is created that will execute the task being created.  The thread handles
+	the context switching itself.  The ThreadState_t object is placed onto
+	the stack that was created for the task - so the stack buffer is still
+	used, just not in the conventional way.  It will not be used for anything
+	other than holding this structure. */
+	pxThreadState = ( ThreadState_t * ) ( ( ( portPOINTER_SIZE_TYPE ) ( pxTopOfStack + 1 ) - sizeof( ThreadState_t ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+	memset( pxThreadState, 0x00, sizeof( ThreadState_t ) );
+
+	pxThreadState->pxCode = pxCode;
+	pxThreadState->pvParams = pvParameters;
+	pxThreadState->xResumePending = pdFALSE;
+	pxThreadState->xDying = pdFALSE;
+	pthread_mutex_init( &( pxThreadState->xMutex ), NULL );
+	pthread_cond_init( &( pxThreadState->xCond ), NULL );
+
+	pthread_attr_init( &xThreadAttributes );
+	pthread_attr_setdetachstate( &xThreadAttributes, PTHREAD_CREATE_JOINABLE );
+
+	/* The new thread inherits the signal mask of the calling thread, so
+	create it with the simulated interrupts masked.  They are unmasked when
+	the task runs for the first time. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOldMask );
+	iReturned = pthread_create( &( pxThreadState->xThread ), &xThreadAttributes, prvWaitForStart, pxThreadState );
+	pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+
+	pthread_attr_destroy( &xThreadAttributes );
+	configASSERT( iReturned == 0 );
+	( void ) iReturned;
+
+	return ( StackType_t * ) pxThreadState;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xSignalAction;
+struct itimerval xTimer;
+sigset_t xWaitSignals;
+int iSignal;
+
+	xSchedulerThread = pthread_self();
+
+	/* This thread never runs a task, so keep the simulated interrupts and the
+	end scheduler signal masked here for the lifetime of the scheduler. */
+	sigemptyset( &xWaitSignals );
+	sigaddset( &xWaitSignals, portSIGNAL_END_SCHEDULER );
+	pthread_sigmask( SIG_BLOCK, &xWaitSignals, NULL );
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+
+	/* Install the interrupt handlers used by the scheduler itself.  All other
+	signals are masked while a handler executes, as would be the case for an
+	interrupt on a target without nested interrupts. */
+	memset( &xSignalAction, 0x00, sizeof( xSignalAction ) );
+	sigfillset( &xSignalAction.sa_mask );
+	xSignalAction.sa_flags = SA_RESTART;
+	xSignalAction.sa_handler = prvTickSignalHandler;
+	sigaction( portSIGNAL_TICK, &xSignalAction, NULL );
+	xSignalAction.sa_handler = prvInterruptSignalHandler;
+	sigaction( portSIGNAL_INTERRUPT, &xSignalAction, NULL );
+
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		xSignalAction.sa_handler = prvYieldSignalHandler;
+		sigaction( portSIGNAL_YIELD, &xSignalAction, NULL );
+	}
+	#endif
+
+	/* Start the timer that simulates the tick interrupt. */
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = portTICK_RATE_MICROSECONDS;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	/* Start the first task by releasing the thread of the task that was
+	selected to run by the kernel. */
+	#if ( configNUMBER_OF_CORES == 1 )
+	{
+		prvResumeThread( prvGetThreadFromTask( pxCurrentTCB ), 0 );
+	}
+	#else
+	{
+	BaseType_t xCoreID;
+
+		for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+		{
+			prvResumeThread( prvGetThreadFromTask( pxCurrentTCBs[ xCoreID ] ), xCoreID );
+		}
+	}
+	#endif
+
+	/* Wait until vPortEndScheduler() is called. */
+	while( xSchedulerEnd == pdFALSE )
+	{
+		( void ) sigwait( &xWaitSignals, &iSignal );
+	}
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+struct sigaction xSignalAction;
+
+	/* Stop the timer and ignore any tick that is already pending. */
+	memset( &xTimer, 0x00, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	memset( &xSignalAction, 0x00, sizeof( xSignalAction ) );
+	xSignalAction.sa_handler = SIG_IGN;
+	sigemptyset( &xSignalAction.sa_mask );
+	sigaction( portSIGNAL_TICK, &xSignalAction, NULL );
+
+	/* Return control to the thread that started the scheduler.  The calling
+	task never runs again. */
+	xSchedulerEnd = pdTRUE;
+	pthread_kill( xSchedulerThread, portSIGNAL_END_SCHEDULER );
+
+	prvSuspendSelf( prvGetThreadFromTask( pxCurrentTCB ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	#if ( configNUMBER_OF_CORES == 1 )
+	{
+		vPortEnterCritical();
+		prvSwitchContext();
+		vPortExitCritical();
+	}
+	#else
+	{
+	portBASE_TYPE xMask;
+
+		/* The kernel only yields when the calling core holds no locks, so
+		interrupts just have to be masked while the thread is switched.  The
+		mask is restored rather than cleared as this is also called from the
+		simulated interrupt handlers. */
+		xMask = xPortSetInterruptMask();
+		prvSwitchContext();
+		vPortClearInterruptMask( xMask );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPortSetInterruptMask( void )
+{
+sigset_t xOldMask;
+
+	/* Return pdTRUE if interrupts were enabled on entry, so
+	vPortClearInterruptMask() knows whether to enable them again.  Interrupts
+	are always disabled inside a (simulated) interrupt handler. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOldMask );
+
+	return ( sigismember( &xOldMask, portSIGNAL_TICK ) == 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( portBASE_TYPE xMask )
+{
+	if( xMask != pdFALSE )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES == 1 )
+
+void vPortEnterCritical( void )
+{
+	if( uxCriticalNesting == portNO_CRITICAL_NESTING )
+	{
+		vPortDisableInterrupts();
+	}
+
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting > portNO_CRITICAL_NESTING );
+	uxCriticalNesting--;
+
+	/* Interrupts are enabled again once the outermost critical section is
+	exited.  Any simulated interrupt that was raised while they were disabled
+	is taken at this point. */
+	if( uxCriticalNesting == portNO_CRITICAL_NESTING )
+	{
+		vPortEnableInterrupts();
+	}
+}
+
+#else
+
+void vPortYieldCore( BaseType_t xCoreID )
+{
+	/* Called with the kernel locks held, so the task running on the core
+	cannot change.  If that task is in a critical section, or its thread is
+	still waiting to be resumed, the signal is held pending until interrupts
+	are enabled in the thread again. */
+	( void ) pthread_kill( prvGetThreadFromTask( pxCurrentTCBs[ xCoreID ] )->xThread, portSIGNAL_YIELD );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetLock( BaseType_t xLock )
+{
+RecursiveLock_t * const pxLock = &( xKernelLocks[ xLock ] );
+BaseType_t xFree;
+
+	if( pxLock->xOwner != xPortThreadCoreID )
+	{
+		/* Each simulated core is a host thread that may share a host CPU
+		with the thread holding the lock, so give up the CPU while
+		spinning. */
+		for( ;; )
+		{
+			xFree = -1;
+
+			if( __atomic_compare_exchange_n( &( pxLock->xOwner ), &xFree, xPortThreadCoreID, pdFALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) != pdFALSE )
+			{
+				break;
+			}
+
+			( void ) sched_yield();
+		}
+	}
+
+	pxLock->uxRecursion++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortReleaseLock( BaseType_t xLock )
+{
+RecursiveLock_t * const pxLock = &( xKernelLocks[ xLock ] );
+
+	configASSERT( pxLock->xOwner == xPortThreadCoreID );
+	configASSERT( pxLock->uxRecursion > 0U );
+
+	pxLock->uxRecursion--;
+
+	if( pxLock->uxRecursion == 0U )
+	{
+		__atomic_store_n( &( pxLock->xOwner ), -1, __ATOMIC_RELEASE );
+	}
+}
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
+void vPortThreadDying( void *pxTaskToDelete, volatile BaseType_t *pxPendYield )
+{
+ThreadState_t *pxThreadState = prvGetThreadFromTask( pxTaskToDelete );
+
+	/* The task is deleting itself.  Its thread exits the next time it is
+	switched out, which is guaranteed to happen as a yield is pended. */
+	pxThreadState->xDying = pdTRUE;
+	*pxPendYield = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void *pxTaskToDelete )
+{
+ThreadState_t *pxThreadState = prvGetThreadFromTask( pxTaskToDelete );
+sigset_t xOldMask;
+
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOldMask );
+	{
+		/* If the task was deleted by another task then its thread is still
+		blocked waiting to be scheduled.  Wake it so it exits - it will not
+		execute any more task code. */
+		if( pxThreadState->xDying == pdFALSE )
+		{
+			pxThreadState->xDying = pdTRUE;
+			prvResumeThread( pxThreadState, pxThreadState->xCoreID );
+		}
+
+		pthread_join( pxThreadState->xThread, NULL );
+		pthread_cond_destroy( &( pxThreadState->xCond ) );
+		pthread_mutex_destroy( &( pxThreadState->xMutex ) );
+	}
+	pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber )
+{
+	if( ulInterruptNumber < portMAX_INTERRUPTS )
+	{
+		__atomic_fetch_or( &ulPendingInterrupts, ( 1UL << ulInterruptNumber ), __ATOMIC_SEQ_CST );
+
+		/* The signal is sent to the process rather than to a thread, so the
+		host delivers it to the only thread that does not have it masked - the
+		thread of the running task.  If that task is in a critical section the
+		signal is held pending until the critical section is exited. */
+		( void ) kill( getpid(), portSIGNAL_INTERRUPT );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( uint32_t ulInterruptNumber, uint32_t (*pvHandler)( void ) )
+{
+	if( ( ulInterruptNumber > portINTERRUPT_TICK ) && ( ulInterruptNumber < portMAX_INTERRUPTS ) )
+	{
+		portENTER_CRITICAL();
+		ulIsrHandler[ ulInterruptNumber ] = pvHandler;
+		portEXIT_CRITICAL();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalHandler( int iSignal )
+{
+	( void ) iSignal;
+
+	#if ( configNUMBER_OF_CORES == 1 )
+	{
+		/* Signals are already masked by the handler, but any critical section
+		entered from within the handler must not unmask them on exit. */
+		uxCriticalNesting++;
+
+		if( xTaskIncrementTick() != pdFALSE )
+		{
+			prvSwitchContext();
+		}
+
+		uxCriticalNesting--;
+	}
+	#else
+	{
+	UBaseType_t uxSavedInterruptStatus;
+	BaseType_t xSwitchRequired;
+
+		/* The tick is taken by only one of the cores, and updates the kernel
+		state shared by all of them. */
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		{
+			xSwitchRequired = xTaskIncrementTick();
+		}
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+		if( xSwitchRequired != pdFALSE )
+		{
+			prvSwitchContext();
+		}
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptSignalHandler( int iSignal )
+{
+uint32_t ulPending, ulSwitchRequired = pdFALSE, i;
+
+	( void ) iSignal;
+
+	#if ( configNUMBER_OF_CORES == 1 )
+	{
+		uxCriticalNesting++;
+	}
+	#endif
+
+	/* Several raised interrupts can be delivered as a single signal, so
+	process every interrupt that is pending. */
+	ulPending = __atomic_exchange_n( &ulPendingInterrupts, 0UL, __ATOMIC_SEQ_CST );
+
+	for( i = 0; i < portMAX_INTERRUPTS; i++ )
+	{
+		if( ( ( ulPending & ( 1UL << i ) ) != 0UL ) && ( ulIsrHandler[ i ] != NULL ) )
+		{
+			if( ulIsrHandler[ i ]() != pdFALSE )
+			{
+				ulSwitchRequired = pdTRUE;
+			}
+		}
+	}
+
+	if( ulSwitchRequired != pdFALSE )
+	{
+		prvSwitchContext();
+	}
+
+	#if ( configNUMBER_OF_CORES == 1 )
+	{
+		uxCriticalNesting--;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+	static void prvYieldSignalHandler( int iSignal )
+	{
+		( void ) iSignal;
+
+		/* Another core found a task that should preempt the task running on
+		this core. */
+		prvSwitchContext();
+	}
+	/*-----------------------------------------------------------*/
+
+#endif
+
+static void prvSwitchContext( void )
+{
+ThreadState_t *pxThreadToSuspend;
+ThreadState_t *pxThreadToResume;
+
+	pxThreadToSuspend = prvGetThreadFromTask( pxCurrentTCB );
+
+	/* Select the next task to run. */
+	vTaskSwitchContext();
+
+	pxThreadToResume = prvGetThreadFromTask( pxCurrentTCB );
+	prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( ThreadState_t *pxThreadToResume, ThreadState_t *pxThreadToSuspend )
+{
+#if ( configNUMBER_OF_CORES == 1 )
+	UBaseType_t uxSavedCriticalNesting;
+#endif
+
+	/* If the task selected to enter the running state is not the task that is
+	already in the running state. */
+	if( pxThreadToSuspend != pxThreadToResume )
+	{
+		#if ( configNUMBER_OF_CORES == 1 )
+		{
+			/* The critical nesting count is per task, so save it on the stack
+			of the thread being suspended and restore it when the thread runs
+			again. */
+			uxSavedCriticalNesting = uxCriticalNesting;
+		}
+		#endif
+
+		/* With more than one core the task being switched out may already
+		have been selected by another core, in which case it is resumed
+		before it suspends itself, and does not wait. */
+		prvResumeThread( pxThreadToResume, portGET_CORE_ID() );
+
+		if( pxThreadToSuspend->xDying != pdFALSE )
+		{
+			/* The task deleted itself, so its thread is no longer required.
+			The idle task joins it when the TCB is freed. */
+			pthread_exit( NULL );
+		}
+
+		prvSuspendSelf( pxThreadToSuspend );
+
+		#if ( configNUMBER_OF_CORES == 1 )
+		{
+			uxCriticalNesting = uxSavedCriticalNesting;
+		}
+		#endif
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( ThreadState_t *pxThreadState )
+{
+	pthread_mutex_lock( &( pxThreadState->xMutex ) );
+	{
+		while( pxThreadState->xResumePending == pdFALSE )
+		{
+			pthread_cond_wait( &( pxThreadState->xCond ), &( pxThreadState->xMutex ) );
+		}
+
+		pxThreadState->xResumePending = pdFALSE;
+
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+			xPortThreadCoreID = pxThreadState->xCoreID;
+		}
+		#endif
+	}
+	pthread_mutex_unlock( &( pxThreadState->xMutex ) );
+
+	/* The thread may have been woken only so that it can exit because its task
+	was deleted by another task. */
+	if( pxThreadState->xDying != pdFALSE )
+	{
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvResumeThread( ThreadState_t *pxThreadState, BaseType_t xCoreID )
+{
+	pthread_mutex_lock( &( pxThreadState->xMutex ) );
+	{
+		pxThreadState->xCoreID = xCoreID;
+		pxThreadState->xResumePending = pdTRUE;
+		pthread_cond_signal( &( pxThreadState->xCond ) );
+	}
+	pthread_mutex_unlock( &( pxThreadState->xMutex ) );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvWaitForStart( void *pvParams )
+{
+ThreadState_t *pxThreadState = ( ThreadState_t * ) pvParams;
+
+	prvSuspendSelf( pxThreadState );
+
+	/* The task is running for the first time, so has not yet entered any
+	critical sections. */
+	#if ( configNUMBER_OF_CORES == 1 )
+	{
+		uxCriticalNesting = portNO_CRITICAL_NESTING;
+	}
+	#endif
+	vPortEnableInterrupts();
+
+	/* Call the function that implements the task. */
+	pxThreadState->pxCode( pxThreadState->pvParams );
+
+	prvTaskExitError();
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskExitError( void )
+{
+	/* A function that implements a task must not exit or attempt to return to
+	its caller as there is nothing to return to.  If a task wants to exit it
+	should instead call vTaskDelete( NULL ). */
+	configASSERT( pdFALSE );
+	portDISABLE_INTERRUPTS();
+
+	for( ;; )
+	{
+		( void ) pause();
+	}
+}
+/*-----------------------------------------------------------*/
+
+/* The set of signals used to simulate interrupts must be valid before the
+first task is created, which can be before the scheduler is started. */
+static void prvSetupSignals( void ) __attribute__( ( constructor ) );
+static void prvSetupSignals( void )
+{
+	sigemptyset( &xInterruptSignals );
+	sigaddset( &xInterruptSignals, portSIGNAL_TICK );
+	sigaddset( &xInterruptSignals, portSIGNAL_INTERRUPT );
+
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		sigaddset( &xInterruptSignals, portSIGNAL_YIELD );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,207 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <limits.h>
+
+/******************************************************************************
+	Defines
+******************************************************************************/
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	unsigned long
+#define portBASE_TYPE	long
+#define portPOINTER_SIZE_TYPE size_t
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+
+	/* 32/64-bit tick type on a 32/64-bit architecture, so reads of the tick
+	count do not need to be guarded with a critical section. */
+	#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+/* Hardware specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portTICK_RATE_MICROSECONDS	( ( TickType_t ) 1000000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+#define portINLINE __inline
+
+/* Scheduler utilities. */
+extern void vPortYield( void );
+
+#define portYIELD()					vPortYield()
+
+#define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYield()
+#define portYIELD_FROM_ISR( x ) portEND_SWITCHING_ISR( x )
+
+/* Critical section management.  Signals are used to simulate interrupts, so
+masking signals in the calling thread is equivalent to disabling interrupts. */
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
+#define portSET_INTERRUPT_MASK()		( vPortDisableInterrupts() )
+#define portCLEAR_INTERRUPT_MASK()		( vPortEnableInterrupts() )
+
+extern portBASE_TYPE xPortSetInterruptMask( void );
+extern void vPortClearInterruptMask( portBASE_TYPE xMask );
+
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()		xPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortClearInterruptMask(x)
+#define portDISABLE_INTERRUPTS()				portSET_INTERRUPT_MASK()
+#define portENABLE_INTERRUPTS()					portCLEAR_INTERRUPT_MASK()
+
+/* Task threads and the signal handlers run on host threads that are not
+necessarily serialised on one CPU. */
+#define portMEMORY_BARRIER()					__sync_synchronize()
+
+#if defined( configNUMBER_OF_CORES ) && ( configNUMBER_OF_CORES > 1 )
+
+	/* Each simulated core runs a task thread of its own.  The kernel keeps the
+	critical nesting count of each core, and takes the kernel locks as well as
+	masking signals. */
+	extern void vTaskEnterCritical( void );
+	extern void vTaskExitCritical( void );
+	#define portENTER_CRITICAL()				vTaskEnterCritical()
+	#define portEXIT_CRITICAL()					vTaskExitCritical()
+
+	/* The core the calling thread is running on. */
+	extern __thread BaseType_t xPortThreadCoreID;
+	#define portGET_CORE_ID()					xPortThreadCoreID
+
+	/* Make the task running on another core yield. */
+	extern void vPortYieldCore( BaseType_t xCoreID );
+	#define portYIELD_CORE( xCoreID )			vPortYieldCore( xCoreID )
+
+	/* Recursive spinlocks, held by a core rather than by a task. */
+	#define portTASK_LOCK						( ( BaseType_t ) 0 )
+	#define portISR_LOCK						( ( BaseType_t ) 1 )
+	extern void vPortGetLock( BaseType_t xLock );
+	extern void vPortReleaseLock( BaseType_t xLock );
+	#define portGET_TASK_LOCK()					vPortGetLock( portTASK_LOCK )
+	#define portRELEASE_TASK_LOCK()				vPortReleaseLock( portTASK_LOCK )
+	#define portGET_ISR_LOCK()					vPortGetLock( portISR_LOCK )
+	#define portRELEASE_ISR_LOCK()				vPortReleaseLock( portISR_LOCK )
+
+#else
+
+	#define portENTER_CRITICAL()				vPortEnterCritical()
+	#define portEXIT_CRITICAL()					vPortExitCritical()
+
+#endif
+
+/* Each task runs in its own pthread.  A task that deletes itself marks its
+thread as dying so it exits the next time it is switched out, and the idle
+task joins the thread when the TCB is cleaned up. */
+extern void vPortThreadDying( void *pxTaskToDelete, volatile BaseType_t *pxPendYield );
+extern void vPortCancelThread( void *pxTaskToDelete );
+#define portPRE_TASK_DELETE_HOOK( pvTaskToDelete, pxPendYield ) vPortThreadDying( ( pvTaskToDelete ), ( pxPendYield ) )
+#define portCLEAN_UP_TCB( pxTCB )	vPortCancelThread( pxTCB )
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+/*
+ * Tasks run in pthreads and have no direct access to the stack, so the
+ * optimised task selection only relies on the compiler's count leading zeros
+ * builtin.  It cannot be used with more than one core.
+ */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#if defined( configNUMBER_OF_CORES ) && ( configNUMBER_OF_CORES > 1 )
+		#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+	#else
+		#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+	#endif
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* Check the configuration. */
+	#if( configMAX_PRIORITIES > 32 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.  It is very rare that a system requires more than 10 to 15 difference priorities as tasks that share a priority will time slice.
+	#endif
+
+	/* Store/clear the ready priorities in a bit map. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+
+	/*-----------------------------------------------------------*/
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( ( sizeof( unsigned long ) * CHAR_BIT ) - 1UL ) - ( UBaseType_t ) __builtin_clzl( ( uxReadyPriorities ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
+#define portINTERRUPT_YIELD				( 0UL )
+#define portINTERRUPT_TICK				( 1UL )
+
+/*
+ * Raise a simulated interrupt.  Unlike the other functions in this file this
+ * function can be called from a host thread that is not running a FreeRTOS
+ * task - for example a thread that is blocked reading a host socket or a TAP
+ * device.  The handler installed with vPortSetInterruptHandler() executes in
+ * the context of whichever task is running when the interrupt is taken, with
+ * all simulated interrupts masked, so it can use the FromISR() API functions.
+ */
+void vPortGenerateSimulatedInterrupt( uint32_t ulInterruptNumber );
+
+/*
+ * Install an interrupt handler to be called by the simulated interrupt
+ * dispatcher.  The interrupt number must be above any used by the kernel itself
+ * (portINTERRUPT_YIELD and portINTERRUPT_TICK) and lower than 32.
+ *
+ * Interrupt handler functions must return a non-zero value if executing the
+ * handler resulted in a task switch being required.
+ */
+void vPortSetInterruptHandler( uint32_t ulInterruptNumber, uint32_t (*pvHandler)( void ) );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
@@ -128,6 +128,11 @@ typedef struct QueueDefinition 		/* The old naming convention is used to prevent
 		uint8_t ucQueueType;
 	#endif
 
+	#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+		UBaseType_t uxSlotsAcquired;	/*< The number of slots reserved by xQueueAcquireSlot() that are not committed yet.  They follow the items in the queue. */
+		UBaseType_t uxItemsBorrowed;	/*< The number of items removed by xQueueBorrowItem() that are not released yet.  They precede the items in the queue. */
+	#endif
+
 } xQUEUE;
 
 /* The old xQUEUE name is maintained above then typedefed to the new Queue_t
@@ -198,6 +203,47 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue, const void *pvIte
  */
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+	/*
+	 * Uses a critical section to determine if every slot of the queue is taken
+	 * by an item, a slot acquired for writing or an item borrowed for reading.
+	 */
+	static BaseType_t prvIsEverySlotTaken( const Queue_t *pxQueue ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Returns the slot that is uxSlots slots before pcSlot in the circular
+	 * storage area of the queue.
+	 */
+	static int8_t *prvSlotBefore( const Queue_t *pxQueue, int8_t *pcSlot, UBaseType_t uxSlots ) PRIVILEGED_FUNCTION;
+#endif
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+	/*
+	 * Copies uxCount items to the back of a queue that has space for them,
+	 * using at most two memcpy() calls.
+	 */
+	static void prvCopyItemsToQueue( Queue_t * const pxQueue, const int8_t *pcItems, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Copies uxCount items out of a queue that holds at least that many items,
+	 * using at most two memcpy() calls.
+	 */
+	static void prvCopyItemsFromQueue( Queue_t * const pxQueue, int8_t *pcBuffer, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Removes up to uxCount tasks from pxEventList, as uxCount items or spaces
+	 * were made available at once.  Returns pdTRUE if any of the tasks has a
+	 * higher priority than the calling task.  Called from a critical section.
+	 */
+	static BaseType_t prvUnblockWaitingTasks( List_t * const pxEventList, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Adds uxCount to a queue lock count, saturating rather than overflowing,
+	 * as there cannot be more than that many tasks to unblock anyway.
+	 */
+	static int8_t prvAddToLockCount( int8_t cLock, UBaseType_t uxCount ) PRIVILEGED_FUNCTION;
+#endif
+
 #if ( configUSE_QUEUE_SETS == 1 )
 	/*
 	 * Checks to see if a queue is a member of a queue set, and if so, notifies
@@ -267,6 +313,13 @@ Queue_t * const pxQueue = xQueue;
 		pxQueue->cRxLock = queueUNLOCKED;
 		pxQueue->cTxLock = queueUNLOCKED;
 
+		#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+		{
+			pxQueue->uxSlotsAcquired = ( UBaseType_t ) 0U;
+			pxQueue->uxItemsBorrowed = ( UBaseType_t ) 0U;
+		}
+		#endif
+
 		if( xNewQueue == pdFALSE )
 		{
 			/* If there are tasks blocked waiting to read from the queue, then
@@ -292,9 +345,11 @@ Queue_t * const pxQueue = xQueue;
 		}
 		else
 		{
-			/* Ensure the event queues start in the correct state. */
-			vListInitialise( &( pxQueue->xTasksWaitingToSend ) );
-			vListInitialise( &( pxQueue->xTasksWaitingToReceive ) );
+			/* Ensure the event queues start in the correct state.  They are
+			sorted by task priority, so are indexed in case many tasks block
+			on the same queue. */
+			vListInitialiseIndexed( &( pxQueue->xTasksWaitingToSend ) );
+			vListInitialiseIndexed( &( pxQueue->xTasksWaitingToReceive ) );
 		}
 	}
 	taskEXIT_CRITICAL();
@@ -985,7 +1040,7 @@ Queue_t * const pxQueue = xQueue;
 	read, instead return a flag to say whether a context switch is required or
 	not (i.e. has a task with a higher priority than us been woken by this
 	post). */
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 	{
 		if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
 		{
@@ -1099,7 +1154,7 @@ Queue_t * const pxQueue = xQueue;
 			xReturn = errQUEUE_FULL;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1144,7 +1199,7 @@ Queue_t * const pxQueue = xQueue;
 	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 	{
 		const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
@@ -1264,7 +1319,7 @@ Queue_t * const pxQueue = xQueue;
 			xReturn = errQUEUE_FULL;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1411,196 +1466,934 @@ Queue_t * const pxQueue = xQueue;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue, TickType_t xTicksToWait )
-{
-BaseType_t xEntryTimeSet = pdFALSE;
-TimeOut_t xTimeOut;
-Queue_t * const pxQueue = xQueue;
-
-#if( configUSE_MUTEXES == 1 )
-	BaseType_t xInheritanceOccurred = pdFALSE;
-#endif
-
-	/* Check the queue pointer is not NULL. */
-	configASSERT( ( pxQueue ) );
-
-	/* Check this really is a semaphore, in which case the item size will be
-	0. */
-	configASSERT( pxQueue->uxItemSize == 0 );
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
 
-	/* Cannot block if the scheduler is suspended. */
-	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	BaseType_t xQueueAcquireSlot( QueueHandle_t xQueue, void **ppvSlot, TickType_t xTicksToWait )
 	{
-		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
-	}
-	#endif
-
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	Queue_t * const pxQueue = xQueue;
 
-	/*lint -save -e904 This function relaxes the coding standard somewhat to allow return
-	statements within the function itself.  This is done in the interest
-	of execution time efficiency. */
-	for( ;; )
-	{
-		taskENTER_CRITICAL();
+		configASSERT( pxQueue );
+		configASSERT( ppvSlot );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
 		{
-			/* Semaphores are queues with an item size of 0, and where the
-			number of messages in the queue is the semaphore's count value. */
-			const UBaseType_t uxSemaphoreCount = pxQueue->uxMessagesWaiting;
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
 
-			/* Is there data in the queue now?  To be running the calling task
-			must be the highest priority task wanting to access the queue. */
-			if( uxSemaphoreCount > ( UBaseType_t ) 0 )
+		/*lint -save -e904 This function relaxes the coding standard somewhat to
+		allow return statements within the function itself.  This is done in the
+		interest of execution time efficiency. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
 			{
-				traceQUEUE_RECEIVE( pxQueue );
-
-				/* Semaphores are queues with a data size of zero and where the
-				messages waiting is the semaphore's count.  Reduce the count. */
-				pxQueue->uxMessagesWaiting = uxSemaphoreCount - ( UBaseType_t ) 1;
-
-				#if ( configUSE_MUTEXES == 1 )
+				/* Is there a slot that is not used by an item, or reserved by
+				another writer or reader? */
+				if( ( pxQueue->uxMessagesWaiting + pxQueue->uxSlotsAcquired + pxQueue->uxItemsBorrowed ) < pxQueue->uxLength )
 				{
-					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+					/* Reserve the slot an item sent to the back of the queue
+					would be copied into. */
+					*ppvSlot = pxQueue->pcWriteTo;
+					pxQueue->pcWriteTo += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+					if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
 					{
-						/* Record the information required to implement
-						priority inheritance should it become necessary. */
-						pxQueue->u.xSemaphore.xMutexHolder = pvTaskIncrementMutexHeldCount();
+						pxQueue->pcWriteTo = pxQueue->pcHead;
 					}
 					else
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
-				}
-				#endif /* configUSE_MUTEXES */
 
-				/* Check to see if other tasks are blocked waiting to give the
-				semaphore, and if so, unblock the highest priority such task. */
-				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+					( pxQueue->uxSlotsAcquired )++;
+
+					taskEXIT_CRITICAL();
+					return pdPASS;
+				}
+				else
 				{
-					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
+					if( xTicksToWait == ( TickType_t ) 0 )
 					{
-						queueYIELD_IF_USING_PREEMPTION();
+						/* No slot is free and no block time is specified (or
+						the block time has expired) so leave now. */
+						taskEXIT_CRITICAL();
+						traceQUEUE_SEND_FAILED( pxQueue );
+						return errQUEUE_FULL;
+					}
+					else if( xEntryTimeSet == pdFALSE )
+					{
+						vTaskInternalSetTimeOutState( &xTimeOut );
+						xEntryTimeSet = pdTRUE;
 					}
 					else
 					{
+						/* Entry time was already set. */
 						mtCOVERAGE_TEST_MARKER();
 					}
 				}
+			}
+			taskEXIT_CRITICAL();
+
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			/* Update the timeout state to see if it has expired yet. */
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsEverySlotTaken( pxQueue ) != pdFALSE )
+				{
+					/* vQueueReleaseItem() unblocks the task once a slot is
+					returned to the queue. */
+					traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
+
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+				}
 				else
 				{
-					mtCOVERAGE_TEST_MARKER();
+					/* Try again. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
 				}
-
-				taskEXIT_CRITICAL();
-				return pdPASS;
 			}
 			else
 			{
-				if( xTicksToWait == ( TickType_t ) 0 )
+				/* The timeout has expired. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+
+				traceQUEUE_SEND_FAILED( pxQueue );
+				return errQUEUE_FULL;
+			}
+		} /*lint -restore */
+	}
+
+#endif /* configUSE_QUEUE_BY_REFERENCE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+
+	void vQueueCommitSlot( QueueHandle_t xQueue, void *pvSlot )
+	{
+	Queue_t * const pxQueue = xQueue;
+	int8_t *pcOldestSlot;
+
+		configASSERT( pxQueue );
+
+		taskENTER_CRITICAL();
+		{
+			/* The oldest acquired slot follows the items already in the queue,
+			so committing it appends it to the queue. */
+			configASSERT( pxQueue->uxSlotsAcquired != ( UBaseType_t ) 0U );
+			pcOldestSlot = prvSlotBefore( pxQueue, pxQueue->pcWriteTo, pxQueue->uxSlotsAcquired );
+			configASSERT( pvSlot == ( void * ) pcOldestSlot );
+			( void ) pvSlot;
+			( void ) pcOldestSlot;
+
+			traceQUEUE_SEND( pxQueue );
+			( pxQueue->uxSlotsAcquired )--;
+			( pxQueue->uxMessagesWaiting )++;
+
+			#if ( configUSE_QUEUE_SETS == 1 )
+				if( pxQueue->pxQueueSetContainer != NULL )
 				{
-					/* For inheritance to have occurred there must have been an
-					initial timeout, and an adjusted timeout cannot become 0, as
-					if it were 0 the function would have exited. */
-					#if( configUSE_MUTEXES == 1 )
+					if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
 					{
-						configASSERT( xInheritanceOccurred == pdFALSE );
+						queueYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
 					}
-					#endif /* configUSE_MUTEXES */
-
-					/* The semaphore count was 0 and no block time is specified
-					(or the block time has expired) so exit now. */
-					taskEXIT_CRITICAL();
-					traceQUEUE_RECEIVE_FAILED( pxQueue );
-					return errQUEUE_EMPTY;
 				}
-				else if( xEntryTimeSet == pdFALSE )
+				else
+			#endif /* configUSE_QUEUE_SETS */
+			{
+				/* If there was a task waiting for data to arrive on the queue
+				then unblock it now. */
+				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
 				{
-					/* The semaphore count was 0 and a block time was specified
-					so configure the timeout structure ready to block. */
-					vTaskInternalSetTimeOutState( &xTimeOut );
-					xEntryTimeSet = pdTRUE;
+					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+					{
+						queueYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
 				}
 				else
 				{
-					/* Entry time was already set. */
 					mtCOVERAGE_TEST_MARKER();
 				}
 			}
 		}
 		taskEXIT_CRITICAL();
+	}
 
-		/* Interrupts and other tasks can give to and take from the semaphore
-		now the critical section has been exited. */
+#endif /* configUSE_QUEUE_BY_REFERENCE */
+/*-----------------------------------------------------------*/
 
-		vTaskSuspendAll();
-		prvLockQueue( pxQueue );
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
 
-		/* Update the timeout state to see if it has expired yet. */
-		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+	BaseType_t xQueueBorrowItem( QueueHandle_t xQueue, void **ppvItem, TickType_t xTicksToWait )
+	{
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( ppvItem );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
 		{
-			/* A block time is specified and not expired.  If the semaphore
-			count is 0 then enter the Blocked state to wait for a semaphore to
-			become available.  As semaphores are implemented with queues the
-			queue being empty is equivalent to the semaphore count being 0. */
-			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		/*lint -save -e904 This function relaxes the coding standard somewhat to
+		allow return statements within the function itself.  This is done in the
+		interest of execution time efficiency. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
 			{
-				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+				{
+					/* Take the item prvCopyDataFromQueue() would copy out, but
+					leave its slot reserved until it is released.  No task
+					waiting to send is unblocked as no slot has been freed. */
+					pxQueue->u.xQueue.pcReadFrom += pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+					if( pxQueue->u.xQueue.pcReadFrom >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+					{
+						pxQueue->u.xQueue.pcReadFrom = pxQueue->pcHead;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
 
-				#if ( configUSE_MUTEXES == 1 )
+					*ppvItem = pxQueue->u.xQueue.pcReadFrom;
+					traceQUEUE_RECEIVE( pxQueue );
+					( pxQueue->uxMessagesWaiting )--;
+					( pxQueue->uxItemsBorrowed )++;
+
+					taskEXIT_CRITICAL();
+					return pdPASS;
+				}
+				else
 				{
-					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+					if( xTicksToWait == ( TickType_t ) 0 )
 					{
-						taskENTER_CRITICAL();
-						{
-							xInheritanceOccurred = xTaskPriorityInherit( pxQueue->u.xSemaphore.xMutexHolder );
-						}
+						/* The queue was empty and no block time is specified
+						(or the block time has expired) so leave now. */
 						taskEXIT_CRITICAL();
+						traceQUEUE_RECEIVE_FAILED( pxQueue );
+						return errQUEUE_EMPTY;
+					}
+					else if( xEntryTimeSet == pdFALSE )
+					{
+						vTaskInternalSetTimeOutState( &xTimeOut );
+						xEntryTimeSet = pdTRUE;
 					}
 					else
 					{
+						/* Entry time was already set. */
 						mtCOVERAGE_TEST_MARKER();
 					}
 				}
-				#endif
+			}
+			taskEXIT_CRITICAL();
 
-				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
-				prvUnlockQueue( pxQueue );
-				if( xTaskResumeAll() == pdFALSE )
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			/* Update the timeout state to see if it has expired yet. */
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
 				{
-					portYIELD_WITHIN_API();
+					traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
+
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
 				}
 				else
 				{
-					mtCOVERAGE_TEST_MARKER();
+					/* The queue contains data again.  Loop back to try and
+					take it. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
 				}
 			}
 			else
 			{
-				/* There was no timeout and the semaphore count was not 0, so
-				attempt to take the semaphore again. */
+				/* Timed out.  If there is no data in the queue exit, otherwise
+				loop back and attempt to take the data. */
 				prvUnlockQueue( pxQueue );
 				( void ) xTaskResumeAll();
+
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+				{
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return errQUEUE_EMPTY;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			}
-		}
-		else
+		} /*lint -restore */
+	}
+
+#endif /* configUSE_QUEUE_BY_REFERENCE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+
+	void vQueueReleaseItem( QueueHandle_t xQueue, void *pvItem )
+	{
+	Queue_t * const pxQueue = xQueue;
+	int8_t *pcOldestItem;
+
+		configASSERT( pxQueue );
+
+		taskENTER_CRITICAL();
 		{
-			/* Timed out. */
-			prvUnlockQueue( pxQueue );
-			( void ) xTaskResumeAll();
+			/* The oldest borrowed item precedes the other borrowed items, the
+			last of which is the last item read from the queue. */
+			configASSERT( pxQueue->uxItemsBorrowed != ( UBaseType_t ) 0U );
+			pcOldestItem = prvSlotBefore( pxQueue, pxQueue->u.xQueue.pcReadFrom, pxQueue->uxItemsBorrowed - ( UBaseType_t ) 1U );
+			configASSERT( pvItem == ( void * ) pcOldestItem );
+			( void ) pvItem;
+			( void ) pcOldestItem;
 
-			/* If the semaphore count is 0 exit now as the timeout has
-			expired.  Otherwise return to attempt to take the semaphore that is
-			known to be available.  As semaphores are implemented by queues the
-			queue being empty is equivalent to the semaphore count being 0. */
-			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			( pxQueue->uxItemsBorrowed )--;
+
+			/* There is now space in the queue, were any tasks waiting to
+			acquire a slot?  If so, unblock the highest priority waiting
+			task. */
+			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
 			{
-				#if ( configUSE_MUTEXES == 1 )
+				if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
 				{
-					/* xInheritanceOccurred could only have be set if
-					pxQueue->uxQueueType == queueQUEUE_IS_MUTEX so no need to
-					test the mutex type again to check it is actually a mutex. */
-					if( xInheritanceOccurred != pdFALSE )
-					{
-						taskENTER_CRITICAL();
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_QUEUE_BY_REFERENCE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	BaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, UBaseType_t uxItemCount, TickType_t xTicksToWait )
+	{
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	UBaseType_t uxCount;
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pvItems );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		/*lint -save -e904 This function relaxes the coding standard somewhat to
+		allow return statements within the function itself.  This is done in the
+		interest of execution time efficiency. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				/* Post as many items as there is room for. */
+				uxCount = configMIN( uxItemCount, pxQueue->uxLength - pxQueue->uxMessagesWaiting );
+
+				if( ( uxCount > ( UBaseType_t ) 0 ) || ( uxItemCount == ( UBaseType_t ) 0 ) )
+				{
+					traceQUEUE_SEND( pxQueue );
+					prvCopyItemsToQueue( pxQueue, ( const int8_t * ) pvItems, uxCount );
+
+					#if ( configUSE_QUEUE_SETS == 1 )
+						if( pxQueue->pxQueueSetContainer != NULL )
+						{
+						UBaseType_t uxNotified;
+
+							/* The queue set holds one entry per item. */
+							for( uxNotified = 0; uxNotified < uxCount; uxNotified++ )
+							{
+								if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+								{
+									queueYIELD_IF_USING_PREEMPTION();
+								}
+								else
+								{
+									mtCOVERAGE_TEST_MARKER();
+								}
+							}
+						}
+						else
+					#endif /* configUSE_QUEUE_SETS */
+					{
+						/* Unblock as many tasks waiting for data as there are
+						new items. */
+						if( prvUnblockWaitingTasks( &( pxQueue->xTasksWaitingToReceive ), uxCount ) != pdFALSE )
+						{
+							queueYIELD_IF_USING_PREEMPTION();
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+
+					taskEXIT_CRITICAL();
+					return ( BaseType_t ) uxCount;
+				}
+				else
+				{
+					if( xTicksToWait == ( TickType_t ) 0 )
+					{
+						/* The queue was full and no block time is specified (or
+						the block time has expired) so leave now. */
+						taskEXIT_CRITICAL();
+						traceQUEUE_SEND_FAILED( pxQueue );
+						return 0;
+					}
+					else if( xEntryTimeSet == pdFALSE )
+					{
+						vTaskInternalSetTimeOutState( &xTimeOut );
+						xEntryTimeSet = pdTRUE;
+					}
+					else
+					{
+						/* Entry time was already set. */
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			/* Update the timeout state to see if it has expired yet. */
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsQueueFull( pxQueue ) != pdFALSE )
+				{
+					traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
+
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+				}
+				else
+				{
+					/* Try again. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
+				}
+			}
+			else
+			{
+				/* The timeout has expired. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+
+				traceQUEUE_SEND_FAILED( pxQueue );
+				return 0;
+			}
+		} /*lint -restore */
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	BaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	BaseType_t xYieldRequired = pdFALSE;
+	UBaseType_t uxSavedInterruptStatus, uxCount;
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pvItems );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		{
+			uxCount = configMIN( uxItemCount, pxQueue->uxLength - pxQueue->uxMessagesWaiting );
+
+			if( uxCount > ( UBaseType_t ) 0 )
+			{
+				const int8_t cTxLock = pxQueue->cTxLock;
+
+				traceQUEUE_SEND_FROM_ISR( pxQueue );
+				prvCopyItemsToQueue( pxQueue, ( const int8_t * ) pvItems, uxCount );
+
+				/* The event list is not altered if the queue is locked.  This
+				will be done when the queue is unlocked later. */
+				if( cTxLock == queueUNLOCKED )
+				{
+					#if ( configUSE_QUEUE_SETS == 1 )
+						if( pxQueue->pxQueueSetContainer != NULL )
+						{
+						UBaseType_t uxNotified;
+
+							for( uxNotified = 0; uxNotified < uxCount; uxNotified++ )
+							{
+								if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+								{
+									xYieldRequired = pdTRUE;
+								}
+								else
+								{
+									mtCOVERAGE_TEST_MARKER();
+								}
+							}
+						}
+						else
+					#endif /* configUSE_QUEUE_SETS */
+					{
+						xYieldRequired = prvUnblockWaitingTasks( &( pxQueue->xTasksWaitingToReceive ), uxCount );
+					}
+				}
+				else
+				{
+					/* Increment the lock count so the task that unlocks the
+					queue knows how many items were posted while it was
+					locked. */
+					pxQueue->cTxLock = prvAddToLockCount( cTxLock, uxCount );
+				}
+			}
+			else
+			{
+				traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+			}
+		}
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+		if( ( xYieldRequired != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+		{
+			*pxHigherPriorityTaskWoken = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( BaseType_t ) uxCount;
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	BaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, UBaseType_t uxMaxItems, TickType_t xTicksToWait )
+	{
+	BaseType_t xEntryTimeSet = pdFALSE;
+	TimeOut_t xTimeOut;
+	UBaseType_t uxCount;
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pvBuffer );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+		{
+			configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+		}
+		#endif
+
+		/*lint -save -e904 This function relaxes the coding standard somewhat to
+		allow return statements within the function itself.  This is done in the
+		interest of execution time efficiency. */
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				/* Remove as many items as are available. */
+				uxCount = configMIN( uxMaxItems, pxQueue->uxMessagesWaiting );
+
+				if( ( uxCount > ( UBaseType_t ) 0 ) || ( uxMaxItems == ( UBaseType_t ) 0 ) )
+				{
+					prvCopyItemsFromQueue( pxQueue, ( int8_t * ) pvBuffer, uxCount );
+					traceQUEUE_RECEIVE( pxQueue );
+
+					/* Unblock as many tasks waiting to post as there are new
+					spaces. */
+					if( prvUnblockWaitingTasks( &( pxQueue->xTasksWaitingToSend ), uxCount ) != pdFALSE )
+					{
+						queueYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					taskEXIT_CRITICAL();
+					return ( BaseType_t ) uxCount;
+				}
+				else
+				{
+					if( xTicksToWait == ( TickType_t ) 0 )
+					{
+						/* The queue was empty and no block time is specified (or
+						the block time has expired) so leave now. */
+						taskEXIT_CRITICAL();
+						traceQUEUE_RECEIVE_FAILED( pxQueue );
+						return 0;
+					}
+					else if( xEntryTimeSet == pdFALSE )
+					{
+						vTaskInternalSetTimeOutState( &xTimeOut );
+						xEntryTimeSet = pdTRUE;
+					}
+					else
+					{
+						/* Entry time was already set. */
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			vTaskSuspendAll();
+			prvLockQueue( pxQueue );
+
+			/* Update the timeout state to see if it has expired yet. */
+			if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+			{
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+				{
+					traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+					vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+					prvUnlockQueue( pxQueue );
+
+					if( xTaskResumeAll() == pdFALSE )
+					{
+						portYIELD_WITHIN_API();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					/* The queue contains data again.  Loop back to try and
+					read the data. */
+					prvUnlockQueue( pxQueue );
+					( void ) xTaskResumeAll();
+				}
+			}
+			else
+			{
+				/* Timed out.  If there is no data in the queue exit, otherwise
+				loop back and attempt to read the data. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+
+				if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+				{
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return 0;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		} /*lint -restore */
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	BaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, UBaseType_t uxMaxItems, BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	BaseType_t xYieldRequired = pdFALSE;
+	UBaseType_t uxSavedInterruptStatus, uxCount;
+	Queue_t * const pxQueue = xQueue;
+
+		configASSERT( pxQueue );
+		configASSERT( pvBuffer );
+		configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+		{
+			uxCount = configMIN( uxMaxItems, pxQueue->uxMessagesWaiting );
+
+			if( uxCount > ( UBaseType_t ) 0 )
+			{
+				const int8_t cRxLock = pxQueue->cRxLock;
+
+				traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+				prvCopyItemsFromQueue( pxQueue, ( int8_t * ) pvBuffer, uxCount );
+
+				/* If the queue is locked the event list will not be modified.
+				Instead update the lock count so the task that unlocks the
+				queue will know how many items were removed while the queue
+				was locked. */
+				if( cRxLock == queueUNLOCKED )
+				{
+					xYieldRequired = prvUnblockWaitingTasks( &( pxQueue->xTasksWaitingToSend ), uxCount );
+				}
+				else
+				{
+					pxQueue->cRxLock = prvAddToLockCount( cRxLock, uxCount );
+				}
+			}
+			else
+			{
+				traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+			}
+		}
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+		if( ( xYieldRequired != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+		{
+			*pxHigherPriorityTaskWoken = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( BaseType_t ) uxCount;
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+Queue_t * const pxQueue = xQueue;
+
+#if( configUSE_MUTEXES == 1 )
+	BaseType_t xInheritanceOccurred = pdFALSE;
+#endif
+
+	/* Check the queue pointer is not NULL. */
+	configASSERT( ( pxQueue ) );
+
+	/* Check this really is a semaphore, in which case the item size will be
+	0. */
+	configASSERT( pxQueue->uxItemSize == 0 );
+
+	/* Cannot block if the scheduler is suspended. */
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+
+	/*lint -save -e904 This function relaxes the coding standard somewhat to allow return
+	statements within the function itself.  This is done in the interest
+	of execution time efficiency. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			/* Semaphores are queues with an item size of 0, and where the
+			number of messages in the queue is the semaphore's count value. */
+			const UBaseType_t uxSemaphoreCount = pxQueue->uxMessagesWaiting;
+
+			/* Is there data in the queue now?  To be running the calling task
+			must be the highest priority task wanting to access the queue. */
+			if( uxSemaphoreCount > ( UBaseType_t ) 0 )
+			{
+				traceQUEUE_RECEIVE( pxQueue );
+
+				/* Semaphores are queues with a data size of zero and where the
+				messages waiting is the semaphore's count.  Reduce the count. */
+				pxQueue->uxMessagesWaiting = uxSemaphoreCount - ( UBaseType_t ) 1;
+
+				#if ( configUSE_MUTEXES == 1 )
+				{
+					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+					{
+						/* Record the information required to implement
+						priority inheritance should it become necessary. */
+						pxQueue->u.xSemaphore.xMutexHolder = pvTaskIncrementMutexHeldCount();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif /* configUSE_MUTEXES */
+
+				/* Check to see if other tasks are blocked waiting to give the
+				semaphore, and if so, unblock the highest priority such task. */
+				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
+					{
+						queueYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				taskEXIT_CRITICAL();
+				return pdPASS;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					/* For inheritance to have occurred there must have been an
+					initial timeout, and an adjusted timeout cannot become 0, as
+					if it were 0 the function would have exited. */
+					#if( configUSE_MUTEXES == 1 )
+					{
+						configASSERT( xInheritanceOccurred == pdFALSE );
+					}
+					#endif /* configUSE_MUTEXES */
+
+					/* The semaphore count was 0 and no block time is specified
+					(or the block time has expired) so exit now. */
+					taskEXIT_CRITICAL();
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return errQUEUE_EMPTY;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					/* The semaphore count was 0 and a block time was specified
+					so configure the timeout structure ready to block. */
+					vTaskInternalSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					/* Entry time was already set. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Interrupts and other tasks can give to and take from the semaphore
+		now the critical section has been exited. */
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		/* Update the timeout state to see if it has expired yet. */
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			/* A block time is specified and not expired.  If the semaphore
+			count is 0 then enter the Blocked state to wait for a semaphore to
+			become available.  As semaphores are implemented with queues the
+			queue being empty is equivalent to the semaphore count being 0. */
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+
+				#if ( configUSE_MUTEXES == 1 )
+				{
+					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+					{
+						taskENTER_CRITICAL();
+						{
+							xInheritanceOccurred = xTaskPriorityInherit( pxQueue->u.xSemaphore.xMutexHolder );
+						}
+						taskEXIT_CRITICAL();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif
+
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* There was no timeout and the semaphore count was not 0, so
+				attempt to take the semaphore again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			/* Timed out. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			/* If the semaphore count is 0 exit now as the timeout has
+			expired.  Otherwise return to attempt to take the semaphore that is
+			known to be available.  As semaphores are implemented by queues the
+			queue being empty is equivalent to the semaphore count being 0. */
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				#if ( configUSE_MUTEXES == 1 )
+				{
+					/* xInheritanceOccurred could only have be set if
+					pxQueue->uxQueueType == queueQUEUE_IS_MUTEX so no need to
+					test the mutex type again to check it is actually a mutex. */
+					if( xInheritanceOccurred != pdFALSE )
+					{
+						taskENTER_CRITICAL();
 						{
 							UBaseType_t uxHighestWaitingPriority;
 
@@ -1803,7 +2596,7 @@ Queue_t * const pxQueue = xQueue;
 	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 	{
 		const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
@@ -1863,7 +2656,7 @@ Queue_t * const pxQueue = xQueue;
 			traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1896,7 +2689,7 @@ Queue_t * const pxQueue = xQueue;
 	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
 	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 	{
 		/* Cannot block in an ISR, so check there is data available. */
 		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
@@ -1917,7 +2710,7 @@ Queue_t * const pxQueue = xQueue;
 			traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue );
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1949,6 +2742,12 @@ Queue_t * const pxQueue = xQueue;
 	taskENTER_CRITICAL();
 	{
 		uxReturn = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+
+		#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+		{
+			uxReturn -= pxQueue->uxSlotsAcquired + pxQueue->uxItemsBorrowed;
+		}
+		#endif
 	}
 	taskEXIT_CRITICAL();
 
@@ -2364,6 +3163,186 @@ Queue_t * const pxQueue = xQueue;
 } /*lint !e818 xQueue could not be pointer to const because it is a typedef. */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+
+	static BaseType_t prvIsEverySlotTaken( const Queue_t *pxQueue )
+	{
+	BaseType_t xReturn;
+
+		taskENTER_CRITICAL();
+		{
+			if( ( pxQueue->uxMessagesWaiting + pxQueue->uxSlotsAcquired + pxQueue->uxItemsBorrowed ) == pxQueue->uxLength )
+			{
+				xReturn = pdTRUE;
+			}
+			else
+			{
+				xReturn = pdFALSE;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_QUEUE_BY_REFERENCE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+
+	static int8_t *prvSlotBefore( const Queue_t *pxQueue, int8_t *pcSlot, UBaseType_t uxSlots )
+	{
+	size_t xOffset = ( size_t ) ( pcSlot - pxQueue->pcHead );
+	const size_t xDistance = ( size_t ) uxSlots * ( size_t ) pxQueue->uxItemSize;
+
+		if( xDistance > xOffset )
+		{
+			/* Wrap back around the end of the storage area. */
+			xOffset += ( size_t ) pxQueue->uxLength * ( size_t ) pxQueue->uxItemSize;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return pxQueue->pcHead + ( xOffset - xDistance );
+	}
+
+#endif /* configUSE_QUEUE_BY_REFERENCE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	static void prvCopyItemsToQueue( Queue_t * const pxQueue, const int8_t *pcItems, UBaseType_t uxCount )
+	{
+	const size_t xTotal = ( size_t ) uxCount * ( size_t ) pxQueue->uxItemSize;
+	size_t xFirst;
+
+		/* This function is called from a critical section. */
+
+		/* Copy up to the end of the storage area, then wrap to the start. */
+		xFirst = configMIN( xTotal, ( size_t ) ( pxQueue->u.xQueue.pcTail - pxQueue->pcWriteTo ) );
+		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, ( const void * ) pcItems, xFirst ); /*lint !e9087 memcpy() requires void *. */
+		pxQueue->pcWriteTo += xFirst; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+
+		if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+		{
+			pxQueue->pcWriteTo = pxQueue->pcHead;
+			( void ) memcpy( ( void * ) pxQueue->pcWriteTo, ( const void * ) &( pcItems[ xFirst ] ), xTotal - xFirst ); /*lint !e9087 memcpy() requires void *. */
+			pxQueue->pcWriteTo += xTotal - xFirst;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxQueue->uxMessagesWaiting += uxCount;
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	static void prvCopyItemsFromQueue( Queue_t * const pxQueue, int8_t *pcBuffer, UBaseType_t uxCount )
+	{
+	const size_t xTotal = ( size_t ) uxCount * ( size_t ) pxQueue->uxItemSize;
+	int8_t *pcReadFrom;
+	size_t xFirst;
+
+		/* This function is called from a critical section. */
+
+		if( xTotal > ( size_t ) 0 )
+		{
+			/* pcReadFrom points to the last item read, so the first item to
+			read follows it. */
+			pcReadFrom = pxQueue->u.xQueue.pcReadFrom + pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+			if( pcReadFrom >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+			{
+				pcReadFrom = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* Copy up to the end of the storage area, then wrap to the
+			start. */
+			xFirst = configMIN( xTotal, ( size_t ) ( pxQueue->u.xQueue.pcTail - pcReadFrom ) );
+			( void ) memcpy( ( void * ) pcBuffer, ( const void * ) pcReadFrom, xFirst ); /*lint !e9087 memcpy() requires void *. */
+			pcReadFrom += xFirst;
+
+			if( xTotal > xFirst )
+			{
+				( void ) memcpy( ( void * ) &( pcBuffer[ xFirst ] ), ( const void * ) pxQueue->pcHead, xTotal - xFirst ); /*lint !e9087 memcpy() requires void *. */
+				pcReadFrom = pxQueue->pcHead + ( xTotal - xFirst );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxQueue->u.xQueue.pcReadFrom = pcReadFrom - pxQueue->uxItemSize;
+			pxQueue->uxMessagesWaiting -= uxCount;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	static BaseType_t prvUnblockWaitingTasks( List_t * const pxEventList, UBaseType_t uxCount )
+	{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+		while( ( uxCount > ( UBaseType_t ) 0 ) && ( listLIST_IS_EMPTY( pxEventList ) == pdFALSE ) )
+		{
+			if( xTaskRemoveFromEventList( pxEventList ) != pdFALSE )
+			{
+				xHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			uxCount--;
+		}
+
+		return xHigherPriorityTaskWoken;
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+	static int8_t prvAddToLockCount( int8_t cLock, UBaseType_t uxCount )
+	{
+	const UBaseType_t uxMaximum = ( UBaseType_t ) 127;
+
+		configASSERT( cLock >= queueLOCKED_UNMODIFIED );
+
+		if( uxCount > ( uxMaximum - ( UBaseType_t ) cLock ) )
+		{
+			uxCount = uxMaximum - ( UBaseType_t ) cLock;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return ( int8_t ) ( ( UBaseType_t ) cLock + uxCount );
+	}
+
+#endif /* configUSE_QUEUE_SEND_RECEIVE_MULTIPLE */
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_CO_ROUTINES == 1 )
 
 	BaseType_t xQueueCRSend( QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait )
@@ -43,6 +43,12 @@ task.h is included from an application file. */
 	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to build stream_buffer.c
 #endif
 
+/* The reader and the writer publish the tail and the head without a critical
+section, so the data copies must not be moved past them. */
+#ifndef portMEMORY_BARRIER
+	#error portMEMORY_BARRIER() must be defined in portmacro.h to build stream_buffer.c - a compiler barrier is enough if the port only runs code on one core at a time
+#endif
+
 /* Lint e961, e9021 and e750 are suppressed as a MISRA exception justified
 because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
 for the header files above, but not in this file, in order to generate the
@@ -51,41 +57,44 @@ correct privileged Vs unprivileged linkage and placement. */
 
 /* If the user has not provided application specific Rx notification macros,
 or #defined the notification macros away, them provide default implementations
-that uses task notifications. */
+that uses task notifications.  A stream buffer has a single reader and a single
+writer, so the defaults only enter the kernel when the other side has actually
+registered itself as waiting.  The waiting task publishes its handle before it
+re-checks the buffer, and the macros are only used after the new head or tail
+has been published, so the barrier ensures at least one side sees the other.
+The waiting task clears its own handle when it unblocks - the handle is read
+once here so a task that stops waiting concurrently is never confused with a
+NULL (calling task) handle. */
 /*lint -save -e9026 Function like macros allowed and needed here so they can be overidden. */
 #ifndef sbRECEIVE_COMPLETED
 	#define sbRECEIVE_COMPLETED( pxStreamBuffer )										\
-		vTaskSuspendAll();																\
+	{																					\
+	TaskHandle_t xWaitingTask;															\
+																						\
+		portMEMORY_BARRIER();															\
+		xWaitingTask = ( pxStreamBuffer )->xTaskWaitingToSend;							\
+		if( xWaitingTask != NULL )														\
 		{																				\
-			if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )						\
-			{																			\
-				( void ) xTaskNotify( ( pxStreamBuffer )->xTaskWaitingToSend,			\
-									  ( uint32_t ) 0,									\
-									  eNoAction );										\
-				( pxStreamBuffer )->xTaskWaitingToSend = NULL;							\
-			}																			\
+			( void ) xTaskNotify( xWaitingTask, ( uint32_t ) 0, eNoAction );			\
 		}																				\
-		( void ) xTaskResumeAll();
+	}
 #endif /* sbRECEIVE_COMPLETED */
 
 #ifndef sbRECEIVE_COMPLETED_FROM_ISR
 	#define sbRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer,								\
 										  pxHigherPriorityTaskWoken )					\
 	{																					\
-	UBaseType_t uxSavedInterruptStatus;													\
+	TaskHandle_t xWaitingTask;															\
 																						\
-		uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();		\
+		portMEMORY_BARRIER();															\
+		xWaitingTask = ( pxStreamBuffer )->xTaskWaitingToSend;							\
+		if( xWaitingTask != NULL )														\
 		{																				\
-			if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )						\
-			{																			\
-				( void ) xTaskNotifyFromISR( ( pxStreamBuffer )->xTaskWaitingToSend,	\
-											 ( uint32_t ) 0,							\
-											 eNoAction,									\
-											 pxHigherPriorityTaskWoken );				\
-				( pxStreamBuffer )->xTaskWaitingToSend = NULL;							\
-			}																			\
+			( void ) xTaskNotifyFromISR( xWaitingTask,									\
+										 ( uint32_t ) 0,								\
+										 eNoAction,										\
+										 pxHigherPriorityTaskWoken );					\
 		}																				\
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );					\
 	}
 #endif /* sbRECEIVE_COMPLETED_FROM_ISR */
 
@@ -94,36 +103,32 @@ or #defined the notification macro away, them provide a default implementation
 that uses task notifications. */
 #ifndef sbSEND_COMPLETED
 	#define sbSEND_COMPLETED( pxStreamBuffer )											\
-		vTaskSuspendAll();																\
+	{																					\
+	TaskHandle_t xWaitingTask;															\
+																						\
+		portMEMORY_BARRIER();															\
+		xWaitingTask = ( pxStreamBuffer )->xTaskWaitingToReceive;						\
+		if( xWaitingTask != NULL )														\
 		{																				\
-			if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )						\
-			{																			\
-				( void ) xTaskNotify( ( pxStreamBuffer )->xTaskWaitingToReceive,		\
-									  ( uint32_t ) 0,									\
-									  eNoAction );										\
-				( pxStreamBuffer )->xTaskWaitingToReceive = NULL;						\
-			}																			\
+			( void ) xTaskNotify( xWaitingTask, ( uint32_t ) 0, eNoAction );			\
 		}																				\
-		( void ) xTaskResumeAll();
+	}
 #endif /* sbSEND_COMPLETED */
 
 #ifndef sbSEND_COMPLETE_FROM_ISR
 	#define sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken )		\
 	{																					\
-	UBaseType_t uxSavedInterruptStatus;													\
+	TaskHandle_t xWaitingTask;															\
 																						\
-		uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();		\
+		portMEMORY_BARRIER();															\
+		xWaitingTask = ( pxStreamBuffer )->xTaskWaitingToReceive;						\
+		if( xWaitingTask != NULL )														\
 		{																				\
-			if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )						\
-			{																			\
-				( void ) xTaskNotifyFromISR( ( pxStreamBuffer )->xTaskWaitingToReceive,	\
-											 ( uint32_t ) 0,							\
-											 eNoAction,									\
-											 pxHigherPriorityTaskWoken );				\
-				( pxStreamBuffer )->xTaskWaitingToReceive = NULL;						\
-			}																			\
+			( void ) xTaskNotifyFromISR( xWaitingTask,									\
+										 ( uint32_t ) 0,								\
+										 eNoAction,										\
+										 pxHigherPriorityTaskWoken );					\
 		}																				\
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );					\
 	}
 #endif /* sbSEND_COMPLETE_FROM_ISR */
 /*lint -restore (9026) */
@@ -160,12 +165,12 @@ typedef struct StreamBufferDef_t /*lint !e9058 Style convention uses tag. */
 static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
 
 /*
- * Add xCount bytes from pucData into the pxStreamBuffer message buffer.
- * Returns the number of bytes written, which will either equal xCount in the
- * success case, or 0 if there was not enough space in the buffer (in which case
- * no data is written into the buffer).
+ * Copy xCount bytes from pucData into the pxStreamBuffer data storage area,
+ * starting at index xHead.  Returns the index following the last byte written.
+ * The caller must have checked there is enough space, and publishes the
+ * returned index as the new head once the whole message has been written.
  */
-static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount ) PRIVILEGED_FUNCTION;
+static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount, size_t xHead ) PRIVILEGED_FUNCTION;
 
 /*
  * If the stream buffer is being used as a message buffer, then reads an entire
@@ -194,13 +199,15 @@ static size_t prvWriteMessageToBuffer(  StreamBuffer_t * const pxStreamBuffer,
 										size_t xRequiredSpace ) PRIVILEGED_FUNCTION;
 
 /*
- * Read xMaxCount bytes from the pxStreamBuffer message buffer and write them
- * to pucData.
+ * Copy xCount bytes out of the pxStreamBuffer data storage area, starting at
+ * index xTail, and write them to pucData.  Returns the index following the last
+ * byte read.  The caller publishes the returned index as the new tail once it
+ * no longer needs the data.
  */
 static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer,
 									  uint8_t *pucData,
-									  size_t xMaxCount,
-									  size_t xBytesAvailable ) PRIVILEGED_FUNCTION;
+									  size_t xCount,
+									  size_t xTail ) PRIVILEGED_FUNCTION;
 
 /*
  * Called by both pxStreamBufferCreate() and pxStreamBufferCreateStatic() to
@@ -532,7 +539,12 @@ TimeOut_t xTimeOut;
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	if( xTicksToWait != ( TickType_t ) 0 )
+	/* Only the reader moves the tail, and it can only create more space, so
+	the space can be checked without entering the kernel.  The kernel is only
+	needed if this task has to block. */
+	xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+	if( ( xSpace < xRequiredSpace ) && ( xTicksToWait != ( TickType_t ) 0 ) )
 	{
 		vTaskSetTimeOutState( &xTimeOut );
 
@@ -542,21 +554,27 @@ TimeOut_t xTimeOut;
 			buffer. */
 			taskENTER_CRITICAL();
 			{
+				/* Clear notification state as going to wait for space. */
+				( void ) xTaskNotifyStateClear( NULL );
+
+				/* Should only be one writer. */
+				configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+				pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+
+				/* The reader does not enter a critical section, so the space
+				must be checked again after the handle is visible to it. */
+				portMEMORY_BARRIER();
 				xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
 
-				if( xSpace < xRequiredSpace )
+				if( xSpace >= xRequiredSpace )
 				{
-					/* Clear notification state as going to wait for space. */
-					( void ) xTaskNotifyStateClear( NULL );
-
-					/* Should only be one writer. */
-					configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
-					pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+					pxStreamBuffer->xTaskWaitingToSend = NULL;
+					taskEXIT_CRITICAL();
+					break;
 				}
 				else
 				{
-					taskEXIT_CRITICAL();
-					break;
+					mtCOVERAGE_TEST_MARKER();
 				}
 			}
 			taskEXIT_CRITICAL();
@@ -564,17 +582,9 @@ TimeOut_t xTimeOut;
 			traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
 			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
 			pxStreamBuffer->xTaskWaitingToSend = NULL;
+			xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
 
-		} while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
-	}
-	else
-	{
-		mtCOVERAGE_TEST_MARKER();
-	}
-
-	if( xSpace == ( size_t ) 0 )
-	{
-		xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+		} while( ( xSpace < xRequiredSpace ) && ( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE ) );
 	}
 	else
 	{
@@ -665,7 +675,11 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 									   size_t xRequiredSpace )
 {
 	BaseType_t xShouldWrite;
-	size_t xReturn;
+	size_t xReturn, xNextHead = pxStreamBuffer->xHead;
+
+	/* xSpace was calculated from the tail published by the reader, so the
+	space must not be written to before the tail itself was read. */
+	portMEMORY_BARRIER();
 
 	if( xSpace == ( size_t ) 0 )
 	{
@@ -688,7 +702,7 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 		into the buffer.  Start by writing the length of the data, the data
 		itself will be written later in this function. */
 		xShouldWrite = pdTRUE;
-		( void ) prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &( xDataLengthBytes ), sbBYTES_TO_STORE_MESSAGE_LENGTH, xNextHead );
 	}
 	else
 	{
@@ -699,7 +713,13 @@ static size_t prvWriteMessageToBuffer( StreamBuffer_t * const pxStreamBuffer,
 	if( xShouldWrite != pdFALSE )
 	{
 		/* Writes the data itself. */
-		xReturn = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) pvTxData, xDataLengthBytes ); /*lint !e9079 Storage buffer is implemented as uint8_t for ease of sizing, alighment and access. */
+		xNextHead = prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) pvTxData, xDataLengthBytes, xNextHead ); /*lint !e9079 Storage buffer is implemented as uint8_t for ease of sizing, alighment and access. */
+
+		/* The reader may be running concurrently, so only publish the new head
+		once both the length and the data are in place. */
+		portMEMORY_BARRIER();
+		pxStreamBuffer->xHead = xNextHead;
+		xReturn = xDataLengthBytes;
 	}
 	else
 	{
@@ -735,27 +755,36 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 		xBytesToStoreMessageLength = 0;
 	}
 
-	if( xTicksToWait != ( TickType_t ) 0 )
+	/* Only the writer moves the head, and it can only add data, so the data
+	available can be checked without entering the kernel.  If this function was
+	invoked by a message buffer read then xBytesToStoreMessageLength holds the
+	number of bytes used to hold the length of the next discrete message.  If
+	this function was invoked by a stream buffer read then
+	xBytesToStoreMessageLength will be 0. */
+	xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+	if( ( xBytesAvailable <= xBytesToStoreMessageLength ) && ( xTicksToWait != ( TickType_t ) 0 ) )
 	{
 		/* Checking if there is data and clearing the notification state must be
 		performed atomically. */
 		taskENTER_CRITICAL();
 		{
+			/* Clear notification state as going to wait for data. */
+			( void ) xTaskNotifyStateClear( NULL );
+
+			/* Should only be one reader. */
+			configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+			pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+
+			/* The writer does not enter a critical section, so the data
+			available must be checked again after the handle is visible to
+			it. */
+			portMEMORY_BARRIER();
 			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
 
-			/* If this function was invoked by a message buffer read then
-			xBytesToStoreMessageLength holds the number of bytes used to hold
-			the length of the next discrete message.  If this function was
-			invoked by a stream buffer read then xBytesToStoreMessageLength will
-			be 0. */
-			if( xBytesAvailable <= xBytesToStoreMessageLength )
+			if( xBytesAvailable > xBytesToStoreMessageLength )
 			{
-				/* Clear notification state as going to wait for data. */
-				( void ) xTaskNotifyStateClear( NULL );
-
-				/* Should only be one reader. */
-				configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
-				pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+				pxStreamBuffer->xTaskWaitingToReceive = NULL;
 			}
 			else
 			{
@@ -781,7 +810,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 	}
 	else
 	{
-		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+		mtCOVERAGE_TEST_MARKER();
 	}
 
 	/* Whether receiving a discrete message (where xBytesToStoreMessageLength
@@ -817,7 +846,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer )
 {
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
-size_t xReturn, xBytesAvailable, xOriginalTail;
+size_t xReturn, xBytesAvailable;
 configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
 
 	configASSERT( pxStreamBuffer );
@@ -831,13 +860,11 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
 			/* The number of bytes available is greater than the number of bytes
 			required to hold the length of the next message, so another message
 			is available.  Return its length without removing the length bytes
-			from the buffer.  A copy of the tail is stored so the buffer can be
-			returned to its prior state as the message is not actually being
-			removed from the buffer. */
-			xOriginalTail = pxStreamBuffer->xTail;
-			( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, xBytesAvailable );
+			from the buffer - the tail is not updated as the message is not
+			actually being removed from the buffer. */
+			portMEMORY_BARRIER();
+			( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempReturn, sbBYTES_TO_STORE_MESSAGE_LENGTH, pxStreamBuffer->xTail );
 			xReturn = ( size_t ) xTempReturn;
-			pxStreamBuffer->xTail = xOriginalTail;
 		}
 		else
 		{
@@ -921,17 +948,21 @@ static size_t prvReadMessageFromBuffer( StreamBuffer_t *pxStreamBuffer,
 										size_t xBytesAvailable,
 										size_t xBytesToStoreMessageLength )
 {
-size_t xOriginalTail, xReceivedLength, xNextMessageLength;
+size_t xNextTail, xReceivedLength, xNextMessageLength;
 configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 
+	/* xBytesAvailable was calculated from the head published by the writer,
+	so the data up to that head must not be read before the head itself. */
+	portMEMORY_BARRIER();
+	xNextTail = pxStreamBuffer->xTail;
+
 	if( xBytesToStoreMessageLength != ( size_t ) 0 )
 	{
 		/* A discrete message is being received.  First receive the length
-		of the message.  A copy of the tail is stored so the buffer can be
-		returned to its prior state if the length of the message is too
-		large for the provided buffer. */
-		xOriginalTail = pxStreamBuffer->xTail;
-		( void ) prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, xBytesToStoreMessageLength, xBytesAvailable );
+		of the message.  The tail is not published until the message has been
+		read, so the buffer remains in its prior state if the length of the
+		message is too large for the provided buffer. */
+		xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) &xTempNextMessageLength, xBytesToStoreMessageLength, xNextTail );
 		xNextMessageLength = ( size_t ) xTempNextMessageLength;
 
 		/* Reduce the number of bytes available by the number of bytes just
@@ -943,9 +974,7 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 		if( xNextMessageLength > xBufferLengthBytes )
 		{
 			/* The user has provided insufficient space to read the message
-			so return the buffer to its previous state (so the length of
-			the message is in the buffer again). */
-			pxStreamBuffer->xTail = xOriginalTail;
+			so leave the length of the message in the buffer. */
 			xNextMessageLength = 0;
 		}
 		else
@@ -960,8 +989,24 @@ configMESSAGE_BUFFER_LENGTH_TYPE xTempNextMessageLength;
 		xNextMessageLength = xBufferLengthBytes;
 	}
 
-	/* Read the actual data. */
-	xReceivedLength = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) pvRxData, xNextMessageLength, xBytesAvailable ); /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+	/* Use the minimum of the wanted bytes and the available bytes. */
+	xReceivedLength = configMIN( xBytesAvailable, xNextMessageLength );
+
+	if( xReceivedLength > ( size_t ) 0 )
+	{
+		/* Read the actual data. */
+		xNextTail = prvReadBytesFromBuffer( pxStreamBuffer, ( uint8_t * ) pvRxData, xReceivedLength, xNextTail ); /*lint !e9079 Data storage area is implemented as uint8_t array for ease of sizing, indexing and alignment. */
+
+		/* Move the tail to effectively remove the data read from the buffer.
+		The writer may be running concurrently, so the data must have been
+		copied out before the space is handed back to it. */
+		portMEMORY_BARRIER();
+		pxStreamBuffer->xTail = xNextTail;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
 	return xReceivedLength;
 }
@@ -1033,7 +1078,7 @@ UBaseType_t uxSavedInterruptStatus;
 
 	configASSERT( pxStreamBuffer );
 
-	uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 	{
 		if( ( pxStreamBuffer )->xTaskWaitingToReceive != NULL )
 		{
@@ -1049,7 +1094,7 @@ UBaseType_t uxSavedInterruptStatus;
 			xReturn = pdFALSE;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 	return xReturn;
 }
@@ -1063,7 +1108,7 @@ UBaseType_t uxSavedInterruptStatus;
 
 	configASSERT( pxStreamBuffer );
 
-	uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+	uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 	{
 		if( ( pxStreamBuffer )->xTaskWaitingToSend != NULL )
 		{
@@ -1079,28 +1124,26 @@ UBaseType_t uxSavedInterruptStatus;
 			xReturn = pdFALSE;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount )
+static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount, size_t xHead )
 {
-size_t xNextHead, xFirstLength;
+size_t xFirstLength;
 
 	configASSERT( xCount > ( size_t ) 0 );
 
-	xNextHead = pxStreamBuffer->xHead;
-
 	/* Calculate the number of bytes that can be added in the first write -
 	which may be less than the total number of bytes that need to be added if
 	the buffer will wrap back to the beginning. */
-	xFirstLength = configMIN( pxStreamBuffer->xLength - xNextHead, xCount );
+	xFirstLength = configMIN( pxStreamBuffer->xLength - xHead, xCount );
 
 	/* Write as many bytes as can be written in the first write. */
-	configASSERT( ( xNextHead + xFirstLength ) <= pxStreamBuffer->xLength );
-	( void ) memcpy( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xNextHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	configASSERT( ( xHead + xFirstLength ) <= pxStreamBuffer->xLength );
+	( void ) memcpy( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 
 	/* If the number of bytes written was less than the number that could be
 	written in the first write... */
@@ -1115,74 +1158,58 @@ size_t xNextHead, xFirstLength;
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	xNextHead += xCount;
-	if( xNextHead >= pxStreamBuffer->xLength )
+	xHead += xCount;
+	if( xHead >= pxStreamBuffer->xLength )
 	{
-		xNextHead -= pxStreamBuffer->xLength;
+		xHead -= pxStreamBuffer->xLength;
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	pxStreamBuffer->xHead = xNextHead;
-
-	return xCount;
+	return xHead;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer, uint8_t *pucData, size_t xMaxCount, size_t xBytesAvailable )
+static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer, uint8_t *pucData, size_t xCount, size_t xTail )
 {
-size_t xCount, xFirstLength, xNextTail;
-
-	/* Use the minimum of the wanted bytes and the available bytes. */
-	xCount = configMIN( xBytesAvailable, xMaxCount );
+size_t xFirstLength;
 
-	if( xCount > ( size_t ) 0 )
-	{
-		xNextTail = pxStreamBuffer->xTail;
+	configASSERT( xCount > ( size_t ) 0 );
 
-		/* Calculate the number of bytes that can be read - which may be
-		less than the number wanted if the data wraps around to the start of
-		the buffer. */
-		xFirstLength = configMIN( pxStreamBuffer->xLength - xNextTail, xCount );
+	/* Calculate the number of bytes that can be read - which may be less than
+	the number wanted if the data wraps around to the start of the buffer. */
+	xFirstLength = configMIN( pxStreamBuffer->xLength - xTail, xCount );
 
-		/* Obtain the number of bytes it is possible to obtain in the first
-		read.  Asserts check bounds of read and write. */
-		configASSERT( xFirstLength <= xMaxCount );
-		configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
-		( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	/* Obtain the number of bytes it is possible to obtain in the first read.
+	Asserts check bounds of read and write. */
+	configASSERT( ( xTail + xFirstLength ) <= pxStreamBuffer->xLength );
+	( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
 
-		/* If the total number of wanted bytes is greater than the number
-		that could be read in the first read... */
-		if( xCount > xFirstLength )
-		{
-			/*...then read the remaining bytes from the start of the buffer. */
-			configASSERT( xCount <= xMaxCount );
-			( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
-		}
-		else
-		{
-			mtCOVERAGE_TEST_MARKER();
-		}
-
-		/* Move the tail pointer to effectively remove the data read from
-		the buffer. */
-		xNextTail += xCount;
-
-		if( xNextTail >= pxStreamBuffer->xLength )
-		{
-			xNextTail -= pxStreamBuffer->xLength;
-		}
+	/* If the total number of wanted bytes is greater than the number that
+	could be read in the first read... */
+	if( xCount > xFirstLength )
+	{
+		/*...then read the remaining bytes from the start of the buffer. */
+		( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-		pxStreamBuffer->xTail = xNextTail;
+	xTail += xCount;
+	if( xTail >= pxStreamBuffer->xLength )
+	{
+		xTail -= pxStreamBuffer->xLength;
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	return xCount;
+	return xTail;
 }
 /*-----------------------------------------------------------*/
 
@@ -69,6 +69,10 @@ functions but without including stdio.h here. */
 #define taskWAITING_NOTIFICATION		( ( uint8_t ) 1 )
 #define taskNOTIFICATION_RECEIVED		( ( uint8_t ) 2 )
 
+/* Bit mask covering every notification index, as passed to
+xTaskNotifyWaitAny(). */
+#define taskNOTIFICATION_INDEX_MASK		( ( UBaseType_t ) ( ( ( UBaseType_t ) 1U << configTASK_NOTIFICATION_ARRAY_ENTRIES ) - ( UBaseType_t ) 1U ) )
+
 /*
  * The value used to fill the stack of a task when the task is created.  This
  * is used purely for checking the high water mark for tasks.
@@ -228,7 +232,37 @@ count overflows. */
  * task should be used in place of the parameter.  This macro simply checks to
  * see if the parameter is NULL and returns a pointer to the appropriate TCB.
  */
-#define prvGetTCBFromHandle( pxHandle ) ( ( ( pxHandle ) == NULL ) ? pxCurrentTCB : ( pxHandle ) )
+#if ( configNUMBER_OF_CORES == 1 )
+	#define prvGetTCBFromHandle( pxHandle ) ( ( ( pxHandle ) == NULL ) ? pxCurrentTCB : ( pxHandle ) )
+#else
+	#define prvGetTCBFromHandle( pxHandle ) ( ( ( pxHandle ) == NULL ) ? prvGetCurrentTCB() : ( pxHandle ) )
+#endif
+
+/*
+ * Evaluates to non-zero if the task referenced by pxTCB is in the Running
+ * state.
+ */
+#if ( configNUMBER_OF_CORES == 1 )
+	#define taskTASK_IS_RUNNING( pxTCB ) ( ( pxTCB ) == pxCurrentTCB )
+#else
+	#define taskTASK_NOT_RUNNING			( ( BaseType_t ) -1 )
+	#define taskTASK_IS_RUNNING( pxTCB )	( ( pxTCB )->xTaskRunState != taskTASK_NOT_RUNNING )
+#endif
+
+/*
+ * Evaluates to non-zero if the task referenced by pxTCB, which has just been
+ * made ready, should preempt the running task.  With more than one core the
+ * task is compared against the tasks running on all the cores it may run on
+ * instead, the core it should preempt (if any) is made to yield, and the
+ * result is non-zero only if that is the calling core.
+ */
+#if ( configNUMBER_OF_CORES == 1 )
+	#define taskPREEMPTS_RUNNING_TASK( pxTCB )		( ( pxTCB )->uxPriority > pxCurrentTCB->uxPriority )
+	#define taskPREEMPTS_OR_EQUALS_RUNNING_TASK( pxTCB )	( ( pxTCB )->uxPriority >= pxCurrentTCB->uxPriority )
+#else
+	#define taskPREEMPTS_RUNNING_TASK( pxTCB )		prvYieldForTask( pxTCB )
+	#define taskPREEMPTS_OR_EQUALS_RUNNING_TASK( pxTCB )	prvYieldForTask( pxTCB )
+#endif
 
 /* The item value of the event list item is normally used to hold the priority
 of the task to which it belongs (coded to allow it to be held in reverse
@@ -305,8 +339,8 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 	#endif
 
 	#if( configUSE_TASK_NOTIFICATIONS == 1 )
-		volatile uint32_t ulNotifiedValue;
-		volatile uint8_t ucNotifyState;
+		volatile uint32_t ulNotifiedValue[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+		volatile uint8_t ucNotifyState[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
 	#endif
 
 	/* See the comments in FreeRTOS.h with the definition of
@@ -323,6 +357,11 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 		int iTaskErrno;
 	#endif
 
+	#if ( configNUMBER_OF_CORES > 1 )
+		volatile BaseType_t xTaskRunState;	/*< The core the task is running on, or taskTASK_NOT_RUNNING. */
+		UBaseType_t		uxCoreAffinityMask;	/*< Bit n is set if the task is allowed to run on core n. */
+	#endif
+
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -331,7 +370,12 @@ typedef tskTCB TCB_t;
 
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
-PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#if ( configNUMBER_OF_CORES == 1 )
+	PRIVILEGED_DATA TCB_t * volatile pxCurrentTCB = NULL;
+#else
+	/* The task running on each core. */
+	PRIVILEGED_DATA TCB_t * volatile pxCurrentTCBs[ configNUMBER_OF_CORES ] = { NULL };
+#endif
 
 /* Lists for ready and blocked tasks. --------------------
 xDelayedTaskList1 and xDelayedTaskList2 could be move to function scople but
@@ -369,7 +413,12 @@ PRIVILEGED_DATA static volatile TickType_t xTickCount 				= ( TickType_t ) confi
 PRIVILEGED_DATA static volatile UBaseType_t uxTopReadyPriority 		= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile BaseType_t xSchedulerRunning 		= pdFALSE;
 PRIVILEGED_DATA static volatile UBaseType_t uxPendedTicks 			= ( UBaseType_t ) 0U;
-PRIVILEGED_DATA static volatile BaseType_t xYieldPending 			= pdFALSE;
+#if ( configNUMBER_OF_CORES == 1 )
+	PRIVILEGED_DATA static volatile BaseType_t xYieldPending 		= pdFALSE;
+#else
+	PRIVILEGED_DATA static volatile BaseType_t xYieldPendings[ configNUMBER_OF_CORES ] = { pdFALSE };
+	PRIVILEGED_DATA static volatile UBaseType_t uxCriticalNestings[ configNUMBER_OF_CORES ] = { 0U };
+#endif
 PRIVILEGED_DATA static volatile BaseType_t xNumOfOverflows 			= ( BaseType_t ) 0;
 PRIVILEGED_DATA static UBaseType_t uxTaskNumber 					= ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xNextTaskUnblockTime		= ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
@@ -389,11 +438,27 @@ PRIVILEGED_DATA static volatile UBaseType_t uxSchedulerSuspended	= ( UBaseType_t
 
 	/* Do not move these variables to function scope as doing so prevents the
 	code working with debuggers that need to remove the static qualifier. */
-	PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
+	#if ( configNUMBER_OF_CORES == 1 )
+		PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
+	#else
+		PRIVILEGED_DATA static uint32_t ulTaskSwitchedInTimes[ configNUMBER_OF_CORES ] = { 0UL };
+	#endif
 	PRIVILEGED_DATA static uint32_t ulTotalRunTime = 0UL;		/*< Holds the total amount of execution time as defined by the run time counter clock. */
 
 #endif
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/* The variables that describe the running task exist once per core.
+	Kernel code only refers to those of the calling core, and only with
+	interrupts disabled, from an interrupt or with the scheduler suspended, so
+	the calling task cannot be moved to another core while it does so. */
+	#define pxCurrentTCB			pxCurrentTCBs[ portGET_CORE_ID() ]
+	#define xYieldPending			xYieldPendings[ portGET_CORE_ID() ]
+	#define ulTaskSwitchedInTime	ulTaskSwitchedInTimes[ portGET_CORE_ID() ]
+
+#endif
+
 /*lint -restore */
 
 /*-----------------------------------------------------------*/
@@ -541,6 +606,40 @@ static void prvResetNextTaskUnblockTime( void );
 
 #endif
 
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	/*
+	 * Returns pdTRUE if any notification index of pxTCB is in the waiting
+	 * state.
+	 */
+	static BaseType_t prvIsWaitingForNotification( const TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Moves every notification index of pxTCB that is in the waiting state
+	 * back to the not waiting state.  Called when the task is unblocked so a
+	 * notification sent to a different index does not try to unblock it again.
+	 */
+	static void prvClearNotifyWaiting( TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if( ( configUSE_TASK_NOTIFICATIONS == 1 ) && ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) )
+
+	/*
+	 * Marks every notification index selected by uxIndexMask as waiting, for
+	 * use by xTaskNotifyWaitAny().
+	 */
+	static void prvSetNotifyWaiting( TCB_t * const pxTCB, UBaseType_t uxIndexMask ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Searches the notification indexes selected by uxIndexMask, lowest first,
+	 * for one that has a notification pending.  Returns pdTRUE and writes the
+	 * index to *puxIndex (if puxIndex is not NULL) if one is found.
+	 */
+	static BaseType_t prvFindPendingNotification( const TCB_t * const pxTCB, UBaseType_t uxIndexMask, UBaseType_t *puxIndex ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Called after a Task_t structure has been allocated either statically or
  * dynamically to fill in the structure's members.
@@ -554,6 +653,37 @@ static void prvInitialiseNewTask( 	TaskFunction_t pxTaskCode,
 									TCB_t *pxNewTCB,
 									const MemoryRegion_t * const xRegions ) PRIVILEGED_FUNCTION;
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/*
+	 * Return the TCB of the task running on the calling core.  Unlike
+	 * pxCurrentTCB this can be called with interrupts enabled.
+	 */
+	static TCB_t *prvGetCurrentTCB( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Select the highest priority ready task that is allowed to run on core
+	 * xCoreID, and is not already running on another core, as the task
+	 * running on xCoreID.
+	 */
+	static void prvSelectHighestPriorityTask( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Make core xCoreID select a task to run again.  The calling core yields
+	 * when it exits the critical section (or interrupt) it is in, other cores
+	 * are interrupted.
+	 */
+	static void prvYieldCore( BaseType_t xCoreID ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * pxTCB has just been made ready.  Make the core running the lowest
+	 * priority task that pxTCB can preempt yield, if there is one.  Returns
+	 * pdTRUE if the calling core has a yield pending.
+	 */
+	static BaseType_t prvYieldForTask( TCB_t *pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif /* configNUMBER_OF_CORES */
+
 /*
  * Called after a new task has been created and initialised to place the task
  * under the control of the scheduler.
@@ -986,8 +1116,8 @@ UBaseType_t x;
 
 	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 	{
-		pxNewTCB->ulNotifiedValue = 0;
-		pxNewTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		( void ) memset( ( void * ) &( pxNewTCB->ulNotifiedValue[ 0 ] ), 0x00, sizeof( pxNewTCB->ulNotifiedValue ) );
+		( void ) memset( ( void * ) &( pxNewTCB->ucNotifyState[ 0 ] ), taskNOT_WAITING_NOTIFICATION, sizeof( pxNewTCB->ucNotifyState ) );
 	}
 	#endif
 
@@ -1004,6 +1134,13 @@ UBaseType_t x;
 	}
 	#endif
 
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		pxNewTCB->xTaskRunState = taskTASK_NOT_RUNNING;
+		pxNewTCB->uxCoreAffinityMask = tskNO_AFFINITY;
+	}
+	#endif
+
 	/* Initialize the TCB stack to look as if the task was already running,
 	but had been interrupted by the scheduler.  The return address is set
 	to the start of the task function. Once the stack has been initialised
@@ -1076,6 +1213,21 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 	taskENTER_CRITICAL();
 	{
 		uxCurrentNumberOfTasks++;
+
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+			/* The tasks that run first on each core are selected when the
+			scheduler is started, so only the lists need initialising. */
+			if( uxCurrentNumberOfTasks == ( UBaseType_t ) 1 )
+			{
+				prvInitialiseTaskLists();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
 		if( pxCurrentTCB == NULL )
 		{
 			/* There are no other tasks, or all the other tasks are in
@@ -1115,6 +1267,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
+		#endif /* configNUMBER_OF_CORES */
 
 		uxTaskNumber++;
 
@@ -1129,26 +1282,46 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		prvAddTaskToReadyList( pxNewTCB );
 
 		portSETUP_TCB( pxNewTCB );
+
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+			/* Preempt the lowest priority task the new task can replace.  A
+			yield of the calling core happens on exiting the critical
+			section. */
+			if( xSchedulerRunning != pdFALSE )
+			{
+				( void ) prvYieldForTask( pxNewTCB );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
 	}
 	taskEXIT_CRITICAL();
 
-	if( xSchedulerRunning != pdFALSE )
+	#if ( configNUMBER_OF_CORES == 1 )
 	{
-		/* If the created task is of a higher priority than the current task
-		then it should run now. */
-		if( pxCurrentTCB->uxPriority < pxNewTCB->uxPriority )
+		if( xSchedulerRunning != pdFALSE )
 		{
-			taskYIELD_IF_USING_PREEMPTION();
+			/* If the created task is of a higher priority than the current task
+			then it should run now. */
+			if( pxCurrentTCB->uxPriority < pxNewTCB->uxPriority )
+			{
+				taskYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
 		}
 		else
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
 	}
-	else
-	{
-		mtCOVERAGE_TEST_MARKER();
-	}
+	#endif /* configNUMBER_OF_CORES */
 }
 /*-----------------------------------------------------------*/
 
@@ -1190,7 +1363,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			not return. */
 			uxTaskNumber++;
 
-			if( pxTCB == pxCurrentTCB )
+			if( taskTASK_IS_RUNNING( pxTCB ) )
 			{
 				/* A task is deleting itself.  This cannot complete within the
 				task itself, as a context switch to another task is required.
@@ -1210,6 +1383,21 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				hence xYieldPending is used to latch that a context switch is
 				required. */
 				portPRE_TASK_DELETE_HOOK( pxTCB, &xYieldPending );
+
+				#if ( configNUMBER_OF_CORES > 1 )
+				{
+					/* The task may instead be running on another core, which
+					must switch away from it before it can be freed. */
+					if( pxTCB->xTaskRunState != portGET_CORE_ID() )
+					{
+						prvYieldCore( pxTCB->xTaskRunState );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif
 			}
 			else
 			{
@@ -1383,9 +1571,10 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 		configASSERT( pxTCB );
 
-		if( pxTCB == pxCurrentTCB )
+		if( taskTASK_IS_RUNNING( pxTCB ) )
 		{
-			/* The task calling this function is querying its own state. */
+			/* The task calling this function is querying its own state, or
+			the task is running on another core. */
 			eReturn = eRunning;
 		}
 		else
@@ -1419,7 +1608,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 							and of the RTOS objects, but could still be in the
 							blocked state if it is waiting on its notification
 							rather than waiting on an object. */
-							if( pxTCB->ucNotifyState == taskWAITING_NOTIFICATION )
+							if( prvIsWaitingForNotification( pxTCB ) != pdFALSE )
 							{
 								eReturn = eBlocked;
 							}
@@ -1465,6 +1654,77 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 #endif /* INCLUDE_eTaskGetState */
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	void vTaskCoreAffinitySet( TaskHandle_t xTask, UBaseType_t uxCoreAffinityMask )
+	{
+	TCB_t *pxTCB;
+	BaseType_t xCoreID;
+
+		configASSERT( ( uxCoreAffinityMask & ( ( ( UBaseType_t ) 1U << configNUMBER_OF_CORES ) - ( UBaseType_t ) 1U ) ) != 0U );
+
+		taskENTER_CRITICAL();
+		{
+			/* If null is passed in here then it is the affinity of the
+			calling task that is being changed. */
+			pxTCB = prvGetTCBFromHandle( xTask );
+			pxTCB->uxCoreAffinityMask = uxCoreAffinityMask;
+
+			if( xSchedulerRunning != pdFALSE )
+			{
+				if( taskTASK_IS_RUNNING( pxTCB ) )
+				{
+					/* The task must leave a core it is no longer allowed to
+					run on. */
+					xCoreID = pxTCB->xTaskRunState;
+
+					if( ( uxCoreAffinityMask & ( ( UBaseType_t ) 1U << xCoreID ) ) == 0U )
+					{
+						prvYieldCore( xCoreID );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+				{
+					/* The task may now be able to preempt a task on a core it
+					was not allowed to run on before. */
+					( void ) prvYieldForTask( pxTCB );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	UBaseType_t uxTaskCoreAffinityGet( const TaskHandle_t xTask )
+	{
+	TCB_t const *pxTCB;
+	UBaseType_t uxReturn;
+
+		taskENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+			uxReturn = pxTCB->uxCoreAffinityMask;
+		}
+		taskEXIT_CRITICAL();
+
+		return uxReturn;
+	}
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_uxTaskPriorityGet == 1 )
 
 	UBaseType_t uxTaskPriorityGet( const TaskHandle_t xTask )
@@ -1512,14 +1772,14 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		https://www.freertos.org/RTOS-Cortex-M3-M4.html */
 		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-		uxSavedInterruptState = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptState = taskENTER_CRITICAL_FROM_ISR();
 		{
 			/* If null is passed in here then it is the priority of the calling
 			task that is being queried. */
 			pxTCB = prvGetTCBFromHandle( xTask );
 			uxReturn = pxTCB->uxPriority;
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptState );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptState );
 
 		return uxReturn;
 	}
@@ -1671,14 +1931,46 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					mtCOVERAGE_TEST_MARKER();
 				}
 
-				if( xYieldRequired != pdFALSE )
+				#if ( configNUMBER_OF_CORES == 1 )
 				{
-					taskYIELD_IF_USING_PREEMPTION();
+					if( xYieldRequired != pdFALSE )
+					{
+						taskYIELD_IF_USING_PREEMPTION();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
 				}
-				else
+				#else
 				{
-					mtCOVERAGE_TEST_MARKER();
+					/* The tests above only consider the calling core.  A
+					running task that was lowered may now have to give way on
+					whichever core it is running, and a ready task that was
+					raised may now preempt a task on any core. */
+					( void ) xYieldRequired;
+
+					if( taskTASK_IS_RUNNING( pxTCB ) )
+					{
+						if( uxNewPriority < uxCurrentBasePriority )
+						{
+							prvYieldCore( pxTCB->xTaskRunState );
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+					{
+						( void ) prvYieldForTask( pxTCB );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
 				}
+				#endif /* configNUMBER_OF_CORES */
 
 				/* Remove compiler warning about unused variables when the port
 				optimised task selection is not being used. */
@@ -1730,11 +2022,24 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 
 			#if( configUSE_TASK_NOTIFICATIONS == 1 )
 			{
-				if( pxTCB->ucNotifyState == taskWAITING_NOTIFICATION )
+				/* If the task was blocked to wait for a notification it is now
+				suspended, so no notification was received. */
+				prvClearNotifyWaiting( pxTCB );
+			}
+			#endif
+
+			#if ( configNUMBER_OF_CORES > 1 )
+			{
+				/* A task running on another core is switched out by that
+				core.  The calling task yields below if it suspended
+				itself. */
+				if( ( taskTASK_IS_RUNNING( pxTCB ) ) && ( pxTCB->xTaskRunState != portGET_CORE_ID() ) )
+				{
+					prvYieldCore( pxTCB->xTaskRunState );
+				}
+				else
 				{
-					/* The task was blocked to wait for a notification, but is
-					now suspended, so no notification was received. */
-					pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+					mtCOVERAGE_TEST_MARKER();
 				}
 			}
 			#endif
@@ -1863,7 +2168,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 					prvAddTaskToReadyList( pxTCB );
 
 					/* A higher priority task may have just been resumed. */
-					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+					if( taskPREEMPTS_OR_EQUALS_RUNNING_TASK( pxTCB ) )
 					{
 						/* This yield may not cause the task just resumed to run,
 						but will leave the lists in the correct state for the
@@ -1920,7 +2225,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 		https://www.freertos.org/RTOS-Cortex-M3-M4.html */
 		portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
 
-		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 		{
 			if( prvTaskIsTaskSuspended( pxTCB ) != pdFALSE )
 			{
@@ -1931,7 +2236,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				{
 					/* Ready lists can be accessed so move the task from the
 					suspended list to the ready list directly. */
-					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+					if( taskPREEMPTS_OR_EQUALS_RUNNING_TASK( pxTCB ) )
 					{
 						xYieldRequired = pdTRUE;
 					}
@@ -1956,7 +2261,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 		return xYieldRequired;
 	}
@@ -2007,6 +2312,24 @@ BaseType_t xReturn;
 	}
 	#endif /* configSUPPORT_STATIC_ALLOCATION */
 
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+	BaseType_t xCoreID;
+
+		/* Each additional core has an idle task of its own, so every core
+		always has a task to run. */
+		for( xCoreID = 1; ( xCoreID < ( BaseType_t ) configNUMBER_OF_CORES ) && ( xReturn == pdPASS ); xCoreID++ )
+		{
+			xReturn = xTaskCreate(	prvIdleTask,
+									configIDLE_TASK_NAME,
+									configMINIMAL_STACK_SIZE,
+									( void * ) NULL,
+									portPRIVILEGE_BIT,
+									NULL );
+		}
+	}
+	#endif /* configNUMBER_OF_CORES */
+
 	#if ( configUSE_TIMERS == 1 )
 	{
 		if( xReturn == pdPASS )
@@ -2038,6 +2361,18 @@ BaseType_t xReturn;
 		starts to run. */
 		portDISABLE_INTERRUPTS();
 
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+		BaseType_t xCoreID;
+
+			/* Select the task each core runs first. */
+			for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+			{
+				prvSelectHighestPriorityTask( xCoreID );
+			}
+		}
+		#endif /* configNUMBER_OF_CORES */
+
 		#if ( configUSE_NEWLIB_REENTRANT == 1 )
 		{
 			/* Switch Newlib's _impure_ptr variable to point to the _reent
@@ -2099,11 +2434,41 @@ void vTaskEndScheduler( void )
 
 void vTaskSuspendAll( void )
 {
-	/* A critical section is not required as the variable is of type
-	BaseType_t.  Please read Richard Barry's reply in the following link to a
-	post in the FreeRTOS support forum before reporting this as a bug! -
-	http://goo.gl/wu4acr */
-	++uxSchedulerSuspended;
+	#if ( configNUMBER_OF_CORES == 1 )
+	{
+		/* A critical section is not required as the variable is of type
+		BaseType_t.  Please read Richard Barry's reply in the following link to a
+		post in the FreeRTOS support forum before reporting this as a bug! -
+		http://goo.gl/wu4acr */
+		++uxSchedulerSuspended;
+	}
+	#else
+	{
+	UBaseType_t uxSavedInterruptStatus;
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			/* The task lock is held for as long as the scheduler is
+			suspended, which keeps the tasks on the other cores out of the
+			kernel.  Interrupts are masked while it is taken so the calling
+			task cannot be switched out between taking the lock and
+			incrementing the count.  The ISR lock orders the increment with
+			the interrupts on the other cores. */
+			uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+			portGET_TASK_LOCK();
+			portGET_ISR_LOCK();
+			{
+				++uxSchedulerSuspended;
+			}
+			portRELEASE_ISR_LOCK();
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		}
+		else
+		{
+			++uxSchedulerSuspended;
+		}
+	}
+	#endif /* configNUMBER_OF_CORES */
 }
 /*----------------------------------------------------------*/
 
@@ -2188,6 +2553,21 @@ BaseType_t xAlreadyYielded = pdFALSE;
 	{
 		--uxSchedulerSuspended;
 
+		#if ( configNUMBER_OF_CORES > 1 )
+		{
+			/* Release the task lock taken by vTaskSuspendAll().  It is still
+			held by the critical section until the section is exited. */
+			if( xSchedulerRunning != pdFALSE )
+			{
+				portRELEASE_TASK_LOCK();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+
 		if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
 		{
 			if( uxCurrentNumberOfTasks > ( UBaseType_t ) 0U )
@@ -2203,7 +2583,7 @@ BaseType_t xAlreadyYielded = pdFALSE;
 
 					/* If the moved task has a priority higher than the current
 					task then a yield must be performed. */
-					if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+					if( taskPREEMPTS_OR_EQUALS_RUNNING_TASK( pxTCB ) )
 					{
 						xYieldPending = pdTRUE;
 					}
@@ -2635,7 +3015,7 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 					/* Preemption is on, but a context switch should only be
 					performed if the unblocked task has a priority that is
 					equal to or higher than the currently executing task. */
-					if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+					if( taskPREEMPTS_RUNNING_TASK( pxTCB ) )
 					{
 						/* Pend the yield to be performed when the scheduler
 						is unsuspended. */
@@ -2758,7 +3138,7 @@ BaseType_t xSwitchRequired = pdFALSE;
 						only be performed if the unblocked task has a
 						priority that is equal to or higher than the
 						currently executing task. */
-						if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+						if( taskPREEMPTS_OR_EQUALS_RUNNING_TASK( pxTCB ) )
 						{
 							xSwitchRequired = pdTRUE;
 						}
@@ -2777,14 +3157,50 @@ BaseType_t xSwitchRequired = pdFALSE;
 		writer has not explicitly turned time slicing off. */
 		#if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
 		{
-			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 )
+			#if ( configNUMBER_OF_CORES == 1 )
 			{
-				xSwitchRequired = pdTRUE;
+				if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 )
+				{
+					xSwitchRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			}
-			else
+			#else
 			{
-				mtCOVERAGE_TEST_MARKER();
+			BaseType_t xCoreID, xOtherCoreID;
+			UBaseType_t uxRunning;
+			List_t *pxReadyList;
+
+				/* A core shares its time with the other tasks of its task's
+				priority only if some of those tasks are not already running
+				on another core. */
+				for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+				{
+					pxReadyList = &( pxReadyTasksLists[ pxCurrentTCBs[ xCoreID ]->uxPriority ] );
+					uxRunning = 0;
+
+					for( xOtherCoreID = 0; xOtherCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xOtherCoreID++ )
+					{
+						if( listIS_CONTAINED_WITHIN( pxReadyList, &( pxCurrentTCBs[ xOtherCoreID ]->xStateListItem ) ) != pdFALSE )
+						{
+							uxRunning++;
+						}
+					}
+
+					if( listCURRENT_LIST_LENGTH( pxReadyList ) > uxRunning )
+					{
+						prvYieldCore( xCoreID );
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
 			}
+			#endif /* configNUMBER_OF_CORES */
 		}
 		#endif /* ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) ) */
 
@@ -2899,11 +3315,11 @@ BaseType_t xSwitchRequired = pdFALSE;
 
 		/* Save the hook function in the TCB.  A critical section is required as
 		the value can be accessed from an interrupt. */
-		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 		{
 			xReturn = pxTCB->pxTaskTag;
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 		return xReturn;
 	}
@@ -2943,8 +3359,162 @@ BaseType_t xSwitchRequired = pdFALSE;
 #endif /* configUSE_APPLICATION_TASK_TAG */
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	static TCB_t *prvGetCurrentTCB( void )
+	{
+	TCB_t *pxTCB;
+	UBaseType_t uxSavedInterruptStatus;
+
+		/* Interrupts are masked so the calling task cannot be moved to
+		another core between reading the core ID and reading the TCB. */
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			pxTCB = pxCurrentTCBs[ portGET_CORE_ID() ];
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return pxTCB;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvSelectHighestPriorityTask( BaseType_t xCoreID )
+	{
+	UBaseType_t uxCurrentPriority, uxTasksToCheck;
+	BaseType_t xTaskScheduled = pdFALSE;
+	List_t *pxReadyList;
+	TCB_t *pxTCB;
+
+		/* uxTopReadyPriority is only lowered past empty ready lists, as the
+		task selected below may be of a lower priority than a task that is
+		already running on another core. */
+		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) != pdFALSE )
+		{
+			configASSERT( uxTopReadyPriority );
+			--uxTopReadyPriority;
+		}
+
+		/* The task that was running on this core may be selected again. */
+		if( pxCurrentTCBs[ xCoreID ] != NULL )
+		{
+			pxCurrentTCBs[ xCoreID ]->xTaskRunState = taskTASK_NOT_RUNNING;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Tasks of equal priority are visited in turn, as they are on a
+		single core, skipping those running on other cores and those not
+		allowed to run on this one. */
+		for( uxCurrentPriority = uxTopReadyPriority + 1U; ( uxCurrentPriority > 0U ) && ( xTaskScheduled == pdFALSE ); )
+		{
+			--uxCurrentPriority;
+			pxReadyList = &( pxReadyTasksLists[ uxCurrentPriority ] );
+
+			for( uxTasksToCheck = listCURRENT_LIST_LENGTH( pxReadyList ); ( uxTasksToCheck > 0U ) && ( xTaskScheduled == pdFALSE ); uxTasksToCheck-- )
+			{
+				listGET_OWNER_OF_NEXT_ENTRY( pxTCB, pxReadyList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+
+				if( ( pxTCB->xTaskRunState == taskTASK_NOT_RUNNING ) &&
+					( ( pxTCB->uxCoreAffinityMask & ( ( UBaseType_t ) 1U << xCoreID ) ) != 0U ) )
+				{
+					pxTCB->xTaskRunState = xCoreID;
+					pxCurrentTCBs[ xCoreID ] = pxTCB;
+					xTaskScheduled = pdTRUE;
+				}
+			}
+		}
+
+		/* There is an idle task for every core, so there is always a task
+		that can run. */
+		configASSERT( xTaskScheduled != pdFALSE );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvYieldCore( BaseType_t xCoreID )
+	{
+		if( xCoreID == portGET_CORE_ID() )
+		{
+			xYieldPendings[ xCoreID ] = pdTRUE;
+		}
+		else if( xYieldPendings[ xCoreID ] == pdFALSE )
+		{
+			/* A core that already has a yield pending will select a task
+			anyway, so does not need interrupting again. */
+			xYieldPendings[ xCoreID ] = pdTRUE;
+			portYIELD_CORE( xCoreID );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvYieldForTask( TCB_t *pxTCB )
+	{
+	BaseType_t xCoreID, xLowestPriorityCore = taskTASK_NOT_RUNNING;
+	UBaseType_t uxLowestPriority = pxTCB->uxPriority;
+
+		#if ( configUSE_PREEMPTION == 1 )
+		{
+			if( xSchedulerRunning != pdFALSE )
+			{
+				/* Cores that already have a yield pending are skipped, so
+				several tasks made ready together preempt different cores. */
+				for( xCoreID = 0; xCoreID < ( BaseType_t ) configNUMBER_OF_CORES; xCoreID++ )
+				{
+					if( ( ( pxTCB->uxCoreAffinityMask & ( ( UBaseType_t ) 1U << xCoreID ) ) != 0U ) &&
+						( xYieldPendings[ xCoreID ] == pdFALSE ) &&
+						( pxCurrentTCBs[ xCoreID ]->uxPriority < uxLowestPriority ) )
+					{
+						uxLowestPriority = pxCurrentTCBs[ xCoreID ]->uxPriority;
+						xLowestPriorityCore = xCoreID;
+					}
+				}
+
+				if( xLowestPriorityCore != taskTASK_NOT_RUNNING )
+				{
+					prvYieldCore( xLowestPriorityCore );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#else
+		{
+			( void ) xCoreID;
+			( void ) xLowestPriorityCore;
+			( void ) uxLowestPriority;
+		}
+		#endif /* configUSE_PREEMPTION */
+
+		return xYieldPendings[ portGET_CORE_ID() ];
+	}
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
 void vTaskSwitchContext( void )
 {
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		/* The caller has interrupts disabled and holds neither lock.  The
+		task lock is taken first, in the same order as in a critical section,
+		so the ready lists and the running tasks of the other cores cannot
+		change during the selection. */
+		portGET_TASK_LOCK();
+		portGET_ISR_LOCK();
+	}
+	#endif
+
 	if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
 	{
 		/* The scheduler is currently suspended - do not allow a context
@@ -2995,7 +3565,15 @@ void vTaskSwitchContext( void )
 
 		/* Select a new task to run using either the generic C or port
 		optimised asm code. */
-		taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		#if ( configNUMBER_OF_CORES == 1 )
+		{
+			taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+		}
+		#else
+		{
+			prvSelectHighestPriorityTask( portGET_CORE_ID() );
+		}
+		#endif
 		traceTASK_SWITCHED_IN();
 
 		/* After the new task is switched in, update the global errno. */
@@ -3013,6 +3591,13 @@ void vTaskSwitchContext( void )
 		}
 		#endif /* configUSE_NEWLIB_REENTRANT */
 	}
+
+	#if ( configNUMBER_OF_CORES > 1 )
+	{
+		portRELEASE_ISR_LOCK();
+		portRELEASE_TASK_LOCK();
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -3138,7 +3723,7 @@ BaseType_t xReturn;
 		vListInsertEnd( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
 	}
 
-	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+	if( taskPREEMPTS_RUNNING_TASK( pxUnblockedTCB ) )
 	{
 		/* Return true if the task removed from the event list has a higher
 		priority than the calling task.  This allows the calling task to know if
@@ -3181,7 +3766,7 @@ TCB_t *pxUnblockedTCB;
 	( void ) uxListRemove( &( pxUnblockedTCB->xStateListItem ) );
 	prvAddTaskToReadyList( pxUnblockedTCB );
 
-	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+	if( taskPREEMPTS_RUNNING_TASK( pxUnblockedTCB ) )
 	{
 		/* The unblocked task has a priority above that of the calling task, so
 		a context switch is required.  This function is called with the
@@ -3349,6 +3934,15 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 		is responsible for freeing the deleted task's TCB and stack. */
 		prvCheckTasksWaitingTermination();
 
+		#if ( configUSE_HEAP_TASK_CACHES == 1 )
+		{
+			/* Return the blocks that tasks have kept in their heap caches
+			without using them, including the caches of tasks that no longer
+			allocate. */
+			vPortTrimTaskCaches();
+		}
+		#endif /* configUSE_HEAP_TASK_CACHES */
+
 		#if ( configUSE_PREEMPTION == 0 )
 		{
 			/* If we are not using preemption we keep forcing a task switch to
@@ -3368,9 +3962,10 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 
 			A critical region is not required here as we are just reading from
 			the list, and an occasional incorrect value will not matter.  If
-			the ready list at the idle priority contains more than one task
-			then a task other than the idle task is ready to execute. */
-			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) 1 )
+			the ready list at the idle priority contains more tasks than
+			there are idle tasks then a task other than an idle task is ready
+			to execute. */
+			if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( UBaseType_t ) configNUMBER_OF_CORES )
 			{
 				taskYIELD();
 			}
@@ -3551,8 +4146,10 @@ UBaseType_t uxPriority;
 		vListInitialise( &( pxReadyTasksLists[ uxPriority ] ) );
 	}
 
-	vListInitialise( &xDelayedTaskList1 );
-	vListInitialise( &xDelayedTaskList2 );
+	/* The delayed lists hold every blocked task with a timeout, so are
+	indexed to keep the insertion made each time a task blocks O(log n). */
+	vListInitialiseIndexed( &xDelayedTaskList1 );
+	vListInitialiseIndexed( &xDelayedTaskList2 );
 	vListInitialise( &xPendingReadyList );
 
 	#if ( INCLUDE_vTaskDelete == 1 )
@@ -3581,22 +4178,42 @@ static void prvCheckTasksWaitingTermination( void )
 
 	#if ( INCLUDE_vTaskDelete == 1 )
 	{
-		TCB_t *pxTCB;
+		TCB_t *pxTCB = NULL;
+		BaseType_t xTaskFreed = pdTRUE;
 
 		/* uxDeletedTasksWaitingCleanUp is used to prevent taskENTER_CRITICAL()
 		being called too often in the idle task. */
-		while( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U )
+		while( ( uxDeletedTasksWaitingCleanUp > ( UBaseType_t ) 0U ) && ( xTaskFreed != pdFALSE ) )
 		{
 			taskENTER_CRITICAL();
 			{
 				pxTCB = listGET_OWNER_OF_HEAD_ENTRY( ( &xTasksWaitingTermination ) ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
-				--uxCurrentNumberOfTasks;
-				--uxDeletedTasksWaitingCleanUp;
+
+				/* A task that deleted itself, or was deleted while running on
+				another core, cannot be freed until its core has switched
+				away from it.  Only possible when there is more than one
+				core. */
+				if( taskTASK_IS_RUNNING( pxTCB ) )
+				{
+					xTaskFreed = pdFALSE;
+				}
+				else
+				{
+					( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+					--uxCurrentNumberOfTasks;
+					--uxDeletedTasksWaitingCleanUp;
+				}
 			}
 			taskEXIT_CRITICAL();
 
-			prvDeleteTCB( pxTCB );
+			if( xTaskFreed != pdFALSE )
+			{
+				prvDeleteTCB( pxTCB );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
 		}
 	}
 	#endif /* INCLUDE_vTaskDelete */
@@ -3643,7 +4260,7 @@ static void prvCheckTasksWaitingTermination( void )
 		state is just set to whatever is passed in. */
 		if( eState != eInvalid )
 		{
-			if( pxTCB == pxCurrentTCB )
+			if( taskTASK_IS_RUNNING( pxTCB ) )
 			{
 				pxTaskStatus->eCurrentState = eRunning;
 			}
@@ -3829,6 +4446,13 @@ static void prvCheckTasksWaitingTermination( void )
 		want to allocate and clean RAM statically. */
 		portCLEAN_UP_TCB( pxTCB );
 
+		#if( configUSE_HEAP_TASK_CACHES == 1 )
+		{
+			/* Return the small blocks the task kept for reuse to the heap. */
+			vPortFreeTaskCache( pxTCB->pvThreadLocalStoragePointers[ configHEAP_TASK_CACHE_TLS_INDEX ] );
+		}
+		#endif
+
 		/* Free up the memory allocated by the scheduler for the task.  It is up
 		to the task to free any memory allocated at the application level. */
 		#if ( configUSE_NEWLIB_REENTRANT == 1 )
@@ -3909,7 +4533,15 @@ TCB_t *pxTCB;
 		/* A critical section is not required as this is not called from
 		an interrupt and the current TCB will always be the same for any
 		individual execution thread. */
-		xReturn = pxCurrentTCB;
+		#if ( configNUMBER_OF_CORES == 1 )
+		{
+			xReturn = pxCurrentTCB;
+		}
+		#else
+		{
+			xReturn = prvGetCurrentTCB();
+		}
+		#endif
 
 		return xReturn;
 	}
@@ -4214,7 +4846,45 @@ TCB_t *pxTCB;
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
 
-#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+#if ( configNUMBER_OF_CORES > 1 )
+
+	void vTaskEnterCritical( void )
+	{
+	BaseType_t xCoreID;
+
+		portDISABLE_INTERRUPTS();
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			xCoreID = portGET_CORE_ID();
+
+			/* The locks are recursive, so are only taken on entry to the
+			outermost critical section.  The task lock is always taken before
+			the ISR lock. */
+			if( uxCriticalNestings[ xCoreID ] == 0U )
+			{
+				portGET_TASK_LOCK();
+				portGET_ISR_LOCK();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			( uxCriticalNestings[ xCoreID ] )++;
+
+			if( uxCriticalNestings[ xCoreID ] == 1U )
+			{
+				portASSERT_IF_IN_ISR();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#elif ( portCRITICAL_NESTING_IN_TCB == 1 )
 
 	void vTaskEnterCritical( void )
 	{
@@ -4244,7 +4914,66 @@ TCB_t *pxTCB;
 #endif /* portCRITICAL_NESTING_IN_TCB */
 /*-----------------------------------------------------------*/
 
-#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+#if ( configNUMBER_OF_CORES > 1 )
+
+	void vTaskExitCritical( void )
+	{
+	BaseType_t xCoreID, xYieldCurrentTask = pdFALSE;
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			xCoreID = portGET_CORE_ID();
+
+			if( uxCriticalNestings[ xCoreID ] > 0U )
+			{
+				( uxCriticalNestings[ xCoreID ] )--;
+
+				if( uxCriticalNestings[ xCoreID ] == 0U )
+				{
+					/* Yields requested of this core while in the critical
+					section are performed now, unless this core has the
+					scheduler suspended.  uxSchedulerSuspended can only be
+					non-zero here if it is this core that holds the task
+					lock for it. */
+					if( ( xYieldPendings[ xCoreID ] != pdFALSE ) && ( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE ) )
+					{
+						xYieldCurrentTask = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+
+					portRELEASE_ISR_LOCK();
+					portRELEASE_TASK_LOCK();
+					portENABLE_INTERRUPTS();
+
+					if( xYieldCurrentTask != pdFALSE )
+					{
+						portYIELD();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#elif ( portCRITICAL_NESTING_IN_TCB == 1 )
 
 	void vTaskExitCritical( void )
 	{
@@ -4277,6 +5006,62 @@ TCB_t *pxTCB;
 #endif /* portCRITICAL_NESTING_IN_TCB */
 /*-----------------------------------------------------------*/
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	UBaseType_t uxTaskEnterCriticalFromISR( void )
+	{
+	UBaseType_t uxSavedInterruptStatus;
+
+		/* Interrupts on the other cores are kept out by the ISR lock.  The
+		task lock is not needed as tasks take the ISR lock too. */
+		uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR();
+
+		if( xSchedulerRunning != pdFALSE )
+		{
+			portGET_ISR_LOCK();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return uxSavedInterruptStatus;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskExitCriticalFromISR( UBaseType_t uxSavedInterruptStatus )
+	{
+		if( xSchedulerRunning != pdFALSE )
+		{
+			portRELEASE_ISR_LOCK();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskYieldWithinAPI( void )
+	{
+		/* A yield requested from inside a critical section is held pending
+		until the critical section is exited, as the core cannot switch
+		tasks while it holds the kernel locks. */
+		if( uxCriticalNestings[ portGET_CORE_ID() ] == 0U )
+		{
+			portYIELD();
+		}
+		else
+		{
+			xYieldPendings[ portGET_CORE_ID() ] = pdTRUE;
+		}
+	}
+
+#endif /* configNUMBER_OF_CORES */
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 	static char *prvWriteNameToBuffer( char *pcBuffer, const char *pcTaskName )
@@ -4562,17 +5347,113 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+	static BaseType_t prvIsWaitingForNotification( const TCB_t * const pxTCB )
+	{
+	UBaseType_t uxIndex;
+	BaseType_t xReturn = pdFALSE;
+
+		for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) configTASK_NOTIFICATION_ARRAY_ENTRIES; uxIndex++ )
+		{
+			if( pxTCB->ucNotifyState[ uxIndex ] == taskWAITING_NOTIFICATION )
+			{
+				xReturn = pdTRUE;
+				break;
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static void prvClearNotifyWaiting( TCB_t * const pxTCB )
+	{
+	UBaseType_t uxIndex;
+
+		for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) configTASK_NOTIFICATION_ARRAY_ENTRIES; uxIndex++ )
+		{
+			if( pxTCB->ucNotifyState[ uxIndex ] == taskWAITING_NOTIFICATION )
+			{
+				pxTCB->ucNotifyState[ uxIndex ] = taskNOT_WAITING_NOTIFICATION;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if( ( configUSE_TASK_NOTIFICATIONS == 1 ) && ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) )
+
+	static void prvSetNotifyWaiting( TCB_t * const pxTCB, UBaseType_t uxIndexMask )
+	{
+	UBaseType_t uxIndex;
+
+		for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) configTASK_NOTIFICATION_ARRAY_ENTRIES; uxIndex++ )
+		{
+			if( ( uxIndexMask & ( ( UBaseType_t ) 1U << uxIndex ) ) != ( UBaseType_t ) 0 )
+			{
+				pxTCB->ucNotifyState[ uxIndex ] = taskWAITING_NOTIFICATION;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+
+#endif /* ( configUSE_TASK_NOTIFICATIONS == 1 ) && ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) */
+/*-----------------------------------------------------------*/
+
+#if( ( configUSE_TASK_NOTIFICATIONS == 1 ) && ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) )
+
+	static BaseType_t prvFindPendingNotification( const TCB_t * const pxTCB, UBaseType_t uxIndexMask, UBaseType_t *puxIndex )
+	{
+	UBaseType_t uxIndex;
+	BaseType_t xReturn = pdFALSE;
+
+		for( uxIndex = ( UBaseType_t ) 0; uxIndex < ( UBaseType_t ) configTASK_NOTIFICATION_ARRAY_ENTRIES; uxIndex++ )
+		{
+			if( ( ( uxIndexMask & ( ( UBaseType_t ) 1U << uxIndex ) ) != ( UBaseType_t ) 0 ) &&
+				( pxTCB->ucNotifyState[ uxIndex ] == taskNOTIFICATION_RECEIVED ) )
+			{
+				if( puxIndex != NULL )
+				{
+					*puxIndex = uxIndex;
+				}
+
+				xReturn = pdTRUE;
+				break;
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif /* ( configUSE_TASK_NOTIFICATIONS == 1 ) && ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	uint32_t ulTaskNotifyTakeIndexed( UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
 	{
 	uint32_t ulReturn;
 
+		configASSERT( uxIndexToWaitOn < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		taskENTER_CRITICAL();
 		{
 			/* Only block if the notification count is not already non-zero. */
-			if( pxCurrentTCB->ulNotifiedValue == 0UL )
+			if( pxCurrentTCB->ulNotifiedValue[ uxIndexToWaitOn ] == 0UL )
 			{
 				/* Mark this task as waiting for a notification. */
-				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+				pxCurrentTCB->ucNotifyState[ uxIndexToWaitOn ] = taskWAITING_NOTIFICATION;
 
 				if( xTicksToWait > ( TickType_t ) 0 )
 				{
@@ -4600,17 +5481,17 @@ TickType_t uxReturn;
 		taskENTER_CRITICAL();
 		{
 			traceTASK_NOTIFY_TAKE();
-			ulReturn = pxCurrentTCB->ulNotifiedValue;
+			ulReturn = pxCurrentTCB->ulNotifiedValue[ uxIndexToWaitOn ];
 
 			if( ulReturn != 0UL )
 			{
 				if( xClearCountOnExit != pdFALSE )
 				{
-					pxCurrentTCB->ulNotifiedValue = 0UL;
+					pxCurrentTCB->ulNotifiedValue[ uxIndexToWaitOn ] = 0UL;
 				}
 				else
 				{
-					pxCurrentTCB->ulNotifiedValue = ulReturn - ( uint32_t ) 1;
+					pxCurrentTCB->ulNotifiedValue[ uxIndexToWaitOn ] = ulReturn - ( uint32_t ) 1;
 				}
 			}
 			else
@@ -4618,7 +5499,7 @@ TickType_t uxReturn;
 				mtCOVERAGE_TEST_MARKER();
 			}
 
-			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			pxCurrentTCB->ucNotifyState[ uxIndexToWaitOn ] = taskNOT_WAITING_NOTIFICATION;
 		}
 		taskEXIT_CRITICAL();
 
@@ -4630,22 +5511,34 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskNotifyWait( uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait )
+	uint32_t ulTaskNotifyTake( BaseType_t xClearCountOnExit, TickType_t xTicksToWait )
+	{
+		return ulTaskNotifyTakeIndexed( tskDEFAULT_INDEX_TO_NOTIFY, xClearCountOnExit, xTicksToWait );
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	BaseType_t xTaskNotifyWaitIndexed( UBaseType_t uxIndexToWaitOn, uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait )
 	{
 	BaseType_t xReturn;
 
+		configASSERT( uxIndexToWaitOn < configTASK_NOTIFICATION_ARRAY_ENTRIES );
+
 		taskENTER_CRITICAL();
 		{
 			/* Only block if a notification is not already pending. */
-			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			if( pxCurrentTCB->ucNotifyState[ uxIndexToWaitOn ] != taskNOTIFICATION_RECEIVED )
 			{
 				/* Clear bits in the task's notification value as bits may get
 				set	by the notifying task or interrupt.  This can be used to
 				clear the value to zero. */
-				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+				pxCurrentTCB->ulNotifiedValue[ uxIndexToWaitOn ] &= ~ulBitsToClearOnEntry;
 
 				/* Mark this task as waiting for a notification. */
-				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+				pxCurrentTCB->ucNotifyState[ uxIndexToWaitOn ] = taskWAITING_NOTIFICATION;
 
 				if( xTicksToWait > ( TickType_t ) 0 )
 				{
@@ -4678,14 +5571,14 @@ TickType_t uxReturn;
 			{
 				/* Output the current notification value, which may or may not
 				have changed. */
-				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+				*pulNotificationValue = pxCurrentTCB->ulNotifiedValue[ uxIndexToWaitOn ];
 			}
 
 			/* If ucNotifyValue is set then either the task never entered the
 			blocked state (because a notification was already pending) or the
 			task unblocked because of a notification.  Otherwise the task
 			unblocked because of a timeout. */
-			if( pxCurrentTCB->ucNotifyState != taskNOTIFICATION_RECEIVED )
+			if( pxCurrentTCB->ucNotifyState[ uxIndexToWaitOn ] != taskNOTIFICATION_RECEIVED )
 			{
 				/* A notification was not received. */
 				xReturn = pdFALSE;
@@ -4694,11 +5587,11 @@ TickType_t uxReturn;
 			{
 				/* A notification was already pending or a notification was
 				received while the task was waiting. */
-				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+				pxCurrentTCB->ulNotifiedValue[ uxIndexToWaitOn ] &= ~ulBitsToClearOnExit;
 				xReturn = pdTRUE;
 			}
 
-			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			pxCurrentTCB->ucNotifyState[ uxIndexToWaitOn ] = taskNOT_WAITING_NOTIFICATION;
 		}
 		taskEXIT_CRITICAL();
 
@@ -4710,44 +5603,112 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
+	BaseType_t xTaskNotifyWait( uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait )
+	{
+		return xTaskNotifyWaitIndexed( tskDEFAULT_INDEX_TO_NOTIFY, ulBitsToClearOnEntry, ulBitsToClearOnExit, pulNotificationValue, xTicksToWait );
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if( ( configUSE_TASK_NOTIFICATIONS == 1 ) && ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) )
+
+	BaseType_t xTaskNotifyWaitAny( UBaseType_t uxIndexMask, UBaseType_t *puxIndex, TickType_t xTicksToWait )
+	{
+	BaseType_t xReturn;
+
+		configASSERT( uxIndexMask != ( UBaseType_t ) 0 );
+		configASSERT( ( uxIndexMask & ~taskNOTIFICATION_INDEX_MASK ) == ( UBaseType_t ) 0 );
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if none of the notifications is already pending.
+			Every slot in the mask is marked as waiting, so a notification to
+			any of them unblocks the task. */
+			if( prvFindPendingNotification( pxCurrentTCB, uxIndexMask, puxIndex ) == pdFALSE )
+			{
+				prvSetNotifyWaiting( pxCurrentTCB, uxIndexMask );
+
+				if( xTicksToWait > ( TickType_t ) 0 )
+				{
+					prvAddCurrentTaskToDelayedList( xTicksToWait, pdTRUE );
+					traceTASK_NOTIFY_WAIT_BLOCK();
+
+					/* All ports are written to allow a yield in a critical
+					section (some will yield immediately, others wait until the
+					critical section exits) - but it is not something that
+					application code should ever do. */
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			/* The notification is left pending, to be consumed by a call for
+			its index.  Slots still marked as waiting after a timeout are
+			reset. */
+			xReturn = prvFindPendingNotification( pxCurrentTCB, uxIndexMask, puxIndex );
+			prvClearNotifyWaiting( pxCurrentTCB );
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* ( configUSE_TASK_NOTIFICATIONS == 1 ) && ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	BaseType_t xTaskGenericNotifyIndexed( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
 	{
 	TCB_t * pxTCB;
 	BaseType_t xReturn = pdPASS;
 	uint8_t ucOriginalNotifyState;
 
 		configASSERT( xTaskToNotify );
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 		pxTCB = xTaskToNotify;
 
 		taskENTER_CRITICAL();
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
-				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue[ uxIndexToNotify ];
 			}
 
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
 
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			switch( eAction )
 			{
 				case eSetBits	:
-					pxTCB->ulNotifiedValue |= ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] |= ulValue;
 					break;
 
 				case eIncrement	:
-					( pxTCB->ulNotifiedValue )++;
+					( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 					break;
 
 				case eSetValueWithOverwrite	:
-					pxTCB->ulNotifiedValue = ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					break;
 
 				case eSetValueWithoutOverwrite :
 					if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
 					{
-						pxTCB->ulNotifiedValue = ulValue;
+						pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					}
 					else
 					{
@@ -4765,7 +5726,7 @@ TickType_t uxReturn;
 					/* Should not get here if all enums are handled.
 					Artificially force an assert by testing a value the
 					compiler can't assume is const. */
-					configASSERT( pxTCB->ulNotifiedValue == ~0UL );
+					configASSERT( pxTCB->ulNotifiedValue[ uxIndexToNotify ] == ~0UL );
 
 					break;
 			}
@@ -4776,6 +5737,10 @@ TickType_t uxReturn;
 			notification then unblock it now. */
 			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
 			{
+				/* The task may be waiting on other slots too, which must not
+				try to unblock it again. */
+				prvClearNotifyWaiting( pxTCB );
+
 				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
 				prvAddTaskToReadyList( pxTCB );
 
@@ -4798,7 +5763,7 @@ TickType_t uxReturn;
 				}
 				#endif
 
-				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				if( taskPREEMPTS_RUNNING_TASK( pxTCB ) )
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
@@ -4824,7 +5789,17 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken )
+	BaseType_t xTaskGenericNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue )
+	{
+		return xTaskGenericNotifyIndexed( xTaskToNotify, tskDEFAULT_INDEX_TO_NOTIFY, ulValue, eAction, pulPreviousNotificationValue );
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	BaseType_t xTaskGenericNotifyIndexedFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken )
 	{
 	TCB_t * pxTCB;
 	uint8_t ucOriginalNotifyState;
@@ -4832,6 +5807,7 @@ TickType_t uxReturn;
 	UBaseType_t uxSavedInterruptStatus;
 
 		configASSERT( xTaskToNotify );
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 
 		/* RTOS ports that support interrupt nesting have the concept of a
 		maximum	system call (or maximum API call) interrupt priority.
@@ -4853,34 +5829,34 @@ TickType_t uxReturn;
 
 		pxTCB = xTaskToNotify;
 
-		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 		{
 			if( pulPreviousNotificationValue != NULL )
 			{
-				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+				*pulPreviousNotificationValue = pxTCB->ulNotifiedValue[ uxIndexToNotify ];
 			}
 
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			switch( eAction )
 			{
 				case eSetBits	:
-					pxTCB->ulNotifiedValue |= ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] |= ulValue;
 					break;
 
 				case eIncrement	:
-					( pxTCB->ulNotifiedValue )++;
+					( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 					break;
 
 				case eSetValueWithOverwrite	:
-					pxTCB->ulNotifiedValue = ulValue;
+					pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					break;
 
 				case eSetValueWithoutOverwrite :
 					if( ucOriginalNotifyState != taskNOTIFICATION_RECEIVED )
 					{
-						pxTCB->ulNotifiedValue = ulValue;
+						pxTCB->ulNotifiedValue[ uxIndexToNotify ] = ulValue;
 					}
 					else
 					{
@@ -4898,7 +5874,7 @@ TickType_t uxReturn;
 					/* Should not get here if all enums are handled.
 					Artificially force an assert by testing a value the
 					compiler can't assume is const. */
-					configASSERT( pxTCB->ulNotifiedValue == ~0UL );
+					configASSERT( pxTCB->ulNotifiedValue[ uxIndexToNotify ] == ~0UL );
 					break;
 			}
 
@@ -4908,6 +5884,10 @@ TickType_t uxReturn;
 			notification then unblock it now. */
 			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
 			{
+				/* The task may be waiting on other slots too, which must not
+				try to unblock it again. */
+				prvClearNotifyWaiting( pxTCB );
+
 				/* The task should not have been on an event list. */
 				configASSERT( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) == NULL );
 
@@ -4923,7 +5903,7 @@ TickType_t uxReturn;
 					vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
 				}
 
-				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				if( taskPREEMPTS_RUNNING_TASK( pxTCB ) )
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
@@ -4943,7 +5923,7 @@ TickType_t uxReturn;
 				}
 			}
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 
 		return xReturn;
 	}
@@ -4953,13 +5933,24 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+	BaseType_t xTaskGenericNotifyFromISR( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction, uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken )
+	{
+		return xTaskGenericNotifyIndexedFromISR( xTaskToNotify, tskDEFAULT_INDEX_TO_NOTIFY, ulValue, eAction, pulPreviousNotificationValue, pxHigherPriorityTaskWoken );
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	void vTaskNotifyGiveIndexedFromISR( TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, BaseType_t *pxHigherPriorityTaskWoken )
 	{
 	TCB_t * pxTCB;
 	uint8_t ucOriginalNotifyState;
 	UBaseType_t uxSavedInterruptStatus;
 
 		configASSERT( xTaskToNotify );
+		configASSERT( uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 
 		/* RTOS ports that support interrupt nesting have the concept of a
 		maximum	system call (or maximum API call) interrupt priority.
@@ -4981,14 +5972,14 @@ TickType_t uxReturn;
 
 		pxTCB = xTaskToNotify;
 
-		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 		{
-			ucOriginalNotifyState = pxTCB->ucNotifyState;
-			pxTCB->ucNotifyState = taskNOTIFICATION_RECEIVED;
+			ucOriginalNotifyState = pxTCB->ucNotifyState[ uxIndexToNotify ];
+			pxTCB->ucNotifyState[ uxIndexToNotify ] = taskNOTIFICATION_RECEIVED;
 
 			/* 'Giving' is equivalent to incrementing a count in a counting
 			semaphore. */
-			( pxTCB->ulNotifiedValue )++;
+			( pxTCB->ulNotifiedValue[ uxIndexToNotify ] )++;
 
 			traceTASK_NOTIFY_GIVE_FROM_ISR();
 
@@ -4996,6 +5987,10 @@ TickType_t uxReturn;
 			notification then unblock it now. */
 			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
 			{
+				/* The task may be waiting on other slots too, which must not
+				try to unblock it again. */
+				prvClearNotifyWaiting( pxTCB );
+
 				/* The task should not have been on an event list. */
 				configASSERT( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) == NULL );
 
@@ -5011,7 +6006,7 @@ TickType_t uxReturn;
 					vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
 				}
 
-				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				if( taskPREEMPTS_RUNNING_TASK( pxTCB ) )
 				{
 					/* The notified task has a priority above the currently
 					executing task so a yield is required. */
@@ -5031,7 +6026,7 @@ TickType_t uxReturn;
 				}
 			}
 		}
-		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+		taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
 	}
 
 #endif /* configUSE_TASK_NOTIFICATIONS */
@@ -5040,20 +6035,31 @@ TickType_t uxReturn;
 
 #if( configUSE_TASK_NOTIFICATIONS == 1 )
 
-	BaseType_t xTaskNotifyStateClear( TaskHandle_t xTask )
+	void vTaskNotifyGiveFromISR( TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken )
+	{
+		vTaskNotifyGiveIndexedFromISR( xTaskToNotify, tskDEFAULT_INDEX_TO_NOTIFY, pxHigherPriorityTaskWoken );
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	BaseType_t xTaskNotifyStateClearIndexed( TaskHandle_t xTask, UBaseType_t uxIndexToClear )
 	{
 	TCB_t *pxTCB;
 	BaseType_t xReturn;
 
 		/* If null is passed in here then it is the calling task that is having
 		its notification state cleared. */
+		configASSERT( uxIndexToClear < configTASK_NOTIFICATION_ARRAY_ENTRIES );
 		pxTCB = prvGetTCBFromHandle( xTask );
 
 		taskENTER_CRITICAL();
 		{
-			if( pxTCB->ucNotifyState == taskNOTIFICATION_RECEIVED )
+			if( pxTCB->ucNotifyState[ uxIndexToClear ] == taskNOTIFICATION_RECEIVED )
 			{
-				pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+				pxTCB->ucNotifyState[ uxIndexToClear ] = taskNOT_WAITING_NOTIFICATION;
 				xReturn = pdPASS;
 			}
 			else
@@ -5069,6 +6075,16 @@ TickType_t uxReturn;
 #endif /* configUSE_TASK_NOTIFICATIONS */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	BaseType_t xTaskNotifyStateClear( TaskHandle_t xTask )
+	{
+		return xTaskNotifyStateClearIndexed( xTask, tskDEFAULT_INDEX_TO_NOTIFY );
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
+
 #if( ( configGENERATE_RUN_TIME_STATS == 1 ) && ( INCLUDE_xTaskGetIdleTaskHandle == 1 ) )
 	TickType_t xTaskGetIdleRunTimeCounter( void )
 	{
@@ -69,6 +69,32 @@ defining trmTIMER_SERVICE_TASK_NAME in FreeRTOSConfig.h. */
 #define tmrSTATUS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 0x02 )
 #define tmrSTATUS_IS_AUTORELOAD				( ( uint8_t ) 0x04 )
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/* Level 0 of the timer wheel has a slot per tick, level 1 a slot per
+	configTIMER_WHEEL_SLOTS ticks.  The slot of a timer is selected by the
+	bits of its expiry time that belong to the level. */
+	#define tmrWHEEL_LEVELS					( 2 )
+	#define tmrWHEEL_SLOTS					( ( TickType_t ) configTIMER_WHEEL_SLOTS )
+	#define tmrWHEEL_MASK					( tmrWHEEL_SLOTS - ( TickType_t ) 1 )
+	#define tmrWHEEL_LEVEL_0_SLOT( xTime )	( ( UBaseType_t ) ( ( xTime ) & tmrWHEEL_MASK ) )
+	#define tmrWHEEL_LEVEL_1_SLOT( xTime )	( ( UBaseType_t ) ( ( ( xTime ) / tmrWHEEL_SLOTS ) & tmrWHEEL_MASK ) )
+
+	/* Commands sent by the timer service task to itself, for example from a
+	timer callback, can be applied without going through the timer queue.
+	This needs xTaskGetCurrentTaskHandle(), and is only done with the timer
+	wheel as the timer lists cannot be modified while they are being
+	switched. */
+	#if( ( INCLUDE_xTaskGetCurrentTaskHandle == 1 ) || ( configUSE_MUTEXES == 1 ) )
+		#define tmrDIRECT_COMMANDS			1
+	#endif
+
+#endif /* configUSE_TIMER_WHEEL */
+
+#ifndef tmrDIRECT_COMMANDS
+	#define tmrDIRECT_COMMANDS				0
+#endif
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl /* The old naming convention is used to prevent breaking kernel aware debuggers. */
 {
@@ -132,10 +158,33 @@ timer service task is allowed to access these lists.
 xActiveTimerList1 and xActiveTimerList2 could be at function scope but that
 breaks some kernel aware debuggers, and debuggers that reply on removing the
 static qualifier. */
-PRIVILEGED_DATA static List_t xActiveTimerList1;
-PRIVILEGED_DATA static List_t xActiveTimerList2;
-PRIVILEGED_DATA static List_t *pxCurrentTimerList;
-PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+#if( configUSE_TIMER_WHEEL == 0 )
+
+	PRIVILEGED_DATA static List_t xActiveTimerList1;
+	PRIVILEGED_DATA static List_t xActiveTimerList2;
+	PRIVILEGED_DATA static List_t *pxCurrentTimerList;
+	PRIVILEGED_DATA static List_t *pxOverflowTimerList;
+
+#else
+
+	/* When configUSE_TIMER_WHEEL is 1 the active timers are instead held in a
+	two level timer wheel, so starting and stopping a timer is O(1) however
+	many timers are active.  Level 0 holds the timers that expire less than
+	configTIMER_WHEEL_SLOTS ticks after xWheelTime, each in the slot for its
+	expiry tick.  Level 1 holds all other timers, each in the slot for the
+	block of configTIMER_WHEEL_SLOTS ticks it expires in.  When xWheelTime
+	reaches the start of a block the timers in its level 1 slot move down to
+	level 0, except those a whole level 1 revolution or more further away,
+	which stay for a later revolution.  The wheel is indexed by the low bits of
+	the tick count, so nothing needs to be done when the tick count
+	overflows. */
+	PRIVILEGED_DATA static List_t xTimerWheel[ tmrWHEEL_LEVELS ][ configTIMER_WHEEL_SLOTS ];
+	PRIVILEGED_DATA static UBaseType_t uxTimersInWheel[ tmrWHEEL_LEVELS ] = { 0U };
+
+	/* Every timer that expires at or before xWheelTime has been processed. */
+	PRIVILEGED_DATA static TickType_t xWheelTime = ( TickType_t ) 0U;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
@@ -175,22 +224,76 @@ static portTASK_FUNCTION_PROTO( prvTimerTask, pvParameters ) PRIVILEGED_FUNCTION
 static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
 /*
- * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * Apply a start, reset, stop, change period or delete command to the timer it
+ * references.  Called by the timer service task only.
  */
-static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
+static void prvProcessTimerCommand( const DaemonTaskMessage_t * const pxMessage ) PRIVILEGED_FUNCTION;
 
 /*
- * An active timer has reached its expire time.  Reload the timer if it is an
- * auto reload timer, then call its callback.
+ * Remove the timer from the active timer list or timer wheel slot that
+ * references it.
  */
-static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+#if( tmrDIRECT_COMMANDS == 1 )
+
+	/*
+	 * Returns pdTRUE if the command can be applied by the calling task rather
+	 * than being sent to the timer service task.
+	 */
+	static BaseType_t prvIsDirectCommand( const BaseType_t xCommandID ) PRIVILEGED_FUNCTION;
+
+#endif
 
 /*
- * The tick count has overflowed.  Switch the timer lists after ensuring the
- * current timer list does not still reference some timers.
+ * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
+ * depending on if the expire time causes a timer counter overflow.  When the
+ * timer wheel is used, insert the timer into its slot of the wheel instead.
  */
-static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_TIMER_WHEEL == 0 )
+
+	/*
+	 * An active timer has reached its expire time.  Reload the timer if it is
+	 * an auto reload timer, then call its callback.
+	 */
+	static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The tick count has overflowed.  Switch the timer lists after ensuring
+	 * the current timer list does not still reference some timers.
+	 */
+	static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
+
+#else
+
+	/*
+	 * Insert the timer into the timer wheel slot for the expiry time held in
+	 * its list item.
+	 */
+	static void prvInsertTimerInWheel( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Move xWheelTime forward to xTimeNow, moving timers from level 1 to level
+	 * 0 and processing the timers that expire on the way.
+	 */
+	static void prvAdvanceTimerWheel( const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * xWheelTime has reached the start of a level 1 slot.  Move the timers in
+	 * the slot that expire within the next configTIMER_WHEEL_SLOTS ticks down
+	 * to level 0.
+	 */
+	static void prvCascadeTimerWheel( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Reload or deactivate, then call the callback of, every timer in the level
+	 * 0 slot for xWheelTime.
+	 */
+	static void prvProcessExpiredTimers( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
@@ -202,7 +305,8 @@ static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched
  * If the timer list contains any active timers then return the expire time of
  * the timer that will expire first and set *pxListWasEmpty to false.  If the
  * timer list does not contain any timers then return 0 and set *pxListWasEmpty
- * to pdTRUE.
+ * to pdTRUE.  When the timer wheel is used the time returned can instead be
+ * the time at which the next non-empty level 1 slot moves down to level 0.
  */
 static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty ) PRIVILEGED_FUNCTION;
 
@@ -381,6 +485,7 @@ static void prvInitialiseNewTimer(	const char * const pcTimerName,			/*lint !e97
 BaseType_t xTimerGenericCommand( TimerHandle_t xTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue, BaseType_t * const pxHigherPriorityTaskWoken, const TickType_t xTicksToWait )
 {
 BaseType_t xReturn = pdFAIL;
+BaseType_t xApplyDirectly = pdFALSE;
 DaemonTaskMessage_t xMessage;
 
 	configASSERT( xTimer );
@@ -394,7 +499,20 @@ DaemonTaskMessage_t xMessage;
 		xMessage.u.xTimerParameters.xMessageValue = xOptionalValue;
 		xMessage.u.xTimerParameters.pxTimer = xTimer;
 
-		if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
+		#if( tmrDIRECT_COMMANDS == 1 )
+		{
+			xApplyDirectly = prvIsDirectCommand( xCommandID );
+		}
+		#endif
+
+		if( xApplyDirectly != pdFALSE )
+		{
+			/* The timer service task is the caller, so apply the command now
+			instead of sending it to itself. */
+			prvProcessTimerCommand( &xMessage );
+			xReturn = pdPASS;
+		}
+		else if( xCommandID < tmrFIRST_FROM_ISR_COMMAND )
 		{
 			if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
 			{
@@ -421,6 +539,39 @@ DaemonTaskMessage_t xMessage;
 }
 /*-----------------------------------------------------------*/
 
+#if( tmrDIRECT_COMMANDS == 1 )
+
+	static BaseType_t prvIsDirectCommand( const BaseType_t xCommandID )
+	{
+	BaseType_t xReturn = pdFALSE;
+
+		/* A command sent from a timer callback, or from a function pended to
+		the timer service task, would otherwise be copied into the timer queue
+		and only read back once the callback returns.  Applying it directly only
+		keeps commands in order if no earlier commands are still in the queue.
+		Deleting is always queued so a callback can delete its own timer, and
+		the reload commands the timer service task sends itself are queued so
+		a timer that has missed many periods is not reloaded recursively. */
+		if( ( xCommandID < tmrFIRST_FROM_ISR_COMMAND ) &&
+			( xCommandID != tmrCOMMAND_DELETE ) &&
+			( xCommandID != tmrCOMMAND_START_DONT_TRACE ) &&
+			( xTimerTaskHandle != NULL ) &&
+			( xTaskGetCurrentTaskHandle() == xTimerTaskHandle ) &&
+			( uxQueueMessagesWaiting( xTimerQueue ) == ( UBaseType_t ) 0 ) )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* tmrDIRECT_COMMANDS */
+/*-----------------------------------------------------------*/
+
 TaskHandle_t xTimerGetTimerDaemonTaskHandle( void )
 {
 	/* If xTimerGetTimerDaemonTaskHandle() is called before the scheduler has been
@@ -479,6 +630,8 @@ Timer_t *pxTimer = xTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
 {
 BaseType_t xResult;
@@ -518,6 +671,145 @@ Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTi
 	/* Call the timer callback. */
 	pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
 }
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvInsertTimerInWheel( Timer_t * const pxTimer )
+	{
+	const TickType_t xExpiryTime = listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) );
+	const TickType_t xTicksAway = xExpiryTime - xWheelTime;
+
+		/* A timer due at xWheelTime would never be processed. */
+		configASSERT( xTicksAway != ( TickType_t ) 0 );
+
+		if( xTicksAway < tmrWHEEL_SLOTS )
+		{
+			vListInsertEnd( &( xTimerWheel[ 0 ][ tmrWHEEL_LEVEL_0_SLOT( xExpiryTime ) ] ), &( pxTimer->xTimerListItem ) );
+			( uxTimersInWheel[ 0 ] )++;
+		}
+		else
+		{
+			vListInsertEnd( &( xTimerWheel[ 1 ][ tmrWHEEL_LEVEL_1_SLOT( xExpiryTime ) ] ), &( pxTimer->xTimerListItem ) );
+			( uxTimersInWheel[ 1 ] )++;
+		}
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvAdvanceTimerWheel( const TickType_t xTimeNow )
+	{
+	TickType_t xNextExpireTime;
+	BaseType_t xWheelWasEmpty;
+
+		for( ;; )
+		{
+			/* Jump straight to the next time at which there is something to
+			do, rather than stepping through every tick. */
+			xNextExpireTime = prvGetNextExpireTime( &xWheelWasEmpty );
+
+			if( ( xWheelWasEmpty != pdFALSE ) || ( ( TickType_t ) ( xTimeNow - xWheelTime ) < ( TickType_t ) ( xNextExpireTime - xWheelTime ) ) )
+			{
+				/* Nothing else is due by xTimeNow. */
+				xWheelTime = xTimeNow;
+				break;
+			}
+
+			xWheelTime = xNextExpireTime;
+
+			if( tmrWHEEL_LEVEL_0_SLOT( xWheelTime ) == ( UBaseType_t ) 0 )
+			{
+				prvCascadeTimerWheel();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			prvProcessExpiredTimers();
+		}
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvCascadeTimerWheel( void )
+	{
+	List_t * const pxSlot = &( xTimerWheel[ 1 ][ tmrWHEEL_LEVEL_1_SLOT( xWheelTime ) ] );
+	ListItem_t const * const pxEnd = listGET_END_MARKER( pxSlot );
+	ListItem_t *pxItem, *pxNextItem;
+	TickType_t xExpiryTime;
+
+		pxItem = listGET_HEAD_ENTRY( pxSlot );
+
+		while( pxItem != pxEnd )
+		{
+			pxNextItem = listGET_NEXT( pxItem );
+			xExpiryTime = listGET_LIST_ITEM_VALUE( pxItem );
+
+			if( ( TickType_t ) ( xExpiryTime - xWheelTime ) < tmrWHEEL_SLOTS )
+			{
+				( void ) uxListRemove( pxItem );
+				( uxTimersInWheel[ 1 ] )--;
+				vListInsertEnd( &( xTimerWheel[ 0 ][ tmrWHEEL_LEVEL_0_SLOT( xExpiryTime ) ] ), pxItem );
+				( uxTimersInWheel[ 0 ] )++;
+			}
+			else
+			{
+				/* Due in a later revolution of level 1. */
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxItem = pxNextItem;
+		}
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvProcessExpiredTimers( void )
+	{
+	List_t * const pxSlot = &( xTimerWheel[ 0 ][ tmrWHEEL_LEVEL_0_SLOT( xWheelTime ) ] );
+	Timer_t *pxTimer;
+
+		/* Every timer in the slot expires now.  The slot is re-read after each
+		callback as a callback can stop other timers. */
+		while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+		{
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			configASSERT( listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) == xWheelTime );
+
+			prvRemoveTimerFromActiveList( pxTimer );
+			traceTIMER_EXPIRED( pxTimer );
+
+			if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+			{
+				/* The next expiry time is relative to this one, not to the
+				current time.  If it has already passed it is processed before
+				prvAdvanceTimerWheel() returns. */
+				listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), ( xWheelTime + pxTimer->xTimerPeriodInTicks ) );
+				prvInsertTimerInWheel( pxTimer );
+			}
+			else
+			{
+				pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+			}
+
+			/* Call the timer callback. */
+			pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+		}
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static portTASK_FUNCTION( prvTimerTask, pvParameters )
@@ -561,6 +853,42 @@ static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseTy
 TickType_t xTimeNow;
 BaseType_t xTimerListsWereSwitched;
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	vTaskSuspendAll();
+	{
+		xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+
+		/* Has the next expire time been reached?  The times are compared
+		relative to xWheelTime, which makes the comparison immune to the tick
+		count overflowing. */
+		if( ( xListWasEmpty == pdFALSE ) && ( ( TickType_t ) ( xTimeNow - xWheelTime ) >= ( TickType_t ) ( xNextExpireTime - xWheelTime ) ) )
+		{
+			( void ) xTaskResumeAll();
+			prvAdvanceTimerWheel( xTimeNow );
+		}
+		else
+		{
+			/* Block to wait for the next expire time or a command to be
+			received - whichever comes first.  If the wheel is empty the task
+			waits indefinitely for a command. */
+			vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+
+			if( xTaskResumeAll() == pdFALSE )
+			{
+				/* Yield to wait for either a command to arrive, or the block
+				time to expire. */
+				portYIELD_WITHIN_API();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+
+#else
+
 	vTaskSuspendAll();
 	{
 		/* Obtain the time now to make an assessment as to whether the timer
@@ -613,6 +941,8 @@ BaseType_t xTimerListsWereSwitched;
 			( void ) xTaskResumeAll();
 		}
 	}
+
+#endif /* configUSE_TIMER_WHEEL */
 }
 /*-----------------------------------------------------------*/
 
@@ -620,6 +950,71 @@ static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
 {
 TickType_t xNextExpireTime;
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+TickType_t xTicksToNext = portMAX_DELAY, xTicksToSlot;
+UBaseType_t uxSlot;
+
+	*pxListWasEmpty = ( ( uxTimersInWheel[ 0 ] + uxTimersInWheel[ 1 ] ) == ( UBaseType_t ) 0 ) ? pdTRUE : pdFALSE;
+
+	if( *pxListWasEmpty == pdFALSE )
+	{
+		/* The first non-empty level 0 slot after xWheelTime holds the timers
+		that expire first. */
+		if( uxTimersInWheel[ 0 ] != ( UBaseType_t ) 0 )
+		{
+			for( xTicksToSlot = ( TickType_t ) 1; xTicksToSlot < tmrWHEEL_SLOTS; xTicksToSlot++ )
+			{
+				if( listLIST_IS_EMPTY( &( xTimerWheel[ 0 ][ tmrWHEEL_LEVEL_0_SLOT( xWheelTime + xTicksToSlot ) ] ) ) == pdFALSE )
+				{
+					xTicksToNext = xTicksToSlot;
+					break;
+				}
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Unless the timers in a level 1 slot have to move down to level 0
+		before then. */
+		if( uxTimersInWheel[ 1 ] != ( UBaseType_t ) 0 )
+		{
+			for( uxSlot = ( UBaseType_t ) 1; uxSlot <= ( UBaseType_t ) configTIMER_WHEEL_SLOTS; uxSlot++ )
+			{
+				xTicksToSlot = ( ( xWheelTime & ~tmrWHEEL_MASK ) + ( ( TickType_t ) uxSlot * tmrWHEEL_SLOTS ) ) - xWheelTime;
+
+				if( xTicksToSlot >= xTicksToNext )
+				{
+					break;
+				}
+				else if( listLIST_IS_EMPTY( &( xTimerWheel[ 1 ][ tmrWHEEL_LEVEL_1_SLOT( xWheelTime + xTicksToSlot ) ] ) ) == pdFALSE )
+				{
+					xTicksToNext = xTicksToSlot;
+					break;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xNextExpireTime = xWheelTime + xTicksToNext;
+	}
+	else
+	{
+		/* Ensure the task blocks until a command is received. */
+		xNextExpireTime = ( TickType_t ) 0U;
+	}
+
+#else
+
 	/* Timers are listed in expiry time order, with the head of the list
 	referencing the task that will expire first.  Obtain the time at which
 	the timer with the nearest expiry time will expire.  If there are no
@@ -638,6 +1033,8 @@ TickType_t xNextExpireTime;
 		xNextExpireTime = ( TickType_t ) 0U;
 	}
 
+#endif /* configUSE_TIMER_WHEEL */
+
 	return xNextExpireTime;
 }
 /*-----------------------------------------------------------*/
@@ -645,21 +1042,32 @@ TickType_t xNextExpireTime;
 static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
 {
 TickType_t xTimeNow;
-PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Variable is only accessible to one task. */
 
 	xTimeNow = xTaskGetTickCount();
 
-	if( xTimeNow < xLastTime )
-	{
-		prvSwitchTimerLists();
-		*pxTimerListsWereSwitched = pdTRUE;
-	}
-	else
+	#if( configUSE_TIMER_WHEEL == 1 )
 	{
+		/* The timer wheel does not need to do anything when the tick count
+		overflows. */
 		*pxTimerListsWereSwitched = pdFALSE;
 	}
+	#else
+	{
+	PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Variable is only accessible to one task. */
 
-	xLastTime = xTimeNow;
+		if( xTimeNow < xLastTime )
+		{
+			prvSwitchTimerLists();
+			*pxTimerListsWereSwitched = pdTRUE;
+		}
+		else
+		{
+			*pxTimerListsWereSwitched = pdFALSE;
+		}
+
+		xLastTime = xTimeNow;
+	}
+	#endif /* configUSE_TIMER_WHEEL */
 
 	return xTimeNow;
 }
@@ -672,6 +1080,34 @@ BaseType_t xProcessTimerNow = pdFALSE;
 	listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
 	listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/* Has the expiry time elapsed between the command to start/reset a timer
+	was issued, and the time the command was processed?  Computing the elapsed
+	time as a difference is correct even if the tick count overflowed in
+	between. */
+	if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks )
+	{
+		xProcessTimerNow = pdTRUE;
+	}
+	else
+	{
+		if( ( uxTimersInWheel[ 0 ] + uxTimersInWheel[ 1 ] ) == ( UBaseType_t ) 0 )
+		{
+			/* xWheelTime is only advanced while timers are active, so catch
+			up before inserting into an empty wheel. */
+			xWheelTime = xTimeNow;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		prvInsertTimerInWheel( pxTimer );
+	}
+
+#else
+
 	if( xNextExpiryTime <= xTimeNow )
 	{
 		/* Has the expiry time elapsed between the command to start/reset a
@@ -702,16 +1138,35 @@ BaseType_t xProcessTimerNow = pdFALSE;
 		}
 	}
 
+#endif /* configUSE_TIMER_WHEEL */
+
 	return xProcessTimerNow;
 }
 /*-----------------------------------------------------------*/
 
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer )
+{
+	#if( configUSE_TIMER_WHEEL == 1 )
+	{
+		/* Keep count of the timers in each level. */
+		if( listLIST_ITEM_CONTAINER( &( pxTimer->xTimerListItem ) ) >= &( xTimerWheel[ 1 ][ 0 ] ) )
+		{
+			( uxTimersInWheel[ 1 ] )--;
+		}
+		else
+		{
+			( uxTimersInWheel[ 0 ] )--;
+		}
+	}
+	#endif /* configUSE_TIMER_WHEEL */
+
+	( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+}
+/*-----------------------------------------------------------*/
+
 static void	prvProcessReceivedCommands( void )
 {
 DaemonTaskMessage_t xMessage;
-Timer_t *pxTimer;
-BaseType_t xTimerListsWereSwitched, xResult;
-TickType_t xTimeNow;
 
 	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL ) /*lint !e603 xMessage does not have to be initialised as it is passed out, not in, and it is not used unless xQueueReceive() returns pdTRUE. */
 	{
@@ -741,119 +1196,131 @@ TickType_t xTimeNow;
 		function calls. */
 		if( xMessage.xMessageID >= ( BaseType_t ) 0 )
 		{
-			/* The messages uses the xTimerParameters member to work on a
-			software timer. */
-			pxTimer = xMessage.u.xTimerParameters.pxTimer;
+			prvProcessTimerCommand( &xMessage );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessTimerCommand( const DaemonTaskMessage_t * const pxMessage )
+{
+Timer_t *pxTimer;
+BaseType_t xTimerListsWereSwitched, xResult;
+TickType_t xTimeNow;
+
+	/* The messages uses the xTimerParameters member to work on a
+	software timer. */
+	pxTimer = pxMessage->u.xTimerParameters.pxTimer;
+
+	if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+	{
+		/* The timer is in a list, remove it. */
+		prvRemoveTimerFromActiveList( pxTimer );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+	traceTIMER_COMMAND_RECEIVED( pxTimer, pxMessage->xMessageID, pxMessage->u.xTimerParameters.xMessageValue );
+
+	/* In this case the xTimerListsWereSwitched parameter is not used, but
+	it must be present in the function call.  prvSampleTimeNow() must be
+	called after the message is received from xTimerQueue so there is no
+	possibility of a higher priority task adding a message to the message
+	queue with a time that is ahead of the timer daemon task (because it
+	pre-empted the timer daemon task after the xTimeNow value was set). */
+	xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+
+	switch( pxMessage->xMessageID )
+	{
+		case tmrCOMMAND_START :
+		case tmrCOMMAND_START_FROM_ISR :
+		case tmrCOMMAND_RESET :
+		case tmrCOMMAND_RESET_FROM_ISR :
+		case tmrCOMMAND_START_DONT_TRACE :
+			/* Start or restart a timer. */
+			pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
+			if( prvInsertTimerInActiveList( pxTimer,  pxMessage->u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, pxMessage->u.xTimerParameters.xMessageValue ) != pdFALSE )
 			{
-				/* The timer is in a list, remove it. */
-				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+				/* The timer expired before it was added to the active
+				timer list.  Process it now. */
+				pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
+				traceTIMER_EXPIRED( pxTimer );
+
+				if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
+				{
+					xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, pxMessage->u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
+					configASSERT( xResult );
+					( void ) xResult;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			}
 			else
 			{
 				mtCOVERAGE_TEST_MARKER();
 			}
-
-			traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
-
-			/* In this case the xTimerListsWereSwitched parameter is not used, but
-			it must be present in the function call.  prvSampleTimeNow() must be
-			called after the message is received from xTimerQueue so there is no
-			possibility of a higher priority task adding a message to the message
-			queue with a time that is ahead of the timer daemon task (because it
-			pre-empted the timer daemon task after the xTimeNow value was set). */
-			xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
-
-			switch( xMessage.xMessageID )
+			break;
+
+		case tmrCOMMAND_STOP :
+		case tmrCOMMAND_STOP_FROM_ISR :
+			/* The timer has already been removed from the active list. */
+			pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+			break;
+
+		case tmrCOMMAND_CHANGE_PERIOD :
+		case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
+			pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
+			pxTimer->xTimerPeriodInTicks = pxMessage->u.xTimerParameters.xMessageValue;
+			configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
+
+			/* The new period does not really have a reference, and can
+			be longer or shorter than the old one.  The command time is
+			therefore set to the current time, and as the period cannot
+			be zero the next expiry time can only be in the future,
+			meaning (unlike for the xTimerStart() case above) there is
+			no fail case that needs to be handled here. */
+			( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
+			break;
+
+		case tmrCOMMAND_DELETE :
+			#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 			{
-				case tmrCOMMAND_START :
-				case tmrCOMMAND_START_FROM_ISR :
-				case tmrCOMMAND_RESET :
-				case tmrCOMMAND_RESET_FROM_ISR :
-				case tmrCOMMAND_START_DONT_TRACE :
-					/* Start or restart a timer. */
-					pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
-					if( prvInsertTimerInActiveList( pxTimer,  xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, xTimeNow, xMessage.u.xTimerParameters.xMessageValue ) != pdFALSE )
-					{
-						/* The timer expired before it was added to the active
-						timer list.  Process it now. */
-						pxTimer->pxCallbackFunction( ( TimerHandle_t ) pxTimer );
-						traceTIMER_EXPIRED( pxTimer );
-
-						if( ( pxTimer->ucStatus & tmrSTATUS_IS_AUTORELOAD ) != 0 )
-						{
-							xResult = xTimerGenericCommand( pxTimer, tmrCOMMAND_START_DONT_TRACE, xMessage.u.xTimerParameters.xMessageValue + pxTimer->xTimerPeriodInTicks, NULL, tmrNO_DELAY );
-							configASSERT( xResult );
-							( void ) xResult;
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
-					}
-					else
-					{
-						mtCOVERAGE_TEST_MARKER();
-					}
-					break;
-
-				case tmrCOMMAND_STOP :
-				case tmrCOMMAND_STOP_FROM_ISR :
-					/* The timer has already been removed from the active list. */
+				/* The timer has already been removed from the active list,
+				just free up the memory if the memory was dynamically
+				allocated. */
+				if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+				{
+					vPortFree( pxTimer );
+				}
+				else
+				{
 					pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-					break;
-
-				case tmrCOMMAND_CHANGE_PERIOD :
-				case tmrCOMMAND_CHANGE_PERIOD_FROM_ISR :
-					pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
-					pxTimer->xTimerPeriodInTicks = xMessage.u.xTimerParameters.xMessageValue;
-					configASSERT( ( pxTimer->xTimerPeriodInTicks > 0 ) );
-
-					/* The new period does not really have a reference, and can
-					be longer or shorter than the old one.  The command time is
-					therefore set to the current time, and as the period cannot
-					be zero the next expiry time can only be in the future,
-					meaning (unlike for the xTimerStart() case above) there is
-					no fail case that needs to be handled here. */
-					( void ) prvInsertTimerInActiveList( pxTimer, ( xTimeNow + pxTimer->xTimerPeriodInTicks ), xTimeNow, xTimeNow );
-					break;
-
-				case tmrCOMMAND_DELETE :
-					#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
-					{
-						/* The timer has already been removed from the active list,
-						just free up the memory if the memory was dynamically
-						allocated. */
-						if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
-						{
-							vPortFree( pxTimer );
-						}
-						else
-						{
-							pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-						}
-					}
-					#else
-					{
-						/* If dynamic allocation is not enabled, the memory
-						could not have been dynamically allocated. So there is
-						no need to free the memory - just mark the timer as
-						"not active". */
-						pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
-					}
-					#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
-					break;
-
-				default	:
-					/* Don't expect to get here. */
-					break;
+				}
 			}
-		}
+			#else
+			{
+				/* If dynamic allocation is not enabled, the memory
+				could not have been dynamically allocated. So there is
+				no need to free the memory - just mark the timer as
+				"not active". */
+				pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+			}
+			#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+			break;
+
+		default	:
+			/* Don't expect to get here. */
+			break;
 	}
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvSwitchTimerLists( void )
 {
 TickType_t xNextExpireTime, xReloadTime;
@@ -911,6 +1378,8 @@ BaseType_t xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
@@ -922,10 +1391,28 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if( configUSE_TIMER_WHEEL == 1 )
+			{
+			UBaseType_t uxLevel, uxSlot;
+
+				for( uxLevel = ( UBaseType_t ) 0; uxLevel < ( UBaseType_t ) tmrWHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = ( UBaseType_t ) 0; uxSlot < ( UBaseType_t ) configTIMER_WHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+				}
+
+				xWheelTime = xTaskGetTickCount();
+			}
+			#else
+			{
+				vListInitialiseIndexed( &xActiveTimerList1 );
+				vListInitialiseIndexed( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#endif /* configUSE_TIMER_WHEEL */
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
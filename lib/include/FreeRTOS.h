@@ -108,6 +108,14 @@ extern "C" {
 	#define configUSE_CO_ROUTINES 0
 #endif
 
+#ifndef configNUMBER_OF_CORES
+	#define configNUMBER_OF_CORES 1
+#endif
+
+#if configNUMBER_OF_CORES < 1
+	#error configNUMBER_OF_CORES must be defined to be greater than or equal to 1.
+#endif
+
 #ifndef INCLUDE_vTaskPrioritySet
 	#define INCLUDE_vTaskPrioritySet 0
 #endif
@@ -222,6 +230,18 @@ extern "C" {
 	#define portCRITICAL_NESTING_IN_TCB 0
 #endif
 
+#ifndef portMEMORY_BARRIER
+	/* Orders memory accesses made by the calling core, for structures such as
+	stream buffers that are accessed without a critical section.  A compiler
+	barrier is enough on ports that only run code on one core at a time, so
+	that is the default for GCC compatible compilers.  Ports that can run code
+	on more than one core at a time, or that are built with other compilers,
+	must define this. */
+	#if defined( __GNUC__ )
+		#define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
+	#endif
+#endif
+
 #ifndef configMAX_TASK_NAME_LEN
 	#define configMAX_TASK_NAME_LEN 16
 #endif
@@ -592,6 +612,13 @@ extern "C" {
 	#define traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet )
 #endif
 
+#ifndef traceEVENT_GROUP_SET_BITS_END
+	/* Called by xEventGroupSetBits() before it resumes the scheduler, so with
+	traceEVENT_GROUP_SET_BITS() it brackets the part that runs with the
+	scheduler suspended. */
+	#define traceEVENT_GROUP_SET_BITS_END( xEventGroup, uxBitsToSet )
+#endif
+
 #ifndef traceEVENT_GROUP_SET_BITS_FROM_ISR
 	#define traceEVENT_GROUP_SET_BITS_FROM_ISR( xEventGroup, uxBitsToSet )
 #endif
@@ -723,7 +750,14 @@ extern "C" {
 #endif
 
 #ifndef portYIELD_WITHIN_API
-	#define portYIELD_WITHIN_API portYIELD
+	#if ( configNUMBER_OF_CORES > 1 )
+		/* A core cannot switch to another task while it holds the kernel
+		spinlocks, so a yield requested from within a critical section is held
+		pending until the critical section is exited. */
+		#define portYIELD_WITHIN_API vTaskYieldWithinAPI
+	#else
+		#define portYIELD_WITHIN_API portYIELD
+	#endif
 #endif
 
 #ifndef portSUPPRESS_TICKS_AND_SLEEP
@@ -810,10 +844,83 @@ extern "C" {
 	#define configUSE_TASK_NOTIFICATIONS 1
 #endif
 
+#ifndef configTASK_NOTIFICATION_ARRAY_ENTRIES
+	#define configTASK_NOTIFICATION_ARRAY_ENTRIES 1
+#endif
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES < 1
+	#error configTASK_NOTIFICATION_ARRAY_ENTRIES must be at least 1
+#endif
+
 #ifndef configUSE_POSIX_ERRNO
 	#define configUSE_POSIX_ERRNO 0
 #endif
 
+#ifndef configUSE_QUEUE_BY_REFERENCE
+	#define configUSE_QUEUE_BY_REFERENCE 0
+#endif
+
+#ifndef configUSE_QUEUE_SEND_RECEIVE_MULTIPLE
+	#define configUSE_QUEUE_SEND_RECEIVE_MULTIPLE 0
+#endif
+
+#ifndef configUSE_INDEXED_LISTS
+	/* Set to 1 to keep a search tree alongside the lists that are initialised
+	with vListInitialiseIndexed(), making sorted insertion O(log n). */
+	#define configUSE_INDEXED_LISTS 0
+#endif
+
+#ifndef configUSE_TIMER_WHEEL
+	/* Set to 1 to hold active software timers in a timer wheel, making
+	starting and stopping a timer O(1), instead of in sorted lists. */
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configTIMER_WHEEL_SLOTS
+	#define configTIMER_WHEEL_SLOTS 64
+#endif
+
+#if( ( configUSE_TIMER_WHEEL == 1 ) && ( ( configTIMER_WHEEL_SLOTS & ( configTIMER_WHEEL_SLOTS - 1 ) ) != 0 ) )
+	#error configTIMER_WHEEL_SLOTS must be a power of 2
+#endif
+
+#ifndef configUSE_EVENT_GROUP_BIT_INDEX
+	/* Set to 1 to list tasks blocked on an event group under the bits they
+	wait for, so setting bits only tests the tasks those bits can unblock. */
+	#define configUSE_EVENT_GROUP_BIT_INDEX 0
+#endif
+
+#ifndef configUSE_HEAP_TASK_CACHES
+	/* Set to 1 to have heap_6.c keep per task caches of small freed blocks,
+	so tasks can allocate and free small blocks without suspending the
+	scheduler. */
+	#define configUSE_HEAP_TASK_CACHES 0
+#endif
+
+#ifndef configHEAP_TASK_CACHE_TLS_INDEX
+	/* The thread local storage pointer that holds the cache of each task. */
+	#define configHEAP_TASK_CACHE_TLS_INDEX 0
+#endif
+
+#ifndef configHEAP_TASK_CACHE_DEPTH
+	/* The most blocks of each size a task cache holds. */
+	#define configHEAP_TASK_CACHE_DEPTH 8
+#endif
+
+#ifndef configHEAP_TASK_CACHE_TRIM_TICKS
+	/* Blocks that stay in a task cache for this long are returned to the
+	heap. */
+	#define configHEAP_TASK_CACHE_TRIM_TICKS 1000
+#endif
+
+#if( ( configUSE_HEAP_TASK_CACHES == 1 ) && ( configNUM_THREAD_LOCAL_STORAGE_POINTERS <= configHEAP_TASK_CACHE_TLS_INDEX ) )
+	#error configUSE_HEAP_TASK_CACHES requires a thread local storage pointer at configHEAP_TASK_CACHE_TLS_INDEX
+#endif
+
+#if( ( configUSE_HEAP_TASK_CACHES == 1 ) && ( INCLUDE_xTaskGetSchedulerState == 0 ) && ( configUSE_TIMERS == 0 ) )
+	#error configUSE_HEAP_TASK_CACHES requires INCLUDE_xTaskGetSchedulerState
+#endif
+
 #ifndef portTICK_TYPE_IS_ATOMIC
 	#define portTICK_TYPE_IS_ATOMIC 0
 #endif
@@ -828,6 +935,47 @@ extern "C" {
 	#define configSUPPORT_DYNAMIC_ALLOCATION 1
 #endif
 
+#if ( configNUMBER_OF_CORES > 1 )
+
+	/* Symmetric multiprocessing.  Each core runs the highest priority ready
+	task that is allowed to run on it.  The port must be able to identify the
+	calling core, interrupt another core to make it yield, and provide the two
+	recursive spinlocks that are taken in place of (as well as) disabling
+	interrupts.  The task lock is held by a core that has suspended the
+	scheduler or is in a critical section, the ISR lock by a core that is in a
+	critical section or an interrupt safe critical section. */
+	#ifndef portGET_CORE_ID
+		#error configNUMBER_OF_CORES is greater than 1 but the port does not define portGET_CORE_ID().
+	#endif
+
+	#ifndef portYIELD_CORE
+		#error configNUMBER_OF_CORES is greater than 1 but the port does not define portYIELD_CORE().
+	#endif
+
+	#if !defined( portGET_TASK_LOCK ) || !defined( portRELEASE_TASK_LOCK ) || !defined( portGET_ISR_LOCK ) || !defined( portRELEASE_ISR_LOCK )
+		#error configNUMBER_OF_CORES is greater than 1 but the port does not define the kernel spinlocks.
+	#endif
+
+	#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION != 0 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION must be 0 when configNUMBER_OF_CORES is greater than 1.
+	#endif
+
+	#if ( configUSE_TICKLESS_IDLE != 0 )
+		#error configUSE_TICKLESS_IDLE must be 0 when configNUMBER_OF_CORES is greater than 1.
+	#endif
+
+	#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+		#error The idle tasks of the cores other than core 0 are created dynamically, so configSUPPORT_DYNAMIC_ALLOCATION must be 1 when configNUMBER_OF_CORES is greater than 1.
+	#endif
+
+#else
+
+	#ifndef portGET_CORE_ID
+		#define portGET_CORE_ID() ( ( BaseType_t ) 0 )
+	#endif
+
+#endif /* configNUMBER_OF_CORES */
+
 #ifndef configSTACK_DEPTH_TYPE
 	/* Defaults to uint16_t for backward compatibility, but can be overridden
 	in FreeRTOSConfig.h if uint16_t is too restrictive. */
@@ -1040,6 +1188,9 @@ struct xSTATIC_LIST_ITEM
 	#endif
 	TickType_t xDummy2;
 	void *pvDummy3[ 4 ];
+	#if( configUSE_INDEXED_LISTS == 1 )
+		void *pvDummy5[ 3 ];
+	#endif
 	#if( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
 		TickType_t xDummy4;
 	#endif
@@ -1066,6 +1217,10 @@ typedef struct xSTATIC_LIST
 	UBaseType_t uxDummy2;
 	void *pvDummy3;
 	StaticMiniListItem_t xDummy4;
+	#if( configUSE_INDEXED_LISTS == 1 )
+		void *pvDummy6;
+		BaseType_t xDummy7;
+	#endif
 	#if( configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES == 1 )
 		TickType_t xDummy5;
 	#endif
@@ -1119,8 +1274,8 @@ typedef struct xSTATIC_TCB
 		struct	_reent	xDummy17;
 	#endif
 	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
-		uint32_t 		ulDummy18;
-		uint8_t 		ucDummy19;
+		uint32_t 		ulDummy18[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
+		uint8_t 		ucDummy19[ configTASK_NOTIFICATION_ARRAY_ENTRIES ];
 	#endif
 	#if ( tskSTATIC_AND_DYNAMIC_ALLOCATION_POSSIBLE != 0 )
 		uint8_t			uxDummy20;
@@ -1132,6 +1287,10 @@ typedef struct xSTATIC_TCB
 	#if ( configUSE_POSIX_ERRNO == 1 )
 		int				iDummy22;
 	#endif
+	#if ( configNUMBER_OF_CORES > 1 )
+		BaseType_t		xDummy23;
+		UBaseType_t		uxDummy24;
+	#endif
 } StaticTask_t;
 
 /*
@@ -1175,6 +1334,10 @@ typedef struct xSTATIC_QUEUE
 		uint8_t ucDummy9;
 	#endif
 
+	#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+		UBaseType_t uxDummy10[ 2 ];
+	#endif
+
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
@@ -1197,6 +1360,11 @@ typedef struct xSTATIC_EVENT_GROUP
 	TickType_t xDummy1;
 	StaticList_t xDummy2;
 
+	#if( configUSE_EVENT_GROUP_BIT_INDEX == 1 )
+		StaticList_t xDummy5[ ( configUSE_16_BIT_TICKS == 1 ) ? 8 : 24 ];
+		TickType_t xDummy6;
+	#endif
+
 	#if( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxDummy3;
 	#endif
@@ -128,6 +128,7 @@ typedef BaseType_t ( * MQTTAgentCallback_t )( void * pvUserData,
 #define mqttagentURL_IS_IP_ADDRESS       0x00000001    /**< Set this bit in xFlags if the provided URL is an IP address. */
 #define mqttagentREQUIRE_TLS             0x00000002    /**< Set this bit in xFlags to use TLS. */
 #define mqttagentUSE_AWS_IOT_ALPN_443    0x00000004    /**< Set this bit in xFlags to use AWS IoT support for MQTT over TLS port 443. */
+#define mqttagentRESUME_SESSION          0x00000008    /**< Set this bit in xFlags to ask the broker to resume the previous session. Needs mqttconfigENABLE_INFLIGHT_STORE, and is ignored otherwise. */
 
 /**
  * @brief Parameters passed to the MQTT_AGENT_Connect API.
@@ -182,10 +183,38 @@ typedef struct MQTTAgentPublishParams
     const uint8_t * pucTopic; /**< The topic string on which the message should be published. */
     uint16_t usTopicLength;   /**< The length of the topic. */
     MQTTQoS_t xQoS;           /**< Quality of Service (QoS). */
-    const void * pvData;      /**< The data to publish. This data is copied into the MQTT buffers and therefore the user can free the buffer after the MQTT_AGENT_Publish call returns. */
+    const void * pvData;      /**< The data to publish. This data is transmitted before the operation completes and therefore the user can free the buffer after the MQTT_AGENT_Publish call returns. Data which does not fit in one MQTT buffer is transmitted straight from this buffer. */
     uint32_t ulDataLength;    /**< Length of the data. */
 } MQTTAgentPublishParams_t;
 
+/**
+ * @brief Opaque handle to represent an asynchronous operation.
+ *
+ * Each asynchronous API returns a handle for the operation it started and
+ * the same handle is later passed to the completion callback, so that the
+ * user can match the results with the operations. Handles are reused after
+ * 65535 operations.
+ */
+typedef void * MQTTAgentOperationHandle_t;
+
+/**
+ * @brief Signature of the callback invoked when an asynchronous operation completes.
+ *
+ * The callback runs in the context of the MQTT task and therefore must not
+ * block. It may start further asynchronous operations, but must not call the
+ * blocking APIs. A callback can forward the result to a queue if the result is
+ * to be processed by an application task.
+ *
+ * @param[in] pvCompletionContext The context passed to the asynchronous API.
+ * @param[in] xOperationHandle The handle returned by the asynchronous API.
+ * @param[in] xReturnCode eMQTTAgentSuccess if the operation succeeded (i.e. the
+ * ACK was received or, for QoS0 publishes, the message was sent), eMQTTAgentTimeout
+ * if the operation did not complete in time or eMQTTAgentFailure if it failed.
+ */
+typedef void ( * MQTTAgentCompletionCallback_t )( void * pvCompletionContext,
+                                                  MQTTAgentOperationHandle_t xOperationHandle,
+                                                  MQTTAgentReturnCode_t xReturnCode );
+
 /**
  * @brief MQTT library Init function.
  *
@@ -339,6 +368,100 @@ MQTTAgentReturnCode_t MQTT_AGENT_Publish( MQTTAgentHandle_t xMQTTHandle,
                                           const MQTTAgentPublishParams_t * const pxPublishParams,
                                           TickType_t xTimeoutTicks );
 
+/**
+ * @brief Subscribes to a given topic without waiting for the SUBACK.
+ *
+ * Queues the subscribe operation to the MQTT task and returns immediately. The
+ * result is reported later through pxCompletionCallback. The subscribe parameters
+ * are copied, but the topic they point to must remain valid until the completion
+ * callback is invoked.
+ *
+ * This function may be called from MQTT callbacks, in which case it does not
+ * wait for space in the command queue.
+ *
+ * @param[in] xMQTTHandle The opaque handle as returned from MQTT_AGENT_Create.
+ * @param[in] pxSubscribeParams Subscribe parameters.
+ * @param[in] pxCompletionCallback Callback invoked with the result of the operation.
+ * @param[in] pvCompletionContext Passed as it is to the completion callback. Can be NULL.
+ * @param[in] xTimeoutTicks Maximum time in ticks after which the operation should fail. Use pdMS_TO_TICKS
+ * macro to convert milliseconds to ticks.
+ * @param[out] pxOperationHandle Output parameter to return the handle of the operation. Can be NULL.
+ *
+ * @return eMQTTAgentSuccess if the operation was queued, in which case the completion
+ * callback is invoked exactly once. Otherwise an error code is returned and the
+ * callback is not invoked.
+ *
+ * @see MQTT_AGENT_Subscribe.
+ */
+MQTTAgentReturnCode_t MQTT_AGENT_SubscribeAsync( MQTTAgentHandle_t xMQTTHandle,
+                                                 const MQTTAgentSubscribeParams_t * const pxSubscribeParams,
+                                                 MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                                 void * pvCompletionContext,
+                                                 TickType_t xTimeoutTicks,
+                                                 MQTTAgentOperationHandle_t * const pxOperationHandle );
+
+/**
+ * @brief Unsubscribes from a given topic without waiting for the UNSUBACK.
+ *
+ * Queues the unsubscribe operation to the MQTT task and returns immediately. The
+ * result is reported later through pxCompletionCallback. The unsubscribe parameters
+ * are copied, but the topic they point to must remain valid until the completion
+ * callback is invoked.
+ *
+ * @param[in] xMQTTHandle The opaque handle as returned from MQTT_AGENT_Create.
+ * @param[in] pxUnsubscribeParams Unsubscribe parameters.
+ * @param[in] pxCompletionCallback Callback invoked with the result of the operation.
+ * @param[in] pvCompletionContext Passed as it is to the completion callback. Can be NULL.
+ * @param[in] xTimeoutTicks Maximum time in ticks after which the operation should fail. Use pdMS_TO_TICKS
+ * macro to convert milliseconds to ticks.
+ * @param[out] pxOperationHandle Output parameter to return the handle of the operation. Can be NULL.
+ *
+ * @return eMQTTAgentSuccess if the operation was queued, in which case the completion
+ * callback is invoked exactly once. Otherwise an error code is returned and the
+ * callback is not invoked.
+ */
+MQTTAgentReturnCode_t MQTT_AGENT_UnsubscribeAsync( MQTTAgentHandle_t xMQTTHandle,
+                                                   const MQTTAgentUnsubscribeParams_t * const pxUnsubscribeParams,
+                                                   MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                                   void * pvCompletionContext,
+                                                   TickType_t xTimeoutTicks,
+                                                   MQTTAgentOperationHandle_t * const pxOperationHandle );
+
+/**
+ * @brief Publishes a message to a given topic without waiting for the PUBACK.
+ *
+ * Queues the publish operation to the MQTT task and returns immediately, so
+ * that a single task can keep many QoS1 publishes in flight. The result is
+ * reported later through pxCompletionCallback. The publish parameters are
+ * copied, but the topic and data they point to must remain valid until the
+ * completion callback is invoked.
+ *
+ * Up to mqttconfigMAX_PARALLEL_OPS operations can wait for an ACK on each
+ * client. Operations started beyond that fail with eMQTTAgentFailure, so the
+ * caller should bound the number of outstanding operations, for example with
+ * a counting semaphore given from the completion callback. Each outstanding
+ * QoS1 publish also holds one buffer from the buffer pool until its PUBACK is
+ * received.
+ *
+ * @param[in] xMQTTHandle The opaque handle as returned from MQTT_AGENT_Create.
+ * @param[in] pxPublishParams Publish parameters.
+ * @param[in] pxCompletionCallback Callback invoked with the result of the operation.
+ * @param[in] pvCompletionContext Passed as it is to the completion callback. Can be NULL.
+ * @param[in] xTimeoutTicks Maximum time in ticks after which the operation should fail. Use pdMS_TO_TICKS
+ * macro to convert milliseconds to ticks.
+ * @param[out] pxOperationHandle Output parameter to return the handle of the operation. Can be NULL.
+ *
+ * @return eMQTTAgentSuccess if the operation was queued, in which case the completion
+ * callback is invoked exactly once. Otherwise an error code is returned and the
+ * callback is not invoked.
+ */
+MQTTAgentReturnCode_t MQTT_AGENT_PublishAsync( MQTTAgentHandle_t xMQTTHandle,
+                                               const MQTTAgentPublishParams_t * const pxPublishParams,
+                                               MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                               void * pvCompletionContext,
+                                               TickType_t xTimeoutTicks,
+                                               MQTTAgentOperationHandle_t * const pxOperationHandle );
+
 /**
  * @brief Returns the buffer provided in the publish callback.
  *
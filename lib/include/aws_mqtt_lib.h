@@ -106,7 +106,8 @@ typedef enum
 typedef enum
 {
     eMQTTRxMessageStore, /**< The message being received is being stored. */
-    eMQTTRxMessageDrop   /**< The message being received is being dropped. */
+    eMQTTRxMessageDrop,  /**< The message being received is being dropped. */
+    eMQTTRxMessageStream /**< The message being received is a publish message too large for one buffer and is being passed to the user in fragments. */
 } MQTTRxMessageAction_t;
 
 /**
@@ -215,6 +216,7 @@ typedef struct MQTTConnACKData
 {
     MQTTConnACKReturnCode_t xConnACKReturnCode; /**< CONNACK return code. @see MQTTConnACKReturnCode_t. */
     uint16_t usPacketIdentifier;                /**< Packet identifier which the user can use to match the CONNACK with the Connect request. */
+    MQTTBool_t xSessionPresent;                 /**< Whether the broker resumed the session of a previous connection. Always eMQTTFalse for a clean session. */
 } MQTTConnACKData_t;
 
 /**
@@ -248,15 +250,22 @@ typedef struct MQTTPubACKData
 /**
  * @brief The data sent by the MQTT library in the user supplied callback
  * when a publish message from the broker is received.
+ *
+ * A publish message which is too large to be stored in one buffer is passed
+ * to the user in fragments, one callback per fragment, in order. Each fragment
+ * carries the topic and the next part of the message. A fragment is the last
+ * one of its message when ulDataOffset + ulDataLength equals ulTotalDataLength.
  */
 typedef struct MQTTPublishData
 {
     MQTTQoS_t xQos;             /**< Quality of Service (QoS). */
     const uint8_t * pucTopic;   /**< The topic on which the message is received. */
     uint16_t usTopicLength;     /**< Length of the topic. */
-    const void * pvData;        /**< The received message. */
-    uint32_t ulDataLength;      /**< Length of the message. */
-    MQTTBufferHandle_t xBuffer; /**< The buffer containing the whole MQTT message. Both pcTopic and pvData are pointers to the locations in this buffer. */
+    const void * pvData;        /**< The received message, or the received fragment of the message. */
+    uint32_t ulDataLength;      /**< Length of pvData. */
+    uint32_t ulDataOffset;      /**< Offset of pvData in the whole message. Always 0 unless the message is passed in fragments. */
+    uint32_t ulTotalDataLength; /**< Length of the whole message. Same as ulDataLength unless the message is passed in fragments. */
+    MQTTBufferHandle_t xBuffer; /**< The buffer containing the MQTT message, or the fragment of it. Both pcTopic and pvData are pointers to the locations in this buffer. */
 } MQTTPublishData_t;
 
 /**
@@ -317,7 +326,10 @@ typedef struct MQTTCallbackParams
  * The user should take the ownership of the buffer containing the received message from the
  * broker by returning eMQTTTrue from the callback if the user wants to use the buffer after
  * the callback is over. The user should return the buffer whenever done by calling the
- * MQTT_ReturnBuffer API.
+ * MQTT_ReturnBuffer API.<br>
+ * The ownership of the buffer can only be taken for the last fragment of a message which
+ * is passed in fragments. eMQTTFalse must be returned for the other fragments because the
+ * library reuses the buffer for the next fragment.
  */
 typedef MQTTBool_t ( * MQTTEventCallback_t )( void * pvCallbackContext,
                                               const MQTTEventCallbackParams_t * const pxParams );
@@ -344,7 +356,10 @@ typedef MQTTBool_t ( * MQTTEventCallback_t )( void * pvCallbackContext,
  * The user should take the ownership of the buffer containing the received message from the
  * broker by returning eMQTTTrue from the callback if the user wants to use the buffer after
  * the callback is over. The user should return the buffer whenever done by calling the
- * MQTT_ReturnBuffer API.
+ * MQTT_ReturnBuffer API.<br>
+ * The ownership of the buffer can only be taken for the last fragment of a message which
+ * is passed in fragments. eMQTTFalse must be returned for the other fragments because the
+ * library reuses the buffer for the next fragment.
  */
 #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
@@ -369,6 +384,27 @@ typedef uint32_t ( * MQTTSend_t )( void * pvSendContext,
                                    const uint8_t * const pucData,
                                    uint32_t ulDataLength );
 
+/**
+ * @brief Signature of the user supplied callback to read the data to publish.
+ *
+ * The user can register this optional callback in the publish parameters to
+ * publish data which is not in memory as one contiguous block, for example a
+ * file. The library calls it with increasing offsets until all the data has
+ * been read, and transmits the data as it is read.
+ *
+ * @param[in] pvReadContext The read context as supplied by the user in the publish parameters.
+ * @param[in] ulOffset The offset in the data of the first byte to read.
+ * @param[out] pucBuffer The buffer to read the data into.
+ * @param[in] ulBufferLength The length of pucBuffer. It never exceeds the length of the data
+ * which remains to be read.
+ *
+ * @return The number of bytes read into pucBuffer. Returning 0 fails the publish operation.
+ */
+typedef uint32_t ( * MQTTPublishRead_t )( void * pvReadContext,
+                                          uint32_t ulOffset,
+                                          uint8_t * pucBuffer,
+                                          uint32_t ulBufferLength );
+
 /**
  * @brief Signature of the callback to get the current tick count.
  *
@@ -411,19 +447,114 @@ typedef uint8_t * ( * MQTTGetFreeBuffer_t )( uint32_t * pulBufferLength );
 typedef void ( * MQTTReturnBuffer_t )( uint8_t * pucBuffer );
 
 /**
- * @brief Represents a subscription entry in the subscription manager.
+ * @brief Signature of the callback supplied by the user as part of
+ * MQTTInFlightStoreInterface_t to write a QoS1 publish message to the store.
+ *
+ * A message is written in one or more parts, in order. The first part is
+ * written at offset 0 and the store must then reserve space for the whole
+ * message, of ulPacketLength bytes.
+ *
+ * @param[in] pvStoreContext The store context as supplied in the store interface.
+ * @param[in] usPacketIdentifier The packet identifier of the message.
+ * @param[in] ulPacketLength The length of the whole message.
+ * @param[in] ulOffset The offset in the message of the first byte to write.
+ * @param[in] pucData The data to write.
+ * @param[in] ulDataLength The length of the data.
+ *
+ * @return eMQTTSuccess if the data was written, eMQTTNoFreeBuffer if there is
+ * no space to store the message, eMQTTFailure if a message with the same
+ * packet identifier is already stored or the data could not be written.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+    typedef MQTTReturnCode_t ( * MQTTStoreWrite_t )( void * pvStoreContext,
+                                                     uint16_t usPacketIdentifier,
+                                                     uint32_t ulPacketLength,
+                                                     uint32_t ulOffset,
+                                                     const uint8_t * pucData,
+                                                     uint32_t ulDataLength );
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Signature of the callback supplied by the user as part of
+ * MQTTInFlightStoreInterface_t to read a stored message.
+ *
+ * @param[in] pvStoreContext The store context as supplied in the store interface.
+ * @param[in] usPacketIdentifier The packet identifier of the message.
+ * @param[in] ulOffset The offset in the message of the first byte to read.
+ * @param[out] pucBuffer The buffer to read the data into.
+ * @param[in] ulBufferLength The number of bytes to read.
+ *
+ * @return The number of bytes read, which is ulBufferLength unless the
+ * message ends earlier. 0 if the message is not stored.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+    typedef uint32_t ( * MQTTStoreRead_t )( void * pvStoreContext,
+                                            uint16_t usPacketIdentifier,
+                                            uint32_t ulOffset,
+                                            uint8_t * pucBuffer,
+                                            uint32_t ulBufferLength );
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Signature of the callback supplied by the user as part of
+ * MQTTInFlightStoreInterface_t to find the stored messages.
+ *
+ * The messages are returned in the order in which they were written.
+ *
+ * @param[in] pvStoreContext The store context as supplied in the store interface.
+ * @param[in] usPacketIdentifier The packet identifier of the previous message
+ * returned, or 0 to get the first message.
+ * @param[out] pulPacketLength The length of the returned message.
+ *
+ * @return The packet identifier of the message stored after the given one,
+ * or 0 if there is none.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+    typedef uint16_t ( * MQTTStoreNext_t )( void * pvStoreContext,
+                                            uint16_t usPacketIdentifier,
+                                            uint32_t * pulPacketLength );
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Signature of the callback supplied by the user as part of
+ * MQTTInFlightStoreInterface_t to remove a stored message.
+ *
+ * @param[in] pvStoreContext The store context as supplied in the store interface.
+ * @param[in] usPacketIdentifier The packet identifier of the message to remove,
+ * or 0 to remove all the messages.
+ *
+ * @return eMQTTTrue if a message was removed, eMQTTFalse otherwise.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+    typedef MQTTBool_t ( * MQTTStoreRemove_t )( void * pvStoreContext,
+                                                uint16_t usPacketIdentifier );
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Represents one level of a topic filter in the subscription manager.
+ *
+ * The subscription manager stores topic filters as a tree with one node per
+ * level, so that topic filters which begin with the same levels share the
+ * nodes for those levels. The '+' and '#' levels following a node are kept
+ * apart from its other children so that they are matched without comparing
+ * level names. Nodes are referred to by their index in the subscription
+ * manager, and index 0, which is the root of the tree, means "no node".
  */
 #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
-    typedef struct MQTTSubscription
+    typedef struct MQTTTopicNode
     {
-        uint8_t ucTopicFilter[ mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH ]; /**< The topic filter this subscription entry is for. */
-        uint16_t usTopicFilterLength;                                             /**< The length of the topic filter. */
-        void * pvPublishCallbackContext;                                          /**< The callback context supplied by the user while subscribing. */
-        MQTTPublishCallback_t pxPublishCallback;                                  /**< The callback associated with this subscription. */
-        MQTTBool_t xInUse;                                                        /**< Tracks whether the subscription entry is in-use. */
-        MQTTTopicFilterType_t xTopicFilterType;                                   /**< The type of the topic filter. */
-    } MQTTSubscription_t;
+        void * pvPublishCallbackContext;         /**< The callback context supplied by the user while subscribing. */
+        MQTTPublishCallback_t pxPublishCallback; /**< The callback associated with the topic filter which ends at this node. */
+        uint16_t usLevelOffset;                  /**< The offset of the name of this level in the level names buffer. */
+        uint16_t usLevelLength;                  /**< The length of the name of this level. */
+        uint16_t usParent;                       /**< The node of the previous level. */
+        uint16_t usFirstChild;                   /**< The first of the next levels other than '+' and '#'. */
+        uint16_t usNextSibling;                  /**< The next node with the same parent. Also links the free nodes. */
+        uint16_t usSingleLevelChild;             /**< The '+' next level. */
+        uint16_t usMultiLevelChild;              /**< The '#' next level. */
+        MQTTBool_t xSubscribed;                  /**< Tracks whether a subscribed topic filter ends at this node. */
+    } MQTTTopicNode_t;
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
@@ -435,8 +566,11 @@ typedef void ( * MQTTReturnBuffer_t )( uint8_t * pucBuffer );
 
     typedef struct MQTTSubscriptionManager
     {
-        MQTTSubscription_t xSubscriptions[ mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS ]; /**< User subscriptions. */
-        uint32_t ulInUseSubscriptions;                                                         /**< Number of subscription entries currently in use. */
+        MQTTTopicNode_t xNodes[ mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES ];      /**< The levels of the stored topic filters. xNodes[ 0 ] is the root of the tree. */
+        uint8_t ucLevelNames[ mqttconfigSUBSCRIPTION_MANAGER_LEVEL_NAMES_SIZE ]; /**< The names of the levels, stored back to back. */
+        uint16_t usLevelNamesLength;                                             /**< Number of bytes of ucLevelNames currently in use. */
+        uint16_t usFreeNodes;                                                    /**< The first of the unused nodes. */
+        uint32_t ulInUseSubscriptions;                                           /**< Number of subscriptions currently stored. */
     } MQTTSubscriptionManager_t;
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
@@ -453,6 +587,43 @@ typedef struct MQTTBufferPoolInterface
     MQTTReturnBuffer_t pxReturnBufferFxn; /**< The function to return the buffer. @see MQTTReturnBuffer_t. */
 } MQTTBufferPoolInterface_t;
 
+/**
+ * @brief The in-flight message store interface supplied by the user.
+ *
+ * The library writes QoS1 publish messages to the store before transmitting
+ * them and removes them when their PUBACK is received, so that they can be
+ * retransmitted if the connection is lost. The store can be kept in RAM or
+ * in non-volatile memory. Set pxWriteFxn to NULL to not store any messages.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    typedef struct MQTTInFlightStoreInterface
+    {
+        void * pvStoreContext;         /**< Passed as it is in the store callbacks. */
+        MQTTStoreWrite_t pxWriteFxn;   /**< The function to write a message. @see MQTTStoreWrite_t. */
+        MQTTStoreRead_t pxReadFxn;     /**< The function to read a stored message. @see MQTTStoreRead_t. */
+        MQTTStoreNext_t pxNextFxn;     /**< The function to find the stored messages. @see MQTTStoreNext_t. */
+        MQTTStoreRemove_t pxRemoveFxn; /**< The function to remove a stored message. @see MQTTStoreRemove_t. */
+    } MQTTInFlightStoreInterface_t;
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Statistics of the in-flight message store of an MQTT context.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    typedef struct MQTTInFlightStoreStats
+    {
+        uint32_t ulStored;        /**< Number of QoS1 publish messages written to the store. */
+        uint32_t ulAcknowledged;  /**< Number of stored messages removed because their PUBACK was received. */
+        uint32_t ulResent;        /**< Number of stored messages retransmitted with the DUP flag set after a session was resumed. */
+        uint32_t ulDiscarded;     /**< Number of stored messages removed without a PUBACK, because they timed out or the session was not resumed. */
+        uint32_t ulStoreFailures; /**< Number of QoS1 publish messages which failed because the store could not hold them. */
+    } MQTTInFlightStoreStats_t;
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
 /**
  * @brief Represents the state of the message currently being received.
  */
@@ -462,6 +633,7 @@ typedef struct MQTTRxMessageState
     MQTTRxMessageAction_t xRxMessageAction; /**< Whether the current Rx message is being stored or dropped. Valid only after the fixed header has been received i.e. xRxNextByte is eMQTTRxNextByteMessage. @see MQTTRxMessageAction_t. */
     uint8_t ucRemaingingLengthFieldBytes;   /**< The number of bytes the "Remaining Length" field spans. Valid only after the fixed header has been received i.e. xRxNextByte is eMQTTRxNextByteMessage. */
     uint32_t ulTotalMessageLength;          /**< The total length of the message. Valid only after the fixed header has been received i.e. xRxNextByte is eMQTTRxNextByteMessage. */
+    uint32_t ulStreamedLength;              /**< The number of bytes of the message already passed to the user and no longer in the Rx buffer. Valid only if xRxMessageAction is eMQTTRxMessageStream. */
 } MQTTRxMessageState_t;
 
 /**
@@ -492,6 +664,11 @@ typedef struct MQTTContext
     #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
         MQTTSubscriptionManager_t xSubscriptionManager;         /**< The subscription manager used to keep track of user subscriptions and topic specific callbacks.*/
     #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        MQTTInFlightStoreInterface_t xInFlightStoreInterface;   /**< The in-flight message store interface supplied by the user. @see MQTTInFlightStoreInterface_t. */
+        MQTTInFlightStoreStats_t xInFlightStoreStats;           /**< Statistics of the in-flight message store. */
+        MQTTBool_t xInFlightResendPending;                      /**< Whether the stored messages of a resumed session still have to be retransmitted. */
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
 } MQTTContext_t;
 
 /**
@@ -507,6 +684,9 @@ typedef struct MQTTInitParams
     MQTTSend_t pxMQTTSendFxn;                       /**< User supplied callback to transmit data. Must not be NULL. @see MQTTSend_t. */
     MQTTGetTicks_t pxGetTicksFxn;                   /**< User supplied callback to get the current tick count. Can be NULL. @see MQTTGetTicks_t. */
     MQTTBufferPoolInterface_t xBufferPoolInterface; /**< User supplied buffer pool interface. @see MQTTBufferPoolInterface_t. */
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        MQTTInFlightStoreInterface_t xInFlightStoreInterface; /**< User supplied in-flight message store interface. @see MQTTInFlightStoreInterface_t. */
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
 } MQTTInitParams_t;
 
 /**
@@ -525,6 +705,9 @@ typedef struct MQTTConnectParams
     uint16_t usUserNameLength;               /**< The length of the user name. */
     uint16_t usPacketIdentifier;             /**< The same identifier is returned in the callback when corresponding CONNACK is received or the operation times out. */
     uint32_t ulTimeoutTicks;                 /**< The time interval in ticks after which the operation should fail. */
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        MQTTBool_t xCleanSession;            /**< eMQTTTrue to start a new session and discard the stored messages, eMQTTFalse to resume the previous session. */
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
 } MQTTConnectParams_t;
 
 /**
@@ -571,10 +754,12 @@ typedef struct MQTTPublishParams
     const uint8_t * pucTopic;    /**< The topic to which the data should be published. */
     uint16_t usTopicLength;      /**< The length of the topic. */
     MQTTQoS_t xQos;              /**< Quality of Service. */
-    const void * pvData;         /**< The data to publish. */
+    const void * pvData;         /**< The data to publish. Not used if pxReadFxn is not NULL. */
     uint32_t ulDataLength;       /**< Length of the data. */
     uint16_t usPacketIdentifier; /**< The same identifier is returned in the callback when corresponding PUBACK is received or the operation times out. */
     uint32_t ulTimeoutTicks;     /**< The time interval in ticks after which the operation should fail. */
+    MQTTPublishRead_t pxReadFxn; /**< User supplied callback to read the data to publish instead of taking it from pvData. Can be NULL. @see MQTTPublishRead_t. */
+    void * pvReadContext;        /**< Passed as it is in the read callback. */
 } MQTTPublishParams_t;
 
 /**
@@ -598,6 +783,11 @@ MQTTReturnCode_t MQTT_Init( MQTTContext_t * pxMQTTContext,
  * waiting ACK list which is removed when the corresponding CONNACK is received
  * or the operation times out.
  *
+ * If the in-flight message store is enabled and the CONNACK reports that the
+ * broker resumed the session, the stored publish messages are retransmitted
+ * with the DUP flag set as soon as the CONNACK is received. If the session
+ * was not resumed, the stored messages are discarded.
+ *
  * @param[in] pxMQTTContext The initialized MQTT context.
  * @param[in] pxConnectParams Connect parameters.
  *
@@ -631,8 +821,11 @@ MQTTReturnCode_t MQTT_Disconnect( MQTTContext_t * pxMQTTContext );
  * in the following order:
  * * If we have an exact matching entry in the subscription manager, the corresponding
  *   callback is invoked.
- * * Then the wild card topic filters are checked for match and the corresponding callbacks
- *   are invoked for the ones which match the topic.
+ * * Then the callbacks of the wild card topic filters which match the topic are invoked.
+ *
+ * The subscription manager finds the matching topic filters by following the levels of
+ * the topic, so the time taken depends on the number of levels in the topic and not on
+ * the number of subscriptions.
  *
  * @note If a publish message is received on a topic which matches more than one topic
  * filters, the order in which the registered callbacks are invoked is undefined.
@@ -677,6 +870,21 @@ MQTTReturnCode_t MQTT_Unsubscribe( MQTTContext_t * pxMQTTContext,
  * packet on the waiting ACK list which is removed when the corresponding PUBACK
  * is received or the operation times out.
  *
+ * If the whole message does not fit in one buffer, or the data is read using
+ * the read callback, only the fixed and variable headers are written in the
+ * buffer. The data is then transmitted straight from pvData, or read into the
+ * rest of the buffer and transmitted one chunk at a time. Either way the data
+ * has been transmitted when this function returns. If eMQTTSendFailed or
+ * eMQTTFailure is returned in this case, part of the message may have been
+ * transmitted already and the connection must be closed.
+ *
+ * If the in-flight message store is enabled, a QoS1 message is written to the
+ * store before it is transmitted and eMQTTNoFreeBuffer is returned if the
+ * store cannot hold it. The message stays in the store until its PUBACK is
+ * received, even if the connection is lost, so the user must not publish it
+ * again in that case. It is only removed without a PUBACK if the operation
+ * times out or the next connection does not resume the session.
+ *
  * @param[in] pxMQTTContext The initialized MQTT context.
  * @param[in] pxPublishParams Publish parameters.
  *
@@ -692,6 +900,10 @@ MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
  * until a complete MQTT message has been received after which the user
  * supplied callback is invoked to inform about the received message.
  *
+ * A publish message which is too large for one buffer is passed to the user
+ * in fragments, each as large as the buffer allows, as soon as they are
+ * received. @see MQTTPublishData_t.
+ *
  * @param[in] pxMQTTContext The initialized MQTT context.
  * @param[in] pucReceivedData Received bytes.
  * @param[in] xReceivedDataLength Number of received bytes.
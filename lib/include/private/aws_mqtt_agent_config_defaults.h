@@ -97,6 +97,9 @@
  * the MQTT task can wake up whenever data is received on a connected socket, this
  * value should be set to maximum value:
  * #define  #define mqttconfigMQTT_TASK_MAX_BLOCK_TICKS    ( ~( ( uint32_t ) 0 ) )
+ * The MQTT task then only reads from the sockets for which the callback was
+ * invoked, and otherwise sleeps until the nearest timeout or keep alive deadline
+ * of all the connections.
  *
  * If the platform's secure_sockets layer does not support SOCKETS_SO_WAKEUP_CALLBACK
  * i.e. the MQTT task cannot wake up whenever data is received on a connected socket,
@@ -129,11 +132,21 @@
 
 /**
  * @brief Maximum number of parallel operations per client.
+ *
+ * This is the number of operations which can wait for an ACK at the same
+ * time, including the QoS1 publishes started with MQTT_AGENT_PublishAsync.
  */
 #ifndef mqttconfigMAX_PARALLEL_OPS
     #define mqttconfigMAX_PARALLEL_OPS    ( 5 )
 #endif
 
+/**
+ * @brief Length of the queue used to send commands to the MQTT task.
+ */
+#ifndef mqttconfigCOMMAND_QUEUE_LENGTH
+    #define mqttconfigCOMMAND_QUEUE_LENGTH    ( mqttconfigMAX_BROKERS * mqttconfigMAX_PARALLEL_OPS )
+#endif
+
 /**
  * @brief Time in milliseconds after which the TCP send operation should timeout.
  */
@@ -148,6 +161,18 @@
     #define mqttconfigRX_BUFFER_SIZE    ( 1024 )
 #endif
 
+/**
+ * @brief Task notification index used to signal completion of an operation
+ * to the task that requested it.
+ *
+ * Set this to an index reserved for the MQTT agent, less than
+ * configTASK_NOTIFICATION_ARRAY_ENTRIES, so that the application can keep
+ * using the other notification indexes of tasks that call the MQTT API.
+ */
+#ifndef mqttconfigNOTIFICATION_INDEX
+    #define mqttconfigNOTIFICATION_INDEX    ( tskDEFAULT_INDEX_TO_NOTIFY )
+#endif
+
 /**
  * @defgroup BufferPoolInterface The functions used by the MQTT client to get and return buffers.
  *
@@ -178,4 +203,18 @@
 #endif
 /** @} */
 
+/**
+ * @brief Keep the in-flight messages in non-volatile memory.
+ *
+ * If the in-flight message store is enabled (mqttconfigENABLE_INFLIGHT_STORE
+ * is 1), each connection keeps its in-flight QoS1 publish messages in a RAM
+ * store of mqttconfigINFLIGHT_STORE_RAM_SIZE bytes by default. Set this to 1
+ * to use the platform's prvPAL_MQTTStore* functions instead, so that the
+ * messages survive a reset. The index of the connection is supplied to them as
+ * the store context.
+ */
+#ifndef mqttconfigINFLIGHT_STORE_USE_PAL
+    #define mqttconfigINFLIGHT_STORE_USE_PAL    ( 0 )
+#endif
+
 #endif /* _AWS_MQTT_AGENT_CONFIG_DEFAULTS_H_ */
@@ -73,6 +73,100 @@
     #define mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS    ( 8 )
 #endif
 
+/**
+ * @brief Maximum number of levels in a topic filter which can be stored in
+ * subscription manager.
+ *
+ * The subscribe operation will fail if the user tries to subscribe to a topic
+ * filter with more levels than the maximum specified here, even if the topic
+ * filter is not longer than mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH.
+ * Matching a received topic against the stored topic filters uses 16 bytes of
+ * stack for each level.
+ */
+#ifndef mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS
+    #define mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS    ( 16 )
+#endif
+
+/**
+ * @brief Maximum number of topic filter levels which can be stored in
+ * subscription manager.
+ *
+ * The subscription manager stores one node for each level of a topic filter,
+ * and topic filters which begin with the same levels share the nodes for those
+ * levels. One node is always used for the root of the tree. The subscribe
+ * operation will fail if there are not enough free nodes to store the topic
+ * filter. Must not be more than 65535.
+ *
+ * The default allows each of mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS
+ * topic filters four levels of its own, which is enough when the topic filters
+ * share their first levels, as they usually do. Raise it if the topic filters
+ * of the application have more levels that they do not share. The worst case,
+ * topic filters of mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS levels that
+ * share none of them, needs ( mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS *
+ * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS ) + 1 nodes.
+ */
+#ifndef mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES
+    #define mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES    ( ( mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS * 4 ) + 1 )
+#endif
+
+/**
+ * @brief Size of the buffer in which subscription manager stores the names of
+ * topic filter levels.
+ *
+ * Each node other than the '+' and '#' levels stores the name of its level in
+ * this buffer. The subscribe operation will fail if there is no space left to
+ * store the names of the new levels of the topic filter. Must not be more than
+ * 65535.
+ *
+ * The default allows each of mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS
+ * topic filters 32 bytes of level names of its own, as the names of shared
+ * levels are only stored once. Raise it if the topic filters of the
+ * application have longer levels that they do not share. The worst case,
+ * topic filters of mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH bytes that
+ * share no levels, needs ( mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS *
+ * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH ) bytes.
+ */
+#ifndef mqttconfigSUBSCRIPTION_MANAGER_LEVEL_NAMES_SIZE
+    #define mqttconfigSUBSCRIPTION_MANAGER_LEVEL_NAMES_SIZE    ( mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS * 32 )
+#endif
+
+/**
+ * @brief Length of the buffer requested to receive a publish message which is
+ * too large for one buffer.
+ *
+ * Such a message is passed to the user in fragments, each of which is as long
+ * as the buffer returned for this request allows. The buffer must be able to
+ * hold the fixed and variable header of the message, including the topic, or
+ * the message is dropped. Set it to 0 to drop such messages without trying to
+ * pass them in fragments.
+ */
+#ifndef mqttconfigRX_FRAGMENT_BUFFER_LENGTH
+    #define mqttconfigRX_FRAGMENT_BUFFER_LENGTH    ( 256 )
+#endif
+
+/**
+ * @brief Enable the in-flight message store.
+ *
+ * If enabled, QoS1 publish messages are written to the store supplied in the
+ * init parameters before they are transmitted and stay there until their
+ * PUBACK is received. When the client reconnects without starting a clean
+ * session and the broker reports that the session is present, the stored
+ * messages are retransmitted with the DUP flag set.
+ */
+#ifndef mqttconfigENABLE_INFLIGHT_STORE
+    #define mqttconfigENABLE_INFLIGHT_STORE    ( 0 )
+#endif
+
+/**
+ * @brief Size of the memory used by an in-flight message store kept in RAM.
+ *
+ * Each stored message uses 8 bytes in addition to its length. A QoS1 publish
+ * fails if there is not enough space left to store the message.
+ */
+#ifndef mqttconfigINFLIGHT_STORE_RAM_SIZE
+    #define mqttconfigINFLIGHT_STORE_RAM_SIZE    ( 4096 )
+#endif
+
 /**
  * @brief Define mqttconfigASSERT to enable asserts.
  *
@@ -0,0 +1,113 @@
+/*
+ * Amazon FreeRTOS MQTT Library V1.1.4
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_mqtt_store.h
+ * @brief In-flight message store kept in RAM.
+ *
+ * Implements the in-flight message store interface of the MQTT library
+ * (MQTTInFlightStoreInterface_t) on top of a byte ring buffer supplied by
+ * the user. Messages are kept one after the other, each preceded by a small
+ * header, in the order in which they were written. A removed message is only
+ * marked as removed, and its space is reclaimed once all the messages written
+ * before it have been removed as well.
+ *
+ * The store does not protect itself against concurrent access, so all its
+ * functions must be called from the same task, which is the case when it is
+ * only accessed through the MQTT library.
+ */
+
+#ifndef _AWS_MQTT_STORE_H_
+#define _AWS_MQTT_STORE_H_
+
+/* MQTT lib includes. */
+#include "aws_mqtt_lib.h"
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+/**
+ * @brief In-flight message store kept in RAM.
+ *
+ * The members must not be accessed directly, but only through the functions
+ * declared in this file.
+ */
+    typedef struct MQTTRAMStore
+    {
+        uint8_t ucBuffer[ mqttconfigINFLIGHT_STORE_RAM_SIZE ]; /**< Ring buffer holding the stored messages. */
+        uint32_t ulHead;                                       /**< Offset in ucBuffer at which the next message is written. */
+        uint32_t ulTail;                                       /**< Offset in ucBuffer of the oldest stored message. */
+        uint32_t ulUsedLength;                                 /**< Number of bytes of ucBuffer in use. */
+    } MQTTRAMStore_t;
+
+/**
+ * @brief Initializes a RAM store, removing all the messages in it.
+ *
+ * @param[in] pvStoreContext The store, of type MQTTRAMStore_t.
+ */
+    void MQTT_RAMSTORE_Init( void * pvStoreContext );
+
+/**
+ * @brief Writes a message to a RAM store.
+ *
+ * @see MQTTStoreWrite_t.
+ */
+    MQTTReturnCode_t MQTT_RAMSTORE_Write( void * pvStoreContext,
+                                          uint16_t usPacketIdentifier,
+                                          uint32_t ulPacketLength,
+                                          uint32_t ulOffset,
+                                          const uint8_t * pucData,
+                                          uint32_t ulDataLength );
+
+/**
+ * @brief Reads a message stored in a RAM store.
+ *
+ * @see MQTTStoreRead_t.
+ */
+    uint32_t MQTT_RAMSTORE_Read( void * pvStoreContext,
+                                 uint16_t usPacketIdentifier,
+                                 uint32_t ulOffset,
+                                 uint8_t * pucBuffer,
+                                 uint32_t ulBufferLength );
+
+/**
+ * @brief Finds the messages stored in a RAM store.
+ *
+ * @see MQTTStoreNext_t.
+ */
+    uint16_t MQTT_RAMSTORE_Next( void * pvStoreContext,
+                                 uint16_t usPacketIdentifier,
+                                 uint32_t * pulPacketLength );
+
+/**
+ * @brief Removes a message from a RAM store.
+ *
+ * @see MQTTStoreRemove_t.
+ */
+    MQTTBool_t MQTT_RAMSTORE_Remove( void * pvStoreContext,
+                                     uint16_t usPacketIdentifier );
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+#endif /* _AWS_MQTT_STORE_H_ */
@@ -0,0 +1,106 @@
+/*
+ * Amazon FreeRTOS MQTT Library V1.1.4
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_mqtt_store_pal.h
+ * @brief Platform abstraction of an in-flight message store kept in
+ * non-volatile memory.
+ *
+ * Each platform which keeps the in-flight QoS1 publish messages in flash or in
+ * a file system implements these functions in
+ * lib/mqtt/portable/<vendor>/<board>/aws_mqtt_store_pal.c. They have the
+ * signatures of the callbacks in MQTTInFlightStoreInterface_t, so that they
+ * can be supplied to the MQTT library directly. The messages stored before a
+ * reset are retransmitted once the device reconnects and the broker resumes
+ * the session.
+ */
+
+#ifndef _AWS_MQTT_STORE_PAL_H_
+#define _AWS_MQTT_STORE_PAL_H_
+
+/* MQTT lib includes. */
+#include "aws_mqtt_lib.h"
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+/**
+ * @brief Write a QoS1 publish message to non-volatile memory.
+ *
+ * The first part of a message is written at offset 0, and space for the whole
+ * message must then be reserved. The pvStoreContext is the one supplied in the
+ * store interface and may be used by the platform to select the storage area.
+ *
+ * @return eMQTTSuccess if the data was written, eMQTTNoFreeBuffer if there is
+ * no space to store the message, eMQTTFailure otherwise.
+ *
+ * @see MQTTStoreWrite_t.
+ */
+    MQTTReturnCode_t prvPAL_MQTTStoreWrite( void * pvStoreContext,
+                                            uint16_t usPacketIdentifier,
+                                            uint32_t ulPacketLength,
+                                            uint32_t ulOffset,
+                                            const uint8_t * pucData,
+                                            uint32_t ulDataLength );
+
+/**
+ * @brief Read a message stored in non-volatile memory.
+ *
+ * @return The number of bytes read, 0 if the message is not stored.
+ *
+ * @see MQTTStoreRead_t.
+ */
+    uint32_t prvPAL_MQTTStoreRead( void * pvStoreContext,
+                                   uint16_t usPacketIdentifier,
+                                   uint32_t ulOffset,
+                                   uint8_t * pucBuffer,
+                                   uint32_t ulBufferLength );
+
+/**
+ * @brief Find the messages stored in non-volatile memory, in the order in
+ * which they were written.
+ *
+ * @return The packet identifier of the message after the given one, 0 if
+ * there is none.
+ *
+ * @see MQTTStoreNext_t.
+ */
+    uint16_t prvPAL_MQTTStoreNext( void * pvStoreContext,
+                                   uint16_t usPacketIdentifier,
+                                   uint32_t * pulPacketLength );
+
+/**
+ * @brief Remove a message, or all the messages if usPacketIdentifier is 0,
+ * from non-volatile memory.
+ *
+ * @return eMQTTTrue if a message was removed, eMQTTFalse otherwise.
+ *
+ * @see MQTTStoreRemove_t.
+ */
+    MQTTBool_t prvPAL_MQTTStoreRemove( void * pvStoreContext,
+                                       uint16_t usPacketIdentifier );
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+#endif /* _AWS_MQTT_STORE_PAL_H_ */
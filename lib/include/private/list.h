@@ -145,6 +145,11 @@ struct xLIST_ITEM
 	struct xLIST_ITEM * configLIST_VOLATILE pxPrevious;	/*< Pointer to the previous ListItem_t in the list. */
 	void * pvOwner;										/*< Pointer to the object (normally a TCB) that contains the list item.  There is therefore a two way link between the object containing the list item and the list item itself. */
 	struct xLIST * configLIST_VOLATILE pxContainer;		/*< Pointer to the list in which this list item is placed (if any). */
+	#if( configUSE_INDEXED_LISTS == 1 )
+		struct xLIST_ITEM * configLIST_VOLATILE pxTreeLeft;		/*< Search tree links, only used while the item is in an indexed list. */
+		struct xLIST_ITEM * configLIST_VOLATILE pxTreeRight;
+		struct xLIST_ITEM * configLIST_VOLATILE pxTreeParent;
+	#endif
 	listSECOND_LIST_ITEM_INTEGRITY_CHECK_VALUE			/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
 };
 typedef struct xLIST_ITEM ListItem_t;					/* For some reason lint wants this as two separate definitions. */
@@ -167,6 +172,10 @@ typedef struct xLIST
 	volatile UBaseType_t uxNumberOfItems;
 	ListItem_t * configLIST_VOLATILE pxIndex;			/*< Used to walk through the list.  Points to the last item returned by a call to listGET_OWNER_OF_NEXT_ENTRY (). */
 	MiniListItem_t xListEnd;							/*< List item that contains the maximum possible item value meaning it is always at the end of the list and is therefore used as a marker. */
+	#if( configUSE_INDEXED_LISTS == 1 )
+		ListItem_t * configLIST_VOLATILE pxTreeRoot;	/*< Root of the search tree that indexes the items, NULL when the list is empty or not indexed. */
+		BaseType_t xIndexed;							/*< pdTRUE if the list was initialised with vListInitialiseIndexed(). */
+	#endif
 	listSECOND_LIST_INTEGRITY_CHECK_VALUE				/*< Set to a known value if configUSE_LIST_DATA_INTEGRITY_CHECK_BYTES is set to 1. */
 } List_t;
 
@@ -344,6 +353,25 @@ List_t * const pxConstList = ( pxList );													\
  */
 void vListInitialise( List_t * const pxList ) PRIVILEGED_FUNCTION;
 
+/*
+ * As vListInitialise(), but the list also maintains a search tree (a treap
+ * keyed on item value) so vListInsert() takes O(log n) rather than O(n) time.
+ * The list order, and therefore every list access macro, is unchanged.  Only
+ * worth using for sorted lists that can grow long, such as the delayed task
+ * lists.  Requires configUSE_INDEXED_LISTS to be set to 1, otherwise it is the
+ * same as vListInitialise().
+ *
+ * @param pxList Pointer to the list being initialised.
+ *
+ * \page vListInitialiseIndexed vListInitialiseIndexed
+ * \ingroup LinkedList
+ */
+#if( configUSE_INDEXED_LISTS == 1 )
+	void vListInitialiseIndexed( List_t * const pxList ) PRIVILEGED_FUNCTION;
+#else
+	#define vListInitialiseIndexed( pxList ) vListInitialise( pxList )
+#endif
+
 /*
  * Must be called before a list item is used.  This sets the list container to
  * null so the item does not think that it is already contained in a list.
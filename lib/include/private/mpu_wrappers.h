@@ -82,6 +82,11 @@ only for ports that are using the MPU. */
 		#define xTaskNotifyWait							MPU_xTaskNotifyWait
 		#define ulTaskNotifyTake						MPU_ulTaskNotifyTake
 		#define xTaskNotifyStateClear					MPU_xTaskNotifyStateClear
+		#define xTaskGenericNotifyIndexed				MPU_xTaskGenericNotifyIndexed
+		#define xTaskNotifyWaitIndexed					MPU_xTaskNotifyWaitIndexed
+		#define xTaskNotifyWaitAny						MPU_xTaskNotifyWaitAny
+		#define ulTaskNotifyTakeIndexed					MPU_ulTaskNotifyTakeIndexed
+		#define xTaskNotifyStateClearIndexed			MPU_xTaskNotifyStateClearIndexed
 
 		#define xTaskGetCurrentTaskHandle				MPU_xTaskGetCurrentTaskHandle
 		#define vTaskSetTimeOutState					MPU_vTaskSetTimeOutState
@@ -144,6 +144,21 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Used by heap_6.c when configUSE_HEAP_TASK_CACHES is 1.  vPortFreeTaskCache()
+ * returns the blocks cached by a task that is being deleted to the heap, and
+ * xPortGetCachedHeapSize() returns the bytes held in the caches of all tasks,
+ * which are not included in xPortGetFreeHeapSize().
+ * xPortGetTaskCachedHeapSize() returns the bytes held in the cache of the
+ * calling task.  vPortTrimTaskCaches() is called by the idle task, and returns
+ * the blocks that were not used for configHEAP_TASK_CACHE_TRIM_TICKS from the
+ * caches of all tasks.
+ */
+void vPortFreeTaskCache( void *pvCache ) PRIVILEGED_FUNCTION;
+void vPortTrimTaskCaches( void ) PRIVILEGED_FUNCTION;
+size_t xPortGetCachedHeapSize( void ) PRIVILEGED_FUNCTION;
+size_t xPortGetTaskCachedHeapSize( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -867,6 +867,293 @@ BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue, void * const pvBuffer ) PRIV
  */
 BaseType_t xQueueReceive( QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueAcquireSlot(
+								QueueHandle_t xQueue,
+								void **ppvSlot,
+								TickType_t xTicksToWait
+							);</pre>
+ *
+ * Reserve the next free item slot in the storage area of a queue, so the item
+ * can be written in place rather than copied in by xQueueSend().  The item
+ * only becomes available to receivers once vQueueCommitSlot() is called.
+ *
+ * xQueueAcquireSlot(), vQueueCommitSlot(), xQueueBorrowItem() and
+ * vQueueReleaseItem() pass items by reference.  A queue that is used with
+ * these functions must not also be used with the functions that copy items
+ * in and out of the queue.  Slots are committed in the order in which they
+ * were acquired, and items are released in the order in which they were
+ * borrowed.
+ *
+ * configUSE_QUEUE_BY_REFERENCE must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.  This function must not be used in an interrupt
+ * service routine.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param ppvSlot Set to the address of the reserved slot, which is
+ * uxItemSize bytes long, if the function returns pdPASS.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for a free slot should all the slots be in use at the time of the
+ * call.
+ *
+ * @return pdPASS if a slot was reserved, otherwise errQUEUE_FULL.
+ *
+ * Example usage:
+   <pre>
+ struct AMessage *pxMessage;
+
+	if( xQueueAcquireSlot( xQueue, ( void ** ) &pxMessage, portMAX_DELAY ) == pdPASS )
+	{
+		// Fill in the message directly in the queue storage.
+		pxMessage->ucMessageID = 1;
+
+		// Make the message available to the receiving task.
+		vQueueCommitSlot( xQueue, pxMessage );
+	}
+ </pre>
+ * \defgroup xQueueAcquireSlot xQueueAcquireSlot
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueAcquireSlot( QueueHandle_t xQueue, void **ppvSlot, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>void vQueueCommitSlot( QueueHandle_t xQueue, void *pvSlot );</pre>
+ *
+ * Make the item written into a slot obtained from xQueueAcquireSlot()
+ * available to receivers, as if it had been sent to the back of the queue.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param pvSlot The slot, which must be the oldest slot acquired from the
+ * queue that is not yet committed.
+ *
+ * \defgroup vQueueCommitSlot vQueueCommitSlot
+ * \ingroup QueueManagement
+ */
+void vQueueCommitSlot( QueueHandle_t xQueue, void *pvSlot ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueBorrowItem(
+								QueueHandle_t xQueue,
+								void **ppvItem,
+								TickType_t xTicksToWait
+							);</pre>
+ *
+ * Remove the item at the front of a queue without copying it out.  The item
+ * stays in the storage area of the queue, where it can be read in place, and
+ * its slot is only reused once vQueueReleaseItem() is called.  See
+ * xQueueAcquireSlot() for the restrictions that apply.
+ *
+ * configUSE_QUEUE_BY_REFERENCE must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.  This function must not be used in an interrupt
+ * service routine.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param ppvItem Set to the address of the item if the function returns
+ * pdPASS.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item should the queue be empty at the time of the call.
+ *
+ * @return pdPASS if an item was removed from the queue, otherwise
+ * errQUEUE_EMPTY.
+ *
+ * \defgroup xQueueBorrowItem xQueueBorrowItem
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueBorrowItem( QueueHandle_t xQueue, void **ppvItem, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>void vQueueReleaseItem( QueueHandle_t xQueue, void *pvItem );</pre>
+ *
+ * Return the slot of an item obtained from xQueueBorrowItem() to the queue,
+ * so it can be acquired again.  The item must not be accessed afterwards.
+ *
+ * @param xQueue The handle to the queue.
+ *
+ * @param pvItem The item, which must be the oldest item borrowed from the
+ * queue that is not yet released.
+ *
+ * \defgroup vQueueReleaseItem vQueueReleaseItem
+ * \ingroup QueueManagement
+ */
+void vQueueReleaseItem( QueueHandle_t xQueue, void *pvItem ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueSendMultiple(
+								QueueHandle_t xQueue,
+								const void *pvItems,
+								UBaseType_t uxItemCount,
+								TickType_t xTicksToWait
+							);</pre>
+ *
+ * Post up to uxItemCount items to the back of a queue, in order, using a
+ * single critical section.  Waiting tasks are unblocked once for the whole
+ * batch rather than once per item.  If the queue does not have space for all
+ * the items then as many items as fit are posted, and the number posted is
+ * returned - the function only blocks while the queue is full.
+ *
+ * configUSE_QUEUE_SEND_RECEIVE_MULTIPLE must be set to 1 in FreeRTOSConfig.h
+ * for this function to be available.  This function must not be used in an
+ * interrupt service routine.  See xQueueSendMultipleFromISR() for an
+ * alternative which may be used in an ISR.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItems A pointer to an array of uxItemCount items, each the size
+ * the queue was created to hold.
+ *
+ * @param uxItemCount The number of items in the pvItems array.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue, should it be full.
+ *
+ * @return The number of items posted, which is 0 if the queue remained full
+ * for xTicksToWait ticks.
+ *
+ * Example usage:
+   <pre>
+ struct AMessage xMessages[ 4 ];
+ UBaseType_t uxSent = 0;
+
+	// Post all four messages, blocking while the queue is full.
+	while( uxSent < 4 )
+	{
+		uxSent += ( UBaseType_t ) xQueueSendMultiple( xQueue, &( xMessages[ uxSent ] ), 4 - uxSent, portMAX_DELAY );
+	}
+ </pre>
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, UBaseType_t uxItemCount, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueSendMultipleFromISR(
+										QueueHandle_t xQueue,
+										const void *pvItems,
+										UBaseType_t uxItemCount,
+										BaseType_t *pxHigherPriorityTaskWoken
+									);</pre>
+ *
+ * A version of xQueueSendMultiple() that can be used in an interrupt service
+ * routine.  It posts as many of the items as fit without blocking.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItems A pointer to an array of uxItemCount items.
+ *
+ * @param uxItemCount The number of items in the pvItems array.
+ *
+ * @param pxHigherPriorityTaskWoken xQueueSendMultipleFromISR() will set
+ * *pxHigherPriorityTaskWoken to pdTRUE if posting the items unblocked a task
+ * with a priority higher than the currently running task.
+ *
+ * @return The number of items posted.
+ *
+ * \defgroup xQueueSendMultipleFromISR xQueueSendMultipleFromISR
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueReceiveMultiple(
+									QueueHandle_t xQueue,
+									void *pvBuffer,
+									UBaseType_t uxMaxItems,
+									TickType_t xTicksToWait
+								);</pre>
+ *
+ * Receive up to uxMaxItems items from the front of a queue, in order, using a
+ * single critical section.  Tasks waiting for space are unblocked once for the
+ * whole batch rather than once per item.  The function only blocks while the
+ * queue is empty, and returns as soon as at least one item was received.
+ *
+ * configUSE_QUEUE_SEND_RECEIVE_MULTIPLE must be set to 1 in FreeRTOSConfig.h
+ * for this function to be available.  This function must not be used in an
+ * interrupt service routine.  See xQueueReceiveMultipleFromISR() for an
+ * alternative which may be used in an ISR.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to an array of uxMaxItems items into which the
+ * received items will be copied.
+ *
+ * @param uxMaxItems The maximum number of items to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty at the time of
+ * the call.
+ *
+ * @return The number of items received, which is 0 if the queue remained
+ * empty for xTicksToWait ticks.
+ *
+ * Example usage:
+   <pre>
+ struct AMessage xMessages[ 8 ];
+ BaseType_t xReceived, x;
+
+	// Wait for at least one message, then handle every message that arrived
+	// in the same burst.
+	xReceived = xQueueReceiveMultiple( xQueue, xMessages, 8, portMAX_DELAY );
+
+	for( x = 0; x < xReceived; x++ )
+	{
+		vProcessMessage( &( xMessages[ x ] ) );
+	}
+ </pre>
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, UBaseType_t uxMaxItems, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ BaseType_t xQueueReceiveMultipleFromISR(
+											QueueHandle_t xQueue,
+											void *pvBuffer,
+											UBaseType_t uxMaxItems,
+											BaseType_t *pxHigherPriorityTaskWoken
+										);</pre>
+ *
+ * A version of xQueueReceiveMultiple() that can be used in an interrupt
+ * service routine.  It receives the items that are available without
+ * blocking.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to an array of uxMaxItems items.
+ *
+ * @param uxMaxItems The maximum number of items to receive.
+ *
+ * @param pxHigherPriorityTaskWoken xQueueReceiveMultipleFromISR() will set
+ * *pxHigherPriorityTaskWoken to pdTRUE if receiving the items unblocked a task
+ * with a priority higher than the currently running task.
+ *
+ * @return The number of items received.
+ *
+ * \defgroup xQueueReceiveMultipleFromISR xQueueReceiveMultipleFromISR
+ * \ingroup QueueManagement
+ */
+BaseType_t xQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, UBaseType_t uxMaxItems, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /**
  * queue. h
  * <pre>UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue );</pre>
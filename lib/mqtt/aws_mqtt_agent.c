@@ -46,6 +46,15 @@
 /* Secure sockets include. */
 #include "aws_secure_sockets.h"
 
+/* In-flight message store includes. */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+    #if ( mqttconfigINFLIGHT_STORE_USE_PAL == 1 )
+        #include "aws_mqtt_store_pal.h"
+    #else
+        #include "aws_mqtt_store.h"
+    #endif
+#endif
+
 /* Standard includes. */
 #include <string.h>
 
@@ -53,12 +62,26 @@
  * @brief The length of the command queue used to send commands from application
  * tasks to the MQTT task.
  *
- * The queue can have a maximum of mqttconfigMAX_PARALLEL_OPS parallel operations
- * for each broker connection at any one time. The socket wake callback will only
- * post to the queue if the queue is empty, so there is no need to leave space for
- * that.
+ * By default the queue can hold mqttconfigMAX_PARALLEL_OPS parallel operations
+ * for each broker connection. The socket wake callback will only post to the
+ * queue if the queue is empty, so there is no need to leave space for that.
+ */
+#define mqttCOMMAND_QUEUE_LENGTH    ( ( UBaseType_t ) ( mqttconfigCOMMAND_QUEUE_LENGTH ) )
+
+/**
+ * @defgroup InFlightOperations Macros related to the in-flight operations table.
+ *
+ * Operations waiting for an ACK are stored in a table of mqttconfigMAX_PARALLEL_OPS
+ * entries per connection. Free entries are linked through usNextFreeOperation.
  */
-#define mqttCOMMAND_QUEUE_LENGTH    ( ( UBaseType_t ) ( mqttconfigMAX_BROKERS * mqttconfigMAX_PARALLEL_OPS ) )
+/** @{ */
+#define mqttNO_FREE_OPERATION    ( ( uint16_t ) 0xFFFF ) /**< Terminates the list of free entries. */
+#define mqttOPERATION_IN_USE     ( ( uint16_t ) 0xFFFE ) /**< Marks an entry which is waiting for an ACK. */
+/** @} */
+
+#if ( mqttconfigMAX_PARALLEL_OPS > 0xFFFD )
+    #error "mqttconfigMAX_PARALLEL_OPS must not exceed 65533."
+#endif
 
 /**
  * @defgroup MessageIdentifer Macros related to message identifier.
@@ -68,22 +91,15 @@
  * from the MQTT task back to the application task. It must only use the top
  * 16-bits of a 32-bit value as the bottom 16-bits pass additional information,
  * for example bit 0 is set to 1 to indicate success (pdPASS) and 0 to indicate
- * a failure (pdFAIL). The value contained in the top 16 bits is also passed as
- * MQTT packet identifier to the MQTT Core Library. The Core library returns this
- * value with ACK or timeout to inform which packet the ACK or timeout response
- * corresponds to.
+ * a failure (pdFAIL). The message identifier is also returned to the user as
+ * the handle of an asynchronous operation. The MQTT packet identifier passed to
+ * the MQTT Core Library is chosen separately by the MQTT task (see
+ * MQTTInFlightOperation_t).
  */
 /** @{ */
 #define mqttMESSAGE_IDENTIFIER_MIN     ( 0x00010000UL )
 #define mqttMESSAGE_IDENTIFIER_MAX     ( 0xFFFF0000UL )
 #define mqttMESSAGE_IDENTIFIER_MASK    ( 0xFFFF0000UL )
-
-/**
- * @brief Extracts the message identifier from the 32-bit notification value.
- *
- * @param[in] x The 32-bit notification value.
- */
-#define mqttMESSAGE_IDENTIFIER_EXTRACT( x )    ( x >> 16 )
 /** @} */
 
 /**
@@ -173,10 +189,28 @@ typedef enum
  */
 typedef struct MQTTNotificationData
 {
-    TaskHandle_t xTaskToNotify;   /**< The handle of the task to notify. */
-    uint32_t ulMessageIdentifier; /**< Used to match a request going from application task to MQTT task with response going the other way. */
+    TaskHandle_t xTaskToNotify;                         /**< The handle of the task to notify. NULL for asynchronous operations. */
+    uint32_t ulMessageIdentifier;                       /**< Used to match a request going from application task to MQTT task with response going the other way. */
+    MQTTAgentCompletionCallback_t pxCompletionCallback; /**< The callback to invoke with the result of an asynchronous operation. NULL for blocking operations. */
+    void * pvCompletionContext;                         /**< Passed as it is to pxCompletionCallback. */
 } MQTTNotificationData_t;
 
+/**
+ * @brief An entry of the table of operations waiting for an ACK.
+ *
+ * Entry x only uses packet identifiers congruent to x + 1 modulo
+ * mqttconfigMAX_PARALLEL_OPS, so the entry of a received ACK is found without
+ * a search. Each use of an entry moves on to its next packet identifier so
+ * that a late ACK for an operation which has already timed out does not
+ * complete a newer operation.
+ */
+typedef struct MQTTInFlightOperation
+{
+    MQTTNotificationData_t xNotificationData; /**< Information used to notify the task that initiated the operation. */
+    uint16_t usPacketIdentifier;              /**< The packet identifier last used by this entry, 0 if the entry was never used. */
+    uint16_t usNextFreeOperation;             /**< Index of the next free entry, or mqttOPERATION_IN_USE while the operation waits for an ACK. */
+} MQTTInFlightOperation_t;
+
 /**
  * @brief Contents of the message sent from an application task to the MQTT task to
  * initiate an MQTT operation.
@@ -191,13 +225,16 @@ typedef struct MQTTEventData
     MQTTNotificationData_t xNotificationData; /**< Information used to notify the task that initiated the operation when the operation is complete. */
     TimeOut_t xEventCreationTimestamp;        /**< Timestamp when this event was created. */
     TickType_t xTicksToWait;                  /**< Time in tick counts after which the operation should fail. */
-    /* Only one of the following is relevant based on the value of xEventType. */
+
+    /* Only one of the following is relevant based on the value of xEventType.
+     * All but the connect parameters are copied, as the asynchronous APIs
+     * return before the MQTT task uses them. */
     union
     {
-        const MQTTAgentConnectParams_t * pxConnectParams;         /**< Connect Parameters. */
-        const MQTTAgentSubscribeParams_t * pxSubscribeParams;     /**< Subscribe Parameters. */
-        const MQTTAgentUnsubscribeParams_t * pxUnsubscribeParams; /**< Unsubscribe Parameters. */
-        const MQTTAgentPublishParams_t * pxPublishParams;         /**< Publish Parameters. */
+        const MQTTAgentConnectParams_t * pxConnectParams; /**< Connect Parameters. */
+        MQTTAgentSubscribeParams_t xSubscribeParams;      /**< Subscribe Parameters. */
+        MQTTAgentUnsubscribeParams_t xUnsubscribeParams;  /**< Unsubscribe Parameters. */
+        MQTTAgentPublishParams_t xPublishParams;          /**< Publish Parameters. */
     } u;
 } MQTTEventData_t;
 
@@ -210,14 +247,20 @@ typedef struct MQTTEventData
  */
 typedef struct MQTTBrokerConnection
 {
-    Socket_t xSocket;                                                   /**< TCP socket connected to the broker. */
-    MQTTContext_t xMQTTContext;                                         /**< MQTT Core library context. */
-    MQTTNotificationData_t xWaitingTasks[ mqttconfigMAX_PARALLEL_OPS ]; /**< Notification data to notify tasks which have sent commands to MQTT command queue and are waiting for results. */
-    void * pvUserData;                                                  /**< User data to be supplied back in the callback as it is. */
-    MQTTAgentCallback_t pxCallback;                                     /**< The callback to notify user of various events including the Publish messages received from the broker. */
-    UBaseType_t uxFlags;                                                /**< Various properties of the connection - secured etc. */
-    BaseType_t xConnectionInUse;                                        /**< Tracks whether or not the connection is in use. It is accessed from application tasks (prvGetFreeConnection and prvReturnConnection) and hence should be accessed in critical section. */
-    uint8_t ucRxBuffer[ mqttconfigRX_BUFFER_SIZE ];                     /**< Buffers incoming messages. */
+    Socket_t xSocket;                                                          /**< TCP socket connected to the broker. */
+    MQTTContext_t xMQTTContext;                                                /**< MQTT Core library context. */
+    MQTTInFlightOperation_t xInFlightOperations[ mqttconfigMAX_PARALLEL_OPS ]; /**< Operations which have been sent to the broker and are waiting for ACKs. */
+    uint16_t usFirstFreeOperation;                                             /**< Index of the first free entry in xInFlightOperations, or mqttNO_FREE_OPERATION if all are in use. */
+    void * pvUserData;                                                         /**< User data to be supplied back in the callback as it is. */
+    MQTTAgentCallback_t pxCallback;                                            /**< The callback to notify user of various events including the Publish messages received from the broker. */
+    UBaseType_t uxFlags;                                                       /**< Various properties of the connection - secured etc. */
+    BaseType_t xConnectionInUse;                                               /**< Tracks whether or not the connection is in use. It is accessed from application tasks (prvGetFreeConnection and prvReturnConnection) and hence should be accessed in critical section. */
+    volatile BaseType_t xSocketReady;                                          /**< Set by the socket wakeup callback when the socket may have data to read, cleared by the MQTT task before it reads. */
+    uint64_t xNextPeriodicTickCount;                                           /**< Tick count at which MQTT_Periodic must next be invoked for this connection. 0 if it must be invoked on the next iteration. */
+    uint8_t ucRxBuffer[ mqttconfigRX_BUFFER_SIZE ];                            /**< Buffers incoming messages. */
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 ) && ( mqttconfigINFLIGHT_STORE_USE_PAL == 0 )
+        MQTTRAMStore_t xInFlightStore;                                         /**< QoS1 publish messages waiting for PUBACK, kept across reconnections. */
+    #endif
 } MQTTBrokerConnection_t;
 /*-----------------------------------------------------------*/
 
@@ -339,36 +382,56 @@ static BaseType_t prvGetFreeConnection( void );
 static void prvReturnConnection( UBaseType_t uxBrokerNumber );
 
 /**
- * @brief Stores the notification data in one of the available buffers in MQTTBrokerConnection_t.
+ * @brief Stores the notification data in a free entry of the in-flight operations table.
  *
- * Finds an empty buffer from xWaitingTasks in MQTTBrokerConnection_t to store the notification data
- * (empty buffer is identified by the NULL value of xTaskToNotify). If it finds a buffer, it stores the
- * notification data from the event data and returns the pointer to the buffer. If it fails to find an
- * empty buffer, it returns NULL.
+ * Takes the first entry from the list of free entries in MQTTBrokerConnection_t,
+ * stores the notification data from the event data in it and assigns the packet
+ * identifier to use for the operation. If all the entries are in use, it returns NULL.
  *
  * @param[in] pxConnection The MQTTBrokerConnection_t corresponding to the MQTT broker connection the event is for.
  * @param[in] pxEventData The event data as posted by application task to the command queue.
  *
- * @return Pointer to the buffer used to store notification data or NULL if all buffers are in use.
+ * @return Pointer to the entry used to store notification data or NULL if all entries are in use.
  */
-static MQTTNotificationData_t * prvStoreNotificationData( MQTTBrokerConnection_t * const pxConnection,
-                                                          const MQTTEventData_t * const pxEventData );
+static MQTTInFlightOperation_t * prvStoreNotificationData( MQTTBrokerConnection_t * const pxConnection,
+                                                           const MQTTEventData_t * const pxEventData );
 
 /**
- * @brief Retrieves the notification data matching the given packet identifier.
+ * @brief Retrieves the in-flight operation matching the given packet identifier.
  *
- * Whenever we receive a message from the MQTT Core library, we need to check if any task is waiting
- * for it and accordingly notify it. This functions iterates over all the waiting tasks ( i.e. xWaitingTasks )
- * in MQTTBrokerConnection_t and tries to find a notification data having message identifier with top 16
- * bits matching the received packet identifier from the Core library.
+ * Whenever we receive a message from the MQTT Core library, we need to check if any operation is
+ * waiting for it. The packet identifier selects the only entry of the in-flight operations table
+ * which can hold the operation, so no search is needed.
  *
  * @param[in] pxConnection The MQTTBrokerConnection_t
  * @param[in] usPacketIdentifier The packet identifier.
  *
- * @return Pointer to the buffer containing the notification data if a task is waiting, NULL otherwise.
+ * @return Pointer to the entry of the operation if one is waiting, NULL otherwise.
+ */
+static MQTTInFlightOperation_t * prvRetrieveNotificationData( MQTTBrokerConnection_t * const pxConnection,
+                                                              uint16_t usPacketIdentifier );
+
+/**
+ * @brief Returns an entry of the in-flight operations table to the list of free entries.
+ *
+ * @param[in] pxConnection The MQTTBrokerConnection_t the entry belongs to.
+ * @param[in] pxOperation The entry to free.
  */
-static MQTTNotificationData_t * prvRetrieveNotificationData( MQTTBrokerConnection_t * const pxConnection,
-                                                             uint16_t usPacketIdentifier );
+static void prvReleaseNotificationData( MQTTBrokerConnection_t * const pxConnection,
+                                        MQTTInFlightOperation_t * const pxOperation );
+
+/**
+ * @brief Notifies the initiator of an in-flight operation and frees its entry.
+ *
+ * @param[in] pxConnection The MQTTBrokerConnection_t the operation belongs to.
+ * @param[in] pxOperation The entry of the completed operation.
+ * @param[in] eNotificationCode Notification code about the result of the operation.
+ * @param[in] uxStatus Status of the operation (pdPASS/pdFAIL).
+ */
+static void prvCompleteOperation( MQTTBrokerConnection_t * const pxConnection,
+                                  MQTTInFlightOperation_t * const pxOperation,
+                                  MQTTNotifyCodes_t xNotificationCode,
+                                  UBaseType_t uxStatus );
 
 /**
  * @brief Sets up the connection as per the parameters in event data.
@@ -396,8 +459,9 @@ static void prvGracefulSocketClose( MQTTBrokerConnection_t * const pxConnection
 /**
  * @brief The callback registered with the socket to get notified of the available data to read on the socket.
  *
- * This function just posts a eMQTTServiceSocket request to the MQTT command queue to
- * unblock the MQTT task in order to ensure that the available data is read and processed.
+ * This function marks the connection of the socket as ready to read and posts a
+ * eMQTTServiceSocket request to the MQTT command queue to unblock the MQTT task in
+ * order to ensure that the available data is read and processed.
  *
  * @param[in] pxSocket The socket on which the data is available for reading.
  */
@@ -498,6 +562,9 @@ static void prvProcessReceivedDisconnect( MQTTBrokerConnection_t * const pxConne
  * queue. Next 15 bits contain the status code. Last bit contains the status - 1 for pdPASS and 0
  * for pdFAIL.
  *
+ * Asynchronous operations have no task to notify. Their completion callback is invoked instead with
+ * the return code the blocking API would have returned.
+ *
  * @param[in] pxNotificationData Notification data containing the information about the task to be notified.
  * @param[in] eNotificationCode Notification code about the result of the operation.
  * @param[in] uxStatus Status of the operation (pdPASS/pdFAIL).
@@ -509,13 +576,18 @@ static void prvNotifyRequestingTask( MQTTNotificationData_t * const pxNotificati
 /**
  * @brief Called on each iteration of the MQTT task to service connected sockets.
  *
- * For all the connected sockets, it reads the available data and passes it to the
- * MQTT Core library. It also invokes the MQTT_Periodic function of the core library
- * to ensure regular timeout and keep alive processing.
+ * For the connected sockets which are marked ready by the socket wakeup callback,
+ * or for all of them when xPollAllSockets is pdTRUE, it reads the available data
+ * and passes it to the MQTT Core library. It also invokes the MQTT_Periodic function
+ * of the core library for the connections which need it, to ensure regular timeout
+ * and keep alive processing.
+ *
+ * @param[in] xPollAllSockets Whether to read from all the connected sockets, for
+ * the platforms which cannot wake up the MQTT task when data is received.
  *
  * @return Time in ticks when the next invocation of MQTT_Periodic is required.
  */
-static TickType_t prvManageConnections( void );
+static TickType_t prvManageConnections( BaseType_t xPollAllSockets );
 
 /**
  * @brief Initiates the MQTT Connect operation.
@@ -607,12 +679,51 @@ static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData );
  */
 static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEventData );
 
+/**
+ * @brief Posts the event to the command queue without waiting for the result.
+ *
+ * Sets the message identifier and creation timestamp of the event, returns the
+ * operation handle and then posts the event to the command queue. The handle is
+ * returned before posting as the operation may complete before this function
+ * returns.
+ *
+ * @param[in] pxEventData The Event to be sent to the command queue.
+ * @param[in] xTicksToWait Maximum time to wait for space in the command queue.
+ * @param[out] pxOperationHandle Output parameter to return the handle of the operation. Can be NULL.
+ *
+ * @return eMQTTAgentSuccess if the event was posted, eMQTTAgentFailure otherwise.
+ */
+static MQTTAgentReturnCode_t prvPostCommandToMQTTTask( MQTTEventData_t * pxEventData,
+                                                       TickType_t xTicksToWait,
+                                                       MQTTAgentOperationHandle_t * const pxOperationHandle );
+
+/**
+ * @brief Posts an asynchronous operation to the command queue.
+ *
+ * The result of the operation is reported through the completion callback instead
+ * of a task notification. If called from the MQTT task (i.e. from a callback), the
+ * function does not wait for space in the command queue as only the MQTT task
+ * empties it.
+ *
+ * @param[in] pxEventData The Event to be sent to the command queue.
+ * @param[in] pxCompletionCallback The callback to invoke with the result of the operation.
+ * @param[in] pvCompletionContext Passed as it is to pxCompletionCallback.
+ * @param[out] pxOperationHandle Output parameter to return the handle of the operation. Can be NULL.
+ *
+ * @return eMQTTAgentSuccess if the event was posted, eMQTTAgentFailure otherwise.
+ */
+static MQTTAgentReturnCode_t prvSendAsyncCommandToMQTTTask( MQTTEventData_t * pxEventData,
+                                                            MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                                            void * pvCompletionContext,
+                                                            MQTTAgentOperationHandle_t * const pxOperationHandle );
+
 /**
  * @brief Implements the task that manages the MQTT protocol.
  *
  * This function reads messages from the command queue and processes them.
- * It wakes up periodically and calls prvManageConnections() in order to
- * ensure regular timeout and keep alive processing by the MQTT Core library.
+ * It calls prvManageConnections() each time it wakes up, and sleeps until
+ * either a command or a socket wakeup is posted, or the nearest timeout or
+ * keep alive deadline of the MQTT Core library is reached.
  *
  * @param[in] pvParameters The parameters as specified when creating the task, NULL in this case.
  */
@@ -802,51 +913,79 @@ static void prvReturnConnection( UBaseType_t uxBrokerNumber )
 }
 /*-----------------------------------------------------------*/
 
-static MQTTNotificationData_t * prvStoreNotificationData( MQTTBrokerConnection_t * const pxConnection,
-                                                          const MQTTEventData_t * const pxEventData )
+static MQTTInFlightOperation_t * prvStoreNotificationData( MQTTBrokerConnection_t * const pxConnection,
+                                                           const MQTTEventData_t * const pxEventData )
 {
-    UBaseType_t x;
-    MQTTNotificationData_t * pxNotificationData = NULL;
+    uint32_t ulPacketIdentifier;
+    MQTTInFlightOperation_t * pxOperation = NULL;
 
-    /* Iterate over all the buffers to find an unused one. Unused
-    * buffer is identified by the NULL value of xTaskToNotify. */
-    for( x = 0; x < ( UBaseType_t ) mqttconfigMAX_PARALLEL_OPS; x++ )
+    /* Take the first entry from the list of free entries, if any. */
+    if( pxConnection->usFirstFreeOperation != mqttNO_FREE_OPERATION )
     {
-        if( pxConnection->xWaitingTasks[ x ].xTaskToNotify == NULL )
+        pxOperation = &( pxConnection->xInFlightOperations[ pxConnection->usFirstFreeOperation ] );
+        pxConnection->usFirstFreeOperation = pxOperation->usNextFreeOperation;
+        pxOperation->usNextFreeOperation = mqttOPERATION_IN_USE;
+
+        /* Move on to the next packet identifier of this entry, wrapping
+         * back to the first one before exceeding 16 bits. Packet identifier
+         * 0 is not permitted by the MQTT protocol. */
+        ulPacketIdentifier = ( uint32_t ) pxOperation->usPacketIdentifier + ( uint32_t ) mqttconfigMAX_PARALLEL_OPS;
+
+        if( ( pxOperation->usPacketIdentifier == ( uint16_t ) 0 ) || ( ulPacketIdentifier > ( uint32_t ) 0xFFFF ) )
         {
-            /* We found one unused buffer - copy the notification data
-             * and return. */
-            pxNotificationData = &( pxConnection->xWaitingTasks[ x ] );
-            memcpy( pxNotificationData, &( pxEventData->xNotificationData ), sizeof( MQTTNotificationData_t ) );
-            break;
+            ulPacketIdentifier = ( uint32_t ) ( pxOperation - pxConnection->xInFlightOperations ) + ( uint32_t ) 1;
         }
+
+        pxOperation->usPacketIdentifier = ( uint16_t ) ulPacketIdentifier;
+        memcpy( &( pxOperation->xNotificationData ), &( pxEventData->xNotificationData ), sizeof( MQTTNotificationData_t ) );
     }
 
-    return pxNotificationData;
+    return pxOperation;
 }
 /*-----------------------------------------------------------*/
 
-static MQTTNotificationData_t * prvRetrieveNotificationData( MQTTBrokerConnection_t * const pxConnection,
-                                                             uint16_t usPacketIdentifier )
+static MQTTInFlightOperation_t * prvRetrieveNotificationData( MQTTBrokerConnection_t * const pxConnection,
+                                                              uint16_t usPacketIdentifier )
 {
-    UBaseType_t x;
-    MQTTNotificationData_t * pxNotificationData = NULL;
+    MQTTInFlightOperation_t * pxOperation = NULL;
+    MQTTInFlightOperation_t * pxCandidate;
 
-    /* Iterate over all the buffers to see if there is one matching the
-     * packet identifier. Note that the packet identifier constitutes of the
-     * top 16 bits of the message identifier stored in the notification data. */
-    for( x = 0; x < ( UBaseType_t ) mqttconfigMAX_PARALLEL_OPS; x++ )
+    /* The packet identifier selects the only entry which can hold the
+     * operation. The entry matches if it is in use and still waiting for
+     * this packet identifier. */
+    if( usPacketIdentifier != ( uint16_t ) 0 )
     {
-        if( ( pxConnection->xWaitingTasks[ x ].xTaskToNotify != NULL ) &&
-            ( usPacketIdentifier == ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxConnection->xWaitingTasks[ x ].ulMessageIdentifier ) ) ) )
+        pxCandidate = &( pxConnection->xInFlightOperations[ ( ( uint32_t ) usPacketIdentifier - ( uint32_t ) 1 ) % ( uint32_t ) mqttconfigMAX_PARALLEL_OPS ] );
+
+        if( ( pxCandidate->usNextFreeOperation == mqttOPERATION_IN_USE ) &&
+            ( pxCandidate->usPacketIdentifier == usPacketIdentifier ) )
         {
-            /* We found the notification data, return it. */
-            pxNotificationData = &( pxConnection->xWaitingTasks[ x ] );
-            break;
+            pxOperation = pxCandidate;
         }
     }
 
-    return pxNotificationData;
+    return pxOperation;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseNotificationData( MQTTBrokerConnection_t * const pxConnection,
+                                        MQTTInFlightOperation_t * const pxOperation )
+{
+    /* Push the entry on to the list of free entries. */
+    pxOperation->xNotificationData.xTaskToNotify = NULL;
+    pxOperation->xNotificationData.pxCompletionCallback = NULL;
+    pxOperation->usNextFreeOperation = pxConnection->usFirstFreeOperation;
+    pxConnection->usFirstFreeOperation = ( uint16_t ) ( pxOperation - pxConnection->xInFlightOperations );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCompleteOperation( MQTTBrokerConnection_t * const pxConnection,
+                                  MQTTInFlightOperation_t * const pxOperation,
+                                  MQTTNotifyCodes_t xNotificationCode,
+                                  UBaseType_t uxStatus )
+{
+    prvNotifyRequestingTask( &( pxOperation->xNotificationData ), xNotificationCode, uxStatus );
+    prvReleaseNotificationData( pxConnection, pxOperation );
 }
 /*-----------------------------------------------------------*/
 
@@ -1036,6 +1175,7 @@ static void prvGracefulSocketClose( MQTTBrokerConnection_t * const pxConnection
     /* Close the socket. */
     ( void ) SOCKETS_Close( pxConnection->xSocket );
     pxConnection->xSocket = SOCKETS_INVALID_SOCKET;
+    pxConnection->xSocketReady = pdFALSE;
     mqttconfigDEBUG_LOG( ( "Socket closed.\r\n" ) );
 
     #if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
@@ -1051,15 +1191,34 @@ static void prvMQTTClientSocketWakeupCallback( Socket_t pxSocket )
 {
     const TickType_t xTicksToWait = pdMS_TO_TICKS( 20 );
     MQTTEventData_t xEventData;
-
-    /* Just to avoid compiler warnings.  The socket is not used but the function
-     * prototype cannot be changed because this is a callback function. */
-    ( void ) pxSocket;
+    UBaseType_t uxBrokerNumber;
+    BaseType_t xSocketFound = pdFALSE;
 
     /* Should not be possible to get here without the task having been
      * created! */
     configASSERT( xMQTTTaskHandle );
 
+    /* Mark the connection of the socket as ready, so that the MQTT task only
+     * reads from the sockets which have data. */
+    for( uxBrokerNumber = 0; uxBrokerNumber < ( UBaseType_t ) mqttconfigMAX_BROKERS; uxBrokerNumber++ )
+    {
+        if( xMQTTConnections[ uxBrokerNumber ].xSocket == pxSocket )
+        {
+            xMQTTConnections[ uxBrokerNumber ].xSocketReady = pdTRUE;
+            xSocketFound = pdTRUE;
+        }
+    }
+
+    /* The secure sockets layer of some platforms does not pass the socket
+     * returned by SOCKETS_Socket, in which case all the sockets are read. */
+    if( xSocketFound == pdFALSE )
+    {
+        for( uxBrokerNumber = 0; uxBrokerNumber < ( UBaseType_t ) mqttconfigMAX_BROKERS; uxBrokerNumber++ )
+        {
+            xMQTTConnections[ uxBrokerNumber ].xSocketReady = pdTRUE;
+        }
+    }
+
     /* A socket used by the MQTT task may need attention.  Send an event
      * to the MQTT task to make sure the task is not blocked on xCommandQueue.
      * There is only any need to do this if there are no messages already in the
@@ -1079,18 +1238,18 @@ static void prvMQTTClientSocketWakeupCallback( Socket_t pxSocket )
 static void prvProcessReceivedCONNACK( MQTTBrokerConnection_t * const pxConnection,
                                        const MQTTEventCallbackParams_t * const pxParams )
 {
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
 
     /* Retrieve the notification data for the task which initiated the Connect operation.*/
-    pxNotificationData = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTConnACKData.usPacketIdentifier );
+    pxOperation = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTConnACKData.usPacketIdentifier );
 
     /* If there is no task waiting for it, ignore it. */
-    if( pxNotificationData != NULL )
+    if( pxOperation != NULL )
     {
         if( pxParams->u.xMQTTConnACKData.xConnACKReturnCode == eMQTTConnACKConnectionAccepted )
         {
             mqttconfigDEBUG_LOG( ( "MQTT Connect was accepted. Connection established.\r\n" ) );
-            prvNotifyRequestingTask( pxNotificationData, eMQTTCONNACKConnectionAccepted, pdPASS );
+            prvCompleteOperation( pxConnection, pxOperation, eMQTTCONNACKConnectionAccepted, pdPASS );
         }
         else
         {
@@ -1111,23 +1270,23 @@ static void prvProcessReceivedCONNACK( MQTTBrokerConnection_t * const pxConnecti
 static void prvProcessReceivedSUBACK( MQTTBrokerConnection_t * const pxConnection,
                                       const MQTTEventCallbackParams_t * const pxParams )
 {
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
 
     /* Retrieve the notification data for the task which initiated the Subscribe operation.*/
-    pxNotificationData = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTSubACKData.usPacketIdentifier );
+    pxOperation = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTSubACKData.usPacketIdentifier );
 
     /* If there is no task waiting for it, ignore it. */
-    if( pxNotificationData != NULL )
+    if( pxOperation != NULL )
     {
         if( pxParams->u.xMQTTSubACKData.xSubACKReturnCode != eMQTTSubACKFailure )
         {
             mqttconfigDEBUG_LOG( ( "MQTT Subscribe was accepted. Subscribed.\r\n" ) );
-            prvNotifyRequestingTask( pxNotificationData, eMQTTSUBACKSubscriptionAccepted, pdPASS );
+            prvCompleteOperation( pxConnection, pxOperation, eMQTTSUBACKSubscriptionAccepted, pdPASS );
         }
         else
         {
             mqttconfigDEBUG_LOG( ( "MQTT Subscribe was rejected.\r\n" ) );
-            prvNotifyRequestingTask( pxNotificationData, eMQTTSUBACKSubscriptionRejected, pdFAIL );
+            prvCompleteOperation( pxConnection, pxOperation, eMQTTSUBACKSubscriptionRejected, pdFAIL );
         }
     }
 }
@@ -1136,17 +1295,17 @@ static void prvProcessReceivedSUBACK( MQTTBrokerConnection_t * const pxConnectio
 static void prvProcessReceivedUNSUBACK( MQTTBrokerConnection_t * const pxConnection,
                                         const MQTTEventCallbackParams_t * const pxParams )
 {
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
 
     /* Retrieve the notification data for the task which initiated the Unsubscribe operation.*/
-    pxNotificationData = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTUnSubACKData.usPacketIdentifier );
+    pxOperation = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTUnSubACKData.usPacketIdentifier );
 
     /* If there is no task waiting for it, ignore it. */
-    if( pxNotificationData != NULL )
+    if( pxOperation != NULL )
     {
         /* Otherwise inform the task. */
         mqttconfigDEBUG_LOG( ( "MQTT Unsubscribe was successful.\r\n" ) );
-        prvNotifyRequestingTask( pxNotificationData, eMQTTUNSUBACKReceived, pdPASS );
+        prvCompleteOperation( pxConnection, pxOperation, eMQTTUNSUBACKReceived, pdPASS );
     }
 }
 /*-----------------------------------------------------------*/
@@ -1154,17 +1313,17 @@ static void prvProcessReceivedUNSUBACK( MQTTBrokerConnection_t * const pxConnect
 static void prvProcessReceivedPUBACK( MQTTBrokerConnection_t * const pxConnection,
                                       const MQTTEventCallbackParams_t * const pxParams )
 {
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
 
     /* Retrieve the notification data for the task which initiated the Publish operation.*/
-    pxNotificationData = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTPubACKData.usPacketIdentifier );
+    pxOperation = prvRetrieveNotificationData( pxConnection, pxParams->u.xMQTTPubACKData.usPacketIdentifier );
 
     /* If there is no task waiting for it, ignore it. */
-    if( pxNotificationData != NULL )
+    if( pxOperation != NULL )
     {
         /* Otherwise inform the task. */
         mqttconfigDEBUG_LOG( ( "MQTT Publish was successful.\r\n" ) );
-        prvNotifyRequestingTask( pxNotificationData, eMQTTPUBACKReceived, pdPASS );
+        prvCompleteOperation( pxConnection, pxOperation, eMQTTPUBACKReceived, pdPASS );
     }
 }
 /*-----------------------------------------------------------*/
@@ -1195,17 +1354,17 @@ static BaseType_t prvProcessReceivedPublish( MQTTBrokerConnection_t * const pxCo
 static void prvProcessReceivedTimeout( MQTTBrokerConnection_t * const pxConnection,
                                        const MQTTEventCallbackParams_t * const pxParams )
 {
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
 
     /* Try to see if there is a task waiting for the operation which just timed out. */
-    pxNotificationData = prvRetrieveNotificationData( pxConnection, pxParams->u.xTimeoutData.usPacketIdentifier );
+    pxOperation = prvRetrieveNotificationData( pxConnection, pxParams->u.xTimeoutData.usPacketIdentifier );
 
     /* If there is no task waiting, just ignore. Otherwise
      * inform the task about the timeout. */
-    if( pxNotificationData != NULL )
+    if( pxOperation != NULL )
     {
         mqttconfigDEBUG_LOG( ( "MQTT Timeout.\r\n" ) );
-        prvNotifyRequestingTask( pxNotificationData, eMQTTOperationTimedOut, pdFAIL );
+        prvCompleteOperation( pxConnection, pxOperation, eMQTTOperationTimedOut, pdFAIL );
     }
 }
 /*-----------------------------------------------------------*/
@@ -1243,11 +1402,12 @@ static void prvProcessReceivedDisconnect( MQTTBrokerConnection_t * const pxConne
      * return code. */
     for( x = 0; x < ( UBaseType_t ) mqttconfigMAX_PARALLEL_OPS; x++ )
     {
-        if( pxConnection->xWaitingTasks[ x ].xTaskToNotify != NULL )
+        if( pxConnection->xInFlightOperations[ x ].usNextFreeOperation == mqttOPERATION_IN_USE )
         {
-            prvNotifyRequestingTask( &( pxConnection->xWaitingTasks[ x ] ),
-                                     eMQTTClientGotDisconnected,
-                                     pdFAIL );
+            prvCompleteOperation( pxConnection,
+                                  &( pxConnection->xInFlightOperations[ x ] ),
+                                  eMQTTClientGotDisconnected,
+                                  pdFAIL );
         }
     }
 }
@@ -1257,7 +1417,33 @@ static void prvNotifyRequestingTask( MQTTNotificationData_t * const pxNotificati
                                      MQTTNotifyCodes_t xNotificationCode,
                                      UBaseType_t uxStatus )
 {
-    if( pxNotificationData->xTaskToNotify != NULL )
+    MQTTAgentReturnCode_t xReturnCode;
+
+    if( pxNotificationData->pxCompletionCallback != NULL )
+    {
+        /* Report the same return code as the blocking API would have. */
+        if( uxStatus == ( UBaseType_t ) pdPASS )
+        {
+            xReturnCode = eMQTTAgentSuccess;
+        }
+        else if( xNotificationCode == eMQTTOperationTimedOut )
+        {
+            xReturnCode = eMQTTAgentTimeout;
+        }
+        else
+        {
+            xReturnCode = eMQTTAgentFailure;
+        }
+
+        mqttconfigDEBUG_LOG( ( "Completing asynchronous operation.\r\n" ) );
+        pxNotificationData->pxCompletionCallback( pxNotificationData->pvCompletionContext,
+                                                  ( MQTTAgentOperationHandle_t ) ( UBaseType_t ) pxNotificationData->ulMessageIdentifier, /*lint !e923 Opaque pointer. */
+                                                  xReturnCode );
+
+        /* The operation must only be completed once. */
+        pxNotificationData->pxCompletionCallback = NULL;
+    }
+    else if( pxNotificationData->xTaskToNotify != NULL )
     {
         /* ulMessageIdentifier only uses the top 16-bits.  The status code uses
          * the low 16-bits, of which the least significant bit is used to indicate
@@ -1269,7 +1455,7 @@ static void prvNotifyRequestingTask( MQTTNotificationData_t * const pxNotificati
         pxNotificationData->ulMessageIdentifier |= uxStatus;
 
         /* Notify the task. */
-        ( void ) xTaskNotify( pxNotificationData->xTaskToNotify, pxNotificationData->ulMessageIdentifier, eSetValueWithoutOverwrite );
+        ( void ) xTaskNotifyIndexed( pxNotificationData->xTaskToNotify, mqttconfigNOTIFICATION_INDEX, pxNotificationData->ulMessageIdentifier, eSetValueWithoutOverwrite );
 
         /* Free up the buffer for further use. */
         pxNotificationData->xTaskToNotify = NULL;
@@ -1277,13 +1463,13 @@ static void prvNotifyRequestingTask( MQTTNotificationData_t * const pxNotificati
 }
 /*-----------------------------------------------------------*/
 
-static TickType_t prvManageConnections( void )
+static TickType_t prvManageConnections( BaseType_t xPollAllSockets )
 {
     UBaseType_t uxBrokerNumber;
     MQTTBrokerConnection_t * pxConnection;
     BaseType_t xAnyConnectedClient = pdFALSE;
     int32_t lBytesReceived;
-    TickType_t xNextMQTTPeriodicInvokeTicks, xNextTimeoutTicks = portMAX_DELAY;
+    TickType_t xNextTimeoutTicks = portMAX_DELAY;
     uint64_t xTickCount = 0;
 
     /* For each broker the MQTT task might be connected to. */
@@ -1291,9 +1477,14 @@ static TickType_t prvManageConnections( void )
     {
         pxConnection = &( xMQTTConnections[ uxBrokerNumber ] );
 
-        /* Process only the connected clients. */
-        if( pxConnection->xSocket != SOCKETS_INVALID_SOCKET )
+        /* Process only the connected clients which may have data. */
+        if( ( pxConnection->xSocket != SOCKETS_INVALID_SOCKET ) &&
+            ( ( pxConnection->xSocketReady != pdFALSE ) || ( xPollAllSockets == pdTRUE ) ) )
         {
+            /* Clear the flag before reading, so that data which arrives
+             * after the read sets it again. */
+            pxConnection->xSocketReady = pdFALSE;
+
             /* Read data from the socket. */
             lBytesReceived = SOCKETS_Recv( pxConnection->xSocket, pxConnection->ucRxBuffer, mqttconfigRX_BUFFER_SIZE, 0 );
 
@@ -1304,22 +1495,26 @@ static TickType_t prvManageConnections( void )
 
                 /* Some data was received on this socket and we do not
                  * know if there is more data available. Therefore we
-                 * set xNextTimeoutTicks to zero which ensures that we
-                 * do not block on the command queue and try to read
-                 * again from this socket on the next invocation of
-                 * prvManageConnections. This way we ensure that we keep
-                 * processing commands received on the command queue
-                 * between calls to SOCKETS_Recv. As a result, a socket
-                 * receiving lots of data continuously does not starve
-                 * the command processing. */
+                 * keep the socket marked ready and set xNextTimeoutTicks
+                 * to zero which ensures that we do not block on the
+                 * command queue and try to read again from this socket
+                 * on the next invocation of prvManageConnections. This
+                 * way we ensure that we keep processing commands received
+                 * on the command queue between calls to SOCKETS_Recv. As
+                 * a result, a socket receiving lots of data continuously
+                 * does not starve the command processing. */
+                pxConnection->xSocketReady = pdTRUE;
                 xNextTimeoutTicks = 0;
+
+                /* The received data may have changed the pending ACKs. */
+                pxConnection->xNextPeriodicTickCount = 0;
             }
             else if( lBytesReceived < 0 )
             {
                 /* A negative return value from SOCKETS_Recv indicates error.
                  * Since the socket is marked non-blocking, read can potentially
                  * return SOCKETS_EWOULDBLOCK in which case we will re-try to
-                 * read on the next execution of this function. In case of any
+                 * read when the socket is marked ready again. In case of any
                  * other error, we disconnect. */
                 if( lBytesReceived != SOCKETS_EWOULDBLOCK )
                 {
@@ -1328,6 +1523,7 @@ static TickType_t prvManageConnections( void )
                      * ( prvProcessReceivedDisconnect function ) from the core
                      * MQTT library. */
                     ( void ) MQTT_Disconnect( &( pxConnection->xMQTTContext ) );
+                    pxConnection->xNextPeriodicTickCount = 0;
                 }
             }
             else
@@ -1347,11 +1543,19 @@ static TickType_t prvManageConnections( void )
         /* Get the current tick count. */
         prvMQTTGetTicks( &xTickCount );
 
-        /* Invoke MQTT_Periodic. */
-        xNextMQTTPeriodicInvokeTicks = ( TickType_t ) MQTT_Periodic( &( pxConnection->xMQTTContext ), xTickCount );
+        /* Invoke MQTT_Periodic only when it is due, or when the state of the
+         * connection may have changed since it was last invoked. */
+        if( xTickCount >= pxConnection->xNextPeriodicTickCount )
+        {
+            pxConnection->xNextPeriodicTickCount = xTickCount + ( uint64_t ) MQTT_Periodic( &( pxConnection->xMQTTContext ), xTickCount );
+        }
 
-        /* Update the next timeout value. */
-        xNextTimeoutTicks = configMIN( xNextTimeoutTicks, xNextMQTTPeriodicInvokeTicks );
+        /* Update the next timeout value, so that the MQTT task sleeps until
+         * the nearest deadline of all the connections. */
+        if( ( pxConnection->xNextPeriodicTickCount - xTickCount ) < ( uint64_t ) xNextTimeoutTicks )
+        {
+            xNextTimeoutTicks = ( TickType_t ) ( pxConnection->xNextPeriodicTickCount - xTickCount );
+        }
     }
 
     /* The MQTT task must not block for more than mqttconfigMQTT_TASK_MAX_BLOCK_TICKS
@@ -1369,17 +1573,17 @@ static TickType_t prvManageConnections( void )
 static void prvInitiateMQTTConnect( MQTTEventData_t * const pxEventData )
 {
     BaseType_t xStatus = pdFAIL;
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
     MQTTConnectParams_t xConnectParams;
     MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
 
     /* Store notification data. */
-    pxNotificationData = prvStoreNotificationData( pxConnection, pxEventData );
+    pxOperation = prvStoreNotificationData( pxConnection, pxEventData );
 
-    /* If a free buffer was not available to store the  notification data
-     * (i.e. mqttconfigMAX_PARALLEL_OPS tasks are already in progress), fail
-     * immediately. */
-    if( pxNotificationData != NULL )
+    /* If a free entry was not available to store the notification data
+     * (i.e. mqttconfigMAX_PARALLEL_OPS operations are already in progress),
+     * fail immediately. */
+    if( pxOperation != NULL )
     {
         /* Store the user data and callback. */
         pxConnection->pvUserData = pxEventData->u.pxConnectParams->pvUserData;
@@ -1414,9 +1618,13 @@ static void prvInitiateMQTTConnect( MQTTEventData_t * const pxEventData )
             xConnectParams.usKeepAliveIntervalSeconds = mqttconfigKEEP_ALIVE_INTERVAL_SECONDS;
             xConnectParams.ulKeepAliveActualIntervalTicks = mqttconfigKEEP_ALIVE_ACTUAL_INTERVAL_TICKS;
             xConnectParams.ulPingRequestTimeoutTicks = mqttconfigKEEP_ALIVE_TIMEOUT_TICKS;
-            xConnectParams.usPacketIdentifier = ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) );
+            xConnectParams.usPacketIdentifier = pxOperation->usPacketIdentifier;
             xConnectParams.ulTimeoutTicks = pxEventData->xTicksToWait;
 
+            #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+                xConnectParams.xCleanSession = ( ( pxEventData->u.pxConnectParams->xFlags & mqttagentRESUME_SESSION ) != 0 ) ? eMQTTFalse : eMQTTTrue;
+            #endif
+
             if( MQTT_Connect( &( pxConnection->xMQTTContext ), &( xConnectParams ) ) != eMQTTSuccess )
             {
                 mqttconfigDEBUG_LOG( ( "MQTT_Connect failed!\r\n" ) );
@@ -1441,10 +1649,10 @@ static void prvInitiateMQTTConnect( MQTTEventData_t * const pxEventData )
          * the Connect operation. */
         prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTCONNCouldNotBeSent, pdFAIL );
 
-        /* If a buffer was used to store notification data, return it. */
-        if( pxNotificationData != NULL )
+        /* If an entry was used to store notification data, return it. */
+        if( pxOperation != NULL )
         {
-            pxNotificationData->xTaskToNotify = NULL;
+            prvReleaseNotificationData( pxConnection, pxOperation );
         }
     }
 }
@@ -1474,27 +1682,27 @@ static void prvInitiateMQTTDisconnect( MQTTEventData_t * const pxEventData )
 static void prvInitiateMQTTSubscribe( MQTTEventData_t * const pxEventData )
 {
     BaseType_t xStatus = pdFAIL;
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
     MQTTSubscribeParams_t xSubscribeParams;
     MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
 
     /* Store notification data. */
-    pxNotificationData = prvStoreNotificationData( pxConnection, pxEventData );
+    pxOperation = prvStoreNotificationData( pxConnection, pxEventData );
 
-    /* If a free buffer was not available to store the  notification data
-     * (i.e. mqttconfigMAX_PARALLEL_OPS tasks are already in progress), fail
-     * immediately. */
-    if( pxNotificationData != NULL )
+    /* If a free entry was not available to store the notification data
+     * (i.e. mqttconfigMAX_PARALLEL_OPS operations are already in progress),
+     * fail immediately. */
+    if( pxOperation != NULL )
     {
         /* Setup subscribe parameters and call the Core library subscribe function. */
-        xSubscribeParams.pucTopic = pxEventData->u.pxSubscribeParams->pucTopic;
-        xSubscribeParams.usTopicLength = pxEventData->u.pxSubscribeParams->usTopicLength;
-        xSubscribeParams.xQos = pxEventData->u.pxSubscribeParams->xQoS;
-        xSubscribeParams.usPacketIdentifier = ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) );
+        xSubscribeParams.pucTopic = pxEventData->u.xSubscribeParams.pucTopic;
+        xSubscribeParams.usTopicLength = pxEventData->u.xSubscribeParams.usTopicLength;
+        xSubscribeParams.xQos = pxEventData->u.xSubscribeParams.xQoS;
+        xSubscribeParams.usPacketIdentifier = pxOperation->usPacketIdentifier;
         xSubscribeParams.ulTimeoutTicks = pxEventData->xTicksToWait;
         #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
-            xSubscribeParams.pvPublishCallbackContext = pxEventData->u.pxSubscribeParams->pvPublishCallbackContext;
-            xSubscribeParams.pxPublishCallback = pxEventData->u.pxSubscribeParams->pxPublishCallback;
+            xSubscribeParams.pvPublishCallbackContext = pxEventData->u.xSubscribeParams.pvPublishCallbackContext;
+            xSubscribeParams.pxPublishCallback = pxEventData->u.xSubscribeParams.pxPublishCallback;
         #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
         if( MQTT_Subscribe( &( pxConnection->xMQTTContext ), &( xSubscribeParams ) ) == eMQTTSuccess )
@@ -1508,7 +1716,7 @@ static void prvInitiateMQTTSubscribe( MQTTEventData_t * const pxEventData )
     }
     else
     {
-        mqttconfigDEBUG_LOG( ( "Could not get a buffer to store notification data. Too many parallel tasks!\r\n" ) );
+        mqttconfigDEBUG_LOG( ( "Could not get an entry to store notification data. Too many parallel operations!\r\n" ) );
     }
 
     if( xStatus == pdFAIL )
@@ -1517,10 +1725,10 @@ static void prvInitiateMQTTSubscribe( MQTTEventData_t * const pxEventData )
          * the Subscribe operation. */
         prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTSUBCouldNotBeSent, pdFAIL );
 
-        /* If a buffer was used to store notification data, return it. */
-        if( pxNotificationData != NULL )
+        /* If an entry was used to store notification data, return it. */
+        if( pxOperation != NULL )
         {
-            pxNotificationData->xTaskToNotify = NULL;
+            prvReleaseNotificationData( pxConnection, pxOperation );
         }
     }
 }
@@ -1529,23 +1737,23 @@ static void prvInitiateMQTTSubscribe( MQTTEventData_t * const pxEventData )
 static void prvInitiateMQTTUnSubscribe( MQTTEventData_t * const pxEventData )
 {
     BaseType_t xStatus = pdFAIL;
-    MQTTNotificationData_t * pxNotificationData;
+    MQTTInFlightOperation_t * pxOperation;
     MQTTUnsubscribeParams_t xUnsubscribeParams;
     MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
 
     /* Store notification data. */
-    pxNotificationData = prvStoreNotificationData( pxConnection, pxEventData );
+    pxOperation = prvStoreNotificationData( pxConnection, pxEventData );
 
-    /* If a free buffer was not available to store the  notification data
-     * (i.e. mqttconfigMAX_PARALLEL_OPS tasks are already in progress), fail
-     * immediately. */
-    if( pxNotificationData != NULL )
+    /* If a free entry was not available to store the notification data
+     * (i.e. mqttconfigMAX_PARALLEL_OPS operations are already in progress),
+     * fail immediately. */
+    if( pxOperation != NULL )
     {
         /* Setup unsubscribe parameters and call the Core library unsubscribe
          * function. */
-        xUnsubscribeParams.pucTopic = pxEventData->u.pxUnsubscribeParams->pucTopic;
-        xUnsubscribeParams.usTopicLength = pxEventData->u.pxUnsubscribeParams->usTopicLength;
-        xUnsubscribeParams.usPacketIdentifier = ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) );
+        xUnsubscribeParams.pucTopic = pxEventData->u.xUnsubscribeParams.pucTopic;
+        xUnsubscribeParams.usTopicLength = pxEventData->u.xUnsubscribeParams.usTopicLength;
+        xUnsubscribeParams.usPacketIdentifier = pxOperation->usPacketIdentifier;
         xUnsubscribeParams.ulTimeoutTicks = pxEventData->xTicksToWait;
 
         if( MQTT_Unsubscribe( &( pxConnection->xMQTTContext ), &( xUnsubscribeParams ) ) == eMQTTSuccess )
@@ -1559,7 +1767,7 @@ static void prvInitiateMQTTUnSubscribe( MQTTEventData_t * const pxEventData )
     }
     else
     {
-        mqttconfigDEBUG_LOG( ( "Could not get a buffer to store notification data. Too many parallel tasks!\r\n" ) );
+        mqttconfigDEBUG_LOG( ( "Could not get an entry to store notification data. Too many parallel operations!\r\n" ) );
     }
 
     if( xStatus == pdFAIL )
@@ -1568,10 +1776,10 @@ static void prvInitiateMQTTUnSubscribe( MQTTEventData_t * const pxEventData )
          * the Unsubscribe operation. */
         prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTUNSUBCouldNotBeSent, pdFAIL );
 
-        /* If a buffer was used to store notification data, return it. */
-        if( pxNotificationData != NULL )
+        /* If an entry was used to store notification data, return it. */
+        if( pxOperation != NULL )
         {
-            pxNotificationData->xTaskToNotify = NULL;
+            prvReleaseNotificationData( pxConnection, pxOperation );
         }
     }
 }
@@ -1580,31 +1788,34 @@ static void prvInitiateMQTTUnSubscribe( MQTTEventData_t * const pxEventData )
 static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData )
 {
     BaseType_t xStatus = pdFAIL;
-    MQTTNotificationData_t * pxNotificationData = NULL;
+    MQTTInFlightOperation_t * pxOperation = NULL;
     MQTTPublishParams_t xPublishParams;
     MQTTBrokerConnection_t * pxConnection = &( xMQTTConnections[ pxEventData->uxBrokerNumber ] );
 
     /* No need to store  notification data in case of QoS0 because
      * there will not be any ACK. */
-    if( pxEventData->u.pxPublishParams->xQoS != eMQTTQoS0 )
+    if( pxEventData->u.xPublishParams.xQoS != eMQTTQoS0 )
     {
-        pxNotificationData = prvStoreNotificationData( pxConnection, pxEventData );
+        pxOperation = prvStoreNotificationData( pxConnection, pxEventData );
     }
 
-    /* If a free buffer was not available to store the notification data
-     * (i.e. mqttconfigMAX_PARALLEL_OPS tasks are already in progress), fail
-     * immediately. We don't store notification data in case of QoS0, so
+    /* If a free entry was not available to store the notification data
+     * (i.e. mqttconfigMAX_PARALLEL_OPS operations are already in progress),
+     * fail immediately. We don't store notification data in case of QoS0, so
      * proceed anyways. */
-    if( ( pxNotificationData != NULL ) || ( pxEventData->u.pxPublishParams->xQoS == eMQTTQoS0 ) )
+    if( ( pxOperation != NULL ) || ( pxEventData->u.xPublishParams.xQoS == eMQTTQoS0 ) )
     {
         /* Setup publish parameters and call the Core library publish function. */
-        xPublishParams.pucTopic = pxEventData->u.pxPublishParams->pucTopic;
-        xPublishParams.usTopicLength = pxEventData->u.pxPublishParams->usTopicLength;
-        xPublishParams.xQos = pxEventData->u.pxPublishParams->xQoS;
-        xPublishParams.pvData = pxEventData->u.pxPublishParams->pvData;
-        xPublishParams.ulDataLength = pxEventData->u.pxPublishParams->ulDataLength;
-        xPublishParams.usPacketIdentifier = ( uint16_t ) ( mqttMESSAGE_IDENTIFIER_EXTRACT( pxEventData->xNotificationData.ulMessageIdentifier ) );
+        xPublishParams.pucTopic = pxEventData->u.xPublishParams.pucTopic;
+        xPublishParams.usTopicLength = pxEventData->u.xPublishParams.usTopicLength;
+        xPublishParams.xQos = pxEventData->u.xPublishParams.xQoS;
+        xPublishParams.pvData = pxEventData->u.xPublishParams.pvData;
+        xPublishParams.ulDataLength = pxEventData->u.xPublishParams.ulDataLength;
+        /* QoS0 publishes are not acknowledged and carry no packet identifier. */
+        xPublishParams.usPacketIdentifier = ( pxOperation != NULL ) ? pxOperation->usPacketIdentifier : ( uint16_t ) 0;
         xPublishParams.ulTimeoutTicks = pxEventData->xTicksToWait;
+        xPublishParams.pxReadFxn = NULL;
+        xPublishParams.pvReadContext = NULL;
 
         if( MQTT_Publish( &( pxConnection->xMQTTContext ), &( xPublishParams ) ) == eMQTTSuccess )
         {
@@ -1617,12 +1828,12 @@ static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData )
     }
     else
     {
-        mqttconfigDEBUG_LOG( ( "Could not get a buffer to store notification data. Too many parallel tasks!\r\n" ) );
+        mqttconfigDEBUG_LOG( ( "Could not get an entry to store notification data. Too many parallel operations!\r\n" ) );
     }
 
     /* In case of QoS0 successful publish, inform and unblock the task that
      * initiated the publish operation as no PUBACK is expected. */
-    if( ( xStatus == pdPASS ) && ( pxEventData->u.pxPublishParams->xQoS == eMQTTQoS0 ) )
+    if( ( xStatus == pdPASS ) && ( pxEventData->u.xPublishParams.xQoS == eMQTTQoS0 ) )
     {
         prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTPUBSent, pdPASS );
     }
@@ -1633,27 +1844,75 @@ static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData )
          * the Publish operation. */
         prvNotifyRequestingTask( &( pxEventData->xNotificationData ), eMQTTPUBCouldNotBeSent, pdFAIL );
 
-        /* If a buffer was used to store notification data, return it. */
-        if( pxNotificationData != NULL )
+        /* If an entry was used to store notification data, return it. */
+        if( pxOperation != NULL )
         {
-            pxNotificationData->xTaskToNotify = NULL;
+            prvReleaseNotificationData( pxConnection, pxOperation );
         }
     }
 }
 /*-----------------------------------------------------------*/
 
-static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEventData )
+static MQTTAgentReturnCode_t prvPostCommandToMQTTTask( MQTTEventData_t * pxEventData,
+                                                       TickType_t xTicksToWait,
+                                                       MQTTAgentOperationHandle_t * const pxOperationHandle )
 {
-    BaseType_t xReturn;
-    MQTTAgentReturnCode_t xReturnCode = eMQTTAgentFailure;
-    uint32_t ulReceivedMessageIdentifier;
+    MQTTAgentReturnCode_t xReturnCode = eMQTTAgentSuccess;
 
     /* Should not try to send commands until after the MQTT task has been
      * initialized, in which case the command queue will have been created. */
     configASSERT( xCommandQueue );
 
+    taskENTER_CRITICAL();
+    {
+        /* The message identifier is used to know which message is being
+         * acknowledged.  A critical region is used as a single message identifier
+         * variable is used by all connections. The identifier uses the top 16-bits
+         * of the 32-bit word, leaving the lowest 16-bits free for use by the MQTT
+         * task to return a status code. */
+        pxEventData->xNotificationData.ulMessageIdentifier = ulQueueMessageIdentifier;
+        ulQueueMessageIdentifier += mqttMESSAGE_IDENTIFIER_MIN;
+
+        if( ulQueueMessageIdentifier >= mqttMESSAGE_IDENTIFIER_MAX )
+        {
+            ulQueueMessageIdentifier = mqttMESSAGE_IDENTIFIER_MIN;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    /* Record the time at which this event is created. */
+    vTaskSetTimeOutState( &( pxEventData->xEventCreationTimestamp ) );
+
+    /* The MQTT task may complete the operation before the queue send
+     * returns, so the handle must be known first. */
+    if( pxOperationHandle != NULL )
+    {
+        *pxOperationHandle = ( MQTTAgentOperationHandle_t ) ( UBaseType_t ) pxEventData->xNotificationData.ulMessageIdentifier; /*lint !e923 Opaque pointer. */
+    }
+
+    /* The MQTT protocol is running in a separate task, to which commands
+     * are sent on a queue. */
+    mqttconfigDEBUG_LOG( ( "Sending command to MQTT task.\r\n" ) );
+
+    if( xQueueSendToBack( xCommandQueue, pxEventData, xTicksToWait ) == pdFALSE )
+    {
+        mqttconfigDEBUG_LOG( ( "Attempt to write to the MQTT command queue failed.\r\n" ) );
+        xReturnCode = eMQTTAgentFailure;
+    }
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
+static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEventData )
+{
+    MQTTAgentReturnCode_t xReturnCode = eMQTTAgentFailure;
+    uint32_t ulReceivedMessageIdentifier;
+
     /* Setup notification data. */
     pxEventData->xNotificationData.xTaskToNotify = xTaskGetCurrentTaskHandle();
+    pxEventData->xNotificationData.pxCompletionCallback = NULL;
+    pxEventData->xNotificationData.pvCompletionContext = NULL;
 
     /* Commands must not be sent from the MQTT task itself (which could be
      * the case if a command is sent from a callback function).  Otherwise
@@ -1661,38 +1920,13 @@ static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEvent
      * resulting in deadlock. */
     if( pxEventData->xNotificationData.xTaskToNotify != xMQTTTaskHandle )
     {
-        taskENTER_CRITICAL();
-        {
-            /* The message identifier is used to know which message is being
-             * acknowledged.  A critical region is used as a single message identifier
-             * variable is used by all connections. The identifier uses the top 16-bits
-             * of the 32-bit word, leaving the lowest 16-bits free for use by the MQTT
-             * task to return a status code. */
-            pxEventData->xNotificationData.ulMessageIdentifier = ulQueueMessageIdentifier;
-            ulQueueMessageIdentifier += mqttMESSAGE_IDENTIFIER_MIN;
-
-            if( ulQueueMessageIdentifier >= mqttMESSAGE_IDENTIFIER_MAX )
-            {
-                ulQueueMessageIdentifier = mqttMESSAGE_IDENTIFIER_MIN;
-            }
-        }
-        taskEXIT_CRITICAL();
-
-        /* Record the time at which this event is created. */
-        vTaskSetTimeOutState( &( pxEventData->xEventCreationTimestamp ) );
-
         /* The calling task is going to wait for a notification, so clear the
          * notifications state first.  This is probably not necessary as the task will
          * wait for a particular notification value, but is for maximum robustness. */
-        ( void ) xTaskNotifyStateClear( NULL );
+        ( void ) xTaskNotifyStateClearIndexed( NULL, mqttconfigNOTIFICATION_INDEX );
 
-        /* The MQTT protocol is running in a separate task, to which commands
-         * are sent on a queue, and a signal is sent back using a task
-         * notification. */
-        mqttconfigDEBUG_LOG( ( "Sending command to MQTT task.\r\n" ) );
-        xReturn = xQueueSendToBack( xCommandQueue, pxEventData, pxEventData->xTicksToWait );
-
-        if( xReturn != pdFALSE )
+        /* A signal is sent back from the MQTT task using a task notification. */
+        if( prvPostCommandToMQTTTask( pxEventData, pxEventData->xTicksToWait, NULL ) == eMQTTAgentSuccess )
         {
             /* Ensure ulReceivedMessageIdentifier does not accidentally equal
              * xEventData.ulMessageIdentifier as it will be checked to see if the
@@ -1707,7 +1941,7 @@ static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEvent
                  * block here forever and rely on the notification from the MQTT task
                  * to unblock us. Return value is ignored because in case of portMAX_DELAY
                  * the function will return only when a notification is received. */
-                ( void ) xTaskNotifyWait( 0UL, 0UL, &ulReceivedMessageIdentifier, portMAX_DELAY );
+                ( void ) xTaskNotifyWaitIndexed( mqttconfigNOTIFICATION_INDEX, 0UL, 0UL, &ulReceivedMessageIdentifier, portMAX_DELAY );
 
                 if( pxEventData->xNotificationData.ulMessageIdentifier == ( ulReceivedMessageIdentifier & mqttMESSAGE_IDENTIFIER_MASK ) )
                 {
@@ -1744,10 +1978,6 @@ static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEvent
                 }
             }
         }
-        else
-        {
-            mqttconfigDEBUG_LOG( ( "Attempt to write to the MQTT command queue failed.\r\n" ) );
-        }
     }
     else
     {
@@ -1759,18 +1989,51 @@ static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEvent
 }
 /*-----------------------------------------------------------*/
 
+static MQTTAgentReturnCode_t prvSendAsyncCommandToMQTTTask( MQTTEventData_t * pxEventData,
+                                                            MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                                            void * pvCompletionContext,
+                                                            MQTTAgentOperationHandle_t * const pxOperationHandle )
+{
+    TickType_t xTicksToWait = pxEventData->xTicksToWait;
+
+    /* The result is reported through the callback, so no task waits. */
+    pxEventData->xNotificationData.xTaskToNotify = NULL;
+    pxEventData->xNotificationData.pxCompletionCallback = pxCompletionCallback;
+    pxEventData->xNotificationData.pvCompletionContext = pvCompletionContext;
+
+    /* Only the MQTT task empties the command queue, so it must not wait for
+     * space in it. */
+    if( xTaskGetCurrentTaskHandle() == xMQTTTaskHandle )
+    {
+        xTicksToWait = 0;
+    }
+
+    return prvPostCommandToMQTTTask( pxEventData, xTicksToWait, pxOperationHandle );
+}
+/*-----------------------------------------------------------*/
+
 static void prvMQTTTask( void * pvParameters )
 {
     MQTTEventData_t xMQTTCommand;
     TickType_t xNextTimeoutTicks = 0;
+    BaseType_t xPollAllSockets;
 
     /* Remove compiler warnings about unused parameters. */
     ( void ) pvParameters;
 
     for( ; ; )
     {
+        /* All the sockets are polled when the MQTT task has blocked on the
+         * queue and the wait expired, for the platforms which cannot wake up
+         * the MQTT task when data is received. A zero wait means that some
+         * socket is still marked ready, so only the sockets marked ready are
+         * read. */
+        xPollAllSockets = ( xNextTimeoutTicks != ( TickType_t ) 0 ) ? pdTRUE : pdFALSE;
+
         if( xQueueReceive( xCommandQueue, &xMQTTCommand, xNextTimeoutTicks ) != pdFALSE )
         {
+            xPollAllSockets = pdFALSE;
+
             mqttconfigDEBUG_LOG( ( "Received message %x from queue.\r\n", xMQTTCommand.xNotificationData.ulMessageIdentifier ) );
 
             /* The connection index identifies the broker to communicate with -
@@ -1825,12 +2088,19 @@ static void prvMQTTTask( void * pvParameters )
                         mqttconfigDEBUG_LOG( ( "Unknown request received on command queue.\r\n" ) );
                         break;
                 }
+
+                /* The command may have added a pending ACK or sent a
+                 * message, so MQTT_Periodic must recompute its deadline. */
+                if( xMQTTCommand.xEventType != eMQTTServiceSocket )
+                {
+                    xMQTTConnections[ xMQTTCommand.uxBrokerNumber ].xNextPeriodicTickCount = 0;
+                }
             }
         }
 
         /* Process active connections each time the queue unblocks.  It might
          * be that the queue read timed out because a connection needs service. */
-        xNextTimeoutTicks = prvManageConnections();
+        xNextTimeoutTicks = prvManageConnections( xPollAllSockets );
     }
 }
 /*-----------------------------------------------------------*/
@@ -1884,18 +2154,38 @@ BaseType_t MQTT_AGENT_Init( void )
             xInitParams.xBufferPoolInterface.pxGetBufferFxn = mqttconfigGET_FREE_BUFFER_FXN;
             xInitParams.xBufferPoolInterface.pxReturnBufferFxn = mqttconfigRETURN_BUFFER_FXN;
 
+            #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+                #if ( mqttconfigINFLIGHT_STORE_USE_PAL == 1 )
+                    xInitParams.xInFlightStoreInterface.pvStoreContext = ( void * ) x; /*lint !e923 The cast is ok as we are passing the index of the client. */
+                    xInitParams.xInFlightStoreInterface.pxWriteFxn = prvPAL_MQTTStoreWrite;
+                    xInitParams.xInFlightStoreInterface.pxReadFxn = prvPAL_MQTTStoreRead;
+                    xInitParams.xInFlightStoreInterface.pxNextFxn = prvPAL_MQTTStoreNext;
+                    xInitParams.xInFlightStoreInterface.pxRemoveFxn = prvPAL_MQTTStoreRemove;
+                #else
+                    MQTT_RAMSTORE_Init( &( xMQTTConnections[ x ].xInFlightStore ) );
+                    xInitParams.xInFlightStoreInterface.pvStoreContext = &( xMQTTConnections[ x ].xInFlightStore );
+                    xInitParams.xInFlightStoreInterface.pxWriteFxn = MQTT_RAMSTORE_Write;
+                    xInitParams.xInFlightStoreInterface.pxReadFxn = MQTT_RAMSTORE_Read;
+                    xInitParams.xInFlightStoreInterface.pxNextFxn = MQTT_RAMSTORE_Next;
+                    xInitParams.xInFlightStoreInterface.pxRemoveFxn = MQTT_RAMSTORE_Remove;
+                #endif
+            #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
             if( MQTT_Init( &xMQTTConnections[ x ].xMQTTContext, &xInitParams ) != eMQTTSuccess )
             {
                 xReturnCode = pdFAIL;
                 break;
             }
 
-            /* Initialize waiting tasks list. */
+            /* Link all the in-flight operation entries into the list of
+             * free entries. The memset above cleared their packet identifiers. */
             for( y = 0; y < ( UBaseType_t ) mqttconfigMAX_PARALLEL_OPS; y++ )
             {
-                xMQTTConnections[ x ].xWaitingTasks[ y ].xTaskToNotify = NULL;
-                xMQTTConnections[ x ].xWaitingTasks[ y ].ulMessageIdentifier = 0;
+                xMQTTConnections[ x ].xInFlightOperations[ y ].usNextFreeOperation = ( uint16_t ) ( y + ( UBaseType_t ) 1 );
             }
+
+            xMQTTConnections[ x ].xInFlightOperations[ mqttconfigMAX_PARALLEL_OPS - 1 ].usNextFreeOperation = mqttNO_FREE_OPERATION;
+            xMQTTConnections[ x ].usFirstFreeOperation = 0;
         }
 
         /* ulQueueMessageIdentifier uses the top 16-bits of a 32-bit value, so
@@ -2011,7 +2301,7 @@ MQTTAgentReturnCode_t MQTT_AGENT_Subscribe( MQTTAgentHandle_t xMQTTHandle,
     xEventData.uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
     xEventData.xEventType = eMQTTSubscribeRequest;
     xEventData.xTicksToWait = xTimeoutTicks;
-    xEventData.u.pxSubscribeParams = pxSubscribeParams;
+    xEventData.u.xSubscribeParams = *pxSubscribeParams;
 
     /* Note that the notification data part of xEventData and
      * xEventCreationTimestamp are set in the following call. */
@@ -2033,7 +2323,7 @@ MQTTAgentReturnCode_t MQTT_AGENT_Unsubscribe( MQTTAgentHandle_t xMQTTHandle,
     xEventData.uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
     xEventData.xEventType = eMQTTUnsubscribeRequest;
     xEventData.xTicksToWait = xTimeoutTicks;
-    xEventData.u.pxUnsubscribeParams = pxUnsubscribeParams;
+    xEventData.u.xUnsubscribeParams = *pxUnsubscribeParams;
 
     /* Note that the notification data part of xEventData and
      * xEventCreationTimestamp are set in the following call. */
@@ -2055,7 +2345,7 @@ MQTTAgentReturnCode_t MQTT_AGENT_Publish( MQTTAgentHandle_t xMQTTHandle,
     xEventData.uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
     xEventData.xEventType = eMQTTPublishRequest;
     xEventData.xTicksToWait = xTimeoutTicks;
-    xEventData.u.pxPublishParams = pxPublishParams;
+    xEventData.u.xPublishParams = *pxPublishParams;
 
     /* Note that the notification data part of xEventData and
      * xEventCreationTimestamp are set in the following call. */
@@ -2066,6 +2356,69 @@ MQTTAgentReturnCode_t MQTT_AGENT_Publish( MQTTAgentHandle_t xMQTTHandle,
 }
 /*-----------------------------------------------------------*/
 
+MQTTAgentReturnCode_t MQTT_AGENT_SubscribeAsync( MQTTAgentHandle_t xMQTTHandle,
+                                                 const MQTTAgentSubscribeParams_t * const pxSubscribeParams,
+                                                 MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                                 void * pvCompletionContext,
+                                                 TickType_t xTimeoutTicks,
+                                                 MQTTAgentOperationHandle_t * const pxOperationHandle )
+{
+    MQTTEventData_t xEventData;
+
+    /* Setup the event to be sent to the command queue. */
+    xEventData.uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
+    xEventData.xEventType = eMQTTSubscribeRequest;
+    xEventData.xTicksToWait = xTimeoutTicks;
+    xEventData.u.xSubscribeParams = *pxSubscribeParams;
+
+    /* Note that the notification data part of xEventData and
+     * xEventCreationTimestamp are set in the following call. */
+    return prvSendAsyncCommandToMQTTTask( &xEventData, pxCompletionCallback, pvCompletionContext, pxOperationHandle );
+}
+/*-----------------------------------------------------------*/
+
+MQTTAgentReturnCode_t MQTT_AGENT_UnsubscribeAsync( MQTTAgentHandle_t xMQTTHandle,
+                                                   const MQTTAgentUnsubscribeParams_t * const pxUnsubscribeParams,
+                                                   MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                                   void * pvCompletionContext,
+                                                   TickType_t xTimeoutTicks,
+                                                   MQTTAgentOperationHandle_t * const pxOperationHandle )
+{
+    MQTTEventData_t xEventData;
+
+    /* Setup the event to be sent to the command queue. */
+    xEventData.uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
+    xEventData.xEventType = eMQTTUnsubscribeRequest;
+    xEventData.xTicksToWait = xTimeoutTicks;
+    xEventData.u.xUnsubscribeParams = *pxUnsubscribeParams;
+
+    /* Note that the notification data part of xEventData and
+     * xEventCreationTimestamp are set in the following call. */
+    return prvSendAsyncCommandToMQTTTask( &xEventData, pxCompletionCallback, pvCompletionContext, pxOperationHandle );
+}
+/*-----------------------------------------------------------*/
+
+MQTTAgentReturnCode_t MQTT_AGENT_PublishAsync( MQTTAgentHandle_t xMQTTHandle,
+                                               const MQTTAgentPublishParams_t * const pxPublishParams,
+                                               MQTTAgentCompletionCallback_t pxCompletionCallback,
+                                               void * pvCompletionContext,
+                                               TickType_t xTimeoutTicks,
+                                               MQTTAgentOperationHandle_t * const pxOperationHandle )
+{
+    MQTTEventData_t xEventData;
+
+    /* Setup the event to be sent to the command queue. */
+    xEventData.uxBrokerNumber = ( UBaseType_t ) mqttDECODE_BROKER_NUMBER( xMQTTHandle ); /*lint !e923 Opaque pointer. */
+    xEventData.xEventType = eMQTTPublishRequest;
+    xEventData.xTicksToWait = xTimeoutTicks;
+    xEventData.u.xPublishParams = *pxPublishParams;
+
+    /* Note that the notification data part of xEventData and
+     * xEventCreationTimestamp are set in the following call. */
+    return prvSendAsyncCommandToMQTTTask( &xEventData, pxCompletionCallback, pvCompletionContext, pxOperationHandle );
+}
+/*-----------------------------------------------------------*/
+
 MQTTAgentReturnCode_t MQTT_AGENT_ReturnBuffer( MQTTAgentHandle_t xMQTTHandle,
                                                MQTTBufferHandle_t xBufferHandle )
 {
@@ -326,6 +326,38 @@
         ( srcIndex ) = ( uint32_t ) ( srcIndex ) + ( uint32_t ) ( byteCount );                           \
         ( dstIndex ) = ( uint32_t ) ( dstIndex ) + ( uint32_t ) ( byteCount );                           \
     }
+
+/* The buffer used to receive a publish message in fragments must at least
+ * hold the longest fixed header, the topic length and one more byte. */
+#if ( ( mqttconfigRX_FRAGMENT_BUFFER_LENGTH != 0 ) && ( mqttconfigRX_FRAGMENT_BUFFER_LENGTH < ( mqttFIXED_HEADER_MAX_SIZE + 3 ) ) )
+    #error "mqttconfigRX_FRAGMENT_BUFFER_LENGTH must be 0 or at least mqttFIXED_HEADER_MAX_SIZE + 3."
+#endif
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+/**
+ * @brief The node index which means "no node" in the subscription manager.
+ *
+ * Index 0 is the root of the tree, which is never the child or the sibling
+ * of another node.
+ */
+    #define mqttSUBSCRIPTION_NO_NODE    ( ( uint16_t ) 0 )
+
+    #if ( ( mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES > 65535 ) || ( mqttconfigSUBSCRIPTION_MANAGER_LEVEL_NAMES_SIZE > 65535 ) )
+        #error "mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES and mqttconfigSUBSCRIPTION_MANAGER_LEVEL_NAMES_SIZE must not be more than 65535."
+    #endif
+
+/**
+ * @brief A branch of the subscription manager which is yet to be matched
+ * against the received topic.
+ */
+    typedef struct MQTTTopicMatch
+    {
+        uint16_t usNode;       /**< The node at which the branch starts. */
+        uint32_t ulTopicIndex; /**< The index of the topic level to match against the children of the node, or more than the topic length if all the levels have been matched. */
+    } MQTTTopicMatch_t;
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
 /**
@@ -430,8 +462,8 @@ static void prvResetRxMessageState( MQTTContext_t * pxMQTTContext );
  *
  * All the buffers on the Tx buffer list and the Rx buffer are returned
  * to the free buffer pool. Rx message state is reset and connection state
- * is marked as "not connected". All the subscription entires in the
- * subscription manager are marked as free.
+ * is marked as "not connected". All the subscriptions in the subscription
+ * manager are removed.
  *
  * @param[in] pxMQTTContext The MQTT context to reset.
  */
@@ -490,6 +522,139 @@ static MQTTReturnCode_t prvSendData( MQTTContext_t * pxMQTTContext,
                                      const uint8_t * const pucData,
                                      uint32_t ulDataLength );
 
+/**
+ * @brief Reads the given part of the data to publish using the user supplied
+ * read callback.
+ *
+ * Keeps invoking the read callback until the requested number of bytes has
+ * been read.
+ *
+ * @param[in] pxPublishParams The publish parameters containing the read callback.
+ * @param[in] ulOffset The offset in the data of the first byte to read.
+ * @param[out] pucBuffer The buffer to read the data into.
+ * @param[in] ulLength The number of bytes to read.
+ *
+ * @return eMQTTSuccess if all the bytes were read, eMQTTFailure otherwise.
+ */
+static MQTTReturnCode_t prvReadPublishData( const MQTTPublishParams_t * const pxPublishParams,
+                                            uint32_t ulOffset,
+                                            uint8_t * pucBuffer,
+                                            uint32_t ulLength );
+
+/**
+ * @brief Transmits the data of a publish message whose headers have already
+ * been transmitted.
+ *
+ * The data is transmitted straight from the user's memory or, if the user
+ * has supplied a read callback, read into the given chunk buffer and
+ * transmitted one chunk at a time. Each chunk is also written to the
+ * in-flight message store, if the message is being stored.
+ *
+ * @param[in] pxMQTTContext The MQTT context.
+ * @param[in] pxPublishParams The publish parameters.
+ * @param[in] ulHeaderLength Length of the headers of the message.
+ * @param[in] pucChunkBuffer The buffer to read the data into.
+ * @param[in] ulChunkBufferLength Length of pucChunkBuffer.
+ *
+ * @return eMQTTSuccess if all the data was transmitted, an error code otherwise.
+ */
+static MQTTReturnCode_t prvSendPublishData( MQTTContext_t * pxMQTTContext,
+                                            const MQTTPublishParams_t * const pxPublishParams,
+                                            uint32_t ulHeaderLength,
+                                            uint8_t * pucChunkBuffer,
+                                            uint32_t ulChunkBufferLength );
+
+/**
+ * @brief Writes part of a QoS1 publish message to the in-flight message store.
+ *
+ * Does nothing for QoS0 messages or if the user has not supplied a store.
+ *
+ * @param[in] pxMQTTContext The MQTT context.
+ * @param[in] pxPublishParams The publish parameters.
+ * @param[in] ulPacketLength The length of the whole message.
+ * @param[in] ulOffset The offset in the message of the first byte to write.
+ * @param[in] pucData The data to write.
+ * @param[in] ulDataLength The length of the data.
+ *
+ * @return eMQTTSuccess if the data was written or need not be stored, an
+ * error code otherwise.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static MQTTReturnCode_t prvStoreInFlightPublish( MQTTContext_t * pxMQTTContext,
+                                                     const MQTTPublishParams_t * const pxPublishParams,
+                                                     uint32_t ulPacketLength,
+                                                     uint32_t ulOffset,
+                                                     const uint8_t * pucData,
+                                                     uint32_t ulDataLength );
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Removes a publish message from the in-flight message store.
+ *
+ * @param[in] pxMQTTContext The MQTT context.
+ * @param[in] usPacketIdentifier The packet identifier of the message, or 0 to
+ * remove all the stored messages.
+ *
+ * @return eMQTTTrue if a message was removed, eMQTTFalse otherwise.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static MQTTBool_t prvRemoveInFlightPublish( MQTTContext_t * pxMQTTContext,
+                                                uint16_t usPacketIdentifier );
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Removes all the messages from the in-flight message store because
+ * the session they belong to was not resumed.
+ *
+ * @param[in] pxMQTTContext The MQTT context.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static void prvDiscardInFlightPublishes( MQTTContext_t * pxMQTTContext );
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Retransmits all the messages in the in-flight message store with
+ * the DUP flag set.
+ *
+ * Called when the broker resumes the session. If a message cannot be
+ * retransmitted because no free buffer is available, the retransmission is
+ * attempted again from MQTT_Periodic.
+ *
+ * @param[in] pxMQTTContext The MQTT context.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static void prvResendInFlightPublishes( MQTTContext_t * pxMQTTContext );
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+/**
+ * @brief Retransmits one message from the in-flight message store with the
+ * DUP flag set.
+ *
+ * The message is read into a buffer and transmitted one buffer at a time if
+ * it does not fit in one buffer.
+ *
+ * @param[in] pxMQTTContext The MQTT context.
+ * @param[in] usPacketIdentifier The packet identifier of the message.
+ * @param[in] ulPacketLength The length of the message.
+ *
+ * @return eMQTTSuccess if the message was transmitted, an error code otherwise.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static MQTTReturnCode_t prvResendInFlightPublish( MQTTContext_t * pxMQTTContext,
+                                                      uint16_t usPacketIdentifier,
+                                                      uint32_t ulPacketLength );
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
 /**
  * @brief Decodes and processes the received MQTT message containing only fixed header.
  *
@@ -585,10 +750,38 @@ static void prvProcessReceivedPINGRESP( MQTTContext_t * pxMQTTContext );
  * free the buffer whenever done or supply it back for re-use by calling
  * MQTT_GiveBuffer.
  *
+ * This is also invoked for each fragment of a message which is passed to the
+ * user in fragments. The fixed and variable headers are kept in the buffer
+ * after a fragment other than the last has been passed, and the next fragment
+ * is stored after them.
+ *
  * @param[in] pxMQTTContext The MQTT context for which the message was received.
  */
 static void prvProcessReceivedPublish( MQTTContext_t * pxMQTTContext );
 
+/**
+ * @brief Passes the part of a large publish message stored in the Rx buffer
+ * to the user if the buffer is full or the whole message has been received.
+ *
+ * The message is dropped if its fixed and variable headers do not leave any
+ * space in the buffer for the data.
+ *
+ * @param[in] pxMQTTContext The MQTT context for which the message is being received.
+ */
+static void prvProcessReceivedPublishFragment( MQTTContext_t * pxMQTTContext );
+
+/**
+ * @brief Calculates the length of the fixed and variable headers of the publish
+ * message in the Rx buffer.
+ *
+ * The topic length field of the message must have been received.
+ *
+ * @param[in] pxMQTTContext The MQTT context for which the message is being received.
+ *
+ * @return The length of the fixed and variable headers.
+ */
+static uint32_t prvGetReceivedPublishHeaderLength( MQTTContext_t * pxMQTTContext );
+
 /**
  * @brief Invokes the user supplied callback.
  *
@@ -688,11 +881,14 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 /**
  * @brief Store the subscription in the subscription manager.
  *
- * This function can fail to store the subscription if all the entries in the
- * subscription manager are in use or the topic name is longer than the maximum
- * length as specified by the mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH
- * macro or if the topic represents an invalid topic filter. eMQTTFalse is returned
- * to indicate the failure.
+ * This function can fail to store the subscription if the maximum number of
+ * subscriptions are already stored, there are not enough free nodes or space
+ * for level names to store the topic filter, the topic name is longer than the
+ * maximum length as specified by mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH,
+ * it has more levels than mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS or
+ * if the topic represents an invalid topic filter. eMQTTFalse is returned to
+ * indicate the failure. If the topic filter is already stored, its callback is
+ * replaced.
  *
  * @param[in] pxMQTTContext The MQTT context for which to store the subscription.
  * @param[in] pucTopic The topic this subscription entry is for.
@@ -717,9 +913,9 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
  * @brief Removes the subscription entry from the subscription manager corresponding
  * to the provided topic.
  *
- * Iterates over all the entries in the subscription manager and tries to find
- * the one with the matching topic. If it finds one, removes it by marking it
- * free.
+ * Follows the levels of the topic filter from the root of the tree. If a
+ * subscribed topic filter ends at the last level, removes the subscription and
+ * frees the nodes which are no longer used by any other topic filter.
  *
  * @param[in] pxMQTTContext The MQTT context for which to remove the subscription.
  * @param[in] pucTopic The topic for which the subscription entry is to be removed.
@@ -733,6 +929,98 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
+/**
+ * @brief Removes all the subscriptions from the subscription manager.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager to reset.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static void prvResetSubscriptionManager( MQTTSubscriptionManager_t * pxSubscriptionManager );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
+/**
+ * @brief Finds the end of the topic level which starts at the given index.
+ *
+ * @param[in] pucTopic The topic or topic filter.
+ * @param[in] usTopicLength The length of the topic.
+ * @param[in] ulLevelStart The index of the first character of the level.
+ *
+ * @return The index of the '/' following the level, or usTopicLength if it is
+ * the last level.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static uint32_t prvGetTopicLevelEnd( const uint8_t * const pucTopic,
+                                         uint16_t usTopicLength,
+                                         uint32_t ulLevelStart );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
+/**
+ * @brief Finds the child of the given node for the given level of a topic
+ * filter.
+ *
+ * The '+' and '#' levels return the wild-card children of the node. Other levels
+ * are compared with the names of the other children.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager to search.
+ * @param[in] usNode The node whose children to search.
+ * @param[in] pucLevel The name of the level.
+ * @param[in] usLevelLength The length of the name of the level.
+ * @param[in] xMatchWildCards If eMQTTFalse, '+' and '#' are compared as names.
+ * Used when matching received topics, which cannot contain wild-cards.
+ *
+ * @return The child node, or mqttSUBSCRIPTION_NO_NODE if there is none.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static uint16_t prvGetChildNode( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                     uint16_t usNode,
+                                     const uint8_t * const pucLevel,
+                                     uint16_t usLevelLength,
+                                     MQTTBool_t xMatchWildCards );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
+/**
+ * @brief Adds a child to the given node for the given level of a topic filter.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager to add the node to.
+ * @param[in] usNode The node to add the child to.
+ * @param[in] pucLevel The name of the level.
+ * @param[in] usLevelLength The length of the name of the level.
+ *
+ * @return The new node, or mqttSUBSCRIPTION_NO_NODE if there is no free node or
+ * no space left to store the name of the level.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static uint16_t prvAddChildNode( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                     uint16_t usNode,
+                                     const uint8_t * const pucLevel,
+                                     uint16_t usLevelLength );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
+/**
+ * @brief Frees the given node and then its parents, for as long as the node
+ * has no children and no topic filter ends at it.
+ *
+ * The level names stored after the name of a freed node are moved down so
+ * that the names buffer never has gaps.
+ *
+ * @param[in] pxSubscriptionManager The subscription manager to free the nodes of.
+ * @param[in] usNode The first node to free.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static void prvFreeUnusedNodes( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                    uint16_t usNode );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
 /**
  * @brief Removes the subscription entry from the subscription manager corresponding
  * to the topic contained in the provided MQTT subscribe or unsubscribe message.
@@ -757,12 +1045,14 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
  * publish message is received.
  *
  * It stops as soon as the user takes the ownership of the MQTT buffer by
- * returning eMQTTTrue from the callback. It follows the following sequence
- * for invoking callbacks:
- * - First it tries to find an exact match with the entries containing topic
- *   filters without wild-cards.
- * - Then it tries to find entries containing topic filters with wild-cards
- *   which match the topic on which the publish message is received.
+ * returning eMQTTTrue from the callback. It follows the levels of the topic
+ * from the root of the subscription manager, taking the child with the same
+ * name as the topic level first. The '+' and '#' children met on the way are
+ * kept and matched afterwards, so:
+ * - First it invokes the callback of the topic filter without wild-cards which
+ *   is the same as the topic, if there is one.
+ * - Then it invokes the callbacks of the topic filters with wild-cards which
+ *   match the topic.
  *
  * @param[in] pxMQTTContext The MQTT context for which to invoke the subscription callbacks.
  * @param[in] pxPublishData The publish data containing the topic and the received message.
@@ -779,6 +1069,24 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
+/**
+ * @brief Invokes the callback of the topic filter which ends at the given node.
+ *
+ * @param[in] pxNode The node at which the matching topic filter ends.
+ * @param[in] pxPublishData The publish data containing the topic and the received message.
+ * @param[out] pxSubscriptionCallbackInvoked Set to eMQTTTrue if the callback was
+ * invoked, otherwise left unchanged.
+ *
+ * @return eMQTTTrue if the user took the ownership of the MQTT buffer, eMQTTFalse otherwise.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static MQTTBool_t prvInvokeSubscriptionCallback( const MQTTTopicNode_t * pxNode,
+                                                     const MQTTPublishData_t * pxPublishData,
+                                                     MQTTBool_t * pxSubscriptionCallbackInvoked );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
 /**
  * @brief Infers the type of the given topic filter.
  *
@@ -806,37 +1114,6 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
     static MQTTTopicFilterType_t prvGetTopicFilterType( const uint8_t * const pucTopicFilter,
                                                         uint16_t usTopicFilterLength );
 
-#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
-
-/**
- * @brief Checks whether the given topic matches the given topic
- * filter.
- *
- * @warning It assumes that the given topic filter is valid i.e.
- * calling prvIsValidTopicFilter with the given topic will not
- * return eMQTTTopicFilterTypeInvalid.
- *
- * Some corner cases as documented by the MQTT protocol spec are:
- * - Filter of type "sport/#" also matches the singular "sport"
- *   since # includes the parent level.
- * - Filter of type "sport/+" also matches the "sport/" but not
- *   "sport".
- *
- * @param[in] pucTopic The given topic to match.
- * @param[in] usTopicLength The length of the given topic.
- * @param[in] pucTopicFilter The given topic filter with which to match
- * the given topic.
- * @param[in] usTopicFilterLength The length of the given topic filter.
- *
- * @return eMQTTTrue if the topic matches the filter, eMQTTFalse otherwise.
- */
-#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
-
-    static MQTTBool_t prvDoesTopicMatchTopicFilter( const uint8_t * const pucTopic,
-                                                    uint16_t usTopicLength,
-                                                    const uint8_t * const pucTopicFilter,
-                                                    uint16_t usTopicFilterLength );
-
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
@@ -994,6 +1271,7 @@ static void prvResetRxMessageState( MQTTContext_t * pxMQTTContext )
     /* Prepares the context to receive the next message. */
     pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes = 0;
     pxMQTTContext->xRxMessageState.ulTotalMessageLength = 0;
+    pxMQTTContext->xRxMessageState.ulStreamedLength = 0;
     pxMQTTContext->xRxMessageState.xRxMessageAction = eMQTTRxMessageStore;
     pxMQTTContext->xRxMessageState.xRxNextByte = eMQTTRxNextBytePacketType;
     pxMQTTContext->ulRxMessageReceivedLength = 0;
@@ -1006,10 +1284,6 @@ static void prvResetMQTTContext( MQTTContext_t * pxMQTTContext )
     Link_t * pxLink, * pxTempLink;
     MQTTBufferHandle_t xBufferHandle;
 
-    #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
-        uint32_t x;
-    #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
-
     /* Set connection state to not connected. */
     pxMQTTContext->xConnectionState = eMQTTNotConnected;
 
@@ -1027,17 +1301,15 @@ static void prvResetMQTTContext( MQTTContext_t * pxMQTTContext )
     prvResetRxMessageState( pxMQTTContext );
 
     #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
-
-        /* Mark all the subscription entires in the subscription
-         * manager as free. */
-        for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
-        {
-            pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse = eMQTTFalse;
-        }
-
-        /* Set the number of in-use subscription entries to zero. */
-        pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions = 0;
+        /* Remove all the subscriptions. */
+        prvResetSubscriptionManager( &( pxMQTTContext->xSubscriptionManager ) );
     #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        /* The in-flight messages stay in the store so that they can be
+         * retransmitted after the next connection. */
+        pxMQTTContext->xInFlightResendPending = eMQTTFalse;
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
 }
 /*-----------------------------------------------------------*/
 
@@ -1121,6 +1393,291 @@ static MQTTReturnCode_t prvSendData( MQTTContext_t * pxMQTTContext,
 }
 /*-----------------------------------------------------------*/
 
+static MQTTReturnCode_t prvReadPublishData( const MQTTPublishParams_t * const pxPublishParams,
+                                            uint32_t ulOffset,
+                                            uint8_t * pucBuffer,
+                                            uint32_t ulLength )
+{
+    MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+    uint32_t ulReadLength, ulTotalReadLength = 0;
+
+    while( ( ulTotalReadLength < ulLength ) && ( xReturnCode == eMQTTSuccess ) )
+    {
+        ulReadLength = pxPublishParams->pxReadFxn( pxPublishParams->pvReadContext,
+                                                   ulOffset + ulTotalReadLength,
+                                                   &( pucBuffer[ ulTotalReadLength ] ),
+                                                   ulLength - ulTotalReadLength );
+
+        /* The user may return fewer bytes than requested, but not none. */
+        if( ( ulReadLength == ( uint32_t ) 0 ) || ( ulReadLength > ( ulLength - ulTotalReadLength ) ) )
+        {
+            mqttconfigDEBUG_LOG( ( "Failed to read the data to publish at offset %d.\r\n", ulOffset + ulTotalReadLength ) );
+            xReturnCode = eMQTTFailure;
+        }
+        else
+        {
+            ulTotalReadLength += ulReadLength;
+        }
+    }
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
+static MQTTReturnCode_t prvSendPublishData( MQTTContext_t * pxMQTTContext,
+                                            const MQTTPublishParams_t * const pxPublishParams,
+                                            uint32_t ulHeaderLength,
+                                            uint8_t * pucChunkBuffer,
+                                            uint32_t ulChunkBufferLength )
+{
+    MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+    uint32_t ulOffset = 0, ulChunkLength;
+
+    /* Remove compiler warnings when the in-flight store is not enabled. */
+    ( void ) ulHeaderLength;
+
+    if( pxPublishParams->pxReadFxn == NULL )
+    {
+        #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+            xReturnCode = prvStoreInFlightPublish( pxMQTTContext,
+                                                   pxPublishParams,
+                                                   ulHeaderLength + pxPublishParams->ulDataLength,
+                                                   ulHeaderLength,
+                                                   ( const uint8_t * ) pxPublishParams->pvData, /*lint !e9079 Publish data is provided as void* by the user. */
+                                                   pxPublishParams->ulDataLength );
+        #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+        /* Transmit the data straight from the user's memory. */
+        if( xReturnCode == eMQTTSuccess )
+        {
+            xReturnCode = prvSendData( pxMQTTContext, ( const uint8_t * ) pxPublishParams->pvData, pxPublishParams->ulDataLength ); /*lint !e9079 Publish data is provided as void* by the user. */
+        }
+    }
+    else
+    {
+        mqttconfigASSERT( ulChunkBufferLength > ( uint32_t ) 0 );
+
+        /* Read as much data as fits in the chunk buffer, transmit it and
+         * repeat until all the data has been transmitted. */
+        while( ( ulOffset < pxPublishParams->ulDataLength ) && ( xReturnCode == eMQTTSuccess ) )
+        {
+            ulChunkLength = mqttMIN( ulChunkBufferLength, pxPublishParams->ulDataLength - ulOffset );
+
+            xReturnCode = prvReadPublishData( pxPublishParams, ulOffset, pucChunkBuffer, ulChunkLength );
+
+            #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+                if( xReturnCode == eMQTTSuccess )
+                {
+                    xReturnCode = prvStoreInFlightPublish( pxMQTTContext,
+                                                           pxPublishParams,
+                                                           ulHeaderLength + pxPublishParams->ulDataLength,
+                                                           ulHeaderLength + ulOffset,
+                                                           pucChunkBuffer,
+                                                           ulChunkLength );
+                }
+            #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+            if( xReturnCode == eMQTTSuccess )
+            {
+                xReturnCode = prvSendData( pxMQTTContext, pucChunkBuffer, ulChunkLength );
+            }
+
+            ulOffset += ulChunkLength;
+        }
+    }
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static MQTTReturnCode_t prvStoreInFlightPublish( MQTTContext_t * pxMQTTContext,
+                                                     const MQTTPublishParams_t * const pxPublishParams,
+                                                     uint32_t ulPacketLength,
+                                                     uint32_t ulOffset,
+                                                     const uint8_t * pucData,
+                                                     uint32_t ulDataLength )
+    {
+        MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+
+        /* Only QoS1 messages wait for an ACK and need to be retransmitted. */
+        if( ( pxPublishParams->xQos == eMQTTQoS1 ) && ( pxMQTTContext->xInFlightStoreInterface.pxWriteFxn != NULL ) )
+        {
+            xReturnCode = pxMQTTContext->xInFlightStoreInterface.pxWriteFxn( pxMQTTContext->xInFlightStoreInterface.pvStoreContext,
+                                                                             pxPublishParams->usPacketIdentifier,
+                                                                             ulPacketLength,
+                                                                             ulOffset,
+                                                                             pucData,
+                                                                             ulDataLength );
+
+            if( xReturnCode != eMQTTSuccess )
+            {
+                mqttconfigDEBUG_LOG( ( "Failed to store the publish message with packet identifier %d.\r\n", pxPublishParams->usPacketIdentifier ) );
+            }
+        }
+
+        return xReturnCode;
+    }
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static MQTTBool_t prvRemoveInFlightPublish( MQTTContext_t * pxMQTTContext,
+                                                uint16_t usPacketIdentifier )
+    {
+        MQTTBool_t xRemoved = eMQTTFalse;
+
+        if( pxMQTTContext->xInFlightStoreInterface.pxWriteFxn != NULL )
+        {
+            xRemoved = pxMQTTContext->xInFlightStoreInterface.pxRemoveFxn( pxMQTTContext->xInFlightStoreInterface.pvStoreContext,
+                                                                           usPacketIdentifier );
+        }
+
+        return xRemoved;
+    }
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static void prvDiscardInFlightPublishes( MQTTContext_t * pxMQTTContext )
+    {
+        uint16_t usPacketIdentifier;
+        uint32_t ulPacketLength = 0;
+
+        if( pxMQTTContext->xInFlightStoreInterface.pxWriteFxn != NULL )
+        {
+            /* Count the messages for the statistics before removing them
+             * all at once. */
+            usPacketIdentifier = pxMQTTContext->xInFlightStoreInterface.pxNextFxn( pxMQTTContext->xInFlightStoreInterface.pvStoreContext,
+                                                                                   0,
+                                                                                   &( ulPacketLength ) );
+
+            while( usPacketIdentifier != ( uint16_t ) 0 )
+            {
+                pxMQTTContext->xInFlightStoreStats.ulDiscarded++;
+
+                usPacketIdentifier = pxMQTTContext->xInFlightStoreInterface.pxNextFxn( pxMQTTContext->xInFlightStoreInterface.pvStoreContext,
+                                                                                       usPacketIdentifier,
+                                                                                       &( ulPacketLength ) );
+            }
+
+            ( void ) prvRemoveInFlightPublish( pxMQTTContext, 0 );
+        }
+
+        pxMQTTContext->xInFlightResendPending = eMQTTFalse;
+    }
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static void prvResendInFlightPublishes( MQTTContext_t * pxMQTTContext )
+    {
+        MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+        uint16_t usPacketIdentifier = 0;
+        uint32_t ulPacketLength = 0;
+
+        if( pxMQTTContext->xInFlightStoreInterface.pxWriteFxn != NULL )
+        {
+            usPacketIdentifier = pxMQTTContext->xInFlightStoreInterface.pxNextFxn( pxMQTTContext->xInFlightStoreInterface.pvStoreContext,
+                                                                                   0,
+                                                                                   &( ulPacketLength ) );
+        }
+
+        while( ( usPacketIdentifier != ( uint16_t ) 0 ) && ( xReturnCode == eMQTTSuccess ) )
+        {
+            xReturnCode = prvResendInFlightPublish( pxMQTTContext, usPacketIdentifier, ulPacketLength );
+
+            if( xReturnCode == eMQTTSuccess )
+            {
+                pxMQTTContext->xInFlightStoreStats.ulResent++;
+
+                usPacketIdentifier = pxMQTTContext->xInFlightStoreInterface.pxNextFxn( pxMQTTContext->xInFlightStoreInterface.pvStoreContext,
+                                                                                       usPacketIdentifier,
+                                                                                       &( ulPacketLength ) );
+            }
+        }
+
+        /* If no buffer was available, start again from MQTT_Periodic. The
+         * messages already retransmitted are then transmitted once more, which
+         * is allowed as they have the DUP flag set. Any other failure means
+         * that the connection is lost and the messages are retransmitted
+         * after the next connection instead. */
+        pxMQTTContext->xInFlightResendPending = ( xReturnCode == eMQTTNoFreeBuffer ) ? eMQTTTrue : eMQTTFalse;
+    }
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+    static MQTTReturnCode_t prvResendInFlightPublish( MQTTContext_t * pxMQTTContext,
+                                                      uint16_t usPacketIdentifier,
+                                                      uint32_t ulPacketLength )
+    {
+        MQTTBufferHandle_t xBuffer;
+        MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+        uint32_t ulOffset = 0, ulChunkLength;
+
+        /* Get a buffer for the whole message or, if there is none, a smaller
+         * one and transmit the message one buffer at a time. */
+        xBuffer = prvGetFreeBuffer( pxMQTTContext, ulPacketLength );
+
+        if( xBuffer == NULL )
+        {
+            xBuffer = prvGetFreeBuffer( pxMQTTContext, mqttFIXED_HEADER_MAX_SIZE );
+        }
+
+        if( xBuffer == NULL )
+        {
+            mqttconfigDEBUG_LOG( ( "No free buffer is available to retransmit the stored messages.\r\n" ) );
+            xReturnCode = eMQTTNoFreeBuffer;
+        }
+        else
+        {
+            while( ( ulOffset < ulPacketLength ) && ( xReturnCode == eMQTTSuccess ) )
+            {
+                ulChunkLength = mqttMIN( mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBuffer ), ulPacketLength - ulOffset );
+
+                if( pxMQTTContext->xInFlightStoreInterface.pxReadFxn( pxMQTTContext->xInFlightStoreInterface.pvStoreContext,
+                                                                      usPacketIdentifier,
+                                                                      ulOffset,
+                                                                      mqttbufferGET_DATA( xBuffer ),
+                                                                      ulChunkLength ) != ulChunkLength )
+                {
+                    mqttconfigDEBUG_LOG( ( "Failed to read the stored message with packet identifier %d.\r\n", usPacketIdentifier ) );
+                    xReturnCode = eMQTTFailure;
+                }
+                else
+                {
+                    /* The message was stored as it was first transmitted, so
+                     * mark it as a duplicate. */
+                    if( ulOffset == ( uint32_t ) 0 )
+                    {
+                        mqttbufferGET_DATA( xBuffer )[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] |= mqttFLAGS_PUBLISH_DUP;
+                    }
+
+                    xReturnCode = prvSendData( pxMQTTContext, mqttbufferGET_DATA( xBuffer ), ulChunkLength );
+                }
+
+                ulOffset += ulChunkLength;
+            }
+
+            prvReturnBuffer( pxMQTTContext, xBuffer );
+        }
+
+        return xReturnCode;
+    }
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+/*-----------------------------------------------------------*/
+
 static void prvProcessReceivedFixedHeaderOnlyMQTTPacket( MQTTContext_t * pxMQTTContext )
 {
     MQTTEventCallbackParams_t xEventCallbackParams;
@@ -1192,6 +1749,7 @@ static void prvProcessReceivedCONNACK( MQTTContext_t * pxMQTTContext )
     MQTTBufferHandle_t xConnectTxBuffer;
     MQTTEventCallbackParams_t xEventCallbackParams;
     MQTTBool_t xConnectionEstablished = eMQTTFalse, xConnectionRefused = eMQTTFalse, xMalformedPacket = eMQTTFalse;
+    MQTTBool_t xSessionPresent = eMQTTFalse;
     uint8_t ucReturnCode;
     static const uint8_t ucDefaultCONNACKParameters[] =
     {
@@ -1227,10 +1785,17 @@ static void prvProcessReceivedCONNACK( MQTTContext_t * pxMQTTContext )
 
                 xEventCallbackParams.xEventType = eMQTTConnACK;
 
-                /* Since AWS IoT only supports CleanSession 1, SP bit will
-                 * always be zero. */
+                /* The SP bit is only set if the client did not ask for a
+                 * clean session and the broker resumed the previous one. */
                 ucReturnCode = mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttCONNACK_RETURN_CODE_OFFSET ];
 
+                if( ( mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttCONNACK_SESSION_PRESENT_OFFSET ] & ( uint8_t ) 0x01 ) != ( uint8_t ) 0 )
+                {
+                    xSessionPresent = eMQTTTrue;
+                }
+
+                xEventCallbackParams.u.xMQTTConnACKData.xSessionPresent = xSessionPresent;
+
                 if( ucReturnCode == ( uint8_t ) 0 ) /* Connection Accepted. */
                 {
                     /* Server has accepted the connection and we are now in
@@ -1336,6 +1901,20 @@ static void prvProcessReceivedCONNACK( MQTTContext_t * pxMQTTContext )
 
         /* No ping has been sent yet. */
         pxMQTTContext->xWaitingForPingResp = eMQTTFalse;
+
+        #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+            /* The stored messages can only be acknowledged in the session
+             * they were first transmitted in. */
+            if( xSessionPresent == eMQTTTrue )
+            {
+                prvResendInFlightPublishes( pxMQTTContext );
+            }
+            else
+            {
+                prvDiscardInFlightPublishes( pxMQTTContext );
+            }
+        #endif /* mqttconfigENABLE_INFLIGHT_STORE */
     }
 
     /* Return the RxBuffer to the free buffer pool. */
@@ -1539,7 +2118,7 @@ static void prvProcessReceivedPUBACK( MQTTContext_t * pxMQTTContext )
 {
     MQTTBufferHandle_t xPublishTxBuffer;
     MQTTEventCallbackParams_t xEventCallbackParams;
-    MQTTBool_t xMalformedPacket = eMQTTFalse;
+    MQTTBool_t xMalformedPacket = eMQTTFalse, xStoredPublish = eMQTTFalse;
     uint16_t usPacketIdentifier;
     static const uint8_t ucPUBACKFixedHeader[] =
     {
@@ -1567,7 +2146,18 @@ static void prvProcessReceivedPUBACK( MQTTContext_t * pxMQTTContext )
 
             xPublishTxBuffer = prvPacketTypeIdentifierGetTxBuffer( pxMQTTContext, mqttCONTROL_PUBLISH, usPacketIdentifier );
 
-            if( xPublishTxBuffer == NULL )
+            #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+                /* A message retransmitted from the in-flight store has no
+                 * Tx buffer, but its PUBACK is still expected. */
+                if( prvRemoveInFlightPublish( pxMQTTContext, usPacketIdentifier ) == eMQTTTrue )
+                {
+                    pxMQTTContext->xInFlightStoreStats.ulAcknowledged++;
+                    xStoredPublish = eMQTTTrue;
+                }
+            #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
+            if( ( xPublishTxBuffer == NULL ) && ( xStoredPublish == eMQTTFalse ) )
             {
                 /* Either a publish was never sent or the sender
                  * timed out. Either case, this is an unexpected PUBACK. */
@@ -1576,7 +2166,7 @@ static void prvProcessReceivedPUBACK( MQTTContext_t * pxMQTTContext )
             }
             else
             {
-                /* Inform the user about the received UNSUBACK. */
+                /* Inform the user about the received PUBACK. */
                 xEventCallbackParams.xEventType = eMQTTPubACK;
                 xEventCallbackParams.u.xMQTTPubACKData.usPacketIdentifier = usPacketIdentifier;
                 ( void ) prvInvokeCallback( pxMQTTContext, &xEventCallbackParams );
@@ -1672,8 +2262,9 @@ static void prvProcessReceivedPINGRESP( MQTTContext_t * pxMQTTContext )
 static void prvProcessReceivedPublish( MQTTContext_t * pxMQTTContext )
 {
     MQTTEventCallbackParams_t xEventCallbackParams;
-    uint8_t ucPacketIdentiferLength; /* Length in bytes taken by the packet identifier field in the received publish packet. */
     uint8_t ucQos;
+    uint32_t ulHeaderLength; /* Length of the fixed and variable headers of the received publish packet. */
+    MQTTBool_t xLastFragment;
     static uint8_t ucPUBACKPacket[] =
     {
         mqttCONTROL_PUBACK | mqttFLAGS_PUBACK, /* Fixed header control packet type. */
@@ -1694,15 +2285,6 @@ static void prvProcessReceivedPublish( MQTTContext_t * pxMQTTContext )
     {
         xEventCallbackParams.u.xPublishData.xQos = ( ucQos == ( uint8_t ) 0 ) ? eMQTTQoS0 : eMQTTQoS1;
 
-        if( xEventCallbackParams.u.xPublishData.xQos == eMQTTQoS0 )
-        {
-            ucPacketIdentiferLength = mqttPUBLISH_QOS0_PACKET_IDENTIFER_LENGTH;
-        }
-        else
-        {
-            ucPacketIdentiferLength = mqttPUBLISH_QOS1_PACKET_IDENTIFER_LENGTH;
-        }
-
         /* Extract Topic Length. */
         xEventCallbackParams.u.xPublishData.usTopicLength = ( uint16_t ) mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_LENGTH_MSB,
                                                                                                                                             pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) ];
@@ -1714,36 +2296,35 @@ static void prvProcessReceivedPublish( MQTTContext_t * pxMQTTContext )
         xEventCallbackParams.u.xPublishData.pucTopic = &( mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_STRING_OFFSET,
                                                                                                                              pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) ] );
 
-        /* Extract Published Data. */
-        xEventCallbackParams.u.xPublishData.pvData = ( void * ) &( mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_STRING_OFFSET,
-                                                                                                                                      pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) +
-                                                                                                                   xEventCallbackParams.u.xPublishData.usTopicLength +
-                                                                                                                   ucPacketIdentiferLength ] ); /*lint !e9087 Publish data is provided as void* to the user. */
-
         /* Topic string is followed by packet identifier which is
-         * followed by actual data. NOte that QoS0 publishes do not
+         * followed by actual data. Note that QoS0 publishes do not
          * have packet identifier. */
-        xEventCallbackParams.u.xPublishData.ulDataLength = pxMQTTContext->xRxMessageState.ulTotalMessageLength - ( mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_STRING_OFFSET,
-                                                                                                                                      pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) +
-                                                                                                                   xEventCallbackParams.u.xPublishData.usTopicLength +
-                                                                                                                   ucPacketIdentiferLength );
+        ulHeaderLength = prvGetReceivedPublishHeaderLength( pxMQTTContext );
+
+        /* Extract Published Data. */
+        xEventCallbackParams.u.xPublishData.pvData = ( void * ) &( mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ ulHeaderLength ] ); /*lint !e9087 Publish data is provided as void* to the user. */
+
+        /* The buffer contains the whole message, unless the message is
+         * passed in fragments in which case it contains the fragment
+         * following the ulStreamedLength bytes already passed. */
+        xEventCallbackParams.u.xPublishData.ulDataLength = mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ) - ulHeaderLength;
+        xEventCallbackParams.u.xPublishData.ulDataOffset = pxMQTTContext->xRxMessageState.ulStreamedLength;
+        xEventCallbackParams.u.xPublishData.ulTotalDataLength = pxMQTTContext->xRxMessageState.ulTotalMessageLength - ulHeaderLength;
 
-        /* Pass the handle of the buffer containing the whole MQTT message. */
+        xLastFragment = ( ( xEventCallbackParams.u.xPublishData.ulDataOffset + xEventCallbackParams.u.xPublishData.ulDataLength ) ==
+                          xEventCallbackParams.u.xPublishData.ulTotalDataLength ) ? eMQTTTrue : eMQTTFalse;
+
+        /* Pass the handle of the buffer containing the MQTT message. */
         xEventCallbackParams.u.xPublishData.xBuffer = pxMQTTContext->xRxBuffer;
 
         /* If this is a QoS1 publish, send the PUBACK before invoking the
-         * callback. */
-        if( xEventCallbackParams.u.xPublishData.xQos == eMQTTQoS1 )
+         * callback for the whole message or its last fragment. */
+        if( ( xEventCallbackParams.u.xPublishData.xQos == eMQTTQoS1 ) && ( xLastFragment == eMQTTTrue ) )
         {
             /* Extract the packet identifier from the publish message
              * to set the same in PUBACK message. */
-            ucPUBACKPacket[ mqttPUBACK_PACKET_ID_MSB_OFFSET ] = mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_STRING_OFFSET,
-                                                                                                                                   pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) +
-                                                                                                                xEventCallbackParams.u.xPublishData.usTopicLength ];
-            ucPUBACKPacket[ mqttPUBACK_PACKET_ID_LSB_OFFSET ] = mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_STRING_OFFSET,
-                                                                                                                                   pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) +
-                                                                                                                xEventCallbackParams.u.xPublishData.usTopicLength +
-                                                                                                                ( uint16_t ) 1 /* Packet ID LSB follows MSB. */ ];
+            ucPUBACKPacket[ mqttPUBACK_PACKET_ID_MSB_OFFSET ] = mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ ulHeaderLength - ( uint32_t ) mqttPUBLISH_QOS1_PACKET_IDENTIFER_LENGTH ];
+            ucPUBACKPacket[ mqttPUBACK_PACKET_ID_LSB_OFFSET ] = mqttbufferGET_DATA( pxMQTTContext->xRxBuffer )[ ulHeaderLength - ( uint32_t ) 1 /* Packet ID LSB is the last byte of the variable header. */ ];
 
             /* Send a PUBACK to the broker confirming the receipt
              * of the publish message. If we fail to send the PUBACK,
@@ -1751,11 +2332,25 @@ static void prvProcessReceivedPublish( MQTTContext_t * pxMQTTContext )
             ( void ) prvSendData( pxMQTTContext, ucPUBACKPacket, ( uint32_t ) sizeof( ucPUBACKPacket ) );
         }
 
-        /* If the user chooses not to take the ownership of the buffer,
-         * return it back to the free buffer pool. */
-        if( prvInvokeCallback( pxMQTTContext, &xEventCallbackParams ) == eMQTTFalse )
+        if( xLastFragment == eMQTTTrue )
+        {
+            /* If the user chooses not to take the ownership of the buffer,
+             * return it back to the free buffer pool. */
+            if( prvInvokeCallback( pxMQTTContext, &xEventCallbackParams ) == eMQTTFalse )
+            {
+                prvReturnBuffer( pxMQTTContext, pxMQTTContext->xRxBuffer );
+            }
+        }
+        else
         {
-            prvReturnBuffer( pxMQTTContext, pxMQTTContext->xRxBuffer );
+            /* The user cannot take the ownership of the buffer for a
+             * fragment other than the last, so the return value is not
+             * checked. Keep the headers in the buffer and store the next
+             * fragment after them. */
+            ( void ) prvInvokeCallback( pxMQTTContext, &xEventCallbackParams );
+
+            pxMQTTContext->xRxMessageState.ulStreamedLength += xEventCallbackParams.u.xPublishData.ulDataLength;
+            mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ) = ulHeaderLength;
         }
     }
     else
@@ -1772,6 +2367,78 @@ static void prvProcessReceivedPublish( MQTTContext_t * pxMQTTContext )
 }
 /*-----------------------------------------------------------*/
 
+static void prvProcessReceivedPublishFragment( MQTTContext_t * pxMQTTContext )
+{
+    uint32_t ulHeaderLength, ulReceivedLength;
+    MQTTBufferHandle_t xBuffer = pxMQTTContext->xRxBuffer;
+
+    /* Nothing can be done before the topic length has been received. */
+    if( mqttbufferGET_DATA_LENGTH( xBuffer ) > mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_LENGTH_LSB, pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) )
+    {
+        ulHeaderLength = prvGetReceivedPublishHeaderLength( pxMQTTContext );
+        ulReceivedLength = pxMQTTContext->xRxMessageState.ulStreamedLength + mqttbufferGET_DATA_LENGTH( xBuffer );
+
+        if( ( ulHeaderLength >= mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBuffer ) ) ||
+            ( ulHeaderLength > pxMQTTContext->xRxMessageState.ulTotalMessageLength ) )
+        {
+            /* The headers do not leave any space for the data in the
+             * buffer - drop the rest of the message. */
+            mqttconfigDEBUG_LOG( ( "Topic of the publish message is too long to pass it in fragments.\r\n" ) );
+
+            pxMQTTContext->ulRxMessageReceivedLength = ulReceivedLength;
+            pxMQTTContext->xRxMessageState.xRxMessageAction = eMQTTRxMessageDrop;
+
+            prvReturnBuffer( pxMQTTContext, xBuffer );
+            pxMQTTContext->xRxBuffer = NULL;
+        }
+        else if( ( mqttbufferGET_DATA_LENGTH( xBuffer ) == mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBuffer ) ) ||
+                 ( ulReceivedLength == pxMQTTContext->xRxMessageState.ulTotalMessageLength ) )
+        {
+            /* The buffer is full or the message is complete - pass
+             * the fragment to the user. */
+            prvProcessReceivedPublish( pxMQTTContext );
+
+            /* Complete message received, start looking for the start of
+             * the next. */
+            if( ulReceivedLength == pxMQTTContext->xRxMessageState.ulTotalMessageLength )
+            {
+                prvResetRxMessageState( pxMQTTContext );
+            }
+        }
+        else
+        {
+            /* Wait for more bytes. */
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvGetReceivedPublishHeaderLength( MQTTContext_t * pxMQTTContext )
+{
+    uint32_t ulHeaderLength;
+    uint8_t * pucData = mqttbufferGET_DATA( pxMQTTContext->xRxBuffer );
+
+    /* The fixed header and the topic length field. */
+    ulHeaderLength = mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_STRING_OFFSET, pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes );
+
+    /* The topic. */
+    ulHeaderLength += ( ( uint32_t ) pucData[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_LENGTH_MSB, pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) ] << mqttBITS_PER_BYTE ) |
+                      ( uint32_t ) pucData[ mqttADJUST_OFFSET( mqttPUBLISH_TOPIC_LENGTH_LSB, pxMQTTContext->xRxMessageState.ucRemaingingLengthFieldBytes ) ];
+
+    /* The packet identifier, which QoS0 publishes do not have. */
+    if( mqttPUBLISH_QoS_BITS( pucData[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] ) == ( uint8_t ) 0 )
+    {
+        ulHeaderLength += ( uint32_t ) mqttPUBLISH_QOS0_PACKET_IDENTIFER_LENGTH;
+    }
+    else
+    {
+        ulHeaderLength += ( uint32_t ) mqttPUBLISH_QOS1_PACKET_IDENTIFER_LENGTH;
+    }
+
+    return ulHeaderLength;
+}
+/*-----------------------------------------------------------*/
+
 static MQTTBool_t prvInvokeCallback( MQTTContext_t * pxMQTTContext,
                                      MQTTEventCallbackParams_t * pxEventCallbackParams )
 {
@@ -1937,123 +2604,347 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
          * actual length information. */
         ucDecodedByte = ( pucEncodedRemainingLength[ x ] & mqttLENGTH_BITMASK_REMAINING_LENGTH );
 
-        /* Move the extracted bits to their correct location. */
-        ulDecodedByte = ( uint32_t ) ucDecodedByte;
-        ulDecodedByte <<= ( x * ( uint32_t ) mqttLENGTH_BITS_REMAINING_LENGTH );
+        /* Move the extracted bits to their correct location. */
+        ulDecodedByte = ( uint32_t ) ucDecodedByte;
+        ulDecodedByte <<= ( x * ( uint32_t ) mqttLENGTH_BITS_REMAINING_LENGTH );
+
+        /* Place the extracted bits in the decoded length. */
+        ulDecodedRemainingLength |= ulDecodedByte;
+
+        /* If the continuation bit is not set in the current byte, decoding is
+         * complete. */
+        if( ( pucEncodedRemainingLength[ x ] & mqttREMAINING_LENGTH_CONTINUATION_BITMASK ) == ( uint8_t ) 0 )
+        {
+            break;
+        }
+    }
+
+    if( x >= ( uint32_t ) mqttREMAINING_LENGTH_MAX_BYTES )
+    {
+        /* This would happen in case 4th byte also has continuation bit set.
+         * This indicates a malformed encoded length and we inform the caller by
+         * returning 0. Note that the provided output buffer pulRemainingLength
+         * is not modified in this case. */
+        ucBytesRead = 0;
+    }
+    else
+    {
+        /* The decoding is successful. Inform the user by returning the number
+         * of bytes used in decoding from given encoded length. */
+        ucBytesRead = ( uint8_t ) x + ( uint8_t ) 1;
+
+        /* If the user has provided output buffer, return the decoded length
+         * in it. */
+        if( pulRemainingLength != NULL )
+        {
+            *pulRemainingLength = ulDecodedRemainingLength;
+        }
+    }
+
+    return ucBytesRead;
+}
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static MQTTBool_t prvStoreSubscription( MQTTContext_t * pxMQTTContext,
+                                            const uint8_t * const pucTopic,
+                                            uint16_t usTopicLength,
+                                            void * pvPublishCallbackContext,
+                                            MQTTPublishCallback_t pxPublishCallback )
+    {
+        MQTTSubscriptionManager_t * pxSubscriptionManager = &( pxMQTTContext->xSubscriptionManager );
+        MQTTBool_t xSubscriptionStored = eMQTTFalse;
+        uint16_t usNode = 0, usChild = 0, usLevelLength;
+        uint32_t ulLevelStart = 0, ulLevelEnd, ulLevels = 0;
+
+        /* Check that the topic name is not too long. */
+        if( usTopicLength <= ( uint16_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH )
+        {
+            /* Ensure that the topic is not invalid. */
+            if( prvGetTopicFilterType( pucTopic, usTopicLength ) != eMQTTTopicFilterTypeInvalid )
+            {
+                /* Follow the levels of the topic filter from the root of
+                 * the tree, adding the nodes which do not exist yet. */
+                do
+                {
+                    ulLevelEnd = prvGetTopicLevelEnd( pucTopic, usTopicLength, ulLevelStart );
+                    usLevelLength = ( uint16_t ) ( ulLevelEnd - ulLevelStart );
+                    ulLevels++;
+
+                    if( ulLevels <= ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS )
+                    {
+                        usChild = prvGetChildNode( pxSubscriptionManager, usNode, &( pucTopic[ ulLevelStart ] ), usLevelLength, eMQTTTrue );
+
+                        if( usChild == mqttSUBSCRIPTION_NO_NODE )
+                        {
+                            usChild = prvAddChildNode( pxSubscriptionManager, usNode, &( pucTopic[ ulLevelStart ] ), usLevelLength );
+
+                            if( usChild == mqttSUBSCRIPTION_NO_NODE )
+                            {
+                                /* No free node or no space for the level name. */
+                                mqttconfigDEBUG_LOG( ( "WARN: Subscription Manager full! No space left to store the topic filter levels.\r\n" ) );
+                            }
+                        }
+                    }
+                    else
+                    {
+                        /* Too many levels. */
+                        mqttconfigDEBUG_LOG( ( "WARN: Topic has too many levels and cannot be stored in the subscription manager. Consider increasing mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS.\r\n" ) );
+                        usChild = mqttSUBSCRIPTION_NO_NODE;
+                    }
+
+                    if( usChild != mqttSUBSCRIPTION_NO_NODE )
+                    {
+                        usNode = usChild;
+                    }
+
+                    ulLevelStart = ulLevelEnd + ( uint32_t ) 1;
+                } while( ( usChild != mqttSUBSCRIPTION_NO_NODE ) && ( ulLevelEnd < ( uint32_t ) usTopicLength ) );
+
+                if( usChild != mqttSUBSCRIPTION_NO_NODE )
+                {
+                    /* If the topic filter is already stored, just
+                     * replace its callback. */
+                    if( pxSubscriptionManager->xNodes[ usNode ].xSubscribed == eMQTTTrue )
+                    {
+                        xSubscriptionStored = eMQTTTrue;
+                    }
+                    else if( pxSubscriptionManager->ulInUseSubscriptions < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS )
+                    {
+                        pxSubscriptionManager->xNodes[ usNode ].xSubscribed = eMQTTTrue;
+
+                        /* Increase the in-use subscription entries count. */
+                        pxSubscriptionManager->ulInUseSubscriptions += ( uint32_t ) 1;
+                        xSubscriptionStored = eMQTTTrue;
+                    }
+                    else
+                    {
+                        /* Subscription Manager full. */
+                        mqttconfigDEBUG_LOG( ( "WARN: Subscription Manager full! No space left to store new subscriptions.\r\n" ) );
+                    }
+                }
+
+                if( xSubscriptionStored == eMQTTTrue )
+                {
+                    /* Store the subscription. */
+                    pxSubscriptionManager->xNodes[ usNode ].pvPublishCallbackContext = pvPublishCallbackContext;
+                    pxSubscriptionManager->xNodes[ usNode ].pxPublishCallback = pxPublishCallback;
+                }
+                else
+                {
+                    /* Free the nodes added for this topic filter. */
+                    prvFreeUnusedNodes( pxSubscriptionManager, usNode );
+                }
+            }
+            else
+            {
+                /* The provided topic filter is invalid. */
+                mqttconfigDEBUG_LOG( ( "WARN: The topic filter is invalid.\r\n" ) );
+            }
+        }
+        else
+        {
+            /* Topic too long. */
+            mqttconfigDEBUG_LOG( ( "WARN: Topic is too long and cannot be stored in the subscription manager. Consider increasing mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH.\r\n" ) );
+        }
+
+        return xSubscriptionStored;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static void prvRemoveSubscription( MQTTContext_t * pxMQTTContext,
+                                       const uint8_t * const pucTopic,
+                                       uint16_t usTopicLength )
+    {
+        MQTTSubscriptionManager_t * pxSubscriptionManager = &( pxMQTTContext->xSubscriptionManager );
+        uint16_t usNode = 0;
+        uint32_t ulLevelStart = 0, ulLevelEnd;
+
+        /* Follow the levels of the topic filter from the root of the
+         * tree. */
+        do
+        {
+            ulLevelEnd = prvGetTopicLevelEnd( pucTopic, usTopicLength, ulLevelStart );
+            usNode = prvGetChildNode( pxSubscriptionManager,
+                                      usNode,
+                                      &( pucTopic[ ulLevelStart ] ),
+                                      ( uint16_t ) ( ulLevelEnd - ulLevelStart ),
+                                      eMQTTTrue );
+            ulLevelStart = ulLevelEnd + ( uint32_t ) 1;
+        } while( ( usNode != mqttSUBSCRIPTION_NO_NODE ) && ( ulLevelEnd < ( uint32_t ) usTopicLength ) );
+
+        if( ( usNode != mqttSUBSCRIPTION_NO_NODE ) && ( pxSubscriptionManager->xNodes[ usNode ].xSubscribed == eMQTTTrue ) )
+        {
+            /* Found a matching subscription, remove it. */
+            pxSubscriptionManager->xNodes[ usNode ].xSubscribed = eMQTTFalse;
+            pxSubscriptionManager->xNodes[ usNode ].pxPublishCallback = NULL;
+            pxSubscriptionManager->xNodes[ usNode ].pvPublishCallbackContext = NULL;
+
+            /* Reduce the count of in-use subscription entries
+             * in the subscription manager. */
+            pxSubscriptionManager->ulInUseSubscriptions -= ( uint32_t ) 1;
+
+            /* Free the nodes no other topic filter uses. */
+            prvFreeUnusedNodes( pxSubscriptionManager, usNode );
+        }
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static void prvResetSubscriptionManager( MQTTSubscriptionManager_t * pxSubscriptionManager )
+    {
+        uint16_t x;
+
+        /* The root node has no level and no children. */
+        memset( &( pxSubscriptionManager->xNodes[ 0 ] ), 0x00, sizeof( MQTTTopicNode_t ) );
+
+        /* Link all the other nodes on the free list. */
+        for( x = 1; x < ( uint16_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES; x++ )
+        {
+            pxSubscriptionManager->xNodes[ x ].usNextSibling = ( uint16_t ) ( x + ( uint16_t ) 1 );
+        }
+
+        pxSubscriptionManager->xNodes[ mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES - 1 ].usNextSibling = mqttSUBSCRIPTION_NO_NODE;
+        pxSubscriptionManager->usFreeNodes = ( ( uint16_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES > ( uint16_t ) 1 ) ? ( uint16_t ) 1 : mqttSUBSCRIPTION_NO_NODE;
+        pxSubscriptionManager->usLevelNamesLength = 0;
+
+        /* Set the number of in-use subscription entries to zero. */
+        pxSubscriptionManager->ulInUseSubscriptions = 0;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
-        /* Place the extracted bits in the decoded length. */
-        ulDecodedRemainingLength |= ulDecodedByte;
+    static uint32_t prvGetTopicLevelEnd( const uint8_t * const pucTopic,
+                                         uint16_t usTopicLength,
+                                         uint32_t ulLevelStart )
+    {
+        uint32_t ulLevelEnd = ulLevelStart;
 
-        /* If the continuation bit is not set in the current byte, decoding is
-         * complete. */
-        if( ( pucEncodedRemainingLength[ x ] & mqttREMAINING_LENGTH_CONTINUATION_BITMASK ) == ( uint8_t ) 0 )
+        while( ( ulLevelEnd < ( uint32_t ) usTopicLength ) && ( pucTopic[ ulLevelEnd ] != ( uint8_t ) '/' ) )
         {
-            break;
+            ulLevelEnd++;
         }
-    }
 
-    if( x >= ( uint32_t ) mqttREMAINING_LENGTH_MAX_BYTES )
-    {
-        /* This would happen in case 4th byte also has continuation bit set.
-         * This indicates a malformed encoded length and we inform the caller by
-         * returning 0. Note that the provided output buffer pulRemainingLength
-         * is not modified in this case. */
-        ucBytesRead = 0;
+        return ulLevelEnd;
     }
-    else
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static uint16_t prvGetChildNode( const MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                     uint16_t usNode,
+                                     const uint8_t * const pucLevel,
+                                     uint16_t usLevelLength,
+                                     MQTTBool_t xMatchWildCards )
     {
-        /* The decoding is successful. Inform the user by returning the number
-         * of bytes used in decoding from given encoded length. */
-        ucBytesRead = ( uint8_t ) x + ( uint8_t ) 1;
+        const MQTTTopicNode_t * pxChild;
+        uint16_t usChild;
 
-        /* If the user has provided output buffer, return the decoded length
-         * in it. */
-        if( pulRemainingLength != NULL )
+        if( ( xMatchWildCards == eMQTTTrue ) && ( usLevelLength == ( uint16_t ) 1 ) && ( pucLevel[ 0 ] == ( uint8_t ) '+' ) )
         {
-            *pulRemainingLength = ulDecodedRemainingLength;
+            usChild = pxSubscriptionManager->xNodes[ usNode ].usSingleLevelChild;
+        }
+        else if( ( xMatchWildCards == eMQTTTrue ) && ( usLevelLength == ( uint16_t ) 1 ) && ( pucLevel[ 0 ] == ( uint8_t ) '#' ) )
+        {
+            usChild = pxSubscriptionManager->xNodes[ usNode ].usMultiLevelChild;
+        }
+        else
+        {
+            /* Compare the level with the names of the other children. */
+            for( usChild = pxSubscriptionManager->xNodes[ usNode ].usFirstChild;
+                 usChild != mqttSUBSCRIPTION_NO_NODE;
+                 usChild = pxChild->usNextSibling )
+            {
+                pxChild = &( pxSubscriptionManager->xNodes[ usChild ] );
+
+                if( ( pxChild->usLevelLength == usLevelLength ) &&
+                    ( memcmp( &( pxSubscriptionManager->ucLevelNames[ pxChild->usLevelOffset ] ), pucLevel, usLevelLength ) == 0 ) )
+                {
+                    break;
+                }
+            }
         }
+
+        return usChild;
     }
 
-    return ucBytesRead;
-}
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
 #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
-    static MQTTBool_t prvStoreSubscription( MQTTContext_t * pxMQTTContext,
-                                            const uint8_t * const pucTopic,
-                                            uint16_t usTopicLength,
-                                            void * pvPublishCallbackContext,
-                                            MQTTPublishCallback_t pxPublishCallback )
+    static uint16_t prvAddChildNode( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                     uint16_t usNode,
+                                     const uint8_t * const pucLevel,
+                                     uint16_t usLevelLength )
     {
-        uint32_t x;
-        MQTTBool_t xSubscriptionStored = eMQTTFalse;
-        MQTTTopicFilterType_t xTopicFilterType;
+        MQTTTopicNode_t * pxParent = &( pxSubscriptionManager->xNodes[ usNode ] );
+        MQTTTopicNode_t * pxChild;
+        uint16_t usChild = pxSubscriptionManager->usFreeNodes;
+        MQTTBool_t xIsWildCard = eMQTTFalse;
 
-        /* Is there a free entry in the subscription manager? */
-        if( pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS )
+        if( ( usLevelLength == ( uint16_t ) 1 ) && ( ( pucLevel[ 0 ] == ( uint8_t ) '+' ) || ( pucLevel[ 0 ] == ( uint8_t ) '#' ) ) )
         {
-            /* Check that the topic name is not too long. */
-            if( usTopicLength <= ( uint16_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH )
-            {
-                /* Ensure that the topic is not invalid. */
-                xTopicFilterType = prvGetTopicFilterType( pucTopic, usTopicLength );
+            /* Wild-card levels do not store their name. */
+            xIsWildCard = eMQTTTrue;
+        }
 
-                if( xTopicFilterType != eMQTTTopicFilterTypeInvalid )
-                {
-                    /* Ensure that subscription manager does not contain
-                     * an entry for the topic filter already. */
-                    prvRemoveSubscription( pxMQTTContext, pucTopic, usTopicLength );
+        if( ( xIsWildCard == eMQTTFalse ) &&
+            ( ( ( uint32_t ) pxSubscriptionManager->usLevelNamesLength + ( uint32_t ) usLevelLength ) > ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_LEVEL_NAMES_SIZE ) )
+        {
+            /* No space left to store the name of the level. */
+            usChild = mqttSUBSCRIPTION_NO_NODE;
+        }
 
-                    /* Find a free entry in the subscription manager. */
-                    for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
-                    {
-                        if( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTFalse )
-                        {
-                            /* Found a free entry. Mark it as used and
-                             * store the subscription. */
-                            pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse = eMQTTTrue;
-
-                            /* Store the subscription. */
-                            memcpy( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter,
-                                    pucTopic,
-                                    usTopicLength );
-                            pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength = usTopicLength;
-                            pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].pvPublishCallbackContext = pvPublishCallbackContext;
-                            pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].pxPublishCallback = pxPublishCallback;
-                            pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType = xTopicFilterType;
-
-                            /* Increase the in-use subscription entries count. */
-                            pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions += ( uint32_t ) 1;
-
-                            /* Inform the user that the subscription was stored
-                             * successfully. */
-                            xSubscriptionStored = eMQTTTrue;
-
-                            /* Done. */
-                            break;
-                        }
-                    }
+        if( usChild != mqttSUBSCRIPTION_NO_NODE )
+        {
+            /* Take the node from the free list. */
+            pxChild = &( pxSubscriptionManager->xNodes[ usChild ] );
+            pxSubscriptionManager->usFreeNodes = pxChild->usNextSibling;
+            memset( pxChild, 0x00, sizeof( MQTTTopicNode_t ) );
+            pxChild->usParent = usNode;
+
+            if( xIsWildCard == eMQTTTrue )
+            {
+                if( pucLevel[ 0 ] == ( uint8_t ) '+' )
+                {
+                    pxParent->usSingleLevelChild = usChild;
                 }
                 else
                 {
-                    /* The provided topic filter is invalid. */
-                    mqttconfigDEBUG_LOG( ( "WARN: The topic filter is invalid.\r\n" ) );
+                    pxParent->usMultiLevelChild = usChild;
                 }
             }
             else
             {
-                /* Topic too long. */
-                mqttconfigDEBUG_LOG( ( "WARN: Topic is too long and cannot be stored in the subscription manager. Consider increasing mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LENGTH.\r\n" ) );
+                /* Store the name of the level after the names of the
+                 * other levels. */
+                memcpy( &( pxSubscriptionManager->ucLevelNames[ pxSubscriptionManager->usLevelNamesLength ] ), pucLevel, usLevelLength );
+                pxChild->usLevelOffset = pxSubscriptionManager->usLevelNamesLength;
+                pxChild->usLevelLength = usLevelLength;
+                pxSubscriptionManager->usLevelNamesLength = ( uint16_t ) ( pxSubscriptionManager->usLevelNamesLength + usLevelLength );
+
+                /* Link the node at the front of the children of the
+                 * parent. */
+                pxChild->usNextSibling = pxParent->usFirstChild;
+                pxParent->usFirstChild = usChild;
             }
         }
-        else
-        {
-            /* Subscription Manager full. */
-            mqttconfigDEBUG_LOG( ( "WARN: Subscription Manager full! No space left to store new subscriptions.\r\n" ) );
-        }
 
-        return xSubscriptionStored;
+        return usChild;
     }
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
@@ -2061,33 +2952,76 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 
 #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
-    static void prvRemoveSubscription( MQTTContext_t * pxMQTTContext,
-                                       const uint8_t * const pucTopic,
-                                       uint16_t usTopicLength )
+    static void prvFreeUnusedNodes( MQTTSubscriptionManager_t * pxSubscriptionManager,
+                                    uint16_t usNode )
     {
-        uint32_t x;
+        MQTTTopicNode_t * pxNode, * pxParent;
+        uint16_t * pusLink;
+        uint16_t x, usParent;
 
-        /* Iterate over all the subscription entries in
-         * the subscription manager and try to find the
-         * matching one. */
-        for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
+        while( usNode != mqttSUBSCRIPTION_NO_NODE )
         {
-            if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
-                ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength == usTopicLength ) )
+            pxNode = &( pxSubscriptionManager->xNodes[ usNode ] );
+
+            /* Stop at the first node which is still in use. The root
+             * node is never freed. */
+            if( ( pxNode->xSubscribed == eMQTTTrue ) ||
+                ( pxNode->usFirstChild != mqttSUBSCRIPTION_NO_NODE ) ||
+                ( pxNode->usSingleLevelChild != mqttSUBSCRIPTION_NO_NODE ) ||
+                ( pxNode->usMultiLevelChild != mqttSUBSCRIPTION_NO_NODE ) )
+            {
+                break;
+            }
+
+            usParent = pxNode->usParent;
+            pxParent = &( pxSubscriptionManager->xNodes[ usParent ] );
+
+            /* Unlink the node from its parent. */
+            if( pxParent->usSingleLevelChild == usNode )
             {
-                if( memcmp( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter, pucTopic, usTopicLength ) == 0 )
+                pxParent->usSingleLevelChild = mqttSUBSCRIPTION_NO_NODE;
+            }
+            else if( pxParent->usMultiLevelChild == usNode )
+            {
+                pxParent->usMultiLevelChild = mqttSUBSCRIPTION_NO_NODE;
+            }
+            else
+            {
+                pusLink = &( pxParent->usFirstChild );
+
+                while( *pusLink != usNode )
                 {
-                    /* Found a matching subscription, mark it as free. */
-                    pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse = eMQTTFalse;
+                    pusLink = &( pxSubscriptionManager->xNodes[ *pusLink ].usNextSibling );
+                }
 
-                    /* Reduce the count of in-use subscription entries
-                     * in the subscription manager. */
-                    pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions -= ( uint32_t ) 1;
+                *pusLink = pxNode->usNextSibling;
 
-                    /* Done. */
-                    break;
+                /* Close the gap left by the name of the level. */
+                if( pxNode->usLevelLength > ( uint16_t ) 0 )
+                {
+                    memmove( &( pxSubscriptionManager->ucLevelNames[ pxNode->usLevelOffset ] ),
+                             &( pxSubscriptionManager->ucLevelNames[ pxNode->usLevelOffset + pxNode->usLevelLength ] ),
+                             ( size_t ) pxSubscriptionManager->usLevelNamesLength - ( size_t ) pxNode->usLevelOffset - ( size_t ) pxNode->usLevelLength );
+                    pxSubscriptionManager->usLevelNamesLength = ( uint16_t ) ( pxSubscriptionManager->usLevelNamesLength - pxNode->usLevelLength );
+
+                    /* The offsets of free nodes are updated too, which
+                     * does no harm. */
+                    for( x = 1; x < ( uint16_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_NODES; x++ )
+                    {
+                        if( pxSubscriptionManager->xNodes[ x ].usLevelOffset > pxNode->usLevelOffset )
+                        {
+                            pxSubscriptionManager->xNodes[ x ].usLevelOffset = ( uint16_t ) ( pxSubscriptionManager->xNodes[ x ].usLevelOffset - pxNode->usLevelLength );
+                        }
+                    }
                 }
             }
+
+            /* Return the node to the free list. */
+            pxNode->usLevelLength = 0;
+            pxNode->usNextSibling = pxSubscriptionManager->usFreeNodes;
+            pxSubscriptionManager->usFreeNodes = usNode;
+
+            usNode = usParent;
         }
     }
 
@@ -2135,88 +3069,85 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                                                       const MQTTPublishData_t * pxPublishData,
                                                       MQTTBool_t * pxSubscriptionCallbackInvoked )
     {
+        const MQTTSubscriptionManager_t * pxSubscriptionManager = &( pxMQTTContext->xSubscriptionManager );
+        const MQTTTopicNode_t * pxNode;
+        MQTTTopicMatch_t xBranches[ 2 * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS ];
         MQTTBool_t xBufferOwnershipTaken = eMQTTFalse;
-        MQTTSubscription_t * pxSubscription;
-        uint32_t x;
+        uint32_t ulBranches = 0, ulTopicIndex = 0, ulLevelEnd;
+        uint16_t usNode = 0;
 
         /* Set the output parameter to eMQTTFalse. It will
          * be set to eMQTTTrue if any callback is invoked. */
         *pxSubscriptionCallbackInvoked = eMQTTFalse;
 
-        /* Iterate over the subscription entries containing topic filters
-         * without any wild-cards and invoke the registered callbacks. */
-        for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
+        /* The stored topic filters have at most
+         * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS levels, and each
+         * node matched on the way to the deepest level leaves at most its '+'
+         * and '#' children to be matched later. */
+        while( xBufferOwnershipTaken == eMQTTFalse )
         {
-            if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
-                ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType == eMQTTTopicFilterTypeSimple ) &&
-                ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength == pxPublishData->usTopicLength ) )
+            pxNode = &( pxSubscriptionManager->xNodes[ usNode ] );
+
+            if( ulTopicIndex > ( uint32_t ) pxPublishData->usTopicLength )
             {
-                if( memcmp( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter, pxPublishData->pucTopic, pxPublishData->usTopicLength ) == 0 )
+                /* All the levels of the topic have been matched, so the
+                 * topic filter ending at this node matches the topic. */
+                xBufferOwnershipTaken = prvInvokeSubscriptionCallback( pxNode, pxPublishData, pxSubscriptionCallbackInvoked );
+
+                /* Filter of type "sport/#" also matches the singular
+                 * "sport" since # includes the parent level. */
+                if( ( xBufferOwnershipTaken == eMQTTFalse ) && ( pxNode->usMultiLevelChild != mqttSUBSCRIPTION_NO_NODE ) )
                 {
-                    /* Found a matching subscription. */
-                    pxSubscription = &( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ] );
+                    xBufferOwnershipTaken = prvInvokeSubscriptionCallback( &( pxSubscriptionManager->xNodes[ pxNode->usMultiLevelChild ] ),
+                                                                           pxPublishData,
+                                                                           pxSubscriptionCallbackInvoked );
+                }
 
-                    /* If a callback is registered with the subscription,
-                     * invoke it. */
-                    if( pxSubscription->pxPublishCallback != NULL )
-                    {
-                        /* Note that a callback was invoked. */
-                        *pxSubscriptionCallbackInvoked = eMQTTTrue;
+                usNode = mqttSUBSCRIPTION_NO_NODE;
+            }
+            else
+            {
+                ulLevelEnd = prvGetTopicLevelEnd( pxPublishData->pucTopic, pxPublishData->usTopicLength, ulTopicIndex );
 
-                        /* Invoke callback. */
-                        xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
+                /* Keep the '#' child, which matches the rest of the topic,
+                 * and the '+' child, which matches this level, to be
+                 * matched after the child with the same name. */
+                if( pxNode->usMultiLevelChild != mqttSUBSCRIPTION_NO_NODE )
+                {
+                    mqttconfigASSERT( ulBranches < ( uint32_t ) ( 2 * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS ) );
+                    xBranches[ ulBranches ].usNode = pxNode->usMultiLevelChild;
+                    xBranches[ ulBranches ].ulTopicIndex = ( uint32_t ) pxPublishData->usTopicLength + ( uint32_t ) 1;
+                    ulBranches++;
+                }
 
-                        /* If the user takes the buffer ownership, do
-                         * not invoke any other callbacks. */
-                        if( xBufferOwnershipTaken == eMQTTTrue )
-                        {
-                            break;
-                        }
-                    }
+                if( pxNode->usSingleLevelChild != mqttSUBSCRIPTION_NO_NODE )
+                {
+                    mqttconfigASSERT( ulBranches < ( uint32_t ) ( 2 * mqttconfigSUBSCRIPTION_MANAGER_MAX_TOPIC_LEVELS ) );
+                    xBranches[ ulBranches ].usNode = pxNode->usSingleLevelChild;
+                    xBranches[ ulBranches ].ulTopicIndex = ulLevelEnd + ( uint32_t ) 1;
+                    ulBranches++;
                 }
+
+                usNode = prvGetChildNode( pxSubscriptionManager,
+                                          usNode,
+                                          &( pxPublishData->pucTopic[ ulTopicIndex ] ),
+                                          ( uint16_t ) ( ulLevelEnd - ulTopicIndex ),
+                                          eMQTTFalse );
+                ulTopicIndex = ulLevelEnd + ( uint32_t ) 1;
             }
-        }
 
-        /* If the user has not taken the buffer ownership yet (which can
-         * happen if there is no exact matching entry in the subscription
-         * manager or the user does not take the ownership in the callback),
-         * iterate over the subscription entries containing topic filters
-         * with wild-cards and invoke the registered callbacks for the ones
-         * which match the topic. */
-        if( xBufferOwnershipTaken == eMQTTFalse )
-        {
-            for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
+            /* When a branch has been followed to its end, continue with
+             * the last one kept. */
+            if( usNode == mqttSUBSCRIPTION_NO_NODE )
             {
-                if( ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse == eMQTTTrue ) &&
-                    ( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xTopicFilterType == eMQTTTopicFilterTypeWildCard ) )
+                if( ulBranches == ( uint32_t ) 0 )
                 {
-                    if( prvDoesTopicMatchTopicFilter( pxPublishData->pucTopic,
-                                                      pxPublishData->usTopicLength,
-                                                      pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].ucTopicFilter,
-                                                      pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].usTopicFilterLength ) == eMQTTTrue )
-                    {
-                        /* Found a matching subscription. */
-                        pxSubscription = &( pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ] );
-
-                        /* If a callback is registered with the subscription,
-                         * invoke it. */
-                        if( pxSubscription->pxPublishCallback != NULL )
-                        {
-                            /* Note that a callback was invoked. */
-                            *pxSubscriptionCallbackInvoked = eMQTTTrue;
-
-                            /* Invoke callback. */
-                            xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
-
-                            /* If the user takes the buffer ownership, do
-                             * not invoke any other callbacks. */
-                            if( xBufferOwnershipTaken == eMQTTTrue )
-                            {
-                                break;
-                            }
-                        }
-                    }
+                    break;
                 }
+
+                ulBranches--;
+                usNode = xBranches[ ulBranches ].usNode;
+                ulTopicIndex = xBranches[ ulBranches ].ulTopicIndex;
             }
         }
 
@@ -2228,6 +3159,31 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static MQTTBool_t prvInvokeSubscriptionCallback( const MQTTTopicNode_t * pxNode,
+                                                     const MQTTPublishData_t * pxPublishData,
+                                                     MQTTBool_t * pxSubscriptionCallbackInvoked )
+    {
+        MQTTBool_t xBufferOwnershipTaken = eMQTTFalse;
+
+        /* If a callback is registered with the subscription,
+         * invoke it. */
+        if( ( pxNode->xSubscribed == eMQTTTrue ) && ( pxNode->pxPublishCallback != NULL ) )
+        {
+            /* Note that a callback was invoked. */
+            *pxSubscriptionCallbackInvoked = eMQTTTrue;
+
+            /* Invoke callback. */
+            xBufferOwnershipTaken = pxNode->pxPublishCallback( pxNode->pvPublishCallbackContext, pxPublishData );
+        }
+
+        return xBufferOwnershipTaken;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
 #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
     static MQTTTopicFilterType_t prvGetTopicFilterType( const uint8_t * const pucTopicFilter,
@@ -2320,113 +3276,9 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
-#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
-
-    static MQTTBool_t prvDoesTopicMatchTopicFilter( const uint8_t * const pucTopic,
-                                                    uint16_t usTopicLength,
-                                                    const uint8_t * const pucTopicFilter,
-                                                    uint16_t usTopicFilterLength )
-    {
-        MQTTBool_t xTopicMatchesTopicFilter = eMQTTFalse;
-        uint16_t usTopicIndex = 0, usTopicFilterIndex = 0;
-
-        while( ( usTopicIndex < usTopicLength ) && ( usTopicFilterIndex < usTopicFilterLength ) )
-        {
-            /* Does the character in the topic string matches the
-             * corresponding one in the topic filter string? */
-            if( pucTopic[ usTopicIndex ] == pucTopicFilter[ usTopicFilterIndex ] )
-            {
-                /* Handle special corner cases as documented by
-                 * the MQTT protocol spec. */
-
-                /* Filter of type "sport/#" also matches the singular
-                 * "sport" since # includes the parent level. */
-                if( ( usTopicIndex == usTopicLength - ( uint16_t ) 1 ) &&
-                    ( usTopicFilterIndex == usTopicFilterLength - ( uint16_t ) 3 ) &&
-                    ( pucTopicFilter[ usTopicFilterIndex + ( uint16_t ) 1 ] == ( uint8_t ) '/' ) &&
-                    ( pucTopicFilter[ usTopicFilterIndex + ( uint16_t ) 2 ] == ( uint8_t ) '#' ) )
-                {
-                    xTopicMatchesTopicFilter = eMQTTTrue;
-                    break;
-                }
-
-                /* Filter of type "sport/+" also matches the "sport/"
-                 * but not "sport". */
-                if( ( usTopicIndex == usTopicLength - ( uint16_t ) 1 ) &&
-                    ( usTopicFilterIndex == usTopicFilterLength - ( uint16_t ) 2 ) &&
-                    ( pucTopicFilter[ usTopicFilterIndex + ( uint16_t ) 1 ] == ( uint8_t ) '+' ) )
-                {
-                    xTopicMatchesTopicFilter = eMQTTTrue;
-                    break;
-                }
-            }
-            else
-            {
-                if( pucTopicFilter[ usTopicFilterIndex ] == ( uint8_t ) '+' )
-                {
-                    /* Consume the current topic level which is until
-                     * we encounter '/' in the topic string or the end
-                     * of the topic string. */
-                    while( usTopicIndex < usTopicLength && pucTopic[ usTopicIndex ] != ( uint8_t ) '/' )
-                    {
-                        usTopicIndex++;
-                    }
-
-                    /* Since we are already at the '/' character or at
-                     * the end in the topic string, increment the topic
-                     * filter index here and skip the index increments
-                     * at the end of the loop. */
-                    usTopicFilterIndex++;
-                    continue;
-                }
-                else if( pucTopicFilter[ usTopicFilterIndex ] == ( uint8_t ) '#' )
-                {
-                    /* Since it is assumed that the given topic filter
-                     * is a valid topic filter, this must be the last
-                     * character in it. The rest of the topic string
-                     * matches this multi-level wild-card and hence this
-                     * is a match. */
-                    xTopicMatchesTopicFilter = eMQTTTrue;
-                    break;
-                }
-                else
-                {
-                    /* Any character mismatch other than '+' or
-                     * '#' means the topic does not match the
-                     * given filter. */
-                    break;
-                }
-            }
-
-            /* Increment indexes. */
-            usTopicIndex++;
-            usTopicFilterIndex++;
-        }
-
-        /* If the topic is not matched yet and both topic
-         * and topic filter strings are consumed, it's a match
-         * else we would have broken the loop in between.*/
-        if( ( xTopicMatchesTopicFilter == eMQTTFalse ) &&
-            ( ( usTopicIndex > ( uint16_t ) 0 ) && ( usTopicIndex >= usTopicLength ) ) &&
-            ( ( usTopicFilterIndex > ( uint16_t ) 0 ) && ( usTopicFilterIndex >= usTopicFilterLength ) ) )
-        {
-            xTopicMatchesTopicFilter = eMQTTTrue;
-        }
-
-        /* Return the result. */
-        return xTopicMatchesTopicFilter;
-    }
-
-#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
-/*-----------------------------------------------------------*/
-
 MQTTReturnCode_t MQTT_Init( MQTTContext_t * pxMQTTContext,
                             const MQTTInitParams_t * const pxInitParams )
 {
-    #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
-        uint32_t x;
-    #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
-
     /* These are checked here once and are later used without
      * NULL checks. */
     mqttconfigASSERT( pxMQTTContext != NULL );
@@ -2459,17 +3311,22 @@ MQTTReturnCode_t MQTT_Init( MQTTContext_t * pxMQTTContext,
     pxMQTTContext->xBufferPoolInterface = pxInitParams->xBufferPoolInterface;
 
     #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+        /* Start with no subscriptions. */
+        prvResetSubscriptionManager( &( pxMQTTContext->xSubscriptionManager ) );
+    #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
-        /* Mark all the subscription entires in the subscription
-         * manager as free. */
-        for( x = 0; x < ( uint32_t ) mqttconfigSUBSCRIPTION_MANAGER_MAX_SUBSCRIPTIONS; x++ )
-        {
-            pxMQTTContext->xSubscriptionManager.xSubscriptions[ x ].xInUse = eMQTTFalse;
-        }
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        /* Store in-flight message store interface. The messages already in
+         * the store are kept for the first connection. */
+        pxMQTTContext->xInFlightStoreInterface = pxInitParams->xInFlightStoreInterface;
+        memset( &( pxMQTTContext->xInFlightStoreStats ), 0x00, sizeof( MQTTInFlightStoreStats_t ) );
+        pxMQTTContext->xInFlightResendPending = eMQTTFalse;
 
-        /* Set the number of in-use subscription entries to zero. */
-        pxMQTTContext->xSubscriptionManager.ulInUseSubscriptions = 0;
-    #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+        mqttconfigASSERT( ( pxInitParams->xInFlightStoreInterface.pxWriteFxn == NULL ) ||
+                          ( ( pxInitParams->xInFlightStoreInterface.pxReadFxn != NULL ) &&
+                            ( pxInitParams->xInFlightStoreInterface.pxNextFxn != NULL ) &&
+                            ( pxInitParams->xInFlightStoreInterface.pxRemoveFxn != NULL ) ) );
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
 
     return eMQTTSuccess;
 }
@@ -2492,7 +3349,7 @@ MQTTReturnCode_t MQTT_Connect( MQTTContext_t * pxMQTTContext,
         ( uint8_t ) 'T',                /* Protocol name byte 2. */
         ( uint8_t ) 'T',                /* Protocol name byte 3. */
         mqttPROTOCOL_LEVEL,             /* Protocol level. */
-        mqttCONNECT_CLEAN_SESSION_FLAG, /* AWS IoT Broker does not support persistent sessions i.e. Clean Session flag must be set. */
+        mqttCONNECT_CLEAN_SESSION_FLAG, /* Clean Session flag is set unless the user asks to resume the session, which needs the in-flight message store. */
         ( uint8_t ) 0,                  /* Keep-alive time in seconds MSB. */
         ( uint8_t ) 0,                  /* Keep-alive time in seconds LSB. */
     };
@@ -2581,6 +3438,14 @@ MQTTReturnCode_t MQTT_Connect( MQTTContext_t * pxMQTTContext,
                     mqttbufferGET_DATA( xBuffer )[ mqttADJUST_OFFSET( mqttCONNECT_FLAGS_OFFSET, ucRemainingLengthFieldBytes ) ] |= mqttCONNECT_USER_NAME_FLAG;
                 }
 
+                #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+                    /* Update the clean session flag. */
+                    if( pxConnectParams->xCleanSession == eMQTTFalse )
+                    {
+                        mqttbufferGET_DATA( xBuffer )[ mqttADJUST_OFFSET( mqttCONNECT_FLAGS_OFFSET, ucRemainingLengthFieldBytes ) ] &= ( uint8_t ) ~mqttCONNECT_CLEAN_SESSION_FLAG;
+                    }
+                #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
                 /* Update keep alive timeout. */
                 mqttbufferGET_DATA( xBuffer )[ mqttADJUST_OFFSET( mqttCONNECT_KEEPALIVE_MSB_OFFSET,
                                                                   ucRemainingLengthFieldBytes ) ] = ( uint8_t ) ( pxConnectParams->usKeepAliveIntervalSeconds >> mqttBITS_PER_BYTE );
@@ -2964,11 +3829,15 @@ MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
                                const MQTTPublishParams_t * const pxPublishParams )
 {
     uint8_t * pucNextByte, * pucLastByteInBuffer, ucRemainingLengthFieldBytes;
-    uint32_t ulRemainingLength, ulTotalMessageLength;
+    uint32_t ulRemainingLength, ulTotalMessageLength, ulHeaderLength, ulFreeLength = 0;
     uint16_t usTopicLength;
     MQTTBufferHandle_t xBuffer = NULL;
     MQTTReturnCode_t xReturnCode = eMQTTFailure;
 
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        MQTTBool_t xStored = eMQTTFalse;
+    #endif
+
     /* These are checked here once and are later used without
      * NULL checks. */
     mqttconfigASSERT( pxMQTTContext != NULL );
@@ -3004,9 +3873,21 @@ MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
             /* Calculate total MQTT message length. */
             ulTotalMessageLength = mqttTOTAL_MESSAGE_LENGTH( ucRemainingLengthFieldBytes, ulRemainingLength );
 
+            /* Length of the fixed and variable headers i.e. everything but the data. */
+            ulHeaderLength = ulTotalMessageLength - pxPublishParams->ulDataLength;
+
             /* Try to get a buffer from the free buffer pool. */
             xBuffer = prvGetFreeBuffer( pxMQTTContext, ulTotalMessageLength );
 
+            /* If the whole message does not fit in one buffer, get one for
+             * the headers only and transmit the data separately. The data is
+             * read into the rest of the buffer if the user has supplied a read
+             * callback, so leave space for at least one byte of it. */
+            if( xBuffer == NULL )
+            {
+                xBuffer = prvGetFreeBuffer( pxMQTTContext, ulHeaderLength + ( ( pxPublishParams->pxReadFxn != NULL ) ? ( uint32_t ) 1 : ( uint32_t ) 0 ) );
+            }
+
             if( xBuffer == NULL )
             {
                 /* Fail the publish operation immediately, if
@@ -3059,28 +3940,97 @@ MQTTReturnCode_t MQTT_Publish( MQTTContext_t * pxMQTTContext,
                     pucNextByte++;
                 }
 
-                /* Write the payload into the message. */
-                memcpy( pucNextByte, pxPublishParams->pvData, ( size_t ) pxPublishParams->ulDataLength );
+                /* Space left in the buffer after the headers. */
+                ulFreeLength = mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBuffer ) - ulHeaderLength;
 
                 /* Store the packet identifier in TxBuffer also for matching
                  * ACK later. */
                 mqttbufferGET_PACKET_IDENTIFIER( xBuffer ) = pxPublishParams->usPacketIdentifier;
 
-                /* Update the number of bytes written to the buffer. */
-                mqttbufferGET_DATA_LENGTH( xBuffer ) = ulTotalMessageLength;
+                if( pxPublishParams->ulDataLength <= ulFreeLength )
+                {
+                    /* Write the payload into the message. */
+                    if( pxPublishParams->pxReadFxn == NULL )
+                    {
+                        memcpy( pucNextByte, pxPublishParams->pvData, ( size_t ) pxPublishParams->ulDataLength );
+                        xReturnCode = eMQTTSuccess;
+                    }
+                    else
+                    {
+                        xReturnCode = prvReadPublishData( pxPublishParams, 0, pucNextByte, pxPublishParams->ulDataLength );
+                    }
 
-                /* MQTT packet created. */
-                xReturnCode = eMQTTSuccess;
+                    /* Update the number of bytes written to the buffer. */
+                    mqttbufferGET_DATA_LENGTH( xBuffer ) = ulTotalMessageLength;
+                }
+                else
+                {
+                    /* Only the headers are in the buffer, the payload is
+                     * transmitted after them. */
+                    mqttbufferGET_DATA_LENGTH( xBuffer ) = ulHeaderLength;
+                    xReturnCode = eMQTTSuccess;
+                }
             }
         }
     }
 
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+        /* If the packet was successfully constructed, write it to the
+         * in-flight store before transmitting it, if it is QoS1. */
+        if( xReturnCode == eMQTTSuccess )
+        {
+            xReturnCode = prvStoreInFlightPublish( pxMQTTContext,
+                                                   pxPublishParams,
+                                                   ulTotalMessageLength,
+                                                   0,
+                                                   mqttbufferGET_DATA( xBuffer ),
+                                                   mqttbufferGET_DATA_LENGTH( xBuffer ) );
+
+            if( xReturnCode == eMQTTSuccess )
+            {
+                xStored = ( ( pxPublishParams->xQos == eMQTTQoS1 ) && ( pxMQTTContext->xInFlightStoreInterface.pxWriteFxn != NULL ) ) ? eMQTTTrue : eMQTTFalse;
+            }
+            else
+            {
+                pxMQTTContext->xInFlightStoreStats.ulStoreFailures++;
+            }
+        }
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
     /* If the packet was successfully constructed, transmit it. */
     if( xReturnCode == eMQTTSuccess )
     {
         xReturnCode = prvSendData( pxMQTTContext, mqttbufferGET_DATA( xBuffer ), mqttbufferGET_DATA_LENGTH( xBuffer ) );
+
+        /* Transmit the payload, if it did not fit in the buffer. */
+        if( ( xReturnCode == eMQTTSuccess ) && ( mqttbufferGET_DATA_LENGTH( xBuffer ) < ulTotalMessageLength ) )
+        {
+            xReturnCode = prvSendPublishData( pxMQTTContext,
+                                              pxPublishParams,
+                                              ulHeaderLength,
+                                              &( mqttbufferGET_DATA( xBuffer )[ ulHeaderLength ] ),
+                                              ulFreeLength );
+        }
     }
 
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+        /* The user is told that the publish failed, so do not retransmit the
+         * message later. */
+        if( xStored == eMQTTTrue )
+        {
+            if( xReturnCode == eMQTTSuccess )
+            {
+                pxMQTTContext->xInFlightStoreStats.ulStored++;
+            }
+            else
+            {
+                ( void ) prvRemoveInFlightPublish( pxMQTTContext, pxPublishParams->usPacketIdentifier );
+            }
+        }
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
     /* If some error occurred or QOS0 (No ACK is expected in case of QOS0),
      * return the buffer, otherwise it will be returned upon receiving ACK
      * or timeout. */
@@ -3100,7 +4050,7 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
 {
     MQTTReturnCode_t xReturnCode = eMQTTSuccess;
     MQTTEventCallbackParams_t xEventCallbackParams;
-    size_t xProcessedBytes = 0, xExpectedBytes, xUnprocessedBytes;
+    size_t xProcessedBytes = 0, xExpectedBytes, xUnprocessedBytes, xFreeBytes;
 
     /* These are checked here once and are later used without
      * NULL checks. */
@@ -3198,8 +4148,20 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
                 {
                     /* Get a buffer to store the received message. */
                     pxMQTTContext->xRxBuffer = prvGetFreeBuffer( pxMQTTContext, pxMQTTContext->xRxMessageState.ulTotalMessageLength );
+                    pxMQTTContext->xRxMessageState.xRxMessageAction = eMQTTRxMessageStore; /*_TODO_ This needs a timeout in case the rest of the message never comes. */
+
+                    /* A publish message too large for one buffer can still be
+                     * passed to the user in fragments, if a smaller buffer is
+                     * available. */
+                    if( ( pxMQTTContext->xRxBuffer == NULL ) &&
+                        ( mqttconfigRX_FRAGMENT_BUFFER_LENGTH > 0 ) &&
+                        ( ( pxMQTTContext->ucRxFixedHeaderBuffer[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] & mqttTOP_NIBBLE_MASK ) == mqttCONTROL_PUBLISH ) )
+                    {
+                        pxMQTTContext->xRxBuffer = prvGetFreeBuffer( pxMQTTContext, mqttconfigRX_FRAGMENT_BUFFER_LENGTH );
+                        pxMQTTContext->xRxMessageState.xRxMessageAction = eMQTTRxMessageStream;
+                    }
 
-                    /* If we got a large enough free buffer, store the rest of the message. */
+                    /* If we got a free buffer, store the rest of the message. */
                     if( pxMQTTContext->xRxBuffer != NULL )
                     {
                         /* Copy the fixed header in the Rx buffer. */
@@ -3207,7 +4169,6 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
                         mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ) = pxMQTTContext->ulRxMessageReceivedLength;
 
                         pxMQTTContext->xRxMessageState.xRxNextByte = eMQTTRxNextByteMessage;
-                        pxMQTTContext->xRxMessageState.xRxMessageAction = eMQTTRxMessageStore; /*_TODO_ This needs a timeout in case the rest of the message never comes. */
                     }
                     else
                     {
@@ -3247,6 +4208,26 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
                 prvResetRxMessageState( pxMQTTContext );
             }
         }
+        else if( ( pxMQTTContext->xRxMessageState.xRxNextByte == eMQTTRxNextByteMessage ) && ( pxMQTTContext->xRxMessageState.xRxMessageAction == eMQTTRxMessageStream ) )
+        {
+            /* These many bytes are still needed to constitute a packet. */
+            xExpectedBytes = pxMQTTContext->xRxMessageState.ulTotalMessageLength -
+                             ( pxMQTTContext->xRxMessageState.ulStreamedLength + mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ) );
+
+            /* These many bytes are still there to be processed. */
+            xUnprocessedBytes = xReceivedDataLength - xProcessedBytes;
+
+            /* These many bytes fit in the buffer before it has to be passed to the user. */
+            xFreeBytes = mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( pxMQTTContext->xRxBuffer ) - mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer );
+
+            /* Copy as many bytes as are available and fit in the buffer,
+             * then pass the buffer to the user if it is full or the
+             * message is complete. */
+            xUnprocessedBytes = mqttMIN( mqttMIN( xUnprocessedBytes, xExpectedBytes ), xFreeBytes );
+            mqttCOPY_BYTES( pucReceivedData, xProcessedBytes, mqttbufferGET_DATA( pxMQTTContext->xRxBuffer ), mqttbufferGET_DATA_LENGTH( pxMQTTContext->xRxBuffer ), xUnprocessedBytes );
+
+            prvProcessReceivedPublishFragment( pxMQTTContext );
+        }
         else if( ( pxMQTTContext->xRxMessageState.xRxNextByte == eMQTTRxNextByteMessage ) && ( pxMQTTContext->xRxMessageState.xRxMessageAction == eMQTTRxMessageDrop ) )
         {
             xExpectedBytes = pxMQTTContext->xRxMessageState.ulTotalMessageLength - pxMQTTContext->ulRxMessageReceivedLength; /* These many bytes are still needed to constitute a packet. */
@@ -3358,6 +4339,19 @@ uint32_t MQTT_Periodic( MQTTContext_t * pxMQTTContext,
                     }
                 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
+                #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+                    /* The user is told that the publish failed, so do not
+                     * retransmit the message later. */
+                    if( ( mqttbufferGET_DATA( xBuffer )[ mqttFIXED_HEADER_CONTROL_BYTE_OFFSET ] & mqttTOP_NIBBLE_MASK ) == mqttCONTROL_PUBLISH )
+                    {
+                        if( prvRemoveInFlightPublish( pxMQTTContext, mqttbufferGET_PACKET_IDENTIFIER( xBuffer ) ) == eMQTTTrue )
+                        {
+                            pxMQTTContext->xInFlightStoreStats.ulDiscarded++;
+                        }
+                    }
+                #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
                 /* Inform the user about the timeout. */
                 xEventCallbackParams.xEventType = eMQTTTimeout;
                 xEventCallbackParams.u.xTimeoutData.usPacketIdentifier = mqttbufferGET_PACKET_IDENTIFIER( xBuffer );
@@ -3375,6 +4369,16 @@ uint32_t MQTT_Periodic( MQTTContext_t * pxMQTTContext,
         }
     }
 
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+        /* Retry retransmitting the stored messages, if no buffer was
+         * available when the session was resumed. */
+        if( ( pxMQTTContext->xConnectionState == eMQTTConnected ) && ( pxMQTTContext->xInFlightResendPending == eMQTTTrue ) )
+        {
+            prvResendInFlightPublishes( pxMQTTContext );
+        }
+    #endif /* mqttconfigENABLE_INFLIGHT_STORE */
+
     /* Check if the previously sent keep alive timed out,
      * or it is time to send a keep alive message. */
     if( pxMQTTContext->xConnectionState == eMQTTConnected )
@@ -0,0 +1,383 @@
+/*
+ * Amazon FreeRTOS MQTT Library V1.1.4
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_mqtt_store_ram.c
+ * @brief In-flight message store kept in RAM.
+ */
+
+/* Interface includes. */
+#include "aws_mqtt_store.h"
+
+/* Standard includes. */
+#include <string.h>
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+/**
+ * @brief Header stored in front of each message.
+ */
+    typedef struct MQTTRAMStoreEntry
+    {
+        uint32_t ulPacketLength;     /**< Length of the message. */
+        uint16_t usPacketIdentifier; /**< Packet identifier of the message. */
+        uint16_t usRemoved;          /**< Non-zero once the message is removed. */
+    } MQTTRAMStoreEntry_t;
+
+/**
+ * @brief Number of bytes used in the ring buffer by a message.
+ */
+    #define mqttramstoreENTRY_LENGTH( ulPacketLength )    ( ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) + ( ulPacketLength ) )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Copies data into the ring buffer, wrapping around its end.
+ *
+ * @param[in] pxStore The store.
+ * @param[in] ulPosition The offset in the ring buffer to copy to.
+ * @param[in] pvData The data to copy.
+ * @param[in] ulLength The length of the data.
+ */
+    static void prvCopyToRing( MQTTRAMStore_t * pxStore,
+                               uint32_t ulPosition,
+                               const void * pvData,
+                               uint32_t ulLength );
+
+/**
+ * @brief Copies data out of the ring buffer, wrapping around its end.
+ *
+ * @param[in] pxStore The store.
+ * @param[in] ulPosition The offset in the ring buffer to copy from.
+ * @param[out] pvData The buffer to copy to.
+ * @param[in] ulLength The length of the data.
+ */
+    static void prvCopyFromRing( const MQTTRAMStore_t * pxStore,
+                                 uint32_t ulPosition,
+                                 void * pvData,
+                                 uint32_t ulLength );
+
+/**
+ * @brief Finds a stored message which has not been removed.
+ *
+ * @param[in] pxStore The store.
+ * @param[in] usPacketIdentifier The packet identifier of the message.
+ * @param[out] pulPosition The offset in the ring buffer of the header of the
+ * message.
+ * @param[out] pxEntry The header of the message.
+ *
+ * @return eMQTTTrue if the message was found, eMQTTFalse otherwise.
+ */
+    static MQTTBool_t prvFindEntry( const MQTTRAMStore_t * pxStore,
+                                    uint16_t usPacketIdentifier,
+                                    uint32_t * pulPosition,
+                                    MQTTRAMStoreEntry_t * pxEntry );
+
+/**
+ * @brief Offset in the ring buffer which follows the given message.
+ *
+ * @param[in] ulPosition The offset in the ring buffer of the header of the
+ * message.
+ * @param[in] pxEntry The header of the message.
+ *
+ * @return The offset of the next message.
+ */
+    static uint32_t prvNextPosition( uint32_t ulPosition,
+                                     const MQTTRAMStoreEntry_t * pxEntry );
+
+/*-----------------------------------------------------------*/
+
+    static void prvCopyToRing( MQTTRAMStore_t * pxStore,
+                               uint32_t ulPosition,
+                               const void * pvData,
+                               uint32_t ulLength )
+    {
+        uint32_t ulFirstLength = ( uint32_t ) mqttconfigINFLIGHT_STORE_RAM_SIZE - ulPosition;
+
+        if( ulFirstLength >= ulLength )
+        {
+            memcpy( &( pxStore->ucBuffer[ ulPosition ] ), pvData, ( size_t ) ulLength );
+        }
+        else
+        {
+            memcpy( &( pxStore->ucBuffer[ ulPosition ] ), pvData, ( size_t ) ulFirstLength );
+            memcpy( pxStore->ucBuffer, &( ( ( const uint8_t * ) pvData )[ ulFirstLength ] ), ( size_t ) ( ulLength - ulFirstLength ) ); /*lint !e9079 !e9087 The data is accessed as bytes. */
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvCopyFromRing( const MQTTRAMStore_t * pxStore,
+                                 uint32_t ulPosition,
+                                 void * pvData,
+                                 uint32_t ulLength )
+    {
+        uint32_t ulFirstLength = ( uint32_t ) mqttconfigINFLIGHT_STORE_RAM_SIZE - ulPosition;
+
+        if( ulFirstLength >= ulLength )
+        {
+            memcpy( pvData, &( pxStore->ucBuffer[ ulPosition ] ), ( size_t ) ulLength );
+        }
+        else
+        {
+            memcpy( pvData, &( pxStore->ucBuffer[ ulPosition ] ), ( size_t ) ulFirstLength );
+            memcpy( &( ( ( uint8_t * ) pvData )[ ulFirstLength ] ), pxStore->ucBuffer, ( size_t ) ( ulLength - ulFirstLength ) ); /*lint !e9079 !e9087 The data is accessed as bytes. */
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static uint32_t prvNextPosition( uint32_t ulPosition,
+                                     const MQTTRAMStoreEntry_t * pxEntry )
+    {
+        return ( ulPosition + mqttramstoreENTRY_LENGTH( pxEntry->ulPacketLength ) ) % ( uint32_t ) mqttconfigINFLIGHT_STORE_RAM_SIZE;
+    }
+/*-----------------------------------------------------------*/
+
+    static MQTTBool_t prvFindEntry( const MQTTRAMStore_t * pxStore,
+                                    uint16_t usPacketIdentifier,
+                                    uint32_t * pulPosition,
+                                    MQTTRAMStoreEntry_t * pxEntry )
+    {
+        uint32_t ulPosition = pxStore->ulTail, ulRemainingLength = pxStore->ulUsedLength;
+        MQTTBool_t xFound = eMQTTFalse;
+
+        while( ( xFound == eMQTTFalse ) && ( ulRemainingLength > ( uint32_t ) 0 ) )
+        {
+            prvCopyFromRing( pxStore, ulPosition, pxEntry, ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) );
+
+            if( ( pxEntry->usRemoved == ( uint16_t ) 0 ) && ( pxEntry->usPacketIdentifier == usPacketIdentifier ) )
+            {
+                *pulPosition = ulPosition;
+                xFound = eMQTTTrue;
+            }
+            else
+            {
+                ulRemainingLength -= mqttramstoreENTRY_LENGTH( pxEntry->ulPacketLength );
+                ulPosition = prvNextPosition( ulPosition, pxEntry );
+            }
+        }
+
+        return xFound;
+    }
+/*-----------------------------------------------------------*/
+
+    void MQTT_RAMSTORE_Init( void * pvStoreContext )
+    {
+        MQTTRAMStore_t * pxStore = ( MQTTRAMStore_t * ) pvStoreContext; /*lint !e9087 The context is always the store. */
+
+        pxStore->ulHead = 0;
+        pxStore->ulTail = 0;
+        pxStore->ulUsedLength = 0;
+    }
+/*-----------------------------------------------------------*/
+
+    MQTTReturnCode_t MQTT_RAMSTORE_Write( void * pvStoreContext,
+                                          uint16_t usPacketIdentifier,
+                                          uint32_t ulPacketLength,
+                                          uint32_t ulOffset,
+                                          const uint8_t * pucData,
+                                          uint32_t ulDataLength )
+    {
+        MQTTRAMStore_t * pxStore = ( MQTTRAMStore_t * ) pvStoreContext; /*lint !e9087 The context is always the store. */
+        MQTTRAMStoreEntry_t xEntry;
+        uint32_t ulPosition;
+        MQTTReturnCode_t xReturnCode = eMQTTSuccess;
+
+        if( ulOffset == ( uint32_t ) 0 )
+        {
+            /* A new message, reserve space for all of it. */
+            if( prvFindEntry( pxStore, usPacketIdentifier, &ulPosition, &xEntry ) == eMQTTTrue )
+            {
+                xReturnCode = eMQTTFailure;
+            }
+            else if( ( ulPacketLength > ( ( uint32_t ) mqttconfigINFLIGHT_STORE_RAM_SIZE - ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) ) ) ||
+                     ( mqttramstoreENTRY_LENGTH( ulPacketLength ) > ( ( uint32_t ) mqttconfigINFLIGHT_STORE_RAM_SIZE - pxStore->ulUsedLength ) ) )
+            {
+                xReturnCode = eMQTTNoFreeBuffer;
+            }
+            else
+            {
+                xEntry.ulPacketLength = ulPacketLength;
+                xEntry.usPacketIdentifier = usPacketIdentifier;
+                xEntry.usRemoved = 0;
+
+                ulPosition = pxStore->ulHead;
+                prvCopyToRing( pxStore, ulPosition, &xEntry, ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) );
+
+                pxStore->ulHead = prvNextPosition( ulPosition, &xEntry );
+                pxStore->ulUsedLength += mqttramstoreENTRY_LENGTH( ulPacketLength );
+            }
+        }
+        else if( prvFindEntry( pxStore, usPacketIdentifier, &ulPosition, &xEntry ) == eMQTTFalse )
+        {
+            xReturnCode = eMQTTFailure;
+        }
+        else
+        {
+            /* Part of a message already reserved. */
+        }
+
+        if( xReturnCode == eMQTTSuccess )
+        {
+            if( ( ulOffset > xEntry.ulPacketLength ) || ( ulDataLength > ( xEntry.ulPacketLength - ulOffset ) ) )
+            {
+                xReturnCode = eMQTTFailure;
+            }
+            else
+            {
+                prvCopyToRing( pxStore,
+                               ( ulPosition + ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) + ulOffset ) % ( uint32_t ) mqttconfigINFLIGHT_STORE_RAM_SIZE,
+                               pucData,
+                               ulDataLength );
+            }
+        }
+
+        return xReturnCode;
+    }
+/*-----------------------------------------------------------*/
+
+    uint32_t MQTT_RAMSTORE_Read( void * pvStoreContext,
+                                 uint16_t usPacketIdentifier,
+                                 uint32_t ulOffset,
+                                 uint8_t * pucBuffer,
+                                 uint32_t ulBufferLength )
+    {
+        MQTTRAMStore_t * pxStore = ( MQTTRAMStore_t * ) pvStoreContext; /*lint !e9087 The context is always the store. */
+        MQTTRAMStoreEntry_t xEntry;
+        uint32_t ulPosition, ulReadLength = 0;
+
+        if( ( prvFindEntry( pxStore, usPacketIdentifier, &ulPosition, &xEntry ) == eMQTTTrue ) &&
+            ( ulOffset < xEntry.ulPacketLength ) )
+        {
+            ulReadLength = xEntry.ulPacketLength - ulOffset;
+
+            if( ulReadLength > ulBufferLength )
+            {
+                ulReadLength = ulBufferLength;
+            }
+
+            prvCopyFromRing( pxStore,
+                             ( ulPosition + ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) + ulOffset ) % ( uint32_t ) mqttconfigINFLIGHT_STORE_RAM_SIZE,
+                             pucBuffer,
+                             ulReadLength );
+        }
+
+        return ulReadLength;
+    }
+/*-----------------------------------------------------------*/
+
+    uint16_t MQTT_RAMSTORE_Next( void * pvStoreContext,
+                                 uint16_t usPacketIdentifier,
+                                 uint32_t * pulPacketLength )
+    {
+        MQTTRAMStore_t * pxStore = ( MQTTRAMStore_t * ) pvStoreContext; /*lint !e9087 The context is always the store. */
+        MQTTRAMStoreEntry_t xEntry;
+        uint32_t ulPosition = pxStore->ulTail, ulRemainingLength = pxStore->ulUsedLength;
+        uint16_t usNextPacketIdentifier = 0;
+        MQTTBool_t xPreviousFound = ( usPacketIdentifier == ( uint16_t ) 0 ) ? eMQTTTrue : eMQTTFalse;
+
+        /* Skip up to and including the given message, then return the first
+         * message which has not been removed. */
+        while( ( usNextPacketIdentifier == ( uint16_t ) 0 ) && ( ulRemainingLength > ( uint32_t ) 0 ) )
+        {
+            prvCopyFromRing( pxStore, ulPosition, &xEntry, ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) );
+
+            if( xEntry.usRemoved == ( uint16_t ) 0 )
+            {
+                if( xPreviousFound == eMQTTTrue )
+                {
+                    usNextPacketIdentifier = xEntry.usPacketIdentifier;
+                    *pulPacketLength = xEntry.ulPacketLength;
+                }
+                else if( xEntry.usPacketIdentifier == usPacketIdentifier )
+                {
+                    xPreviousFound = eMQTTTrue;
+                }
+                else
+                {
+                    /* Not yet reached the given message. */
+                }
+            }
+
+            ulRemainingLength -= mqttramstoreENTRY_LENGTH( xEntry.ulPacketLength );
+            ulPosition = prvNextPosition( ulPosition, &xEntry );
+        }
+
+        return usNextPacketIdentifier;
+    }
+/*-----------------------------------------------------------*/
+
+    MQTTBool_t MQTT_RAMSTORE_Remove( void * pvStoreContext,
+                                     uint16_t usPacketIdentifier )
+    {
+        MQTTRAMStore_t * pxStore = ( MQTTRAMStore_t * ) pvStoreContext; /*lint !e9087 The context is always the store. */
+        MQTTRAMStoreEntry_t xEntry;
+        uint32_t ulPosition, ulLength;
+        MQTTBool_t xRemoved = eMQTTFalse;
+
+        if( usPacketIdentifier == ( uint16_t ) 0 )
+        {
+            ulLength = 0;
+            xRemoved = ( MQTT_RAMSTORE_Next( pvStoreContext, 0, &ulLength ) != ( uint16_t ) 0 ) ? eMQTTTrue : eMQTTFalse;
+            MQTT_RAMSTORE_Init( pvStoreContext );
+        }
+        else if( prvFindEntry( pxStore, usPacketIdentifier, &ulPosition, &xEntry ) == eMQTTTrue )
+        {
+            xEntry.usRemoved = 1;
+            prvCopyToRing( pxStore, ulPosition, &xEntry, ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) );
+            xRemoved = eMQTTTrue;
+
+            /* Reclaim the space of the removed messages at the tail. */
+            while( xEntry.usRemoved != ( uint16_t ) 0 )
+            {
+                prvCopyFromRing( pxStore, pxStore->ulTail, &xEntry, ( uint32_t ) sizeof( MQTTRAMStoreEntry_t ) );
+
+                if( xEntry.usRemoved != ( uint16_t ) 0 )
+                {
+                    pxStore->ulUsedLength -= mqttramstoreENTRY_LENGTH( xEntry.ulPacketLength );
+                    pxStore->ulTail = prvNextPosition( pxStore->ulTail, &xEntry );
+
+                    if( pxStore->ulUsedLength == ( uint32_t ) 0 )
+                    {
+                        /* The store is empty. */
+                        xEntry.usRemoved = 0;
+                    }
+                }
+            }
+
+            if( pxStore->ulUsedLength == ( uint32_t ) 0 )
+            {
+                MQTT_RAMSTORE_Init( pvStoreContext );
+            }
+        }
+        else
+        {
+            /* The message is not stored. */
+        }
+
+        return xRemoved;
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
@@ -50,6 +50,9 @@ typedef struct SSOCKETContext
     char ** ppcAlpnProtocols;
     uint32_t ulAlpnProtocolsCount;
     BaseType_t xConnectAttempted;
+    #if ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 )
+        void ( * pxUserWakeCallback )( Socket_t xSocket );
+    #endif
 } SSOCKETContext_t, * SSOCKETContextPtr_t;
 
 /*
@@ -82,6 +85,24 @@ static BaseType_t prvNetworkRecv( void * pvContext,
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 )
+
+/*
+ * @brief Wakeup callback registered with FreeRTOS+TCP, which passes the
+ * secure socket rather than the wrapped socket to the user's callback.
+ */
+    static void prvSocketWakeupCallback( Socket_t xSocket )
+    {
+        SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) FreeRTOS_GetSocketID( xSocket ); /*lint !e9087 cast used for portability. */
+
+        if( ( pxContext != NULL ) && ( pxContext->pxUserWakeCallback != NULL ) )
+        {
+            pxContext->pxUserWakeCallback( ( Socket_t ) pxContext );
+        }
+    }
+#endif /* ipconfigSOCKET_HAS_USER_WAKE_CALLBACK */
+/*-----------------------------------------------------------*/
+
 /*
  * Interface routines.
  */
@@ -427,6 +448,21 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
 
                 break;
 
+            #if ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 )
+                case SOCKETS_SO_WAKEUP_CALLBACK:
+
+                    /* The user's callback receives the secure socket, so that
+                     * it can tell which of its sockets needs attention. */
+                    pxContext->pxUserWakeCallback = ( void ( * )( Socket_t ) )pvOptionValue; /*lint !e9074 !e611 The option value is the callback. */
+                    ( void ) FreeRTOS_SetSocketID( pxContext->xSocket, pxContext );
+                    lStatus = FreeRTOS_setsockopt( pxContext->xSocket,
+                                                   lLevel,
+                                                   lOptionName,
+                                                   ( pvOptionValue != NULL ) ? ( void * ) prvSocketWakeupCallback : NULL, /*lint !e9074 The callback is passed as the option value. */
+                                                   xOptionLength );
+                    break;
+            #endif /* ipconfigSOCKET_HAS_USER_WAKE_CALLBACK */
+
             case SOCKETS_SO_RCVTIMEO:
             case SOCKETS_SO_SNDTIMEO:
                 /* Comply with Berkeley standard - a 0 timeout is wait forever. */
@@ -0,0 +1,2005 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "list.h"
+#include "task.h"
+#include "queue.h"
+#include "message_buffer.h"
+#include "timers.h"
+#include "event_groups.h"
+
+/* Test includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+#include "aws_test_runner_config.h"
+
+/**
+ * @brief Configuration for this test group.
+ */
+
+/* The list test applies the same random operations to a list initialised with
+ * vListInitialise() and to one initialised with vListInitialiseIndexed(), and
+ * checks that both hold the same items in the same order.  Few distinct values
+ * are used so that many items have the same value. */
+#define kerneltestLIST_ITEMS               200
+#define kerneltestLIST_OPERATIONS          5000
+#define kerneltestLIST_VALUES              64
+
+/* The delayed list benchmark keeps this many items in a list and repeatedly
+ * moves the head item to a later time, as the scheduler does when a task that
+ * was unblocked by the tick blocks again, during kerneltestLIST_TICKS for each
+ * length. */
+#define kerneltestLIST_MAX_LENGTH          1024
+#define kerneltestLIST_TICKS               pdMS_TO_TICKS( 50 )
+#define kerneltestLIST_TIME_MASK           1023UL
+
+/* The scheduler benchmark runs with this many tasks that block periodically,
+ * with periods of kerneltestSLEEPER_PERIOD ticks or up to twice as long. */
+#define kerneltestMAX_SLEEPERS             128
+#define kerneltestSLEEPER_PERIOD           100
+#define kerneltestSLEEPER_PRIORITY         ( tskIDLE_PRIORITY + 1 )
+
+/* The task that measures, and its partner in the block and unblock round
+ * trips, run above the sleepers.  Their block time is longer than the period
+ * of any sleeper, so they are placed behind all of them in the delayed list. */
+#define kerneltestBENCHMARK_PRIORITY       ( tskIDLE_PRIORITY + 2 )
+#define kerneltestBENCHMARK_BLOCK_TIME     pdMS_TO_TICKS( 1000 )
+#define kerneltestBENCHMARK_TICKS          pdMS_TO_TICKS( 50 )
+
+/* The tick is simulated during this number of real ticks.  It is kept short
+ * as the tick count advances by every simulated tick. */
+#define kerneltestTICK_TICKS               pdMS_TO_TICKS( 10 )
+
+/* The by-reference queue test passes kerneltestQUEUE_ITEMS items of this size
+ * through a queue of kerneltestQUEUE_LENGTH items. */
+#define kerneltestQUEUE_ITEM_SIZE          256
+#define kerneltestQUEUE_LENGTH             4
+#define kerneltestQUEUE_ITEMS              1000
+
+/* The message buffer benchmark passes numbered messages of each size through
+ * a buffer of kerneltestMESSAGE_BUFFER_SIZE bytes for kerneltestBENCHMARK_TICKS,
+ * from a task that uses either the task or the interrupt API. */
+#define kerneltestMESSAGE_BUFFER_SIZE      16384
+#define kerneltestMESSAGE_MAX_SIZE         4096
+#define kerneltestMESSAGE_BLOCK_TIME       pdMS_TO_TICKS( 10 )
+
+/* The batch queue test passes kerneltestBATCH_ITEMS items through a queue of
+ * kerneltestBATCH_QUEUE_LENGTH items, and times draining a full queue item by
+ * item and in one batch. */
+#define kerneltestBATCH_QUEUE_LENGTH       32
+#define kerneltestBATCH_ITEMS              5000
+
+/* The notification test receives kerneltestNOTIFY_GIVES notifications spread
+ * over two notification indexes while waiting on both at once. */
+#define kerneltestNOTIFY_GIVES             10000
+
+/* The timer test checks one-shot timers with these periods, which cover both
+ * levels of the timer wheel when configTIMER_WHEEL_SLOTS is 16, fire within
+ * kerneltestTIMER_LATENCY ticks of their expiry time. */
+#define kerneltestTIMER_PERIODS            { 1, 2, 15, 16, 17, 100, 255, 256, 257, 300, 600 }
+#define kerneltestTIMER_LATENCY            20
+
+/* The timer benchmark starts and stops a timer while kerneltestMAX_TIMERS
+ * other timers are active, with expiry times spread over
+ * kerneltestTIMER_SPREAD ticks from kerneltestTIMER_MIN_PERIOD on. */
+#define kerneltestMAX_TIMERS               1000
+#define kerneltestTIMER_MIN_PERIOD         pdMS_TO_TICKS( 60000 )
+#define kerneltestTIMER_SPREAD             10000
+
+/* The event group benchmark sets and clears a bit no task waits for while
+ * up to kerneltestMAX_BIT_WAITERS tasks wait for another bit, as tasks wait
+ * for a connection state bit.  Waiters are given kerneltestWAITER_TICKS to
+ * run after the bits they wait for are set.  Where FreeRTOSConfig.h defines
+ * kerneltestGET_TIME_NS() and routes the traceEVENT_GROUP_SET_BITS() and
+ * traceEVENT_GROUP_SET_BITS_END() macros to vTraceEventGroupSetBits(), only
+ * the part of xEventGroupSetBits() that runs with the scheduler suspended is
+ * timed, as suspending and resuming the scheduler otherwise dominates. */
+#define kerneltestMAX_BIT_WAITERS          256
+#define kerneltestWAITER_TICKS             pdMS_TO_TICKS( 20 )
+
+/* The heap benchmark keeps up to kerneltestHEAP_BLOCKS blocks allocated,
+ * with sizes and lifetimes modelled on a TLS handshake and on OTA job
+ * documents being decoded, after leaving kerneltestHEAP_HOLES small holes
+ * between long lived blocks.  kerneltestHEAP_WARM_UP operations are replayed
+ * before the heap is measured. */
+#define kerneltestHEAP_BLOCKS              256
+#define kerneltestHEAP_HOLES               128
+#define kerneltestHEAP_WARM_UP             20000
+#define kerneltestHEAP_TLS_RECORD_SIZE     16717
+#define kerneltestHEAP_MAX_CBOR_SIZE       8192
+
+/* The small block benchmark runs kerneltestHEAP_WORKERS tasks that each
+ * allocate, then free, kerneltestHEAP_BURST blocks of up to
+ * kerneltestHEAP_SMALL_SIZE bytes at a time. */
+#define kerneltestHEAP_WORKERS             4
+#define kerneltestHEAP_BURST               8
+#define kerneltestHEAP_SMALL_SIZE          256
+
+/* The multiprocessing tests let tasks run for kerneltestSMP_TICKS. */
+#define kerneltestSMP_TICKS                pdMS_TO_TICKS( 50 )
+
+/*
+ * @brief Test group definition.
+ */
+TEST_GROUP( Full_FREERTOS_KERNEL );
+
+TEST_SETUP( Full_FREERTOS_KERNEL )
+{
+}
+
+TEST_TEAR_DOWN( Full_FREERTOS_KERNEL )
+{
+}
+
+TEST_GROUP_RUNNER( Full_FREERTOS_KERNEL )
+{
+    /* vListInitialiseIndexed() lists behave as normal lists. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, IndexedList );
+
+    /* The cost of keeping a delayed list sorted, per length. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, DelayedListLength );
+
+    /* The cost of the tick and of blocking, per number of delayed tasks. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, DelayedTasks );
+
+    /* Queue items written and read in place. */
+    #if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+        RUN_TEST_CASE( Full_FREERTOS_KERNEL, QueueByReference );
+    #endif
+
+    /* Message buffer throughput, per message size. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, MessageBufferThroughput );
+
+    /* Several queue items sent and received at once. */
+    #if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+        RUN_TEST_CASE( Full_FREERTOS_KERNEL, QueueSendReceiveMultiple );
+    #endif
+
+    /* Independent notification indexes, and waiting on several of them. */
+    #if ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 )
+        RUN_TEST_CASE( Full_FREERTOS_KERNEL, TaskNotificationIndexes );
+    #endif
+
+    /* Software timers expire on time, and timer commands from callbacks. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, TimerExpiry );
+
+    /* The cost of starting and stopping a timer, per number of timers. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, TimerStartStop );
+
+    /* Event group waiters are unblocked by the right bits, and the cost of
+     * setting bits, per number of waiting tasks. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, EventGroupWaiters );
+
+    /* Heap latency and fragmentation under a replayed allocation pattern. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, HeapTrace );
+
+    /* Small blocks allocated and freed by several tasks at once. */
+    RUN_TEST_CASE( Full_FREERTOS_KERNEL, HeapSmallBlocks );
+
+    /* Core affinity, and tasks running on several cores at once. */
+    #if ( configNUMBER_OF_CORES > 1 )
+        RUN_TEST_CASE( Full_FREERTOS_KERNEL, CoreAffinity );
+        RUN_TEST_CASE( Full_FREERTOS_KERNEL, CoreParallelism );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( uint32_t * pulSeed )
+{
+    *pulSeed = ( *pulSeed * 1664525UL ) + 1013904223UL;
+
+    return *pulSeed >> 8;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Check that two lists hold items with the same owners in the same order, and
+ * that the tree of an indexed list has the items in list order. */
+static void prvCheckSameOrder( List_t * pxPlainList,
+                               List_t * pxIndexedList )
+{
+    const ListItem_t * pxPlain = listGET_HEAD_ENTRY( pxPlainList );
+    const ListItem_t * pxIndexed = listGET_HEAD_ENTRY( pxIndexedList );
+
+    TEST_ASSERT_EQUAL( listCURRENT_LIST_LENGTH( pxPlainList ), listCURRENT_LIST_LENGTH( pxIndexedList ) );
+
+    while( pxPlain != listGET_END_MARKER( pxPlainList ) )
+    {
+        TEST_ASSERT_EQUAL_PTR( listGET_LIST_ITEM_OWNER( pxPlain ), listGET_LIST_ITEM_OWNER( pxIndexed ) );
+        TEST_ASSERT_EQUAL( listGET_LIST_ITEM_VALUE( pxPlain ), listGET_LIST_ITEM_VALUE( pxIndexed ) );
+        pxPlain = listGET_NEXT( pxPlain );
+        pxIndexed = listGET_NEXT( pxIndexed );
+    }
+
+    TEST_ASSERT_EQUAL_PTR( listGET_END_MARKER( pxIndexedList ), pxIndexed );
+
+    #if ( configUSE_INDEXED_LISTS == 1 )
+        {
+            const ListItem_t * pxNode = pxIndexedList->pxTreeRoot;
+
+            /* Walk the tree in order, from its leftmost node. */
+            while( ( pxNode != NULL ) && ( pxNode->pxTreeLeft != NULL ) )
+            {
+                pxNode = pxNode->pxTreeLeft;
+            }
+
+            pxIndexed = listGET_HEAD_ENTRY( pxIndexedList );
+
+            while( pxNode != NULL )
+            {
+                TEST_ASSERT_EQUAL_PTR( pxIndexed, pxNode );
+                pxIndexed = listGET_NEXT( pxIndexed );
+
+                if( pxNode->pxTreeRight != NULL )
+                {
+                    TEST_ASSERT_EQUAL_PTR( pxNode, pxNode->pxTreeRight->pxTreeParent );
+                    pxNode = pxNode->pxTreeRight;
+
+                    while( pxNode->pxTreeLeft != NULL )
+                    {
+                        TEST_ASSERT_EQUAL_PTR( pxNode, pxNode->pxTreeLeft->pxTreeParent );
+                        pxNode = pxNode->pxTreeLeft;
+                    }
+                }
+                else
+                {
+                    while( ( pxNode->pxTreeParent != NULL ) && ( pxNode->pxTreeParent->pxTreeRight == pxNode ) )
+                    {
+                        pxNode = pxNode->pxTreeParent;
+                    }
+
+                    pxNode = pxNode->pxTreeParent;
+                }
+            }
+
+            TEST_ASSERT_EQUAL_PTR( listGET_END_MARKER( pxIndexedList ), pxIndexed );
+        }
+    #endif /* if ( configUSE_INDEXED_LISTS == 1 ) */
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, IndexedList )
+{
+    static ListItem_t xPlainItems[ kerneltestLIST_ITEMS ];
+    static ListItem_t xIndexedItems[ kerneltestLIST_ITEMS ];
+    List_t * pxPlainList;
+    List_t * pxIndexedList;
+    UBaseType_t uxIndex;
+    uint32_t ulSeed = 1;
+    uint32_t ulRandom;
+    BaseType_t xOperation;
+    void * pvPlainOwner;
+    void * pvIndexedOwner;
+
+    /* The lists are allocated so that the compiler does not see the list end
+     * marker, which is smaller than a list item, being accessed as one. */
+    pxPlainList = pvPortMalloc( sizeof( List_t ) );
+    pxIndexedList = pvPortMalloc( sizeof( List_t ) );
+    TEST_ASSERT_NOT_NULL( pxPlainList );
+    TEST_ASSERT_NOT_NULL( pxIndexedList );
+
+    vListInitialise( pxPlainList );
+    vListInitialiseIndexed( pxIndexedList );
+
+    for( uxIndex = 0; uxIndex < kerneltestLIST_ITEMS; uxIndex++ )
+    {
+        vListInitialiseItem( &( xPlainItems[ uxIndex ] ) );
+        vListInitialiseItem( &( xIndexedItems[ uxIndex ] ) );
+        listSET_LIST_ITEM_OWNER( &( xPlainItems[ uxIndex ] ), &( xPlainItems[ uxIndex ] ) );
+        listSET_LIST_ITEM_OWNER( &( xIndexedItems[ uxIndex ] ), &( xPlainItems[ uxIndex ] ) );
+    }
+
+    /* Sorted insertion, including at portMAX_DELAY, and removal from
+     * anywhere in the list. */
+    for( xOperation = 0; xOperation < kerneltestLIST_OPERATIONS; xOperation++ )
+    {
+        ulRandom = prvRandom( &ulSeed );
+        uxIndex = ulRandom % kerneltestLIST_ITEMS;
+        ulRandom /= kerneltestLIST_ITEMS;
+
+        if( listIS_CONTAINED_WITHIN( pxPlainList, &( xPlainItems[ uxIndex ] ) ) != pdFALSE )
+        {
+            TEST_ASSERT_EQUAL( uxListRemove( &( xPlainItems[ uxIndex ] ) ),
+                               uxListRemove( &( xIndexedItems[ uxIndex ] ) ) );
+        }
+        else
+        {
+            if( ( ulRandom % kerneltestLIST_VALUES ) == 0 )
+            {
+                listSET_LIST_ITEM_VALUE( &( xPlainItems[ uxIndex ] ), portMAX_DELAY );
+            }
+            else
+            {
+                listSET_LIST_ITEM_VALUE( &( xPlainItems[ uxIndex ] ), ulRandom % kerneltestLIST_VALUES );
+            }
+
+            listSET_LIST_ITEM_VALUE( &( xIndexedItems[ uxIndex ] ), listGET_LIST_ITEM_VALUE( &( xPlainItems[ uxIndex ] ) ) );
+            vListInsert( pxPlainList, &( xPlainItems[ uxIndex ] ) );
+            vListInsert( pxIndexedList, &( xIndexedItems[ uxIndex ] ) );
+        }
+
+        prvCheckSameOrder( pxPlainList, pxIndexedList );
+    }
+
+    for( uxIndex = 0; uxIndex < kerneltestLIST_ITEMS; uxIndex++ )
+    {
+        if( listIS_CONTAINED_WITHIN( pxPlainList, &( xPlainItems[ uxIndex ] ) ) != pdFALSE )
+        {
+            ( void ) uxListRemove( &( xPlainItems[ uxIndex ] ) );
+            ( void ) uxListRemove( &( xIndexedItems[ uxIndex ] ) );
+        }
+    }
+
+    prvCheckSameOrder( pxPlainList, pxIndexedList );
+
+    /* Insertion at the end, while the index walks through the list. */
+    for( xOperation = 0; xOperation < kerneltestLIST_OPERATIONS; xOperation++ )
+    {
+        ulRandom = prvRandom( &ulSeed );
+        uxIndex = ulRandom % kerneltestLIST_ITEMS;
+        ulRandom /= kerneltestLIST_ITEMS;
+
+        if( ( ( ulRandom % 4 ) == 0 ) && ( listLIST_IS_EMPTY( pxPlainList ) == pdFALSE ) )
+        {
+            listGET_OWNER_OF_NEXT_ENTRY( pvPlainOwner, pxPlainList );
+            listGET_OWNER_OF_NEXT_ENTRY( pvIndexedOwner, pxIndexedList );
+            TEST_ASSERT_EQUAL_PTR( pvPlainOwner, pvIndexedOwner );
+        }
+        else if( listIS_CONTAINED_WITHIN( pxPlainList, &( xPlainItems[ uxIndex ] ) ) != pdFALSE )
+        {
+            TEST_ASSERT_EQUAL( uxListRemove( &( xPlainItems[ uxIndex ] ) ),
+                               uxListRemove( &( xIndexedItems[ uxIndex ] ) ) );
+        }
+        else
+        {
+            vListInsertEnd( pxPlainList, &( xPlainItems[ uxIndex ] ) );
+            vListInsertEnd( pxIndexedList, &( xIndexedItems[ uxIndex ] ) );
+        }
+
+        prvCheckSameOrder( pxPlainList, pxIndexedList );
+    }
+
+    vPortFree( pxPlainList );
+    vPortFree( pxIndexedList );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Count the head items that can be moved to a later time in a list of
+ * uxLength items during kerneltestLIST_TICKS, and return the time per move in
+ * nanoseconds. */
+static uint32_t prvTimeDelayedList( List_t * pxList,
+                                    ListItem_t * pxItems,
+                                    UBaseType_t uxLength )
+{
+    ListItem_t * pxHead;
+    TickType_t xNow = 0;
+    TickType_t xStart;
+    UBaseType_t uxIndex;
+    uint32_t ulSeed = 1;
+    uint32_t ulMoves = 0;
+
+    for( uxIndex = 0; uxIndex < uxLength; uxIndex++ )
+    {
+        vListInitialiseItem( &( pxItems[ uxIndex ] ) );
+        listSET_LIST_ITEM_VALUE( &( pxItems[ uxIndex ] ), prvRandom( &ulSeed ) & kerneltestLIST_TIME_MASK );
+        vListInsert( pxList, &( pxItems[ uxIndex ] ) );
+    }
+
+    xStart = xTaskGetTickCount();
+
+    while( ( xTaskGetTickCount() - xStart ) < kerneltestLIST_TICKS )
+    {
+        pxHead = listGET_HEAD_ENTRY( pxList );
+        xNow = listGET_LIST_ITEM_VALUE( pxHead );
+        ( void ) uxListRemove( pxHead );
+        listSET_LIST_ITEM_VALUE( pxHead, xNow + 1 + ( prvRandom( &ulSeed ) & kerneltestLIST_TIME_MASK ) );
+        vListInsert( pxList, pxHead );
+        ulMoves++;
+    }
+
+    /* The list must still be sorted. */
+    for( pxHead = listGET_HEAD_ENTRY( pxList ); listGET_NEXT( pxHead ) != listGET_END_MARKER( pxList ); pxHead = listGET_NEXT( pxHead ) )
+    {
+        TEST_ASSERT_TRUE( listGET_LIST_ITEM_VALUE( pxHead ) <= listGET_LIST_ITEM_VALUE( listGET_NEXT( pxHead ) ) );
+    }
+
+    for( uxIndex = 0; uxIndex < uxLength; uxIndex++ )
+    {
+        ( void ) uxListRemove( &( pxItems[ uxIndex ] ) );
+    }
+
+    return ( uint32_t ) ( ( ( uint64_t ) kerneltestLIST_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulMoves );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, DelayedListLength )
+{
+    static ListItem_t xItems[ kerneltestLIST_MAX_LENGTH ];
+    List_t xList;
+    UBaseType_t uxLength;
+    uint32_t ulLinear;
+    uint32_t ulIndexed;
+
+    for( uxLength = 16; uxLength <= kerneltestLIST_MAX_LENGTH; uxLength *= 4 )
+    {
+        vListInitialise( &xList );
+        ulLinear = prvTimeDelayedList( &xList, xItems, uxLength );
+        vListInitialiseIndexed( &xList );
+        ulIndexed = prvTimeDelayedList( &xList, xItems, uxLength );
+
+        configPRINTF( ( "Delayed list: %4u items: linear %5u ns, indexed %5u ns per unblock and block\r\n",
+                        ( unsigned ) uxLength,
+                        ( unsigned ) ulLinear,
+                        ( unsigned ) ulIndexed ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static volatile BaseType_t xStopSleepers = pdFALSE;
+static volatile UBaseType_t uxRunningSleepers = 0;
+
+static void prvSleeperTask( void * pvParameters )
+{
+    const TickType_t xPeriod = ( TickType_t ) ( uintptr_t ) pvParameters;
+
+    while( xStopSleepers == pdFALSE )
+    {
+        vTaskDelay( xPeriod );
+    }
+
+    taskENTER_CRITICAL();
+    {
+        uxRunningSleepers--;
+    }
+    taskEXIT_CRITICAL();
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPartnerTask( void * pvParameters )
+{
+    TaskHandle_t xBenchmarkTask = ( TaskHandle_t ) pvParameters;
+
+    while( xStopSleepers == pdFALSE )
+    {
+        if( ulTaskNotifyTake( pdTRUE, kerneltestBENCHMARK_BLOCK_TIME ) != 0 )
+        {
+            xTaskNotifyGive( xBenchmarkTask );
+        }
+    }
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, DelayedTasks )
+{
+    static const UBaseType_t uxSleeperCounts[] = { 0, 16, 64, kerneltestMAX_SLEEPERS };
+    TaskHandle_t xPartnerTask = NULL;
+    UBaseType_t uxOriginalPriority;
+    UBaseType_t uxCount;
+    UBaseType_t uxSleepers = 0;
+    TickType_t xStart;
+    TickType_t xWaited;
+    uint32_t ulTicks;
+    uint32_t ulRoundTrips;
+
+    uxOriginalPriority = uxTaskPriorityGet( NULL );
+    vTaskPrioritySet( NULL, kerneltestBENCHMARK_PRIORITY );
+    xStopSleepers = pdFALSE;
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvPartnerTask, "Partner", configMINIMAL_STACK_SIZE * 2,
+                                            xTaskGetCurrentTaskHandle(), kerneltestBENCHMARK_PRIORITY, &xPartnerTask ) );
+
+    for( uxCount = 0; uxCount < sizeof( uxSleeperCounts ) / sizeof( uxSleeperCounts[ 0 ] ); uxCount++ )
+    {
+        /* Add sleepers, with periods spread over a range so that they wake up
+         * at different ticks. */
+        while( uxSleepers < uxSleeperCounts[ uxCount ] )
+        {
+            taskENTER_CRITICAL();
+            {
+                uxRunningSleepers++;
+            }
+            taskEXIT_CRITICAL();
+
+            TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvSleeperTask, "Sleeper", configMINIMAL_STACK_SIZE,
+                                                    ( void * ) ( uintptr_t ) ( kerneltestSLEEPER_PERIOD + ( ( uxSleepers * 37 ) % kerneltestSLEEPER_PERIOD ) ),
+                                                    kerneltestSLEEPER_PRIORITY, NULL ) );
+            uxSleepers++;
+        }
+
+        vTaskDelay( kerneltestSLEEPER_PERIOD * 2 );
+
+        /* xTaskIncrementTick() is called as the tick interrupt would, with the
+         * tick interrupt masked.  The tick count then advances faster than
+         * real time, which is measured by the ticks that were not simulated. */
+        ulTicks = 0;
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart - ulTicks ) < kerneltestTICK_TICKS )
+        {
+            taskENTER_CRITICAL();
+            {
+                ( void ) xTaskIncrementTick();
+            }
+            taskEXIT_CRITICAL();
+            ulTicks++;
+        }
+
+        vTaskDelay( kerneltestSLEEPER_PERIOD * 2 );
+
+        /* Each round trip blocks and unblocks both tasks. */
+        ulRoundTrips = 0;
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+        {
+            xTaskNotifyGive( xPartnerTask );
+            TEST_ASSERT_NOT_EQUAL( 0, ulTaskNotifyTake( pdTRUE, kerneltestBENCHMARK_BLOCK_TIME ) );
+            ulRoundTrips++;
+        }
+
+        configPRINTF( ( "Delayed tasks: %3u sleepers: %5u ns per tick, %6u ns per block and unblock\r\n",
+                        ( unsigned ) uxSleepers,
+                        ( unsigned ) ( ( ( uint64_t ) kerneltestTICK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulTicks ),
+                        ( unsigned ) ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ( ulRoundTrips * 2 ) ) ) );
+    }
+
+    /* Let every task see the flag, and wait for the sleepers to delete
+     * themselves. */
+    xStopSleepers = pdTRUE;
+    xTaskNotifyGive( xPartnerTask );
+
+    for( xWaited = 0; ( uxRunningSleepers != 0 ) && ( xWaited < ( kerneltestSLEEPER_PERIOD * 4 ) ); xWaited += 10 )
+    {
+        vTaskDelay( 10 );
+    }
+
+    /* Drop the notification the partner sent back before it stopped. */
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+    vTaskPrioritySet( NULL, uxOriginalPriority );
+    TEST_ASSERT_EQUAL( 0, uxRunningSleepers );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_BY_REFERENCE == 1 )
+
+    typedef struct
+    {
+        uint32_t ulSequence;
+        uint8_t ucPayload[ kerneltestQUEUE_ITEM_SIZE - sizeof( uint32_t ) ];
+    } QueueTestItem_t;
+
+/* Write kerneltestQUEUE_ITEMS numbered items into the queue, two slots at a
+ * time, then notify the task that created this one. */
+    static void prvQueueProducerTask( void * pvParameters )
+    {
+        QueueHandle_t xQueue = ( QueueHandle_t ) pvParameters;
+        QueueTestItem_t * pxFirst;
+        QueueTestItem_t * pxSecond;
+        uint32_t ulSequence;
+        BaseType_t xFirstAcquired, xSecondAcquired;
+
+        for( ulSequence = 0; ulSequence < kerneltestQUEUE_ITEMS; ulSequence += 2 )
+        {
+            xFirstAcquired = xQueueAcquireSlot( xQueue, ( void ** ) &pxFirst, portMAX_DELAY );
+            xSecondAcquired = xQueueAcquireSlot( xQueue, ( void ** ) &pxSecond, portMAX_DELAY );
+            configASSERT( xFirstAcquired == pdPASS );
+            configASSERT( xSecondAcquired == pdPASS );
+
+            if( ( xFirstAcquired != pdPASS ) || ( xSecondAcquired != pdPASS ) )
+            {
+                /* The test times out waiting for the missing items. */
+                break;
+            }
+
+            pxSecond->ulSequence = ulSequence + 1;
+            pxFirst->ulSequence = ulSequence;
+            memset( pxFirst->ucPayload, ( int ) ( ulSequence & 0xFF ), sizeof( pxFirst->ucPayload ) );
+            memset( pxSecond->ucPayload, ( int ) ( ( ulSequence + 1 ) & 0xFF ), sizeof( pxSecond->ucPayload ) );
+            vQueueCommitSlot( xQueue, pxFirst );
+            vQueueCommitSlot( xQueue, pxSecond );
+        }
+
+        vTaskDelete( NULL );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_KERNEL, QueueByReference )
+    {
+        QueueHandle_t xQueue;
+        QueueTestItem_t * pxItems[ kerneltestQUEUE_LENGTH ];
+        QueueTestItem_t * pxItem;
+        QueueTestItem_t * pxOlder = NULL;
+        UBaseType_t uxIndex;
+        uint32_t ulSequence;
+
+        xQueue = xQueueCreate( kerneltestQUEUE_LENGTH, sizeof( QueueTestItem_t ) );
+        TEST_ASSERT_NOT_NULL( xQueue );
+
+        /* Acquired slots and borrowed items both use up space in the queue,
+         * and only committed items can be received. */
+        for( uxIndex = 0; uxIndex < kerneltestQUEUE_LENGTH; uxIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, xQueueAcquireSlot( xQueue, ( void ** ) &( pxItems[ uxIndex ] ), 0 ) );
+            pxItems[ uxIndex ]->ulSequence = uxIndex;
+        }
+
+        TEST_ASSERT_EQUAL( errQUEUE_FULL, xQueueAcquireSlot( xQueue, ( void ** ) &pxItem, 0 ) );
+        TEST_ASSERT_EQUAL( errQUEUE_EMPTY, xQueueBorrowItem( xQueue, ( void ** ) &pxItem, 0 ) );
+        TEST_ASSERT_EQUAL( 0, uxQueueSpacesAvailable( xQueue ) );
+
+        vQueueCommitSlot( xQueue, pxItems[ 0 ] );
+        vQueueCommitSlot( xQueue, pxItems[ 1 ] );
+        TEST_ASSERT_EQUAL( 2, uxQueueMessagesWaiting( xQueue ) );
+        TEST_ASSERT_EQUAL( pdPASS, xQueueBorrowItem( xQueue, ( void ** ) &pxItem, 0 ) );
+        TEST_ASSERT_EQUAL_PTR( pxItems[ 0 ], pxItem );
+        TEST_ASSERT_EQUAL( errQUEUE_FULL, xQueueAcquireSlot( xQueue, ( void ** ) &pxItem, 0 ) );
+        vQueueReleaseItem( xQueue, pxItems[ 0 ] );
+        TEST_ASSERT_EQUAL( 1, uxQueueSpacesAvailable( xQueue ) );
+
+        /* The freed slot is reused after the last acquired one, and items
+         * come out in the order of their slots. */
+        TEST_ASSERT_EQUAL( pdPASS, xQueueAcquireSlot( xQueue, ( void ** ) &pxItem, 0 ) );
+        TEST_ASSERT_EQUAL_PTR( pxItems[ 0 ], pxItem );
+        pxItem->ulSequence = kerneltestQUEUE_LENGTH;
+        vQueueCommitSlot( xQueue, pxItems[ 2 ] );
+        vQueueCommitSlot( xQueue, pxItems[ 3 ] );
+        vQueueCommitSlot( xQueue, pxItem );
+
+        for( ulSequence = 1; ulSequence <= kerneltestQUEUE_LENGTH; ulSequence++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, xQueueBorrowItem( xQueue, ( void ** ) &pxItem, 0 ) );
+            TEST_ASSERT_EQUAL( ulSequence, pxItem->ulSequence );
+
+            /* Hold on to one item at a time while the next is borrowed. */
+            if( pxOlder != NULL )
+            {
+                vQueueReleaseItem( xQueue, pxOlder );
+            }
+
+            pxOlder = pxItem;
+        }
+
+        vQueueReleaseItem( xQueue, pxOlder );
+        TEST_ASSERT_EQUAL( kerneltestQUEUE_LENGTH, uxQueueSpacesAvailable( xQueue ) );
+
+        /* Items from another task, which blocks while every slot is used. */
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvQueueProducerTask, "Producer", configMINIMAL_STACK_SIZE * 2,
+                                                ( void * ) xQueue, uxTaskPriorityGet( NULL ), NULL ) );
+
+        for( ulSequence = 0; ulSequence < kerneltestQUEUE_ITEMS; ulSequence++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, xQueueBorrowItem( xQueue, ( void ** ) &pxItem, pdMS_TO_TICKS( 1000 ) ) );
+            TEST_ASSERT_EQUAL( ulSequence, pxItem->ulSequence );
+            TEST_ASSERT_EQUAL( ulSequence & 0xFF, pxItem->ucPayload[ sizeof( pxItem->ucPayload ) - 1 ] );
+            vQueueReleaseItem( xQueue, pxItem );
+        }
+
+        vQueueDelete( xQueue );
+    }
+
+#endif /* if ( configUSE_QUEUE_BY_REFERENCE == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+typedef struct
+{
+    MessageBufferHandle_t xMessageBuffer;
+    TaskHandle_t xReceiverTask;
+    size_t xMessageSize;
+    BaseType_t xFromISR;
+} MessageBufferProducer_t;
+
+static volatile BaseType_t xStopProducer = pdFALSE;
+
+/* Send numbered messages until xStopProducer is set, then notify the receiver.
+ * The interrupt API is called from a task, as an interrupt would call it, and
+ * the task yields while the buffer is full. */
+static void prvMessageProducerTask( void * pvParameters )
+{
+    MessageBufferProducer_t * pxProducer = ( MessageBufferProducer_t * ) pvParameters;
+    uint8_t * pucMessage;
+    uint32_t ulSequence = 0;
+    size_t xSent;
+    BaseType_t xHigherPriorityTaskWoken;
+
+    pucMessage = ( uint8_t * ) pvPortMalloc( pxProducer->xMessageSize );
+    configASSERT( pucMessage != NULL );
+    memset( pucMessage, 0xA5, pxProducer->xMessageSize );
+
+    while( xStopProducer == pdFALSE )
+    {
+        memcpy( pucMessage, &ulSequence, sizeof( ulSequence ) );
+
+        if( pxProducer->xFromISR != pdFALSE )
+        {
+            xHigherPriorityTaskWoken = pdFALSE;
+            xSent = xMessageBufferSendFromISR( pxProducer->xMessageBuffer, pucMessage, pxProducer->xMessageSize, &xHigherPriorityTaskWoken );
+            portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+
+            if( xSent == 0 )
+            {
+                taskYIELD();
+            }
+        }
+        else
+        {
+            xSent = xMessageBufferSend( pxProducer->xMessageBuffer, pucMessage, pxProducer->xMessageSize, kerneltestMESSAGE_BLOCK_TIME );
+        }
+
+        if( xSent != 0 )
+        {
+            configASSERT( xSent == pxProducer->xMessageSize );
+            ulSequence++;
+        }
+    }
+
+    vPortFree( pucMessage );
+    xTaskNotifyGive( pxProducer->xReceiverTask );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Receive messages from a producer for kerneltestBENCHMARK_TICKS, checking
+ * their length and order, and return the number of bytes received. */
+static uint64_t prvTimeMessageBuffer( size_t xMessageSize,
+                                      BaseType_t xFromISR,
+                                      uint8_t * pucMessage )
+{
+    MessageBufferProducer_t xProducer;
+    uint64_t ullBytes = 0;
+    uint32_t ulSequence = 0;
+    uint32_t ulReceived;
+    size_t xReceived;
+    TickType_t xStart;
+
+    xProducer.xMessageBuffer = xMessageBufferCreate( kerneltestMESSAGE_BUFFER_SIZE );
+    TEST_ASSERT_NOT_NULL( xProducer.xMessageBuffer );
+    xProducer.xReceiverTask = xTaskGetCurrentTaskHandle();
+    xProducer.xMessageSize = xMessageSize;
+    xProducer.xFromISR = xFromISR;
+    xStopProducer = pdFALSE;
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvMessageProducerTask, "Producer", configMINIMAL_STACK_SIZE * 2,
+                                            &xProducer, kerneltestBENCHMARK_PRIORITY, NULL ) );
+
+    xStart = xTaskGetTickCount();
+
+    while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+    {
+        xReceived = xMessageBufferReceive( xProducer.xMessageBuffer, pucMessage, kerneltestMESSAGE_MAX_SIZE, kerneltestMESSAGE_BLOCK_TIME );
+
+        if( xReceived != 0 )
+        {
+            TEST_ASSERT_EQUAL( xMessageSize, xReceived );
+            memcpy( &ulReceived, pucMessage, sizeof( ulReceived ) );
+            TEST_ASSERT_EQUAL( ulSequence, ulReceived );
+            TEST_ASSERT_EQUAL( 0xA5, pucMessage[ xMessageSize - 1 ] );
+            ulSequence++;
+            ullBytes += xReceived;
+        }
+    }
+
+    /* Keep the buffer draining until the producer has seen the flag. */
+    xStopProducer = pdTRUE;
+
+    while( ulTaskNotifyTake( pdTRUE, 0 ) == 0 )
+    {
+        ( void ) xMessageBufferReceive( xProducer.xMessageBuffer, pucMessage, kerneltestMESSAGE_MAX_SIZE, pdMS_TO_TICKS( 1 ) );
+    }
+
+    vMessageBufferDelete( xProducer.xMessageBuffer );
+
+    return ullBytes;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, MessageBufferThroughput )
+{
+    static const size_t xMessageSizes[] = { 16, 64, 256, 1024, kerneltestMESSAGE_MAX_SIZE };
+    const uint64_t ullMilliseconds = ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS;
+    UBaseType_t uxOriginalPriority;
+    UBaseType_t uxIndex;
+    uint8_t * pucMessage;
+    uint64_t ullTaskBytes;
+    uint64_t ullISRBytes;
+
+    pucMessage = ( uint8_t * ) pvPortMalloc( kerneltestMESSAGE_MAX_SIZE );
+    TEST_ASSERT_NOT_NULL( pucMessage );
+    uxOriginalPriority = uxTaskPriorityGet( NULL );
+    vTaskPrioritySet( NULL, kerneltestBENCHMARK_PRIORITY );
+
+    for( uxIndex = 0; uxIndex < sizeof( xMessageSizes ) / sizeof( xMessageSizes[ 0 ] ); uxIndex++ )
+    {
+        ullTaskBytes = prvTimeMessageBuffer( xMessageSizes[ uxIndex ], pdFALSE, pucMessage );
+        ullISRBytes = prvTimeMessageBuffer( xMessageSizes[ uxIndex ], pdTRUE, pucMessage );
+
+        TEST_ASSERT_NOT_EQUAL( 0, ullTaskBytes );
+        TEST_ASSERT_NOT_EQUAL( 0, ullISRBytes );
+
+        configPRINTF( ( "Message buffer: %4u byte messages: task to task %7u KB/s, ISR to task %7u KB/s\r\n",
+                        ( unsigned ) xMessageSizes[ uxIndex ],
+                        ( unsigned ) ( ( ullTaskBytes * 1000ULL ) / ullMilliseconds / 1024ULL ),
+                        ( unsigned ) ( ( ullISRBytes * 1000ULL ) / ullMilliseconds / 1024ULL ) ) );
+    }
+
+    vTaskPrioritySet( NULL, uxOriginalPriority );
+    vPortFree( pucMessage );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 )
+
+/* Send kerneltestBATCH_ITEMS numbered items in batches of varying size. */
+    static void prvBatchProducerTask( void * pvParameters )
+    {
+        QueueHandle_t xQueue = ( QueueHandle_t ) pvParameters;
+        uint32_t ulItems[ 7 ];
+        uint32_t ulSequence = 0;
+        UBaseType_t uxCount;
+        UBaseType_t uxIndex;
+        BaseType_t xSent;
+
+        while( ulSequence < kerneltestBATCH_ITEMS )
+        {
+            uxCount = configMIN( ( UBaseType_t ) ( ( ulSequence % 7 ) + 1 ), ( UBaseType_t ) ( kerneltestBATCH_ITEMS - ulSequence ) );
+
+            for( uxIndex = 0; uxIndex < uxCount; uxIndex++ )
+            {
+                ulItems[ uxIndex ] = ulSequence + ( uint32_t ) uxIndex;
+            }
+
+            xSent = xQueueSendMultiple( xQueue, ulItems, uxCount, pdMS_TO_TICKS( 1000 ) );
+            configASSERT( xSent > 0 );
+            ulSequence += ( uint32_t ) xSent;
+        }
+
+        vTaskDelete( NULL );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_KERNEL, QueueSendReceiveMultiple )
+    {
+        QueueHandle_t xQueue;
+        uint32_t ulItems[ kerneltestBATCH_QUEUE_LENGTH ];
+        uint32_t ulReceived[ kerneltestBATCH_QUEUE_LENGTH ];
+        uint32_t ulSequence = 0;
+        uint32_t ulItemByItem;
+        uint32_t ulBatched;
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        BaseType_t xReceived;
+        BaseType_t xIndex;
+        TickType_t xStart;
+
+        xQueue = xQueueCreate( kerneltestBATCH_QUEUE_LENGTH, sizeof( uint32_t ) );
+        TEST_ASSERT_NOT_NULL( xQueue );
+
+        for( xIndex = 0; xIndex < kerneltestBATCH_QUEUE_LENGTH; xIndex++ )
+        {
+            ulItems[ xIndex ] = ( uint32_t ) xIndex;
+        }
+
+        /* As many items as fit are sent, and items are received in order
+         * across the end of the storage area. */
+        TEST_ASSERT_EQUAL( 20, xQueueSendMultiple( xQueue, ulItems, 20, 0 ) );
+        TEST_ASSERT_EQUAL( 12, xQueueReceiveMultiple( xQueue, ulReceived, 12, 0 ) );
+        TEST_ASSERT_EQUAL_UINT32_ARRAY( ulItems, ulReceived, 12 );
+        TEST_ASSERT_EQUAL( 24, xQueueSendMultiple( xQueue, &( ulItems[ 8 ] ), 24, 0 ) );
+        TEST_ASSERT_EQUAL( 0, xQueueSendMultiple( xQueue, ulItems, 1, 0 ) );
+        TEST_ASSERT_EQUAL( 0, uxQueueSpacesAvailable( xQueue ) );
+
+        TEST_ASSERT_EQUAL( 8, xQueueReceiveMultipleFromISR( xQueue, ulReceived, 8, &xHigherPriorityTaskWoken ) );
+        TEST_ASSERT_EQUAL_UINT32_ARRAY( &( ulItems[ 12 ] ), ulReceived, 8 );
+        TEST_ASSERT_EQUAL( 8, xQueueSendMultipleFromISR( xQueue, ulItems, 10, &xHigherPriorityTaskWoken ) );
+        TEST_ASSERT_EQUAL( pdFALSE, xHigherPriorityTaskWoken );
+
+        /* Items sent one at a time and in batches come out in the same order. */
+        TEST_ASSERT_EQUAL( pdPASS, xQueueReceive( xQueue, &( ulReceived[ 0 ] ), 0 ) );
+        TEST_ASSERT_EQUAL( kerneltestBATCH_QUEUE_LENGTH - 1, xQueueReceiveMultiple( xQueue, &( ulReceived[ 1 ] ), kerneltestBATCH_QUEUE_LENGTH - 1, 0 ) );
+        TEST_ASSERT_EQUAL_UINT32_ARRAY( &( ulItems[ 8 ] ), ulReceived, 24 );
+        TEST_ASSERT_EQUAL_UINT32_ARRAY( ulItems, &( ulReceived[ 24 ] ), 8 );
+        TEST_ASSERT_EQUAL( 0, xQueueReceiveMultiple( xQueue, ulReceived, kerneltestBATCH_QUEUE_LENGTH, 0 ) );
+
+        /* Items from another task, which blocks while the queue is full while
+         * this task blocks while it is empty. */
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvBatchProducerTask, "Producer", configMINIMAL_STACK_SIZE * 2,
+                                                ( void * ) xQueue, uxTaskPriorityGet( NULL ), NULL ) );
+
+        while( ulSequence < kerneltestBATCH_ITEMS )
+        {
+            xReceived = xQueueReceiveMultiple( xQueue, ulReceived, 5, pdMS_TO_TICKS( 1000 ) );
+            TEST_ASSERT_GREATER_THAN( 0, xReceived );
+
+            for( xIndex = 0; xIndex < xReceived; xIndex++ )
+            {
+                TEST_ASSERT_EQUAL( ulSequence, ulReceived[ xIndex ] );
+                ulSequence++;
+            }
+        }
+
+        /* Drain a full queue item by item, then in a single batch. */
+        ulItemByItem = 0;
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+        {
+            TEST_ASSERT_EQUAL( kerneltestBATCH_QUEUE_LENGTH, xQueueSendMultiple( xQueue, ulItems, kerneltestBATCH_QUEUE_LENGTH, 0 ) );
+
+            for( xIndex = 0; xIndex < kerneltestBATCH_QUEUE_LENGTH; xIndex++ )
+            {
+                ( void ) xQueueReceive( xQueue, &( ulReceived[ xIndex ] ), 0 );
+            }
+
+            ulItemByItem++;
+        }
+
+        ulBatched = 0;
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+        {
+            TEST_ASSERT_EQUAL( kerneltestBATCH_QUEUE_LENGTH, xQueueSendMultiple( xQueue, ulItems, kerneltestBATCH_QUEUE_LENGTH, 0 ) );
+            TEST_ASSERT_EQUAL( kerneltestBATCH_QUEUE_LENGTH, xQueueReceiveMultiple( xQueue, ulReceived, kerneltestBATCH_QUEUE_LENGTH, 0 ) );
+            ulBatched++;
+        }
+
+        TEST_ASSERT_EQUAL_UINT32_ARRAY( ulItems, ulReceived, kerneltestBATCH_QUEUE_LENGTH );
+
+        configPRINTF( ( "Queue drain of %u items: item by item %6u ns, batched %6u ns\r\n",
+                        ( unsigned ) kerneltestBATCH_QUEUE_LENGTH,
+                        ( unsigned ) ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulItemByItem ),
+                        ( unsigned ) ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulBatched ) ) );
+
+        vQueueDelete( xQueue );
+    }
+
+#endif /* if ( configUSE_QUEUE_SEND_RECEIVE_MULTIPLE == 1 ) */
+/*-----------------------------------------------------------*/
+
+#if ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 )
+
+    static volatile eTaskState eWaiterState = eInvalid;
+
+/* Wait for the receiver to block, then give to notification indexes 1 and 2
+ * in turn.  The last give to each index is done from the interrupt API. */
+    static void prvNotifierTask( void * pvParameters )
+    {
+        TaskHandle_t xReceiver = ( TaskHandle_t ) pvParameters;
+        uint32_t ulGive;
+
+        vTaskDelay( pdMS_TO_TICKS( 10 ) );
+        eWaiterState = eTaskGetState( xReceiver );
+
+        for( ulGive = 0; ulGive < ( kerneltestNOTIFY_GIVES - 2 ); ulGive++ )
+        {
+            ( void ) xTaskNotifyGiveIndexed( xReceiver, ( UBaseType_t ) ( ( ulGive & 1UL ) + 1UL ) );
+        }
+
+        vTaskNotifyGiveIndexedFromISR( xReceiver, 1, NULL );
+        ( void ) xTaskNotifyIndexedFromISR( xReceiver, 2, 0, eIncrement, NULL );
+
+        vTaskDelete( NULL );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_KERNEL, TaskNotificationIndexes )
+    {
+        TaskHandle_t xSelf = xTaskGetCurrentTaskHandle();
+        UBaseType_t uxIndex = 0;
+        uint32_t ulValue = 0;
+        uint32_t ulReceived = 0;
+        uint32_t ulPerIndex[ 3 ] = { 0 };
+
+        /* Start with nothing pending on any index. */
+        for( uxIndex = 0; uxIndex < configTASK_NOTIFICATION_ARRAY_ENTRIES; uxIndex++ )
+        {
+            ( void ) xTaskNotifyStateClearIndexed( NULL, uxIndex );
+            ( void ) ulTaskNotifyTakeIndexed( uxIndex, pdTRUE, 0 );
+        }
+
+        /* A notification to one index leaves the others alone, and is found
+         * but not consumed by xTaskNotifyWaitAny(). */
+        TEST_ASSERT_EQUAL( pdPASS, xTaskNotifyIndexed( xSelf, 1, 0x55UL, eSetValueWithOverwrite ) );
+        TEST_ASSERT_EQUAL( pdFALSE, xTaskNotifyWait( 0UL, 0UL, &ulValue, 0 ) );
+        TEST_ASSERT_EQUAL( 0, ulValue );
+        TEST_ASSERT_EQUAL( pdTRUE, xTaskNotifyWaitAny( 0x7U, &uxIndex, 0 ) );
+        TEST_ASSERT_EQUAL( 1, uxIndex );
+        TEST_ASSERT_EQUAL( pdFALSE, xTaskNotifyWaitAny( 0x5U, NULL, 0 ) );
+        TEST_ASSERT_EQUAL( pdFAIL, xTaskNotifyIndexed( xSelf, 1, 0xAAUL, eSetValueWithoutOverwrite ) );
+        TEST_ASSERT_EQUAL( pdPASS, xTaskNotifyIndexed( xSelf, 2, 0xAAUL, eSetValueWithoutOverwrite ) );
+        TEST_ASSERT_EQUAL( pdTRUE, xTaskNotifyWaitIndexed( 1, 0UL, 0xffffffffUL, &ulValue, 0 ) );
+        TEST_ASSERT_EQUAL( 0x55UL, ulValue );
+        TEST_ASSERT_EQUAL( pdTRUE, xTaskNotifyWaitAny( 0x7U, &uxIndex, 0 ) );
+        TEST_ASSERT_EQUAL( 2, uxIndex );
+        TEST_ASSERT_EQUAL( pdPASS, xTaskNotifyStateClearIndexed( NULL, 2 ) );
+        TEST_ASSERT_EQUAL( 0xAAUL, ulTaskNotifyTakeIndexed( 2, pdTRUE, 0 ) );
+        TEST_ASSERT_EQUAL( pdFALSE, xTaskNotifyWaitAny( 0x7U, NULL, 0 ) );
+
+        /* Gives to two indexes from another task while this task waits on
+         * both of them.  The default index must not be touched. */
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvNotifierTask, "Notifier", configMINIMAL_STACK_SIZE * 2,
+                                                ( void * ) xSelf, uxTaskPriorityGet( NULL ), NULL ) );
+
+        while( ulReceived < kerneltestNOTIFY_GIVES )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, xTaskNotifyWaitAny( 0x6U, &uxIndex, pdMS_TO_TICKS( 1000 ) ) );
+            TEST_ASSERT_TRUE( ( uxIndex == 1 ) || ( uxIndex == 2 ) );
+            ulValue = ulTaskNotifyTakeIndexed( uxIndex, pdTRUE, 0 );
+            ulPerIndex[ uxIndex ] += ulValue;
+            ulReceived += ulValue;
+        }
+
+        TEST_ASSERT_EQUAL( eBlocked, eWaiterState );
+        TEST_ASSERT_EQUAL( kerneltestNOTIFY_GIVES / 2, ulPerIndex[ 1 ] );
+        TEST_ASSERT_EQUAL( kerneltestNOTIFY_GIVES / 2, ulPerIndex[ 2 ] );
+        TEST_ASSERT_EQUAL( 0, ulTaskNotifyTake( pdTRUE, 0 ) );
+        TEST_ASSERT_EQUAL( pdFALSE, xTaskNotifyWaitAny( 0x7U, NULL, 0 ) );
+    }
+
+#endif /* if ( configTASK_NOTIFICATION_ARRAY_ENTRIES > 1 ) */
+/*-----------------------------------------------------------*/
+
+static volatile uint32_t ulTimerFired[ 16 ];
+static volatile TickType_t xTimerFiredAt[ 16 ];
+static TimerHandle_t xChainedTimer = NULL;
+
+/* Record when each timer fired, using the timer ID as an index. */
+static void prvRecordingTimerCallback( TimerHandle_t xTimer )
+{
+    UBaseType_t uxIndex = ( UBaseType_t ) pvTimerGetTimerID( xTimer );
+
+    xTimerFiredAt[ uxIndex ] = xTaskGetTickCount();
+    ulTimerFired[ uxIndex ]++;
+}
+
+/*-----------------------------------------------------------*/
+
+/* An auto-reload timer that stops itself on its fifth expiry. */
+static void prvSelfStoppingTimerCallback( TimerHandle_t xTimer )
+{
+    BaseType_t xStopped;
+
+    prvRecordingTimerCallback( xTimer );
+
+    if( ulTimerFired[ ( UBaseType_t ) pvTimerGetTimerID( xTimer ) ] == 5 )
+    {
+        xStopped = xTimerStop( xTimer, 0 );
+        configASSERT( xStopped == pdPASS );
+        ( void ) xStopped;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* A one-shot timer that starts another timer, then deletes itself. */
+static void prvChainingTimerCallback( TimerHandle_t xTimer )
+{
+    BaseType_t xStarted, xDeleted;
+
+    prvRecordingTimerCallback( xTimer );
+    xStarted = xTimerStart( xChainedTimer, 0 );
+    xDeleted = xTimerDelete( xTimer, 0 );
+    configASSERT( xStarted == pdPASS );
+    configASSERT( xDeleted == pdPASS );
+    ( void ) xStarted;
+    ( void ) xDeleted;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, TimerExpiry )
+{
+    const TickType_t xPeriods[] = kerneltestTIMER_PERIODS;
+    const UBaseType_t uxTimers = sizeof( xPeriods ) / sizeof( xPeriods[ 0 ] );
+    TimerHandle_t xTimers[ sizeof( xPeriods ) / sizeof( xPeriods[ 0 ] ) ];
+    TickType_t xStartedAfter[ sizeof( xPeriods ) / sizeof( xPeriods[ 0 ] ) ];
+    TickType_t xStartedBefore[ sizeof( xPeriods ) / sizeof( xPeriods[ 0 ] ) ];
+    TimerHandle_t xSelfStopping, xChaining;
+    UBaseType_t uxIndex;
+
+    memset( ( void * ) ulTimerFired, 0x00, sizeof( ulTimerFired ) );
+
+    for( uxIndex = 0; uxIndex < uxTimers; uxIndex++ )
+    {
+        xTimers[ uxIndex ] = xTimerCreate( "Expiry", xPeriods[ uxIndex ], pdFALSE, ( void * ) uxIndex, prvRecordingTimerCallback );
+        TEST_ASSERT_NOT_NULL( xTimers[ uxIndex ] );
+    }
+
+    /* One-shot timers fire once, no earlier than their period after they
+     * were started and not much later. */
+    for( uxIndex = 0; uxIndex < uxTimers; uxIndex++ )
+    {
+        xStartedAfter[ uxIndex ] = xTaskGetTickCount();
+        TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xTimers[ uxIndex ], portMAX_DELAY ) );
+        xStartedBefore[ uxIndex ] = xTaskGetTickCount();
+    }
+
+    /* Timers started from a callback are applied at once, and a timer can
+     * stop or delete itself from its own callback. */
+    xSelfStopping = xTimerCreate( "Stopping", 7, pdTRUE, ( void * ) uxTimers, prvSelfStoppingTimerCallback );
+    xChaining = xTimerCreate( "Chaining", 3, pdFALSE, ( void * ) ( uxTimers + 1 ), prvChainingTimerCallback );
+    xChainedTimer = xTimerCreate( "Chained", 20, pdFALSE, ( void * ) ( uxTimers + 2 ), prvRecordingTimerCallback );
+    TEST_ASSERT_NOT_NULL( xSelfStopping );
+    TEST_ASSERT_NOT_NULL( xChaining );
+    TEST_ASSERT_NOT_NULL( xChainedTimer );
+    TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xSelfStopping, portMAX_DELAY ) );
+    TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xChaining, portMAX_DELAY ) );
+
+    vTaskDelay( xPeriods[ uxTimers - 1 ] + kerneltestTIMER_LATENCY );
+
+    for( uxIndex = 0; uxIndex < uxTimers; uxIndex++ )
+    {
+        TEST_ASSERT_EQUAL( 1, ulTimerFired[ uxIndex ] );
+        TEST_ASSERT_TRUE( ( xTimerFiredAt[ uxIndex ] - xStartedAfter[ uxIndex ] ) >= xPeriods[ uxIndex ] );
+        TEST_ASSERT_TRUE( ( xTimerFiredAt[ uxIndex ] - xStartedBefore[ uxIndex ] ) <= ( xPeriods[ uxIndex ] + kerneltestTIMER_LATENCY ) );
+        TEST_ASSERT_EQUAL( pdFALSE, xTimerIsTimerActive( xTimers[ uxIndex ] ) );
+        TEST_ASSERT_EQUAL( pdPASS, xTimerDelete( xTimers[ uxIndex ], portMAX_DELAY ) );
+    }
+
+    TEST_ASSERT_EQUAL( 5, ulTimerFired[ uxTimers ] );
+    TEST_ASSERT_EQUAL( pdFALSE, xTimerIsTimerActive( xSelfStopping ) );
+    TEST_ASSERT_EQUAL( 1, ulTimerFired[ uxTimers + 1 ] );
+    TEST_ASSERT_EQUAL( 1, ulTimerFired[ uxTimers + 2 ] );
+    TEST_ASSERT_TRUE( ( xTimerFiredAt[ uxTimers + 2 ] - xTimerFiredAt[ uxTimers + 1 ] ) <= ( 20 + kerneltestTIMER_LATENCY ) );
+    TEST_ASSERT_EQUAL( pdPASS, xTimerDelete( xSelfStopping, portMAX_DELAY ) );
+    TEST_ASSERT_EQUAL( pdPASS, xTimerDelete( xChainedTimer, portMAX_DELAY ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static volatile uint32_t ulTimerTaskStartStops = 0;
+static TaskHandle_t xTimerBenchmarkTask = NULL;
+
+static void prvTimerBenchmarkCallback( TimerHandle_t xTimer )
+{
+    ( void ) xTimer;
+
+    /* The benchmark timers never expire. */
+    configASSERT( pdFALSE );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Pended to the timer service task, so the timer commands are issued by the
+ * task that processes them. */
+static void prvTimerTaskStartStop( void * pvParameter1,
+                                   uint32_t ulParameter2 )
+{
+    TimerHandle_t xProbe = ( TimerHandle_t ) pvParameter1;
+    TickType_t xStart = xTaskGetTickCount();
+    uint32_t ulStartStops = 0;
+    BaseType_t xStarted, xStopped;
+
+    ( void ) ulParameter2;
+
+    while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+    {
+        xStarted = xTimerStart( xProbe, 0 );
+        xStopped = xTimerStop( xProbe, 0 );
+        configASSERT( xStarted == pdPASS );
+        configASSERT( xStopped == pdPASS );
+        ( void ) xStarted;
+        ( void ) xStopped;
+        ulStartStops++;
+    }
+
+    ulTimerTaskStartStops = ulStartStops;
+    ( void ) xTaskNotifyGive( xTimerBenchmarkTask );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, TimerStartStop )
+{
+    static TimerHandle_t xTimers[ kerneltestMAX_TIMERS ];
+    const UBaseType_t uxCounts[] = { 10, 100, kerneltestMAX_TIMERS };
+    TimerHandle_t xProbe;
+    UBaseType_t uxActive = 0;
+    UBaseType_t uxCount;
+    uint32_t ulStartStops;
+    TickType_t xStart;
+
+    xProbe = xTimerCreate( "Probe", kerneltestTIMER_MIN_PERIOD + ( kerneltestTIMER_SPREAD / 2 ), pdFALSE, NULL, prvTimerBenchmarkCallback );
+    TEST_ASSERT_NOT_NULL( xProbe );
+
+    for( uxCount = 0; uxCount < ( sizeof( uxCounts ) / sizeof( uxCounts[ 0 ] ) ); uxCount++ )
+    {
+        for( ; uxActive < uxCounts[ uxCount ]; uxActive++ )
+        {
+            xTimers[ uxActive ] = xTimerCreate( "Active", kerneltestTIMER_MIN_PERIOD + ( ( uxActive * 7919U ) % kerneltestTIMER_SPREAD ),
+                                                pdFALSE, NULL, prvTimerBenchmarkCallback );
+            TEST_ASSERT_NOT_NULL( xTimers[ uxActive ] );
+            TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xTimers[ uxActive ], portMAX_DELAY ) );
+        }
+
+        /* Commands from a task go through the timer queue. */
+        ulStartStops = 0;
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, xTimerStart( xProbe, portMAX_DELAY ) );
+            TEST_ASSERT_EQUAL( pdPASS, xTimerStop( xProbe, portMAX_DELAY ) );
+            ulStartStops++;
+        }
+
+        /* Commands from the timer service task itself, as from a callback. */
+        ulTimerTaskStartStops = 0;
+        #if ( configUSE_TIMER_WHEEL == 1 )
+            xTimerBenchmarkTask = xTaskGetCurrentTaskHandle();
+            ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+            TEST_ASSERT_EQUAL( pdPASS, xTimerPendFunctionCall( prvTimerTaskStartStop, ( void * ) xProbe, 0, portMAX_DELAY ) );
+            TEST_ASSERT_NOT_EQUAL( 0, ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( 5000 ) ) );
+            TEST_ASSERT_NOT_EQUAL( 0, ulTimerTaskStartStops );
+        #endif
+
+        configPRINTF( ( "Timer start and stop with %4u timers active: from a task %6u ns, from the timer task %6u ns\r\n",
+                        ( unsigned ) uxActive,
+                        ( unsigned ) ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulStartStops ),
+                        ( unsigned ) ( ( ulTimerTaskStartStops == 0 ) ? 0 : ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulTimerTaskStartStops ) ) ) );
+    }
+
+    while( uxActive > 0 )
+    {
+        uxActive--;
+        TEST_ASSERT_EQUAL( pdPASS, xTimerDelete( xTimers[ uxActive ], portMAX_DELAY ) );
+    }
+
+    TEST_ASSERT_EQUAL( pdPASS, xTimerDelete( xProbe, portMAX_DELAY ) );
+}
+
+/*-----------------------------------------------------------*/
+
+typedef struct
+{
+    EventBits_t uxBitsToWaitFor;
+    BaseType_t xClearOnExit;
+    BaseType_t xWaitForAllBits;
+    TickType_t xTicksToWait;
+    volatile EventBits_t uxReturned;
+    volatile BaseType_t xReturned;
+} BitWaiter_t;
+
+static EventGroupHandle_t xWaitersEventGroup = NULL;
+
+#ifdef kerneltestGET_TIME_NS
+/* Only sets on this event group are timed, as other tasks use event groups
+ * too. */
+    static EventGroupHandle_t xTimedEventGroup = NULL;
+    static unsigned long long ullSetBitsStart;
+    static unsigned long long ullSetBitsTotal;
+    static uint32_t ulTimedSets;
+#endif
+
+static void prvBitWaiterTask( void * pvParameters )
+{
+    BitWaiter_t * pxWaiter = ( BitWaiter_t * ) pvParameters;
+
+    pxWaiter->uxReturned = xEventGroupWaitBits( xWaitersEventGroup, pxWaiter->uxBitsToWaitFor, pxWaiter->xClearOnExit,
+                                                pxWaiter->xWaitForAllBits, pxWaiter->xTicksToWait );
+    pxWaiter->xReturned = pdTRUE;
+
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+#ifdef kerneltestGET_TIME_NS
+    void vTraceEventGroupSetBits( void * pvEventGroup,
+                                  int iEnd )
+    {
+        if( ( xTimedEventGroup != NULL ) && ( pvEventGroup == ( void * ) xTimedEventGroup ) )
+        {
+            if( iEnd == 0 )
+            {
+                ullSetBitsStart = kerneltestGET_TIME_NS();
+            }
+            else
+            {
+                ullSetBitsTotal += kerneltestGET_TIME_NS() - ullSetBitsStart;
+                ulTimedSets++;
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+#endif /* ifdef kerneltestGET_TIME_NS */
+
+static void prvStartBitWaiter( BitWaiter_t * pxWaiter,
+                               EventBits_t uxBitsToWaitFor,
+                               BaseType_t xClearOnExit,
+                               BaseType_t xWaitForAllBits,
+                               TickType_t xTicksToWait )
+{
+    pxWaiter->uxBitsToWaitFor = uxBitsToWaitFor;
+    pxWaiter->xClearOnExit = xClearOnExit;
+    pxWaiter->xWaitForAllBits = xWaitForAllBits;
+    pxWaiter->xTicksToWait = xTicksToWait;
+    pxWaiter->uxReturned = 0;
+    pxWaiter->xReturned = pdFALSE;
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvBitWaiterTask, "BitWaiter", configMINIMAL_STACK_SIZE, ( void * ) pxWaiter,
+                                            uxTaskPriorityGet( NULL ) + 1, NULL ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Returns the number of waiters that returned within xTicksToWait. */
+static UBaseType_t prvWaitForBitWaiters( BitWaiter_t * pxWaiters,
+                                         UBaseType_t uxWaiters,
+                                         TickType_t xTicksToWait )
+{
+    UBaseType_t uxIndex;
+    UBaseType_t uxReturned;
+    TickType_t xWaited = 0;
+
+    for( ; ; )
+    {
+        uxReturned = 0;
+
+        for( uxIndex = 0; uxIndex < uxWaiters; uxIndex++ )
+        {
+            if( pxWaiters[ uxIndex ].xReturned != pdFALSE )
+            {
+                uxReturned++;
+            }
+        }
+
+        if( ( uxReturned == uxWaiters ) || ( xWaited >= xTicksToWait ) )
+        {
+            break;
+        }
+
+        vTaskDelay( 1 );
+        xWaited++;
+    }
+
+    return uxReturned;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, EventGroupWaiters )
+{
+    static BitWaiter_t xWaiters[ kerneltestMAX_BIT_WAITERS ];
+    const UBaseType_t uxCounts[] = { 0, 16, 64, kerneltestMAX_BIT_WAITERS };
+    UBaseType_t uxCount;
+    UBaseType_t uxWaiters = 0;
+    uint32_t ulSets;
+    TickType_t xStart;
+
+    xWaitersEventGroup = xEventGroupCreate();
+    TEST_ASSERT_NOT_NULL( xWaitersEventGroup );
+
+    /* All of three bits, any of two bits, a single bit, all of two bits with
+     * a timeout, and all of two bits one of which is cleared again. */
+    prvStartBitWaiter( &( xWaiters[ 0 ] ), 0x007, pdTRUE, pdTRUE, portMAX_DELAY );
+    prvStartBitWaiter( &( xWaiters[ 1 ] ), 0x018, pdFALSE, pdFALSE, portMAX_DELAY );
+    prvStartBitWaiter( &( xWaiters[ 2 ] ), 0x020, pdFALSE, pdFALSE, portMAX_DELAY );
+    prvStartBitWaiter( &( xWaiters[ 3 ] ), 0x0c0, pdFALSE, pdTRUE, kerneltestWAITER_TICKS * 4 );
+    prvStartBitWaiter( &( xWaiters[ 4 ] ), 0x300, pdFALSE, pdTRUE, portMAX_DELAY );
+    vTaskDelay( kerneltestWAITER_TICKS );
+    TEST_ASSERT_EQUAL( 0, prvWaitForBitWaiters( xWaiters, 5, 0 ) );
+
+    /* Two of the three bits waited for by the first waiter. */
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x002 );
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x001 );
+    TEST_ASSERT_EQUAL( 0, prvWaitForBitWaiters( &( xWaiters[ 0 ] ), 1, kerneltestWAITER_TICKS ) );
+
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x010 );
+    TEST_ASSERT_EQUAL( 1, prvWaitForBitWaiters( &( xWaiters[ 1 ] ), 1, kerneltestWAITER_TICKS ) );
+    TEST_ASSERT_EQUAL( 0x013, xWaiters[ 1 ].uxReturned );
+
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x004 );
+    TEST_ASSERT_EQUAL( 1, prvWaitForBitWaiters( &( xWaiters[ 0 ] ), 1, kerneltestWAITER_TICKS ) );
+    TEST_ASSERT_EQUAL( 0x017, xWaiters[ 0 ].uxReturned );
+    TEST_ASSERT_EQUAL( 0x010, xEventGroupGetBits( xWaitersEventGroup ) );
+
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x020 );
+    TEST_ASSERT_EQUAL( 1, prvWaitForBitWaiters( &( xWaiters[ 2 ] ), 1, kerneltestWAITER_TICKS ) );
+
+    /* Only one of its bits is set before the fourth waiter times out. */
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x040 );
+    TEST_ASSERT_EQUAL( 1, prvWaitForBitWaiters( &( xWaiters[ 3 ] ), 1, kerneltestWAITER_TICKS * 8 ) );
+    TEST_ASSERT_EQUAL( 0x070, xWaiters[ 3 ].uxReturned );
+
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x100 );
+    ( void ) xEventGroupClearBits( xWaitersEventGroup, 0x100 );
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x200 );
+    TEST_ASSERT_EQUAL( 0, prvWaitForBitWaiters( &( xWaiters[ 4 ] ), 1, kerneltestWAITER_TICKS ) );
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x100 );
+    TEST_ASSERT_EQUAL( 1, prvWaitForBitWaiters( &( xWaiters[ 4 ] ), 1, kerneltestWAITER_TICKS ) );
+    TEST_ASSERT_EQUAL( 0x370, xWaiters[ 4 ].uxReturned );
+
+    ( void ) xEventGroupClearBits( xWaitersEventGroup, 0x370 );
+
+    /* Set and clear a bit while more and more tasks wait for another one. */
+    for( uxCount = 0; uxCount < ( sizeof( uxCounts ) / sizeof( uxCounts[ 0 ] ) ); uxCount++ )
+    {
+        for( ; uxWaiters < uxCounts[ uxCount ]; uxWaiters++ )
+        {
+            prvStartBitWaiter( &( xWaiters[ uxWaiters ] ), 0x001, pdFALSE, pdFALSE, portMAX_DELAY );
+        }
+
+        vTaskDelay( kerneltestWAITER_TICKS );
+
+        ulSets = 0;
+        #ifdef kerneltestGET_TIME_NS
+            ullSetBitsTotal = 0;
+            ulTimedSets = 0;
+            xTimedEventGroup = xWaitersEventGroup;
+        #endif
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+        {
+            ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x002 );
+            ( void ) xEventGroupClearBits( xWaitersEventGroup, 0x002 );
+            ulSets++;
+        }
+
+        #ifdef kerneltestGET_TIME_NS
+            xTimedEventGroup = NULL;
+            TEST_ASSERT_EQUAL_UINT32( ulSets, ulTimedSets );
+
+            configPRINTF( ( "Event group set bits with %3u other tasks waiting: %5u ns suspended (%s)\r\n",
+                            ( unsigned ) uxWaiters,
+                            ( unsigned ) ( ullSetBitsTotal / ulTimedSets ),
+                            ( configUSE_EVENT_GROUP_BIT_INDEX == 1 ) ? "bit index" : "single list" ) );
+        #else
+            configPRINTF( ( "Event group set bits with %3u other tasks waiting: %5u ns\r\n",
+                            ( unsigned ) uxWaiters,
+                            ( unsigned ) ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulSets ) ) );
+        #endif
+    }
+
+    TEST_ASSERT_EQUAL( 0, prvWaitForBitWaiters( xWaiters, uxWaiters, 0 ) );
+
+    /* Deleting the event group unblocks the last waiter, whatever it waits
+     * for. */
+    ( void ) xEventGroupSetBits( xWaitersEventGroup, 0x001 );
+    TEST_ASSERT_EQUAL( uxWaiters, prvWaitForBitWaiters( xWaiters, uxWaiters, kerneltestWAITER_TICKS ) );
+    prvStartBitWaiter( &( xWaiters[ 0 ] ), 0x0f0, pdFALSE, pdTRUE, portMAX_DELAY );
+    vTaskDelay( kerneltestWAITER_TICKS );
+    vEventGroupDelete( xWaitersEventGroup );
+    TEST_ASSERT_EQUAL( 1, prvWaitForBitWaiters( xWaiters, 1, kerneltestWAITER_TICKS ) );
+    TEST_ASSERT_EQUAL( 0, xWaiters[ 0 ].uxReturned );
+}
+
+/*-----------------------------------------------------------*/
+
+typedef struct
+{
+    uint8_t * pucBlock;
+    size_t xSize;
+} HeapTraceBlock_t;
+
+/* The size of the next allocation.  Most TLS allocations are small big
+ * number and ASN.1 buffers, then certificates, then the record buffers. */
+static size_t prvHeapTraceSize( uint32_t * pulSeed )
+{
+    uint32_t ulRandom = prvRandom( pulSeed );
+    size_t xSize;
+
+    switch( ulRandom % 100UL )
+    {
+        case 0:
+        case 1:
+        case 2:
+            xSize = kerneltestHEAP_TLS_RECORD_SIZE;
+            break;
+
+        default:
+
+            if( ( ulRandom % 100UL ) < 50UL )
+            {
+                xSize = 16 + ( ( ulRandom >> 8 ) % 112 );
+            }
+            else if( ( ulRandom % 100UL ) < 85UL )
+            {
+                xSize = 128 + ( ( ulRandom >> 8 ) % 896 );
+            }
+            else
+            {
+                xSize = 1024 + ( ( ulRandom >> 8 ) % 3072 );
+            }
+
+            break;
+    }
+
+    return xSize;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapTraceFill( HeapTraceBlock_t * pxBlock,
+                              size_t xSize )
+{
+    pxBlock->xSize = xSize;
+    pxBlock->pucBlock = ( uint8_t * ) pvPortMalloc( xSize );
+    configASSERT( pxBlock->pucBlock != NULL );
+    pxBlock->pucBlock[ 0 ] = ( uint8_t ) xSize;
+    pxBlock->pucBlock[ xSize - 1 ] = ( uint8_t ) ( xSize >> 8 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapTraceFree( HeapTraceBlock_t * pxBlock )
+{
+    /* Blocks that overlapped another block would have been overwritten. */
+    configASSERT( pxBlock->pucBlock[ 0 ] == ( uint8_t ) pxBlock->xSize );
+    configASSERT( pxBlock->pucBlock[ pxBlock->xSize - 1 ] == ( uint8_t ) ( pxBlock->xSize >> 8 ) );
+    vPortFree( pxBlock->pucBlock );
+    pxBlock->pucBlock = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Allocate or free a random block.  A quarter of the blocks that are not
+ * freed are reallocated at twice their size, as a CBOR encoder grows its
+ * buffer. */
+static void prvHeapTraceStep( HeapTraceBlock_t * pxBlocks,
+                              uint32_t * pulSeed )
+{
+    HeapTraceBlock_t * pxBlock = &( pxBlocks[ prvRandom( pulSeed ) % kerneltestHEAP_BLOCKS ] );
+    HeapTraceBlock_t xOld;
+
+    if( pxBlock->pucBlock == NULL )
+    {
+        prvHeapTraceFill( pxBlock, prvHeapTraceSize( pulSeed ) );
+    }
+    else if( ( ( prvRandom( pulSeed ) & 3UL ) == 0UL ) && ( pxBlock->xSize <= ( kerneltestHEAP_MAX_CBOR_SIZE / 2 ) ) )
+    {
+        xOld = *pxBlock;
+        prvHeapTraceFill( pxBlock, xOld.xSize * 2 );
+        prvHeapTraceFree( &xOld );
+    }
+    else
+    {
+        prvHeapTraceFree( pxBlock );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Find the largest block that can be allocated now. */
+static size_t prvLargestFreeBlock( void )
+{
+    size_t xLargest = 0;
+    size_t xTooLarge = xPortGetFreeHeapSize() + 1;
+    size_t xTry;
+    void * pvTry;
+
+    while( ( xTooLarge - xLargest ) > 1 )
+    {
+        xTry = xLargest + ( ( xTooLarge - xLargest ) / 2 );
+        pvTry = pvPortMalloc( xTry );
+
+        if( pvTry != NULL )
+        {
+            vPortFree( pvTry );
+            xLargest = xTry;
+        }
+        else
+        {
+            xTooLarge = xTry;
+        }
+    }
+
+    return xLargest;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, HeapTrace )
+{
+    static HeapTraceBlock_t xBlocks[ kerneltestHEAP_BLOCKS ];
+    static HeapTraceBlock_t xLongLived[ kerneltestHEAP_HOLES * 2 ];
+    uint32_t ulSeed = 0x5eed;
+    uint32_t ulOperations = 0;
+    size_t xLargestAtStart;
+    size_t xFree;
+    size_t xLargest;
+    UBaseType_t uxIndex;
+    TickType_t xStart;
+
+    memset( xBlocks, 0x00, sizeof( xBlocks ) );
+    xLargestAtStart = prvLargestFreeBlock();
+
+    /* Leave holes between blocks that stay allocated, as objects created
+     * while the system starts do. */
+    for( uxIndex = 0; uxIndex < ( kerneltestHEAP_HOLES * 2 ); uxIndex++ )
+    {
+        prvHeapTraceFill( &( xLongLived[ uxIndex ] ), 64 + ( prvRandom( &ulSeed ) % 448 ) );
+    }
+
+    for( uxIndex = 0; uxIndex < ( kerneltestHEAP_HOLES * 2 ); uxIndex += 2 )
+    {
+        prvHeapTraceFree( &( xLongLived[ uxIndex ] ) );
+    }
+
+    for( uxIndex = 0; uxIndex < kerneltestHEAP_WARM_UP; uxIndex++ )
+    {
+        prvHeapTraceStep( xBlocks, &ulSeed );
+    }
+
+    xStart = xTaskGetTickCount();
+
+    while( ( xTaskGetTickCount() - xStart ) < kerneltestBENCHMARK_TICKS )
+    {
+        prvHeapTraceStep( xBlocks, &ulSeed );
+        ulOperations++;
+    }
+
+    xFree = xPortGetFreeHeapSize();
+    xLargest = prvLargestFreeBlock();
+
+    configPRINTF( ( "Heap trace: %4u ns per operation, %7u bytes free, largest free block %7u bytes (%u%%)\r\n",
+                    ( unsigned ) ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulOperations ),
+                    ( unsigned ) xFree,
+                    ( unsigned ) xLargest,
+                    ( unsigned ) ( ( ( uint64_t ) xLargest * 100ULL ) / xFree ) ) );
+
+    /* Freeing everything merges the heap back together.  Other tasks may
+     * hold a little memory they did not hold at the start. */
+    for( uxIndex = 0; uxIndex < kerneltestHEAP_BLOCKS; uxIndex++ )
+    {
+        if( xBlocks[ uxIndex ].pucBlock != NULL )
+        {
+            prvHeapTraceFree( &( xBlocks[ uxIndex ] ) );
+        }
+    }
+
+    for( uxIndex = 1; uxIndex < ( kerneltestHEAP_HOLES * 2 ); uxIndex += 2 )
+    {
+        prvHeapTraceFree( &( xLongLived[ uxIndex ] ) );
+    }
+
+    TEST_ASSERT_TRUE( prvLargestFreeBlock() >= ( xLargestAtStart - ( xLargestAtStart / 16 ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static volatile BaseType_t xStopHeapWorkers = pdFALSE;
+static volatile uint32_t ulHeapWorkerBursts[ kerneltestHEAP_WORKERS ];
+static TaskHandle_t xHeapBenchmarkTask = NULL;
+
+#if ( configUSE_HEAP_TASK_CACHES == 1 )
+    static volatile size_t xHeapCachedBytes = 0;
+#endif
+
+static void prvHeapWorkerTask( void * pvParameters )
+{
+    const UBaseType_t uxWorker = ( UBaseType_t ) pvParameters;
+    uint32_t ulSeed = ( uint32_t ) uxWorker;
+    void * pvBlocks[ kerneltestHEAP_BURST ];
+    UBaseType_t uxIndex;
+
+    while( xStopHeapWorkers == pdFALSE )
+    {
+        for( uxIndex = 0; uxIndex < kerneltestHEAP_BURST; uxIndex++ )
+        {
+            pvBlocks[ uxIndex ] = pvPortMalloc( 1 + ( prvRandom( &ulSeed ) % kerneltestHEAP_SMALL_SIZE ) );
+            configASSERT( pvBlocks[ uxIndex ] != NULL );
+        }
+
+        for( uxIndex = 0; uxIndex < kerneltestHEAP_BURST; uxIndex++ )
+        {
+            vPortFree( pvBlocks[ uxIndex ] );
+        }
+
+        ulHeapWorkerBursts[ uxWorker ]++;
+    }
+
+    ( void ) xTaskNotifyGive( xHeapBenchmarkTask );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_HEAP_TASK_CACHES == 1 )
+
+/* Leave a burst of freed blocks in the task's cache, then wait to be
+ * deleted. */
+    static void prvHeapCachingTask( void * pvParameters )
+    {
+        void * pvBlocks[ kerneltestHEAP_BURST ];
+        void * pvReused;
+        UBaseType_t uxIndex;
+
+        ( void ) pvParameters;
+
+        for( uxIndex = 0; uxIndex < kerneltestHEAP_BURST; uxIndex++ )
+        {
+            pvBlocks[ uxIndex ] = pvPortMalloc( kerneltestHEAP_SMALL_SIZE - 8 );
+            configASSERT( pvBlocks[ uxIndex ] != NULL );
+        }
+
+        for( uxIndex = 0; uxIndex < kerneltestHEAP_BURST; uxIndex++ )
+        {
+            vPortFree( pvBlocks[ uxIndex ] );
+        }
+
+        /* The last block freed is the first reused. */
+        pvReused = pvPortMalloc( kerneltestHEAP_SMALL_SIZE - 8 );
+        configASSERT( pvReused == pvBlocks[ kerneltestHEAP_BURST - 1 ] );
+        vPortFree( pvReused );
+
+        xHeapCachedBytes = xPortGetTaskCachedHeapSize();
+        ( void ) xTaskNotifyGive( xHeapBenchmarkTask );
+
+        for( ; ; )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+    }
+
+#endif /* if ( configUSE_HEAP_TASK_CACHES == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_KERNEL, HeapSmallBlocks )
+{
+    UBaseType_t uxWorker;
+    uint32_t ulBursts = 0;
+
+    xHeapBenchmarkTask = xTaskGetCurrentTaskHandle();
+    ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+    #if ( configUSE_HEAP_TASK_CACHES == 1 )
+        {
+            TaskHandle_t xCachingTask = NULL;
+            size_t xCachedBefore, xCachedAfter;
+
+            /* A task keeps the blocks it frees until the task is deleted.
+             * Other tasks, possibly on another core, fill and trim their own
+             * caches at the same time, so the caching task reports the size
+             * of its own cache. */
+            xHeapCachedBytes = 0;
+            TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvHeapCachingTask, "Caching", configMINIMAL_STACK_SIZE, NULL,
+                                                    uxTaskPriorityGet( NULL ), &xCachingTask ) );
+            TEST_ASSERT_NOT_EQUAL( 0, ulTaskNotifyTake( pdTRUE, kerneltestWAITER_TICKS ) );
+            TEST_ASSERT_TRUE( xHeapCachedBytes >= ( kerneltestHEAP_BURST * kerneltestHEAP_SMALL_SIZE ) );
+            TEST_ASSERT_TRUE( xHeapCachedBytes < ( kerneltestHEAP_BURST * ( kerneltestHEAP_SMALL_SIZE + 64 ) ) );
+
+            /* No task starts to change its cache while the scheduler is
+             * suspended, and the TCB and stack of the deleted task are then
+             * freed to the heap rather than to the cache of this task, so
+             * deleting the task releases exactly the bytes it cached. */
+            vTaskSuspendAll();
+            {
+                xCachedBefore = xPortGetCachedHeapSize();
+                vTaskDelete( xCachingTask );
+                xCachedAfter = xPortGetCachedHeapSize();
+            }
+            ( void ) xTaskResumeAll();
+            TEST_ASSERT_EQUAL( xCachedBefore - xHeapCachedBytes, xCachedAfter );
+        }
+    #endif /* if ( configUSE_HEAP_TASK_CACHES == 1 ) */
+
+    xStopHeapWorkers = pdFALSE;
+
+    for( uxWorker = 0; uxWorker < kerneltestHEAP_WORKERS; uxWorker++ )
+    {
+        ulHeapWorkerBursts[ uxWorker ] = 0;
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvHeapWorkerTask, "HeapWorker", configMINIMAL_STACK_SIZE * 2, ( void * ) uxWorker,
+                                                uxTaskPriorityGet( NULL ), NULL ) );
+    }
+
+    vTaskDelay( kerneltestBENCHMARK_TICKS );
+    xStopHeapWorkers = pdTRUE;
+
+    for( uxWorker = 0; uxWorker < kerneltestHEAP_WORKERS; uxWorker++ )
+    {
+        TEST_ASSERT_NOT_EQUAL( 0, ulTaskNotifyTake( pdFALSE, kerneltestWAITER_TICKS ) );
+        ulBursts += ulHeapWorkerBursts[ uxWorker ];
+    }
+
+    configPRINTF( ( "Heap small blocks from %u tasks: %5u ns per allocation and free\r\n",
+                    ( unsigned ) kerneltestHEAP_WORKERS,
+                    ( unsigned ) ( ( ( uint64_t ) kerneltestBENCHMARK_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ( ( uint64_t ) ulBursts * kerneltestHEAP_BURST ) ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configNUMBER_OF_CORES > 1 )
+
+    static TaskHandle_t xSMPTestTask = NULL;
+    static volatile BaseType_t xStopSMPTasks = pdFALSE;
+    static volatile UBaseType_t uxSMPCoresSeen = 0;
+    static TaskHandle_t xSMPSpinTasks[ 2 ];
+    static volatile uint32_t ulSMPLooks[ 2 ];
+    static volatile uint32_t ulSMPOtherRunning[ 2 ];
+
+/* Record the cores the task runs on, blocking and yielding in turn so that
+ * the scheduler may move it to another core. */
+    static void prvSMPPinnedTask( void * pvParameters )
+    {
+        uint32_t ulCount = 0;
+
+        ( void ) pvParameters;
+
+        while( xStopSMPTasks == pdFALSE )
+        {
+            uxSMPCoresSeen |= ( ( UBaseType_t ) 1 ) << portGET_CORE_ID();
+
+            if( ( ulCount++ % 2 ) == 0 )
+            {
+                vTaskDelay( 1 );
+            }
+            else
+            {
+                taskYIELD();
+            }
+        }
+
+        ( void ) xTaskNotifyGive( xSMPTestTask );
+        vTaskDelete( NULL );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_KERNEL, CoreAffinity )
+    {
+        TaskHandle_t xPinnedTask = NULL;
+
+        xSMPTestTask = xTaskGetCurrentTaskHandle();
+        ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+
+        /* The affinity of the calling task moves it to the core it allows. */
+        TEST_ASSERT_EQUAL( tskNO_AFFINITY, uxTaskCoreAffinityGet( NULL ) );
+        vTaskCoreAffinitySet( NULL, ( ( UBaseType_t ) 1 ) << 1 );
+        TEST_ASSERT_EQUAL( ( ( UBaseType_t ) 1 ) << 1, uxTaskCoreAffinityGet( NULL ) );
+        TEST_ASSERT_EQUAL( 1, portGET_CORE_ID() );
+        vTaskCoreAffinitySet( NULL, ( ( UBaseType_t ) 1 ) << 0 );
+        TEST_ASSERT_EQUAL( ( ( UBaseType_t ) 1 ) << 0, uxTaskCoreAffinityGet( NULL ) );
+        TEST_ASSERT_EQUAL( 0, portGET_CORE_ID() );
+        vTaskCoreAffinitySet( NULL, tskNO_AFFINITY );
+        TEST_ASSERT_EQUAL( tskNO_AFFINITY, uxTaskCoreAffinityGet( NULL ) );
+
+        /* A task pinned to core 1 never runs on core 0, although core 0 is
+         * idle while this task waits. */
+        xStopSMPTasks = pdFALSE;
+        uxSMPCoresSeen = 0;
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvSMPPinnedTask, "Pinned", configMINIMAL_STACK_SIZE, NULL,
+                                                kerneltestBENCHMARK_PRIORITY, &xPinnedTask ) );
+        TEST_ASSERT_EQUAL( tskNO_AFFINITY, uxTaskCoreAffinityGet( xPinnedTask ) );
+        vTaskCoreAffinitySet( xPinnedTask, ( ( UBaseType_t ) 1 ) << 1 );
+        TEST_ASSERT_EQUAL( ( ( UBaseType_t ) 1 ) << 1, uxTaskCoreAffinityGet( xPinnedTask ) );
+        vTaskDelay( 2 );
+        uxSMPCoresSeen = 0;
+        vTaskDelay( kerneltestSMP_TICKS );
+        TEST_ASSERT_EQUAL( ( ( UBaseType_t ) 1 ) << 1, uxSMPCoresSeen );
+
+        /* Changing the affinity of the running task moves it to core 0. */
+        vTaskCoreAffinitySet( xPinnedTask, ( ( UBaseType_t ) 1 ) << 0 );
+        TEST_ASSERT_EQUAL( ( ( UBaseType_t ) 1 ) << 0, uxTaskCoreAffinityGet( xPinnedTask ) );
+        vTaskDelay( 2 );
+        uxSMPCoresSeen = 0;
+        vTaskDelay( kerneltestSMP_TICKS );
+        TEST_ASSERT_EQUAL( ( ( UBaseType_t ) 1 ) << 0, uxSMPCoresSeen );
+
+        xStopSMPTasks = pdTRUE;
+        TEST_ASSERT_NOT_EQUAL( 0, ulTaskNotifyTake( pdTRUE, kerneltestSMP_TICKS ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Spin without blocking, and count how often the other spinning task is
+ * running as well.  With one core it never would be. */
+    static void prvSMPSpinTask( void * pvParameters )
+    {
+        const UBaseType_t uxSelf = ( UBaseType_t ) ( uintptr_t ) pvParameters;
+        const UBaseType_t uxOther = uxSelf ^ 1;
+
+        while( xStopSMPTasks == pdFALSE )
+        {
+            if( xSMPSpinTasks[ uxOther ] != NULL )
+            {
+                ulSMPLooks[ uxSelf ]++;
+
+                if( eTaskGetState( xSMPSpinTasks[ uxOther ] ) == eRunning )
+                {
+                    ulSMPOtherRunning[ uxSelf ]++;
+                }
+            }
+        }
+
+        ( void ) xTaskNotifyGive( xSMPTestTask );
+        vTaskDelete( NULL );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_KERNEL, CoreParallelism )
+    {
+        UBaseType_t uxOriginalPriority;
+        UBaseType_t uxTask;
+
+        xSMPTestTask = xTaskGetCurrentTaskHandle();
+        ( void ) ulTaskNotifyTake( pdTRUE, 0 );
+        xStopSMPTasks = pdFALSE;
+
+        for( uxTask = 0; uxTask < 2; uxTask++ )
+        {
+            xSMPSpinTasks[ uxTask ] = NULL;
+            ulSMPLooks[ uxTask ] = 0;
+            ulSMPOtherRunning[ uxTask ] = 0;
+        }
+
+        /* This task gets a higher priority than the spinning tasks, so that
+         * it can stop them, but it sleeps while they run. */
+        uxOriginalPriority = uxTaskPriorityGet( NULL );
+        vTaskPrioritySet( NULL, kerneltestBENCHMARK_PRIORITY + 1 );
+
+        for( uxTask = 0; uxTask < 2; uxTask++ )
+        {
+            TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( prvSMPSpinTask, "Spin", configMINIMAL_STACK_SIZE, ( void * ) ( uintptr_t ) uxTask,
+                                                    kerneltestBENCHMARK_PRIORITY, &( xSMPSpinTasks[ uxTask ] ) ) );
+        }
+
+        vTaskDelay( kerneltestSMP_TICKS );
+        xStopSMPTasks = pdTRUE;
+
+        for( uxTask = 0; uxTask < 2; uxTask++ )
+        {
+            TEST_ASSERT_NOT_EQUAL( 0, ulTaskNotifyTake( pdFALSE, kerneltestSMP_TICKS ) );
+        }
+
+        vTaskPrioritySet( NULL, uxOriginalPriority );
+
+        /* Both tasks ran, and mostly at the same time.  Other tasks of a
+         * higher priority may take a core now and then. */
+        for( uxTask = 0; uxTask < 2; uxTask++ )
+        {
+            TEST_ASSERT_NOT_EQUAL( 0, ulSMPLooks[ uxTask ] );
+            TEST_ASSERT_TRUE( ulSMPOtherRunning[ uxTask ] > ( ulSMPLooks[ uxTask ] / 2 ) );
+        }
+    }
+
+#endif /* if ( configNUMBER_OF_CORES > 1 ) */
@@ -34,16 +34,103 @@
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_IP_Private.h"
 #include "FreeRTOS_DNS.h"
+#include "NetworkBufferManagement.h"
+#include "semphr.h"
 
 /* Test includes. */
 #include "unity_fixture.h"
 #include "unity.h"
 #include "aws_freertos_tcp_test_access_declare.h"
+#include "aws_test_runner_config.h"
 
 /**
  * @brief Configuration for this test group.
  */
 
+/* Largest number of connected sockets used by the socket lookup benchmark. */
+#define tcptestLOOKUP_MAX_SOCKETS     256
+
+/* Number of ticks during which the lookups are counted, for each step. */
+#define tcptestLOOKUP_TICKS           pdMS_TO_TICKS( 100 )
+
+/* Local ports used by the lookup benchmark. */
+#define tcptestLOOKUP_CHILD_PORT      5000
+#define tcptestLOOKUP_LISTEN_PORT     5001
+
+/* The congestion control harness sends a bulk stream from one TCP window to
+ * another over a simulated path: a bottleneck that forwards
+ * tcptestCC_LINK_RATE segments per tick from a drop-tail queue, followed by a
+ * fixed one-way delay on which segments are lost at random.  The ACK's take the
+ * same delay back without any loss.  With a round-trip of 20 ms the path holds
+ * 40 segments, plus 16 in the queue, which is less than the transmission
+ * window: without congestion control there are losses even when no loss is
+ * injected. */
+#define tcptestCC_MSS                 1460
+#define tcptestCC_WINDOW_SEGMENTS     64
+#define tcptestCC_BUFFER_LENGTH       ( tcptestCC_WINDOW_SEGMENTS * tcptestCC_MSS )
+#define tcptestCC_LINK_RATE           2
+#define tcptestCC_QUEUE_LENGTH        16
+#define tcptestCC_DELAY_TICKS         pdMS_TO_TICKS( 10 )
+#define tcptestCC_WIRE_LENGTH         ( ( tcptestCC_LINK_RATE * tcptestCC_DELAY_TICKS ) + tcptestCC_WINDOW_SEGMENTS )
+#define tcptestCC_RUN_TICKS           pdMS_TO_TICKS( 2000 )
+
+/* A new TCP window has no RTT measurement yet, so its first time-outs take
+ * a second.  The first window of segments is never lost, so that the runs show
+ * the steady state rather than the luck of the first few segments. */
+#define tcptestCC_WARM_UP_SEGMENTS    tcptestCC_WINDOW_SEGMENTS
+
+/* Number of segments sent at once by the SACK scoreboard test. */
+#define tcptestSACK_SEGMENTS          20
+
+/* The checksum benchmark times each implementation of usGenerateChecksum()
+ * for these payload lengths, during tcptestCHECKSUM_TICKS each. */
+#define tcptestCHECKSUM_TICKS         pdMS_TO_TICKS( 50 )
+#define tcptestCHECKSUM_BUFFER_SIZE   2048
+
+/* The implementations in portable/Checksum that are built for x86 hosts. */
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+    #define tcptestCHECKSUM_X86       1
+#else
+    #define tcptestCHECKSUM_X86       0
+#endif
+
+/* The network buffer test takes and releases this many buffers per tick
+ * during tcptestBUFFER_TICKS, to compare BufferAllocation_3.c with a pool
+ * that is protected by a semaphore, like BufferAllocation_2.c. */
+#define tcptestBUFFER_TICKS           pdMS_TO_TICKS( 50 )
+#define tcptestBUFFER_SMALL           64
+#define tcptestBUFFER_LARGE           1000
+
+/* The size of the payload buffers in the zero-copy send test. */
+#define tcptestZERO_COPY_SIZE         100
+
+/* The connected zero-copy test talks to a peer that is simulated by passing
+ * packets to the IP-task.  The peer advertises a small MSS, so that the large
+ * buffer gets two segments, which are sent by copying.  The small buffer fits
+ * in one segment and is sent as it is. */
+#define tcptestZERO_COPY_PORT         5002
+#define tcptestZERO_COPY_PEER_PORT    40000
+#define tcptestZERO_COPY_PEER_HOST    77
+#define tcptestZERO_COPY_PEER_ISN     1000
+#define tcptestZERO_COPY_PEER_MSS     536
+#define tcptestZERO_COPY_SMALL        500
+#define tcptestZERO_COPY_PLAIN        100
+#define tcptestZERO_COPY_LARGE        1000
+#define tcptestZERO_COPY_TICKS        pdMS_TO_TICKS( 2000 )
+#define tcptestTCP_FLAG_SYN           0x02u
+#define tcptestTCP_FLAG_ACK           0x10u
+
+/* The receive buffer of the peek test, and the amounts of data that make the
+ * data wrap around its end. */
+#define tcptestPEEK_BUFFER_SIZE       256
+#define tcptestPEEK_FIRST             200
+#define tcptestPEEK_CONSUMED          150
+
+/* The buffer allocation scheme linked with the tests. */
+#ifndef testrunnerFREERTOS_TCP_BUFFER_ALLOCATION
+    #define testrunnerFREERTOS_TCP_BUFFER_ALLOCATION    2
+#endif
+
 /*
  * @brief Test group definition.
  */
@@ -68,6 +155,38 @@ TEST_GROUP_RUNNER( Full_FREERTOS_TCP )
 
     /* xProcessReceivedUDPPacket test. */
     RUN_TEST_CASE( Full_FREERTOS_TCP, UDPPacketLength );
+
+    /* pxTCPSocketLookup() correctness and cost per number of sockets. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, pxTCPSocketLookup );
+
+    /* Goodput of a TCP window over a path with injected losses. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, TCPWindowCongestionControl );
+
+    /* Loss detection by the SACK scoreboard. */
+    #if ( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPWindowSackScoreboard );
+    #endif
+
+    /* The implementations of usGenerateChecksum(), correctness and speed. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, usGenerateChecksum );
+
+    /* The size classes of BufferAllocation_3.c. */
+    #if ( testrunnerFREERTOS_TCP_BUFFER_ALLOCATION == 3 )
+        RUN_TEST_CASE( Full_FREERTOS_TCP, NetworkBufferClasses );
+    #endif
+
+    /* Payload buffers for FreeRTOS_send() with FREERTOS_ZERO_COPY. */
+    #if ( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPZeroCopySend );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPZeroCopySendConnected );
+    #endif
+
+    /* FreeRTOS_recv_peek() and FreeRTOS_recv_consume(). */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, TCPRecvPeek );
+
+    #if ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 )
+        RUN_TEST_CASE( Full_FREERTOS_TCP, SocketIDWakeCallback );
+    #endif
 }
 
 TEST( Full_FREERTOS_TCP, prvParseDnsResponse )
@@ -360,3 +479,1135 @@ TEST( Full_FREERTOS_TCP, UDPPacketLength )
     xReturn = xProcessReceivedUDPPacket( &xNetworkBuffer, usPort );
     TEST_ASSERT_EQUAL_UINT32( pdFAIL, xReturn );
 }
+
+/*-----------------------------------------------------------*/
+
+/* Give a socket the remote address of the connection with index xIndex and
+ * bind it to tcptestLOOKUP_CHILD_PORT, as the IP-task does for the child
+ * sockets of a listening socket.  The state CLOSE_WAIT keeps the IP-task from
+ * doing anything with the socket. */
+static BaseType_t prvBindLookupSocket( FreeRTOS_Socket_t * pxSocket,
+                                       BaseType_t xIndex )
+{
+    struct freertos_sockaddr xAddress;
+    BaseType_t xResult;
+
+    xAddress.sin_port = FreeRTOS_htons( tcptestLOOKUP_CHILD_PORT );
+    xAddress.sin_addr = 0;
+
+    vTaskSuspendAll();
+    {
+        xResult = vSocketBind( pxSocket, &xAddress, sizeof( xAddress ), pdTRUE );
+        pxSocket->u.xTCP.ulRemoteIP = 0x0A000001UL + ( uint32_t ) ( xIndex >> 2 );
+        pxSocket->u.xTCP.usRemotePort = ( uint16_t ) ( 40000 + xIndex );
+        pxSocket->u.xTCP.ucTCPState = ( uint8_t ) eCLOSE_WAIT;
+        #if ( ipconfigUSE_TCP_SOCKET_HASH != 0 )
+            vSocketUpdateTCPHash( pxSocket );
+        #endif
+    }
+    ( void ) xTaskResumeAll();
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_TCP, pxTCPSocketLookup )
+{
+    static FreeRTOS_Socket_t * pxSockets[ tcptestLOOKUP_MAX_SOCKETS ];
+    FreeRTOS_Socket_t * pxListenSocket;
+    FreeRTOS_Socket_t * pxFound;
+    struct freertos_sockaddr xAddress;
+    BaseType_t xCount = 0;
+    BaseType_t xStep;
+    BaseType_t xIndex;
+    uint32_t ulLookups;
+    TickType_t xStart;
+
+    /* A listening socket on another port catches tuples that are unknown. */
+    pxListenSocket = ( FreeRTOS_Socket_t * ) FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+    TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, pxListenSocket );
+    xAddress.sin_port = FreeRTOS_htons( tcptestLOOKUP_LISTEN_PORT );
+    xAddress.sin_addr = 0;
+    TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( pxListenSocket, &xAddress, sizeof( xAddress ) ) );
+    TEST_ASSERT_EQUAL( 0, FreeRTOS_listen( pxListenSocket, 4 ) );
+
+    for( xStep = 1; xStep <= tcptestLOOKUP_MAX_SOCKETS; xStep *= 2 )
+    {
+        while( xCount < xStep )
+        {
+            pxSockets[ xCount ] = ( FreeRTOS_Socket_t * ) FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+            TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, pxSockets[ xCount ] );
+            TEST_ASSERT_EQUAL( 0, prvBindLookupSocket( pxSockets[ xCount ], xCount ) );
+            xCount++;
+        }
+
+        /* Every connected socket must be found by its own tuple. */
+        for( xIndex = 0; xIndex < xCount; xIndex++ )
+        {
+            pxFound = pxTCPSocketLookup( 0, tcptestLOOKUP_CHILD_PORT,
+                                         pxSockets[ xIndex ]->u.xTCP.ulRemoteIP,
+                                         pxSockets[ xIndex ]->u.xTCP.usRemotePort );
+            TEST_ASSERT_EQUAL_PTR( pxSockets[ xIndex ], pxFound );
+        }
+
+        pxFound = pxTCPSocketLookup( 0, tcptestLOOKUP_LISTEN_PORT, 0x0B000001UL, 1234 );
+        TEST_ASSERT_EQUAL_PTR( pxListenSocket, pxFound );
+        pxFound = pxTCPSocketLookup( 0, tcptestLOOKUP_CHILD_PORT, 0x0B000001UL, 1234 );
+        TEST_ASSERT_NULL( pxFound );
+
+        /* Count the lookups done within a fixed number of ticks. */
+        ulLookups = 0;
+        xIndex = 0;
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < tcptestLOOKUP_TICKS )
+        {
+            pxFound = pxTCPSocketLookup( 0, tcptestLOOKUP_CHILD_PORT,
+                                         pxSockets[ xIndex ]->u.xTCP.ulRemoteIP,
+                                         pxSockets[ xIndex ]->u.xTCP.usRemotePort );
+            configASSERT( pxFound == pxSockets[ xIndex ] );
+
+            if( ++xIndex == xCount )
+            {
+                xIndex = 0;
+            }
+
+            ulLookups++;
+        }
+
+        configPRINTF( ( "pxTCPSocketLookup: %3d sockets: %u ns per lookup\r\n",
+                        ( int ) xCount,
+                        ( unsigned ) ( ( ( uint64_t ) tcptestLOOKUP_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulLookups ) ) );
+    }
+
+    for( xIndex = 0; xIndex < xCount; xIndex++ )
+    {
+        FreeRTOS_closesocket( pxSockets[ xIndex ] );
+    }
+
+    FreeRTOS_closesocket( pxListenSocket );
+}
+
+/*-----------------------------------------------------------*/
+
+/* A segment or an ACK on the simulated path. */
+typedef struct xCC_PACKET
+{
+    TickType_t xArrival;
+    uint32_t ulSequenceNumber; /* Data: first byte.  ACK: the ACK number. */
+    uint32_t ulLength;         /* Data: length.  ACK: 0. */
+    uint32_t ulSackFirst;      /* ACK: a SACK block, if ulSackLast != 0. */
+    uint32_t ulSackLast;
+} CCPacket_t;
+
+typedef struct xCC_FIFO
+{
+    CCPacket_t * pxPackets;
+    UBaseType_t uxSize;
+    UBaseType_t uxHead;
+    UBaseType_t uxCount;
+} CCFifo_t;
+
+static BaseType_t prvCCPush( CCFifo_t * pxFifo,
+                             const CCPacket_t * pxPacket )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( pxFifo->uxCount < pxFifo->uxSize )
+    {
+        pxFifo->pxPackets[ ( pxFifo->uxHead + pxFifo->uxCount ) % pxFifo->uxSize ] = *pxPacket;
+        pxFifo->uxCount++;
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+static CCPacket_t * prvCCPeek( CCFifo_t * pxFifo,
+                               TickType_t xNow )
+{
+    CCPacket_t * pxReturn = NULL;
+
+    if( ( pxFifo->uxCount != 0 ) && ( ( xNow - pxFifo->pxPackets[ pxFifo->uxHead ].xArrival ) < ( portMAX_DELAY >> 1 ) ) )
+    {
+        pxReturn = &( pxFifo->pxPackets[ pxFifo->uxHead ] );
+    }
+
+    return pxReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCCPop( CCFifo_t * pxFifo )
+{
+    pxFifo->uxHead = ( pxFifo->uxHead + 1 ) % pxFifo->uxSize;
+    pxFifo->uxCount--;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Run a bulk transfer for tcptestCC_RUN_TICKS, losing ulLossPermille out of
+ * every 1000 segments on the path.  Returns the number of bytes that were
+ * delivered in order to the receiver. */
+static uint32_t prvCCTransfer( uint32_t ulLossPermille,
+                               uint32_t * pulSegmentsSent )
+{
+    static TCPWindow_t xSender, xReceiver;
+    static CCPacket_t xQueuePackets[ tcptestCC_QUEUE_LENGTH ];
+    static CCPacket_t xWirePackets[ tcptestCC_WIRE_LENGTH ];
+    static CCPacket_t xAckPackets[ tcptestCC_WIRE_LENGTH ];
+    CCFifo_t xQueue = { xQueuePackets, tcptestCC_QUEUE_LENGTH, 0, 0 };
+    CCFifo_t xWire = { xWirePackets, tcptestCC_WIRE_LENGTH, 0, 0 };
+    CCFifo_t xAcks = { xAckPackets, tcptestCC_WIRE_LENGTH, 0, 0 };
+    const uint32_t ulISS = 0xFFFF0000UL; /* Let the sequence numbers wrap. */
+    uint32_t ulSeed = 0x12345678UL;
+    uint32_t ulDelivered = 0, ulStreamUsed = 0, ulSent = 0, ulForwarded = 0, ulLength, ulCount;
+    int32_t lHead = 0, lPosition, lAdded;
+    CCPacket_t xPacket, * pxPacket;
+    TickType_t xNow, xStart;
+    BaseType_t xIndex;
+
+    memset( &xSender, 0, sizeof( xSender ) );
+    memset( &xReceiver, 0, sizeof( xReceiver ) );
+    memset( &xPacket, 0, sizeof( xPacket ) );
+
+    vTaskSuspendAll();
+    {
+        vTCPWindowCreate( &xSender, tcptestCC_BUFFER_LENGTH, tcptestCC_BUFFER_LENGTH, 1UL, ulISS, tcptestCC_MSS );
+        vTCPWindowCreate( &xReceiver, tcptestCC_BUFFER_LENGTH, tcptestCC_BUFFER_LENGTH, ulISS, 1UL, tcptestCC_MSS );
+    }
+    ( void ) xTaskResumeAll();
+
+    xStart = xTaskGetTickCount();
+
+    do
+    {
+        /* The segment pool is shared with the IP-task. */
+        vTaskSuspendAll();
+        xNow = xTaskGetTickCount();
+
+        /* ACK's that arrive at the sender, the SACK option first as
+         * prvCheckOptions() does. */
+        while( ( pxPacket = prvCCPeek( &xAcks, xNow ) ) != NULL )
+        {
+            ulCount = 0;
+
+            if( pxPacket->ulSackLast != 0 )
+            {
+                ulCount += ulTCPWindowTxSack( &xSender, pxPacket->ulSackFirst, pxPacket->ulSackLast );
+            }
+
+            ulCount += ulTCPWindowTxAck( &xSender, pxPacket->ulSequenceNumber );
+            ulStreamUsed -= ulCount;
+            prvCCPop( &xAcks );
+        }
+
+        /* The bottleneck forwards at most tcptestCC_LINK_RATE segments. */
+        for( xIndex = 0; ( xIndex < tcptestCC_LINK_RATE ) && ( xQueue.uxCount != 0 ); xIndex++ )
+        {
+            xPacket = xQueue.pxPackets[ xQueue.uxHead ];
+            prvCCPop( &xQueue );
+            ulSeed = ( ulSeed * 1664525UL ) + 1013904223UL;
+
+            if( ( ++ulForwarded <= tcptestCC_WARM_UP_SEGMENTS ) || ( ( ( ulSeed >> 16 ) % 1000UL ) >= ulLossPermille ) )
+            {
+                xPacket.xArrival = xNow + tcptestCC_DELAY_TICKS;
+                ( void ) prvCCPush( &xWire, &xPacket );
+            }
+        }
+
+        /* Segments that arrive at the receiver, each one is ACK'd. */
+        while( ( pxPacket = prvCCPeek( &xWire, xNow ) ) != NULL )
+        {
+            if( lTCPWindowRxCheck( &xReceiver, pxPacket->ulSequenceNumber, pxPacket->ulLength, tcptestCC_BUFFER_LENGTH ) == 0 )
+            {
+                ulDelivered += pxPacket->ulLength + xReceiver.ulUserDataLength;
+            }
+
+            xPacket.xArrival = xNow + tcptestCC_DELAY_TICKS;
+            xPacket.ulSequenceNumber = xReceiver.rx.ulCurrentSequenceNumber;
+            xPacket.ulLength = 0;
+            xPacket.ulSackFirst = 0;
+            xPacket.ulSackLast = 0;
+
+            if( xReceiver.ucOptionLength != 0 )
+            {
+                xPacket.ulSackFirst = FreeRTOS_ntohl( xReceiver.ulOptionsData[ 1 ] );
+                xPacket.ulSackLast = FreeRTOS_ntohl( xReceiver.ulOptionsData[ 2 ] );
+            }
+
+            ( void ) prvCCPush( &xAcks, &xPacket );
+            prvCCPop( &xWire );
+        }
+
+        /* The sender keeps its stream full, and sends what the windows
+         * allow.  A full bottleneck queue drops the segment. */
+        lAdded = lTCPWindowTxAdd( &xSender, tcptestCC_BUFFER_LENGTH - ulStreamUsed, lHead, tcptestCC_BUFFER_LENGTH );
+        ulStreamUsed += ( uint32_t ) lAdded;
+        lHead = ( lHead + lAdded ) % tcptestCC_BUFFER_LENGTH;
+
+        for( xIndex = 0; xIndex < tcptestCC_WINDOW_SEGMENTS; xIndex++ )
+        {
+            ulLength = ulTCPWindowTxGet( &xSender, tcptestCC_BUFFER_LENGTH, &lPosition );
+
+            if( ulLength == 0 )
+            {
+                break;
+            }
+
+            xPacket.ulSequenceNumber = xSender.ulOurSequenceNumber;
+            xPacket.ulLength = ulLength;
+            ( void ) prvCCPush( &xQueue, &xPacket );
+            ulSent++;
+        }
+
+        ( void ) xTaskResumeAll();
+        vTaskDelay( 1 );
+    } while( ( xTaskGetTickCount() - xStart ) < tcptestCC_RUN_TICKS );
+
+    #if ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+        TEST_ASSERT_TRUE( xSender.ulCongestionWindow >= tcptestCC_MSS );
+    #endif
+
+    vTaskSuspendAll();
+    {
+        vTCPWindowDestroy( &xSender );
+        vTCPWindowDestroy( &xReceiver );
+    }
+    ( void ) xTaskResumeAll();
+
+    *pulSegmentsSent = ulSent;
+
+    return ulDelivered;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_TCP, TCPWindowCongestionControl )
+{
+    static const uint32_t ulLossRates[] = { 0, 5, 10, 30 }; /* Per 1000 segments. */
+    const char * pcAlgorithm[] = { "none", "NewReno", "CUBIC" };
+    uint32_t ulDelivered, ulSent, ulCapacity;
+    BaseType_t xIndex;
+
+    /* The number of bytes that the bottleneck could carry during the run. */
+    ulCapacity = ( uint32_t ) tcptestCC_RUN_TICKS * tcptestCC_LINK_RATE * tcptestCC_MSS;
+
+    for( xIndex = 0; xIndex < ( BaseType_t ) ( sizeof( ulLossRates ) / sizeof( ulLossRates[ 0 ] ) ); xIndex++ )
+    {
+        ulDelivered = prvCCTransfer( ulLossRates[ xIndex ], &ulSent );
+
+        configPRINTF( ( "TCP congestion control %s: loss %2u.%u%%: goodput %5u KB/s (%3u%% of the link), %5u segments sent\r\n",
+                        pcAlgorithm[ ipconfigTCP_CONGESTION_CONTROL ],
+                        ( unsigned ) ( ulLossRates[ xIndex ] / 10 ),
+                        ( unsigned ) ( ulLossRates[ xIndex ] % 10 ),
+                        ( unsigned ) ( ( ( uint64_t ) ulDelivered * configTICK_RATE_HZ ) / ( ( uint64_t ) tcptestCC_RUN_TICKS * 1024ULL ) ),
+                        ( unsigned ) ( ( ( uint64_t ) ulDelivered * 100ULL ) / ulCapacity ),
+                        ( unsigned ) ulSent ) );
+
+        /* Every run must make progress.  With congestion control, the
+         * loss-free run must use at least half of the link. */
+        TEST_ASSERT_TRUE( ulDelivered > 0 );
+
+        #if ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+            if( ulLossRates[ xIndex ] == 0 )
+            {
+                TEST_ASSERT_TRUE( ulDelivered >= ( ulCapacity / 2 ) );
+            }
+        #endif
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_TCP_SACK_SCOREBOARD != 0 )
+
+/* Pass a segment to the receiving window, and its ACK, with the SACK option
+ * if any, back to the sender. */
+    static void prvSackDeliver( TCPWindow_t * pxSender,
+                                TCPWindow_t * pxReceiver,
+                                uint32_t ulSequenceNumber )
+    {
+        ( void ) lTCPWindowRxCheck( pxReceiver, ulSequenceNumber, tcptestCC_MSS, tcptestCC_BUFFER_LENGTH );
+
+        if( pxReceiver->ucOptionLength != 0 )
+        {
+            ( void ) ulTCPWindowTxSack( pxSender,
+                                        FreeRTOS_ntohl( pxReceiver->ulOptionsData[ 1 ] ),
+                                        FreeRTOS_ntohl( pxReceiver->ulOptionsData[ 2 ] ) );
+        }
+
+        ( void ) ulTCPWindowTxAck( pxSender, pxReceiver->rx.ulCurrentSequenceNumber );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_TCP, TCPWindowSackScoreboard )
+    {
+        static TCPWindow_t xSender, xReceiver;
+        static const BaseType_t xLost[] = { 5, 9, 14 };
+        const uint32_t ulISS = 0x1000UL;
+        uint32_t ulSequence[ tcptestSACK_SEGMENTS ];
+        uint32_t ulSentLength[ tcptestSACK_SEGMENTS ];
+        uint32_t ulHoleLength[ 3 ], ulHoleSequence[ 3 ];
+        uint32_t ulOvertakenLength, ulAfterHolesLength, ulFinalSequence;
+        int32_t lPosition;
+        BaseType_t xIndex, xHole;
+
+        #if ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+            uint32_t ulFastRecovery;
+        #endif
+
+        memset( &xSender, 0, sizeof( xSender ) );
+        memset( &xReceiver, 0, sizeof( xReceiver ) );
+
+        /* The windows share the segment pool with the IP-task.  While the
+         * scheduler is suspended, the clock stands still and no segment will
+         * be retransmitted because of a time-out. */
+        vTaskSuspendAll();
+
+        /* A failed check must not leave the scheduler suspended, so the
+         * results are only recorded here, and checked once it is resumed. */
+        vTCPWindowCreate( &xSender, tcptestCC_BUFFER_LENGTH, tcptestCC_BUFFER_LENGTH, 1UL, ulISS, tcptestCC_MSS );
+        vTCPWindowCreate( &xReceiver, tcptestCC_BUFFER_LENGTH, tcptestCC_BUFFER_LENGTH, ulISS, 1UL, tcptestCC_MSS );
+
+        #if ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+            /* Send all segments at once. */
+            xSender.ulCongestionWindow = tcptestCC_BUFFER_LENGTH;
+        #endif
+
+        ( void ) lTCPWindowTxAdd( &xSender, tcptestSACK_SEGMENTS * tcptestCC_MSS, 0, tcptestCC_BUFFER_LENGTH );
+
+        for( xIndex = 0; xIndex < tcptestSACK_SEGMENTS; xIndex++ )
+        {
+            ulSentLength[ xIndex ] = ulTCPWindowTxGet( &xSender, tcptestCC_BUFFER_LENGTH, &lPosition );
+            ulSequence[ xIndex ] = xSender.ulOurSequenceNumber;
+        }
+
+        /* Segment 0 is overtaken by segments 1 and 2.  A receiver that sends
+         * several SACK blocks per ACK repeats the same ranges: that is no
+         * new evidence, segment 0 is not lost. */
+        ( void ) ulTCPWindowTxSack( &xSender, ulSequence[ 1 ], ulSequence[ 2 ] );
+        ( void ) ulTCPWindowTxSack( &xSender, ulSequence[ 1 ], ulSequence[ 3 ] );
+        ( void ) ulTCPWindowTxSack( &xSender, ulSequence[ 1 ], ulSequence[ 3 ] );
+        ( void ) ulTCPWindowTxSack( &xSender, ulSequence[ 1 ], ulSequence[ 3 ] );
+        ulOvertakenLength = ulTCPWindowTxGet( &xSender, tcptestCC_BUFFER_LENGTH, &lPosition );
+
+        for( xIndex = 0; xIndex < 3; xIndex++ )
+        {
+            prvSackDeliver( &xSender, &xReceiver, ulSequence[ xIndex ] );
+        }
+
+        /* Three segments are lost.  The SACK's for the segments that follow
+         * them must reveal all three holes, before any time-out. */
+        for( xIndex = 3, xHole = 0; xIndex < tcptestSACK_SEGMENTS; xIndex++ )
+        {
+            if( ( xHole < 3 ) && ( xIndex == xLost[ xHole ] ) )
+            {
+                xHole++;
+            }
+            else
+            {
+                prvSackDeliver( &xSender, &xReceiver, ulSequence[ xIndex ] );
+            }
+        }
+
+        for( xHole = 0; xHole < 3; xHole++ )
+        {
+            ulHoleLength[ xHole ] = ulTCPWindowTxGet( &xSender, tcptestCC_BUFFER_LENGTH, &lPosition );
+            ulHoleSequence[ xHole ] = xSender.ulOurSequenceNumber;
+        }
+
+        ulAfterHolesLength = ulTCPWindowTxGet( &xSender, tcptestCC_BUFFER_LENGTH, &lPosition );
+
+        /* The retransmissions complete the transfer and end the recovery. */
+        for( xHole = 0; xHole < 3; xHole++ )
+        {
+            prvSackDeliver( &xSender, &xReceiver, ulSequence[ xLost[ xHole ] ] );
+        }
+
+        ulFinalSequence = xSender.tx.ulCurrentSequenceNumber;
+        #if ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+            ulFastRecovery = xSender.u.bits.bFastRecovery;
+        #endif
+
+        vTCPWindowDestroy( &xSender );
+        vTCPWindowDestroy( &xReceiver );
+
+        ( void ) xTaskResumeAll();
+
+        for( xIndex = 0; xIndex < tcptestSACK_SEGMENTS; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( tcptestCC_MSS, ulSentLength[ xIndex ] );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( 0, ulOvertakenLength );
+
+        for( xHole = 0; xHole < 3; xHole++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( tcptestCC_MSS, ulHoleLength[ xHole ] );
+            TEST_ASSERT_EQUAL_UINT32( ulSequence[ xLost[ xHole ] ], ulHoleSequence[ xHole ] );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( 0, ulAfterHolesLength );
+        TEST_ASSERT_EQUAL_UINT32( ulISS + ( tcptestSACK_SEGMENTS * tcptestCC_MSS ), ulFinalSequence );
+        #if ( ipconfigTCP_CONGESTION_CONTROL != ipTCP_CONGESTION_NONE )
+            TEST_ASSERT_EQUAL_UINT32( pdFALSE_UNSIGNED, ulFastRecovery );
+        #endif
+    }
+
+#endif /* ipconfigUSE_TCP_SACK_SCOREBOARD != 0 */
+
+/*-----------------------------------------------------------*/
+
+typedef struct xCHECKSUM_FUNCTION
+{
+    const char * pcName;
+    uint16_t ( * pxFunction )( uint32_t ulSum,
+                               const uint8_t * pucNextData,
+                               size_t uxDataLengthBytes );
+} ChecksumFunction_t;
+
+/* Byte by byte, the way RFC 1071 describes it, in host order. */
+static uint16_t prvChecksumReference( uint32_t ulSum,
+                                      const uint8_t * pucNextData,
+                                      size_t uxDataLengthBytes )
+{
+    size_t uxIndex;
+
+    for( uxIndex = 0; uxIndex + 1 < uxDataLengthBytes; uxIndex += 2 )
+    {
+        ulSum += ( ( uint32_t ) pucNextData[ uxIndex ] << 8 ) | pucNextData[ uxIndex + 1 ];
+    }
+
+    if( uxIndex < uxDataLengthBytes )
+    {
+        ulSum += ( uint32_t ) pucNextData[ uxIndex ] << 8;
+    }
+
+    while( ( ulSum >> 16 ) != 0 )
+    {
+        ulSum = ( ulSum & 0xffffUL ) + ( ulSum >> 16 );
+    }
+
+    return ( uint16_t ) ulSum;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_TCP, usGenerateChecksum )
+{
+    static const size_t xLengths[] = { 64, 128, 256, 512, 1024, 1500 };
+    static const ChecksumFunction_t xFunctions[] =
+    {
+        { "Word32", usGenerateChecksumWord32 },
+        #if ( tcptestCHECKSUM_X86 != 0 )
+            { "Word64", usGenerateChecksumWord64 },
+            { "SSE2",   usGenerateChecksumSSE2   },
+            { "AVX2",   usGenerateChecksumAVX2   },
+        #endif
+    };
+    static uint8_t ucBuffer[ tcptestCHECKSUM_BUFFER_SIZE ] __attribute__( ( aligned( 8 ) ) );
+    const BaseType_t xFunctionCount = ( BaseType_t ) ( sizeof( xFunctions ) / sizeof( xFunctions[ 0 ] ) );
+    volatile uint16_t usSink = 0;
+    uint32_t ulSeed = 0x12345678UL;
+    uint32_t ulSum, ulCalls;
+    size_t uxLength, uxOffset, uxIndex;
+    BaseType_t xFunction;
+    TickType_t xStart;
+
+    for( uxIndex = 0; uxIndex < sizeof( ucBuffer ); uxIndex++ )
+    {
+        ulSeed = ( ulSeed * 1664525UL ) + 1013904223UL;
+        ucBuffer[ uxIndex ] = ( uint8_t ) ( ulSeed >> 24 );
+    }
+
+    /* Every length up to 1500 at every alignment, with an initial sum.  The
+     * initial sum is byte swapped by usGenerateChecksumWord32() when the data
+     * starts at an odd address, so it is only given at even addresses there. */
+    for( xFunction = 0; xFunction < xFunctionCount; xFunction++ )
+    {
+        #if ( tcptestCHECKSUM_X86 != 0 )
+            if( ( xFunctions[ xFunction ].pxFunction == usGenerateChecksumAVX2 ) && ( __builtin_cpu_supports( "avx2" ) == 0 ) )
+            {
+                continue;
+            }
+        #endif
+
+        for( uxLength = 0; uxLength <= 1500; uxLength++ )
+        {
+            for( uxOffset = 0; uxOffset < 8; uxOffset++ )
+            {
+                ulSeed = ( ulSeed * 1664525UL ) + 1013904223UL;
+                ulSum = ulSeed >> 16;
+
+                if( ( ( uxOffset & 1 ) != 0 ) && ( xFunctions[ xFunction ].pxFunction == usGenerateChecksumWord32 ) )
+                {
+                    ulSum = 0;
+                }
+
+                TEST_ASSERT_EQUAL_HEX16( prvChecksumReference( ulSum, ucBuffer + uxOffset, uxLength ),
+                                         xFunctions[ xFunction ].pxFunction( ulSum, ucBuffer + uxOffset, uxLength ) );
+            }
+        }
+    }
+
+    /* The time per call for typical payload lengths, on 32-bit aligned
+     * data, like the TCP payload of a network buffer. */
+    for( uxIndex = 0; uxIndex < sizeof( xLengths ) / sizeof( xLengths[ 0 ] ); uxIndex++ )
+    {
+        for( xFunction = 0; xFunction < xFunctionCount; xFunction++ )
+        {
+            #if ( tcptestCHECKSUM_X86 != 0 )
+                if( ( xFunctions[ xFunction ].pxFunction == usGenerateChecksumAVX2 ) && ( __builtin_cpu_supports( "avx2" ) == 0 ) )
+                {
+                    continue;
+                }
+            #endif
+
+            ulCalls = 0;
+            xStart = xTaskGetTickCount();
+
+            while( ( xTaskGetTickCount() - xStart ) < tcptestCHECKSUM_TICKS )
+            {
+                usSink += xFunctions[ xFunction ].pxFunction( 0UL, ucBuffer, xLengths[ uxIndex ] );
+                ulCalls++;
+            }
+
+            configPRINTF( ( "usGenerateChecksum: %4u bytes: %-6s %5u ns per call, %5u MB/s\r\n",
+                            ( unsigned ) xLengths[ uxIndex ],
+                            xFunctions[ xFunction ].pcName,
+                            ( unsigned ) ( ( ( uint64_t ) tcptestCHECKSUM_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulCalls ),
+                            ( unsigned ) ( ( ( uint64_t ) ulCalls * xLengths[ uxIndex ] * 1000ULL ) / ( ( uint64_t ) tcptestCHECKSUM_TICKS * portTICK_PERIOD_MS * 1000000ULL ) ) ) );
+        }
+    }
+
+    ( void ) usSink;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( testrunnerFREERTOS_TCP_BUFFER_ALLOCATION == 3 )
+
+/* Time a pair of pxGetNetworkBufferWithDescriptor() and
+ * vReleaseNetworkBufferAndDescriptor() calls, or with 'xBaseline', a pair of
+ * calls that lock a pool with a semaphore and take the buffer from the heap. */
+    static uint32_t prvTimeBufferPair( size_t uxSize,
+                                       BaseType_t xBaseline )
+    {
+        static SemaphoreHandle_t xSemaphore = NULL;
+        NetworkBufferDescriptor_t * pxBuffer;
+        void * pvBuffer;
+        uint32_t ulCalls = 0;
+        TickType_t xStart;
+
+        if( xSemaphore == NULL )
+        {
+            xSemaphore = xSemaphoreCreateCounting( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS );
+            TEST_ASSERT_NOT_NULL( xSemaphore );
+        }
+
+        xStart = xTaskGetTickCount();
+
+        while( ( xTaskGetTickCount() - xStart ) < tcptestBUFFER_TICKS )
+        {
+            if( xBaseline != pdFALSE )
+            {
+                ( void ) xSemaphoreTake( xSemaphore, 0 );
+                taskENTER_CRITICAL();
+                pvBuffer = pvPortMalloc( uxSize + ipBUFFER_PADDING );
+                taskEXIT_CRITICAL();
+                TEST_ASSERT_NOT_NULL( pvBuffer );
+                taskENTER_CRITICAL();
+                vPortFree( pvBuffer );
+                taskEXIT_CRITICAL();
+                ( void ) xSemaphoreGive( xSemaphore );
+            }
+            else
+            {
+                pxBuffer = pxGetNetworkBufferWithDescriptor( uxSize, 0 );
+                TEST_ASSERT_NOT_NULL( pxBuffer );
+                vReleaseNetworkBufferAndDescriptor( pxBuffer );
+            }
+
+            ulCalls++;
+        }
+
+        return ( uint32_t ) ( ( ( uint64_t ) tcptestBUFFER_TICKS * portTICK_PERIOD_MS * 1000000ULL ) / ulCalls );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_TCP, NetworkBufferClasses )
+    {
+        static NetworkBufferDescriptor_t * pxBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+        NetworkBufferClassStats_t xBefore[ 3 ], xAfter[ 3 ];
+        NetworkBufferDescriptor_t * pxBuffer;
+        uint8_t * pucBuffer;
+        UBaseType_t uxClass, uxCount = 0, x;
+
+        for( uxClass = 0; uxClass < 3; uxClass++ )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, xGetNetworkBufferClassStats( uxClass, &( xBefore[ uxClass ] ) ) );
+        }
+
+        TEST_ASSERT_EQUAL( pdFALSE, xGetNetworkBufferClassStats( 3, &( xAfter[ 0 ] ) ) );
+        TEST_ASSERT_TRUE( xBefore[ 0 ].uxBufferSize < xBefore[ 1 ].uxBufferSize );
+        TEST_ASSERT_TRUE( xBefore[ 1 ].uxBufferSize < xBefore[ 2 ].uxBufferSize );
+
+        /* A driver must be able to receive a complete frame. */
+        pxBuffer = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, 0 );
+        TEST_ASSERT_NOT_NULL( pxBuffer );
+        vReleaseNetworkBufferAndDescriptor( pxBuffer );
+
+        /* A buffer that fits in the smallest class grows within its slot, and
+         * moves to a larger slot when it grows beyond it.  The descriptor can
+         * still be found from the buffer. */
+        pxBuffer = pxGetNetworkBufferWithDescriptor( tcptestBUFFER_SMALL, 0 );
+        TEST_ASSERT_NOT_NULL( pxBuffer );
+        TEST_ASSERT_EQUAL_PTR( pxBuffer, pxPacketBuffer_to_NetworkBuffer( pxBuffer->pucEthernetBuffer ) );
+        memset( pxBuffer->pucEthernetBuffer, 0xA5, tcptestBUFFER_SMALL );
+        pucBuffer = pxBuffer->pucEthernetBuffer;
+
+        TEST_ASSERT_EQUAL_PTR( pxBuffer, pxResizeNetworkBufferWithDescriptor( pxBuffer, xBefore[ 0 ].uxBufferSize ) );
+        TEST_ASSERT_EQUAL_PTR( pucBuffer, pxBuffer->pucEthernetBuffer );
+
+        pxBuffer->xDataLength = tcptestBUFFER_SMALL;
+        TEST_ASSERT_EQUAL_PTR( pxBuffer, pxResizeNetworkBufferWithDescriptor( pxBuffer, tcptestBUFFER_LARGE ) );
+        TEST_ASSERT_TRUE( pucBuffer != pxBuffer->pucEthernetBuffer );
+        TEST_ASSERT_EQUAL( tcptestBUFFER_LARGE, pxBuffer->xDataLength );
+        TEST_ASSERT_EQUAL_PTR( pxBuffer, pxPacketBuffer_to_NetworkBuffer( pxBuffer->pucEthernetBuffer ) );
+        TEST_ASSERT_EACH_EQUAL_HEX8( 0xA5, pxBuffer->pucEthernetBuffer, tcptestBUFFER_SMALL );
+        vReleaseNetworkBufferAndDescriptor( pxBuffer );
+
+        /* A second release of the same descriptor is ignored. */
+        x = uxGetNumberOfFreeNetworkBuffers();
+        vReleaseNetworkBufferAndDescriptor( pxBuffer );
+        TEST_ASSERT_EQUAL( x, uxGetNumberOfFreeNetworkBuffers() );
+
+        /* Exhaust the smallest class: the next small buffers spill into the
+         * larger classes, and the empty class is counted as a failure. */
+        for( x = 0; x <= xBefore[ 0 ].uxBufferCount; x++ )
+        {
+            pxBuffers[ uxCount ] = pxGetNetworkBufferWithDescriptor( tcptestBUFFER_SMALL, 0 );
+
+            if( pxBuffers[ uxCount ] == NULL )
+            {
+                break;
+            }
+
+            TEST_ASSERT_EQUAL_PTR( pxBuffers[ uxCount ], pxPacketBuffer_to_NetworkBuffer( pxBuffers[ uxCount ]->pucEthernetBuffer ) );
+            uxCount++;
+        }
+
+        TEST_ASSERT_EQUAL( pdTRUE, xGetNetworkBufferClassStats( 0, &( xAfter[ 0 ] ) ) );
+        TEST_ASSERT_EQUAL( xAfter[ 0 ].uxBufferCount, xAfter[ 0 ].uxInUse );
+        TEST_ASSERT_EQUAL( xAfter[ 0 ].uxBufferCount, xAfter[ 0 ].uxHighWaterMark );
+        TEST_ASSERT_TRUE( xAfter[ 0 ].ulFailures > xBefore[ 0 ].ulFailures );
+        TEST_ASSERT_TRUE( xAfter[ 0 ].ulAllocations >= xBefore[ 0 ].ulAllocations + uxCount - 1 );
+
+        while( uxCount > 0 )
+        {
+            uxCount--;
+            vReleaseNetworkBufferAndDescriptor( pxBuffers[ uxCount ] );
+        }
+
+        for( uxClass = 0; uxClass < 3; uxClass++ )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, xGetNetworkBufferClassStats( uxClass, &( xAfter[ uxClass ] ) ) );
+            TEST_ASSERT_TRUE( xAfter[ uxClass ].uxInUse <= xBefore[ uxClass ].uxInUse + 1 );
+            configPRINTF( ( "Network buffers: %4u bytes: %2u buffers, high water %2u, %5u allocations, %3u failures\r\n",
+                            ( unsigned ) xAfter[ uxClass ].uxBufferSize,
+                            ( unsigned ) xAfter[ uxClass ].uxBufferCount,
+                            ( unsigned ) xAfter[ uxClass ].uxHighWaterMark,
+                            ( unsigned ) xAfter[ uxClass ].ulAllocations,
+                            ( unsigned ) xAfter[ uxClass ].ulFailures ) );
+        }
+
+        configPRINTF( ( "Network buffers: get and release %4u bytes: %5u ns, semaphore and heap %5u ns\r\n",
+                        tcptestBUFFER_SMALL, ( unsigned ) prvTimeBufferPair( tcptestBUFFER_SMALL, pdFALSE ),
+                        ( unsigned ) prvTimeBufferPair( tcptestBUFFER_SMALL, pdTRUE ) ) );
+        configPRINTF( ( "Network buffers: get and release %4u bytes: %5u ns, semaphore and heap %5u ns\r\n",
+                        tcptestBUFFER_LARGE, ( unsigned ) prvTimeBufferPair( tcptestBUFFER_LARGE, pdFALSE ),
+                        ( unsigned ) prvTimeBufferPair( tcptestBUFFER_LARGE, pdTRUE ) ) );
+    }
+
+#endif /* testrunnerFREERTOS_TCP_BUFFER_ALLOCATION == 3 */
+
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigUSE_TCP_ZERO_COPY_TX != 0 )
+
+    TEST( Full_FREERTOS_TCP, TCPZeroCopySend )
+    {
+        Socket_t xSocket;
+        NetworkBufferDescriptor_t * pxBuffer;
+        uint8_t * pucPayload;
+        UBaseType_t uxFree;
+
+        /* The payload buffer leaves space for the headers of a TCP packet
+         * without options, and leads back to its network buffer. */
+        uxFree = uxGetNumberOfFreeNetworkBuffers();
+        pucPayload = ( uint8_t * ) FreeRTOS_GetTCPPayloadBuffer( tcptestZERO_COPY_SIZE, 0 );
+        TEST_ASSERT_NOT_NULL( pucPayload );
+        TEST_ASSERT_EQUAL( uxFree - 1, uxGetNumberOfFreeNetworkBuffers() );
+
+        pxBuffer = pxTCPPayloadBuffer_to_NetworkBuffer( pucPayload );
+        TEST_ASSERT_NOT_NULL( pxBuffer );
+        TEST_ASSERT_EQUAL_PTR( pxBuffer->pucEthernetBuffer + ipTCP_PAYLOAD_OFFSET, pucPayload );
+        TEST_ASSERT_EQUAL( ipTCP_PAYLOAD_OFFSET + tcptestZERO_COPY_SIZE, pxBuffer->xDataLength );
+        TEST_ASSERT_NULL( pxTCPPayloadBuffer_to_NetworkBuffer( NULL ) );
+
+        /* A socket that is not connected does not take the buffer, it still
+         * belongs to the caller. */
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        TEST_ASSERT_TRUE( xSocket != FREERTOS_INVALID_SOCKET );
+        memset( pucPayload, 0x5A, tcptestZERO_COPY_SIZE );
+        TEST_ASSERT_TRUE( FreeRTOS_send( xSocket, pucPayload, tcptestZERO_COPY_SIZE, FREERTOS_ZERO_COPY ) < 0 );
+        TEST_ASSERT_EQUAL( uxFree - 1, uxGetNumberOfFreeNetworkBuffers() );
+        TEST_ASSERT_EACH_EQUAL_HEX8( 0x5A, pucPayload, tcptestZERO_COPY_SIZE );
+        FreeRTOS_closesocket( xSocket );
+
+        FreeRTOS_ReleaseTCPPayloadBuffer( pucPayload );
+        TEST_ASSERT_EQUAL( uxFree, uxGetNumberOfFreeNetworkBuffers() );
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Pass a TCP packet without data from the simulated peer to the IP-task.  A
+ * SYN carries the MSS option of the peer. */
+    static void prvZeroCopyPeerSend( uint32_t ulPeerIP,
+                                     uint32_t ulAckNr,
+                                     uint8_t ucFlags )
+    {
+        static const uint8_t ucPeerMAC[ ipMAC_ADDRESS_LENGTH_BYTES ] = { 0x02, 0x00, 0x00, 0x00, 0x00, tcptestZERO_COPY_PEER_HOST };
+        NetworkBufferDescriptor_t * pxBuffer;
+        TCPPacket_t * pxPacket;
+        IPStackEvent_t xEvent;
+        size_t uxOptionsLength = 0;
+        size_t uxLength;
+
+        if( ( ucFlags & tcptestTCP_FLAG_SYN ) != 0 )
+        {
+            uxOptionsLength = 4;
+        }
+
+        uxLength = ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxOptionsLength;
+        pxBuffer = pxGetNetworkBufferWithDescriptor( ipSIZE_OF_ETH_HEADER + uxLength, tcptestZERO_COPY_TICKS );
+        TEST_ASSERT_NOT_NULL( pxBuffer );
+        memset( pxBuffer->pucEthernetBuffer, 0, pxBuffer->xDataLength );
+
+        pxPacket = ( TCPPacket_t * ) pxBuffer->pucEthernetBuffer;
+        memcpy( &( pxPacket->xEthernetHeader.xDestinationAddress ), ipLOCAL_MAC_ADDRESS, ipMAC_ADDRESS_LENGTH_BYTES );
+        memcpy( &( pxPacket->xEthernetHeader.xSourceAddress ), ucPeerMAC, ipMAC_ADDRESS_LENGTH_BYTES );
+        pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+
+        pxPacket->xIPHeader.ucVersionHeaderLength = 0x45u;
+        pxPacket->xIPHeader.usLength = FreeRTOS_htons( uxLength );
+        pxPacket->xIPHeader.ucTimeToLive = ipconfigTCP_TIME_TO_LIVE;
+        pxPacket->xIPHeader.ucProtocol = ipPROTOCOL_TCP;
+        pxPacket->xIPHeader.ulSourceIPAddress = ulPeerIP;
+        pxPacket->xIPHeader.ulDestinationIPAddress = *ipLOCAL_IP_ADDRESS_POINTER;
+        pxPacket->xIPHeader.usHeaderChecksum = usGenerateChecksum( 0UL, ( uint8_t * ) &( pxPacket->xIPHeader ), ipSIZE_OF_IPv4_HEADER );
+        pxPacket->xIPHeader.usHeaderChecksum = ~FreeRTOS_htons( pxPacket->xIPHeader.usHeaderChecksum );
+
+        /* The peer sends no data, so its sequence number stays one past its
+         * SYN. */
+        pxPacket->xTCPHeader.usSourcePort = FreeRTOS_htons( tcptestZERO_COPY_PEER_PORT );
+        pxPacket->xTCPHeader.usDestinationPort = FreeRTOS_htons( tcptestZERO_COPY_PORT );
+        pxPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( tcptestZERO_COPY_PEER_ISN + ( ( ( ucFlags & tcptestTCP_FLAG_SYN ) != 0 ) ? 0UL : 1UL ) );
+        pxPacket->xTCPHeader.ulAckNr = FreeRTOS_htonl( ulAckNr );
+        pxPacket->xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER + uxOptionsLength ) << 2 );
+        pxPacket->xTCPHeader.ucTCPFlags = ucFlags;
+        pxPacket->xTCPHeader.usWindow = FreeRTOS_htons( 0xFFFFU );
+
+        if( uxOptionsLength != 0 )
+        {
+            /* The MSS option: kind 2, length 4. */
+            pxPacket->xTCPHeader.ucOptdata[ 0 ] = 2;
+            pxPacket->xTCPHeader.ucOptdata[ 1 ] = 4;
+            pxPacket->xTCPHeader.ucOptdata[ 2 ] = ( uint8_t ) ( tcptestZERO_COPY_PEER_MSS >> 8 );
+            pxPacket->xTCPHeader.ucOptdata[ 3 ] = ( uint8_t ) ( tcptestZERO_COPY_PEER_MSS & 0xFF );
+        }
+
+        ( void ) usGenerateProtocolChecksum( pxBuffer->pucEthernetBuffer, pxBuffer->xDataLength, pdTRUE );
+
+        xEvent.eEventType = eNetworkRxEvent;
+        xEvent.pvData = ( void * ) pxBuffer;
+        TEST_ASSERT_EQUAL( pdPASS, xSendEventStructToIPTask( &xEvent, tcptestZERO_COPY_TICKS ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Wait until the IP-task has brought the socket in state eState. */
+    static BaseType_t prvZeroCopyWaitState( FreeRTOS_Socket_t * pxSocket,
+                                            eIPTCPState_t eState )
+    {
+        TickType_t xStart = xTaskGetTickCount();
+
+        while( pxSocket->u.xTCP.ucTCPState != ( uint8_t ) eState )
+        {
+            if( ( xTaskGetTickCount() - xStart ) > tcptestZERO_COPY_TICKS )
+            {
+                return pdFALSE;
+            }
+
+            vTaskDelay( 1 );
+        }
+
+        return pdTRUE;
+    }
+
+/*-----------------------------------------------------------*/
+
+/* Wait until the socket has sent all data up to sequence number ulSequence,
+ * then acknowledge it, and wait until no more than uxFragments payload buffers
+ * are left in the socket. */
+    static BaseType_t prvZeroCopyPeerAck( FreeRTOS_Socket_t * pxSocket,
+                                          uint32_t ulPeerIP,
+                                          uint32_t ulSequence,
+                                          UBaseType_t uxFragments )
+    {
+        TCPWindow_t * pxWindow = &( pxSocket->u.xTCP.xTCPWindow );
+        TickType_t xStart = xTaskGetTickCount();
+
+        while( ( int32_t ) ( pxWindow->tx.ulHighestSequenceNumber - ulSequence ) < 0 )
+        {
+            if( ( xTaskGetTickCount() - xStart ) > tcptestZERO_COPY_TICKS )
+            {
+                return pdFALSE;
+            }
+
+            vTaskDelay( 1 );
+        }
+
+        prvZeroCopyPeerSend( ulPeerIP, ulSequence, tcptestTCP_FLAG_ACK );
+
+        while( ( pxWindow->tx.ulCurrentSequenceNumber != ulSequence ) ||
+               ( listCURRENT_LIST_LENGTH( &( pxSocket->u.xTCP.xTxFragments ) ) > uxFragments ) )
+        {
+            if( ( xTaskGetTickCount() - xStart ) > tcptestZERO_COPY_TICKS )
+            {
+                return pdFALSE;
+            }
+
+            vTaskDelay( 1 );
+        }
+
+        return pdTRUE;
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_TCP, TCPZeroCopySendConnected )
+    {
+        Socket_t xSocket;
+        FreeRTOS_Socket_t * pxSocket;
+        struct freertos_sockaddr xAddress;
+        uint8_t ucPlain[ tcptestZERO_COPY_PLAIN ];
+        uint8_t * pucSmall;
+        uint8_t * pucLarge;
+        uint32_t ulPeerIP, ulLocalIP, ulNetMask, ulFirst;
+        UBaseType_t uxFree;
+        BaseType_t xReuse = pdTRUE;
+        TickType_t xStart;
+
+        FreeRTOS_GetAddressConfiguration( &ulLocalIP, &ulNetMask, NULL, NULL );
+        ulPeerIP = ( ulLocalIP & ulNetMask ) | ( FreeRTOS_htonl( tcptestZERO_COPY_PEER_HOST ) & ~ulNetMask );
+
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        TEST_ASSERT_TRUE( xSocket != FREERTOS_INVALID_SOCKET );
+        pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_REUSE_LISTEN_SOCKET, &xReuse, sizeof( xReuse ) ) );
+        xAddress.sin_port = FreeRTOS_htons( tcptestZERO_COPY_PORT );
+        xAddress.sin_addr = 0;
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xSocket, &xAddress, sizeof( xAddress ) ) );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_listen( xSocket, 1 ) );
+
+        /* Connect, the listening socket itself takes the connection. */
+        prvZeroCopyPeerSend( ulPeerIP, 0, tcptestTCP_FLAG_SYN );
+        TEST_ASSERT_TRUE( prvZeroCopyWaitState( pxSocket, eSYN_RECEIVED ) );
+        ulFirst = pxSocket->u.xTCP.xTCPWindow.tx.ulFirstSequenceNumber + 1UL;
+        prvZeroCopyPeerSend( ulPeerIP, ulFirst, tcptestTCP_FLAG_ACK );
+        TEST_ASSERT_TRUE( prvZeroCopyWaitState( pxSocket, eESTABLISHED ) );
+        TEST_ASSERT_EQUAL( tcptestZERO_COPY_PEER_MSS, pxSocket->u.xTCP.usCurMSS );
+
+        /* A buffer that fits in one segment, ordinary data, and a buffer that
+         * is larger than the MSS of the peer. */
+        uxFree = uxGetNumberOfFreeNetworkBuffers();
+        pucSmall = ( uint8_t * ) FreeRTOS_GetTCPPayloadBuffer( tcptestZERO_COPY_SMALL, 0 );
+        pucLarge = ( uint8_t * ) FreeRTOS_GetTCPPayloadBuffer( tcptestZERO_COPY_LARGE, 0 );
+        TEST_ASSERT_NOT_NULL( pucSmall );
+        TEST_ASSERT_NOT_NULL( pucLarge );
+        memset( pucSmall, 0xA5, tcptestZERO_COPY_SMALL );
+        memset( ucPlain, 0x3C, sizeof( ucPlain ) );
+        memset( pucLarge, 0x5A, tcptestZERO_COPY_LARGE );
+
+        TEST_ASSERT_EQUAL( tcptestZERO_COPY_SMALL, FreeRTOS_send( xSocket, pucSmall, tcptestZERO_COPY_SMALL, FREERTOS_ZERO_COPY ) );
+        TEST_ASSERT_EQUAL( tcptestZERO_COPY_PLAIN, FreeRTOS_send( xSocket, ucPlain, sizeof( ucPlain ), 0 ) );
+        TEST_ASSERT_EQUAL( tcptestZERO_COPY_LARGE, FreeRTOS_send( xSocket, pucLarge, tcptestZERO_COPY_LARGE, FREERTOS_ZERO_COPY ) );
+        TEST_ASSERT_EQUAL( 2, listCURRENT_LIST_LENGTH( &( pxSocket->u.xTCP.xTxFragments ) ) );
+
+        /* The small buffer is released as soon as its data is acknowledged. */
+        ulFirst += tcptestZERO_COPY_SMALL;
+        TEST_ASSERT_TRUE( prvZeroCopyPeerAck( pxSocket, ulPeerIP, ulFirst, 1 ) );
+        TEST_ASSERT_EQUAL( 1, listCURRENT_LIST_LENGTH( &( pxSocket->u.xTCP.xTxFragments ) ) );
+
+        /* The large buffer is kept while only its first segment has been
+         * acknowledged. */
+        ulFirst += tcptestZERO_COPY_PLAIN + tcptestZERO_COPY_PEER_MSS;
+        TEST_ASSERT_TRUE( prvZeroCopyPeerAck( pxSocket, ulPeerIP, ulFirst, 1 ) );
+        TEST_ASSERT_EQUAL( 1, listCURRENT_LIST_LENGTH( &( pxSocket->u.xTCP.xTxFragments ) ) );
+
+        ulFirst += tcptestZERO_COPY_LARGE - tcptestZERO_COPY_PEER_MSS;
+        TEST_ASSERT_TRUE( prvZeroCopyPeerAck( pxSocket, ulPeerIP, ulFirst, 0 ) );
+        TEST_ASSERT_EQUAL( 0, listCURRENT_LIST_LENGTH( &( pxSocket->u.xTCP.xTxFragments ) ) );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_outstanding( xSocket ) );
+
+        /* Both network buffers are free again before the socket is closed. */
+        xStart = xTaskGetTickCount();
+
+        while( ( uxGetNumberOfFreeNetworkBuffers() != uxFree ) &&
+               ( ( xTaskGetTickCount() - xStart ) <= tcptestZERO_COPY_TICKS ) )
+        {
+            vTaskDelay( 1 );
+        }
+
+        TEST_ASSERT_EQUAL( uxFree, uxGetNumberOfFreeNetworkBuffers() );
+        FreeRTOS_closesocket( xSocket );
+    }
+
+#endif /* ipconfigUSE_TCP_ZERO_COPY_TX != 0 */
+
+/*-----------------------------------------------------------*/
+
+/* The byte at position ulPosition of the data received in the peek test. */
+static uint8_t prvPeekByte( uint32_t ulPosition )
+{
+    return ( uint8_t ) ( ulPosition * 7u );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_FREERTOS_TCP, TCPRecvPeek )
+{
+    FreeRTOS_Socket_t * pxSocket;
+    struct freertos_iovec xSegments[ 2 ];
+    uint8_t ucData[ tcptestPEEK_FIRST ];
+    uint8_t ucCopy[ tcptestPEEK_FIRST ];
+    uint32_t ulValue = tcptestPEEK_BUFFER_SIZE;
+    TickType_t xNoWait = 0;
+    uint32_t ulIndex;
+    int32_t lAdded;
+
+    pxSocket = ( FreeRTOS_Socket_t * ) FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+    TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, pxSocket );
+    TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( pxSocket, 0, FREERTOS_SO_RCVBUF, &ulValue, sizeof( ulValue ) ) );
+    TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( pxSocket, 0, FREERTOS_SO_RCVTIMEO, &xNoWait, sizeof( xNoWait ) ) );
+    TEST_ASSERT_EQUAL( 0, prvBindLookupSocket( pxSocket, tcptestLOOKUP_MAX_SOCKETS ) );
+
+    /* Without data, the socket returns like FreeRTOS_recv(). */
+    TEST_ASSERT_EQUAL( -pdFREERTOS_ERRNO_ENOTCONN, FreeRTOS_recv_peek( pxSocket, xSegments, 0 ) );
+    TEST_ASSERT_NULL( xSegments[ 0 ].iov_base );
+    TEST_ASSERT_EQUAL( 0, xSegments[ 0 ].iov_len + xSegments[ 1 ].iov_len );
+
+    /* Data that does not wrap around is returned in one part. */
+    for( ulIndex = 0; ulIndex < tcptestPEEK_FIRST; ulIndex++ )
+    {
+        ucData[ ulIndex ] = prvPeekByte( ulIndex );
+    }
+
+    vTaskSuspendAll();
+    {
+        lAdded = lTCPAddRxdata( pxSocket, 0, ucData, tcptestPEEK_FIRST );
+    }
+    ( void ) xTaskResumeAll();
+    TEST_ASSERT_EQUAL( tcptestPEEK_FIRST, lAdded );
+
+    TEST_ASSERT_EQUAL( tcptestPEEK_FIRST, FreeRTOS_recv_peek( pxSocket, xSegments, 0 ) );
+    TEST_ASSERT_EQUAL( tcptestPEEK_FIRST, xSegments[ 0 ].iov_len );
+    TEST_ASSERT_EQUAL( 0, xSegments[ 1 ].iov_len );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( ucData, xSegments[ 0 ].iov_base, tcptestPEEK_FIRST );
+
+    /* Consume part of it, and add data that wraps around the end. */
+    TEST_ASSERT_EQUAL( tcptestPEEK_CONSUMED, FreeRTOS_recv_consume( pxSocket, tcptestPEEK_CONSUMED ) );
+
+    for( ulIndex = 0; ulIndex < tcptestPEEK_CONSUMED; ulIndex++ )
+    {
+        ucData[ ulIndex ] = prvPeekByte( tcptestPEEK_FIRST + ulIndex );
+    }
+
+    vTaskSuspendAll();
+    {
+        lAdded = lTCPAddRxdata( pxSocket, 0, ucData, tcptestPEEK_CONSUMED );
+    }
+    ( void ) xTaskResumeAll();
+    TEST_ASSERT_EQUAL( tcptestPEEK_CONSUMED, lAdded );
+
+    TEST_ASSERT_EQUAL( tcptestPEEK_FIRST, FreeRTOS_recv_peek( pxSocket, xSegments, 0 ) );
+    TEST_ASSERT_TRUE( xSegments[ 1 ].iov_len > 0 );
+    TEST_ASSERT_EQUAL( tcptestPEEK_FIRST, xSegments[ 0 ].iov_len + xSegments[ 1 ].iov_len );
+    memcpy( ucData, xSegments[ 0 ].iov_base, xSegments[ 0 ].iov_len );
+    memcpy( ucData + xSegments[ 0 ].iov_len, xSegments[ 1 ].iov_base, xSegments[ 1 ].iov_len );
+
+    for( ulIndex = 0; ulIndex < tcptestPEEK_FIRST; ulIndex++ )
+    {
+        TEST_ASSERT_EQUAL_HEX8( prvPeekByte( tcptestPEEK_CONSUMED + ulIndex ), ucData[ ulIndex ] );
+    }
+
+    /* The parts hold the same data as FreeRTOS_recv() would copy. */
+    TEST_ASSERT_EQUAL( tcptestPEEK_FIRST, FreeRTOS_recv( pxSocket, ucCopy, sizeof( ucCopy ), FREERTOS_MSG_PEEK ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( ucData, ucCopy, tcptestPEEK_FIRST );
+
+    /* No more than the available data can be consumed. */
+    TEST_ASSERT_EQUAL( tcptestPEEK_FIRST, FreeRTOS_recv_consume( pxSocket, 2 * tcptestPEEK_BUFFER_SIZE ) );
+    TEST_ASSERT_EQUAL( -pdFREERTOS_ERRNO_ENOTCONN, FreeRTOS_recv_peek( pxSocket, xSegments, 0 ) );
+
+    FreeRTOS_closesocket( pxSocket );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 )
+
+/* The ID of the last socket passed to prvRecordSocketID(). */
+    static void * pvWokenSocketID = NULL;
+
+/* A wakeup callback which finds its own context from the socket, like the
+ * one of the secure sockets port. */
+    static void prvRecordSocketID( Socket_t xSocket )
+    {
+        pvWokenSocketID = FreeRTOS_GetSocketID( xSocket );
+    }
+
+/*-----------------------------------------------------------*/
+
+    TEST( Full_FREERTOS_TCP, SocketIDWakeCallback )
+    {
+        Socket_t xSocket;
+        uint8_t ucContext;
+
+        TEST_ASSERT_EQUAL( -pdFREERTOS_ERRNO_EINVAL, FreeRTOS_SetSocketID( FREERTOS_INVALID_SOCKET, &ucContext ) );
+        TEST_ASSERT_NULL( FreeRTOS_GetSocketID( FREERTOS_INVALID_SOCKET ) );
+
+        /* A new socket has no ID. */
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        TEST_ASSERT_TRUE( xSocket != FREERTOS_INVALID_SOCKET );
+        TEST_ASSERT_NULL( FreeRTOS_GetSocketID( xSocket ) );
+
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_SetSocketID( xSocket, &ucContext ) );
+        TEST_ASSERT_EQUAL_PTR( &ucContext, FreeRTOS_GetSocketID( xSocket ) );
+
+        /* The wakeup callback gets the socket, and through it the ID. */
+        pvWokenSocketID = NULL;
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_WAKEUP_CALLBACK, ( void * ) prvRecordSocketID, sizeof( &prvRecordSocketID ) ) );
+        vSocketWakeUpUser( ( FreeRTOS_Socket_t * ) xSocket );
+        TEST_ASSERT_EQUAL_PTR( &ucContext, pvWokenSocketID );
+
+        FreeRTOS_closesocket( xSocket );
+    }
+
+#endif /* ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 */
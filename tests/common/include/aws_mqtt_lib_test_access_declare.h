@@ -50,6 +50,24 @@
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    MQTTBool_t Test_prvStoreSubscription( MQTTContext_t * pxMQTTContext,
+                                          const uint8_t * const pucTopic,
+                                          uint16_t usTopicLength,
+                                          void * pvPublishCallbackContext,
+                                          MQTTPublishCallback_t pxPublishCallback );
+
+    void Test_prvRemoveSubscription( MQTTContext_t * pxMQTTContext,
+                                     const uint8_t * const pucTopic,
+                                     uint16_t usTopicLength );
+
+    MQTTBool_t Test_prvInvokeSubscriptionCallbacks( MQTTContext_t * pxMQTTContext,
+                                                    const MQTTPublishData_t * pxPublishData,
+                                                    MQTTBool_t * pxSubscriptionCallbackInvoked );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
 void Test_prvResetMQTTContext( MQTTContext_t * pxMQTTContext );
 
 #endif /* _AWS_MQTT_LIB_TEST_ACCESS_DEFINE_H_ */
@@ -48,12 +48,66 @@
 
 #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
+    static MQTTBool_t prvTestMatchCallback( void * pvPublishCallbackContext,
+                                            const MQTTPublishData_t * const pxPublishData )
+    {
+        ( void ) pvPublishCallbackContext;
+        ( void ) pxPublishData;
+
+        return eMQTTFalse;
+    }
+
     MQTTBool_t Test_prvDoesTopicMatchTopicFilter( const uint8_t * const pucTopic,
                                                   uint16_t usTopicLength,
                                                   const uint8_t * const pucTopicFilter,
                                                   uint16_t usTopicFilterLength )
     {
-        return prvDoesTopicMatchTopicFilter( pucTopic, usTopicLength, pucTopicFilter, usTopicFilterLength );
+        /* Topics are matched by the subscription manager, so store the topic
+         * filter alone in a subscription manager and check whether its
+         * callback is invoked for the topic. */
+        static MQTTContext_t xMatchContext;
+        MQTTPublishData_t xPublishData;
+        MQTTBool_t xTopicMatchesTopicFilter = eMQTTFalse;
+
+        prvResetSubscriptionManager( &( xMatchContext.xSubscriptionManager ) );
+
+        if( prvStoreSubscription( &( xMatchContext ), pucTopicFilter, usTopicFilterLength, NULL, prvTestMatchCallback ) == eMQTTTrue )
+        {
+            memset( &( xPublishData ), 0x00, sizeof( xPublishData ) );
+            xPublishData.pucTopic = pucTopic;
+            xPublishData.usTopicLength = usTopicLength;
+            ( void ) prvInvokeSubscriptionCallbacks( &( xMatchContext ), &( xPublishData ), &( xTopicMatchesTopicFilter ) );
+        }
+
+        return xTopicMatchesTopicFilter;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    MQTTBool_t Test_prvStoreSubscription( MQTTContext_t * pxMQTTContext,
+                                          const uint8_t * const pucTopic,
+                                          uint16_t usTopicLength,
+                                          void * pvPublishCallbackContext,
+                                          MQTTPublishCallback_t pxPublishCallback )
+    {
+        return prvStoreSubscription( pxMQTTContext, pucTopic, usTopicLength, pvPublishCallbackContext, pxPublishCallback );
+    }
+
+    void Test_prvRemoveSubscription( MQTTContext_t * pxMQTTContext,
+                                     const uint8_t * const pucTopic,
+                                     uint16_t usTopicLength )
+    {
+        prvRemoveSubscription( pxMQTTContext, pucTopic, usTopicLength );
+    }
+
+    MQTTBool_t Test_prvInvokeSubscriptionCallbacks( MQTTContext_t * pxMQTTContext,
+                                                    const MQTTPublishData_t * pxPublishData,
+                                                    MQTTBool_t * pxSubscriptionCallbackInvoked )
+    {
+        return prvInvokeSubscriptionCallbacks( pxMQTTContext, pxPublishData, pxSubscriptionCallbackInvoked );
     }
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
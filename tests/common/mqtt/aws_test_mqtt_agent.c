@@ -53,6 +53,11 @@
 #define mqttagenttestMESSAGE       "Hello from the test."
 #define mqttagenttestFAILUREPRINTF( x )    vLoggingPrintf x
 
+/* Number of QoS1 publishes kept in flight by the asynchronous publish test. */
+#ifndef mqttagenttestASYNC_PUBLISH_COUNT
+    #define mqttagenttestASYNC_PUBLISH_COUNT    ( 4 )
+#endif
+
 /* The parameters below are definable so the test can run on most target. */
 /* Size in bytes of the messages published.  */
 #ifndef  mqttagenttestMULTI_TASK_TEST_PUB_DATA_SIZE
@@ -224,6 +229,26 @@ static MQTTBool_t prvMQTTCallback( void * pvUserData,
     return eMQTTFalse;
 }
 
+/**
+ * @brief Completion callback for asynchronous MQTT agent operations.
+ */
+static void prvAsyncCompletionCallback( void * pvCompletionContext,
+                                        MQTTAgentOperationHandle_t xOperationHandle,
+                                        MQTTAgentReturnCode_t xReturnCode )
+{
+    MQTTtestAgentCbParam_t * pxCbParam = ( MQTTtestAgentCbParam_t * ) pvCompletionContext;
+
+    ( void ) xOperationHandle;
+
+    if( xReturnCode != eMQTTAgentSuccess )
+    {
+        pxCbParam->xStatus = pdFAIL;
+    }
+
+    /* Runs in the MQTT task, so must not block. */
+    xSemaphoreGive( pxCbParam->xSemaphore );
+}
+
 /*-----------------------------------------------------------*/
 
 
@@ -367,6 +392,7 @@ TEST_GROUP_RUNNER( Full_MQTT_Agent )
 {
     RUN_TEST_CASE( Full_MQTT_Agent, AFQP_MQTT_Agent_SubscribePublishDefaultPort );
     RUN_TEST_CASE( Full_MQTT_Agent, AFQP_MQTT_Agent_InvalidCredentials );
+    RUN_TEST_CASE( Full_MQTT_Agent, AFQP_MQTT_Agent_PublishAsyncPipelined );
 }
 TEST_GROUP_RUNNER( Full_MQTT_Agent_Stress_Tests )
 {
@@ -442,6 +468,95 @@ TEST( Full_MQTT_Agent, AFQP_MQTT_Agent_InvalidCredentials )
 }
 /*-----------------------------------------------------------*/
 
+/* Test for keeping several QoS1 publishes in flight with the asynchronous API. */
+TEST( Full_MQTT_Agent, AFQP_MQTT_Agent_PublishAsyncPipelined )
+{
+    MQTTAgentReturnCode_t xReturned;
+    MQTTAgentHandle_t xMQTTHandle = NULL;
+    BaseType_t xClientCreated = pdFALSE, xClientConnected = pdFALSE;
+    MQTTAgentConnectParams_t xConnectParameters;
+    MQTTAgentPublishParams_t xPublishParameters;
+    MQTTAgentOperationHandle_t xOperationHandle;
+    StaticSemaphore_t xSemaphore = { 0 };
+    MQTTtestAgentCbParam_t xCbParam;
+    uint32_t ulPublished = 0, ulCompleted = 0;
+
+    memcpy( &xConnectParameters, &xDefaultConnectParameters, sizeof( MQTTAgentConnectParams_t ) );
+    xConnectParameters.usClientIdLength = ( uint16_t ) strlen(
+        ( char * ) xConnectParameters.pucClientId );
+
+    xCbParam.xSemaphore = xSemaphoreCreateCountingStatic( mqttagenttestASYNC_PUBLISH_COUNT, 0, &xSemaphore );
+    xCbParam.xStatus = pdPASS;
+    TEST_ASSERT_NOT_NULL( xCbParam.xSemaphore );
+
+    if( TEST_PROTECT() )
+    {
+        xReturned = MQTT_AGENT_Create( &xMQTTHandle );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        xClientCreated = pdTRUE;
+
+        xReturned = MQTT_AGENT_Connect( xMQTTHandle,
+                                        &xConnectParameters,
+                                        mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT_MESSAGE( xReturned, eMQTTAgentSuccess, "Failed to connect to the MQTT broker with MQTT_AGENT_Connect()." );
+        xClientConnected = pdTRUE;
+
+        memset( &( xPublishParameters ), 0x00, sizeof( xPublishParameters ) );
+        xPublishParameters.pucTopic = mqttagenttestTOPIC_NAME;
+        xPublishParameters.pvData = mqttagenttestMESSAGE;
+        xPublishParameters.usTopicLength = ( uint16_t ) strlen( ( const char * ) mqttagenttestTOPIC_NAME );
+        xPublishParameters.ulDataLength = ( uint32_t ) strlen( mqttagenttestMESSAGE );
+        xPublishParameters.xQoS = eMQTTQoS1;
+
+        /* Queue all the publishes without waiting for any PUBACK. */
+        for( ulPublished = 0; ulPublished < mqttagenttestASYNC_PUBLISH_COUNT; ulPublished++ )
+        {
+            xReturned = MQTT_AGENT_PublishAsync( xMQTTHandle,
+                                                 &( xPublishParameters ),
+                                                 prvAsyncCompletionCallback,
+                                                 &xCbParam,
+                                                 mqttagenttestTIMEOUT,
+                                                 &xOperationHandle );
+            TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        }
+
+        /* Each accepted publish completes exactly once. */
+        for( ulCompleted = 0; ulCompleted < ulPublished; ulCompleted++ )
+        {
+            if( pdFALSE == xSemaphoreTake( xCbParam.xSemaphore, mqttagenttestTIMEOUT ) )
+            {
+                TEST_FAIL();
+            }
+        }
+
+        TEST_ASSERT_EQUAL_INT( pdPASS, xCbParam.xStatus );
+
+        xReturned = MQTT_AGENT_Disconnect( xMQTTHandle, mqttagenttestTIMEOUT );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+        xClientConnected = pdFALSE;
+    }
+
+    if( xClientConnected == pdTRUE )
+    {
+        /* Disconnecting fails any publish still in flight, so the
+         * callbacks are done with xCbParam once this returns. */
+        xReturned = MQTT_AGENT_Disconnect( xMQTTHandle,
+                                           mqttagenttestTIMEOUT );
+
+        if( xReturned != eMQTTAgentSuccess )
+        {
+            mqttagenttestFAILUREPRINTF( ( "%s: Could not disconnect client.\r\n", __FUNCTION__ ) );
+        }
+    }
+
+    if( xClientCreated == pdTRUE )
+    {
+        xReturned = MQTT_AGENT_Delete( xMQTTHandle );
+        TEST_ASSERT_EQUAL_INT( xReturned, eMQTTAgentSuccess );
+    }
+}
+/*-----------------------------------------------------------*/
+
 /* Test for ping-ponging a message using AWS IoT MQTT broker support for port 443. */
 TEST( Full_MQTT_Agent_ALPN, MQTT_Agent_SubscribePublishAlpn )
 {
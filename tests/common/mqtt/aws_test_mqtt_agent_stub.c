@@ -0,0 +1,856 @@
+/*
+ * Amazon FreeRTOS MQTT AFQP V1.1.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_test_mqtt_agent_stub.c
+ * @brief Tests for MQTT Agent, against a fake broker.
+ *
+ * This file implements the secure sockets API with a fake broker, which
+ * answers the packets sent by the MQTT agent without any network, so that the
+ * agent can be tested on the platforms which do not link a secure sockets
+ * port, such as the Linux simulator.  It must not be linked together with a
+ * secure sockets port.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* Amazon FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "aws_mqtt_agent.h"
+#include "aws_mqtt_agent_config.h"
+#include "aws_mqtt_agent_config_defaults.h"
+#include "aws_bufferpool.h"
+#include "aws_secure_sockets.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+/* Number of sockets the fake broker can accept at the same time. */
+#define mqttagentstubMAX_SOCKETS          ( 2 )
+
+/* Size of the buffer holding the packets sent by the fake broker to each
+ * socket.  It holds at least one ACK for each operation in flight. */
+#define mqttagentstubRX_BUFFER_SIZE       ( ( mqttconfigMAX_PARALLEL_OPS * 8 ) + 64 )
+
+/* Number of QoS1 publishes issued by the pipelined publish test. */
+#define mqttagentstubPIPELINED_COUNT      ( 100 )
+
+/* Largest number of asynchronous operations started by one test. */
+#define mqttagentstubMAX_OPERATIONS       ( mqttagentstubPIPELINED_COUNT )
+
+/* Timeout of the operations which are expected to complete. */
+#define mqttagentstubTIMEOUT              pdMS_TO_TICKS( 5000 )
+
+/* Timeout of the operations whose ACK is dropped by the fake broker. */
+#define mqttagentstubSHORT_TIMEOUT        pdMS_TO_TICKS( 200 )
+
+/* Time for the MQTT task to process the commands already sent to it. */
+#define mqttagentstubSETTLE_TICKS         pdMS_TO_TICKS( 50 )
+
+/* How late the MQTT task may wake up after the deadline of an operation, on a
+ * host that does not run the simulated tick on time. */
+#define mqttagentstubDEADLINE_MARGIN      pdMS_TO_TICKS( 100 )
+
+#define mqttagentstubTOPIC                ( ( const uint8_t * ) "freertos/tests/stub" )
+#define mqttagentstubMESSAGE              "Hello from the test."
+
+/* MQTT control packet types, in the first byte of the fixed header. */
+#define mqttagentstubCONNECT              ( 0x10 )
+#define mqttagentstubCONNACK              ( 0x20 )
+#define mqttagentstubPUBLISH              ( 0x30 )
+#define mqttagentstubPUBACK               ( 0x40 )
+#define mqttagentstubSUBSCRIBE            ( 0x80 )
+#define mqttagentstubSUBACK               ( 0x90 )
+#define mqttagentstubUNSUBSCRIBE          ( 0xA0 )
+#define mqttagentstubUNSUBACK             ( 0xB0 )
+#define mqttagentstubPACKET_TYPE_MASK     ( 0xF0 )
+#define mqttagentstubPUBLISH_QOS_MASK     ( 0x06 )
+
+/**
+ * @brief One socket of the fake broker.
+ *
+ * The data sent by the broker to the MQTT agent is kept in a circular buffer.
+ * While xHoldAcks is set, the ACKs are kept in a second buffer instead, and
+ * they are only received once prvReleaseHeldAcks() is called.  When
+ * xMaxRecvLength is not 0, SOCKETS_Recv() returns no more than that many bytes
+ * at a time, like a TCP stream which receives one small segment at a time.
+ */
+typedef struct MQTTAgentStubSocket
+{
+    BaseType_t xInUse;
+    BaseType_t xShutdown;
+    BaseType_t xHoldAcks;
+    uint32_t ulDropEvery;
+    uint32_t ulPublishCount;
+    uint32_t ulRecvCalls;
+    size_t xMaxRecvLength;
+    void ( * pxWakeupCallback )( Socket_t xSocket );
+    uint8_t ucRxBuffer[ mqttagentstubRX_BUFFER_SIZE ];
+    size_t xRxHead;
+    size_t xRxLength;
+    uint8_t ucHeldBuffer[ mqttagentstubRX_BUFFER_SIZE ];
+    size_t xHeldLength;
+} MQTTAgentStubSocket_t;
+
+/**
+ * @brief Result of an asynchronous operation started by a test.
+ */
+typedef struct MQTTAgentStubResult
+{
+    MQTTAgentOperationHandle_t xHandle;
+    BaseType_t xCompletions;
+    MQTTAgentReturnCode_t xReturnCode;
+} MQTTAgentStubResult_t;
+
+/* The sockets of the fake broker. */
+static MQTTAgentStubSocket_t xStubSockets[ mqttagentstubMAX_SOCKETS ];
+
+/* The results of the asynchronous operations, indexed by their completion
+ * context. */
+static MQTTAgentStubResult_t xResults[ mqttagentstubMAX_OPERATIONS ];
+
+/* Given once for each completed operation. */
+static SemaphoreHandle_t xCompletedSemaphore = NULL;
+
+/* Given back when an operation completes, when the test bounds the number of
+ * operations in flight. */
+static SemaphoreHandle_t xSlotSemaphore = NULL;
+
+/* The MQTT clients used by a test, deleted by the tear down function. */
+static MQTTAgentHandle_t xMQTTHandles[ mqttagentstubMAX_SOCKETS ];
+
+static const char mqttagentstubPAYLOAD[] = mqttagentstubMESSAGE;
+
+/*-----------------------------------------------------------*/
+
+/* Queues the bytes of a packet, which are then read by the MQTT agent.  Called
+ * in a critical section. */
+static void prvQueueToAgent( MQTTAgentStubSocket_t * pxStubSocket,
+                             const uint8_t * pucPacket,
+                             size_t xLength,
+                             BaseType_t xMayHold )
+{
+    size_t x;
+
+    if( ( xMayHold == pdTRUE ) && ( pxStubSocket->xHoldAcks == pdTRUE ) )
+    {
+        configASSERT( ( pxStubSocket->xHeldLength + xLength ) <= sizeof( pxStubSocket->ucHeldBuffer ) );
+        memcpy( &( pxStubSocket->ucHeldBuffer[ pxStubSocket->xHeldLength ] ), pucPacket, xLength );
+        pxStubSocket->xHeldLength += xLength;
+    }
+    else
+    {
+        configASSERT( ( pxStubSocket->xRxLength + xLength ) <= sizeof( pxStubSocket->ucRxBuffer ) );
+
+        for( x = 0; x < xLength; x++ )
+        {
+            pxStubSocket->ucRxBuffer[ ( pxStubSocket->xRxHead + pxStubSocket->xRxLength ) % sizeof( pxStubSocket->ucRxBuffer ) ] = pucPacket[ x ];
+            pxStubSocket->xRxLength++;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Lets the MQTT agent know that the socket has data, as a secure sockets port
+ * does when a packet is received. */
+static void prvWakeAgent( MQTTAgentStubSocket_t * pxStubSocket )
+{
+    if( pxStubSocket->pxWakeupCallback != NULL )
+    {
+        pxStubSocket->pxWakeupCallback( ( Socket_t ) pxStubSocket );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Sends the ACKs held by the fake broker to the MQTT agent, and stops holding
+ * the next ones. */
+static void prvReleaseHeldAcks( MQTTAgentStubSocket_t * pxStubSocket )
+{
+    taskENTER_CRITICAL();
+    {
+        pxStubSocket->xHoldAcks = pdFALSE;
+        prvQueueToAgent( pxStubSocket, pxStubSocket->ucHeldBuffer, pxStubSocket->xHeldLength, pdFALSE );
+        pxStubSocket->xHeldLength = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    prvWakeAgent( pxStubSocket );
+}
+
+/*-----------------------------------------------------------*/
+
+Socket_t SOCKETS_Socket( int32_t lDomain,
+                         int32_t lType,
+                         int32_t lProtocol )
+{
+    Socket_t xSocket = SOCKETS_INVALID_SOCKET;
+    BaseType_t x;
+
+    ( void ) lDomain;
+    ( void ) lType;
+    ( void ) lProtocol;
+
+    taskENTER_CRITICAL();
+    {
+        for( x = 0; ( x < mqttagentstubMAX_SOCKETS ) && ( xSocket == SOCKETS_INVALID_SOCKET ); x++ )
+        {
+            if( xStubSockets[ x ].xInUse == pdFALSE )
+            {
+                memset( &( xStubSockets[ x ] ), 0x00, sizeof( xStubSockets[ x ] ) );
+                xStubSockets[ x ].xInUse = pdTRUE;
+                xSocket = ( Socket_t ) &( xStubSockets[ x ] );
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xSocket;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Connect( Socket_t xSocket,
+                         SocketsSockaddr_t * pxAddress,
+                         Socklen_t xAddressLength )
+{
+    ( void ) xSocket;
+    ( void ) pxAddress;
+    ( void ) xAddressLength;
+
+    return SOCKETS_ERROR_NONE;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t SOCKETS_GetHostByName( const char * pcHostName )
+{
+    ( void ) pcHostName;
+
+    return SOCKETS_inet_addr_quick( 127, 0, 0, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
+                            int32_t lLevel,
+                            int32_t lOptionName,
+                            const void * pvOptionValue,
+                            size_t xOptionLength )
+{
+    MQTTAgentStubSocket_t * pxStubSocket = ( MQTTAgentStubSocket_t * ) xSocket;
+
+    ( void ) lLevel;
+    ( void ) xOptionLength;
+
+    if( lOptionName == SOCKETS_SO_WAKEUP_CALLBACK )
+    {
+        pxStubSocket->pxWakeupCallback = ( void ( * )( Socket_t ) )pvOptionValue;
+    }
+
+    return SOCKETS_ERROR_NONE;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Recv( Socket_t xSocket,
+                      void * pvBuffer,
+                      size_t xBufferLength,
+                      uint32_t ulFlags )
+{
+    MQTTAgentStubSocket_t * pxStubSocket = ( MQTTAgentStubSocket_t * ) xSocket;
+    uint8_t * pucBuffer = ( uint8_t * ) pvBuffer;
+    int32_t lReceived = 0;
+
+    ( void ) ulFlags;
+
+    taskENTER_CRITICAL();
+    {
+        pxStubSocket->ulRecvCalls++;
+
+        if( ( pxStubSocket->xMaxRecvLength != 0 ) && ( xBufferLength > pxStubSocket->xMaxRecvLength ) )
+        {
+            xBufferLength = pxStubSocket->xMaxRecvLength;
+        }
+
+        if( pxStubSocket->xShutdown == pdTRUE )
+        {
+            lReceived = SOCKETS_EINVAL;
+        }
+        else if( pxStubSocket->xRxLength == 0 )
+        {
+            lReceived = SOCKETS_EWOULDBLOCK;
+        }
+        else
+        {
+            while( ( pxStubSocket->xRxLength > 0 ) && ( ( size_t ) lReceived < xBufferLength ) )
+            {
+                pucBuffer[ lReceived ] = pxStubSocket->ucRxBuffer[ pxStubSocket->xRxHead ];
+                pxStubSocket->xRxHead = ( pxStubSocket->xRxHead + 1 ) % sizeof( pxStubSocket->ucRxBuffer );
+                pxStubSocket->xRxLength--;
+                lReceived++;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return lReceived;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Send( Socket_t xSocket,
+                      const void * pvBuffer,
+                      size_t xDataLength,
+                      uint32_t ulFlags )
+{
+    MQTTAgentStubSocket_t * pxStubSocket = ( MQTTAgentStubSocket_t * ) xSocket;
+    const uint8_t * pucPacket = ( const uint8_t * ) pvBuffer;
+    uint8_t ucAck[ 5 ];
+    size_t xAckLength = 0;
+    size_t xHeaderLength = 1;
+    size_t xTopicLength;
+    BaseType_t xMayHold = pdTRUE;
+
+    ( void ) ulFlags;
+
+    /* The agent sends each packet in one call.  Skip the remaining length of
+     * the fixed header to find the variable header. */
+    while( ( pucPacket[ xHeaderLength ] & 0x80 ) != 0 )
+    {
+        xHeaderLength++;
+    }
+
+    xHeaderLength++;
+
+    switch( pucPacket[ 0 ] & mqttagentstubPACKET_TYPE_MASK )
+    {
+        case mqttagentstubCONNECT:
+            ucAck[ 0 ] = mqttagentstubCONNACK;
+            ucAck[ 1 ] = 2;
+            ucAck[ 2 ] = 0;
+            ucAck[ 3 ] = 0;
+            xAckLength = 4;
+            xMayHold = pdFALSE;
+            break;
+
+        case mqttagentstubSUBSCRIBE:
+            ucAck[ 0 ] = mqttagentstubSUBACK;
+            ucAck[ 1 ] = 3;
+            ucAck[ 2 ] = pucPacket[ xHeaderLength ];
+            ucAck[ 3 ] = pucPacket[ xHeaderLength + 1 ];
+            ucAck[ 4 ] = 1;
+            xAckLength = 5;
+            break;
+
+        case mqttagentstubUNSUBSCRIBE:
+            ucAck[ 0 ] = mqttagentstubUNSUBACK;
+            ucAck[ 1 ] = 2;
+            ucAck[ 2 ] = pucPacket[ xHeaderLength ];
+            ucAck[ 3 ] = pucPacket[ xHeaderLength + 1 ];
+            xAckLength = 4;
+            break;
+
+        case mqttagentstubPUBLISH:
+
+            /* Only QoS1 publishes are acknowledged. */
+            if( ( pucPacket[ 0 ] & mqttagentstubPUBLISH_QOS_MASK ) != 0 )
+            {
+                xTopicLength = ( ( size_t ) pucPacket[ xHeaderLength ] << 8 ) | pucPacket[ xHeaderLength + 1 ];
+                ucAck[ 0 ] = mqttagentstubPUBACK;
+                ucAck[ 1 ] = 2;
+                ucAck[ 2 ] = pucPacket[ xHeaderLength + 2 + xTopicLength ];
+                ucAck[ 3 ] = pucPacket[ xHeaderLength + 3 + xTopicLength ];
+                xAckLength = 4;
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    if( xAckLength > 0 )
+    {
+        taskENTER_CRITICAL();
+        {
+            if( ( ucAck[ 0 ] & mqttagentstubPACKET_TYPE_MASK ) == mqttagentstubPUBACK )
+            {
+                pxStubSocket->ulPublishCount++;
+
+                if( ( pxStubSocket->ulDropEvery != 0 ) &&
+                    ( ( pxStubSocket->ulPublishCount % pxStubSocket->ulDropEvery ) == 0 ) )
+                {
+                    xAckLength = 0;
+                }
+            }
+
+            /* The CONNACK is never held. */
+            prvQueueToAgent( pxStubSocket, ucAck, xAckLength, xMayHold );
+
+            if( ( xMayHold == pdTRUE ) && ( pxStubSocket->xHoldAcks == pdTRUE ) )
+            {
+                xAckLength = 0;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xAckLength > 0 )
+        {
+            prvWakeAgent( pxStubSocket );
+        }
+    }
+
+    return ( int32_t ) xDataLength;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Shutdown( Socket_t xSocket,
+                          uint32_t ulHow )
+{
+    MQTTAgentStubSocket_t * pxStubSocket = ( MQTTAgentStubSocket_t * ) xSocket;
+
+    ( void ) ulHow;
+
+    pxStubSocket->xShutdown = pdTRUE;
+
+    return SOCKETS_ERROR_NONE;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Close( Socket_t xSocket )
+{
+    MQTTAgentStubSocket_t * pxStubSocket = ( MQTTAgentStubSocket_t * ) xSocket;
+
+    pxStubSocket->xInUse = pdFALSE;
+
+    return SOCKETS_ERROR_NONE;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCompletionCallback( void * pvCompletionContext,
+                                   MQTTAgentOperationHandle_t xOperationHandle,
+                                   MQTTAgentReturnCode_t xReturnCode )
+{
+    MQTTAgentStubResult_t * pxResult = &( xResults[ ( size_t ) pvCompletionContext ] );
+
+    /* The callback can be invoked before the function that started the
+     * operation returns its handle, so the handle is checked by the test. */
+    pxResult->xHandle = xOperationHandle;
+    pxResult->xReturnCode = xReturnCode;
+    pxResult->xCompletions++;
+
+    if( xSlotSemaphore != NULL )
+    {
+        ( void ) xSemaphoreGive( xSlotSemaphore );
+    }
+
+    ( void ) xSemaphoreGive( xCompletedSemaphore );
+}
+
+/*-----------------------------------------------------------*/
+
+/* Waits for the completion of ulCount operations, and fails the test if they
+ * do not complete in time. */
+static void prvWaitForCompletions( uint32_t ulCount )
+{
+    uint32_t x;
+
+    for( x = 0; x < ulCount; x++ )
+    {
+        TEST_ASSERT_EQUAL_MESSAGE( pdTRUE,
+                                   xSemaphoreTake( xCompletedSemaphore, mqttagentstubTIMEOUT ),
+                                   "An asynchronous operation did not complete." );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Counts the operations which completed once with xReturnCode, and checks that
+ * none of the ulCount operations completed more than once or with a handle
+ * other than the one returned when it was started. */
+static uint32_t prvCountResults( uint32_t ulCount,
+                                 const MQTTAgentOperationHandle_t * pxHandles,
+                                 MQTTAgentReturnCode_t xReturnCode )
+{
+    uint32_t x, ulMatching = 0;
+
+    for( x = 0; x < ulCount; x++ )
+    {
+        TEST_ASSERT_TRUE( xResults[ x ].xCompletions <= 1 );
+
+        if( xResults[ x ].xCompletions == 1 )
+        {
+            TEST_ASSERT_EQUAL_PTR( pxHandles[ x ], xResults[ x ].xHandle );
+
+            if( xResults[ x ].xReturnCode == xReturnCode )
+            {
+                ulMatching++;
+            }
+        }
+    }
+
+    return ulMatching;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Creates a client and connects it to the fake broker. */
+static MQTTAgentStubSocket_t * prvConnect( BaseType_t xClient )
+{
+    MQTTAgentConnectParams_t xConnectParameters;
+    MQTTAgentStubSocket_t * pxStubSocket = NULL;
+    BaseType_t x;
+
+    memset( &xConnectParameters, 0x00, sizeof( xConnectParameters ) );
+    xConnectParameters.pcURL = "broker.stub";
+    xConnectParameters.usPort = 1883;
+    xConnectParameters.pucClientId = ( const uint8_t * ) "StubClient";
+    xConnectParameters.usClientIdLength = ( uint16_t ) strlen( "StubClient" );
+
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_Create( &( xMQTTHandles[ xClient ] ) ) );
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_Connect( xMQTTHandles[ xClient ], &xConnectParameters, mqttagentstubTIMEOUT ) );
+
+    /* The socket of the new connection is the last one taken. */
+    for( x = 0; x < mqttagentstubMAX_SOCKETS; x++ )
+    {
+        if( xStubSockets[ x ].xInUse == pdTRUE )
+        {
+            pxStubSocket = &( xStubSockets[ x ] );
+        }
+    }
+
+    TEST_ASSERT_NOT_NULL( pxStubSocket );
+
+    return pxStubSocket;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvInitPublishParams( MQTTAgentPublishParams_t * pxPublishParameters )
+{
+    memset( pxPublishParameters, 0x00, sizeof( MQTTAgentPublishParams_t ) );
+    pxPublishParameters->pucTopic = mqttagentstubTOPIC;
+    pxPublishParameters->usTopicLength = ( uint16_t ) strlen( ( const char * ) mqttagentstubTOPIC );
+    pxPublishParameters->pvData = mqttagentstubPAYLOAD;
+    pxPublishParameters->ulDataLength = ( uint32_t ) strlen( mqttagentstubPAYLOAD );
+    pxPublishParameters->xQoS = eMQTTQoS1;
+}
+
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Test group definition.
+ */
+TEST_GROUP( Full_MQTT_Agent_Stub );
+
+TEST_SETUP( Full_MQTT_Agent_Stub )
+{
+    /* Both do nothing when they have already been called. */
+    TEST_ASSERT_EQUAL( pdPASS, BUFFERPOOL_Init() );
+    TEST_ASSERT_EQUAL( pdPASS, MQTT_AGENT_Init() );
+
+    if( xCompletedSemaphore == NULL )
+    {
+        xCompletedSemaphore = xSemaphoreCreateCounting( mqttagentstubMAX_OPERATIONS, 0 );
+        TEST_ASSERT_NOT_NULL( xCompletedSemaphore );
+    }
+
+    memset( xResults, 0x00, sizeof( xResults ) );
+    memset( xMQTTHandles, 0x00, sizeof( xMQTTHandles ) );
+}
+
+TEST_TEAR_DOWN( Full_MQTT_Agent_Stub )
+{
+    BaseType_t x;
+
+    for( x = 0; x < mqttagentstubMAX_SOCKETS; x++ )
+    {
+        if( xMQTTHandles[ x ] != NULL )
+        {
+            if( MQTT_AGENT_Disconnect( xMQTTHandles[ x ], mqttagentstubTIMEOUT ) != eMQTTAgentSuccess )
+            {
+                configPRINTF( ( "Failed to disconnect the stub client %d.\r\n", ( int ) x ) );
+            }
+
+            ( void ) MQTT_AGENT_Delete( xMQTTHandles[ x ] );
+        }
+    }
+
+    if( xSlotSemaphore != NULL )
+    {
+        vSemaphoreDelete( xSlotSemaphore );
+        xSlotSemaphore = NULL;
+    }
+
+    /* Forget the completions of the operations failed by the disconnect. */
+    while( xSemaphoreTake( xCompletedSemaphore, 0 ) == pdTRUE )
+    {
+    }
+}
+
+TEST_GROUP_RUNNER( Full_MQTT_Agent_Stub )
+{
+    RUN_TEST_CASE( Full_MQTT_Agent_Stub, AsyncPublishPipelined );
+    RUN_TEST_CASE( Full_MQTT_Agent_Stub, AsyncPublishTableFull );
+    RUN_TEST_CASE( Full_MQTT_Agent_Stub, AsyncPublishTimeout );
+    RUN_TEST_CASE( Full_MQTT_Agent_Stub, AsyncDisconnect );
+    RUN_TEST_CASE( Full_MQTT_Agent_Stub, ServiceReadySockets );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_Agent_Stub, AsyncPublishPipelined )
+{
+    MQTTAgentSubscribeParams_t xSubscribeParameters;
+    MQTTAgentUnsubscribeParams_t xUnsubscribeParameters;
+    MQTTAgentPublishParams_t xPublishParameters;
+    MQTTAgentOperationHandle_t xHandles[ mqttagentstubPIPELINED_COUNT ];
+    uint32_t x;
+
+    ( void ) prvConnect( 0 );
+
+    /* Subscribe and unsubscribe complete through the callback. */
+    memset( &xSubscribeParameters, 0x00, sizeof( xSubscribeParameters ) );
+    xSubscribeParameters.pucTopic = mqttagentstubTOPIC;
+    xSubscribeParameters.usTopicLength = ( uint16_t ) strlen( ( const char * ) mqttagentstubTOPIC );
+    xSubscribeParameters.xQoS = eMQTTQoS1;
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_SubscribeAsync( xMQTTHandles[ 0 ], &xSubscribeParameters, prvCompletionCallback,
+                                                                     ( void * ) 0, mqttagentstubTIMEOUT, &( xHandles[ 0 ] ) ) );
+    prvWaitForCompletions( 1 );
+    TEST_ASSERT_EQUAL( 1, prvCountResults( 1, xHandles, eMQTTAgentSuccess ) );
+
+    memset( xResults, 0x00, sizeof( xResults ) );
+    xUnsubscribeParameters.pucTopic = xSubscribeParameters.pucTopic;
+    xUnsubscribeParameters.usTopicLength = xSubscribeParameters.usTopicLength;
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_UnsubscribeAsync( xMQTTHandles[ 0 ], &xUnsubscribeParameters, prvCompletionCallback,
+                                                                       ( void * ) 0, mqttagentstubTIMEOUT, &( xHandles[ 0 ] ) ) );
+    prvWaitForCompletions( 1 );
+    TEST_ASSERT_EQUAL( 1, prvCountResults( 1, xHandles, eMQTTAgentSuccess ) );
+
+    /* Keep as many QoS1 publishes in flight as the agent can track, without
+     * waiting for each one to complete before starting the next one. */
+    memset( xResults, 0x00, sizeof( xResults ) );
+    xSlotSemaphore = xSemaphoreCreateCounting( mqttconfigMAX_PARALLEL_OPS, mqttconfigMAX_PARALLEL_OPS );
+    TEST_ASSERT_NOT_NULL( xSlotSemaphore );
+    prvInitPublishParams( &xPublishParameters );
+
+    for( x = 0; x < mqttagentstubPIPELINED_COUNT; x++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xSlotSemaphore, mqttagentstubTIMEOUT ) );
+        TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_PublishAsync( xMQTTHandles[ 0 ], &xPublishParameters, prvCompletionCallback,
+                                                                       ( void * ) ( size_t ) x, mqttagentstubTIMEOUT, &( xHandles[ x ] ) ) );
+    }
+
+    prvWaitForCompletions( mqttagentstubPIPELINED_COUNT );
+    TEST_ASSERT_EQUAL( mqttagentstubPIPELINED_COUNT, prvCountResults( mqttagentstubPIPELINED_COUNT, xHandles, eMQTTAgentSuccess ) );
+
+    /* The blocking API still works once the asynchronous operations are
+     * done. */
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_Publish( xMQTTHandles[ 0 ], &xPublishParameters, mqttagentstubTIMEOUT ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_Agent_Stub, AsyncPublishTableFull )
+{
+    MQTTAgentPublishParams_t xPublishParameters;
+    MQTTAgentOperationHandle_t xHandles[ mqttconfigMAX_PARALLEL_OPS + 2 ];
+    MQTTAgentStubSocket_t * pxStubSocket;
+    uint32_t x;
+
+    pxStubSocket = prvConnect( 0 );
+    prvInitPublishParams( &xPublishParameters );
+
+    /* While no PUBACK is received, the publishes that do not fit in the table
+     * of operations in flight fail right away. */
+    pxStubSocket->xHoldAcks = pdTRUE;
+
+    for( x = 0; x < ( mqttconfigMAX_PARALLEL_OPS + 2 ); x++ )
+    {
+        TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_PublishAsync( xMQTTHandles[ 0 ], &xPublishParameters, prvCompletionCallback,
+                                                                       ( void * ) ( size_t ) x, mqttagentstubTIMEOUT, &( xHandles[ x ] ) ) );
+    }
+
+    prvWaitForCompletions( 2 );
+    vTaskDelay( mqttagentstubSETTLE_TICKS );
+    TEST_ASSERT_EQUAL( 2, prvCountResults( mqttconfigMAX_PARALLEL_OPS + 2, xHandles, eMQTTAgentFailure ) );
+    TEST_ASSERT_EQUAL( 0, prvCountResults( mqttconfigMAX_PARALLEL_OPS + 2, xHandles, eMQTTAgentSuccess ) );
+
+    /* The others complete once their PUBACK is received. */
+    prvReleaseHeldAcks( pxStubSocket );
+    prvWaitForCompletions( mqttconfigMAX_PARALLEL_OPS );
+    TEST_ASSERT_EQUAL( mqttconfigMAX_PARALLEL_OPS, prvCountResults( mqttconfigMAX_PARALLEL_OPS + 2, xHandles, eMQTTAgentSuccess ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_Agent_Stub, AsyncPublishTimeout )
+{
+    MQTTAgentPublishParams_t xPublishParameters;
+    MQTTAgentOperationHandle_t xHandles[ 4 ];
+    MQTTAgentStubSocket_t * pxStubSocket;
+    uint32_t x;
+
+    pxStubSocket = prvConnect( 0 );
+    prvInitPublishParams( &xPublishParameters );
+
+    /* The publishes whose PUBACK is dropped time out, the others succeed. */
+    pxStubSocket->ulDropEvery = 2;
+
+    for( x = 0; x < 4; x++ )
+    {
+        TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_PublishAsync( xMQTTHandles[ 0 ], &xPublishParameters, prvCompletionCallback,
+                                                                       ( void * ) ( size_t ) x, mqttagentstubSHORT_TIMEOUT, &( xHandles[ x ] ) ) );
+    }
+
+    prvWaitForCompletions( 4 );
+    TEST_ASSERT_EQUAL( 2, prvCountResults( 4, xHandles, eMQTTAgentSuccess ) );
+    TEST_ASSERT_EQUAL( 2, prvCountResults( 4, xHandles, eMQTTAgentTimeout ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_Agent_Stub, AsyncDisconnect )
+{
+    MQTTAgentPublishParams_t xPublishParameters;
+    MQTTAgentOperationHandle_t xHandles[ 3 ];
+    MQTTAgentStubSocket_t * pxStubSocket;
+    uint32_t x;
+
+    pxStubSocket = prvConnect( 0 );
+    prvInitPublishParams( &xPublishParameters );
+
+    /* A QoS0 publish completes as soon as it is sent. */
+    xPublishParameters.xQoS = eMQTTQoS0;
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_PublishAsync( xMQTTHandles[ 0 ], &xPublishParameters, prvCompletionCallback,
+                                                                   ( void * ) 0, mqttagentstubTIMEOUT, &( xHandles[ 0 ] ) ) );
+    prvWaitForCompletions( 1 );
+    TEST_ASSERT_EQUAL( 1, prvCountResults( 1, xHandles, eMQTTAgentSuccess ) );
+
+    /* Disconnecting fails the operations still waiting for their ACK. */
+    memset( xResults, 0x00, sizeof( xResults ) );
+    xPublishParameters.xQoS = eMQTTQoS1;
+    pxStubSocket->xHoldAcks = pdTRUE;
+
+    for( x = 0; x < 3; x++ )
+    {
+        TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_PublishAsync( xMQTTHandles[ 0 ], &xPublishParameters, prvCompletionCallback,
+                                                                       ( void * ) ( size_t ) x, mqttagentstubTIMEOUT, &( xHandles[ x ] ) ) );
+    }
+
+    vTaskDelay( mqttagentstubSETTLE_TICKS );
+    TEST_ASSERT_EQUAL( 0, prvCountResults( 3, xHandles, eMQTTAgentSuccess ) );
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_Disconnect( xMQTTHandles[ 0 ], mqttagentstubTIMEOUT ) );
+    prvWaitForCompletions( 3 );
+    TEST_ASSERT_EQUAL( 3, prvCountResults( 3, xHandles, eMQTTAgentFailure ) );
+
+    ( void ) MQTT_AGENT_Delete( xMQTTHandles[ 0 ] );
+    xMQTTHandles[ 0 ] = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_MQTT_Agent_Stub, ServiceReadySockets )
+{
+    MQTTAgentPublishParams_t xPublishParameters;
+    MQTTAgentOperationHandle_t xHandles[ 3 ];
+    MQTTAgentStubSocket_t * pxReadySocket;
+    MQTTAgentStubSocket_t * pxIdleSocket;
+    TickType_t xStartTime, xElapsedTime;
+    uint32_t x;
+
+    pxReadySocket = prvConnect( 0 );
+    pxIdleSocket = prvConnect( 1 );
+    TEST_ASSERT_TRUE( pxReadySocket != pxIdleSocket );
+    prvInitPublishParams( &xPublishParameters );
+
+    /* Three PUBACKs are received one at a time, from a single wakeup. */
+    pxReadySocket->xHoldAcks = pdTRUE;
+    pxReadySocket->xMaxRecvLength = 4;
+
+    for( x = 0; x < 3; x++ )
+    {
+        TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_PublishAsync( xMQTTHandles[ 0 ], &xPublishParameters, prvCompletionCallback,
+                                                                       ( void * ) ( size_t ) x, mqttagentstubTIMEOUT, &( xHandles[ x ] ) ) );
+    }
+
+    /* Once both connections are idle, the MQTT task does not read from the
+     * sockets until one of them has data. */
+    vTaskDelay( mqttagentstubSETTLE_TICKS );
+    taskENTER_CRITICAL();
+    {
+        pxReadySocket->ulRecvCalls = 0;
+        pxIdleSocket->ulRecvCalls = 0;
+    }
+    taskEXIT_CRITICAL();
+
+    /* Only the socket which receives the PUBACKs is read, including while it
+     * keeps returning data and is read again without blocking. */
+    prvReleaseHeldAcks( pxReadySocket );
+    prvWaitForCompletions( 3 );
+    vTaskDelay( mqttagentstubSETTLE_TICKS );
+    TEST_ASSERT_EQUAL( 3, prvCountResults( 3, xHandles, eMQTTAgentSuccess ) );
+    TEST_ASSERT_TRUE( pxReadySocket->ulRecvCalls >= 3 );
+    TEST_ASSERT_EQUAL( 0, pxIdleSocket->ulRecvCalls );
+    memset( xResults, 0x00, sizeof( xResults ) );
+
+    /* With an operation waiting for an ACK on the second connection, and the
+     * first one only waiting for its keep alive, the MQTT task sleeps until
+     * the nearest deadline, then times out the operation. */
+    taskENTER_CRITICAL();
+    {
+        pxReadySocket->ulRecvCalls = 0;
+        pxIdleSocket->ulRecvCalls = 0;
+        pxIdleSocket->xHoldAcks = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    xStartTime = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL( eMQTTAgentSuccess, MQTT_AGENT_PublishAsync( xMQTTHandles[ 1 ], &xPublishParameters, prvCompletionCallback,
+                                                                   ( void * ) 0, mqttagentstubSHORT_TIMEOUT, &( xHandles[ 0 ] ) ) );
+    vTaskDelay( mqttagentstubSHORT_TIMEOUT / 2 );
+    TEST_ASSERT_EQUAL( 0, xResults[ 0 ].xCompletions );
+    TEST_ASSERT_EQUAL( 0, pxReadySocket->ulRecvCalls );
+    TEST_ASSERT_EQUAL( 0, pxIdleSocket->ulRecvCalls );
+
+    prvWaitForCompletions( 1 );
+    xElapsedTime = xTaskGetTickCount() - xStartTime;
+    TEST_ASSERT_EQUAL( 1, prvCountResults( 1, xHandles, eMQTTAgentTimeout ) );
+    TEST_ASSERT_TRUE( xElapsedTime >= mqttagentstubSHORT_TIMEOUT );
+    TEST_ASSERT_TRUE( xElapsedTime < ( mqttagentstubSHORT_TIMEOUT + mqttagentstubDEADLINE_MARGIN ) );
+
+    /* The sockets are read at most once when the wait expires, in case the
+     * platform could not report that they have data. */
+    TEST_ASSERT_TRUE( pxReadySocket->ulRecvCalls <= 1 );
+    TEST_ASSERT_TRUE( pxIdleSocket->ulRecvCalls <= 1 );
+}
@@ -29,6 +29,7 @@
  */
 
 /* Standard includes. */
+#include <stdio.h>
 #include <string.h>
 
 /* Unity framework includes. */
@@ -38,6 +39,7 @@
 #include "aws_mqtt_lib.h"
 #include "aws_mqtt_lib_test_access_declare.h"
 #include "aws_mqtt_agent_config.h"
+#include "aws_mqtt_store.h"
 
 /* Bufferpool includes. */
 #include "aws_bufferpool.h"
@@ -74,11 +76,65 @@
  * @brief MQTT Control packet types.
  */
 #define mqttCONTROL_CONNACK                   ( ( uint8_t ) 2 << ( uint8_t ) 4 )
+#define mqttCONTROL_PUBLISH                   ( ( uint8_t ) 3 << ( uint8_t ) 4 )
+#define mqttCONTROL_PUBACK                    ( ( uint8_t ) 4 << ( uint8_t ) 4 )
 
 /**
  * @brief MQTT Control packet flags.
  */
 #define mqttFLAGS_CONNACK                     ( ( uint8_t ) 0 ) /**< Reserved. */
+#define mqttFLAGS_PUBLISH_DUP                 ( ( uint8_t ) 8 )
+
+/**
+ * @brief Offset of the flags in the sent CONNECT message, and the clean
+ * session flag.
+ */
+#define testmqttlibCONNECT_FLAGS_OFFSET       ( 9 )
+#define mqttCONNECT_CLEAN_SESSION_FLAG        ( ( uint8_t ) 0x02 )
+
+/**
+ * @brief Topic of the large publish messages.
+ */
+#define testmqttlibLARGE_PUBLISH_TOPIC        "freertos/tests/large"
+
+/**
+ * @brief Length of the data of the large publish messages. It is more than
+ * what fits in one buffer of the buffer pool.
+ */
+#define testmqttlibLARGE_PAYLOAD_LENGTH       ( 5000 )
+
+/**
+ * @brief Maximum number of bytes returned by the publish read callback at a
+ * time, to check that the library keeps reading until it has what it needs.
+ */
+#define testmqttlibREAD_CALLBACK_LENGTH       ( 100 )
+
+/**
+ * @brief Number of bytes of the large publish message passed to
+ * MQTT_ParseReceivedData at a time.
+ */
+#define testmqttlibRECEIVE_CHUNK_LENGTH       ( 700 )
+
+/**
+ * @brief Packet ID of the large publish messages.
+ */
+#define testmqttlibPUBLISH_PACKET_ID          ( 0x1234 )
+
+/**
+ * @brief Number of things whose shadow and jobs topics are subscribed to by
+ * the subscription manager test.
+ */
+#define testmqttlibTHINGS                     ( 120 )
+
+/**
+ * @brief The callback context of the "$aws/things/+/shadow/#" subscription.
+ */
+#define testmqttlibWILD_CARD_CONTEXT          ( testmqttlibTHINGS * 2 )
+
+/**
+ * @brief Number of topics dispatched to measure the time taken.
+ */
+#define testmqttlibDISPATCH_COUNT             ( 100000 )
 /*-----------------------------------------------------------*/
 
 /**
@@ -90,6 +146,8 @@ typedef struct CallbackCounter
     uint32_t ulConnACK;           /**< Number of times the callback is invoked for CONNACK message. */
     uint32_t ulUnexpectedConnACK; /**< Number of times the callback is invoked for unexpected CONNACK messages. */
     uint32_t ulDisconnect;        /**< Number of times the callback is invoked for disconnect message. */
+    uint32_t ulPublish;           /**< Number of times the callback is invoked for publish messages or fragments of them. */
+    uint32_t ulPubACK;            /**< Number of times the callback is invoked for PUBACK messages. */
     uint32_t ulUnidentified;      /**< Number of times the callback is invoked for un-handled events. */
 } CallbackCounter_t;
 /*-----------------------------------------------------------*/
@@ -103,6 +161,30 @@ static MQTTContext_t xMQTTContext;
  * @brief Callback counter used by all the tests.
  */
 static CallbackCounter_t xCallbackCounter;
+
+/**
+ * @brief The data of the large publish messages.
+ */
+static uint8_t ucLargePayload[ testmqttlibLARGE_PAYLOAD_LENGTH ];
+
+/**
+ * @brief The data transmitted by prvRecordingSendCallback.
+ */
+static uint8_t ucSentData[ testmqttlibLARGE_PAYLOAD_LENGTH + 64 ];
+static uint32_t ulSentDataLength;
+
+/**
+ * @brief The data received in the publish callbacks.
+ */
+static uint8_t ucReceivedPayload[ testmqttlibLARGE_PAYLOAD_LENGTH ];
+static uint32_t ulReceivedPayloadLength;
+
+/**
+ * @brief The in-flight message store used by all the tests.
+ */
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+    static MQTTRAMStore_t xInFlightStore;
+#endif
 /*-----------------------------------------------------------*/
 
 /**
@@ -158,6 +240,46 @@ static uint32_t prvSendFailedCallback( void * pvSendContext,
                                        const uint8_t * const pucData,
                                        uint32_t ulDataLength );
 
+/**
+ * @brief The send callback registered with the MQTT library to record
+ * the transmitted data in ucSentData.
+ *
+ * @param[in] pvSendContext The send context as supplied in Init parameters.
+ * @param[in] pucData The data to transmit.
+ * @param[in] ulDataLength The length of the data.
+ *
+ * @return The number of bytes actually transmitted.
+ */
+static uint32_t prvRecordingSendCallback( void * pvSendContext,
+                                          const uint8_t * const pucData,
+                                          uint32_t ulDataLength );
+
+/**
+ * @brief The read callback supplied in the publish parameters.
+ *
+ * Reads from the buffer passed as the read context, at most
+ * testmqttlibREAD_CALLBACK_LENGTH bytes at a time.
+ *
+ * @param[in] pvReadContext The read context as supplied in the publish parameters.
+ * @param[in] ulOffset The offset in the data of the first byte to read.
+ * @param[out] pucBuffer The buffer to read the data into.
+ * @param[in] ulBufferLength The length of pucBuffer.
+ *
+ * @return The number of bytes read.
+ */
+static uint32_t prvPublishReadCallback( void * pvReadContext,
+                                        uint32_t ulOffset,
+                                        uint8_t * pucBuffer,
+                                        uint32_t ulBufferLength );
+
+/**
+ * @brief Checks that ucSentData contains a publish message on
+ * testmqttlibLARGE_PUBLISH_TOPIC with ucLargePayload as the data.
+ *
+ * @param[in] xQos The QoS of the publish message.
+ */
+static void prvCheckSentLargePublish( MQTTQoS_t xQos );
+
 /**
  * @brief Initializes the global callback counter object.
  */
@@ -177,6 +299,16 @@ static MQTTReturnCode_t prvInitializeMQTTContext( void );
  */
 static MQTTReturnCode_t prvSendMQTTConnect( void );
 
+/**
+ * @brief Sends MQTT connect message by calling MQTT_Connect, asking the broker
+ * to start a clean session or to resume the previous one.
+ *
+ * @param[in] xCleanSession Whether to start a clean session.
+ *
+ * @return The return value of MQTT_Connect.
+ */
+static MQTTReturnCode_t prvSendMQTTConnectWithSession( MQTTBool_t xCleanSession );
+
 /**
  * @brief Mimics receiving a CONNACK message by passing a valid CONNACK message
  * to MQTT_ParseReceivedData.
@@ -213,6 +345,23 @@ static MQTTBool_t prvMQTTEventCallback( void * pvCallbackContext,
 
             break;
 
+        case eMQTTPubACK:
+            xCallbackCounter.ulPubACK += 1;
+
+            break;
+
+        case eMQTTPublish:
+            xCallbackCounter.ulPublish += 1;
+
+            /* Fragments are passed in order and put back together here. */
+            TEST_ASSERT_EQUAL( ulReceivedPayloadLength, pxParams->u.xPublishData.ulDataOffset );
+            TEST_ASSERT_TRUE( ( pxParams->u.xPublishData.ulDataOffset + pxParams->u.xPublishData.ulDataLength ) <= pxParams->u.xPublishData.ulTotalDataLength );
+            TEST_ASSERT_TRUE( pxParams->u.xPublishData.ulTotalDataLength <= sizeof( ucReceivedPayload ) );
+            memcpy( &( ucReceivedPayload[ ulReceivedPayloadLength ] ), pxParams->u.xPublishData.pvData, pxParams->u.xPublishData.ulDataLength );
+            ulReceivedPayloadLength += pxParams->u.xPublishData.ulDataLength;
+
+            break;
+
         default:
             xCallbackCounter.ulUnidentified += 1;
 
@@ -249,11 +398,78 @@ static uint32_t prvSendFailedCallback( void * pvSendContext,
 }
 /*-----------------------------------------------------------*/
 
+static uint32_t prvRecordingSendCallback( void * pvSendContext,
+                                          const uint8_t * const pucData,
+                                          uint32_t ulDataLength )
+{
+    /* Ensure that the correct context was supplied by the library. */
+    TEST_ASSERT_EQUAL( pvSendContext, testmqttlibSEND_CONTEXT );
+
+    TEST_ASSERT_TRUE( ( ulSentDataLength + ulDataLength ) <= sizeof( ucSentData ) );
+    memcpy( &( ucSentData[ ulSentDataLength ] ), pucData, ulDataLength );
+    ulSentDataLength += ulDataLength;
+
+    /* Mimic that everything was sent successfully. */
+    return ulDataLength;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvPublishReadCallback( void * pvReadContext,
+                                        uint32_t ulOffset,
+                                        uint8_t * pucBuffer,
+                                        uint32_t ulBufferLength )
+{
+    uint32_t ulReadLength = ( ulBufferLength < testmqttlibREAD_CALLBACK_LENGTH ) ? ulBufferLength : testmqttlibREAD_CALLBACK_LENGTH;
+
+    TEST_ASSERT_TRUE( ( ulOffset + ulBufferLength ) <= testmqttlibLARGE_PAYLOAD_LENGTH );
+    memcpy( pucBuffer, &( ( ( const uint8_t * ) pvReadContext )[ ulOffset ] ), ulReadLength );
+
+    return ulReadLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckSentLargePublish( MQTTQoS_t xQos )
+{
+    uint32_t ulIndex = 1, ulRemainingLength = 0, ulMultiplier = 1;
+    uint16_t usTopicLength = ( uint16_t ) strlen( testmqttlibLARGE_PUBLISH_TOPIC );
+
+    TEST_ASSERT_EQUAL( mqttCONTROL_PUBLISH | ( ( uint8_t ) xQos << 1 ), ucSentData[ 0 ] );
+
+    /* Decode the "Remaining Length". */
+    do
+    {
+        ulRemainingLength += ( uint32_t ) ( ucSentData[ ulIndex ] & 0x7F ) * ulMultiplier;
+        ulMultiplier *= 128;
+        ulIndex++;
+    } while( ( ucSentData[ ulIndex - 1 ] & 0x80 ) != 0 );
+
+    TEST_ASSERT_EQUAL( ulSentDataLength, ulIndex + ulRemainingLength );
+
+    /* Topic. */
+    TEST_ASSERT_EQUAL( usTopicLength, ( ( uint16_t ) ucSentData[ ulIndex ] << 8 ) | ucSentData[ ulIndex + 1 ] );
+    TEST_ASSERT_EQUAL_MEMORY( testmqttlibLARGE_PUBLISH_TOPIC, &( ucSentData[ ulIndex + 2 ] ), usTopicLength );
+    ulIndex += 2 + usTopicLength;
+
+    /* Packet identifier. */
+    if( xQos == eMQTTQoS1 )
+    {
+        TEST_ASSERT_EQUAL( testmqttlibPUBLISH_PACKET_ID, ( ( uint16_t ) ucSentData[ ulIndex ] << 8 ) | ucSentData[ ulIndex + 1 ] );
+        ulIndex += 2;
+    }
+
+    /* Data. */
+    TEST_ASSERT_EQUAL( testmqttlibLARGE_PAYLOAD_LENGTH, ulSentDataLength - ulIndex );
+    TEST_ASSERT_EQUAL_MEMORY( ucLargePayload, &( ucSentData[ ulIndex ] ), testmqttlibLARGE_PAYLOAD_LENGTH );
+}
+/*-----------------------------------------------------------*/
+
 static void prvInitializeCallbackCounter( void )
 {
     xCallbackCounter.ulConnACK = 0;
     xCallbackCounter.ulUnexpectedConnACK = 0;
     xCallbackCounter.ulDisconnect = 0;
+    xCallbackCounter.ulPublish = 0;
+    xCallbackCounter.ulPubACK = 0;
     xCallbackCounter.ulUnidentified = 0;
 }
 /*-----------------------------------------------------------*/
@@ -272,6 +488,16 @@ static MQTTReturnCode_t prvInitializeMQTTContext( void )
     xInitParams.xBufferPoolInterface.pxGetBufferFxn = BUFFERPOOL_GetFreeBuffer;
     xInitParams.xBufferPoolInterface.pxReturnBufferFxn = BUFFERPOOL_ReturnBuffer;
 
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        /* Start with an empty in-flight message store. */
+        MQTT_RAMSTORE_Init( &( xInFlightStore ) );
+        xInitParams.xInFlightStoreInterface.pvStoreContext = &( xInFlightStore );
+        xInitParams.xInFlightStoreInterface.pxWriteFxn = MQTT_RAMSTORE_Write;
+        xInitParams.xInFlightStoreInterface.pxReadFxn = MQTT_RAMSTORE_Read;
+        xInitParams.xInFlightStoreInterface.pxNextFxn = MQTT_RAMSTORE_Next;
+        xInitParams.xInFlightStoreInterface.pxRemoveFxn = MQTT_RAMSTORE_Remove;
+    #endif
+
     /* Initialize MQTT context. */
     xReturnCode = MQTT_Init( &( xMQTTContext ), &( xInitParams ) );
 
@@ -281,6 +507,12 @@ static MQTTReturnCode_t prvInitializeMQTTContext( void )
 /*-----------------------------------------------------------*/
 
 static MQTTReturnCode_t prvSendMQTTConnect( void )
+{
+    return prvSendMQTTConnectWithSession( eMQTTTrue );
+}
+/*-----------------------------------------------------------*/
+
+static MQTTReturnCode_t prvSendMQTTConnectWithSession( MQTTBool_t xCleanSession )
 {
     MQTTConnectParams_t xConnectParams;
     MQTTReturnCode_t xReturnCode;
@@ -296,6 +528,12 @@ static MQTTReturnCode_t prvSendMQTTConnect( void )
     xConnectParams.ulPingRequestTimeoutTicks = mqttconfigKEEP_ALIVE_TIMEOUT_TICKS;
     xConnectParams.ulTimeoutTicks = testmqttlibOPERATION_TIMEOUT_TICKS;
 
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        xConnectParams.xCleanSession = xCleanSession;
+    #else
+        ( void ) xCleanSession;
+    #endif
+
     /* Send MQTT Connect. */
     xReturnCode = MQTT_Connect( &( xMQTTContext ), &( xConnectParams ) );
 
@@ -366,6 +604,11 @@ TEST_GROUP_RUNNER( Full_MQTT )
     RUN_TEST_CASE( Full_MQTT, AFQP_prvDoesTopicMatchTopicFilter_MatchCases );
     RUN_TEST_CASE( Full_MQTT, AFQP_prvDoesTopicMatchTopicFilter_NotMatchCases );
 
+    /* Subscription manager tests. */
+    #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+        RUN_TEST_CASE( Full_MQTT, SubscriptionManager_ManyTopicFilters );
+    #endif
+
     /* MQTT_Init tests. */
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Init_HappyCase );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Init_NULLParams );
@@ -381,6 +624,15 @@ TEST_GROUP_RUNNER( Full_MQTT )
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_SecondConnectWhileAlreadyConnected );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_SecondConnectWhileWaitingForConnACK );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_NetworkSendFailed );
+
+    /* Large publish message tests. */
+    RUN_TEST_CASE( Full_MQTT, MQTT_Publish_LargePayload );
+    RUN_TEST_CASE( Full_MQTT, MQTT_ParseReceivedData_LargePublish );
+
+    #if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+        /* In-flight message store tests. */
+        RUN_TEST_CASE( Full_MQTT, MQTT_Publish_InFlightResend );
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -1075,3 +1327,365 @@ TEST( Full_MQTT, AFQP_MQTT_Connect_NetworkSendFailed )
     TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
 }
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief MQTT publish - The data does not fit in one buffer, and is taken from
+ * the user's memory or read using the read callback.
+ */
+TEST( Full_MQTT, MQTT_Publish_LargePayload )
+{
+    MQTTPublishParams_t xPublishParams;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < testmqttlibLARGE_PAYLOAD_LENGTH; ulIndex++ )
+    {
+        ucLargePayload[ ulIndex ] = ( uint8_t ) ( ulIndex % 251 );
+    }
+
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnect() );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvReceiveMQTTConnACK() );
+    xMQTTContext.pxMQTTSendFxn = &( prvRecordingSendCallback );
+
+    memset( &( xPublishParams ), 0x00, sizeof( xPublishParams ) );
+    xPublishParams.pucTopic = ( const uint8_t * ) testmqttlibLARGE_PUBLISH_TOPIC;
+    xPublishParams.usTopicLength = ( uint16_t ) strlen( testmqttlibLARGE_PUBLISH_TOPIC );
+    xPublishParams.pvData = ucLargePayload;
+    xPublishParams.ulDataLength = testmqttlibLARGE_PAYLOAD_LENGTH;
+    xPublishParams.ulTimeoutTicks = testmqttlibOPERATION_TIMEOUT_TICKS;
+
+    /* Data taken from the user's memory. */
+    xPublishParams.xQos = eMQTTQoS0;
+    ulSentDataLength = 0;
+    TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Publish( &( xMQTTContext ), &( xPublishParams ) ) );
+    prvCheckSentLargePublish( eMQTTQoS0 );
+
+    /* Data read using the read callback. The QoS1 publish waits for a PUBACK. */
+    xPublishParams.xQos = eMQTTQoS1;
+    xPublishParams.usPacketIdentifier = testmqttlibPUBLISH_PACKET_ID;
+    xPublishParams.pvData = NULL;
+    xPublishParams.pxReadFxn = &( prvPublishReadCallback );
+    xPublishParams.pvReadContext = ucLargePayload;
+    ulSentDataLength = 0;
+    TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Publish( &( xMQTTContext ), &( xPublishParams ) ) );
+    prvCheckSentLargePublish( eMQTTQoS1 );
+    TEST_ASSERT_FALSE( listIS_EMPTY( &( xMQTTContext.xTxBufferListHead ) ) );
+
+    /* No callback must have been invoked. */
+    TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief MQTT parse received data - A publish message which does not fit in
+ * one buffer is passed in fragments and acknowledged once complete.
+ */
+TEST( Full_MQTT, MQTT_ParseReceivedData_LargePublish )
+{
+    static uint8_t ucPublishMessage[ testmqttlibLARGE_PAYLOAD_LENGTH + 16 ];
+    static const uint8_t ucPUBACKMessage[] =
+    {
+        mqttCONTROL_PUBACK,                                    /* Fixed header control packet type. */
+        2,                                                     /* Fixed header remaining length. */
+        ( uint8_t ) ( testmqttlibPUBLISH_PACKET_ID >> 8 ),     /* Packet identifier MSB. */
+        ( uint8_t ) ( testmqttlibPUBLISH_PACKET_ID & 0xFF )    /* Packet identifier LSB. */
+    };
+    uint32_t ulIndex, ulMessageLength = 0, ulRemainingLength, ulChunkLength;
+
+    for( ulIndex = 0; ulIndex < testmqttlibLARGE_PAYLOAD_LENGTH; ulIndex++ )
+    {
+        ucLargePayload[ ulIndex ] = ( uint8_t ) ( ulIndex % 251 );
+    }
+
+    /* QoS1 publish on topic "a/b". */
+    ulRemainingLength = 2 + 3 + 2 + testmqttlibLARGE_PAYLOAD_LENGTH;
+    ucPublishMessage[ ulMessageLength++ ] = mqttCONTROL_PUBLISH | ( ( uint8_t ) eMQTTQoS1 << 1 );
+    ucPublishMessage[ ulMessageLength++ ] = ( uint8_t ) ( ( ulRemainingLength & 0x7F ) | 0x80 );
+    ucPublishMessage[ ulMessageLength++ ] = ( uint8_t ) ( ulRemainingLength >> 7 );
+    ucPublishMessage[ ulMessageLength++ ] = 0;
+    ucPublishMessage[ ulMessageLength++ ] = 3;
+    memcpy( &( ucPublishMessage[ ulMessageLength ] ), "a/b", 3 );
+    ulMessageLength += 3;
+    ucPublishMessage[ ulMessageLength++ ] = ( uint8_t ) ( testmqttlibPUBLISH_PACKET_ID >> 8 );
+    ucPublishMessage[ ulMessageLength++ ] = ( uint8_t ) ( testmqttlibPUBLISH_PACKET_ID & 0xFF );
+    memcpy( &( ucPublishMessage[ ulMessageLength ] ), ucLargePayload, testmqttlibLARGE_PAYLOAD_LENGTH );
+    ulMessageLength += testmqttlibLARGE_PAYLOAD_LENGTH;
+
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnect() );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvReceiveMQTTConnACK() );
+    xMQTTContext.pxMQTTSendFxn = &( prvRecordingSendCallback );
+    ulSentDataLength = 0;
+    ulReceivedPayloadLength = 0;
+
+    /* Receive the message a chunk at a time. */
+    for( ulIndex = 0; ulIndex < ulMessageLength; ulIndex += ulChunkLength )
+    {
+        ulChunkLength = ( ( ulMessageLength - ulIndex ) < testmqttlibRECEIVE_CHUNK_LENGTH ) ? ( ulMessageLength - ulIndex ) : testmqttlibRECEIVE_CHUNK_LENGTH;
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ParseReceivedData( &( xMQTTContext ), &( ucPublishMessage[ ulIndex ] ), ulChunkLength ) );
+    }
+
+    /* The whole message was passed in more than one fragment. */
+    TEST_ASSERT_TRUE( xCallbackCounter.ulPublish > 1 );
+    TEST_ASSERT_EQUAL( testmqttlibLARGE_PAYLOAD_LENGTH, ulReceivedPayloadLength );
+    TEST_ASSERT_EQUAL_MEMORY( ucLargePayload, ucReceivedPayload, testmqttlibLARGE_PAYLOAD_LENGTH );
+
+    /* The PUBACK was sent once the message was complete. */
+    TEST_ASSERT_EQUAL( sizeof( ucPUBACKMessage ), ulSentDataLength );
+    TEST_ASSERT_EQUAL_MEMORY( ucPUBACKMessage, ucSentData, sizeof( ucPUBACKMessage ) );
+
+    /* Ready for the next message. */
+    TEST_ASSERT_NULL( xMQTTContext.xRxBuffer );
+    TEST_ASSERT_EQUAL( eMQTTRxNextBytePacketType, xMQTTContext.xRxMessageState.xRxNextByte );
+    TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
+}
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+/**
+ * @brief The callback contexts of the subscriptions invoked for the last
+ * dispatched topic, in the order in which they were invoked.
+ */
+    static uint32_t ulInvokedContexts[ 4 ];
+    static uint32_t ulInvokedCount;
+
+    static MQTTBool_t prvSubscriptionCallback( void * pvPublishCallbackContext,
+                                               const MQTTPublishData_t * const pxPublishData )
+    {
+        ( void ) pxPublishData;
+
+        if( ulInvokedCount < ( sizeof( ulInvokedContexts ) / sizeof( ulInvokedContexts[ 0 ] ) ) )
+        {
+            ulInvokedContexts[ ulInvokedCount ] = ( uint32_t ) ( size_t ) pvPublishCallbackContext;
+        }
+
+        ulInvokedCount++;
+
+        return eMQTTFalse;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static uint16_t prvThingTopic( char * pcTopic,
+                                   size_t xTopicLength,
+                                   uint32_t ulThing,
+                                   const char * pcSuffix )
+    {
+        return ( uint16_t ) snprintf( pcTopic, xTopicLength, "$aws/things/thing%u/%s", ( unsigned ) ulThing, pcSuffix );
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvDispatch( const char * pcTopic,
+                             uint16_t usTopicLength )
+    {
+        MQTTPublishData_t xPublishData;
+        MQTTBool_t xCallbackInvoked;
+
+        memset( &( xPublishData ), 0x00, sizeof( xPublishData ) );
+        xPublishData.pucTopic = ( const uint8_t * ) pcTopic;
+        xPublishData.usTopicLength = usTopicLength;
+        ulInvokedCount = 0;
+
+        ( void ) Test_prvInvokeSubscriptionCallbacks( &( xMQTTContext ), &( xPublishData ), &( xCallbackInvoked ) );
+        TEST_ASSERT_EQUAL( ( ulInvokedCount > 0 ) ? eMQTTTrue : eMQTTFalse, xCallbackInvoked );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Stores the shadow and jobs topic filters of many things, then checks
+ * that received topics are dispatched to the right callbacks as the
+ * subscriptions are removed again.
+ */
+    TEST( Full_MQTT, SubscriptionManager_ManyTopicFilters )
+    {
+        static const char cWildCardFilter[] = "$aws/things/+/shadow/#";
+        static const char cTooManyLevels[] = "a/b/c/d/e/f/g/h/i/j/k/l/m/n/o/p/q";
+        char cTopic[ 64 ];
+        uint16_t usTopicLength;
+        uint32_t ulThing;
+        TickType_t xStart, xTicks;
+
+        /* Store a shadow and a jobs topic filter for each thing, and one
+         * wild-card filter matching the shadow topics of all things. */
+        for( ulThing = 0; ulThing < testmqttlibTHINGS; ulThing++ )
+        {
+            usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), ulThing, "shadow/update/accepted" );
+            TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ), ( const uint8_t * ) cTopic, usTopicLength,
+                                                                     ( void * ) ( size_t ) ulThing, prvSubscriptionCallback ) );
+
+            usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), ulThing, "jobs/+/get/accepted" );
+            TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ), ( const uint8_t * ) cTopic, usTopicLength,
+                                                                     ( void * ) ( size_t ) ( ulThing + testmqttlibTHINGS ), prvSubscriptionCallback ) );
+        }
+
+        TEST_ASSERT_EQUAL( eMQTTTrue, Test_prvStoreSubscription( &( xMQTTContext ), ( const uint8_t * ) cWildCardFilter, ( uint16_t ) strlen( cWildCardFilter ),
+                                                                 ( void * ) ( size_t ) testmqttlibWILD_CARD_CONTEXT, prvSubscriptionCallback ) );
+        TEST_ASSERT_EQUAL( testmqttlibTHINGS * 2 + 1, xMQTTContext.xSubscriptionManager.ulInUseSubscriptions );
+
+        /* Topic filters with too many levels are not stored. */
+        TEST_ASSERT_EQUAL( eMQTTFalse, Test_prvStoreSubscription( &( xMQTTContext ), ( const uint8_t * ) cTooManyLevels, ( uint16_t ) strlen( cTooManyLevels ),
+                                                                  NULL, prvSubscriptionCallback ) );
+
+        /* The exact match is invoked first, then the wild-card match. */
+        usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), 7, "shadow/update/accepted" );
+        prvDispatch( cTopic, usTopicLength );
+        TEST_ASSERT_EQUAL( 2, ulInvokedCount );
+        TEST_ASSERT_EQUAL( 7, ulInvokedContexts[ 0 ] );
+        TEST_ASSERT_EQUAL( testmqttlibWILD_CARD_CONTEXT, ulInvokedContexts[ 1 ] );
+
+        /* '+' matches the job identifier. */
+        usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), 9, "jobs/job1/get/accepted" );
+        prvDispatch( cTopic, usTopicLength );
+        TEST_ASSERT_EQUAL( 1, ulInvokedCount );
+        TEST_ASSERT_EQUAL( 9 + testmqttlibTHINGS, ulInvokedContexts[ 0 ] );
+
+        /* Topics of other things do not match. */
+        usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), testmqttlibTHINGS, "jobs/job1/get/accepted" );
+        prvDispatch( cTopic, usTopicLength );
+        TEST_ASSERT_EQUAL( 0, ulInvokedCount );
+
+        /* Measure the time taken to dispatch a topic. */
+        usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), testmqttlibTHINGS - 1, "shadow/update/accepted" );
+        xStart = xTaskGetTickCount();
+
+        for( ulThing = 0; ulThing < testmqttlibDISPATCH_COUNT; ulThing++ )
+        {
+            prvDispatch( cTopic, usTopicLength );
+        }
+
+        xTicks = xTaskGetTickCount() - xStart;
+        configPRINTF( ( "Dispatched a topic to %u subscriptions in %u ns\r\n",
+                        ( unsigned ) xMQTTContext.xSubscriptionManager.ulInUseSubscriptions,
+                        ( unsigned ) ( ( ( uint64_t ) xTicks * portTICK_PERIOD_MS * 1000000ULL ) / testmqttlibDISPATCH_COUNT ) ) );
+
+        /* Remove the shadow subscriptions of the even things. Their shadow
+         * topics then only match the wild-card filter. */
+        for( ulThing = 0; ulThing < testmqttlibTHINGS; ulThing += 2 )
+        {
+            usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), ulThing, "shadow/update/accepted" );
+            Test_prvRemoveSubscription( &( xMQTTContext ), ( const uint8_t * ) cTopic, usTopicLength );
+        }
+
+        usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), 8, "shadow/update/accepted" );
+        prvDispatch( cTopic, usTopicLength );
+        TEST_ASSERT_EQUAL( 1, ulInvokedCount );
+        TEST_ASSERT_EQUAL( testmqttlibWILD_CARD_CONTEXT, ulInvokedContexts[ 0 ] );
+
+        usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), 9, "shadow/update/accepted" );
+        prvDispatch( cTopic, usTopicLength );
+        TEST_ASSERT_EQUAL( 2, ulInvokedCount );
+        TEST_ASSERT_EQUAL( 9, ulInvokedContexts[ 0 ] );
+
+        /* The level names moved when nodes were freed must still match. */
+        usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), testmqttlibTHINGS - 2, "jobs/job1/get/accepted" );
+        prvDispatch( cTopic, usTopicLength );
+        TEST_ASSERT_EQUAL( 1, ulInvokedCount );
+        TEST_ASSERT_EQUAL( testmqttlibTHINGS - 2 + testmqttlibTHINGS, ulInvokedContexts[ 0 ] );
+
+        /* Removing all the subscriptions frees all the nodes and names. */
+        for( ulThing = 0; ulThing < testmqttlibTHINGS; ulThing++ )
+        {
+            usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), ulThing, "shadow/update/accepted" );
+            Test_prvRemoveSubscription( &( xMQTTContext ), ( const uint8_t * ) cTopic, usTopicLength );
+            usTopicLength = prvThingTopic( cTopic, sizeof( cTopic ), ulThing, "jobs/+/get/accepted" );
+            Test_prvRemoveSubscription( &( xMQTTContext ), ( const uint8_t * ) cTopic, usTopicLength );
+        }
+
+        Test_prvRemoveSubscription( &( xMQTTContext ), ( const uint8_t * ) cWildCardFilter, ( uint16_t ) strlen( cWildCardFilter ) );
+        TEST_ASSERT_EQUAL( 0, xMQTTContext.xSubscriptionManager.ulInUseSubscriptions );
+        TEST_ASSERT_EQUAL( 0, xMQTTContext.xSubscriptionManager.usLevelNamesLength );
+        TEST_ASSERT_EQUAL( 0, xMQTTContext.xSubscriptionManager.xNodes[ 0 ].usFirstChild );
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
+#if ( mqttconfigENABLE_INFLIGHT_STORE == 1 )
+
+/**
+ * @brief MQTT publish - A QoS1 publish message which is not acknowledged
+ * before the connection is lost is retransmitted with the DUP flag once the
+ * session is resumed, and discarded if a clean session is started.
+ */
+    TEST( Full_MQTT, MQTT_Publish_InFlightResend )
+    {
+        static uint8_t ucPublishMessage[ 64 ];
+        static const uint8_t ucSessionPresentConnACKMessage[] =
+        {
+            mqttCONTROL_CONNACK | mqttFLAGS_CONNACK, /* Fixed header control packet type. */
+            2,                                       /* Fixed header remaining length - always 2 for CONNACK. */
+            1,                                       /* Bit 0 is SP - Session Present. */
+            0,                                       /* Return code. */
+        };
+        static const uint8_t ucPUBACKMessage[] =
+        {
+            mqttCONTROL_PUBACK,                                 /* Fixed header control packet type. */
+            2,                                                  /* Fixed header remaining length. */
+            ( uint8_t ) ( testmqttlibPUBLISH_PACKET_ID >> 8 ),  /* Packet identifier MSB. */
+            ( uint8_t ) ( testmqttlibPUBLISH_PACKET_ID & 0xFF ) /* Packet identifier LSB. */
+        };
+        MQTTPublishParams_t xPublishParams;
+        uint32_t ulPublishMessageLength, ulPacketLength = 0;
+
+        TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnect() );
+        TEST_ASSERT_EQUAL( eMQTTSuccess, prvReceiveMQTTConnACK() );
+        xMQTTContext.pxMQTTSendFxn = &( prvRecordingSendCallback );
+
+        memset( &( xPublishParams ), 0x00, sizeof( xPublishParams ) );
+        xPublishParams.pucTopic = ( const uint8_t * ) "a/b";
+        xPublishParams.usTopicLength = 3;
+        xPublishParams.xQos = eMQTTQoS1;
+        xPublishParams.usPacketIdentifier = testmqttlibPUBLISH_PACKET_ID;
+        xPublishParams.pvData = "telemetry";
+        xPublishParams.ulDataLength = 9;
+        xPublishParams.ulTimeoutTicks = testmqttlibOPERATION_TIMEOUT_TICKS;
+
+        /* The message is stored before it is transmitted. */
+        ulSentDataLength = 0;
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Publish( &( xMQTTContext ), &( xPublishParams ) ) );
+        TEST_ASSERT_TRUE( ulSentDataLength <= sizeof( ucPublishMessage ) );
+        memcpy( ucPublishMessage, ucSentData, ulSentDataLength );
+        ulPublishMessageLength = ulSentDataLength;
+        TEST_ASSERT_EQUAL( 1, xMQTTContext.xInFlightStoreStats.ulStored );
+        TEST_ASSERT_EQUAL( testmqttlibPUBLISH_PACKET_ID, MQTT_RAMSTORE_Next( &( xInFlightStore ), 0, &( ulPacketLength ) ) );
+        TEST_ASSERT_EQUAL( ulPublishMessageLength, ulPacketLength );
+
+        /* The connection is lost, and the next one resumes the session. */
+        Test_prvResetMQTTContext( &( xMQTTContext ) );
+        ulSentDataLength = 0;
+        TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnectWithSession( eMQTTFalse ) );
+        TEST_ASSERT_EQUAL( 0, ucSentData[ testmqttlibCONNECT_FLAGS_OFFSET ] & mqttCONNECT_CLEAN_SESSION_FLAG );
+
+        ulSentDataLength = 0;
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ParseReceivedData( &( xMQTTContext ), ucSessionPresentConnACKMessage, sizeof( ucSessionPresentConnACKMessage ) ) );
+        TEST_ASSERT_EQUAL( eMQTTConnected, xMQTTContext.xConnectionState );
+
+        /* The same message is retransmitted, with the DUP flag. */
+        TEST_ASSERT_EQUAL( 1, xMQTTContext.xInFlightStoreStats.ulResent );
+        TEST_ASSERT_EQUAL( ulPublishMessageLength, ulSentDataLength );
+        TEST_ASSERT_EQUAL( ucPublishMessage[ 0 ] | mqttFLAGS_PUBLISH_DUP, ucSentData[ 0 ] );
+        TEST_ASSERT_EQUAL_MEMORY( &( ucPublishMessage[ 1 ] ), &( ucSentData[ 1 ] ), ulPublishMessageLength - 1 );
+
+        /* Its PUBACK removes it from the store. */
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ParseReceivedData( &( xMQTTContext ), ucPUBACKMessage, sizeof( ucPUBACKMessage ) ) );
+        TEST_ASSERT_EQUAL( 1, xCallbackCounter.ulPubACK );
+        TEST_ASSERT_EQUAL( 1, xMQTTContext.xInFlightStoreStats.ulAcknowledged );
+        TEST_ASSERT_EQUAL( 0, MQTT_RAMSTORE_Next( &( xInFlightStore ), 0, &( ulPacketLength ) ) );
+
+        /* A message not acknowledged before a clean session is discarded. */
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Publish( &( xMQTTContext ), &( xPublishParams ) ) );
+        Test_prvResetMQTTContext( &( xMQTTContext ) );
+        TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnect() );
+        ulSentDataLength = 0;
+        TEST_ASSERT_EQUAL( eMQTTSuccess, prvReceiveMQTTConnACK() );
+        TEST_ASSERT_EQUAL( 0, ulSentDataLength );
+        TEST_ASSERT_EQUAL( 1, xMQTTContext.xInFlightStoreStats.ulDiscarded );
+        TEST_ASSERT_EQUAL( 0, MQTT_RAMSTORE_Next( &( xInFlightStore ), 0, &( ulPacketLength ) ) );
+
+        /* Both connections were established. */
+        TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
+    }
+
+#endif /* mqttconfigENABLE_INFLIGHT_STORE */
+/*-----------------------------------------------------------*/
@@ -29,6 +29,9 @@
  * @brief The function to be called to run all the tests.
  */
 
+/* Standard includes. */
+#include <stdlib.h>
+
 /* Test runner interface includes. */
 #include "aws_test_runner.h"
 
@@ -99,6 +102,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_MQTT_Agent );
     #endif
 
+    #if ( testrunnerFULL_MQTT_AGENT_STUB_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_MQTT_Agent_Stub );
+    #endif
+
     #if ( testrunnerFULL_MQTT_ALPN_ENABLED == 1 )
         RUN_TEST_GROUP( Full_MQTT_Agent_ALPN );
     #endif
@@ -150,6 +157,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_FREERTOS_TCP );
     #endif
 
+    #if ( testrunnerFULL_FREERTOS_KERNEL_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_FREERTOS_KERNEL );
+    #endif
+
     #if ( testrunnerOTA_END_TO_END_ENABLED == 1 )
         extern void vStartOTAUpdateDemoTask( void );
         vStartOTAUpdateDemoTask();
@@ -199,6 +210,12 @@ void TEST_RUNNER_RunTests_task( void * pvParameters )
         exit( 0 );
     #endif
 
+    #ifdef testrunnerEXIT_ON_COMPLETION
+        /* Hosted builds report the result through the exit status of the
+         * process. */
+        exit( ( Unity.TestFailures == 0U ) ? 0 : 1 );
+    #endif
+
     /* This task has finished.  FreeRTOS does not allow a task to run off the
      * end of its implementing function, so the task must be deleted. */
     vTaskDelete( NULL );
@@ -0,0 +1,216 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include "unity_internals.h"
+
+/*-----------------------------------------------------------
+* Application specific definitions.
+*
+* These definitions should be adjusted for your particular hardware and
+* application requirements.
+*
+* THESE PARAMETERS ARE DESCRIBED WITHIN THE 'CONFIGURATION' SECTION OF THE
+* FreeRTOS API DOCUMENTATION AVAILABLE ON THE FreeRTOS.org WEB SITE.
+* http://www.freertos.org/a00110.html
+*----------------------------------------------------------*/
+#define configENABLE_BACKWARD_COMPATIBILITY        1
+#define configUSE_PREEMPTION                       1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION    0                         /* Must be 0 when configNUMBER_OF_CORES is greater than 1. */
+#define configNUMBER_OF_CORES                      2                         /* Run the tests on two simulated cores. */
+#define configMAX_PRIORITIES                       ( 7 )
+#define configTICK_RATE_HZ                         ( 1000 )                  /* The tick is generated by a host interval timer, so 1ms is achievable but not guaranteed. */
+#define configMINIMAL_STACK_SIZE                   ( ( unsigned short ) 60 ) /* In this simulated case, the stack only has to hold one small structure as the real stack is part of the pthread. */
+#define configTOTAL_HEAP_SIZE                      ( ( size_t ) ( 2048U * 1024U ) )
+#define configMAX_TASK_NAME_LEN                    ( 15 )
+#define configUSE_TRACE_FACILITY                   1
+#define configUSE_16_BIT_TICKS                     0
+#define configIDLE_SHOULD_YIELD                    1
+#define configUSE_CO_ROUTINES                      0
+#define configUSE_MUTEXES                          1
+#define configUSE_RECURSIVE_MUTEXES                1
+#define configQUEUE_REGISTRY_SIZE                  0
+#define configUSE_APPLICATION_TASK_TAG             1
+#define configUSE_COUNTING_SEMAPHORES              1
+#define configUSE_ALTERNATIVE_API                  0
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS    3
+#define configUSE_HEAP_TASK_CACHES                1
+#define configHEAP_TASK_CACHE_TLS_INDEX           0
+#define configRECORD_STACK_HIGH_ADDRESS            1
+#define configUSE_QUEUE_BY_REFERENCE               1
+#define configUSE_INDEXED_LISTS                    1                         /* O(log n) insertion into the delayed, event and timer lists. */
+#define configUSE_QUEUE_SEND_RECEIVE_MULTIPLE      1
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES      3
+
+/* Hook function related definitions. */
+#define configUSE_TICK_HOOK                        0
+#define configUSE_IDLE_HOOK                        1
+#define configUSE_MALLOC_FAILED_HOOK               1
+#define configCHECK_FOR_STACK_OVERFLOW             0      /* Not applicable to the Posix port. */
+
+/* Software timer related definitions. */
+#define configUSE_TIMERS                           1
+#define configTIMER_TASK_PRIORITY                  ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH                   5
+#define configTIMER_TASK_STACK_DEPTH               ( configMINIMAL_STACK_SIZE * 2 )
+#define configUSE_TIMER_WHEEL                      1
+#define configTIMER_WHEEL_SLOTS                    16                        /* Small, so the tests reach every level of the wheel quickly. */
+
+/* Event group related definitions. */
+#define configUSE_EVENT_GROUPS                     1
+#define configUSE_EVENT_GROUP_BIT_INDEX            1
+
+/* The EventGroupWaiters test times the part of xEventGroupSetBits() that runs
+ * with the scheduler suspended. */
+unsigned long long ullGetRunTimeNanoseconds( void );
+void vTraceEventGroupSetBits( void * pvEventGroup,
+                              int iEnd );
+#define kerneltestGET_TIME_NS()                                      ullGetRunTimeNanoseconds()
+#define traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet )        vTraceEventGroupSetBits( ( void * ) ( xEventGroup ), 0 )
+#define traceEVENT_GROUP_SET_BITS_END( xEventGroup, uxBitsToSet )    vTraceEventGroupSetBits( ( void * ) ( xEventGroup ), 1 )
+
+/* Run time stats gathering definitions. */
+unsigned long ulGetRunTimeCounterValue( void );
+void vConfigureTimerForRunTimeStats( void );
+#define configGENERATE_RUN_TIME_STATS    1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vConfigureTimerForRunTimeStats()
+#define portGET_RUN_TIME_COUNTER_VALUE()            ulGetRunTimeCounterValue()
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES                   0
+#define configMAX_CO_ROUTINE_PRIORITIES         ( 2 )
+
+/* Currently the TCP/IP stack is using dynamic allocation, and the MQTT task is
+ * using static allocation. */
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configSUPPORT_STATIC_ALLOCATION         1
+
+/* Set the following definitions to 1 to include the API function, or zero
+ * to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet                1
+#define INCLUDE_uxTaskPriorityGet               1
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskCleanUpResources           0
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_vTaskDelayUntil                 1
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTimerGetTimerTaskHandle        0
+#define INCLUDE_xTaskGetIdleTaskHandle          0
+#define INCLUDE_xQueueGetMutexHolder            1
+#define INCLUDE_eTaskGetState                   1
+#define INCLUDE_xEventGroupSetBitsFromISR       1
+#define INCLUDE_xTimerPendFunctionCall          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_xTaskAbortDelay                 1
+
+/* This project makes use of the example stats formatting functions.  These
+ * format the raw data provided by the uxTaskGetSystemState() function in to
+ * human readable ASCII form.  See the notes in the implementation of
+ * vTaskList() within FreeRTOS/Source/tasks.c for limitations. */
+#define configUSE_STATS_FORMATTING_FUNCTIONS    1
+
+/* Assert call defined for debug builds. */
+void vAssertCalled( const char * pcFile,
+                    uint32_t ulLine );
+
+#define configASSERT( x )    if( ( x ) == 0 ) TEST_ABORT()
+
+/* The function that implements FreeRTOS printf style output, and the macro
+ * that maps the configPRINTF() macros to that function. */
+void vLoggingPrintf( char const * pcFormat,
+                     ... );
+#define configPRINTF( X )    vLoggingPrintf X
+
+/* Non-format version thread-safe print. */
+extern void vLoggingPrint( const char * pcMessage );
+#define configPRINT( X )    vLoggingPrint( X )
+
+/* Map the logging task's printf to the function that writes to the host
+ * console. */
+extern void vMainConsolePrintString( const char * pcString );
+#define configPRINT_STRING( X )                    vMainConsolePrintString( X )
+#define configLOGGING_MAX_MESSAGE_LENGTH           256
+#define configLOGGING_INCLUDE_TIME_AND_TASK_NAME   1
+
+/* Application specific definitions follow. **********************************/
+
+/* The platform that FreeRTOS is running on. */
+#define configPLATFORM_NAME    "LinuxSim"
+
+/* Only used when running in the FreeRTOS Posix port.  Defines the priority of
+ * the task the simulated Ethernet interrupt defers to. */
+#define configMAC_ISR_SIMULATOR_PRIORITY    ( configMAX_PRIORITIES - 1 )
+
+/* The tests create a virtual network connection through a TAP device on the
+ * host.  The device is created if it does not exist, which requires
+ * CAP_NET_ADMIN.  Give the host side of the device an address in the same
+ * subnet as configIP_ADDR0..3 to reach the stack from the host, for example
+ * "ip addr add 192.168.7.1/24 dev tap0".  Set
+ * configNETWORK_INTERFACE_USE_PACKET_MMAP to 1 to use a packet socket bound to
+ * an existing interface, such as "eth0", instead. */
+#define configNETWORK_INTERFACE_TO_USE             "tap0"
+#define configNETWORK_INTERFACE_USE_PACKET_MMAP    0
+
+/* Default MAC address configuration. */
+#define configMAC_ADDR0                     0x00
+#define configMAC_ADDR1                     0x11
+#define configMAC_ADDR2                     0x22
+#define configMAC_ADDR3                     0x33
+#define configMAC_ADDR4                     0x44
+#define configMAC_ADDR5                     0x21
+
+/* Default IP address configuration.  Used in ipconfigUSE_DHCP is set to 0, or
+ * ipconfigUSE_DHCP is set to 1 but a DNS server cannot be contacted. */
+#define configIP_ADDR0                      192
+#define configIP_ADDR1                      168
+#define configIP_ADDR2                      7
+#define configIP_ADDR3                      2
+
+/* Default gateway IP address configuration.  Used in ipconfigUSE_DHCP is set to
+ * 0, or ipconfigUSE_DHCP is set to 1 but a DNS server cannot be contacted. */
+#define configGATEWAY_ADDR0                 192
+#define configGATEWAY_ADDR1                 168
+#define configGATEWAY_ADDR2                 7
+#define configGATEWAY_ADDR3                 1
+
+/* Default DNS server configuration.  Used in ipconfigUSE_DHCP is set to 0, or
+ * ipconfigUSE_DHCP is set to 1 but a DNS server cannot be contacted.*/
+#define configDNS_SERVER_ADDR0              192
+#define configDNS_SERVER_ADDR1              168
+#define configDNS_SERVER_ADDR2              7
+#define configDNS_SERVER_ADDR3              1
+
+/* Default netmask configuration.  Used in ipconfigUSE_DHCP is set to 0, or
+ * ipconfigUSE_DHCP is set to 1 but a DNS server cannot be contacted. */
+#define configNET_MASK0                     255
+#define configNET_MASK1                     255
+#define configNET_MASK2                     255
+#define configNET_MASK3                     0
+
+#endif /* FREERTOS_CONFIG_H */
@@ -40,6 +40,7 @@
 #define testrunnerFULL_CBOR_ENABLED                0
 #define testrunnerFULL_CRYPTO_ENABLED              0
 #define testrunnerFULL_FREERTOS_TCP_ENABLED        0
+#define testrunnerFULL_FREERTOS_KERNEL_ENABLED     0
 #define testrunnerFULL_DEFENDER_ENABLED            0
 #define testrunnerFULL_GGD_ENABLED                 0
 #define testrunnerFULL_GGD_HELPER_ENABLED          0